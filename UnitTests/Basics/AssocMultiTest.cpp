@@ -0,0 +1,261 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite for the AssocMulti class
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+
+#include "Basics/AssocMulti.h"
+#include "Basics/hashes.h"
+
+using namespace triagens;
+using namespace triagens::basics;
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+struct data_container_t {
+  int key;
+  int value;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief description for the template version
+////////////////////////////////////////////////////////////////////////////////
+
+struct DataDescription {
+  uint64_t hashKey (int const* key) const {
+    return TRI_FnvHashPointer(key, sizeof(int));
+  }
+
+  uint64_t hashElement (data_container_t const* element, bool byKey) const {
+    if (byKey) {
+      return TRI_FnvHashPointer(&element->key, sizeof(element->key));
+    }
+
+    return TRI_FnvHashPointer(&element->value, sizeof(element->value));
+  }
+
+  bool isEqualKeyElement (int const* key, data_container_t const* element) const {
+    return *key == element->key;
+  }
+
+  bool isEqualElementElement (data_container_t const* left,
+                              data_container_t const* right,
+                              bool byKey) const {
+    if (byKey) {
+      return left->key == right->key;
+    }
+
+    return left->value == right->value;
+  }
+};
+
+typedef AssocMulti<int, data_container_t, DataDescription> DataArray;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates elements, every key is used by perKey elements
+////////////////////////////////////////////////////////////////////////////////
+
+static vector<data_container_t> CreateElements (int n, int perKey) {
+  vector<data_container_t> elements(n);
+
+  for (int i = 0;  i < n;  ++i) {
+    elements[i].key = i / perKey;
+    elements[i].value = i;
+  }
+
+  return elements;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 setup / tear-down
+// -----------------------------------------------------------------------------
+
+struct AssocMultiSetup {
+  AssocMultiSetup () {
+    BOOST_TEST_MESSAGE("setup AssocMulti");
+  }
+
+  ~AssocMultiSetup () {
+    BOOST_TEST_MESSAGE("tear-down AssocMulti");
+  }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                        test suite
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief setup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE (AssocMultiTest, AssocMultiSetup)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test initialisation
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_init) {
+  DataArray a(TRI_CORE_MEM_ZONE);
+
+  BOOST_CHECK_EQUAL((uint64_t) 0, a.size());
+  BOOST_CHECK_EQUAL(1.0, a.selectivity());
+
+  int key = 1;
+  BOOST_CHECK_EQUAL((size_t) 0, a.lookupByKey(&key).size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert and lookup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_insert_lookup) {
+  DataArray a(TRI_CORE_MEM_ZONE);
+  vector<data_container_t> elements = CreateElements(1000, 10);
+
+  for (auto& element : elements) {
+    BOOST_CHECK(a.insert(&element, true, true) == nullptr);
+  }
+
+  BOOST_CHECK_EQUAL((uint64_t) 1000, a.size());
+  BOOST_CHECK_EQUAL(0.1, a.selectivity());
+
+  for (int key = 0;  key < 100;  ++key) {
+    vector<data_container_t*> found = a.lookupByKey(&key);
+
+    BOOST_CHECK_EQUAL((size_t) 10, found.size());
+
+    for (auto element : found) {
+      BOOST_CHECK_EQUAL(key, element->key);
+    }
+  }
+
+  int key = 100;
+  BOOST_CHECK_EQUAL((size_t) 0, a.lookupByKey(&key).size());
+
+  for (auto& element : elements) {
+    BOOST_CHECK(a.lookup(&element) == &element);
+  }
+
+  // an equal element replaces the old one
+  data_container_t copy = elements[15];
+  BOOST_CHECK(a.insert(&copy, true, true) == &elements[15]);
+  BOOST_CHECK(a.lookup(&elements[15]) == &copy);
+  BOOST_CHECK_EQUAL((uint64_t) 1000, a.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test remove
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_remove) {
+  DataArray a(TRI_CORE_MEM_ZONE);
+  vector<data_container_t> elements = CreateElements(1000, 10);
+
+  for (auto& element : elements) {
+    a.insert(&element, true, true);
+  }
+
+  // remove the heads and the tails of the lists
+  for (size_t i = 0;  i < elements.size();  ++i) {
+    if (i % 10 == 0 || i % 10 == 9) {
+      BOOST_CHECK(a.remove(&elements[i]) == &elements[i]);
+      BOOST_CHECK(a.remove(&elements[i]) == nullptr);
+    }
+  }
+
+  BOOST_CHECK_EQUAL((uint64_t) 800, a.size());
+
+  for (int key = 0;  key < 100;  ++key) {
+    BOOST_CHECK_EQUAL((size_t) 8, a.lookupByKey(&key).size());
+  }
+
+  // remove everything else
+  for (size_t i = 0;  i < elements.size();  ++i) {
+    if (i % 10 != 0 && i % 10 != 9) {
+      BOOST_CHECK(a.remove(&elements[i]) == &elements[i]);
+    }
+  }
+
+  BOOST_CHECK_EQUAL((uint64_t) 0, a.size());
+  BOOST_CHECK_EQUAL(1.0, a.selectivity());
+
+  int key = 5;
+  BOOST_CHECK_EQUAL((size_t) 0, a.lookupByKey(&key).size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test batch lookup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_lookup_batches) {
+  DataArray a(TRI_CORE_MEM_ZONE);
+  vector<data_container_t> elements = CreateElements(1000, 250);
+
+  for (auto& element : elements) {
+    a.insert(&element, true, true);
+  }
+
+  int key = 2;
+  void* next = nullptr;
+  size_t batches = 0;
+  vector<data_container_t*> found;
+
+  do {
+    a.lookupByKey(&key, [&found] (data_container_t* element) { found.push_back(element); }, next, 100);
+    ++batches;
+  }
+  while (next != nullptr);
+
+  BOOST_CHECK_EQUAL((size_t) 3, batches);
+  BOOST_CHECK_EQUAL((size_t) 250, found.size());
+
+  for (auto element : found) {
+    BOOST_CHECK_EQUAL(2, element->key);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generate tests
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END ()
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite for the latency histograms
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+
+#include <thread>
+
+#include "Statistics/histogram.h"
+
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 setup / tear-down
+// -----------------------------------------------------------------------------
+
+struct CHistogramSetup {
+  CHistogramSetup () {
+    BOOST_TEST_MESSAGE("setup histogram");
+  }
+
+  ~CHistogramSetup () {
+    BOOST_TEST_MESSAGE("tear-down histogram");
+  }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                        test suite
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief setup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE(CHistogramTest, CHistogramSetup)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test bucket boundaries
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_buckets) {
+  // small values are counted exactly
+  for (uint64_t i = 0;  i < StatisticsHistogram::SubBucketCount;  ++i) {
+    BOOST_CHECK_EQUAL((size_t) i, StatisticsHistogram::bucketIndex(i));
+  }
+
+  // every bucket contains exactly the values between its bounds
+  for (size_t i = 0;  i < StatisticsHistogram::BucketCount - 1;  ++i) {
+    uint64_t lower = StatisticsHistogram::bucketLowerBound(i);
+    uint64_t upper = StatisticsHistogram::bucketUpperBound(i);
+
+    BOOST_CHECK(lower <= upper);
+    BOOST_CHECK_EQUAL(i, StatisticsHistogram::bucketIndex(lower));
+    BOOST_CHECK_EQUAL(i, StatisticsHistogram::bucketIndex(upper));
+    BOOST_CHECK_EQUAL(i + 1, StatisticsHistogram::bucketIndex(upper + 1));
+
+    // relative error stays below 1 / 32
+    BOOST_CHECK((upper - lower) * 32 <= lower || lower < StatisticsHistogram::SubBucketCount);
+  }
+
+  // huge values end up in the last bucket
+  BOOST_CHECK_EQUAL(StatisticsHistogram::BucketCount - 1, StatisticsHistogram::bucketIndex(UINT64_MAX));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test an empty histogram
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_empty) {
+  StatisticsHistogram histogram;
+  StatisticsHistogramSnapshot snapshot = histogram.snapshot();
+
+  BOOST_CHECK_EQUAL((uint64_t) 0, snapshot._count);
+  BOOST_CHECK_EQUAL((uint64_t) 0, snapshot._total);
+  BOOST_CHECK_EQUAL((uint64_t) 0, snapshot.percentile(0.5));
+  BOOST_CHECK_EQUAL((uint64_t) 0, snapshot.percentile(0.999));
+  BOOST_CHECK_EQUAL(0.0, snapshot.mean());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test percentiles
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_percentiles) {
+  StatisticsHistogram histogram;
+
+  // 1 ... 10000 microseconds
+  for (uint64_t i = 1;  i <= 10000;  ++i) {
+    histogram.addValue(i);
+  }
+
+  StatisticsHistogramSnapshot snapshot = histogram.snapshot();
+
+  BOOST_CHECK_EQUAL((uint64_t) 10000, snapshot._count);
+  BOOST_CHECK_EQUAL((uint64_t) 50005000, snapshot._total);
+  BOOST_CHECK_EQUAL((uint64_t) 1, snapshot._min);
+  BOOST_CHECK_EQUAL((uint64_t) 10000, snapshot._max);
+  BOOST_CHECK_EQUAL(5000.5, snapshot.mean());
+
+  uint64_t p50 = snapshot.percentile(0.5);
+  uint64_t p99 = snapshot.percentile(0.99);
+  uint64_t p999 = snapshot.percentile(0.999);
+
+  BOOST_CHECK(p50 >= 5000 && p50 <= 5000 + 5000 / 32);
+  BOOST_CHECK(p99 >= 9900 && p99 <= 9900 + 9900 / 32);
+  BOOST_CHECK(p999 >= 9990 && p999 <= 10000);
+  BOOST_CHECK_EQUAL((uint64_t) 10000, snapshot.percentile(1.0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a single outlier is visible in the top percentile
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_outlier) {
+  StatisticsHistogram histogram;
+
+  for (size_t i = 0;  i < 999;  ++i) {
+    histogram.addFigure(0.001);
+  }
+
+  histogram.addFigure(2.5);
+
+  StatisticsHistogramSnapshot snapshot = histogram.snapshot();
+
+  uint64_t p99 = snapshot.percentile(0.99);
+  uint64_t p999 = snapshot.percentile(0.999);
+
+  BOOST_CHECK(p99 >= 1000 && p99 <= 1000 + 1000 / 32);
+  BOOST_CHECK(p999 >= 1000 && p999 <= 1000 + 1000 / 32);
+  BOOST_CHECK_EQUAL((uint64_t) 2500000, snapshot.percentile(0.9995));
+  BOOST_CHECK_EQUAL((uint64_t) 2500000, snapshot._max);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test concurrent recording
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_threads) {
+  StatisticsHistogram histogram;
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0;  i < 8;  ++i) {
+    threads.emplace_back([&histogram, i] () {
+      for (uint64_t j = 0;  j < 10000;  ++j) {
+        histogram.addValue(i * 1000 + j % 100);
+      }
+    });
+  }
+
+  for (auto& it : threads) {
+    it.join();
+  }
+
+  StatisticsHistogramSnapshot snapshot = histogram.snapshot();
+
+  BOOST_CHECK_EQUAL((uint64_t) 80000, snapshot._count);
+  BOOST_CHECK_EQUAL((uint64_t) 0, snapshot._min);
+  BOOST_CHECK_EQUAL((uint64_t) 7099, snapshot._max);
+
+  uint64_t sum = 0;
+
+  for (auto const& it : snapshot._counts) {
+    sum += it;
+  }
+
+  BOOST_CHECK_EQUAL((uint64_t) 80000, sum);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test merging snapshots
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_merge) {
+  StatisticsHistogram a;
+  StatisticsHistogram b;
+
+  a.addValue(10);
+  a.addValue(20);
+  b.addValue(5);
+  b.addValue(40);
+
+  StatisticsHistogramSnapshot snapshot = a.snapshot();
+  snapshot.merge(b.snapshot());
+  snapshot.merge(StatisticsHistogramSnapshot());
+
+  BOOST_CHECK_EQUAL((uint64_t) 4, snapshot._count);
+  BOOST_CHECK_EQUAL((uint64_t) 75, snapshot._total);
+  BOOST_CHECK_EQUAL((uint64_t) 5, snapshot._min);
+  BOOST_CHECK_EQUAL((uint64_t) 40, snapshot._max);
+  BOOST_CHECK_EQUAL((uint64_t) 20, snapshot.percentile(0.75));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generate tests
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END ()
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @\\}\\)"
+// End:
@@ -0,0 +1,316 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite for ShapedJsonParser
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/test/unit_test.hpp>
+
+#include "Basics/json.h"
+#include "ShapedJson/ShapedJsonParser.h"
+
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private classes
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a minimal in-memory shaper
+////////////////////////////////////////////////////////////////////////////////
+
+struct TestShaper {
+  TRI_shaper_t base;
+  std::map<std::string, TRI_shape_aid_t> attributes;
+  std::vector<TRI_shape_t*> shapes;
+  TRI_shape_sid_t nextSid;
+
+  TestShaper ()
+    : nextSid(BasicShapes::TRI_SHAPE_SID_LIST + 1) {
+    TRI_InitShaper(&base, TRI_UNKNOWN_MEM_ZONE);
+    base.findOrCreateAttributeByName = FindOrCreateAttributeByName;
+    base.findShape = FindShape;
+  }
+
+  ~TestShaper () {
+    for (auto shape : shapes) {
+      TRI_Free(TRI_UNKNOWN_MEM_ZONE, shape);
+    }
+    TRI_DestroyShaper(&base);
+  }
+
+  static TRI_shape_aid_t FindOrCreateAttributeByName (TRI_shaper_t* shaper,
+                                                      char const* name) {
+    auto self = reinterpret_cast<TestShaper*>(shaper);
+    auto it = self->attributes.find(name);
+
+    if (it != self->attributes.end()) {
+      return (*it).second;
+    }
+
+    TRI_shape_aid_t aid = static_cast<TRI_shape_aid_t>(self->attributes.size() + 1);
+    self->attributes.emplace(name, aid);
+    return aid;
+  }
+
+  static TRI_shape_t const* FindShape (TRI_shaper_t* shaper,
+                                       TRI_shape_t* shape,
+                                       bool create) {
+    auto self = reinterpret_cast<TestShaper*>(shaper);
+    TRI_shape_t const* found = TRI_LookupBasicShapeShaper(shape);
+
+    if (found == nullptr) {
+      for (auto other : self->shapes) {
+        if (other->_size == shape->_size &&
+            memcmp(reinterpret_cast<char const*>(other) + sizeof(TRI_shape_sid_t),
+                   reinterpret_cast<char const*>(shape) + sizeof(TRI_shape_sid_t),
+                   static_cast<size_t>(shape->_size) - sizeof(TRI_shape_sid_t)) == 0) {
+          found = other;
+          break;
+        }
+      }
+    }
+
+    if (found != nullptr) {
+      TRI_Free(TRI_UNKNOWN_MEM_ZONE, shape);
+      return found;
+    }
+
+    if (! create) {
+      return nullptr;
+    }
+
+    shape->_sid = self->nextSid++;
+    self->shapes.push_back(shape);
+    return shape;
+  }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    private macros
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compare the parser result with shaping the parsed JSON
+////////////////////////////////////////////////////////////////////////////////
+
+#define SHAPE_CHECK(parser, text)                                                          \
+  do {                                                                                     \
+    TRI_json_t* json = TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, text);                         \
+    BOOST_REQUIRE(json != nullptr);                                                        \
+    TRI_shaped_json_t* expected = TRI_ShapedJsonJson(&shaper.base, json, true);            \
+    BOOST_REQUIRE(expected != nullptr);                                                    \
+    BOOST_CHECK_EQUAL(TRI_ERROR_NO_ERROR, parser.parse(text, strlen(text)));               \
+    TRI_shaped_json_t const* actual = parser.shaped();                                     \
+    BOOST_CHECK_EQUAL(expected->_sid, actual->_sid);                                       \
+    BOOST_CHECK_EQUAL(expected->_data.length, actual->_data.length);                       \
+    if (expected->_data.length == actual->_data.length) {                                  \
+      BOOST_CHECK(memcmp(expected->_data.data, actual->_data.data, actual->_data.length) == 0); \
+    }                                                                                      \
+    TRI_FreeShapedJson(TRI_UNKNOWN_MEM_ZONE, expected);                                    \
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);                                              \
+  }                                                                                        \
+  while (0)
+
+#define PARSE_CHECK(expected, parser, text) \
+  BOOST_CHECK_EQUAL(expected, parser.parse(text, strlen(text)))
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 setup / tear-down
+// -----------------------------------------------------------------------------
+
+struct CShapedJsonParserSetup {
+  CShapedJsonParserSetup () {
+    BOOST_TEST_MESSAGE("setup shaped json parser test");
+  }
+
+  ~CShapedJsonParserSetup () {
+    BOOST_TEST_MESSAGE("tear-down shaped json parser test");
+  }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                        test suite
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief setup
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE(CShapedJsonParserTest, CShapedJsonParserSetup)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test simple values
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_simple_values) {
+  TestShaper shaper;
+  ShapedJsonParser parser(&shaper.base);
+
+  SHAPE_CHECK(parser, "{}");
+  SHAPE_CHECK(parser, "{ \"a\" : null }");
+  SHAPE_CHECK(parser, "{ \"a\" : true, \"b\" : false }");
+  SHAPE_CHECK(parser, "{ \"a\" : TRUE, \"b\" : False, \"c\" : NULL }");
+  SHAPE_CHECK(parser, "{ \"a\" : 0, \"b\" : -1, \"c\" : 1.5, \"d\" : -43.2e10, \"e\" : +5, \"f\" : 1E-3 }");
+  SHAPE_CHECK(parser, "{ \"a\" : \"\", \"b\" : \"abc\", \"c\" : \"abcdef\", \"d\" : \"abcdefg\" }");
+  SHAPE_CHECK(parser, "{ \"a\" : \"the quick brown fox jumped over the lazy dog\" }");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test strings that need unescaping
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_escaped_strings) {
+  TestShaper shaper;
+  ShapedJsonParser parser(&shaper.base);
+
+  SHAPE_CHECK(parser, "{ \"a\" : \"\\n\\t\\\"\\\\\\/\" }");
+  SHAPE_CHECK(parser, "{ \"a\" : \"\\u00e4\\u00f6\\u00fc\", \"\\u00df\" : 1 }");
+  SHAPE_CHECK(parser, "{ \"a\" : \"\\ud83d\\ude00 smile\" }");
+  SHAPE_CHECK(parser, "{ \"\xc3\xa4\" : \"\xc3\xb6\xc3\xbc \xe2\x82\xac\" }");
+  SHAPE_CHECK(parser, "{ \"a\" : \"A\\u030a\" }");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test nested objects and lists
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_nested) {
+  TestShaper shaper;
+  ShapedJsonParser parser(&shaper.base);
+
+  SHAPE_CHECK(parser, "{ \"a\" : [ ] }");
+  SHAPE_CHECK(parser, "{ \"a\" : [ 1, 2, 3 ] }");
+  SHAPE_CHECK(parser, "{ \"a\" : [ \"a\", \"bb\", \"a long string value\" ] }");
+  SHAPE_CHECK(parser, "{ \"a\" : [ \"a long string value\", \"another long string\" ] }");
+  SHAPE_CHECK(parser, "{ \"a\" : [ 1, \"a\", null, true, { }, [ ] ] }");
+  SHAPE_CHECK(parser, "{ \"a\" : [ [ 1, 2 ], [ 3, 4 ], [ 5 ] ] }");
+  SHAPE_CHECK(parser, "{ \"a\" : [ { \"x\" : 1 }, { \"x\" : 2, \"y\" : [ \"a long string value\" ] } ] }");
+  SHAPE_CHECK(parser, "{ \"z\" : { \"b\" : \"a long string value\", \"a\" : 1, \"c\" : { \"d\" : [ true ] } }, \"a\" : \"x\" }");
+  SHAPE_CHECK(parser, "{ \"a\" : { \"_key\" : \"nested\", \"_from\" : 1, \"\" : 2, \"b\" : 3 } }");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test system attributes
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_system_attributes) {
+  TestShaper shaper;
+  ShapedJsonParser parser(&shaper.base);
+  char const* key;
+
+  SHAPE_CHECK(parser, "{ \"_key\" : \"abc\", \"_rev\" : \"1\", \"_id\" : \"c/abc\", \"_from\" : \"v/1\", \"_to\" : \"v/2\", \"a\" : 1 }");
+  BOOST_CHECK_EQUAL(TRI_ERROR_NO_ERROR, parser.key(&key));
+  BOOST_CHECK_EQUAL(std::string("abc"), key);
+  BOOST_CHECK_EQUAL(std::string("v/1"), parser.from());
+  BOOST_CHECK_EQUAL(std::string("v/2"), parser.to());
+
+  SHAPE_CHECK(parser, "{ \"_key\" : \"\\u0061bc\", \"_from\" : [ 1 ], \"_to\" : { } }");
+  BOOST_CHECK_EQUAL(TRI_ERROR_NO_ERROR, parser.key(&key));
+  BOOST_CHECK_EQUAL(std::string("abc"), key);
+  BOOST_CHECK(parser.from() == nullptr);
+  BOOST_CHECK(parser.to() == nullptr);
+
+  SHAPE_CHECK(parser, "{ \"a\" : 1 }");
+  BOOST_CHECK_EQUAL(TRI_ERROR_NO_ERROR, parser.key(&key));
+  BOOST_CHECK(key == nullptr);
+
+  SHAPE_CHECK(parser, "{ \"_key\" : 123 }");
+  BOOST_CHECK_EQUAL(TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD, parser.key(&key));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that a parser can be reused
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_reuse) {
+  TestShaper shaper;
+  ShapedJsonParser parser(&shaper.base);
+
+  SHAPE_CHECK(parser, "{ \"a\" : [ \"a long string value\", { \"b\" : [ 1, 2, 3 ] } ] }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : [ 1, 2 }");
+  SHAPE_CHECK(parser, "{ \"b\" : 1 }");
+  SHAPE_CHECK(parser, "{ \"a\" : [ \"a long string value\", { \"b\" : [ 1, 2, 3 ] } ] }");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test invalid documents
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_invalid) {
+  TestShaper shaper;
+  ShapedJsonParser parser(&shaper.base);
+
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ 1 : 2 }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" 1 }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : 1, }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : 1 \"b\" : 2 }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : moo }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : [ 1, 2, \"bar\", moo ] }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : [ 1, ] }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : 01 }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : - }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : 1e999 }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : \"abc }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ } { }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "[ 1, 2");
+
+  PARSE_CHECK(TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID, parser, "[ 1, 2 ]");
+  PARSE_CHECK(TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID, parser, "\"abc\"");
+  PARSE_CHECK(TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID, parser, " 12 ");
+  PARSE_CHECK(TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID, parser, "null");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test duplicate attribute names
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE (tst_duplicates) {
+  TestShaper shaper;
+  ShapedJsonParser parser(&shaper.base);
+
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : 1, \"b\" : 2, \"a\" : 3 }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"a\" : 1, \"b\" : { \"b\" : 2, \"c\" : 3, \"b\" : 4 } }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"_key\" : \"a\", \"_key\" : \"b\" }");
+  PARSE_CHECK(TRI_ERROR_HTTP_CORRUPTED_JSON, parser, "{ \"\" : 1, \"\" : 2 }");
+
+  PARSE_CHECK(TRI_ERROR_NO_ERROR, parser, "{ \"a\" : 1, \"b\" : { \"a\" : 2 } }");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generate tests
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END ()
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// {@inheritDoc}\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @\\}\\)"
+// End:
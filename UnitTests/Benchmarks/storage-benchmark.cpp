@@ -0,0 +1,1157 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief microbenchmarks for the storage engine
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Basics/Common.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+#include "Basics/AssocMulti.h"
+#include "Basics/associative-multi.h"
+#include "Basics/fasthash.h"
+#include "Basics/hashes.h"
+#include "Basics/init.h"
+#include "Basics/json.h"
+#include "Basics/StringUtils.h"
+#include "HashIndex/hash-array.h"
+#include "HashIndex/hash-index.h"
+#include "ShapedJson/json-shaper.h"
+#include "ShapedJson/shaped-json.h"
+#include "SkipLists/skiplistIndex.h"
+#include "VocBase/datafile.h"
+#include "VocBase/document-collection.h"
+#include "VocBase/index.h"
+#include "VocBase/primary-index.h"
+#include "Wal/Marker.h"
+
+using namespace std;
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                               allocation counting
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of allocations done by the current thread
+///
+/// With glibc, the allocation functions are replaced by versions that count
+/// the calls and hand them on to the libc implementation. This covers
+/// TRI_Allocate as well as operator new. On other platforms, no allocations
+/// are counted.
+////////////////////////////////////////////////////////////////////////////////
+
+static __thread uint64_t Allocations = 0;
+
+#ifdef __GLIBC__
+
+#define TRI_COUNT_ALLOCATIONS 1
+
+extern "C" {
+  extern void* __libc_malloc (size_t);
+  extern void* __libc_calloc (size_t, size_t);
+  extern void* __libc_realloc (void*, size_t);
+
+  void* malloc (size_t size) {
+    ++Allocations;
+    return __libc_malloc(size);
+  }
+
+  void* calloc (size_t number, size_t size) {
+    ++Allocations;
+    return __libc_calloc(number, size);
+  }
+
+  void* realloc (void* ptr, size_t size) {
+    ++Allocations;
+    return __libc_realloc(ptr, size);
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private classes
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a minimal in-memory shaper
+////////////////////////////////////////////////////////////////////////////////
+
+struct BenchmarkShaper {
+  TRI_shaper_t base;
+  std::map<std::string, TRI_shape_aid_t> attributes;
+  std::vector<TRI_shape_t*> shapes;
+  TRI_shape_sid_t nextSid;
+
+  BenchmarkShaper ()
+    : nextSid(BasicShapes::TRI_SHAPE_SID_LIST + 1) {
+    TRI_InitShaper(&base, TRI_UNKNOWN_MEM_ZONE);
+    base.findOrCreateAttributeByName = FindOrCreateAttributeByName;
+    base.findShape = FindShape;
+    base.lookupShapeId = LookupShapeId;
+  }
+
+  ~BenchmarkShaper () {
+    for (auto shape : shapes) {
+      TRI_Free(TRI_UNKNOWN_MEM_ZONE, shape);
+    }
+    TRI_DestroyShaper(&base);
+  }
+
+  static TRI_shape_aid_t FindOrCreateAttributeByName (TRI_shaper_t* shaper,
+                                                      char const* name) {
+    auto self = reinterpret_cast<BenchmarkShaper*>(shaper);
+    auto it = self->attributes.find(name);
+
+    if (it != self->attributes.end()) {
+      return (*it).second;
+    }
+
+    TRI_shape_aid_t aid = static_cast<TRI_shape_aid_t>(self->attributes.size() + 1);
+    self->attributes.emplace(name, aid);
+    return aid;
+  }
+
+  static TRI_shape_t const* FindShape (TRI_shaper_t* shaper,
+                                       TRI_shape_t* shape,
+                                       bool create) {
+    auto self = reinterpret_cast<BenchmarkShaper*>(shaper);
+    TRI_shape_t const* found = TRI_LookupBasicShapeShaper(shape);
+
+    if (found == nullptr) {
+      for (auto other : self->shapes) {
+        if (other->_size == shape->_size &&
+            memcmp(reinterpret_cast<char const*>(other) + sizeof(TRI_shape_sid_t),
+                   reinterpret_cast<char const*>(shape) + sizeof(TRI_shape_sid_t),
+                   static_cast<size_t>(shape->_size) - sizeof(TRI_shape_sid_t)) == 0) {
+          found = other;
+          break;
+        }
+      }
+    }
+
+    if (found != nullptr) {
+      TRI_Free(TRI_UNKNOWN_MEM_ZONE, shape);
+      return found;
+    }
+
+    if (! create) {
+      return nullptr;
+    }
+
+    shape->_sid = self->nextSid++;
+    self->shapes.push_back(shape);
+    return shape;
+  }
+
+  static TRI_shape_t const* LookupShapeId (TRI_shaper_t* shaper,
+                                           TRI_shape_sid_t sid) {
+    auto self = reinterpret_cast<BenchmarkShaper*>(shaper);
+    TRI_shape_t const* found = TRI_LookupSidBasicShapeShaper(sid);
+
+    if (found == nullptr) {
+      for (auto other : self->shapes) {
+        if (other->_sid == sid) {
+          return other;
+        }
+      }
+    }
+
+    return found;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief documents with key markers, as the indexes see them
+///
+/// Every document consists of a master pointer and a key marker, the marker
+/// contains the key but no shaped JSON, so only inline sub-objects can be
+/// indexed.
+////////////////////////////////////////////////////////////////////////////////
+
+class DocumentSet {
+
+  public:
+
+    static size_t const KeyLength = 32;
+
+    static size_t const MarkerSize = TRI_DF_ALIGN_BLOCK(sizeof(TRI_doc_document_key_marker_t) + KeyLength);
+
+    DocumentSet (size_t threadNumber,
+                 size_t count)
+      : _markers(count * MarkerSize),
+        _documents(count) {
+
+      for (size_t i = 0;  i < count;  ++i) {
+        auto marker = reinterpret_cast<TRI_doc_document_key_marker_t*>(&_markers[i * MarkerSize]);
+
+        marker->base._size   = static_cast<TRI_voc_size_t>(MarkerSize);
+        marker->base._type   = TRI_DOC_MARKER_KEY_DOCUMENT;
+        marker->_rid         = static_cast<TRI_voc_rid_t>(i + 1);
+        marker->_tid         = 0;
+        marker->_shape       = 0;
+        marker->_offsetKey   = static_cast<uint16_t>(sizeof(TRI_doc_document_key_marker_t));
+        marker->_offsetJson  = static_cast<uint16_t>(MarkerSize);
+
+        snprintf(reinterpret_cast<char*>(marker) + marker->_offsetKey, KeyLength,
+                 "testkey%llu-%llu", (unsigned long long) threadNumber, (unsigned long long) i);
+
+        _documents[i]._rid = marker->_rid;
+        _documents[i].setDataPtr(marker);
+      }
+    }
+
+    size_t size () const {
+      return _documents.size();
+    }
+
+    TRI_doc_mptr_t* document (size_t position) {
+      return &_documents[position];
+    }
+
+    char const* key (size_t position) const {
+      return &_markers[position * MarkerSize] + sizeof(TRI_doc_document_key_marker_t);
+    }
+
+  private:
+
+    std::vector<char> _markers;
+
+    std::vector<TRI_doc_mptr_t> _documents;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a benchmark, every thread runs its own instance
+///
+/// The data structures of a collection are protected by the collection lock,
+/// so there are no concurrent writers to one instance. Running an instance
+/// per thread shows how the allocator and the memory bandwidth limit the
+/// throughput of writers to different collections.
+////////////////////////////////////////////////////////////////////////////////
+
+class StorageBenchmark {
+
+  public:
+
+    virtual ~StorageBenchmark () {
+    }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepares the operations, this is not measured
+////////////////////////////////////////////////////////////////////////////////
+
+    virtual void setUp (size_t threadNumber,
+                        size_t operations) = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief runs the operations
+////////////////////////////////////////////////////////////////////////////////
+
+    virtual void run (size_t operations) = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief releases the data structures, this is not measured
+////////////////////////////////////////////////////////////////////////////////
+
+    virtual void tearDown () = 0;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inserts keys into the primary index
+////////////////////////////////////////////////////////////////////////////////
+
+class PrimaryIndexBenchmark : public StorageBenchmark {
+
+  public:
+
+    void setUp (size_t threadNumber,
+                size_t operations) override {
+      _documents.reset(new DocumentSet(threadNumber, operations));
+      TRI_InitPrimaryIndex(&_index);
+    }
+
+    void run (size_t operations) override {
+      for (size_t i = 0;  i < operations;  ++i) {
+        TRI_doc_mptr_t* document = _documents->document(i);
+        void const* found;
+
+        document->_hash = TRI_HashKeyPrimaryIndex(_documents->key(i));
+        TRI_InsertKeyPrimaryIndex(&_index, document, &found);
+      }
+    }
+
+    void tearDown () override {
+      TRI_DestroyPrimaryIndex(&_index);
+      _documents.reset();
+    }
+
+  private:
+
+    std::unique_ptr<DocumentSet> _documents;
+
+    TRI_primary_index_t _index;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inserts numbers into a unique hash index
+///
+/// Like the hash index, every insertion allocates the sub-objects of the
+/// element and the search value.
+////////////////////////////////////////////////////////////////////////////////
+
+class HashIndexBenchmark : public StorageBenchmark {
+
+  public:
+
+    void setUp (size_t threadNumber,
+                size_t operations) override {
+      _documents.reset(new DocumentSet(threadNumber, operations));
+      TRI_InitHashArray(&_array, 1);
+    }
+
+    void run (size_t operations) override {
+      for (size_t i = 0;  i < operations;  ++i) {
+        double value = static_cast<double>(i);
+
+        TRI_hash_index_element_t element;
+        element._document = _documents->document(i);
+        element._subObjects = static_cast<TRI_shaped_sub_t*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, sizeof(TRI_shaped_sub_t), false));
+        element._subObjects->_sid = BasicShapes::TRI_SHAPE_SID_NUMBER;
+        memcpy(element._subObjects->_value._data, &value, sizeof(double));
+
+        TRI_index_search_value_t key;
+        key._length = 1;
+        key._values = static_cast<TRI_shaped_json_t*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, sizeof(TRI_shaped_json_t), false));
+        key._values[0]._sid = BasicShapes::TRI_SHAPE_SID_NUMBER;
+        key._values[0]._data.data = element._subObjects->_value._data;
+        key._values[0]._data.length = sizeof(double);
+
+        if (TRI_InsertKeyHashArray(&_array, &key, &element, false) != TRI_ERROR_NO_ERROR) {
+          TRI_Free(TRI_UNKNOWN_MEM_ZONE, element._subObjects);
+        }
+
+        TRI_Free(TRI_UNKNOWN_MEM_ZONE, key._values);
+      }
+    }
+
+    void tearDown () override {
+      TRI_DestroyHashArray(&_array);
+      _documents.reset();
+    }
+
+  private:
+
+    std::unique_ptr<DocumentSet> _documents;
+
+    TRI_hash_array_t _array;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inserts numbers in random order into a non-unique skiplist index
+////////////////////////////////////////////////////////////////////////////////
+
+class SkiplistIndexBenchmark : public StorageBenchmark {
+
+  public:
+
+    void setUp (size_t threadNumber,
+                size_t operations) override {
+      _documents.reset(new DocumentSet(threadNumber, operations));
+      _collection.setShaper(&_shaper.base);
+      _index = SkiplistIndex_new(&_collection, 1, false, TRI_SKIPLIST_VERTEX_NONE);
+    }
+
+    void run (size_t operations) override {
+      size_t const elementSize = SkiplistIndex_ElementSize(_index);
+
+      for (size_t i = 0;  i < operations;  ++i) {
+        double value = static_cast<double>(fasthash64(&i, sizeof(i), 0xdeadbeef) >> 11);
+
+        auto element = static_cast<TRI_skiplist_index_element_t*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, elementSize, false));
+        element->_document = _documents->document(i);
+
+        TRI_shaped_sub_t* subObjects = SkiplistIndex_Subobjects(element);
+        subObjects[0]._sid = BasicShapes::TRI_SHAPE_SID_NUMBER;
+        memcpy(subObjects[0]._value._data, &value, sizeof(double));
+
+        // the index takes over the element, even in case of an error
+        SkiplistIndex_insert(_index, element);
+      }
+    }
+
+    void tearDown () override {
+      SkiplistIndex_free(_index);
+      _index = nullptr;
+      _documents.reset();
+    }
+
+  private:
+
+    std::unique_ptr<DocumentSet> _documents;
+
+    BenchmarkShaper _shaper;
+
+    TRI_document_collection_t _collection;
+
+    SkiplistIndex* _index;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of elements per key in the multi-pointer benchmarks
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MultiElementsPerKey = 20;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief element of the multi-pointer benchmarks
+////////////////////////////////////////////////////////////////////////////////
+
+struct MultiElement {
+  size_t key;
+  size_t value;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief description of the elements for AssocMulti
+////////////////////////////////////////////////////////////////////////////////
+
+struct MultiElementDescription {
+  uint64_t hashKey (size_t const* key) const {
+    return TRI_FnvHashPointer(key, sizeof(size_t));
+  }
+
+  uint64_t hashElement (MultiElement const* element, bool byKey) const {
+    if (byKey) {
+      return TRI_FnvHashPointer(&element->key, sizeof(element->key));
+    }
+
+    return TRI_FnvHashPointer(&element->value, sizeof(element->value));
+  }
+
+  bool isEqualKeyElement (size_t const* key, MultiElement const* element) const {
+    return *key == element->key;
+  }
+
+  bool isEqualElementElement (MultiElement const* left,
+                              MultiElement const* right,
+                              bool byKey) const {
+    if (byKey) {
+      return left->key == right->key;
+    }
+
+    return left->value == right->value;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief operation measured by the multi-pointer benchmarks
+///
+/// For lookups and removals, all elements are inserted in the set-up. A
+/// lookup fetches all elements of one key.
+////////////////////////////////////////////////////////////////////////////////
+
+enum class MultiOperation {
+  INSERT,
+  LOOKUP,
+  REMOVE
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the elements, every key is used by MultiElementsPerKey
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<MultiElement> CreateMultiElements (size_t operations) {
+  std::vector<MultiElement> elements(operations);
+
+  for (size_t i = 0;  i < operations;  ++i) {
+    elements[i].key = i / MultiElementsPerKey;
+    elements[i].value = i;
+  }
+
+  return elements;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inserts, looks up or removes elements in a TRI_multi_pointer_t
+////////////////////////////////////////////////////////////////////////////////
+
+class MultiPointerBenchmark : public StorageBenchmark {
+
+  public:
+
+    explicit MultiPointerBenchmark (MultiOperation operation)
+      : _operation(operation) {
+    }
+
+    void setUp (size_t,
+                size_t operations) override {
+      _elements = CreateMultiElements(operations);
+      TRI_InitMultiPointer(&_array, TRI_UNKNOWN_MEM_ZONE, HashKey, HashElement, IsEqualKeyElement, IsEqualElementElement);
+
+      if (_operation != MultiOperation::INSERT) {
+        for (auto& element : _elements) {
+          TRI_InsertElementMultiPointer(&_array, &element, true, true);
+        }
+      }
+    }
+
+    void run (size_t operations) override {
+      switch (_operation) {
+        case MultiOperation::INSERT: {
+          for (size_t i = 0;  i < operations;  ++i) {
+            TRI_InsertElementMultiPointer(&_array, &_elements[i], true, true);
+          }
+          break;
+        }
+
+        case MultiOperation::LOOKUP: {
+          size_t const numberKeys = (operations + MultiElementsPerKey - 1) / MultiElementsPerKey;
+
+          for (size_t i = 0;  i < operations;  ++i) {
+            size_t key = i % numberKeys;
+            TRI_vector_pointer_t found = TRI_LookupByKeyMultiPointer(TRI_UNKNOWN_MEM_ZONE, &_array, &key);
+            TRI_DestroyVectorPointer(&found);
+          }
+          break;
+        }
+
+        case MultiOperation::REMOVE: {
+          for (size_t i = 0;  i < operations;  ++i) {
+            TRI_RemoveElementMultiPointer(&_array, &_elements[i]);
+          }
+          break;
+        }
+      }
+    }
+
+    void tearDown () override {
+      TRI_DestroyMultiPointer(&_array);
+      _elements.clear();
+    }
+
+  private:
+
+    static uint64_t HashKey (TRI_multi_pointer_t*, void const* key) {
+      return MultiElementDescription().hashKey(static_cast<size_t const*>(key));
+    }
+
+    static uint64_t HashElement (TRI_multi_pointer_t*, void const* element, bool byKey) {
+      return MultiElementDescription().hashElement(static_cast<MultiElement const*>(element), byKey);
+    }
+
+    static bool IsEqualKeyElement (TRI_multi_pointer_t*, void const* key, void const* element) {
+      return MultiElementDescription().isEqualKeyElement(static_cast<size_t const*>(key),
+                                                         static_cast<MultiElement const*>(element));
+    }
+
+    static bool IsEqualElementElement (TRI_multi_pointer_t*, void const* left, void const* right, bool byKey) {
+      return MultiElementDescription().isEqualElementElement(static_cast<MultiElement const*>(left),
+                                                             static_cast<MultiElement const*>(right),
+                                                             byKey);
+    }
+
+  private:
+
+    MultiOperation const _operation;
+
+    std::vector<MultiElement> _elements;
+
+    TRI_multi_pointer_t _array;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inserts, looks up or removes elements in an AssocMulti
+////////////////////////////////////////////////////////////////////////////////
+
+class AssocMultiBenchmark : public StorageBenchmark {
+
+  typedef AssocMulti<size_t, MultiElement, MultiElementDescription> MultiArray;
+
+  public:
+
+    explicit AssocMultiBenchmark (MultiOperation operation)
+      : _operation(operation) {
+    }
+
+    void setUp (size_t,
+                size_t operations) override {
+      _elements = CreateMultiElements(operations);
+      _array.reset(new MultiArray(TRI_UNKNOWN_MEM_ZONE));
+
+      if (_operation != MultiOperation::INSERT) {
+        for (auto& element : _elements) {
+          _array->insert(&element, true, true);
+        }
+      }
+    }
+
+    void run (size_t operations) override {
+      switch (_operation) {
+        case MultiOperation::INSERT: {
+          for (size_t i = 0;  i < operations;  ++i) {
+            _array->insert(&_elements[i], true, true);
+          }
+          break;
+        }
+
+        case MultiOperation::LOOKUP: {
+          size_t const numberKeys = (operations + MultiElementsPerKey - 1) / MultiElementsPerKey;
+
+          for (size_t i = 0;  i < operations;  ++i) {
+            size_t key = i % numberKeys;
+            _array->lookupByKey(&key);
+          }
+          break;
+        }
+
+        case MultiOperation::REMOVE: {
+          for (size_t i = 0;  i < operations;  ++i) {
+            _array->remove(&_elements[i]);
+          }
+          break;
+        }
+      }
+    }
+
+    void tearDown () override {
+      _array.reset();
+      _elements.clear();
+    }
+
+  private:
+
+    MultiOperation const _operation;
+
+    std::vector<MultiElement> _elements;
+
+    std::unique_ptr<MultiArray> _array;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of distinct documents used for shaping
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const NumberJsonDocuments = 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the JSON documents used for shaping
+////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<TRI_json_t*> CreateJsonDocuments () {
+  std::vector<TRI_json_t*> documents;
+  char buffer[512];
+
+  for (size_t i = 0;  i < NumberJsonDocuments;  ++i) {
+    snprintf(buffer, sizeof(buffer),
+             "{ \"_key\" : \"testkey%llu\", \"name\" : \"user %llu\", \"value\" : %llu, "
+             "\"active\" : %s, \"tags\" : [ \"red\", \"green\", \"blue\" ], "
+             "\"address\" : { \"street\" : \"Hauptstrasse %llu\", \"city\" : \"Cologne\", \"zip\" : \"50667\" } }",
+             (unsigned long long) i,
+             (unsigned long long) i,
+             (unsigned long long) i,
+             (i % 2 == 0) ? "true" : "false",
+             (unsigned long long) (i % 100));
+
+    documents.push_back(TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, buffer));
+  }
+
+  return documents;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief frees the JSON documents used for shaping
+////////////////////////////////////////////////////////////////////////////////
+
+static void FreeJsonDocuments (std::vector<TRI_json_t*>& documents) {
+  for (auto json : documents) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+  }
+
+  documents.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts JSON documents into shaped JSON
+///
+/// The shapes are created during the set up, so the operations only look
+/// them up, as they do for a collection with uniform documents.
+////////////////////////////////////////////////////////////////////////////////
+
+class ShapedJsonBenchmark : public StorageBenchmark {
+
+  public:
+
+    void setUp (size_t,
+                size_t) override {
+      _documents = CreateJsonDocuments();
+
+      for (auto json : _documents) {
+        TRI_FreeShapedJson(TRI_UNKNOWN_MEM_ZONE, TRI_ShapedJsonJson(&_shaper.base, json, true));
+      }
+    }
+
+    void run (size_t operations) override {
+      for (size_t i = 0;  i < operations;  ++i) {
+        TRI_shaped_json_t* shaped = TRI_ShapedJsonJson(&_shaper.base, _documents[i % NumberJsonDocuments], true);
+
+        if (shaped != nullptr) {
+          TRI_FreeShapedJson(TRI_UNKNOWN_MEM_ZONE, shaped);
+        }
+      }
+    }
+
+    void tearDown () override {
+      FreeJsonDocuments(_documents);
+    }
+
+  private:
+
+    BenchmarkShaper _shaper;
+
+    std::vector<TRI_json_t*> _documents;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief builds WAL document markers and fills them into a slot
+///
+/// Every operation creates a document marker and does what Slot::fill does
+/// with it: it sets tick and size, calculates the CRC and copies the marker
+/// into the logfile memory, which is a ring buffer here.
+////////////////////////////////////////////////////////////////////////////////
+
+class WalMarkerBenchmark : public StorageBenchmark {
+
+  public:
+
+    static size_t const LogfileSize = 32 * 1024 * 1024;
+
+    WalMarkerBenchmark ()
+      : _logfile(LogfileSize) {
+    }
+
+    void setUp (size_t,
+                size_t) override {
+      std::vector<TRI_json_t*> documents = CreateJsonDocuments();
+
+      for (size_t i = 0;  i < documents.size();  ++i) {
+        _shaped.push_back(TRI_ShapedJsonJson(&_shaper.base, documents[i], true));
+        _keys.push_back("testkey" + StringUtils::itoa(static_cast<uint64_t>(i)));
+      }
+
+      FreeJsonDocuments(documents);
+    }
+
+    void run (size_t operations) override {
+      size_t position = 0;
+
+      for (size_t i = 0;  i < operations;  ++i) {
+        size_t const n = i % NumberJsonDocuments;
+
+        triagens::wal::DocumentMarker marker(1, 1, static_cast<TRI_voc_rid_t>(i + 1), 0, _keys[n], 8, _shaped[n]);
+
+        size_t const size = marker.size();
+        size_t const alignedSize = TRI_DF_ALIGN_BLOCK(size);
+
+        if (position + alignedSize > _logfile.size()) {
+          position = 0;
+        }
+
+        auto m = static_cast<TRI_df_marker_t*>(marker.mem());
+        m->_tick = static_cast<TRI_voc_tick_t>(i + 1);
+        m->_size = static_cast<TRI_voc_size_t>(size);
+        m->_crc  = 0;
+
+        TRI_voc_crc_t crc = TRI_InitialCrc32();
+        crc = TRI_BlockCrc32(crc, static_cast<char const*>(marker.mem()), static_cast<TRI_voc_size_t>(size));
+        m->_crc = TRI_FinalCrc32(crc);
+
+        memcpy(&_logfile[position], marker.mem(), size);
+        position += alignedSize;
+      }
+    }
+
+    void tearDown () override {
+      for (auto shaped : _shaped) {
+        TRI_FreeShapedJson(TRI_UNKNOWN_MEM_ZONE, shaped);
+      }
+
+      _shaped.clear();
+      _keys.clear();
+    }
+
+  private:
+
+    BenchmarkShaper _shaper;
+
+    std::vector<TRI_shaped_json_t*> _shaped;
+
+    std::vector<std::string> _keys;
+
+    std::vector<char> _logfile;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculates the CRC of a block
+////////////////////////////////////////////////////////////////////////////////
+
+class CrcBenchmark : public StorageBenchmark {
+
+  public:
+
+    explicit CrcBenchmark (size_t size)
+      : _size(size) {
+    }
+
+    void setUp (size_t threadNumber,
+                size_t) override {
+      _block.resize(_size);
+
+      for (size_t i = 0;  i < _size;  ++i) {
+        _block[i] = static_cast<char>((i * 31 + threadNumber) & 0xff);
+      }
+    }
+
+    void run (size_t operations) override {
+      TRI_voc_crc_t result = 0;
+
+      for (size_t i = 0;  i < operations;  ++i) {
+        TRI_voc_crc_t crc = TRI_InitialCrc32();
+        crc = TRI_BlockCrc32(crc, _block.data(), static_cast<TRI_voc_size_t>(_size));
+        result ^= TRI_FinalCrc32(crc);
+      }
+
+      _result = result;
+    }
+
+    void tearDown () override {
+      _block.clear();
+    }
+
+  private:
+
+    size_t const _size;
+
+    std::vector<char> _block;
+
+    volatile TRI_voc_crc_t _result;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief description of a benchmark
+////////////////////////////////////////////////////////////////////////////////
+
+struct BenchmarkCase {
+  char const* _name;
+  char const* _description;
+  StorageBenchmark* (*_create) ();
+  size_t _divisor;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief result of a benchmark run
+////////////////////////////////////////////////////////////////////////////////
+
+struct BenchmarkResult {
+  double _nsPerOperation;
+  double _allocationsPerOperation;
+  double _operationsPerSecond;
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief all benchmarks
+///
+/// The divisor reduces the number of operations for expensive operations.
+////////////////////////////////////////////////////////////////////////////////
+
+static BenchmarkCase const Benchmarks[] = {
+  { "primary-index-insert",  "TRI_InsertKeyPrimaryIndex with new keys",
+    [] () -> StorageBenchmark* { return new PrimaryIndexBenchmark(); }, 1 },
+  { "hash-index-insert",     "TRI_InsertKeyHashArray, unique, one number attribute",
+    [] () -> StorageBenchmark* { return new HashIndexBenchmark(); }, 1 },
+  { "skiplist-index-insert", "SkiplistIndex_insert, non-unique, one number attribute",
+    [] () -> StorageBenchmark* { return new SkiplistIndexBenchmark(); }, 1 },
+  { "shaped-json",           "TRI_ShapedJsonJson of a document with 7 attributes",
+    [] () -> StorageBenchmark* { return new ShapedJsonBenchmark(); }, 1 },
+  { "wal-marker-fill",       "create a WAL document marker and fill it into a slot",
+    [] () -> StorageBenchmark* { return new WalMarkerBenchmark(); }, 1 },
+  { "multi-pointer-insert",  "TRI_InsertElementMultiPointer, 20 elements per key",
+    [] () -> StorageBenchmark* { return new MultiPointerBenchmark(MultiOperation::INSERT); }, 1 },
+  { "multi-pointer-lookup",  "TRI_LookupByKeyMultiPointer, 20 elements per key",
+    [] () -> StorageBenchmark* { return new MultiPointerBenchmark(MultiOperation::LOOKUP); }, 1 },
+  { "multi-pointer-remove",  "TRI_RemoveElementMultiPointer, 20 elements per key",
+    [] () -> StorageBenchmark* { return new MultiPointerBenchmark(MultiOperation::REMOVE); }, 1 },
+  { "assoc-multi-insert",    "AssocMulti::insert, 20 elements per key",
+    [] () -> StorageBenchmark* { return new AssocMultiBenchmark(MultiOperation::INSERT); }, 1 },
+  { "assoc-multi-lookup",    "AssocMulti::lookupByKey, 20 elements per key",
+    [] () -> StorageBenchmark* { return new AssocMultiBenchmark(MultiOperation::LOOKUP); }, 1 },
+  { "assoc-multi-remove",    "AssocMulti::remove, 20 elements per key",
+    [] () -> StorageBenchmark* { return new AssocMultiBenchmark(MultiOperation::REMOVE); }, 1 },
+  { "crc32-64",              "TRI_BlockCrc32 of 64 bytes",
+    [] () -> StorageBenchmark* { return new CrcBenchmark(64); }, 1 },
+  { "crc32-4k",              "TRI_BlockCrc32 of 4 KB",
+    [] () -> StorageBenchmark* { return new CrcBenchmark(4096); }, 16 },
+  { "crc32-1m",              "TRI_BlockCrc32 of 1 MB",
+    [] () -> StorageBenchmark* { return new CrcBenchmark(1024 * 1024); }, 4096 }
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief runs a benchmark once with the given number of threads
+////////////////////////////////////////////////////////////////////////////////
+
+static BenchmarkResult RunBenchmark (BenchmarkCase const& benchmark,
+                                     size_t numberThreads,
+                                     size_t operations) {
+  std::vector<std::unique_ptr<StorageBenchmark>> instances;
+  std::vector<double> durations(numberThreads, 0.0);
+  std::vector<uint64_t> allocations(numberThreads, 0);
+
+  for (size_t i = 0;  i < numberThreads;  ++i) {
+    instances.emplace_back(benchmark._create());
+  }
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  size_t ready = 0;
+  bool started = false;
+
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0;  i < numberThreads;  ++i) {
+    threads.emplace_back([&, i] () {
+      // the master pointers check for a transaction in maintainer mode
+      triagens::arango::TransactionBase trx(true);
+
+      instances[i]->setUp(i, operations);
+
+      {
+        std::unique_lock<std::mutex> guard(mutex);
+        ++ready;
+        condition.notify_all();
+        condition.wait(guard, [&] () { return started; });
+      }
+
+      uint64_t const allocationsBefore = Allocations;
+      auto const start = std::chrono::steady_clock::now();
+
+      instances[i]->run(operations);
+
+      auto const end = std::chrono::steady_clock::now();
+      allocations[i] = Allocations - allocationsBefore;
+      durations[i] = std::chrono::duration<double>(end - start).count();
+
+      instances[i]->tearDown();
+    });
+  }
+
+  {
+    std::unique_lock<std::mutex> guard(mutex);
+    condition.wait(guard, [&] () { return ready == numberThreads; });
+    started = true;
+    condition.notify_all();
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  double totalDuration = 0.0;
+  double maxDuration = 0.0;
+  uint64_t totalAllocations = 0;
+
+  for (size_t i = 0;  i < numberThreads;  ++i) {
+    totalDuration += durations[i];
+    maxDuration = (std::max)(maxDuration, durations[i]);
+    totalAllocations += allocations[i];
+  }
+
+  double const totalOperations = static_cast<double>(operations * numberThreads);
+
+  BenchmarkResult result;
+  result._nsPerOperation = totalDuration * 1.0e9 / totalOperations;
+  result._allocationsPerOperation = static_cast<double>(totalAllocations) / totalOperations;
+  result._operationsPerSecond = (maxDuration > 0.0) ? (totalOperations / maxDuration) : 0.0;
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief runs a benchmark repeatedly and returns the median run
+////////////////////////////////////////////////////////////////////////////////
+
+static BenchmarkResult RunBenchmark (BenchmarkCase const& benchmark,
+                                     size_t numberThreads,
+                                     size_t operations,
+                                     size_t runs) {
+  std::vector<BenchmarkResult> results;
+
+  for (size_t i = 0;  i < runs;  ++i) {
+    results.emplace_back(RunBenchmark(benchmark, numberThreads, operations));
+  }
+
+  std::sort(results.begin(), results.end(), [] (BenchmarkResult const& left, BenchmarkResult const& right) {
+    return left._nsPerOperation < right._nsPerOperation;
+  });
+
+  return results[results.size() / 2];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prints the usage
+////////////////////////////////////////////////////////////////////////////////
+
+static void PrintUsage (char const* name) {
+  cout << "usage: " << name << " [options]" << endl
+       << endl
+       << "  --benchmark <name>    run only benchmarks whose name contains <name>" << endl
+       << "  --operations <n>      operations per thread (default: 200000)" << endl
+       << "  --threads <list>      comma-separated thread counts (default: 1,2,4,8)" << endl
+       << "  --runs <n>            runs per benchmark, the median is reported (default: 3)" << endl
+       << "  --list                list the benchmarks" << endl
+       << endl;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                              main
+// -----------------------------------------------------------------------------
+
+int main (int argc, char* argv[]) {
+  std::string filter;
+  size_t operations = 200000;
+  size_t runs = 3;
+  std::vector<size_t> threadCounts = { 1, 2, 4, 8 };
+
+  for (int i = 1;  i < argc;  ++i) {
+    std::string const option = argv[i];
+
+    if (option == "--list") {
+      for (auto const& benchmark : Benchmarks) {
+        cout << std::left << std::setw(24) << benchmark._name << benchmark._description << endl;
+      }
+
+      return EXIT_SUCCESS;
+    }
+
+    if (i + 1 >= argc ||
+        (option != "--benchmark" && option != "--operations" && option != "--threads" && option != "--runs")) {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+    std::string const value = argv[++i];
+
+    if (option == "--benchmark") {
+      filter = value;
+    }
+    else if (option == "--operations") {
+      operations = static_cast<size_t>(StringUtils::uint64(value));
+    }
+    else if (option == "--runs") {
+      runs = static_cast<size_t>(StringUtils::uint64(value));
+    }
+    else {
+      threadCounts.clear();
+
+      for (auto const& part : StringUtils::split(value, ',')) {
+        threadCounts.push_back(static_cast<size_t>(StringUtils::uint64(part)));
+      }
+    }
+  }
+
+  if (operations == 0 || runs == 0 || threadCounts.empty() ||
+      std::find(threadCounts.begin(), threadCounts.end(), 0) != threadCounts.end()) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  TRIAGENS_C_INITIALISE(argc, argv);
+
+  cout << std::left << std::setw(24) << "benchmark"
+       << std::right << std::setw(8) << "threads"
+       << std::setw(12) << "ops/thread"
+       << std::setw(12) << "ns/op"
+#ifdef TRI_COUNT_ALLOCATIONS
+       << std::setw(12) << "allocs/op"
+#endif
+       << std::setw(14) << "ops/sec"
+       << std::setw(10) << "scaling"
+       << endl;
+
+  cout << std::fixed;
+
+  for (auto const& benchmark : Benchmarks) {
+    if (! filter.empty() && strstr(benchmark._name, filter.c_str()) == nullptr) {
+      continue;
+    }
+
+    size_t const n = (std::max)(operations / benchmark._divisor, static_cast<size_t>(1));
+    double baseline = 0.0;
+
+    for (auto numberThreads : threadCounts) {
+      BenchmarkResult const result = RunBenchmark(benchmark, numberThreads, n, runs);
+
+      if (baseline == 0.0) {
+        // scaling is relative to the first thread count, usually 1
+        baseline = result._operationsPerSecond / static_cast<double>(numberThreads);
+      }
+
+      cout << std::left << std::setw(24) << benchmark._name
+           << std::right << std::setw(8) << numberThreads
+           << std::setw(12) << n
+           << std::setw(12) << std::setprecision(1) << result._nsPerOperation
+#ifdef TRI_COUNT_ALLOCATIONS
+           << std::setw(12) << std::setprecision(2) << result._allocationsPerOperation
+#endif
+           << std::setw(14) << std::setprecision(0) << result._operationsPerSecond
+           << std::setw(10) << std::setprecision(2) << (baseline > 0.0 ? result._operationsPerSecond / baseline : 0.0)
+           << endl;
+    }
+  }
+
+  TRIAGENS_C_SHUTDOWN;
+
+  return EXIT_SUCCESS;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -531,6 +531,95 @@ describe ArangoDB do
 
     end
 
+################################################################################
+## checking parallel execution of parts
+################################################################################
+  
+    context "checking parallel execution:" do
+
+      before do
+        @cn = "UnitTestsBatch"
+        ArangoDB.drop_collection(@cn)
+        ArangoDB.create_collection(@cn)
+      end
+
+      after do
+        ArangoDB.drop_collection(@cn)
+      end
+      
+      it "checks the order of part responses" do
+        cmd = "/_api/batch"
+
+        multipart = ArangoMultipartBody.new()
+
+        (1..64).each do|i|
+          multipart.addPart("GET", "/_api/version", { }, "", "part" + i.to_s)
+        end
+        doc = ArangoDB.log_post("#{prefix}-post-parallel", cmd, :body => multipart.to_s, :format => :plain, :headers => { "Content-Type" => "multipart/form-data; boundary=" + multipart.getBoundary, "x-arango-batch-concurrency" => "8" })
+
+        doc.code.should eq(200)
+
+        parts = multipart.getParts(multipart.getBoundary, doc.response.body)
+        parts.length.should eq(64)
+
+        i = 1
+        parts.each do|part|
+          part[:status].should eq(200)
+          part[:contentId].should eq("part" + i.to_s)
+          i = i + 1
+        end
+      end
+      
+      it "checks parallel document creation with errors" do
+        cmd = "/_api/batch"
+
+        multipart = ArangoMultipartBody.new()
+
+        (1..50).each do|i|
+          multipart.addPart("POST", "/_api/document?collection=#{@cn}", { }, "{\"_key\":\"test#{i}\",\"value\":#{i}}", "part" + i.to_s)
+          multipart.addPart("GET", "/_api/document/#{@cn}/nonexisting#{i}", { }, "", "error" + i.to_s)
+        end
+        doc = ArangoDB.log_post("#{prefix}-post-parallel-documents", cmd, :body => multipart.to_s, :format => :plain, :headers => { "Content-Type" => "multipart/form-data; boundary=" + multipart.getBoundary, "x-arango-batch-concurrency" => "4" })
+
+        doc.code.should eq(200)
+        doc.headers['x-arango-errors'].should eq("50")
+
+        parts = multipart.getParts(multipart.getBoundary, doc.response.body)
+        parts.length.should eq(100)
+
+        i = 0
+        parts.each do|part|
+          if i % 2 == 0
+            part[:status].should eq(202)
+            part[:contentId].should eq("part" + (i / 2 + 1).to_s)
+          else
+            part[:status].should eq(404)
+            part[:contentId].should eq("error" + (i / 2 + 1).to_s)
+          end
+          i = i + 1
+        end
+
+        doc = ArangoDB.log_get("#{prefix}-get-collection-count", "/_api/collection/#{@cn}/count")
+        doc.code.should eq(200)
+        doc.parsed_response['count'].should eq(50)
+      end
+      
+      it "checks a parallel batch with a single part" do
+        cmd = "/_api/batch"
+
+        multipart = ArangoMultipartBody.new()
+        multipart.addPart("GET", "/_api/version", { }, "")
+
+        doc = ArangoDB.log_post("#{prefix}-post-parallel-single", cmd, :body => multipart.to_s, :format => :plain, :headers => { "Content-Type" => "multipart/form-data; boundary=" + multipart.getBoundary, "x-arango-batch-concurrency" => "16" })
+
+        doc.code.should eq(200)
+
+        parts = multipart.getParts(multipart.getBoundary, doc.response.body)
+        parts.length.should eq(1)
+        parts[0][:status].should eq(200)
+      end
+
+    end
       
   end
 
@@ -316,12 +316,15 @@ describe ArangoDB do
         doc.parsed_response['figures']['attributes']['count'].should >= 0
         doc.parsed_response['figures']['datafiles']['count'].should be_kind_of(Integer)
         doc.parsed_response['figures']['datafiles']['fileSize'].should be_kind_of(Integer)
+        doc.parsed_response['figures']['datafiles']['residentSize'].should be_kind_of(Integer)
         doc.parsed_response['figures']['datafiles']['count'].should eq(0)
         doc.parsed_response['figures']['journals']['count'].should be_kind_of(Integer)
         doc.parsed_response['figures']['journals']['fileSize'].should be_kind_of(Integer)
+        doc.parsed_response['figures']['journals']['residentSize'].should be_kind_of(Integer)
         doc.parsed_response['figures']['journals']['count'].should eq(0)
         doc.parsed_response['figures']['compactors']['count'].should be_kind_of(Integer)
         doc.parsed_response['figures']['compactors']['fileSize'].should be_kind_of(Integer)
+        doc.parsed_response['figures']['compactors']['residentSize'].should be_kind_of(Integer)
         doc.parsed_response['figures']['compactors']['count'].should eq(0)
         doc.parsed_response['figures']['shapefiles']['count'].should be_kind_of(Integer)
         doc.parsed_response['figures']['shapefiles']['fileSize'].should be_kind_of(Integer)
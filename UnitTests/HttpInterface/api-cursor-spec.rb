@@ -474,6 +474,134 @@ describe ArangoDB do
       end
     end
 
+################################################################################
+## stream cursors
+################################################################################
+
+    context "handling a stream cursor:" do
+      before do
+        @cn = "users"
+        ArangoDB.drop_collection(@cn)
+        @cid = ArangoDB.create_collection(@cn, false)
+
+        (0...10).each{|i|
+          ArangoDB.post("/_api/document?collection=#{@cid}", :body => "{ \"n\" : #{i} }")
+        }
+      end
+
+      after do
+        ArangoDB.drop_collection(@cn)
+      end
+
+      it "creates a stream cursor" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} SORT u.n RETURN u.n\", \"batchSize\" : 4, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream", cmd, :body => body)
+        
+        doc.code.should eq(201)
+        doc.headers['content-type'].should eq("application/json; charset=utf-8")
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['code'].should eq(201)
+        doc.parsed_response['id'].should be_kind_of(String)
+        doc.parsed_response['id'].should match(@reId)
+        doc.parsed_response['hasMore'].should eq(true)
+        doc.parsed_response['count'].should be_nil
+        doc.parsed_response['extra'].should be_nil
+        doc.parsed_response['result'].should eq([ 0, 1, 2, 3 ])
+
+        id = doc.parsed_response['id']
+
+        cmd = api + "/#{id}"
+        doc = ArangoDB.log_put("#{prefix}-create-stream-cont", cmd)
+        
+        doc.code.should eq(200)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['id'].should eq(id)
+        doc.parsed_response['hasMore'].should eq(true)
+        doc.parsed_response['extra'].should be_nil
+        doc.parsed_response['result'].should eq([ 4, 5, 6, 7 ])
+
+        doc = ArangoDB.log_put("#{prefix}-create-stream-cont2", cmd)
+        
+        doc.code.should eq(200)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['id'].should be_nil
+        doc.parsed_response['hasMore'].should eq(false)
+        doc.parsed_response['count'].should be_nil
+        doc.parsed_response['result'].should eq([ 8, 9 ])
+        doc.parsed_response['extra']['stats']['scannedFull'].should eq(10)
+        doc.parsed_response['extra']['warnings'].should eq([ ])
+
+        doc = ArangoDB.log_put("#{prefix}-create-stream-cont3", cmd)
+        
+        doc.code.should eq(404)
+        doc.parsed_response['error'].should eq(true)
+        doc.parsed_response['errorNum'].should eq(1600)
+      end
+
+      it "creates a stream cursor that is exhausted in the first batch" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} LIMIT 3 RETURN u.n\", \"batchSize\" : 5, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream-single", cmd, :body => body)
+        
+        doc.code.should eq(201)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['id'].should be_nil
+        doc.parsed_response['hasMore'].should eq(false)
+        doc.parsed_response['result'].length.should eq(3)
+        doc.parsed_response['extra']['stats'].should be_kind_of(Hash)
+      end
+
+      it "creates a stream cursor and deletes it in the middle" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} RETURN u.n\", \"batchSize\" : 2, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream-delete", cmd, :body => body)
+        
+        doc.code.should eq(201)
+        doc.parsed_response['hasMore'].should eq(true)
+        doc.parsed_response['result'].length.should eq(2)
+
+        id = doc.parsed_response['id']
+
+        cmd = api + "/#{id}"
+        doc = ArangoDB.log_delete("#{prefix}-create-stream-delete", cmd)
+
+        doc.code.should eq(202)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['id'].should eq(id)
+
+        doc = ArangoDB.log_put("#{prefix}-create-stream-delete", cmd)
+        
+        doc.code.should eq(404)
+        doc.parsed_response['errorNum'].should eq(1600)
+      end
+
+      it "rejects a stream cursor with count" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} RETURN u.n\", \"count\" : true, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream-count", cmd, :body => body)
+        
+        doc.code.should eq(400)
+        doc.parsed_response['error'].should eq(true)
+        doc.parsed_response['code'].should eq(400)
+        doc.parsed_response['errorNum'].should eq(10)
+      end
+
+      it "executes a data-modification query completely" do
+        cmd = api
+        body = "{ \"query\" : \"FOR u IN #{@cn} REMOVE u IN #{@cn}\", \"batchSize\" : 2, \"options\" : { \"stream\" : true } }"
+        doc = ArangoDB.log_post("#{prefix}-create-stream-modify", cmd, :body => body)
+        
+        doc.code.should eq(201)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['hasMore'].should eq(false)
+        doc.parsed_response['extra']['stats']['writesExecuted'].should eq(10)
+
+        doc = ArangoDB.get("/_api/collection/#{@cn}/count")
+        doc.parsed_response['count'].should eq(0)
+      end
+    end
+
 ################################################################################
 ## checking a query
 ################################################################################
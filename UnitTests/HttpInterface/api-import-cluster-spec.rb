@@ -0,0 +1,111 @@
+# coding: utf-8
+
+require 'rspec'
+require 'arangodb.rb'
+
+describe ArangoDB do
+  api = "/_api/import"
+  prefix = "api-import"
+
+  context "importing documents into a sharded collection:" do
+
+################################################################################
+## import documents
+################################################################################
+
+    context "import, sharded collection:" do
+      before do
+        @cn = "UnitTestsImport"
+        ArangoDB.drop_collection(@cn)
+
+        body = "{ \"name\" : \"#{@cn}\", \"numberOfShards\" : 4 }"
+        doc = ArangoDB.post("/_api/collection", :body => body)
+        doc.code.should eq(200)
+      end
+
+      after do
+        ArangoDB.drop_collection(@cn)
+      end
+
+      it "imports self-contained documents" do
+        body = ""
+        (1..100).each{|i|
+          body += "{ \"value\" : #{i} }\n"
+        }
+
+        cmd = api + "?collection=#{@cn}&type=documents"
+        doc = ArangoDB.log_post("#{prefix}-cluster-documents", cmd, :body => body)
+
+        doc.code.should eq(201)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['created'].should eq(100)
+        doc.parsed_response['errors'].should eq(0)
+        doc.parsed_response['empty'].should eq(0)
+
+        doc = ArangoDB.get("/_api/collection/#{@cn}/count")
+        doc.parsed_response['count'].should eq(100)
+      end
+
+      it "imports an array of documents with keys" do
+        body = "[ { \"_key\" : \"test1\", \"value\" : 1 }, { \"_key\" : \"test2\", \"value\" : 2 }, { \"_key\" : \"test3\", \"value\" : 3 } ]"
+
+        cmd = api + "?collection=#{@cn}&type=array"
+        doc = ArangoDB.log_post("#{prefix}-cluster-array", cmd, :body => body)
+
+        doc.code.should eq(201)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['created'].should eq(3)
+        doc.parsed_response['errors'].should eq(0)
+
+        doc = ArangoDB.get("/_api/document/#{@cn}/test2")
+        doc.code.should eq(200)
+        doc.parsed_response['value'].should eq(2)
+      end
+
+      it "imports headers and values" do
+        body = "[ \"_key\", \"value\" ]\n[ \"test1\", 1 ]\n\n[ \"test2\", 2 ]\n"
+
+        cmd = api + "?collection=#{@cn}"
+        doc = ArangoDB.log_post("#{prefix}-cluster-values", cmd, :body => body)
+
+        doc.code.should eq(201)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['created'].should eq(2)
+        doc.parsed_response['errors'].should eq(0)
+        doc.parsed_response['empty'].should eq(1)
+      end
+
+      it "reports errors with the positions of the documents" do
+        body = "{ \"_key\" : \"test1\" }\n[ ]\n{ \"_key\" : \"test2\" }\n{ \"_key\" : \"test1\" }\n"
+
+        cmd = api + "?collection=#{@cn}&type=documents&details=true"
+        doc = ArangoDB.log_post("#{prefix}-cluster-errors", cmd, :body => body)
+
+        doc.code.should eq(201)
+        doc.parsed_response['error'].should eq(false)
+        doc.parsed_response['created'].should eq(2)
+        doc.parsed_response['errors'].should eq(2)
+        doc.parsed_response['details'].length.should eq(2)
+        doc.parsed_response['details'][0].should match(/^at position 2: invalid JSON type/)
+        doc.parsed_response['details'][1].should match(/^at position 4: creating document failed with error 'unique constraint violated'/)
+      end
+
+      it "updates documents on duplicates" do
+        body = "{ \"_key\" : \"test1\", \"value\" : 1 }\n{ \"_key\" : \"test1\", \"value\" : 2 }\n"
+
+        cmd = api + "?collection=#{@cn}&type=documents&onDuplicate=update"
+        doc = ArangoDB.log_post("#{prefix}-cluster-update", cmd, :body => body)
+
+        doc.code.should eq(201)
+        doc.parsed_response['created'].should eq(1)
+        doc.parsed_response['updated'].should eq(1)
+        doc.parsed_response['errors'].should eq(0)
+
+        doc = ArangoDB.get("/_api/document/#{@cn}/test1")
+        doc.parsed_response['value'].should eq(2)
+      end
+
+    end
+
+  end
+end
@@ -0,0 +1,156 @@
+# coding: utf-8
+
+require 'rspec'
+require 'arangodb.rb'
+require 'json'
+
+describe ArangoDB do
+  api = "/_api/keyspace"
+  prefix = "api-keyspace"
+
+  context "dealing with keyspaces:" do
+    before do
+      @ks = "UnitTestsKeyspace"
+      ArangoDB.delete("#{api}/#{@ks}")
+
+      doc = ArangoDB.log_post("#{prefix}-create", api, :body => JSON.dump({ name: @ks }))
+      doc.code.should eq(201)
+    end
+
+    after do
+      ArangoDB.delete("#{api}/#{@ks}")
+    end
+
+    it "creates and drops a keyspace" do
+      doc = ArangoDB.log_post("#{prefix}-create", api, :body => JSON.dump({ name: @ks }))
+      doc.code.should eq(409)
+      doc.parsed_response['error'].should eq(true)
+      doc.parsed_response['errorNum'].should eq(1808)
+
+      doc = ArangoDB.log_post("#{prefix}-create", api, :body => JSON.dump({ name: @ks, ignoreExisting: true }))
+      doc.code.should eq(201)
+      doc.parsed_response['name'].should eq(@ks)
+
+      doc = ArangoDB.log_get("#{prefix}-read", "#{api}/#{@ks}")
+      doc.code.should eq(200)
+      doc.headers['content-type'].should eq("application/json; charset=utf-8")
+      doc.parsed_response['name'].should eq(@ks)
+      doc.parsed_response['count'].should eq(0)
+
+      doc = ArangoDB.log_delete("#{prefix}-drop", "#{api}/#{@ks}")
+      doc.code.should eq(200)
+
+      doc = ArangoDB.log_get("#{prefix}-read", "#{api}/#{@ks}")
+      doc.code.should eq(404)
+      doc.parsed_response['errorNum'].should eq(1807)
+
+      doc = ArangoDB.log_delete("#{prefix}-drop", "#{api}/#{@ks}")
+      doc.code.should eq(404)
+    end
+
+    it "rejects a keyspace without a name" do
+      doc = ArangoDB.log_post("#{prefix}-create-invalid", api, :body => JSON.dump({ size: 10 }))
+      doc.code.should eq(400)
+      doc.parsed_response['error'].should eq(true)
+    end
+
+    it "sets, reads and removes keys" do
+      doc = ArangoDB.log_put("#{prefix}-set", "#{api}/#{@ks}/foo", :body => JSON.dump({ user: "bar", roles: [ 1, 2 ] }))
+      doc.code.should eq(200)
+
+      doc = ArangoDB.log_get("#{prefix}-get", "#{api}/#{@ks}/foo")
+      doc.code.should eq(200)
+      doc.parsed_response.should eq({ "user" => "bar", "roles" => [ 1, 2 ] })
+
+      doc = ArangoDB.log_head("#{prefix}-head", "#{api}/#{@ks}/foo")
+      doc.code.should eq(200)
+
+      doc = ArangoDB.log_put("#{prefix}-set", "#{api}/#{@ks}/foo?replace=false", :body => "1")
+      doc.code.should eq(409)
+      doc.parsed_response['errorNum'].should eq(1801)
+
+      doc = ArangoDB.log_put("#{prefix}-set", "#{api}/#{@ks}/foo", :body => "\"baz\"")
+      doc.code.should eq(200)
+
+      doc = ArangoDB.log_get("#{prefix}-get", "#{api}/#{@ks}/foo")
+      doc.code.should eq(200)
+      doc.body.should eq("\"baz\"")
+
+      doc = ArangoDB.log_get("#{prefix}-read", "#{api}/#{@ks}?prefix=fo")
+      doc.parsed_response['count'].should eq(1)
+
+      doc = ArangoDB.log_delete("#{prefix}-remove", "#{api}/#{@ks}/foo")
+      doc.code.should eq(200)
+
+      doc = ArangoDB.log_delete("#{prefix}-remove", "#{api}/#{@ks}/foo")
+      doc.code.should eq(404)
+      doc.parsed_response['errorNum'].should eq(1802)
+
+      doc = ArangoDB.log_get("#{prefix}-get", "#{api}/#{@ks}/foo")
+      doc.code.should eq(404)
+
+      doc = ArangoDB.log_head("#{prefix}-head", "#{api}/#{@ks}/foo")
+      doc.code.should eq(404)
+    end
+
+    it "returns an error for keys in a non-existing keyspace" do
+      doc = ArangoDB.log_put("#{prefix}-set-missing", "#{api}/UnitTestsKeyspaceMissing/foo", :body => "1")
+      doc.code.should eq(404)
+      doc.parsed_response['errorNum'].should eq(1807)
+    end
+
+    it "increments keys" do
+      doc = ArangoDB.log_post("#{prefix}-incr", "#{api}/#{@ks}/counter", :body => "")
+      doc.code.should eq(200)
+      doc.parsed_response['value'].should eq(1)
+
+      doc = ArangoDB.log_post("#{prefix}-incr", "#{api}/#{@ks}/counter", :body => "41")
+      doc.code.should eq(200)
+      doc.parsed_response['value'].should eq(42)
+
+      doc = ArangoDB.log_post("#{prefix}-incr", "#{api}/#{@ks}/counter", :body => "\"foo\"")
+      doc.code.should eq(400)
+
+      ArangoDB.log_put("#{prefix}-set", "#{api}/#{@ks}/string", :body => "\"foo\"")
+      doc = ArangoDB.log_post("#{prefix}-incr", "#{api}/#{@ks}/string", :body => "")
+      doc.code.should eq(400)
+      doc.parsed_response['errorNum'].should eq(1809)
+    end
+
+    it "expires keys with a ttl" do
+      doc = ArangoDB.log_put("#{prefix}-set-ttl", "#{api}/#{@ks}/session?ttl=1", :body => JSON.dump({ user: "bar" }))
+      doc.code.should eq(200)
+
+      doc = ArangoDB.log_post("#{prefix}-incr-ttl", "#{api}/#{@ks}/requests?ttl=1", :body => "")
+      doc.parsed_response['value'].should eq(1)
+
+      ArangoDB.log_put("#{prefix}-set", "#{api}/#{@ks}/permanent", :body => "1")
+
+      doc = ArangoDB.log_get("#{prefix}-get", "#{api}/#{@ks}/session")
+      doc.code.should eq(200)
+
+      doc = ArangoDB.log_put("#{prefix}-set-ttl", "#{api}/#{@ks}/session?ttl=-1", :body => "1")
+      doc.code.should eq(400)
+
+      sleep 1.5
+
+      doc = ArangoDB.log_get("#{prefix}-get", "#{api}/#{@ks}/session")
+      doc.code.should eq(404)
+
+      doc = ArangoDB.log_get("#{prefix}-read", "#{api}/#{@ks}")
+      doc.parsed_response['count'].should eq(1)
+
+      # an expired counter starts again
+      doc = ArangoDB.log_post("#{prefix}-incr-ttl", "#{api}/#{@ks}/requests?ttl=1", :body => "")
+      doc.parsed_response['value'].should eq(1)
+    end
+
+    it "rejects unsupported methods" do
+      doc = ArangoDB.log_patch("#{prefix}-patch", "#{api}/#{@ks}/foo", :body => "1")
+      doc.code.should eq(405)
+
+      doc = ArangoDB.log_put("#{prefix}-put", "#{api}/#{@ks}", :body => "1")
+      doc.code.should eq(405)
+    end
+  end
+end
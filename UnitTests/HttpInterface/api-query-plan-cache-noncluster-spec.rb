@@ -0,0 +1,220 @@
+# coding: utf-8
+
+require 'rspec'
+require 'arangodb.rb'
+require 'json'
+
+describe ArangoDB do
+  api = "/_api/query/plan-cache"
+  prefix = "api-query-plan-cache"
+
+  context "dealing with the query plan cache:" do
+    before do
+      @cn = "UnitTestsQueryPlanCache"
+      ArangoDB.drop_collection(@cn)
+      ArangoDB.create_collection(@cn, false)
+
+      (0...10).each{|i|
+        ArangoDB.post("/_api/document?collection=#{@cn}", :body => "{ \"value\" : #{i} }")
+      }
+
+      ArangoDB.log_put("#{prefix}-properties", api, :body => JSON.dump({ maxEntries: 128 }))
+      ArangoDB.log_delete("#{prefix}-clear", api)
+    end
+
+    after do
+      ArangoDB.log_put("#{prefix}-properties", api, :body => JSON.dump({ maxEntries: 128 }))
+      ArangoDB.drop_collection(@cn)
+    end
+
+    def run_query (prefix, query, bindVars = { })
+      body = JSON.dump({ query: query, bindVars: bindVars })
+      doc = ArangoDB.log_post("#{prefix}-cursor", "/_api/cursor", :body => body)
+
+      doc.code.should eq(201)
+      doc.parsed_response['error'].should eq(false)
+      doc
+    end
+
+    it "returns the state of the cache" do
+      doc = ArangoDB.log_get("#{prefix}-get", api)
+
+      doc.code.should eq(200)
+      doc.headers['content-type'].should eq("application/json; charset=utf-8")
+      doc.parsed_response['error'].should eq(false)
+      doc.parsed_response['code'].should eq(200)
+      doc.parsed_response['maxEntries'].should eq(128)
+      doc.parsed_response['entries'].should be_kind_of(Integer)
+      doc.parsed_response['hits'].should be_kind_of(Integer)
+      doc.parsed_response['misses'].should be_kind_of(Integer)
+      doc.parsed_response['hitRate'].should be_kind_of(Numeric)
+    end
+
+    it "uses the cached plan when a query is repeated" do
+      query = "FOR d IN #{@cn} FILTER d.value >= 7 SORT d.value RETURN d.value"
+
+      before = ArangoDB.log_get("#{prefix}-get", api).parsed_response
+
+      doc = run_query(prefix, query)
+      doc.parsed_response['result'].should eq([ 7, 8, 9 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+
+      doc = run_query(prefix, query)
+      doc.parsed_response['result'].should eq([ 7, 8, 9 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      # redundant whitespace does not matter
+      doc = run_query(prefix, "  FOR d IN #{@cn}   FILTER d.value >=  7\tSORT d.value  RETURN d.value  ")
+      doc.parsed_response['result'].should eq([ 7, 8, 9 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      # differences in strings do
+      doc = run_query(prefix, "FOR d IN #{@cn} FILTER d.value >= 9 SORT d.value RETURN [ d.value, 'a  b' ]")
+      doc.parsed_response['result'].should eq([ [ 9, "a  b" ] ])
+      doc = run_query(prefix, "FOR d IN #{@cn} FILTER d.value >= 9 SORT d.value RETURN [ d.value, 'a b' ]")
+      doc.parsed_response['result'].should eq([ [ 9, "a b" ] ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+
+      doc = ArangoDB.log_get("#{prefix}-get", api)
+      doc.code.should eq(200)
+      doc.parsed_response['entries'].should be >= 3
+      doc.parsed_response['hits'].should be >= before['hits'] + 2
+      doc.parsed_response['misses'].should be >= before['misses'] + 3
+      doc.parsed_response['hitRate'].should be > 0
+    end
+
+    it "reuses the plan of a query with bind parameters for other values" do
+      query = "FOR d IN #{@cn} FILTER d.value >= @value SORT d.value RETURN d.value"
+
+      doc = run_query(prefix, query, { value: 7 })
+      doc.parsed_response['result'].should eq([ 7, 8, 9 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+
+      doc = run_query(prefix, query, { value: 8 })
+      doc.parsed_response['result'].should eq([ 8, 9 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      doc = run_query(prefix, query, { value: 7 })
+      doc.parsed_response['result'].should eq([ 7, 8, 9 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      # other kinds of values use another plan
+      doc = run_query(prefix, query, { value: "a" })
+      doc.parsed_response['result'].should eq([ ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+    end
+
+    it "reuses the plan of a query with a bound collection only for the same collection" do
+      query = "FOR d IN @@collection FILTER d.value == @value RETURN d.value"
+
+      doc = run_query(prefix, query, { "@collection" => @cn, value: 3 })
+      doc.parsed_response['result'].should eq([ 3 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+
+      doc = run_query(prefix, query, { "@collection" => @cn, value: 4 })
+      doc.parsed_response['result'].should eq([ 4 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      doc = run_query(prefix, query, { "@collection" => "_users", value: 4 })
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+    end
+
+    it "reuses the plan of a query with a bound limit only for the same limit" do
+      query = "FOR d IN #{@cn} FILTER d.value >= @value SORT d.value LIMIT @count RETURN d.value"
+
+      doc = run_query(prefix, query, { value: 2, count: 2 })
+      doc.parsed_response['result'].should eq([ 2, 3 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+
+      doc = run_query(prefix, query, { value: 5, count: 2 })
+      doc.parsed_response['result'].should eq([ 5, 6 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      doc = run_query(prefix, query, { value: 5, count: 3 })
+      doc.parsed_response['result'].should eq([ 5, 6, 7 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+    end
+
+    it "invalidates plans when an index is created or dropped" do
+      query = "FOR d IN #{@cn} FILTER d.value == 3 RETURN d.value"
+
+      run_query(prefix, query)
+      doc = run_query(prefix, query)
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+      doc.parsed_response['extra']['stats']['scannedFull'].should eq(10)
+
+      body = JSON.dump({ type: "hash", unique: false, fields: [ "value" ] })
+      doc = ArangoDB.log_post("#{prefix}-index", "/_api/index?collection=#{@cn}", :body => body)
+      doc.code.should eq(201)
+      iid = doc.parsed_response['id']
+
+      doc = run_query(prefix, query)
+      doc.parsed_response['result'].should eq([ 3 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+      doc.parsed_response['extra']['stats']['scannedFull'].should eq(0)
+
+      doc = run_query(prefix, query)
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+      doc.parsed_response['extra']['stats']['scannedIndex'].should eq(1)
+
+      doc = ArangoDB.log_delete("#{prefix}-index", "/_api/index/#{iid}")
+      doc.code.should eq(200)
+
+      doc = run_query(prefix, query)
+      doc.parsed_response['result'].should eq([ 3 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+      doc.parsed_response['extra']['stats']['scannedFull'].should eq(10)
+    end
+
+    it "invalidates plans when a collection is recreated" do
+      query = "FOR d IN #{@cn} RETURN d.value"
+
+      run_query(prefix, query)
+      doc = run_query(prefix, query)
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      ArangoDB.drop_collection(@cn)
+      ArangoDB.create_collection(@cn, false)
+
+      doc = run_query(prefix, query)
+      doc.parsed_response['result'].should eq([ ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+    end
+
+    it "does not cache plans when turned off" do
+      query = "FOR d IN #{@cn} FILTER d.value == 3 RETURN d.value"
+
+      doc = ArangoDB.log_put("#{prefix}-properties", api, :body => JSON.dump({ maxEntries: 0 }))
+      doc.code.should eq(200)
+      doc.parsed_response['maxEntries'].should eq(0)
+
+      run_query(prefix, query)
+      doc = run_query(prefix, query)
+      doc.parsed_response['result'].should eq([ 3 ])
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+
+      doc = ArangoDB.log_get("#{prefix}-get", api)
+      doc.parsed_response['entries'].should eq(0)
+    end
+
+    it "removes the least recently used plans" do
+      doc = ArangoDB.log_put("#{prefix}-properties", api, :body => JSON.dump({ maxEntries: 2 }))
+      doc.code.should eq(200)
+
+      run_query(prefix, "FOR d IN #{@cn} FILTER d.value == 1 RETURN d.value")
+      run_query(prefix, "FOR d IN #{@cn} FILTER d.value == 2 RETURN d.value")
+      run_query(prefix, "FOR d IN #{@cn} FILTER d.value == 1 RETURN d.value")
+      run_query(prefix, "FOR d IN #{@cn} FILTER d.value == 3 RETURN d.value")
+
+      doc = ArangoDB.log_get("#{prefix}-get", api)
+      doc.parsed_response['entries'].should eq(2)
+
+      doc = run_query(prefix, "FOR d IN #{@cn} FILTER d.value == 1 RETURN d.value")
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(true)
+
+      doc = run_query(prefix, "FOR d IN #{@cn} FILTER d.value == 2 RETURN d.value")
+      doc.parsed_response['extra']['stats']['cachedPlan'].should eq(false)
+    end
+
+  end
+end
@@ -950,6 +950,155 @@ describe ArangoDB do
         }
       end
 
+################################################################################
+## keys
+################################################################################
+
+      def create_keys (prefix, api, collection)
+        doc = ArangoDB.log_post("#{prefix}-keys-create", api + "/keys?collection=" + collection, :body => "")
+        doc.code.should eq(200)
+        doc.parsed_response['id'].should match(/^\d+$/)
+        doc.parsed_response
+      end
+
+      it "checks the key ranges for an empty collection" do
+        cid = ArangoDB.create_collection("UnitTestsReplication", false)
+
+        keys = create_keys(prefix, api, "UnitTestsReplication")
+        keys['count'].should eq(0)
+
+        cmd = api + "/keys/" + keys['id']
+        doc = ArangoDB.log_get("#{prefix}-keys-empty", cmd, :body => "")
+
+        doc.code.should eq(200)
+        doc.parsed_response.should eq([ ])
+
+        doc = ArangoDB.log_delete("#{prefix}-keys-delete", cmd)
+        doc.code.should eq(204)
+
+        doc = ArangoDB.log_get("#{prefix}-keys-empty", cmd, :body => "")
+        doc.code.should eq(404)
+        doc.parsed_response['errorNum'].should eq(1414)
+      end
+
+      it "checks the key ranges for a non-empty collection" do
+        cid = ArangoDB.create_collection("UnitTestsReplication", false)
+
+        (0...100).each{|i|
+          body = "{ \"_key\" : \"test" + i.to_s.rjust(3, "0") + "\", \"test\" : " + i.to_s + " }"
+          doc = ArangoDB.post("/_api/document?collection=UnitTestsReplication", :body => body)
+          doc.code.should eq(202)
+        }
+
+        keys = create_keys(prefix, api, "UnitTestsReplication")
+        keys['count'].should eq(100)
+
+        cmd = api + "/keys/" + keys['id'] + "?chunkSize=30"
+        doc = ArangoDB.log_get("#{prefix}-keys-ranges", cmd, :body => "")
+
+        doc.code.should eq(200)
+        ranges = doc.parsed_response
+        ranges.length.should eq(4)
+        ranges[0]['low'].should eq("test000")
+        ranges[0]['high'].should eq("test029")
+        ranges[0]['count'].should eq(30)
+        ranges[0]['hash'].should match(/^\d+$/)
+        ranges[3]['low'].should eq("test090")
+        ranges[3]['high'].should eq("test099")
+        ranges[3]['count'].should eq(10)
+
+        # the same snapshot must produce the same checksums
+        doc = ArangoDB.log_get("#{prefix}-keys-ranges", cmd, :body => "")
+        doc.parsed_response.should eq(ranges)
+
+        # changing a document does not change the existing snapshot
+        doc = ArangoDB.patch("/_api/document/UnitTestsReplication/test045", :body => "{ \"foo\" : 1 }")
+        doc.code.should eq(202)
+
+        doc = ArangoDB.log_get("#{prefix}-keys-ranges", cmd, :body => "")
+        doc.parsed_response.should eq(ranges)
+        ArangoDB.log_delete("#{prefix}-keys-delete", api + "/keys/" + keys['id'])
+
+        # but it changes the checksum of its range in a new snapshot
+        keys = create_keys(prefix, api, "UnitTestsReplication")
+        cmd = api + "/keys/" + keys['id'] + "?chunkSize=30"
+        doc = ArangoDB.log_get("#{prefix}-keys-ranges", cmd, :body => "")
+        changed = doc.parsed_response
+        changed[0]['hash'].should eq(ranges[0]['hash'])
+        changed[1]['hash'].should_not eq(ranges[1]['hash'])
+        changed[2]['hash'].should eq(ranges[2]['hash'])
+        changed[3]['hash'].should eq(ranges[3]['hash'])
+        ArangoDB.log_delete("#{prefix}-keys-delete", api + "/keys/" + keys['id'])
+      end
+
+      it "fetches the keys and documents of a key range" do
+        cid = ArangoDB.create_collection("UnitTestsReplication", false)
+
+        (0...10).each{|i|
+          body = "{ \"_key\" : \"test" + i.to_s + "\", \"test\" : " + i.to_s + " }"
+          doc = ArangoDB.post("/_api/document?collection=UnitTestsReplication", :body => body)
+          doc.code.should eq(202)
+        }
+
+        keys = create_keys(prefix, api, "UnitTestsReplication")
+
+        cmd = api + "/keys/" + keys['id'] + "?type=keys"
+        doc = ArangoDB.log_put("#{prefix}-keys-keys", cmd, :body => "{ \"low\" : \"test2\", \"high\" : \"test4\" }")
+
+        doc.code.should eq(200)
+        result = doc.parsed_response
+        result.length.should eq(3)
+        result[0][0].should eq("test2")
+        result[0][1].should match(/^\d+$/)
+        result[2][0].should eq("test4")
+
+        cmd = api + "/keys/" + keys['id'] + "?type=docs"
+        doc = ArangoDB.log_put("#{prefix}-keys-docs", cmd, :body => "[ \"test3\", \"missing\", \"test7\" ]", :format => :plain)
+
+        doc.code.should eq(200)
+        doc.headers["content-type"].should eq("application/x-arango-dump; charset=utf-8")
+
+        lines = doc.response.body.split("\n")
+        lines.length.should eq(2)
+        document = JSON.parse(lines[0])
+        document['type'].should eq(2300)
+        document['key'].should eq("test3")
+        document['data']['test'].should eq(3)
+        document = JSON.parse(lines[1])
+        document['key'].should eq("test7")
+        document['data']['test'].should eq(7)
+
+        ArangoDB.log_delete("#{prefix}-keys-delete", api + "/keys/" + keys['id'])
+      end
+
+      it "checks the keys API with an invalid type" do
+        cid = ArangoDB.create_collection("UnitTestsReplication", false)
+
+        keys = create_keys(prefix, api, "UnitTestsReplication")
+
+        cmd = api + "/keys/" + keys['id'] + "?type=foo"
+        doc = ArangoDB.log_put("#{prefix}-keys-invalid", cmd, :body => "[ ]")
+
+        doc.code.should eq(400)
+
+        ArangoDB.log_delete("#{prefix}-keys-delete", api + "/keys/" + keys['id'])
+      end
+
+      it "checks the keys API with an unknown snapshot" do
+        doc = ArangoDB.log_get("#{prefix}-keys-unknown", api + "/keys/123456", :body => "")
+        doc.code.should eq(404)
+        doc.parsed_response['error'].should eq(true)
+        doc.parsed_response['errorNum'].should eq(1414)
+
+        doc = ArangoDB.log_put("#{prefix}-keys-unknown", api + "/keys/123456?type=keys", :body => "{ \"low\" : \"a\", \"high\" : \"z\" }")
+        doc.code.should eq(404)
+        doc.parsed_response['errorNum'].should eq(1414)
+
+        doc = ArangoDB.log_delete("#{prefix}-keys-unknown", api + "/keys/123456")
+        doc.code.should eq(404)
+        doc.parsed_response['errorNum'].should eq(1414)
+      end
+
     end
 
   end
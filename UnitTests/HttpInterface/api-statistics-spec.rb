@@ -44,6 +44,41 @@ describe ArangoDB do
       doc.code.should eq(200)
     end
 
+################################################################################
+## check V8 context statistics
+###############################################################################
+
+    it "testing statistics of the V8 contexts" do 
+      cmd = "/_admin/statistics"
+      doc = ArangoDB.log_get("#{prefix}-v8", cmd) 
+  
+      doc.code.should eq(200)
+      contexts = doc.parsed_response['v8Contexts']
+      contexts['available'].should be > 0
+      contexts['available'].should be >= contexts['min']
+      contexts['available'].should be <= contexts['max']
+      contexts['available'].should eq(contexts['busy'] + contexts['dirty'] + contexts['free'])
+      contexts['busy'].should be >= 1
+      contexts['timeouts'].should be_kind_of(Integer)
+      contexts['waitTime']['count'].should be > 0
+      contexts['waitTime']['p99'].should be_kind_of(Numeric)
+      contexts['gcTime']['count'].should be_kind_of(Integer)
+    end
+
+    it "testing statistics of the code cache" do 
+      cmd = "/_admin/statistics"
+      doc = ArangoDB.log_get("#{prefix}-code-cache", cmd) 
+  
+      doc.code.should eq(200)
+      cache = doc.parsed_response['v8Contexts']['codeCache']
+      cache['enabled'].should eq(true)
+      cache['entries'].should be > 0
+      cache['memory'].should be > 0
+      cache['misses'].should be >= cache['entries']
+      cache['hits'].should be_kind_of(Integer)
+      cache['rejected'].should eq(0)
+    end
+
 ################################################################################
 ## check statistics for wrong user interaction
 ###############################################################################
@@ -209,6 +209,30 @@ void AqlItemBlock::destroy () {
   _valueCount.clear();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reuses the storage of a destroyed block for a block of another
+/// shape, reserving room for at least the given number of values
+////////////////////////////////////////////////////////////////////////////////
+
+void AqlItemBlock::rearrange (size_t nrItems,
+                              RegisterId nrRegs,
+                              size_t capacity) {
+  TRI_ASSERT(nrItems > 0);
+  TRI_ASSERT(_valueCount.empty());
+
+  // the values were destroyed or stolen before, so only forget them
+  for (auto& it : _data) {
+    it.erase();
+  }
+
+  _data.reserve(capacity);
+  _data.resize(nrItems * nrRegs);
+  _docColls.assign(nrRegs, nullptr);
+
+  _nrItems = nrItems;
+  _nrRegs  = nrRegs;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    public methods
 // -----------------------------------------------------------------------------
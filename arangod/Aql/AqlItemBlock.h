@@ -91,6 +91,15 @@ namespace triagens {
 
         void destroy ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reuses the storage of a destroyed block for a block of another
+/// shape, reserving room for at least the given number of values
+////////////////////////////////////////////////////////////////////////////////
+
+        void rearrange (size_t nrItems,
+                        RegisterId nrRegs,
+                        size_t capacity);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    public methods
 // -----------------------------------------------------------------------------
@@ -29,9 +29,42 @@
 
 #include "AqlItemBlockManager.h"
 #include "Aql/AqlItemBlock.h"
+#include "Aql/ExecutionStats.h"
 
 using namespace triagens::aql;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the size class of a block that must hold the given number of values
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t RequestBucket (size_t values) {
+  size_t bucket = 0;
+
+  while (((size_t) 1 << bucket) < values) {
+    ++bucket;
+  }
+
+  return bucket;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the size class of a block that can hold the given number of values
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t ReturnBucket (size_t capacity) {
+  size_t bucket = 0;
+
+  while (((size_t) 2 << bucket) <= capacity) {
+    ++bucket;
+  }
+
+  return bucket;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors / destructors
 // -----------------------------------------------------------------------------
@@ -40,9 +73,12 @@ using namespace triagens::aql;
 /// @brief create the manager
 ////////////////////////////////////////////////////////////////////////////////
 
-AqlItemBlockManager::AqlItemBlockManager ()
-  : _last(nullptr) {
+AqlItemBlockManager::AqlItemBlockManager (ExecutionStats& stats)
+  : _stats(stats) {
 
+  for (size_t i = 0; i < NumBuckets; ++i) {
+    _buckets[i].reserve(MaxBlocksPerBucket);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -50,7 +86,11 @@ AqlItemBlockManager::AqlItemBlockManager ()
 ////////////////////////////////////////////////////////////////////////////////
 
 AqlItemBlockManager::~AqlItemBlockManager () {
-  delete _last;
+  for (size_t i = 0; i < NumBuckets; ++i) {
+    for (auto block : _buckets[i]) {
+      delete block;
+    }
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -63,15 +103,36 @@ AqlItemBlockManager::~AqlItemBlockManager () {
 
 AqlItemBlock* AqlItemBlockManager::requestBlock (size_t nrItems, 
                                                  RegisterId nrRegs) {
-  if (_last != nullptr &&
-      _last->size() == nrItems &&
-      _last->getNrRegs() == nrRegs) {
-    auto block = _last;
-    _last = nullptr;
-    return block;
+  size_t const values = nrItems * nrRegs;
+  size_t const bucket = RequestBucket(values);
+  AqlItemBlock* block = nullptr;
+
+  if (bucket < NumBuckets && ! _buckets[bucket].empty()) {
+    block = _buckets[bucket].back();
+    _buckets[bucket].pop_back();
+    ++_stats.blocksReused;
+  }
+  else {
+    // create the block without any storage, and let rearrange() allocate it
+    block = new AqlItemBlock(nrItems, 0);
+    ++_stats.blocksAllocated;
+  }
+
+  size_t const capacity = block->_data.capacity();
+
+  try {
+    block->rearrange(nrItems, nrRegs, bucket < NumBuckets ? ((size_t) 1 << bucket) : values);
+  }
+  catch (...) {
+    delete block;
+    throw;
+  }
+
+  if (block->_data.capacity() > capacity) {
+    _stats.bytesAllocated += static_cast<int64_t>((block->_data.capacity() - capacity) * sizeof(AqlValue));
   }
 
-  return new AqlItemBlock(nrItems, nrRegs);
+  return block;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -82,8 +143,15 @@ void AqlItemBlockManager::returnBlock (AqlItemBlock*& block) {
   TRI_ASSERT(block != nullptr);
   block->destroy();
 
-  delete _last;
-  _last = block;
+  size_t const bucket = ReturnBucket(block->_data.capacity());
+
+  if (bucket < NumBuckets && _buckets[bucket].size() < MaxBlocksPerBucket) {
+    _buckets[bucket].push_back(block);
+  }
+  else {
+    delete block;
+  }
+
   block = nullptr;
 }
 
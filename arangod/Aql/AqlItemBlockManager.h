@@ -37,11 +37,23 @@ namespace triagens {
   namespace aql {
 
     class AqlItemBlock;
+    struct ExecutionStats;
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                         class AqlItemBlockManager
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief recycler for the AqlItemBlocks of a query
+///
+/// Blocks handed back to the manager are kept in size classes, with all
+/// values removed. A class holds blocks whose storage can take at least 2^n
+/// values, so a request can use any block of its class without growing the
+/// block's storage. Blocks created by the manager reserve a power of two
+/// values for this reason. Only a few blocks per class are kept, and very
+/// large blocks are not kept at all.
+////////////////////////////////////////////////////////////////////////////////
+
     class AqlItemBlockManager {
 
 // -----------------------------------------------------------------------------
@@ -54,7 +66,7 @@ namespace triagens {
 /// @brief create the manager
 ////////////////////////////////////////////////////////////////////////////////
 
-        AqlItemBlockManager ();
+        explicit AqlItemBlockManager (ExecutionStats&);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroy the manager
@@ -88,11 +100,28 @@ namespace triagens {
       private:
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief last block handed back to the manager
-/// this is the block that may be recycled
+/// @brief number of size classes, blocks with more values are not recycled
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const NumBuckets = 17;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of blocks kept per size class
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const MaxBlocksPerBucket = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief statistics of the query, counts the blocks and their memory
+////////////////////////////////////////////////////////////////////////////////
+
+        ExecutionStats& _stats;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief recycled blocks, by size class
 ////////////////////////////////////////////////////////////////////////////////
 
-        AqlItemBlock* _last;
+        std::vector<AqlItemBlock*> _buckets[NumBuckets];
 
     };
 
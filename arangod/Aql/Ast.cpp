@@ -1050,7 +1050,8 @@ AstNode* Ast::createNodeNop () {
 /// @brief injects bind parameters into the AST
 ////////////////////////////////////////////////////////////////////////////////
 
-void Ast::injectBindParameters (BindParameters& parameters) {
+void Ast::injectBindParameters (BindParameters& parameters,
+                                std::unordered_set<std::string> const* only) {
   auto p = parameters();
 
   auto func = [&](AstNode* node, void*) -> AstNode* {
@@ -1073,6 +1074,13 @@ void Ast::injectBindParameters (BindParameters& parameters) {
       // mark the bind parameter as being used
       (*it).second.second = true;
 
+      if (only != nullptr && 
+          *param != '@' &&
+          only->find((*it).first) == only->end()) {
+        // the value will be injected into the optimized plan
+        return node;
+      }
+
       auto value = (*it).second.first;
 
       if (*param == '@') {
@@ -1131,6 +1139,61 @@ void Ast::injectBindParameters (BindParameters& parameters) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the names of the bind parameters the optimizer needs the
+/// values of
+////////////////////////////////////////////////////////////////////////////////
+
+std::unordered_set<std::string> Ast::structuralBindParameters (BindParameters& parameters) const {
+  auto const& p = parameters();
+  std::unordered_set<std::string> result;
+
+  auto collect = [&](AstNode const* node, void*) -> void {
+    if (node->type == NODE_TYPE_PARAMETER) {
+      result.emplace(std::string(node->getStringValue()));
+    }
+  };
+
+  auto func = [&](AstNode const* node, void*) -> void {
+    if (node->type == NODE_TYPE_LIMIT) {
+      // offset and count must be numbers when the plan is built
+      traverseReadOnly(node, collect, nullptr);
+    }
+    else if (node->type == NODE_TYPE_SORT_ELEMENT ||
+             node->type == NODE_TYPE_BOUND_ATTRIBUTE_ACCESS) {
+      // sort direction or attribute name
+      traverseReadOnly(node->getMember(1), collect, nullptr);
+    }
+    else if (node->type == NODE_TYPE_OPERATOR_BINARY_EQ ||
+             node->type == NODE_TYPE_OPERATOR_BINARY_NE ||
+             node->type == NODE_TYPE_OPERATOR_BINARY_LT ||
+             node->type == NODE_TYPE_OPERATOR_BINARY_LE ||
+             node->type == NODE_TYPE_OPERATOR_BINARY_GT ||
+             node->type == NODE_TYPE_OPERATOR_BINARY_GE) {
+      // an index range with a bound computed at runtime treats an array
+      // value like the operand of IN
+      for (size_t i = 0; i < 2; ++i) {
+        auto member = node->getMember(i);
+
+        if (member->type != NODE_TYPE_PARAMETER) {
+          continue;
+        }
+
+        auto it = p.find(std::string(member->getStringValue()));
+
+        if (it != p.end() && 
+            (TRI_IsArrayJson((*it).second.first) || TRI_IsObjectJson((*it).second.first))) {
+          result.emplace((*it).first);
+        }
+      }
+    }
+  };
+
+  traverseReadOnly(_root, func, nullptr);
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replace variables
 ////////////////////////////////////////////////////////////////////////////////
@@ -530,9 +530,31 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief injects bind parameters into the AST
+///
+/// if a set of names is passed, only collection parameters and the parameters
+/// in the set are replaced. all other parameters are kept as parameter nodes,
+/// so their values can be injected into the optimized plan later
+////////////////////////////////////////////////////////////////////////////////
+
+        void injectBindParameters (BindParameters&,
+                                   std::unordered_set<std::string> const* = nullptr);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the names of the bind parameters the optimizer needs the
+/// values of
+///
+/// these are the parameters used in LIMIT, as sort direction or as the name
+/// of a bound attribute, and array or object values compared directly with
+/// another operand
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_set<std::string> structuralBindParameters (BindParameters&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create an AST node from JSON
 ////////////////////////////////////////////////////////////////////////////////
 
-        void injectBindParameters (BindParameters&);
+        AstNode* nodeFromJson (TRI_json_t const*);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replace variables
@@ -678,12 +700,6 @@ namespace triagens {
 
         AstNode* optimizeFor (AstNode*);
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief create an AST node from JSON
-////////////////////////////////////////////////////////////////////////////////
-
-        AstNode* nodeFromJson (TRI_json_t const*);
-
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief traverse the AST, using pre- and post-order visitors
 ////////////////////////////////////////////////////////////////////////////////
@@ -77,6 +77,14 @@ namespace triagens {
           return _parameters;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the parameters as passed by the user
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t const* json () const {
+          return _json;
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
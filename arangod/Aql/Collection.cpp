@@ -268,7 +268,7 @@ void Collection::fillIndexesCoordinator () const {
     for (size_t i = 0; i < n; ++i) {
       TRI_json_t const* v = TRI_LookupArrayJson(json, i);
       if (v != nullptr) {
-        indexes.emplace_back(new Index(v));
+        indexes.emplace_back(new Index(v, (*collectionInfo).type()));
       }
     }
   }
@@ -328,7 +328,7 @@ void Collection::fillIndexesDBServer () const {
         }
       }
 
-      auto idx = new Index(v);
+      auto idx = new Index(v, document->_info._type);
       // assign the found local index
       idx->setInternals(data);
 
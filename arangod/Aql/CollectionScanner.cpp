@@ -28,6 +28,8 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "CollectionScanner.h"
+#include "Basics/Barrier.h"
+#include "Basics/ThreadPool.h"
 
 using namespace triagens::aql;
 
@@ -120,6 +122,162 @@ void LinearCollectionScanner::reset () {
   position = 0;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                  struct ParallelCollectionScanner
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+ParallelCollectionScanner::ParallelCollectionScanner (triagens::arango::AqlTransaction* trx,
+                                                      TRI_transaction_collection_t* trxCollection,
+                                                      triagens::basics::ThreadPool* pool,
+                                                      std::vector<Filter> const& filters) 
+  : CollectionScanner(trx, trxCollection),
+    pool(pool),
+    filters(filters),
+    scanned(0),
+    exhausted(false) {
+
+  TRI_ASSERT(! this->filters.empty());
+}
+
+int ParallelCollectionScanner::scan (std::vector<TRI_doc_mptr_copy_t>& docs,
+                                     size_t batchSize) {
+  size_t const n = filters.size();
+
+  // each part covers batchSize slots of the primary index, so it yields at
+  // most batchSize documents
+  TRI_voc_size_t const numSlots = static_cast<TRI_voc_size_t>(batchSize * n);
+
+  // an empty result ends the scan, so go on until a document passes
+  while (docs.empty() && ! exhausted) {
+    std::vector<std::vector<TRI_doc_mptr_copy_t>> results(n);
+    exhausted = true;
+
+    int res = trx->readSlots(trxCollection,
+                             position,
+                             numSlots,
+                             [&] (void* const* beg, void* const* end) -> void {
+      exhausted = (static_cast<TRI_voc_size_t>(end - beg) < numSlots);
+      scanParts(beg, end, results);
+    }, &totalCount);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+
+    for (auto const& it : results) {
+      docs.insert(docs.end(), it.begin(), it.end());
+    }
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+void ParallelCollectionScanner::reset () {
+  position = 0;
+  exhausted = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scans the slots in parallel, one part per filter. must be called
+/// while the collection is read-locked
+////////////////////////////////////////////////////////////////////////////////
+
+void ParallelCollectionScanner::scanParts (void* const* beg,
+                                           void* const* end,
+                                           std::vector<std::vector<TRI_doc_mptr_copy_t>>& results) {
+  size_t const n = filters.size();
+  size_t const length = static_cast<size_t>(end - beg);
+  size_t const partLength = (length + n - 1) / n;
+
+  std::atomic<int> result(TRI_ERROR_NO_ERROR);
+  std::atomic<uint64_t> total(0);
+
+  auto scanPart = [&] (size_t i) -> void {
+    int res = TRI_ERROR_NO_ERROR;
+
+    try {
+      void* const* ptr = beg + (std::min)(i * partLength, length);
+      void* const* partEnd = beg + (std::min)((i + 1) * partLength, length);
+      auto& filter = filters[i];
+      auto& docs = results[i];
+      uint64_t count = 0;
+
+      for (; ptr < partEnd; ++ptr) {
+        if (*ptr != nullptr) {
+          auto d = static_cast<TRI_doc_mptr_t const*>(*ptr);
+          ++count;
+
+          if (filter(d)) {
+            docs.emplace_back(*d);
+          }
+        }
+      }
+
+      total += count;
+    }
+    catch (triagens::basics::Exception const& ex) {
+      res = ex.code();
+    }
+    catch (...) {
+      res = TRI_ERROR_INTERNAL;
+    }
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      int expected = TRI_ERROR_NO_ERROR;
+      result.compare_exchange_strong(expected, res, std::memory_order_acquire);
+    }
+  };
+
+  {
+    triagens::basics::Barrier barrier(n - 1);
+
+    // scan threads must come first, otherwise this thread will block the loop
+    // and prevent distribution to threads
+    for (size_t i = 0; i < n - 1; ++i) {
+      auto task = [&scanPart, &barrier, i] () -> void {
+        triagens::arango::TransactionBase scope(true);
+        scanPart(i);
+        barrier.join();
+      };
+
+      if (pool == nullptr) {
+        scanPart(i);
+        barrier.join();
+        continue;
+      }
+
+      try {
+        pool->enqueue(task);
+      }
+      catch (...) {
+        int expected = TRI_ERROR_NO_ERROR;
+        result.compare_exchange_strong(expected, TRI_ERROR_INTERNAL, std::memory_order_acquire);
+
+        barrier.join();
+      }
+    }
+
+    // the last part is scanned by this thread
+    scanPart(n - 1);
+
+    // barrier waits here until all threads have joined
+  }
+
+  scanned += total.load();
+
+  if (result.load() != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION(result.load());
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
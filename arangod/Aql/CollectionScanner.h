@@ -36,6 +36,12 @@
 #include "VocBase/transaction.h"
 #include "VocBase/vocbase.h"
 
+namespace triagens {
+  namespace basics {
+    class ThreadPool;
+  }
+}
+
 namespace triagens {
   namespace aql {
 
@@ -109,6 +115,49 @@ namespace triagens {
       void reset () override;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                  struct ParallelCollectionScanner
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief linear scan that filters the documents while scanning
+///
+/// Each call splits the next slots of the primary index into one part per
+/// filter. All parts but the last are scanned by threads of the pool, the
+/// last one by the calling thread. Part i is filtered with filter i only, so
+/// a filter is never called concurrently. The results of the parts are
+/// concatenated in order, so documents are returned in the same order as by
+/// the LinearCollectionScanner.
+////////////////////////////////////////////////////////////////////////////////
+
+    struct ParallelCollectionScanner final : public CollectionScanner {
+
+      typedef std::function<bool(TRI_doc_mptr_t const*)> Filter;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+  
+      ParallelCollectionScanner (triagens::arango::AqlTransaction*,
+                                 TRI_transaction_collection_t*,
+                                 triagens::basics::ThreadPool*,
+                                 std::vector<Filter> const&);
+
+      int scan (std::vector<TRI_doc_mptr_copy_t>&,
+                size_t) override;
+      
+      void reset () override;
+
+      void scanParts (void* const*,
+                      void* const*,
+                      std::vector<std::vector<TRI_doc_mptr_copy_t>>&);
+
+      triagens::basics::ThreadPool* pool;
+      std::vector<Filter> filters;
+      uint64_t scanned;
+      bool exhausted;
+    };
+
   }
 }
 
@@ -31,14 +31,17 @@
 #include "Basics/ScopeGuard.h"
 #include "Basics/StringUtils.h"
 #include "Basics/StringBuffer.h"
+#include "Basics/ThreadPool.h"
 #include "Basics/json-utilities.h"
 #include "Basics/Exceptions.h"
 #include "Dispatcher/DispatcherThread.h"
+#include "GeoIndex/geo-index.h"
 #include "Cluster/ClusterMethods.h"
 #include "HashIndex/hash-index.h"
 #include "V8/v8-globals.h"
 #include "VocBase/edge-collection.h"
 #include "VocBase/index.h"
+#include "VocBase/server.h"
 #include "VocBase/vocbase.h"
 
 using namespace std;
@@ -647,7 +650,7 @@ int ExecutionBlock::getOrSkipSome (size_t atLeast,
           more.release();
         }
         skipped += cur->size() - _pos;
-        delete cur;
+        returnBlock(cur);
         _buffer.pop_front();
         _pos = 0;
       }
@@ -663,7 +666,7 @@ int ExecutionBlock::getOrSkipSome (size_t atLeast,
           collector.emplace_back(cur);
         }
         else {
-          delete cur;
+          returnBlock(cur);
         }
         _buffer.pop_front();
         _pos = 0;
@@ -815,11 +818,41 @@ int SingletonBlock::getOrSkipSome (size_t,   // atLeast,
 // --SECTION--                                    class EnumerateCollectionBlock
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determines the lazily computed properties and values of all nodes
+/// of an expression, so that copies of it can be executed concurrently
+////////////////////////////////////////////////////////////////////////////////
+
+static void PrepareConcurrentExecution (AstNode const* node) {
+  node->isSimple();
+  node->canThrow();
+  node->isDeterministic();
+
+  if (node->isConstant() &&
+      (node->type == NODE_TYPE_VALUE ||
+       node->type == NODE_TYPE_ARRAY ||
+       node->type == NODE_TYPE_OBJECT)) {
+    if (node->computeJson() == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+  }
+
+  size_t const n = node->numMembers();
+
+  for (size_t i = 0; i < n; ++i) {
+    PrepareConcurrentExecution(node->getMember(i));
+  }
+}
+
 EnumerateCollectionBlock::EnumerateCollectionBlock (ExecutionEngine* engine,
                                                     EnumerateCollectionNode const* ep)
   : ExecutionBlock(engine, ep),
     _collection(ep->_collection),
     _scanner(nullptr),
+    _parallelScanner(nullptr),
+    _filters(),
+    _filterItems(),
+    _filterVariables(),
     _posInDocuments(0),
     _random(ep->_random),
     _mustStoreResult(true) {
@@ -833,6 +866,47 @@ EnumerateCollectionBlock::EnumerateCollectionBlock (ExecutionEngine* engine,
     // random scan
     _scanner = new RandomCollectionScanner(_trx, trxCollection);
   }
+  else if (ep->_filter != nullptr) {
+    // linear scan evaluating the filter, split into one part for each scan
+    // thread plus one for this thread
+    auto pool = static_cast<triagens::basics::ThreadPool*>(_trx->vocbase()->_server->_scanPool);
+
+    // analyze a copy of the filter here and not in a scan thread. a V8 filter
+    // can only be evaluated in this thread, so the scan is not split then
+    _filters.emplace_back(ep->_filter->clone());
+
+    if (_filters.back()->isV8()) {
+      pool = nullptr;
+    }
+
+    size_t const n = (pool == nullptr ? 1 : pool->size() + 1);
+
+    PrepareConcurrentExecution(ep->_filter->node());
+    _filterVariables.emplace_back(const_cast<Variable*>(ep->_outVariable));
+
+    std::vector<ParallelCollectionScanner::Filter> filters;
+    filters.reserve(n);
+    _filters.reserve(n);
+    _filterItems.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+      if (i > 0) {
+        _filters.emplace_back(ep->_filter->clone());
+        // analyze the copy
+        _filters.back()->isV8();
+      }
+
+      _filterItems.emplace_back(new AqlItemBlock(1, 1));
+      _filterItems.back()->setDocumentCollection(0, _trx->documentCollection(_collection->cid()));
+
+      filters.emplace_back([this, i] (TRI_doc_mptr_t const* document) -> bool {
+        return evaluateFilter(i, document);
+      });
+    }
+
+    _parallelScanner = new ParallelCollectionScanner(_trx, trxCollection, pool, filters);
+    _scanner = _parallelScanner;
+  }
   else {
     // default: linear scan
     _scanner = new LinearCollectionScanner(_trx, trxCollection);
@@ -841,6 +915,36 @@ EnumerateCollectionBlock::EnumerateCollectionBlock (ExecutionEngine* engine,
 
 EnumerateCollectionBlock::~EnumerateCollectionBlock () {
   delete _scanner;
+
+  for (auto it : _filters) {
+    delete it;
+  }
+
+  for (auto it : _filterItems) {
+    delete it;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief evaluate the filter for a document
+////////////////////////////////////////////////////////////////////////////////
+
+bool EnumerateCollectionBlock::evaluateFilter (size_t part,
+                                               TRI_doc_mptr_t const* document) {
+  // the document is the only value in the block
+  static std::vector<RegisterId> const regs{ 0 };
+
+  auto items = _filterItems[part];
+  items->setShaped(0, 0, static_cast<TRI_df_marker_t const*>(document->getDataPtr()));
+
+  TRI_document_collection_t const* myCollection = nullptr;
+  AqlValue result = _filters[part]->execute(_trx, items, 0, _filterVariables, regs, &myCollection);
+  bool const matches = result.isTrue();
+  result.destroy();
+
+  items->eraseValue(0, 0);
+
+  return matches;
 }
 
 bool EnumerateCollectionBlock::moreDocuments (size_t hint) {
@@ -862,12 +966,23 @@ bool EnumerateCollectionBlock::moreDocuments (size_t hint) {
   if (res != TRI_ERROR_NO_ERROR) {
     THROW_ARANGO_EXCEPTION(res);
   }
+
+  if (_parallelScanner != nullptr) {
+    // documents that did not pass the filter were scanned, too
+    int64_t const scanned = static_cast<int64_t>(_parallelScanner->scanned);
+    _parallelScanner->scanned = 0;
+
+    _engine->_stats.scannedFull += scanned;
+    _engine->_stats.filtered += scanned - static_cast<int64_t>(newDocs.size());
+  }
   
   if (newDocs.empty()) {
     return false;
   }
 
-  _engine->_stats.scannedFull += static_cast<int64_t>(newDocs.size());
+  if (_parallelScanner == nullptr) {
+    _engine->_stats.scannedFull += static_cast<int64_t>(newDocs.size());
+  }
 
   _documents.swap(newDocs);
   _posInDocuments = 0;
@@ -1031,7 +1146,7 @@ size_t EnumerateCollectionBlock::skipSome (size_t atLeast, size_t atMost) {
         initializeDocuments();
         if (++_pos >= cur->size()) {
           _buffer.pop_front();  // does not throw
-          delete cur;
+          returnBlock(cur);
           _pos = 0;
         }
       }
@@ -1052,6 +1167,9 @@ IndexRangeBlock::IndexRangeBlock (ExecutionEngine* engine,
                                   IndexRangeNode const* en)
   : ExecutionBlock(engine, en),
     _collection(en->collection()),
+    _indexOnly(en->isIndexOnly()),
+    _indexAttributes(),
+    _indexValues(),
     _posInDocs(0),
     _anyBoundVariable(false),
     _skiplistIterator(nullptr),
@@ -1101,10 +1219,38 @@ IndexRangeBlock::IndexRangeBlock (ExecutionEngine* engine,
     _anyBoundVariable |= ! isConstant;
     _allBoundsConstant.push_back(isConstant); // note: emplace_back() is not supported in C++11 but only from C++14
   }
+
+  if (_indexOnly) {
+    auto const& fields = en->_index->fields;
+    _indexAttributes.reserve(fields.size());
+
+    for (auto const& field : fields) {
+      bool contained = false;
+
+      // an attribute inside another indexed attribute is already part of 
+      // that attribute's value
+      for (auto const& other : fields) {
+        if (other.size() < field.size() && 
+            field.compare(0, other.size(), other) == 0 &&
+            field[other.size()] == '.') {
+          contained = true;
+          break;
+        }
+      }
+
+      if (contained) {
+        _indexAttributes.emplace_back();
+      }
+      else {
+        _indexAttributes.emplace_back(triagens::basics::StringUtils::split(field, '.'));
+      }
+    }
+  }
 }
 
 IndexRangeBlock::~IndexRangeBlock () {
   destroyHashIndexSearchValues();
+  freeIndexValues();
 
   for (auto e : _allVariableBoundExpressions) {
     delete e;
@@ -1516,6 +1662,71 @@ bool IndexRangeBlock::initRanges () {
   LEAVE_BLOCK;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief builds an object with the indexed attributes from their shaped
+/// values, one value for each indexed attribute
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* IndexRangeBlock::buildIndexValue (TRI_shaped_json_t const* values) const {
+  TRI_shaper_t* shaper = _collection->documentCollection()->getShaper(); 
+
+  Json result(Json::Object, _indexAttributes.size());
+  size_t const n = _indexAttributes.size();
+
+  for (size_t i = 0; i < n; ++i) {
+    auto const& path = _indexAttributes[i];
+
+    if (path.empty()) {
+      // contained in another indexed attribute
+      continue;
+    }
+
+    // find or create the sub-objects for nested attributes
+    TRI_json_t* parent = result.json();
+
+    for (size_t j = 0; j < path.size() - 1; ++j) {
+      TRI_json_t* sub = TRI_LookupObjectJson(parent, path[j].c_str());
+
+      if (sub == nullptr) {
+        sub = TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE);
+
+        if (sub == nullptr) {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+
+        TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, parent, path[j].c_str(), sub);
+        sub = TRI_LookupObjectJson(parent, path[j].c_str());
+      }
+
+      parent = sub;
+    }
+
+    TRI_json_t* value = TRI_JsonShapedJson(shaper, &values[i]);
+
+    if (value == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, parent, path.back().c_str(), value);
+  }
+
+  return result.steal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief frees the values of an index-only scan
+////////////////////////////////////////////////////////////////////////////////
+
+void IndexRangeBlock::freeIndexValues () {
+  for (auto& it : _indexValues) {
+    if (it != nullptr) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it);
+    }
+  }
+
+  _indexValues.clear();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // @brief: sorts the index range conditions and resets _posInRanges to 0
 ////////////////////////////////////////////////////////////////////////////////
@@ -1771,6 +1982,8 @@ bool IndexRangeBlock::readIndex (size_t atMost) {
   else { 
     _documents.clear();
   }
+
+  freeIndexValues();
   
   auto en = static_cast<IndexRangeNode const*>(getPlanNode());
   
@@ -1852,7 +2065,7 @@ AqlItemBlock* IndexRangeBlock::getSome (size_t atLeast,
       if (! readIndex(atMost)) { //no more output from this version of the index
         if (++_pos >= cur->size()) {
           _buffer.pop_front();  // does not throw
-          delete cur;
+          returnBlock(cur);
           _pos = 0;
         }
         if (_buffer.empty()) {
@@ -1880,7 +2093,7 @@ AqlItemBlock* IndexRangeBlock::getSome (size_t atLeast,
 
     if (toSend > 0) {
 
-      res.reset(new AqlItemBlock(toSend,
+      res.reset(requestBlock(toSend,
             getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
       // automatically freed should we throw
@@ -1889,9 +2102,11 @@ AqlItemBlock* IndexRangeBlock::getSome (size_t atLeast,
       // only copy 1st row of registers inherited from previous frame(s)
       inheritRegisters(cur, res.get(), _pos);
 
-      // set our collection for our output register
-      res->setDocumentCollection(static_cast<triagens::aql::RegisterId>(curRegs),
-          _trx->documentCollection(_collection->cid()));
+      if (! _indexOnly) {
+        // set our collection for our output register
+        res->setDocumentCollection(static_cast<triagens::aql::RegisterId>(curRegs),
+            _trx->documentCollection(_collection->cid()));
+      }
 
       for (size_t j = 0; j < toSend; j++) {
         if (j > 0) {
@@ -1903,6 +2118,21 @@ AqlItemBlock* IndexRangeBlock::getSome (size_t atLeast,
           }
         }
 
+        if (_indexOnly) {
+          // hand over the object with the indexed attributes
+          AqlValue a(new Json(TRI_UNKNOWN_MEM_ZONE, _indexValues[_posInDocs]));
+          _indexValues[_posInDocs++] = nullptr;
+
+          try {
+            res->setValue(j, static_cast<triagens::aql::RegisterId>(curRegs), a);
+          }
+          catch (...) {
+            a.destroy();
+            throw;
+          }
+          continue;
+        }
+
         // The result is in the first variable of this depth,
         // we do not need to do a lookup in getPlanNode()->_registerPlan->varInfo,
         // but can just take cur->getNrRegs() as registerId:
@@ -2286,6 +2516,24 @@ void IndexRangeBlock::readHashIndex (size_t atMost) {
     TRI_LookupHashIndex(idx, &_hashIndexSearchValue, _documents, _hashNextElement, atMost);
     size_t const numRead = _documents.size() - n;
 
+    if (_indexOnly && numRead > 0) {
+      // a hash index lookup is an equality lookup on all indexed attributes,
+      // so their values are the ones searched for
+      Json value(TRI_UNKNOWN_MEM_ZONE, buildIndexValue(_hashIndexSearchValue._values));
+
+      _indexValues.reserve(_documents.size());
+
+      for (size_t i = 0; i < numRead; ++i) {
+        TRI_json_t* copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value.json());
+
+        if (copy == nullptr) {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+
+        _indexValues.emplace_back(copy);
+      }
+    }
+
     _engine->_stats.scannedIndex += static_cast<int64_t>(numRead);
     nrSent += numRead;
 
@@ -2455,6 +2703,27 @@ void IndexRangeBlock::readSkiplistIndex (size_t atMost) {
         _documents.emplace_back(*(indexElement->_document));
         ++nrSent;
         ++_engine->_stats.scannedIndex;
+
+        if (_indexOnly) {
+          // small values are stored in the index element itself, only larger
+          // ones are read from the document
+          size_t const n = _indexAttributes.size();
+          std::vector<TRI_shaped_json_t> values(n);
+          TRI_shaped_sub_t const* subObjects = SkiplistIndex_Subobjects(indexElement);
+
+          for (size_t i = 0; i < n; ++i) {
+            char const* ptr;
+            size_t length;
+            TRI_InspectShapedSub(&subObjects[i], indexElement->_document, ptr, length);
+
+            values[i]._sid = subObjects[i]._sid;
+            values[i]._data.data = const_cast<char*>(ptr);
+            values[i]._data.length = static_cast<uint32_t>(length);
+          }
+
+          _indexValues.reserve(_documents.size());
+          _indexValues.emplace_back(buildIndexValue(values.data()));
+        }
       }
     }
   }
@@ -2468,6 +2737,332 @@ void IndexRangeBlock::readSkiplistIndex (size_t atMost) {
   LEAVE_BLOCK;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                               class GeoIndexBlock
+// -----------------------------------------------------------------------------
+
+GeoIndexBlock::GeoIndexBlock (ExecutionEngine* engine,
+                              GeoIndexNode const* en)
+  : ExecutionBlock(engine, en),
+    _collection(const_cast<Collection*>(en->collection())),
+    _index(en->getIndex()->getInternals()),
+    _documents(),
+    _posInDocuments(0),
+    _unindexedDone(false),
+    _indexDone(false),
+    _requested(0),
+    _produced(0),
+    _lastDistance(-1.0),
+    _lastDocuments(),
+    _mustStoreResult(true) {
+
+  auto trxCollection = _trx->trxCollection(_collection->cid());
+  if (trxCollection != nullptr) {
+    _trx->orderBarrier(trxCollection);
+  }
+}
+
+GeoIndexBlock::~GeoIndexBlock () {
+}
+
+int GeoIndexBlock::initialize () {
+  auto ep = static_cast<GeoIndexNode const*>(_exeNode);
+  _mustStoreResult = ep->isVarUsedLater(ep->_outVariable);
+  
+  return ExecutionBlock::initialize();
+}
+
+int GeoIndexBlock::initializeCursor (AqlItemBlock* items, 
+                                     size_t pos) {
+  int res = ExecutionBlock::initializeCursor(items, pos);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  initializeDocuments();
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialize fetching of documents
+////////////////////////////////////////////////////////////////////////////////
+
+void GeoIndexBlock::initializeDocuments () {
+  _documents.clear();
+  _posInDocuments = 0;
+  _unindexedDone = false;
+  _indexDone = false;
+  _requested = 0;
+  _produced = 0;
+  _lastDistance = -1.0;
+  _lastDocuments.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief continue fetching of documents
+////////////////////////////////////////////////////////////////////////////////
+
+bool GeoIndexBlock::moreDocuments (size_t hint) {
+  throwIfKilled(); // check if we were aborted
+
+  _documents.clear();
+  _posInDocuments = 0;
+
+  if (! _unindexedDone) {
+    _unindexedDone = true;
+    readUnindexed();
+
+    if (! _documents.empty()) {
+      return true;
+    }
+  }
+
+  while (! _indexDone) {
+    readIndex(hint);
+
+    if (! _documents.empty()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetch the documents that are not contained in the index. the index
+/// keeps track of them, so no scan is needed
+////////////////////////////////////////////////////////////////////////////////
+
+void GeoIndexBlock::readUnindexed () {
+  auto const& unindexed = TRI_UnindexedGeoIndex(_index);
+
+  _documents.reserve(unindexed.size());
+
+  for (auto const& mptr : unindexed) {
+    _documents.emplace_back(*mptr);
+  }
+
+  _engine->_stats.scannedIndex += static_cast<int64_t>(_documents.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetch the next documents from the index
+///
+/// the index can only return the nearest documents up to a number, so it is
+/// asked for a growing number of documents, and the documents that were
+/// already produced are left out
+////////////////////////////////////////////////////////////////////////////////
+
+void GeoIndexBlock::readIndex (size_t hint) {
+  auto ep = static_cast<GeoIndexNode const*>(_exeNode);
+  size_t const count = TRI_CountGeoIndex(_index);
+
+  // asking for more documents than there are tells that the index is exhausted
+  _requested = (std::max)(_produced + (std::max)(hint, static_cast<size_t>(1)), _requested * 2);
+  _requested = (std::min)(_requested, count + 1);
+
+  GeoCoordinates* cors = nullptr;
+
+  if (count > 0) {
+    cors = TRI_NearestGeoIndex(_index, ep->_latitude, ep->_longitude, _requested);
+  }
+
+  if (cors == nullptr) {
+    _indexDone = true;
+    return;
+  }
+
+  try {
+    size_t const n = cors->length;
+
+    if (n < _requested) {
+      _indexDone = true;
+    }
+
+    // the index returns the documents in no particular order
+    std::vector<size_t> order;
+    order.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+      order.emplace_back(i);
+    }
+
+    std::sort(order.begin(), order.end(), [&cors] (size_t lhs, size_t rhs) {
+      return cors->distances[lhs] < cors->distances[rhs];
+    });
+
+    // the distances of the index may differ from the ones of DISTANCE() by 
+    // rounding errors, the filter on the distance is kept anyway
+    double const radius = ep->_radius * (1.0 + 1e-9);
+
+    for (auto i : order) {
+      double const distance = cors->distances[i];
+      void const* data = cors->coordinates[i].data;
+
+      if (ep->_radius >= 0.0 && distance > radius) {
+        _indexDone = true;
+        break;
+      }
+
+      if (distance < _lastDistance ||
+          (distance == _lastDistance && _lastDocuments.find(data) != _lastDocuments.end())) {
+        // already produced
+        continue;
+      }
+
+      if (distance != _lastDistance) {
+        _lastDistance = distance;
+        _lastDocuments.clear();
+      }
+
+      _lastDocuments.emplace(data);
+      _documents.emplace_back(*static_cast<TRI_doc_mptr_t const*>(data));
+      ++_produced;
+    }
+  }
+  catch (...) {
+    GeoIndex_CoordinatesFree(cors);
+    throw;
+  }
+
+  GeoIndex_CoordinatesFree(cors);
+
+  _engine->_stats.scannedIndex += static_cast<int64_t>(_documents.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSome
+////////////////////////////////////////////////////////////////////////////////
+
+AqlItemBlock* GeoIndexBlock::getSome (size_t, // atLeast,
+                                      size_t atMost) {
+  if (_done) {
+    return nullptr;
+  }
+
+  if (_buffer.empty()) {
+    size_t toFetch = (std::min)(DefaultBatchSize, atMost);
+    if (! ExecutionBlock::getBlock(toFetch, toFetch)) {
+      _done = true;
+      return nullptr;
+    }
+    _pos = 0;           // this is in the first block
+    initializeDocuments();
+  }
+
+  // If we get here, we do have _buffer.front()
+  AqlItemBlock* cur = _buffer.front();
+  size_t const curRegs = cur->getNrRegs();
+
+  if (_posInDocuments >= _documents.size()) {
+    if (! moreDocuments(atMost)) {
+      _done = true;
+      return nullptr;
+    }
+  }
+
+  size_t available = _documents.size() - _posInDocuments;
+  size_t toSend = (std::min)(atMost, available);
+  RegisterId nrRegs = getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()];
+
+  std::unique_ptr<AqlItemBlock> res(requestBlock(toSend, nrRegs));
+  // automatically freed if we throw
+  TRI_ASSERT(curRegs <= res->getNrRegs());
+
+  // only copy 1st row of registers inherited from previous frame(s)
+  inheritRegisters(cur, res.get(), _pos);
+
+  // set our collection for our output register
+  res->setDocumentCollection(static_cast<triagens::aql::RegisterId>(curRegs), _trx->documentCollection(_collection->cid()));
+
+  for (size_t j = 0; j < toSend; j++) {
+    if (j > 0) {
+      // re-use already copied aqlvalues
+      for (RegisterId i = 0; i < curRegs; i++) {
+        res->setValue(j, i, res->getValueReference(0, i));
+      }
+    }
+
+    if (_mustStoreResult) {
+      res->setShaped(j, 
+                     static_cast<triagens::aql::RegisterId>(curRegs),
+                     reinterpret_cast<TRI_df_marker_t const*>(_documents[_posInDocuments].getDataPtr()));
+    }
+
+    ++_posInDocuments;
+  }
+
+  // Advance read position:
+  if (_posInDocuments >= _documents.size()) {
+    if (! moreDocuments(atMost)) {
+      // nothing more to read, re-initialize fetching of documents
+      initializeDocuments();
+
+      if (++_pos >= cur->size()) {
+        _buffer.pop_front();  // does not throw
+        returnBlock(cur);
+        _pos = 0;
+      }
+    }
+  }
+
+  // Clear out registers no longer needed later:
+  clearRegisters(res.get());
+
+  return res.release();
+}
+
+size_t GeoIndexBlock::skipSome (size_t atLeast, size_t atMost) {
+  size_t skipped = 0;
+
+  if (_done) {
+    return skipped;
+  }
+
+  while (skipped < atLeast) {
+    if (_buffer.empty()) {
+      size_t toFetch = (std::min)(DefaultBatchSize, atMost);
+      if (! getBlock(toFetch, toFetch)) {
+        _done = true;
+        return skipped;
+      }
+      _pos = 0;           // this is in the first block
+      initializeDocuments();
+    }
+
+    // if we get here, then _buffer.front() exists
+    AqlItemBlock* cur = _buffer.front();
+
+    if (_posInDocuments >= _documents.size()) {
+      if (! moreDocuments(atMost)) {
+        _done = true;
+        return skipped;
+      }
+    }
+
+    if (atMost >= skipped + _documents.size() - _posInDocuments) {
+      skipped += _documents.size() - _posInDocuments;
+
+      if (! moreDocuments(atMost - skipped)) {
+        // nothing more to read, re-initialize fetching of documents
+        initializeDocuments();
+        if (++_pos >= cur->size()) {
+          _buffer.pop_front();  // does not throw
+          returnBlock(cur);
+          _pos = 0;
+        }
+      }
+    }
+    else {
+      _posInDocuments += atMost - skipped;
+      skipped = atMost;
+    }
+  }
+  return skipped;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                          class EnumerateListBlock
 // -----------------------------------------------------------------------------
@@ -2592,7 +3187,7 @@ AqlItemBlock* EnumerateListBlock::getSome (size_t, size_t atMost) {
       size_t toSend = (std::min)(atMost, sizeInVar - _index);
 
       // create the result
-      res.reset(new AqlItemBlock(toSend, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+      res.reset(requestBlock(toSend, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
       inheritRegisters(cur, res.get(), _pos);
 
@@ -3251,7 +3846,7 @@ int FilterBlock::getOrSkipSome (size_t atLeast,
           collector.emplace_back(cur);
         }
         else {
-          delete cur;
+          returnBlock(cur);
         }
         _buffer.pop_front();
         _chosen.clear();
@@ -3443,7 +4038,7 @@ int SortedAggregateBlock::getOrSkipSome (size_t atLeast,
   AqlItemBlock* cur = _buffer.front();
 
   if (! skipping) {
-    res.reset(new AqlItemBlock(atMost, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
+    res.reset(requestBlock(atMost, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
     TRI_ASSERT(cur->getNrRegs() <= res->getNrRegs());
     inheritRegisters(cur, res.get(), _pos);
@@ -4296,7 +4891,7 @@ AqlItemBlock* ReturnBlock::getSome (size_t atLeast,
   TRI_ASSERT(it != ep->getRegisterPlan()->varInfo.end());
   RegisterId const registerId = it->second.registerId;
 
-  std::unique_ptr<AqlItemBlock> stripped(new AqlItemBlock(n, 1));
+  std::unique_ptr<AqlItemBlock> stripped(requestBlock(n, 1));
 
   for (size_t i = 0; i < n; i++) {
     auto a = res->getValueReference(i, registerId);
@@ -4327,8 +4922,9 @@ AqlItemBlock* ReturnBlock::getSome (size_t atLeast,
   }
 
   stripped->setDocumentCollection(0, res->getDocumentCollection(registerId));
-  delete res.get();
-  res.release();
+
+  AqlItemBlock* block = res.release();
+  returnBlock(block);
 
   return stripped.release();
 }
@@ -4726,15 +5322,21 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
 
   auto trxCollection = _trx->trxCollection(_collection->cid());
 
-  TRI_doc_mptr_copy_t nptr;
   bool const isEdgeCollection = _collection->isEdgeCollection();
   bool const producesOutput = (ep->_outVariableNew != nullptr);
-         
-  // initialize an empty edge container
-  TRI_document_edge_t edge = { 0, nullptr, 0, nullptr };
-
-  std::string from;
-  std::string to;
+  bool const ignoreErrors = ep->_options.ignoreErrors;
+
+  // the documents of a block are inserted at once. without ignoreErrors, the
+  // query fails at the first document that cannot be inserted, so no document
+  // after it must be inserted
+  std::vector<Json> jsons;
+  std::vector<TRI_json_t const*> documents;
+  std::vector<TRI_document_edge_t> edges;
+  std::vector<TRI_document_edge_t const*> edgePointers;
+  std::vector<std::string> keys;
+  std::vector<size_t> rows;
+  std::vector<int> errorCodes;
+  std::vector<TRI_doc_bulk_operation_t> results;
 
   result.reset(new AqlItemBlock(count, getPlanNode()->getRegisterPlan()->nrRegs[getPlanNode()->getDepth()]));
 
@@ -4750,22 +5352,40 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
     size_t const n = res->size();
     
     throwIfKilled(); // check if we were aborted
+
+    jsons.clear();
+    documents.clear();
+    edges.clear();
+    edgePointers.clear();
+    keys.clear();
+    rows.clear();
+    errorCodes.assign(n, TRI_ERROR_NO_ERROR);
+
+    // the edges and keys must not be moved once they are referenced
+    jsons.reserve(n);
+    edges.reserve(n);
+    keys.reserve(2 * n);
     
-    // loop over the complete block
+    // loop over the complete block, collecting the documents
     for (size_t i = 0; i < n; ++i) {
       AqlValue a = res->getValue(i, registerId);
       
       // only copy 1st row of registers inherited from previous frame(s)
-      inheritRegisters(res, result.get(), i, dstRow);
+      inheritRegisters(res, result.get(), i, dstRow + i);
 
       int errorCode = TRI_ERROR_NO_ERROR;
 
+      // initialize an empty edge container
+      TRI_document_edge_t edge = { 0, nullptr, 0, nullptr };
+
       if (a.isObject()) {
         // value is an array
         
         if (isEdgeCollection) {
           // array must have _from and _to attributes
           TRI_json_t const* json;
+          std::string from;
+          std::string to;
 
           Json member(a.extractObjectMember(_trx, document, TRI_VOC_ATTRIBUTE_FROM, false, _buffer));
           json = member.json();
@@ -4787,6 +5407,13 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
               errorCode = TRI_ERROR_ARANGO_DOCUMENT_HANDLE_BAD;
             }
           }
+
+          if (errorCode == TRI_ERROR_NO_ERROR) {
+            keys.emplace_back(from);
+            edge._fromKey = (TRI_voc_key_t) keys.back().c_str();
+            keys.emplace_back(to);
+            edge._toKey = (TRI_voc_key_t) keys.back().c_str();
+          }
         }
       }
       else {
@@ -4794,31 +5421,54 @@ AqlItemBlock* InsertBlock::work (std::vector<AqlItemBlock*>& blocks) {
       }
 
       if (errorCode == TRI_ERROR_NO_ERROR) {
-        TRI_doc_mptr_copy_t mptr;
-        auto json = a.toJson(_trx, document);
+        jsons.emplace_back(a.toJson(_trx, document));
 
         if (isEdgeCollection) {
           // edge
-          edge._fromKey = (TRI_voc_key_t) from.c_str();
-          edge._toKey = (TRI_voc_key_t) to.c_str();
-          errorCode = _trx->create(trxCollection, &mptr, json.json(), &edge, ep->_options.waitForSync);
+          edges.emplace_back(edge);
+          edgePointers.push_back(&edges.back());
         }
-        else {
-          // document
-          errorCode = _trx->create(trxCollection, &mptr, json.json(), nullptr, ep->_options.waitForSync);
+
+        rows.push_back(i);
+      }
+      else {
+        errorCodes[i] = errorCode;
+
+        if (! ignoreErrors) {
+          // handleResult() will throw for this row
+          break;
         }
+      }
+    }
 
-        if (producesOutput && errorCode == TRI_ERROR_NO_ERROR) {
-          result->setValue(dstRow,
+    if (! rows.empty()) {
+      for (auto const& json : jsons) {
+        documents.push_back(json.json());
+      }
+
+      int errorCode = _trx->createMany(trxCollection, documents, edgePointers, results, ep->_options.waitForSync, ! ignoreErrors);
+
+      if (errorCode != TRI_ERROR_NO_ERROR) {
+        // not all documents were processed
+        THROW_ARANGO_EXCEPTION(errorCode);
+      }
+
+      for (size_t j = 0; j < rows.size(); ++j) {
+        errorCodes[rows[j]] = results[j].errorCode;
+
+        if (producesOutput && results[j].errorCode == TRI_ERROR_NO_ERROR) {
+          result->setValue(dstRow + rows[j],
                            _outRegNew,
-                           AqlValue(reinterpret_cast<TRI_df_marker_t const*>(mptr.getDataPtr())));
+                           AqlValue(reinterpret_cast<TRI_df_marker_t const*>(results[j].mptr.getDataPtr())));
         }
       }
+    }
 
-      handleResult(errorCode, ep->_options.ignoreErrors);
-
-      ++dstRow; 
+    for (size_t i = 0; i < n; ++i) {
+      handleResult(errorCodes[i], ignoreErrors);
     }
+
+    dstRow += n;
     // done with a block
 
     // now free it already
@@ -5694,7 +6344,7 @@ AqlItemBlock* GatherBlock::getSome (size_t atLeast, size_t atMost) {
   AqlItemBlock* example =_gatherBlockBuffer.at(index).front();
   size_t nrRegs = example->getNrRegs();
 
-  std::unique_ptr<AqlItemBlock> res(new AqlItemBlock(toSend,
+  std::unique_ptr<AqlItemBlock> res(requestBlock(toSend,
         static_cast<triagens::aql::RegisterId>(nrRegs)));  
   // automatically deleted if things go wrong
     
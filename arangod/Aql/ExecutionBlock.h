@@ -502,6 +502,14 @@ namespace triagens {
 
         bool moreDocuments (size_t hint);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief evaluate the filter for a document, using the filter copy of a
+/// part of a parallel scan
+////////////////////////////////////////////////////////////////////////////////
+
+        bool evaluateFilter (size_t part, 
+                             TRI_doc_mptr_t const* document);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief initialize, here we fetch all docs from the database
 ////////////////////////////////////////////////////////////////////////////////
@@ -546,6 +554,32 @@ namespace triagens {
 
         CollectionScanner* _scanner;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the scanner if the filter is evaluated while scanning, a nullptr
+/// otherwise
+////////////////////////////////////////////////////////////////////////////////
+
+        ParallelCollectionScanner* _parallelScanner;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief copies of the filter, one for each part of a parallel scan, as
+/// expressions must not be executed concurrently
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Expression*> _filters;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief blocks holding the document to evaluate a filter copy for
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<AqlItemBlock*> _filterItems;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the variable the filter is evaluated for, i.e. the out variable
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable*> _filterVariables;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief document buffer
 ////////////////////////////////////////////////////////////////////////////////
@@ -705,6 +739,19 @@ namespace triagens {
 
         void readSkiplistIndex (size_t atMost);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief builds an object with the indexed attributes from their shaped
+/// values, used for index-only scans
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t* buildIndexValue (TRI_shaped_json_t const*) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief frees the remaining values of an index-only scan
+////////////////////////////////////////////////////////////////////////////////
+
+        void freeIndexValues ();
+
 ////////////////////////////////////////////////////////////////////////////////
 // @brief: sorts the index range conditions and resets _posInRanges to 0
 ////////////////////////////////////////////////////////////////////////////////
@@ -770,6 +817,25 @@ namespace triagens {
 
         std::vector<TRI_doc_mptr_copy_t> _documents;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether only the indexed attributes are produced
+////////////////////////////////////////////////////////////////////////////////
+
+        bool const _indexOnly;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief paths of the indexed attributes produced by an index-only scan,
+/// empty for attributes contained in another indexed attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::vector<std::string>> _indexAttributes;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief values of an index-only scan, one for each entry in _documents
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_json_t*> _indexValues;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief current position in _allDocs
 ////////////////////////////////////////////////////////////////////////////////
@@ -870,6 +936,151 @@ namespace triagens {
 
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     GeoIndexBlock
+// -----------------------------------------------------------------------------
+
+    class GeoIndexBlock : public ExecutionBlock {
+
+      public:
+
+        GeoIndexBlock (ExecutionEngine* engine,
+                       GeoIndexNode const* ep);
+
+        ~GeoIndexBlock ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialize
+////////////////////////////////////////////////////////////////////////////////
+
+        int initialize () override;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initializeCursor
+////////////////////////////////////////////////////////////////////////////////
+
+        int initializeCursor (AqlItemBlock* items, size_t pos) override;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getSome
+////////////////////////////////////////////////////////////////////////////////
+
+        AqlItemBlock* getSome (size_t atLeast, size_t atMost) override final;
+
+////////////////////////////////////////////////////////////////////////////////
+// skip between atLeast and atMost, returns the number actually skipped . . .
+// will only return less than atLeast if there aren't atLeast many
+// things to skip overall.
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t skipSome (size_t atLeast, size_t atMost) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+      
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initialize fetching of documents
+////////////////////////////////////////////////////////////////////////////////
+
+        void initializeDocuments ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief continue fetching of documents
+////////////////////////////////////////////////////////////////////////////////
+
+        bool moreDocuments (size_t hint);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetch the documents that are not contained in the index
+////////////////////////////////////////////////////////////////////////////////
+
+        void readUnindexed ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetch the next documents from the index
+////////////////////////////////////////////////////////////////////////////////
+
+        void readIndex (size_t hint);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection* _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the geo index
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_index_t* _index;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief document buffer
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_doc_mptr_copy_t> _documents;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief current position in _documents
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _posInDocuments;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the documents that are not contained in the index
+/// were fetched. they have no distance and are produced first
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _unindexedDone;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the index has no further documents
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _indexDone;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of nearest documents requested from the index last time
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _requested;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of documents produced from the index
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _produced;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief distance of the last document produced from the index
+////////////////////////////////////////////////////////////////////////////////
+
+        double _lastDistance;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the documents produced with the last distance. the index returns an
+/// arbitrary part of the documents with the same distance, so these must be
+/// left out when the index is asked for more documents
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_set<void const*> _lastDocuments;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the produced documents need to be stored
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _mustStoreResult;
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                EnumerateListBlock
 // -----------------------------------------------------------------------------
@@ -56,6 +56,9 @@ static ExecutionBlock* CreateBlock (ExecutionEngine* engine,
     case ExecutionNode::INDEX_RANGE: {
       return new IndexRangeBlock(engine, static_cast<IndexRangeNode const*>(en));
     }
+    case ExecutionNode::GEO_INDEX: {
+      return new GeoIndexBlock(engine, static_cast<GeoIndexNode const*>(en));
+    }
     case ExecutionNode::ENUMERATE_COLLECTION: {
       return new EnumerateCollectionBlock(engine,
                                           static_cast<EnumerateCollectionNode const*>(en));
@@ -175,6 +178,7 @@ static ExecutionBlock* CreateBlock (ExecutionEngine* engine,
 
 ExecutionEngine::ExecutionEngine (Query* query)
   : _stats(),
+    _itemBlockManager(_stats),
     _blocks(),
     _root(nullptr),
     _query(query),
@@ -382,6 +386,9 @@ struct CoordinatorInstanciator : public WalkerWorker<ExecutionNode> {
         else if ((*en)->getType() == ExecutionNode::INDEX_RANGE) {
           collection = const_cast<Collection*>(static_cast<IndexRangeNode*>((*en))->collection());
         }
+        else if ((*en)->getType() == ExecutionNode::GEO_INDEX) {
+          collection = const_cast<Collection*>(static_cast<GeoIndexNode*>((*en))->collection());
+        }
         else if ((*en)->getType() == ExecutionNode::INSERT ||
                  (*en)->getType() == ExecutionNode::UPDATE ||
                  (*en)->getType() == ExecutionNode::REPLACE ||
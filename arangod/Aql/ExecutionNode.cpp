@@ -75,7 +75,8 @@ std::unordered_map<int, std::string const> const ExecutionNode::TypeNames{
   { static_cast<int>(DISTRIBUTE),                   "DistributeNode" },
   { static_cast<int>(GATHER),                       "GatherNode" },
   { static_cast<int>(NORESULTS),                    "NoResultsNode" },
-  { static_cast<int>(UPSERT),                       "UpsertNode" }
+  { static_cast<int>(UPSERT),                       "UpsertNode" },
+  { static_cast<int>(GEO_INDEX),                    "GeoIndexNode" }
 };
           
 // -----------------------------------------------------------------------------
@@ -210,6 +211,8 @@ ExecutionNode* ExecutionNode::fromJsonFactory (ExecutionPlan* plan,
       return new NoResultsNode(plan, oneNode);
     case INDEX_RANGE:
       return new IndexRangeNode(plan, oneNode);
+    case GEO_INDEX:
+      return new GeoIndexNode(plan, oneNode);
     case REMOTE:
       return new RemoteNode(plan, oneNode);
     case GATHER: {
@@ -518,6 +521,14 @@ ExecutionNode::IndexMatch ExecutionNode::CompareIndex (ExecutionNode const* node
 
   TRI_ASSERT(idx->type == TRI_IDX_TYPE_SKIPLIST_INDEX);
 
+  if (idx->vertexCentric &&
+      equalityLookupAttributes.find(idx->fields[0]) == equalityLookupAttributes.end()) {
+    // a vertex-centric index orders its first attribute by collection id and
+    // key of the vertex, which is not the sort order of the attribute values.
+    // it can only provide the order of the other attributes for a fixed vertex
+    return match;
+  }
+
   size_t const idxFields = idx->fields.size();
   size_t const n = attrs.size();
   match.doesMatch = (idxFields >= n);
@@ -894,6 +905,20 @@ void ExecutionNode::RegisterPlan::after (ExecutionNode *en) {
       break;
     }
 
+    case ExecutionNode::GEO_INDEX: {
+      depth++;
+      nrRegsHere.emplace_back(1);
+      RegisterId registerId = 1 + nrRegs.back();
+      nrRegs.emplace_back(registerId);
+
+      auto ep = static_cast<GeoIndexNode const*>(en);
+      TRI_ASSERT(ep != nullptr);
+      varInfo.emplace(make_pair(ep->outVariable()->id,
+                               VarInfo(depth, totalNrRegs)));
+      totalNrRegs++;
+      break;
+    }
+
     case ExecutionNode::ENUMERATE_LIST: {
       depth++;
       nrRegsHere.emplace_back(1);
@@ -1170,7 +1195,14 @@ EnumerateCollectionNode::EnumerateCollectionNode (ExecutionPlan* plan,
     _vocbase(plan->getAst()->query()->vocbase()),
     _collection(plan->getAst()->query()->collections()->get(JsonHelper::checkAndGetStringValue(base.json(), "collection"))),
     _outVariable(varFromJson(plan->getAst(), base, "outVariable")),
-    _random(JsonHelper::checkAndGetBooleanValue(base.json(), "random")) {
+    _random(JsonHelper::checkAndGetBooleanValue(base.json(), "random")),
+    _filter(nullptr) {
+
+  triagens::basics::Json filter = base.get("filter");
+
+  if (filter.isObject()) {
+    _filter = new Expression(plan->getAst(), new AstNode(plan->getAst(), filter));
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1192,6 +1224,10 @@ void EnumerateCollectionNode::toJsonHelper (triagens::basics::Json& nodes,
       ("outVariable", _outVariable->toJson())
       ("random", triagens::basics::Json(_random));
 
+  if (_filter != nullptr) {
+    json("filter", _filter->toJson(TRI_UNKNOWN_MEM_ZONE, verbose));
+  }
+
   // And add it:
   nodes(json);
 }
@@ -1211,6 +1247,10 @@ ExecutionNode* EnumerateCollectionNode::clone (ExecutionPlan* plan,
     
   auto c = new EnumerateCollectionNode(plan, _id, _vocbase, _collection, outVariable, _random);
 
+  if (_filter != nullptr) {
+    c->filter(_filter->clone());
+  }
+
   CloneHelper(c, plan, withDependencies, withProperties);
 
   return static_cast<ExecutionNode*>(c);
@@ -1492,6 +1532,7 @@ void IndexRangeNode::toJsonHelper (triagens::basics::Json& nodes,
  
   json("index", _index->toJson()); 
   json("reverse", triagens::basics::Json(_reverse));
+  json("indexOnly", triagens::basics::Json(_indexOnly));
 
   // And add it:
   nodes(json);
@@ -1517,6 +1558,7 @@ ExecutionNode* IndexRangeNode::clone (ExecutionPlan* plan,
 
   auto c = new IndexRangeNode(plan, _id, _vocbase, _collection, 
                               outVariable, _index, ranges, _reverse);
+  c->indexOnly(_indexOnly);
 
   CloneHelper(c, plan, withDependencies, withProperties);
 
@@ -1535,7 +1577,8 @@ IndexRangeNode::IndexRangeNode (ExecutionPlan* plan,
     _outVariable(varFromJson(plan->getAst(), json, "outVariable")),
     _index(nullptr), 
     _ranges(),
-    _reverse(false) {
+    _reverse(false),
+    _indexOnly(false) {
 
   triagens::basics::Json rangeArrayJson(TRI_UNKNOWN_MEM_ZONE, JsonHelper::checkAndGetArrayValue(json.json(), "ranges"));
 
@@ -1556,6 +1599,7 @@ IndexRangeNode::IndexRangeNode (ExecutionPlan* plan,
 
   _index = _collection->getIndex(iid);
   _reverse = JsonHelper::checkAndGetBooleanValue(json.json(), "reverse");
+  _indexOnly = JsonHelper::getBooleanValue(json.json(), "indexOnly", false);
 
   if (_index == nullptr) {
     THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "index not found");
@@ -1790,6 +1834,106 @@ bool IndexRangeNode::estimateItemsWithIndexSelectivity (size_t incoming,
   return true;
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                           methods of GeoIndexNode
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor for GeoIndexNode from Json
+////////////////////////////////////////////////////////////////////////////////
+
+GeoIndexNode::GeoIndexNode (ExecutionPlan* plan,
+                            triagens::basics::Json const& json)
+  : ExecutionNode(plan, json),
+    _vocbase(plan->getAst()->query()->vocbase()),
+    _collection(plan->getAst()->query()->collections()->get(JsonHelper::checkAndGetStringValue(json.json(), "collection"))),
+    _outVariable(varFromJson(plan->getAst(), json, "outVariable")),
+    _index(nullptr), 
+    _latitude(JsonHelper::checkAndGetNumericValue<double>(json.json(), "latitude")),
+    _longitude(JsonHelper::checkAndGetNumericValue<double>(json.json(), "longitude")),
+    _radius(JsonHelper::getNumericValue<double>(json.json(), "radius", -1.0)) {
+
+  auto index = JsonHelper::checkAndGetObjectValue(json.json(), "index");
+  auto iid   = JsonHelper::checkAndGetStringValue(index, "id");
+
+  _index = _collection->getIndex(iid);
+
+  if (_index == nullptr) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "index not found");
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief toJson, for GeoIndexNode
+////////////////////////////////////////////////////////////////////////////////
+
+void GeoIndexNode::toJsonHelper (triagens::basics::Json& nodes,
+                                 TRI_memory_zone_t* zone,
+                                 bool verbose) const {
+  triagens::basics::Json json(ExecutionNode::toJsonHelperGeneric(nodes, zone, verbose));  // call base class method
+
+  if (json.isEmpty()) {
+    return;
+  }
+
+  json("database", triagens::basics::Json(_vocbase->_name))
+      ("collection", triagens::basics::Json(_collection->getName()))
+      ("outVariable", _outVariable->toJson())
+      ("index", _index->toJson())
+      ("latitude", triagens::basics::Json(_latitude))
+      ("longitude", triagens::basics::Json(_longitude));
+
+  if (_radius >= 0.0) {
+    json("radius", triagens::basics::Json(_radius));
+  }
+
+  // And add it:
+  nodes(json);
+}
+
+ExecutionNode* GeoIndexNode::clone (ExecutionPlan* plan,
+                                    bool withDependencies,
+                                    bool withProperties) const {
+  auto outVariable = _outVariable;
+
+  if (withProperties) {
+    outVariable = plan->getAst()->variables()->createVariable(outVariable);
+  }
+
+  auto c = new GeoIndexNode(plan, _id, _vocbase, _collection, outVariable, 
+                            _index, _latitude, _longitude, _radius);
+
+  CloneHelper(c, plan, withDependencies, withProperties);
+
+  return static_cast<ExecutionNode*>(c);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cost of a geo index node. all documents may be produced, but
+/// the documents are produced lazily, so a following limit makes the scan
+/// stop early. with a radius, only a part of the documents is produced
+////////////////////////////////////////////////////////////////////////////////
+
+double GeoIndexNode::estimateCost (size_t& nrItems) const {
+  static double const RadiusReductionFactor = 10.0;
+
+  size_t incoming = 0;
+  double const dependencyCost = _dependencies.at(0)->getCost(incoming);
+  size_t const count = _collection->count();
+
+  if (_radius >= 0.0) {
+    nrItems = static_cast<size_t>(incoming * count / RadiusReductionFactor);
+  }
+  else {
+    nrItems = incoming * count;
+  }
+
+  nrItems = (std::max)(nrItems, static_cast<size_t>(1));
+
+  // the index lookups are more expensive than a plain scan per document
+  return dependencyCost + nrItems * 1.1;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              methods of LimitNode
 // -----------------------------------------------------------------------------
@@ -2441,6 +2585,7 @@ struct UserVarFinder : public WalkerWorker<ExecutionNode> {
     }
     else if (en->getType() == ExecutionNode::ENUMERATE_COLLECTION ||
              en->getType() == ExecutionNode::INDEX_RANGE ||
+             en->getType() == ExecutionNode::GEO_INDEX ||
              en->getType() == ExecutionNode::ENUMERATE_LIST ||
              en->getType() == ExecutionNode::AGGREGATE) {
       depth += 1;
@@ -101,7 +101,8 @@ namespace triagens {
           RETURN                  = 18,
           NORESULTS               = 19,
           DISTRIBUTE              = 20,
-          UPSERT                  = 21
+          UPSERT                  = 21,
+          GEO_INDEX               = 22
         };
 
 // -----------------------------------------------------------------------------
@@ -856,7 +857,8 @@ namespace triagens {
             _vocbase(vocbase), 
             _collection(collection),
             _outVariable(outVariable),  
-            _random(random) {
+            _random(random),
+            _filter(nullptr) {
           TRI_ASSERT(_vocbase != nullptr);
           TRI_ASSERT(_collection != nullptr);
           TRI_ASSERT(_outVariable != nullptr);
@@ -865,6 +867,10 @@ namespace triagens {
         EnumerateCollectionNode (ExecutionPlan* plan,
                                  triagens::basics::Json const& base);
 
+        ~EnumerateCollectionNode () {
+          delete _filter;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the type of the node
 ////////////////////////////////////////////////////////////////////////////////
@@ -936,6 +942,14 @@ namespace triagens {
           _random = true;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not documents are iterated in random order
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isRandom () const {
+          return _random;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the database
 ////////////////////////////////////////////////////////////////////////////////
@@ -960,6 +974,23 @@ namespace triagens {
           return _outVariable;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the filter evaluated while scanning, may be a nullptr
+////////////////////////////////////////////////////////////////////////////////
+
+        Expression* filter () const {
+          return _filter;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the filter evaluated while scanning, takes ownership
+////////////////////////////////////////////////////////////////////////////////
+
+        void filter (Expression* filter) {
+          delete _filter;
+          _filter = filter;
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -989,6 +1020,13 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         bool _random;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief filter condition on the documents only, evaluated while scanning
+/// so that the scan can be split among multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+        Expression* _filter;
     };
 
 // -----------------------------------------------------------------------------
@@ -1124,7 +1162,8 @@ namespace triagens {
             _outVariable(outVariable),
             _index(index),
             _ranges(ranges),
-            _reverse(reverse) {
+            _reverse(reverse),
+            _indexOnly(false) {
           TRI_ASSERT(_vocbase != nullptr);
           TRI_ASSERT(_collection != nullptr);
           TRI_ASSERT(_outVariable != nullptr);
@@ -1226,6 +1265,19 @@ namespace triagens {
           _reverse = value;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the out variable is only used for reading indexed
+/// attributes, which can then be produced from the index alone
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isIndexOnly () const {
+          return _indexOnly;
+        }
+
+        void indexOnly (bool value) {
+          _indexOnly = value;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief getIndex, hand out the index used
 ////////////////////////////////////////////////////////////////////////////////
@@ -1289,6 +1341,193 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         bool _reverse;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief produce objects with only the indexed attributes instead of the
+/// documents
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _indexOnly;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class GeoIndexNode
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief class GeoIndexNode, produces the documents of a collection in
+/// increasing distance from a point, using a geo index
+////////////////////////////////////////////////////////////////////////////////
+
+    class GeoIndexNode : public ExecutionNode {
+      
+      friend class ExecutionBlock;
+      friend class GeoIndexBlock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor, a negative radius means no documents are left out
+////////////////////////////////////////////////////////////////////////////////
+
+      public:
+
+        GeoIndexNode (ExecutionPlan* plan,
+                      size_t id,
+                      TRI_vocbase_t* vocbase, 
+                      Collection const* collection,
+                      Variable const* outVariable,
+                      Index const* index, 
+                      double latitude,
+                      double longitude,
+                      double radius)
+          : ExecutionNode(plan, id), 
+            _vocbase(vocbase), 
+            _collection(collection),
+            _outVariable(outVariable),
+            _index(index),
+            _latitude(latitude),
+            _longitude(longitude),
+            _radius(radius) {
+          TRI_ASSERT(_vocbase != nullptr);
+          TRI_ASSERT(_collection != nullptr);
+          TRI_ASSERT(_outVariable != nullptr);
+          TRI_ASSERT(_index != nullptr);
+        }
+
+        GeoIndexNode (ExecutionPlan*, triagens::basics::Json const& base);
+
+        ~GeoIndexNode () {
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the type of the node
+////////////////////////////////////////////////////////////////////////////////
+
+        NodeType getType () const override final {
+          return GEO_INDEX;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the database
+////////////////////////////////////////////////////////////////////////////////
+        
+        TRI_vocbase_t* vocbase () const {
+          return _vocbase;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection const* collection () const {
+          return _collection;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return out variable
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* outVariable () const {
+          return _outVariable;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the radius, negative if there is none
+////////////////////////////////////////////////////////////////////////////////
+
+        double radius () const {
+          return _radius;
+        }
+
+        void radius (double value) {
+          _radius = value;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief export to JSON
+////////////////////////////////////////////////////////////////////////////////
+
+        void toJsonHelper (triagens::basics::Json&,
+                           TRI_memory_zone_t*,
+                           bool) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clone ExecutionNode recursively
+////////////////////////////////////////////////////////////////////////////////
+
+        ExecutionNode* clone (ExecutionPlan* plan,
+                              bool withDependencies,
+                              bool withProperties) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getVariablesSetHere
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Variable const*> getVariablesSetHere () const override final {
+          return std::vector<Variable const*>{ _outVariable };
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief estimateCost
+////////////////////////////////////////////////////////////////////////////////
+
+        double estimateCost (size_t&) const override final;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief getIndex, hand out the index used
+////////////////////////////////////////////////////////////////////////////////
+
+        Index const* getIndex () const {
+          return _index;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the database
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_vocbase_t* _vocbase;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection
+////////////////////////////////////////////////////////////////////////////////
+
+        Collection const* _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief output variable
+////////////////////////////////////////////////////////////////////////////////
+
+        Variable const* _outVariable;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the geo index
+////////////////////////////////////////////////////////////////////////////////
+
+        Index const* _index;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief latitude of the point the distances are measured from
+////////////////////////////////////////////////////////////////////////////////
+
+        double _latitude;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief longitude of the point the distances are measured from
+////////////////////////////////////////////////////////////////////////////////
+
+        double _longitude;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief documents further away than this are not produced, a negative
+/// value means all documents are produced
+////////////////////////////////////////////////////////////////////////////////
+
+        double _radius;
     };
 
 // -----------------------------------------------------------------------------
@@ -1723,7 +1723,8 @@ bool ExecutionPlan::isDeadSimple () const {
     if (nodeType == ExecutionNode::SUBQUERY ||
         nodeType == ExecutionNode::ENUMERATE_COLLECTION ||
         nodeType == ExecutionNode::ENUMERATE_LIST ||
-        nodeType == ExecutionNode::INDEX_RANGE) {
+        nodeType == ExecutionNode::INDEX_RANGE ||
+        nodeType == ExecutionNode::GEO_INDEX) {
       // these node types are not simple
       return false;
     }
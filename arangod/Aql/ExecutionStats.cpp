@@ -43,12 +43,15 @@ using JsonHelper = triagens::basics::JsonHelper;
 ////////////////////////////////////////////////////////////////////////////////
 
 Json ExecutionStats::toJson () const {
-  Json json(Json::Object, 5);
+  Json json(Json::Object, 9);
   json.set("writesExecuted", Json(static_cast<double>(writesExecuted)));
   json.set("writesIgnored",  Json(static_cast<double>(writesIgnored)));
   json.set("scannedFull",    Json(static_cast<double>(scannedFull)));
   json.set("scannedIndex",   Json(static_cast<double>(scannedIndex)));
   json.set("filtered",       Json(static_cast<double>(filtered)));
+  json.set("blocksAllocated", Json(static_cast<double>(blocksAllocated)));
+  json.set("blocksReused",   Json(static_cast<double>(blocksReused)));
+  json.set("bytesAllocated", Json(static_cast<double>(bytesAllocated)));
 
   if (fullCount > -1) {
     // fullCount is exceptional. it has a default value of -1 and is
@@ -60,12 +63,15 @@ Json ExecutionStats::toJson () const {
 }
 
 Json ExecutionStats::toJsonStatic () {
-  Json json(Json::Object, 7);
+  Json json(Json::Object, 10);
   json.set("writesExecuted", Json(0.0));
   json.set("writesIgnored",  Json(0.0));
   json.set("scannedFull",    Json(0.0));
   json.set("scannedIndex",   Json(0.0));
   json.set("filtered",       Json(0.0));
+  json.set("blocksAllocated", Json(0.0));
+  json.set("blocksReused",   Json(0.0));
+  json.set("bytesAllocated", Json(0.0));
   json.set("fullCount",      Json(-1.0));
   json.set("static",         Json(0.0));
 
@@ -78,7 +84,10 @@ ExecutionStats::ExecutionStats()
    scannedFull(0),
    scannedIndex(0),
    filtered(0),
-   fullCount(-1) {
+   fullCount(-1),
+   blocksAllocated(0),
+   blocksReused(0),
+   bytesAllocated(0) {
 }
 
 ExecutionStats::ExecutionStats (triagens::basics::Json const& jsonStats) {
@@ -94,6 +103,11 @@ ExecutionStats::ExecutionStats (triagens::basics::Json const& jsonStats) {
 
   // note: fullCount is an optional attribute!
   fullCount      = JsonHelper::getNumericValue<int64_t>(jsonStats.json(), "fullCount", -1);
+
+  // the block statistics are optional, too, as older servers do not send them
+  blocksAllocated = JsonHelper::getNumericValue<int64_t>(jsonStats.json(), "blocksAllocated", 0);
+  blocksReused    = JsonHelper::getNumericValue<int64_t>(jsonStats.json(), "blocksReused", 0);
+  bytesAllocated  = JsonHelper::getNumericValue<int64_t>(jsonStats.json(), "bytesAllocated", 0);
 }
 
 // -----------------------------------------------------------------------------
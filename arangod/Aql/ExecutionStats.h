@@ -69,6 +69,9 @@ namespace triagens {
         scannedIndex   += summand.scannedIndex;
         fullCount      += summand.fullCount;
         filtered       += summand.filtered;
+        blocksAllocated += summand.blocksAllocated;
+        blocksReused    += summand.blocksReused;
+        bytesAllocated  += summand.bytesAllocated;
       }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +85,9 @@ namespace triagens {
         scannedIndex   += newStats.scannedIndex   - lastStats.scannedIndex;
         fullCount      += newStats.fullCount      - lastStats.fullCount;
         filtered       += newStats.filtered       - lastStats.filtered;
+        blocksAllocated += newStats.blocksAllocated - lastStats.blocksAllocated;
+        blocksReused    += newStats.blocksReused    - lastStats.blocksReused;
+        bytesAllocated  += newStats.bytesAllocated  - lastStats.bytesAllocated;
       }
 
 
@@ -121,6 +127,24 @@ namespace triagens {
 
       int64_t fullCount; 
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of item blocks that were allocated
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t blocksAllocated;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of item blocks that were recycled instead of allocated
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t blocksReused;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of bytes allocated for the values of item blocks
+////////////////////////////////////////////////////////////////////////////////
+
+      int64_t bytesAllocated;
+
     };
 
   }
@@ -193,6 +193,7 @@ std::unordered_map<std::string, Function const> const Executor::FunctionNames{
   { "WITHIN",                      Function("WITHIN",                      "AQL_WITHIN", "h,n,n,n|s", false, true, false) },
   { "WITHIN_RECTANGLE",            Function("WITHIN_RECTANGLE",            "AQL_WITHIN_RECTANGLE", "h,d,d,d,d", false, true, false) },
   { "IS_IN_POLYGON",               Function("IS_IN_POLYGON",               "AQL_IS_IN_POLYGON", "l,ln|nb", true, false, true) },
+  { "DISTANCE",                    Function("DISTANCE",                    "AQL_DISTANCE", "n,n,n,n", true, false, true, &Functions::Distance) },
 
   // fulltext functions
   { "FULLTEXT",                    Function("FULLTEXT",                    "AQL_FULLTEXT", "h,s,s|n", false, true, false) },
@@ -34,6 +34,7 @@
 #include "Basics/JsonHelper.h"
 #include "Basics/json-utilities.h"
 #include "Basics/StringBuffer.h"
+#include "GeoIndex/GeoIndex.h"
 #include "Rest/SslInterface.h"
 
 using namespace triagens::aql;
@@ -1126,6 +1127,52 @@ AqlValue Functions::Intersection (triagens::aql::Query* query,
   return AqlValue(jr);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief function DISTANCE
+///
+/// the distance is calculated in the same way as by the geo index, so a
+/// filter on the distance agrees with the geo index. coordinates the geo index
+/// would not accept produce a null result
+////////////////////////////////////////////////////////////////////////////////
+
+AqlValue Functions::Distance (triagens::aql::Query* query,
+                              triagens::arango::AqlTransaction* trx,
+                              TRI_document_collection_t const* collection,
+                              AqlValue const parameters) {
+  double values[4];
+
+  for (size_t i = 0; i < 4; ++i) {
+    Json value(parameters.extractArrayMember(trx, collection, i, false));
+
+    if (! value.isNumber()) {
+      RegisterInvalidArgumentWarning(query, "DISTANCE");
+      return AqlValue(new Json(Json::Null));
+    }
+
+    values[i] = value.json()->_value._number;
+  }
+
+  GeoCoordinate c1;
+  c1.latitude = values[0];
+  c1.longitude = values[1];
+  c1.data = nullptr;
+
+  GeoCoordinate c2;
+  c2.latitude = values[2];
+  c2.longitude = values[3];
+  c2.data = nullptr;
+
+  if (c1.latitude < -90.0 || c1.latitude > 90.0 ||
+      c2.latitude < -90.0 || c2.latitude > 90.0 ||
+      c1.longitude < -180.0 || c1.longitude > 180.0 ||
+      c2.longitude < -180.0 || c2.longitude > 180.0) {
+    RegisterInvalidArgumentWarning(query, "DISTANCE");
+    return AqlValue(new Json(Json::Null));
+  }
+
+  return AqlValue(new Json(GeoIndex_distance(&c1, &c2)));
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -58,6 +58,8 @@ namespace triagens {
           type(idx->_type),
           unique(idx->_unique),
           sparse(idx->_sparse),
+          vertexCentric(idx->_type == TRI_IDX_TYPE_SKIPLIST_INDEX &&
+                        reinterpret_cast<TRI_skiplist_index_t const*>(idx)->_skiplistIndex->_vertex != TRI_SKIPLIST_VERTEX_NONE),
           fields(),
           internals(idx) {
 
@@ -72,11 +74,13 @@ namespace triagens {
         TRI_ASSERT(internals != nullptr);
       }
       
-      Index (TRI_json_t const* json)
+      Index (TRI_json_t const* json,
+             TRI_col_type_e collectionType)
         : id(triagens::basics::StringUtils::uint64(triagens::basics::JsonHelper::checkAndGetStringValue(json, "id"))),
           type(TRI_TypeIndex(triagens::basics::JsonHelper::checkAndGetStringValue(json, "type").c_str())),
           unique(triagens::basics::JsonHelper::checkAndGetBooleanValue(json, "unique")),
           sparse(triagens::basics::JsonHelper::getBooleanValue(json, "sparse", false)),
+          vertexCentric(false),
           fields(),
           internals(nullptr) {
 
@@ -94,6 +98,13 @@ namespace triagens {
           }
         }
 
+        // a skiplist index on an edge collection starting with _from or _to
+        // is vertex-centric, see TRI_CreateSkiplistIndex
+        vertexCentric = (type == TRI_IDX_TYPE_SKIPLIST_INDEX &&
+                         collectionType == TRI_COL_TYPE_EDGE &&
+                         ! fields.empty() &&
+                         (fields[0] == TRI_VOC_ATTRIBUTE_FROM || fields[0] == TRI_VOC_ATTRIBUTE_TO));
+
         // it is the caller's responsibility to fill the data attribute with something sensible later!
       }
       
@@ -109,6 +120,10 @@ namespace triagens {
             ("unique", triagens::basics::Json(unique))
             ("sparse", triagens::basics::Json(sparse));
 
+        if (vertexCentric) {
+          json("vertexCentric", triagens::basics::Json(true));
+        }
+
         if (hasSelectivityEstimate()) {
           json("selectivityEstimate", triagens::basics::Json(selectivityEstimate()));
         }
@@ -164,6 +179,16 @@ namespace triagens {
         TRI_idx_type_e const       type;
         bool const                 unique;
         bool const                 sparse;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the index is a vertex-centric skiplist index
+///
+/// The first attribute of a vertex-centric index is _from or _to, but the
+/// index orders it by collection id and key of the vertex and not like the
+/// attribute value. It can only be used for equality lookups on it.
+////////////////////////////////////////////////////////////////////////////////
+
+        bool                       vertexCentric;
         std::vector<std::string>   fields;
 
       private:
@@ -566,12 +566,35 @@ void Optimizer::setupRules () {
                removeFiltersCoveredByIndexRule_pass6,
                true);
 
+  if (! triagens::arango::ServerState::instance()->isCoordinator()) {
+    // try to use geo indexes for filters and sorts on DISTANCE()
+    registerRule("use-geo-index",
+                 useGeoIndexRule,
+                 useGeoIndexRule_pass6,
+                 true);
+  }
+
   // try to find sort blocks which are superseeded by indexes
   registerRule("use-index-for-sort",
                useIndexForSortRule,
                useIndexForSortRule_pass6,
                true);
 
+  // try to read only the indexed attributes instead of the documents
+  registerRule("use-index-only",
+               useIndexOnlyRule,
+               useIndexOnlyRule_pass6,
+               true);
+
+  if (! triagens::arango::ServerState::instance()->isCoordinator()) {
+    // evaluate filters on the documents of full collection scans while
+    // scanning, using multiple threads
+    registerRule("parallelize-collection-scan",
+                 parallelizeCollectionScanRule,
+                 parallelizeCollectionScanRule_pass6,
+                 true);
+  }
+
 //////////////////////////////////////////////////////////////////////////////
 /// Pass 9: push down calculations beyond FILTERs and LIMITs
 //////////////////////////////////////////////////////////////////////////////
@@ -188,10 +188,20 @@ namespace triagens {
 
         // try to remove filters covered by index ranges
         removeFiltersCoveredByIndexRule_pass6         = 840,
+
+        // try to use geo indexes for filters and sorts on DISTANCE()
+        useGeoIndexRule_pass6                         = 845,
   
         // try to find sort blocks which are superseeded by indexes
         useIndexForSortRule_pass6                     = 850,
 
+        // try to read only the indexed attributes instead of the documents
+        useIndexOnlyRule_pass6                        = 860,
+
+        // evaluate filters on the documents of full collection scans while
+        // scanning, using multiple threads
+        parallelizeCollectionScanRule_pass6           = 870,
+
 //////////////////////////////////////////////////////////////////////////////
 /// Pass 9: push down calculations beyond FILTERs and LIMITs
 //////////////////////////////////////////////////////////////////////////////
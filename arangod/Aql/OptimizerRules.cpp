@@ -847,9 +847,10 @@ int triagens::aql::removeSortRandRule (Optimizer* opt,
         case EN::FILTER: 
         case EN::SUBQUERY:
         case EN::ENUMERATE_LIST:
-        case EN::INDEX_RANGE: {
+        case EN::INDEX_RANGE:
+        case EN::GEO_INDEX: {
           // if we found another SortNode, an AggregateNode, FilterNode, a SubqueryNode, 
-          // an EnumerateListNode or an IndexRangeNode
+          // an EnumerateListNode or an index node
           // this means we cannot apply our optimization
           collectionNode = nullptr;
           current = nullptr;
@@ -1054,6 +1055,7 @@ int triagens::aql::moveCalculationsDownRule (Optimizer* opt,
         shouldMove = true;
       } 
       else if (currentType == EN::INDEX_RANGE ||
+               currentType == EN::GEO_INDEX ||
                currentType == EN::ENUMERATE_COLLECTION ||
                currentType == EN::ENUMERATE_LIST ||
                currentType == EN::AGGREGATE ||
@@ -2040,6 +2042,7 @@ class FilterToEnumCollFinder : public WalkerWorker<ExecutionNode> {
           return true;
         case EN::SORT:
         case EN::INDEX_RANGE:
+        case EN::GEO_INDEX:
           break;
         case EN::ENUMERATE_COLLECTION: {
           auto node = static_cast<EnumerateCollectionNode*>(en);
@@ -2258,6 +2261,13 @@ class FilterToEnumCollFinder : public WalkerWorker<ExecutionNode> {
                           break; // not usable
                         }
 
+                        if (idx->vertexCentric && ! range->second.is1ValueRangeInfo()) {
+                          // a vertex-centric index does not order the vertices like
+                          // strings, so it can only look up a single vertex
+                          indexOrCondition.clear();
+                          break; // not usable
+                        }
+
                         // insert the first index attribute
                         indexOrCondition.at(k).emplace_back(range->second);
                        
@@ -2713,6 +2723,7 @@ class SortToIndexNode : public WalkerWorker<ExecutionNode> {
 
         if (node->getType() == EN::ENUMERATE_COLLECTION ||
             node->getType() == EN::INDEX_RANGE ||
+            node->getType() == EN::GEO_INDEX ||
             node->getType() == EN::ENUMERATE_LIST) {
           // we are contained in an outer loop
           return true;
@@ -2837,6 +2848,7 @@ class SortToIndexNode : public WalkerWorker<ExecutionNode> {
       case EN::GATHER:
       case EN::REMOTE:
       case EN::ILLEGAL:
+      case EN::GEO_INDEX:
       case EN::LIMIT:                      // LIMIT is criterion to stop
         return true;  // abort.
 
@@ -2880,6 +2892,619 @@ int triagens::aql::useIndexForSortRule (Optimizer* opt,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief walker collecting all nodes that use a specific variable
+////////////////////////////////////////////////////////////////////////////////
+
+class VariableUsersFinder : public WalkerWorker<ExecutionNode> {
+
+  public:
+
+    VariableUsersFinder (Variable const* variable) 
+      : _variable(variable),
+        _users() {
+    }
+
+    bool before (ExecutionNode* en) override final {
+      // the nodes of a subquery are visited on their own
+      if (en->getType() != EN::SUBQUERY) {
+        auto&& used = en->getVariablesUsedHere();
+
+        if (std::find(used.begin(), used.end(), _variable) != used.end()) {
+          _users.emplace_back(en);
+        }
+      }
+
+      return false;
+    }
+
+    bool enterSubquery (ExecutionNode*, ExecutionNode*) override final {
+      return true;
+    }
+
+    std::vector<ExecutionNode*> const& users () const {
+      return _users;
+    }
+
+  private:
+
+    Variable const* _variable;
+
+    std::vector<ExecutionNode*> _users;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether all references to a variable in an expression are
+/// attribute accesses that start with one of the given attribute paths
+////////////////////////////////////////////////////////////////////////////////
+
+static bool OnlyIndexedAttributesUsed (AstNode const* node,
+                                       Variable const* variable,
+                                       std::vector<std::vector<std::string>> const& fields) {
+  if (node == nullptr) {
+    return true;
+  }
+
+  if (node->type == NODE_TYPE_REFERENCE) {
+    // a reference to the variable that is not an attribute access
+    return (static_cast<Variable const*>(node->getData()) != variable);
+  }
+
+  if (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    std::vector<std::string> path;
+    AstNode const* current = node;
+
+    while (current->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+      path.emplace_back(current->getStringValue());
+      current = current->getMember(0);
+    }
+
+    if (current->type != NODE_TYPE_REFERENCE ||
+        static_cast<Variable const*>(current->getData()) != variable) {
+      return OnlyIndexedAttributesUsed(current, variable, fields);
+    }
+
+    std::reverse(path.begin(), path.end());
+
+    for (auto const& field : fields) {
+      if (field.size() <= path.size() &&
+          std::equal(field.begin(), field.end(), path.begin())) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  size_t const n = node->numMembers();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (! OnlyIndexedAttributesUsed(node->getMember(i), variable, fields)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief produce only the indexed attributes from an index range if the
+/// documents themselves are not needed
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::useIndexOnlyRule (Optimizer* opt, 
+                                     ExecutionPlan* plan,
+                                     Optimizer::Rule const* rule) {
+  bool modified = false;
+  std::vector<ExecutionNode*> nodes
+    = plan->findNodesOfType(EN::INDEX_RANGE, true);
+
+  for (auto n : nodes) {
+    auto indexRangeNode = static_cast<IndexRangeNode*>(n);
+    auto index = indexRangeNode->getIndex();
+
+    if (indexRangeNode->isIndexOnly() ||
+        (index->type != TRI_IDX_TYPE_HASH_INDEX && 
+         index->type != TRI_IDX_TYPE_SKIPLIST_INDEX)) {
+      continue;
+    }
+
+    std::vector<std::vector<std::string>> fields;
+    bool usable = true;
+
+    for (auto const& field : index->fields) {
+      if (field.empty() || field[0] == '_') {
+        // system attributes are not part of the shaped document data
+        usable = false;
+        break;
+      }
+
+      fields.emplace_back(triagens::basics::StringUtils::split(field, '.'));
+    }
+
+    if (! usable) {
+      continue;
+    }
+
+    auto outVariable = indexRangeNode->outVariable();
+
+    VariableUsersFinder finder(outVariable);
+    plan->root()->walk(&finder);
+
+    for (auto user : finder.users()) {
+      if (user->getType() != EN::CALCULATION) {
+        usable = false;
+        break;
+      }
+
+      auto expression = static_cast<CalculationNode const*>(user)->expression();
+
+      if (! OnlyIndexedAttributesUsed(expression->node(), outVariable, fields)) {
+        usable = false;
+        break;
+      }
+    }
+
+    if (usable && ! finder.users().empty()) {
+      indexRangeNode->indexOnly(true);
+      modified = true;
+    }
+  }
+    
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether a filter condition can be evaluated by multiple
+/// threads for the documents of a collection scan. this is the case if it
+/// only reads non-system attributes of the documents and uses nothing that
+/// needs V8 or state of the query
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CanFilterWhileScanning (AstNode const* node,
+                                    Variable const* variable) {
+  switch (node->type) {
+    case NODE_TYPE_VALUE: {
+      return true;
+    }
+
+    case NODE_TYPE_ATTRIBUTE_ACCESS: {
+      char const* name = node->getStringValue();
+
+      if (*name == '\0' || *name == '_') {
+        // system attributes are not part of the shaped document data
+        return false;
+      }
+
+      auto member = node->getMember(0);
+
+      if (member->type == NODE_TYPE_REFERENCE) {
+        return (static_cast<Variable const*>(member->getData()) == variable);
+      }
+
+      return CanFilterWhileScanning(member, variable);
+    }
+
+    case NODE_TYPE_ARRAY:
+    case NODE_TYPE_OBJECT:
+    case NODE_TYPE_OBJECT_ELEMENT:
+    case NODE_TYPE_RANGE:
+    case NODE_TYPE_OPERATOR_UNARY_NOT:
+    case NODE_TYPE_OPERATOR_BINARY_AND:
+    case NODE_TYPE_OPERATOR_BINARY_OR:
+    case NODE_TYPE_OPERATOR_BINARY_EQ:
+    case NODE_TYPE_OPERATOR_BINARY_NE:
+    case NODE_TYPE_OPERATOR_BINARY_LT:
+    case NODE_TYPE_OPERATOR_BINARY_LE:
+    case NODE_TYPE_OPERATOR_BINARY_GT:
+    case NODE_TYPE_OPERATOR_BINARY_GE:
+    case NODE_TYPE_OPERATOR_BINARY_IN:
+    case NODE_TYPE_OPERATOR_BINARY_NIN: {
+      break;
+    }
+
+    default: {
+      // references to whole documents or to other variables, function calls,
+      // arithmetic, ternary operators, subqueries etc.
+      return false;
+    }
+  }
+
+  size_t const n = node->numMembers();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (! CanFilterWhileScanning(node->getMember(i), variable)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief evaluate filters on the documents of a full collection scan while
+/// scanning, so the scan and the filters can be split among multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::parallelizeCollectionScanRule (Optimizer* opt, 
+                                                  ExecutionPlan* plan,
+                                                  Optimizer::Rule const* rule) {
+  bool modified = false;
+  std::vector<ExecutionNode*> nodes
+    = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+
+  for (auto n : nodes) {
+    auto collectionNode = static_cast<EnumerateCollectionNode*>(n);
+
+    if (collectionNode->isRandom() ||
+        collectionNode->filter() != nullptr) {
+      continue;
+    }
+
+    auto outVariable = collectionNode->outVariable();
+
+    std::unordered_map<VariableId, CalculationNode*> calculations;
+    std::unordered_set<ExecutionNode*> toUnlink;
+    std::vector<CalculationNode*> setters;
+    AstNode* condition = nullptr;
+
+    // look at the filters following the scan, up to the next node that is no
+    // filter or calculation
+    auto parents = collectionNode->getParents();
+
+    while (parents.size() == 1) {
+      auto current = parents[0];
+
+      if (current->getType() == EN::CALCULATION) {
+        auto calculationNode = static_cast<CalculationNode*>(current);
+        auto expression = calculationNode->expression();
+
+        if (expression->canThrow() || ! expression->isDeterministic()) {
+          // filters must not be moved before this calculation
+          break;
+        }
+
+        calculations.emplace(calculationNode->outVariable()->id, calculationNode);
+      }
+      else if (current->getType() == EN::FILTER) {
+        auto inVariable = current->getVariablesUsedHere()[0];
+        auto it = calculations.find(inVariable->id);
+
+        // V8 expressions cannot be evaluated by the scan threads, which have
+        // no V8 context
+        if (it != calculations.end() &&
+            CanFilterWhileScanning((*it).second->expression()->node(), outVariable) &&
+            ! (*it).second->expression()->isV8()) {
+          auto node = const_cast<AstNode*>((*it).second->expression()->node());
+
+          if (condition == nullptr) {
+            condition = node;
+          }
+          else {
+            condition = plan->getAst()->createNodeBinaryOperator(NODE_TYPE_OPERATOR_BINARY_AND, condition, node);
+          }
+
+          toUnlink.emplace(current);
+          setters.emplace_back((*it).second);
+        }
+      }
+      else {
+        break;
+      }
+
+      parents = current->getParents();
+    }
+
+    if (condition == nullptr) {
+      continue;
+    }
+
+    collectionNode->filter(new Expression(plan->getAst(), condition));
+    plan->unlinkNodes(toUnlink);
+    modified = true;
+
+    // remove the calculations that were used by the filters only
+    toUnlink.clear();
+
+    for (auto setter : setters) {
+      VariableUsersFinder finder(setter->outVariable());
+      plan->root()->walk(&finder);
+
+      if (finder.users().empty()) {
+        toUnlink.emplace(setter);
+      }
+    }
+
+    if (! toUnlink.empty()) {
+      plan->unlinkNodes(toUnlink);
+    }
+  }
+    
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a call to DISTANCE() with the coordinates of the documents of a
+/// collection scan and a constant point
+////////////////////////////////////////////////////////////////////////////////
+
+struct GeoDistanceCall {
+  std::string latitudeAttribute;
+  std::string longitudeAttribute;
+  double latitude;
+  double longitude;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief builds the name of the attribute of a variable accessed by an
+/// expression, e.g. "a.b" for "d.a.b", returns false for other expressions
+////////////////////////////////////////////////////////////////////////////////
+
+static bool GetAttributePath (AstNode const* node,
+                              Variable const* variable,
+                              std::string& path) {
+  std::vector<char const*> names;
+
+  while (node->type == NODE_TYPE_ATTRIBUTE_ACCESS) {
+    names.emplace_back(node->getStringValue());
+    node = node->getMember(0);
+  }
+
+  if (names.empty() ||
+      node->type != NODE_TYPE_REFERENCE ||
+      static_cast<Variable const*>(node->getData()) != variable) {
+    return false;
+  }
+
+  path.clear();
+
+  for (auto it = names.rbegin(); it != names.rend(); ++it) {
+    if (! path.empty()) {
+      path.push_back('.');
+    }
+    path.append(*it);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not an expression is a call of DISTANCE()
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsDistanceCall (AstNode const* node) {
+  if (node->type != NODE_TYPE_FCALL) {
+    return false;
+  }
+
+  auto func = static_cast<Function const*>(node->getData());
+
+  return (func->externalName == "DISTANCE" &&
+          node->getMember(0)->numMembers() == 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief checks whether an expression is a call of DISTANCE() between the
+/// coordinates of a document and a constant point, in any argument order
+////////////////////////////////////////////////////////////////////////////////
+
+static bool MatchDistanceCall (AstNode const* node,
+                               Variable const* variable,
+                               GeoDistanceCall& call) {
+  if (! IsDistanceCall(node)) {
+    return false;
+  }
+
+  auto args = node->getMember(0);
+
+  for (size_t i = 0; i < 2; ++i) {
+    // the document coordinates are either the first or the last two arguments
+    size_t const document = (i == 0 ? 0 : 2);
+    size_t const point    = (i == 0 ? 2 : 0);
+
+    auto latitude  = args->getMember(point);
+    auto longitude = args->getMember(point + 1);
+
+    if (latitude->isNumericValue() &&
+        longitude->isNumericValue() &&
+        GetAttributePath(args->getMember(document), variable, call.latitudeAttribute) &&
+        GetAttributePath(args->getMember(document + 1), variable, call.longitudeAttribute)) {
+      call.latitude  = latitude->getDoubleValue();
+      call.longitude = longitude->getDoubleValue();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief use a geo index for the documents of a collection scan that are
+/// filtered or sorted by their distance to a constant point, e.g.
+///   FOR d IN c FILTER DISTANCE(d.lat, d.lon, 0, 0) < 1000 RETURN d
+///   FOR d IN c SORT DISTANCE(d.lat, d.lon, 0, 0) LIMIT 10 RETURN d
+/// the geo index produces the documents by increasing distance, so the sort
+/// can be removed, and documents beyond the radius of the filter are never
+/// looked at. the filter itself is kept
+////////////////////////////////////////////////////////////////////////////////
+
+int triagens::aql::useGeoIndexRule (Optimizer* opt, 
+                                    ExecutionPlan* plan,
+                                    Optimizer::Rule const* rule) {
+  bool modified = false;
+  std::vector<ExecutionNode*> nodes
+    = plan->findNodesOfType(EN::ENUMERATE_COLLECTION, true);
+
+  for (auto n : nodes) {
+    auto collectionNode = static_cast<EnumerateCollectionNode*>(n);
+
+    if (collectionNode->isRandom() ||
+        collectionNode->filter() != nullptr) {
+      continue;
+    }
+
+    // geo indexes on separate latitude and longitude attributes
+    std::vector<Index const*> geoIndexes;
+
+    for (auto idx : const_cast<Collection*>(collectionNode->collection())->getIndexes()) {
+      if (idx->type == TRI_IDX_TYPE_GEO2_INDEX &&
+          idx->fields.size() == 2) {
+        geoIndexes.emplace_back(idx);
+      }
+    }
+
+    if (geoIndexes.empty()) {
+      continue;
+    }
+
+    auto outVariable = collectionNode->outVariable();
+
+    std::unordered_map<VariableId, CalculationNode*> calculations;
+    Index const* index = nullptr;
+    double latitude  = 0.0;
+    double longitude = 0.0;
+    double radius    = -1.0;
+    ExecutionNode* sortNode = nullptr;
+
+    // checks whether an expression is the distance to the point of the index,
+    // the first such expression determines the index and the point
+    auto matchesPoint = [&] (AstNode const* node) -> bool {
+      if (node->type == NODE_TYPE_REFERENCE) {
+        auto it = calculations.find(static_cast<Variable const*>(node->getData())->id);
+
+        if (it == calculations.end()) {
+          return false;
+        }
+        node = (*it).second->expression()->node();
+      }
+
+      GeoDistanceCall call;
+
+      if (! MatchDistanceCall(node, outVariable, call)) {
+        return false;
+      }
+
+      if (index == nullptr) {
+        for (auto idx : geoIndexes) {
+          if (idx->fields[0] == call.latitudeAttribute &&
+              idx->fields[1] == call.longitudeAttribute) {
+            index     = idx;
+            latitude  = call.latitude;
+            longitude = call.longitude;
+            return true;
+          }
+        }
+        return false;
+      }
+
+      return (index->fields[0] == call.latitudeAttribute &&
+              index->fields[1] == call.longitudeAttribute &&
+              latitude == call.latitude &&
+              longitude == call.longitude);
+    };
+
+    // look at the filters following the scan, up to the first sort or the
+    // next node that is no filter or calculation
+    auto parents = collectionNode->getParents();
+
+    while (parents.size() == 1) {
+      auto current = parents[0];
+
+      if (current->getType() == EN::CALCULATION) {
+        auto calculationNode = static_cast<CalculationNode*>(current);
+        auto expression = calculationNode->expression();
+
+        if (expression->canThrow() || ! expression->isDeterministic()) {
+          // leaving out documents beyond the radius must not change results
+          break;
+        }
+
+        calculations.emplace(calculationNode->outVariable()->id, calculationNode);
+      }
+      else if (current->getType() == EN::FILTER) {
+        auto inVariable = current->getVariablesUsedHere()[0];
+        auto it = calculations.find(inVariable->id);
+
+        // DISTANCE(...) < value or value > DISTANCE(...)
+        AstNode const* condition = (it == calculations.end() ? nullptr : (*it).second->expression()->node());
+        AstNode const* distance = nullptr;
+        AstNode const* value = nullptr;
+
+        if (condition == nullptr) {
+          // not calculated after the scan
+        }
+        else if (condition->type == NODE_TYPE_OPERATOR_BINARY_LT ||
+            condition->type == NODE_TYPE_OPERATOR_BINARY_LE) {
+          distance = condition->getMember(0);
+          value    = condition->getMember(1);
+        }
+        else if (condition->type == NODE_TYPE_OPERATOR_BINARY_GT ||
+                 condition->type == NODE_TYPE_OPERATOR_BINARY_GE) {
+          distance = condition->getMember(1);
+          value    = condition->getMember(0);
+        }
+
+        if (distance != nullptr &&
+            value->isNumericValue() &&
+            matchesPoint(distance)) {
+          // documents without coordinates pass such a filter, but these are
+          // produced by the geo index node regardless of the radius
+          double const r = (std::max)(value->getDoubleValue(), 0.0);
+
+          if (radius < 0.0 || r < radius) {
+            radius = r;
+          }
+        }
+      }
+      else if (current->getType() == EN::SORT) {
+        auto const& elements = static_cast<SortNode*>(current)->getElements();
+
+        if (elements.size() == 1 && 
+            elements[0].second) {
+          auto it = calculations.find(elements[0].first->id);
+
+          if (it != calculations.end() &&
+              matchesPoint((*it).second->expression()->node())) {
+            sortNode = current;
+          }
+        }
+        break;
+      }
+      else {
+        break;
+      }
+
+      parents = current->getParents();
+    }
+
+    if (index == nullptr ||
+        (radius < 0.0 && sortNode == nullptr)) {
+      continue;
+    }
+
+    auto geoNode = new GeoIndexNode(plan, plan->nextId(), collectionNode->vocbase(), 
+                                    collectionNode->collection(), outVariable, 
+                                    index, latitude, longitude, radius);
+    plan->registerNode(geoNode);
+    plan->replaceNode(collectionNode, geoNode);
+
+    if (sortNode != nullptr) {
+      // the documents are already sorted by their distance
+      plan->unlinkNode(sortNode);
+    }
+
+    modified = true;
+  }
+    
+  opt->addPlan(plan, rule, modified);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 // TODO: finish rule and test it
 struct FilterCondition {
   std::string variableName;
@@ -3657,6 +4282,7 @@ int triagens::aql::distributeFilternCalcToClusterRule (Optimizer* opt,
         case EN::LIMIT:
         case EN::SORT:
         case EN::INDEX_RANGE:
+        case EN::GEO_INDEX:
         case EN::ENUMERATE_COLLECTION:
           //do break
           stopSearching = true;
@@ -3751,6 +4377,7 @@ int triagens::aql::distributeSortToClusterRule (Optimizer* opt,
         case EN::REMOTE:
         case EN::LIMIT:
         case EN::INDEX_RANGE:
+        case EN::GEO_INDEX:
         case EN::ENUMERATE_COLLECTION:
           // For all these, we do not want to pull a SortNode further down
           // out to the DBservers, note that potential FilterNodes and
@@ -4026,7 +4653,8 @@ class RemoveToEnumCollFinder : public WalkerWorker<ExecutionNode> {
         case EN::ILLEGAL:
         case EN::LIMIT:           
         case EN::SORT:
-        case EN::INDEX_RANGE: {
+        case EN::INDEX_RANGE:
+        case EN::GEO_INDEX: {
           // if we meet any of the above, then we abort . . .
         }
     }
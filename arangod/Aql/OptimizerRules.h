@@ -146,6 +146,27 @@ namespace triagens {
 
     int useIndexForSortRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief produce only the indexed attributes from an index range if the
+/// documents themselves are not needed
+////////////////////////////////////////////////////////////////////////////////
+
+    int useIndexOnlyRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief evaluate filters on the documents of a full collection scan while
+/// scanning, so the scan and the filters can be split among multiple threads
+////////////////////////////////////////////////////////////////////////////////
+
+    int parallelizeCollectionScanRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief use a geo index for collection scans filtered or sorted by the
+/// distance to a constant point
+////////////////////////////////////////////////////////////////////////////////
+
+    int useGeoIndexRule (Optimizer*, ExecutionPlan*, Optimizer::Rule const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief try to remove filters which are covered by indexes
 ////////////////////////////////////////////////////////////////////////////////
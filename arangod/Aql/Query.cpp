@@ -35,6 +35,7 @@
 #include "Aql/Optimizer.h"
 #include "Aql/Parser.h"
 #include "Aql/QueryList.h"
+#include "Aql/QueryPlanCache.h"
 #include "Basics/JsonHelper.h"
 #include "Basics/json.h"
 #include "Basics/tri-strings.h"
@@ -72,6 +73,70 @@ static std::string StateNames[] = {
 static_assert(sizeof(StateNames) / sizeof(std::string) == static_cast<size_t>(ExecutionState::INVALID_STATE), 
               "invalid number of ExecutionState values");
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return a copy of a plan in JSON format, with the parameter nodes
+/// replaced by the values of the bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_json_t* InjectBindParameters (Ast* ast,
+                                         TRI_json_t const* json,
+                                         BindParametersType const& parameters) {
+  if (TRI_IsObjectJson(json)) {
+    TRI_json_t const* type = TRI_LookupObjectJson(json, "type");
+
+    if (TRI_IsStringJson(type) &&
+        strcmp(type->_value._string.data, "parameter") == 0) {
+      TRI_json_t const* name = TRI_LookupObjectJson(json, "name");
+
+      if (! TRI_IsStringJson(name)) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_INTERNAL);
+      }
+
+      auto it = parameters.find(std::string(name->_value._string.data, name->_value._string.length - 1));
+
+      if (it == parameters.end()) {
+        THROW_ARANGO_EXCEPTION_PARAMS(TRI_ERROR_QUERY_BIND_PARAMETER_MISSING, name->_value._string.data);
+      }
+
+      return ast->nodeFromJson((*it).second.first)->toJson(TRI_UNKNOWN_MEM_ZONE, true);
+    }
+  }
+  else if (! TRI_IsArrayJson(json)) {
+    TRI_json_t* copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+    if (copy == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    return copy;
+  }
+
+  size_t const n = TRI_LengthVector(&json->_value._objects);
+  bool const isObject = TRI_IsObjectJson(json);
+
+  Json copy(TRI_UNKNOWN_MEM_ZONE, isObject ? Json::Object : Json::Array, isObject ? n / 2 : n);
+
+  for (size_t i = 0; i < n; ++i) {
+    if (isObject) {
+      auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i++));
+      auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i));
+
+      copy.set(key->_value._string.data, InjectBindParameters(ast, value, parameters));
+    }
+    else {
+      auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i));
+
+      copy.add(InjectBindParameters(ast, value, parameters));
+    }
+  }
+
+  return copy.steal();
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                    struct Profile
 // -----------------------------------------------------------------------------
@@ -193,7 +258,8 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _warnings(),
     _part(part),
     _contextOwnedByExterior(contextOwnedByExterior),
-    _killed(false) {
+    _killed(false),
+    _cachedPlan(false) {
 
   // std::cout << TRI_CurrentThreadId() << ", QUERY " << this << " CTOR: " << queryString << "\n";
 
@@ -240,7 +306,8 @@ Query::Query (triagens::arango::ApplicationV8* applicationV8,
     _warnings(),
     _part(part),
     _contextOwnedByExterior(contextOwnedByExterior),
-    _killed(false) {
+    _killed(false),
+    _cachedPlan(false) {
 
   // std::cout << TRI_CurrentThreadId() << ", QUERY " << this << " CTOR (JSON): " << _queryJson.toString() << "\n";
 
@@ -518,10 +585,54 @@ QueryResult Query::prepare (QueryRegistry* registry) {
     std::unique_ptr<Parser> parser(new Parser(this));
     std::unique_ptr<ExecutionPlan> plan;
 
-    if (_queryString != nullptr) {
+    // look for an optimized plan of the same query
+    QueryPlanCache* cache = planCache();
+    std::shared_ptr<QueryPlanCacheEntry> cached;
+    std::string cacheKey;
+    uint64_t cacheGeneration = 0;
+
+    if (cache != nullptr) {
+      auto const& bindParameters = _bindParameters();
+      cacheKey = QueryPlanCache::BuildKey(_queryString, _queryLength, bindParameters, _options);
+      cached = cache->lookup(cacheKey, bindParameters, cacheGeneration);
+      _cachedPlan = (cached != nullptr);
+    }
+
+    // values of the bind parameters the plan to be cached was optimized for
+    Json injectedParameters;
+    // whether or not the values of some bind parameters must be injected
+    // into the optimized plan
+    bool injectIntoPlan = false;
+
+    if (_queryString != nullptr && ! _cachedPlan) {
       parser->parse(false);
-      // put in bind parameters
-      parser->ast()->injectBindParameters(_bindParameters);
+
+      if (cache != nullptr) {
+        // only put in the bind parameters the optimizer depends on, so the
+        // plan can be reused with other values for all others
+        auto const structural = parser->ast()->structuralBindParameters(_bindParameters);
+        injectedParameters = Json(TRI_UNKNOWN_MEM_ZONE, Json::Object);
+
+        for (auto const& it : _bindParameters()) {
+          if (it.first[0] == '@') {
+            // collection names are part of the cache key
+            continue;
+          }
+
+          if (structural.find(it.first) == structural.end()) {
+            injectIntoPlan = true;
+          }
+          else {
+            injectedParameters.set(it.first, Json(TRI_UNKNOWN_MEM_ZONE, it.second.first).copy());
+          }
+        }
+
+        parser->ast()->injectBindParameters(_bindParameters, &structural);
+      }
+      else {
+        // put in bind parameters
+        parser->ast()->injectBindParameters(_bindParameters);
+      }
     }
 
     // create the transaction object, but do not start it yet
@@ -530,7 +641,7 @@ QueryResult Query::prepare (QueryRegistry* registry) {
 
     bool planRegisters;
 
-    if (_queryString != nullptr) {
+    if (_queryString != nullptr && ! _cachedPlan) {
       // we have an AST
       int res = _trx->begin();
 
@@ -560,12 +671,50 @@ QueryResult Query::prepare (QueryRegistry* registry) {
       // Now plan and all derived plans belong to the optimizer
       plan.reset(opt.stealBest()); // Now we own the best one again
       planRegisters = true;
+
+      if (injectIntoPlan) {
+        // cache the plan with the parameter nodes, and execute a copy with
+        // the values put in
+        plan->findVarUsage();
+        plan->planRegisters();
+
+        auto json = plan->toJson(parser->ast(), TRI_UNKNOWN_MEM_ZONE, true);
+        Json injected(TRI_UNKNOWN_MEM_ZONE, InjectBindParameters(parser->ast(), json.json(), _bindParameters()));
+
+        if (_warnings.empty()) {
+          try {
+            cache->store(cacheKey, json.steal(), injectedParameters.steal(), _collections.collectionNames(), cacheGeneration);
+          }
+          catch (...) {
+            // caching is optional
+          }
+        }
+
+        plan.reset(ExecutionPlan::instanciateFromJson(parser->ast(), injected));
+
+        if (plan.get() == nullptr) {
+          // oops
+          return QueryResult(TRI_ERROR_INTERNAL);
+        }
+
+        planRegisters = false;
+      }
     }
-    else {   // no queryString, we are instanciating from _queryJson
+    else {   // no queryString or a cached plan, we are instanciating from JSON
+      Json const cachedJson(TRI_UNKNOWN_MEM_ZONE, _cachedPlan ? cached->plan : nullptr, Json::NOFREE);
+      Json injected;
+
+      if (_cachedPlan && ! _bindParameters().empty()) {
+        // put the values of the bind parameters into a copy of the plan
+        injected = Json(TRI_UNKNOWN_MEM_ZONE, InjectBindParameters(parser->ast(), cached->plan, _bindParameters()));
+      }
+
+      Json const& queryJson = _cachedPlan ? (injected.isEmpty() ? cachedJson : injected) : _queryJson;
+
       enterState(PLAN_INSTANCIATION);
-      ExecutionPlan::getCollectionsFromJson(parser->ast(), _queryJson);
+      ExecutionPlan::getCollectionsFromJson(parser->ast(), queryJson);
 
-      parser->ast()->variables()->fromJson(_queryJson);
+      parser->ast()->variables()->fromJson(queryJson);
       // creating the plan may have produced some collections
       // we need to add them to the transaction now (otherwise the query will fail)
 
@@ -580,7 +729,7 @@ QueryResult Query::prepare (QueryRegistry* registry) {
       }
 
       // we have an execution plan in JSON format
-      plan.reset(ExecutionPlan::instanciateFromJson(parser->ast(), _queryJson));
+      plan.reset(ExecutionPlan::instanciateFromJson(parser->ast(), queryJson));
       if (plan.get() == nullptr) {
         // oops
         return QueryResult(TRI_ERROR_INTERNAL);
@@ -613,6 +762,19 @@ QueryResult Query::prepare (QueryRegistry* registry) {
     enterState(EXECUTION);
     ExecutionEngine* engine(ExecutionEngine::instanciateFromPlan(registry, this, plan.get(), planRegisters));
 
+    if (cache != nullptr && ! _cachedPlan && ! injectIntoPlan && _warnings.empty()) {
+      // store the plan including its registers, so the next execution of the
+      // query can skip parsing and optimization. queries that produced
+      // warnings are not cached, because the warnings would get lost
+      try {
+        auto json = plan->toJson(parser->ast(), TRI_UNKNOWN_MEM_ZONE, true);
+        cache->store(cacheKey, json.steal(), injectedParameters.steal(), _collections.collectionNames(), cacheGeneration);
+      }
+      catch (...) {
+        // caching is optional
+      }
+    }
+
     // If all went well so far, then we keep _plan, _parser and _trx and
     // return:
     _plan = plan.release();
@@ -643,16 +805,25 @@ QueryResult Query::prepare (QueryRegistry* registry) {
 ////////////////////////////////////////////////////////////////////////////////
 
 QueryResult Query::execute (QueryRegistry* registry) {
-  // Now start the execution:
-  try {
-    QueryResult res = prepare(registry);
+  QueryResult res = prepare(registry);
 
-    if (res.code != TRI_ERROR_NO_ERROR) {
-      return res;
-    }
+  if (res.code != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
 
+  return executePrepared();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute an AQL query that was prepared before and return its full
+/// result
+////////////////////////////////////////////////////////////////////////////////
+
+QueryResult Query::executePrepared () {
+  TRI_ASSERT(_engine != nullptr);
+
+  try {
     triagens::basics::Json jsonResult(triagens::basics::Json::Array, 16);
-    triagens::basics::Json stats;
 
     // this is the RegisterId our results can be found in
     auto const resultRegister = _engine->resultRegister();
@@ -674,8 +845,7 @@ QueryResult Query::execute (QueryRegistry* registry) {
             jsonResult.add(val.toJson(_trx, doc)); 
           }
         }
-        delete value;
-        value = nullptr;
+        _engine->_itemBlockManager.returnBlock(value);
       }
     }
     catch (...) {
@@ -683,22 +853,8 @@ QueryResult Query::execute (QueryRegistry* registry) {
       throw;
     }
 
-    stats = _engine->_stats.toJson();
-
-    _trx->commit();
-    
-    cleanupPlanAndEngine(TRI_ERROR_NO_ERROR);
-
-    enterState(FINALIZATION); 
-
-    QueryResult result(TRI_ERROR_NO_ERROR);
-    result.warnings = warningsToJson(TRI_UNKNOWN_MEM_ZONE);
-    result.json     = jsonResult.steal();
-    result.stats    = stats.steal(); 
-
-    if (_profile != nullptr && profiling()) {
-      result.profile = _profile->toJson(TRI_UNKNOWN_MEM_ZONE);
-    }
+    QueryResult result = finish();
+    result.json = jsonResult.steal();
 
     return result;
   }
@@ -720,6 +876,47 @@ QueryResult Query::execute (QueryRegistry* registry) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish the execution of a prepared query
+////////////////////////////////////////////////////////////////////////////////
+
+QueryResult Query::finish () {
+  TRI_ASSERT(_engine != nullptr);
+
+  triagens::basics::Json stats = _engine->_stats.toJson();
+  stats.set("cachedPlan", Json(_cachedPlan));
+
+  _trx->commit();
+  
+  cleanupPlanAndEngine(TRI_ERROR_NO_ERROR);
+
+  enterState(FINALIZATION); 
+
+  QueryResult result(TRI_ERROR_NO_ERROR);
+  result.warnings = warningsToJson(TRI_UNKNOWN_MEM_ZONE);
+  result.stats    = stats.steal(); 
+
+  if (_profile != nullptr && profiling()) {
+    result.profile = _profile->toJson(TRI_UNKNOWN_MEM_ZONE);
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the query modifies data
+////////////////////////////////////////////////////////////////////////////////
+
+bool Query::isModificationQuery () const {
+  for (auto const& it : *_collections.collections()) {
+    if (it.second->accessType == TRI_TRANSACTION_WRITE) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief execute an AQL query 
 /// may only be called with an active V8 handle scope
@@ -757,8 +954,7 @@ QueryResultV8 Query::executeV8 (v8::Isolate* isolate, QueryRegistry* registry) {
             result.result->Set(j++, val.toV8(isolate, _trx, doc)); 
           }
         }
-        delete value;
-        value = nullptr;
+        _engine->_itemBlockManager.returnBlock(value);
       }
     }
     catch (...) {
@@ -767,6 +963,7 @@ QueryResultV8 Query::executeV8 (v8::Isolate* isolate, QueryRegistry* registry) {
     }
 
     stats = _engine->_stats.toJson();
+    stats.set("cachedPlan", Json(_cachedPlan));
 
     _trx->commit();
     
@@ -986,9 +1183,13 @@ char* Query::registerString (std::string const& p,
 void Query::enterContext () {
   if (! _contextOwnedByExterior) {
     if (_context == nullptr) {
-      _context = _applicationV8->enterContext("STANDARD", _vocbase, false);
+      _context = _applicationV8->enterContext("STANDARD", _vocbase, false, true);
 
       if (_context == nullptr) {
+        if (TRI_errno() == TRI_ERROR_V8_CONTEXT_TIMEOUT) {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_V8_CONTEXT_TIMEOUT);
+        }
+
         THROW_ARANGO_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "cannot enter V8 context");
       }
     
@@ -1198,6 +1399,29 @@ std::vector<std::string> Query::getRulesFromOptions () const {
   return rules;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the plan cache for the query, or a nullptr if the query's
+/// plan must not be cached
+////////////////////////////////////////////////////////////////////////////////
+
+QueryPlanCache* Query::planCache () const {
+  if (_queryString == nullptr || 
+      _part != PART_MAIN ||
+      triagens::arango::ServerState::instance()->isCoordinator()) {
+    // plans are not cached on a coordinator, because index changes happen on
+    // the DB servers and would not invalidate them
+    return nullptr;
+  }
+
+  auto cache = static_cast<QueryPlanCache*>(_vocbase->_planCache);
+
+  if (cache == nullptr || ! cache->enabled()) {
+    return nullptr;
+  }
+
+  return cache;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief enter a new state
 ////////////////////////////////////////////////////////////////////////////////
@@ -59,6 +59,7 @@ namespace triagens {
     class Expression;
     class Parser;
     class Query;
+    class QueryPlanCache;
     class QueryRegistry;
     struct Variable;
 
@@ -198,6 +199,14 @@ namespace triagens {
           return _part;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the query's plan was taken from the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        inline bool cachedPlan () const {
+          return _cachedPlan;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the vocbase
 ////////////////////////////////////////////////////////////////////////////////
@@ -341,6 +350,30 @@ namespace triagens {
 
         QueryResult execute (QueryRegistry*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute an AQL query that was prepared before and return its full
+/// result
+////////////////////////////////////////////////////////////////////////////////
+
+        QueryResult executePrepared ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish the execution of a prepared query
+///
+/// commits the transaction, frees the plan and the engine, and returns the
+/// statistics, warnings and profile of the query. this is used by callers
+/// that fetch the results from the engine themselves
+////////////////////////////////////////////////////////////////////////////////
+
+        QueryResult finish ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the query modifies data. only valid after the query
+/// was prepared
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isModificationQuery () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief execute an AQL query 
 /// may only be called with an active V8 handle scope
@@ -490,6 +523,13 @@ namespace triagens {
 
         std::vector<std::string> getRulesFromOptions () const;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the plan cache for the query, or a nullptr if the query's
+/// plan must not be cached
+////////////////////////////////////////////////////////////////////////////////
+
+        QueryPlanCache* planCache () const;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief neatly format transaction errors to the user.
 ////////////////////////////////////////////////////////////////////////////////
@@ -695,6 +735,12 @@ namespace triagens {
 
         bool                              _killed;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the query's plan was taken from the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        bool                              _cachedPlan;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not query tracking is disabled globally
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,437 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, cache for optimized execution plans
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Aql/QueryPlanCache.h"
+#include "Basics/JsonHelper.h"
+#include "Basics/MutexLocker.h"
+#include "Basics/json-utilities.h"
+#include "VocBase/vocbase.h"
+
+using namespace triagens::aql;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the kind of a bind parameter value
+////////////////////////////////////////////////////////////////////////////////
+
+static char ValueKind (TRI_json_t const* value) {
+  if (TRI_IsStringJson(value)) {
+    return 's';
+  }
+  if (TRI_IsNumberJson(value)) {
+    return 'n';
+  }
+  if (TRI_IsBooleanJson(value)) {
+    return 'b';
+  }
+  if (TRI_IsArrayJson(value)) {
+    return 'a';
+  }
+  if (TRI_IsObjectJson(value)) {
+    return 'o';
+  }
+  return '0';
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        struct QueryPlanCacheEntry
+// -----------------------------------------------------------------------------
+
+QueryPlanCacheEntry::QueryPlanCacheEntry (std::string const& key,
+                                          TRI_json_t* plan,
+                                          TRI_json_t* parameters,
+                                          std::vector<std::string> const& collections)
+  : key(key),
+    plan(plan),
+    parameters(parameters),
+    collections(collections) {
+}
+
+QueryPlanCacheEntry::~QueryPlanCacheEntry () {
+  if (plan != nullptr) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, plan);
+  }
+  if (parameters != nullptr) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, parameters);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan can be used with the bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+bool QueryPlanCacheEntry::matches (BindParametersType const& bindParameters) const {
+  if (parameters == nullptr) {
+    return true;
+  }
+
+  size_t const n = TRI_LengthVector(&parameters->_value._objects);
+
+  for (size_t i = 0; i < n; i += 2) {
+    auto name = static_cast<TRI_json_t const*>(TRI_AtVector(&parameters->_value._objects, i));
+    auto value = static_cast<TRI_json_t const*>(TRI_AtVector(&parameters->_value._objects, i + 1));
+
+    auto it = bindParameters.find(std::string(name->_value._string.data, name->_value._string.length - 1));
+
+    if (it == bindParameters.end() ||
+        ! TRI_CheckSameValueJson(value, (*it).second.first)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                              class QueryPlanCache
+// -----------------------------------------------------------------------------
+
+size_t QueryPlanCache::DoDefaultMaxEntries = 128;
+
+size_t const QueryPlanCache::MaxEntriesLimit = 16384;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+QueryPlanCache::QueryPlanCache ()
+  : _lock(),
+    _lru(),
+    _entries(),
+    _maxEntries(QueryPlanCache::DefaultMaxEntries()),
+    _generation(0),
+    _hits(0),
+    _misses(0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+QueryPlanCache::~QueryPlanCache () {
+  invalidate();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of plans to keep
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryPlanCache::maxEntries (size_t value) {
+  if (value > MaxEntriesLimit) {
+    // sanity checks
+    value = MaxEntriesLimit;
+  }
+
+  MUTEX_LOCKER(_lock);
+
+  _maxEntries = value;
+  evict();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of plans in the cache
+////////////////////////////////////////////////////////////////////////////////
+
+size_t QueryPlanCache::size () {
+  MUTEX_LOCKER(_lock);
+
+  return _entries.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up a plan that can be used with the bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<QueryPlanCacheEntry> QueryPlanCache::lookup (std::string const& key,
+                                                             BindParametersType const& bindParameters,
+                                                             uint64_t& generation) {
+  MUTEX_LOCKER(_lock);
+
+  auto it = _entries.find(key);
+
+  if (it == _entries.end() ||
+      ! (*(*it).second)->matches(bindParameters)) {
+    generation = _generation;
+    _misses.fetch_add(1, std::memory_order_relaxed);
+
+    return nullptr;
+  }
+
+  // move the plan to the front
+  _lru.splice(_lru.begin(), _lru, (*it).second);
+  _hits.fetch_add(1, std::memory_order_relaxed);
+
+  return *((*it).second);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan and the values of the bind parameters injected before
+/// its optimization
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryPlanCache::store (std::string const& key,
+                            TRI_json_t* plan,
+                            TRI_json_t* parameters,
+                            std::vector<std::string> const& collections,
+                            uint64_t generation) {
+  std::shared_ptr<QueryPlanCacheEntry> entry;
+
+  try {
+    entry.reset(new QueryPlanCacheEntry(key, plan, parameters, collections));
+  }
+  catch (...) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, plan);
+    if (parameters != nullptr) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, parameters);
+    }
+    throw;
+  }
+
+  MUTEX_LOCKER(_lock);
+
+  if (generation != _generation || _maxEntries == 0) {
+    // a collection was changed while the plan was built
+    return;
+  }
+
+  auto it = _entries.find(key);
+
+  if (it != _entries.end()) {
+    // either another thread was faster, or the plan was built for other
+    // values of the bind parameters. the most recent plan wins
+    _lru.erase((*it).second);
+    _entries.erase(it);
+  }
+
+  _lru.emplace_front(entry);
+
+  try {
+    _entries.emplace(key, _lru.begin());
+  }
+  catch (...) {
+    _lru.pop_front();
+    throw;
+  }
+
+  evict();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all plans using the collection
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryPlanCache::invalidate (std::string const& collection) {
+  MUTEX_LOCKER(_lock);
+
+  ++_generation;
+
+  for (auto it = _lru.begin(); it != _lru.end(); /* no hoisting */) {
+    auto const& names = (*it)->collections;
+
+    if (std::find(names.begin(), names.end(), collection) != names.end()) {
+      _entries.erase((*it)->key);
+      it = _lru.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all plans
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryPlanCache::invalidate () {
+  MUTEX_LOCKER(_lock);
+
+  ++_generation;
+  _entries.clear();
+  _lru.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all plans using the collection from the cache of a database
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryPlanCache::InvalidateCollection (TRI_vocbase_t* vocbase,
+                                           char const* collection) {
+  auto planCache = static_cast<QueryPlanCache*>(vocbase->_planCache);
+
+  if (planCache != nullptr) {
+    planCache->invalidate(std::string(collection));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the cache key for a query
+///
+/// runs of whitespace outside of quoted strings, names and comments are
+/// collapsed, so queries differing only in their formatting share a plan. a
+/// run containing a line break is collapsed into a line break, so line
+/// comments keep their meaning. of the bind parameters, only the names and
+/// kinds of the values are part of the key, except for collection names
+////////////////////////////////////////////////////////////////////////////////
+
+std::string QueryPlanCache::BuildKey (char const* queryString,
+                                      size_t length,
+                                      BindParametersType const& bindParameters,
+                                      TRI_json_t const* options) {
+  std::string key;
+  key.reserve(length + 64);
+
+  char const* p = queryString;
+  char const* end = queryString + length;
+  char quote = '\0';
+
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+    ++p;
+  }
+
+  while (p < end) {
+    char c = *p++;
+
+    if (quote != '\0') {
+      key.push_back(c);
+
+      if (c == '\\' && p < end) {
+        key.push_back(*p++);
+      }
+      else if (c == quote) {
+        quote = '\0';
+      }
+    }
+    else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      bool lineBreak = (c == '\n');
+
+      while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) {
+        lineBreak |= (*p == '\n');
+        ++p;
+      }
+
+      if (p < end) {
+        key.push_back(lineBreak ? '\n' : ' ');
+      }
+    }
+    else if (c == '/' && p < end && (*p == '/' || *p == '*')) {
+      // comments are copied verbatim, so quotes inside them are ignored
+      bool lineComment = (*p == '/');
+      key.push_back(c);
+      key.push_back(*p++);
+
+      while (p < end) {
+        c = *p++;
+        key.push_back(c);
+
+        if (lineComment ? (c == '\n') : (c == '*' && p < end && *p == '/')) {
+          if (! lineComment) {
+            key.push_back(*p++);
+          }
+          break;
+        }
+      }
+    }
+    else {
+      if (c == '\'' || c == '"' || c == '`') {
+        quote = c;
+      }
+      key.push_back(c);
+    }
+  }
+
+  key.push_back('\0');
+
+  // the order of the bind parameters must not matter
+  std::vector<std::string> names;
+  names.reserve(bindParameters.size());
+
+  for (auto const& it : bindParameters) {
+    names.emplace_back(it.first);
+  }
+
+  std::sort(names.begin(), names.end());
+
+  for (auto const& name : names) {
+    auto value = bindParameters.find(name)->second.first;
+
+    key.append(name);
+    key.push_back('=');
+
+    if (name[0] == '@') {
+      // collection parameter
+      key.append(value->_value._string.data, value->_value._string.length - 1);
+    }
+    else {
+      key.push_back(ValueKind(value));
+    }
+
+    key.push_back('\0');
+  }
+
+  if (options != nullptr) {
+    key.append(triagens::basics::JsonHelper::toString(options));
+  }
+
+  return key;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove the least recently used plans until the cache fits
+////////////////////////////////////////////////////////////////////////////////
+
+void QueryPlanCache::evict () {
+  while (_entries.size() > _maxEntries) {
+    _entries.erase(_lru.back()->key);
+    _lru.pop_back();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
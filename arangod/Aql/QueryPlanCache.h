@@ -0,0 +1,339 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief Aql, cache for optimized execution plans
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_AQL_QUERY_PLAN_CACHE_H
+#define ARANGODB_AQL_QUERY_PLAN_CACHE_H 1
+
+#include "Basics/Common.h"
+#include "Aql/BindParameters.h"
+#include "Basics/json.h"
+#include "Basics/Mutex.h"
+
+struct TRI_vocbase_s;
+
+namespace triagens {
+  namespace aql {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        struct QueryPlanCacheEntry
+// -----------------------------------------------------------------------------
+
+    struct QueryPlanCacheEntry {
+      QueryPlanCacheEntry (QueryPlanCacheEntry const&) = delete;
+      QueryPlanCacheEntry& operator= (QueryPlanCacheEntry const&) = delete;
+
+      QueryPlanCacheEntry (std::string const&,
+                           TRI_json_t*,
+                           TRI_json_t*,
+                           std::vector<std::string> const&);
+
+      ~QueryPlanCacheEntry ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the plan can be used with the bind parameters
+////////////////////////////////////////////////////////////////////////////////
+
+      bool matches (BindParametersType const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cache key
+////////////////////////////////////////////////////////////////////////////////
+
+      std::string const key;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the optimized plan, including its collections, variables and
+/// registers, in the same format that is used for shipping plans to the
+/// DB servers
+////////////////////////////////////////////////////////////////////////////////
+
+      TRI_json_t* plan;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the values of the bind parameters that were injected before the
+/// plan was optimized, as an object, or a nullptr. the plan can only be used
+/// with the same values
+////////////////////////////////////////////////////////////////////////////////
+
+      TRI_json_t* parameters;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief names of the collections used by the plan
+////////////////////////////////////////////////////////////////////////////////
+
+      std::vector<std::string> const collections;
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                              class QueryPlanCache
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a per-database LRU cache of optimized execution plans
+///
+/// Plans are keyed by the normalized query string, the names and value kinds
+/// of the bind parameters, the names of bound collections and the query
+/// options. The plan of a query with bind parameters is built before their
+/// values are injected, and the values are injected into a copy of the plan
+/// on every use. Values the optimizer depends on (e.g. the LIMIT values) are
+/// injected before optimization and stored with the plan, so the plan is only
+/// used for the same values. Creating or dropping an index and dropping or
+/// renaming a collection removes all plans using the collection.
+////////////////////////////////////////////////////////////////////////////////
+
+    class QueryPlanCache {
+
+      QueryPlanCache (QueryPlanCache const&) = delete;
+      QueryPlanCache& operator= (QueryPlanCache const&) = delete;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        QueryPlanCache ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        ~QueryPlanCache ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not plans are cached
+////////////////////////////////////////////////////////////////////////////////
+
+        inline bool enabled () const {
+          return _maxEntries > 0;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the maximum number of plans to keep
+////////////////////////////////////////////////////////////////////////////////
+
+        inline size_t maxEntries () const {
+          return _maxEntries;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of plans to keep, a value of 0 turns the
+/// cache off
+////////////////////////////////////////////////////////////////////////////////
+
+        void maxEntries (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of lookups that found a plan
+////////////////////////////////////////////////////////////////////////////////
+
+        inline uint64_t hits () const {
+          return _hits.load(std::memory_order_relaxed);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of lookups that did not find a plan
+////////////////////////////////////////////////////////////////////////////////
+
+        inline uint64_t misses () const {
+          return _misses.load(std::memory_order_relaxed);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of plans in the cache
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t size ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up a plan that can be used with the bind parameters
+///
+/// If no plan is found, the current generation of the cache is returned in
+/// the third parameter. It must be passed to store() later, so a plan built
+/// while its collections were changed is not stored.
+////////////////////////////////////////////////////////////////////////////////
+
+        std::shared_ptr<QueryPlanCacheEntry> lookup (std::string const&,
+                                                     BindParametersType const&,
+                                                     uint64_t&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief store a plan and the values of the bind parameters injected before
+/// its optimization, the cache takes over both. a plan stored under the same
+/// key is replaced
+////////////////////////////////////////////////////////////////////////////////
+
+        void store (std::string const&,
+                    TRI_json_t*,
+                    TRI_json_t*,
+                    std::vector<std::string> const&,
+                    uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all plans using the collection
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all plans
+////////////////////////////////////////////////////////////////////////////////
+
+        void invalidate ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove all plans using the collection from the cache of a database
+////////////////////////////////////////////////////////////////////////////////
+
+        static void InvalidateCollection (struct TRI_vocbase_s*,
+                                          char const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the cache key for a query
+////////////////////////////////////////////////////////////////////////////////
+
+        static std::string BuildKey (char const*,
+                                     size_t,
+                                     BindParametersType const&,
+                                     TRI_json_t const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the default maximum number of plans per database
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t DefaultMaxEntries () {
+          return DoDefaultMaxEntries;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the default maximum number of plans per database
+////////////////////////////////////////////////////////////////////////////////
+
+        static void DefaultMaxEntries (size_t value) {
+          DoDefaultMaxEntries = (std::min)(value, MaxEntriesLimit);
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove the least recently used plans until the cache fits
+///
+/// the caller must hold the lock
+////////////////////////////////////////////////////////////////////////////////
+
+        void evict ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lock for the cache
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::Mutex _lock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cached plans, the most recently used plan is at the front
+////////////////////////////////////////////////////////////////////////////////
+
+        std::list<std::shared_ptr<QueryPlanCacheEntry>> _lru;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cached plans by key
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<std::string, std::list<std::shared_ptr<QueryPlanCacheEntry>>::iterator> _entries;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of plans to keep
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _maxEntries;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief generation, increased on every invalidation
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _generation;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of lookups that found a plan
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint64_t> _hits;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of lookups that did not find a plan
+////////////////////////////////////////////////////////////////////////////////
+
+        std::atomic<uint64_t> _misses;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief default maximum number of plans per database
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t DoDefaultMaxEntries;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief upper bound for the maximum number of plans
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const MaxEntriesLimit;
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -35,6 +35,7 @@
 #include "Basics/tri-strings.h"
 #include "Basics/vector.h"
 #include "Basics/json-utilities.h"
+#include "Basics/StringBuffer.h"
 #include "Basics/StringUtils.h"
 #include "VocBase/index.h"
 #include "VocBase/server.h"
@@ -432,6 +433,10 @@ int figuresOnCoordinator (string const& dbname,
             result->_journalfileSize      += ExtractFigure<int64_t>(figures, "journals", "fileSize");
             result->_compactorfileSize    += ExtractFigure<int64_t>(figures, "compactors", "fileSize");
             result->_shapefileSize        += ExtractFigure<int64_t>(figures, "shapefiles", "fileSize");
+
+            result->_datafileResidentSize      += ExtractFigure<int64_t>(figures, "datafiles", "residentSize");
+            result->_journalfileResidentSize   += ExtractFigure<int64_t>(figures, "journals", "residentSize");
+            result->_compactorfileResidentSize += ExtractFigure<int64_t>(figures, "compactors", "residentSize");
           }
           nrok++;
         }
@@ -629,6 +634,225 @@ int createDocumentOnCoordinator (
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief imports documents in a coordinator
+///
+/// the documents are partitioned by their responsible shards, and each shard
+/// gets all of its documents in a single import request. The requests to the
+/// shards are sent in parallel. Keys are created for documents without a key,
+/// and user-specified keys are checked as in createDocumentOnCoordinator.
+/// Documents that cannot be sent to a shard, and all documents of a shard
+/// that fails or does not answer, are reported in result.rejected. The errors
+/// reported by the shards for single documents are reported in result.errors.
+/// In both cases the index of the document in the vector is reported
+////////////////////////////////////////////////////////////////////////////////
+
+int importDocumentsOnCoordinator (
+                string const& dbname,
+                string const& collname,
+                vector<TRI_json_t*> const& documents,
+                bool waitForSync,
+                bool complete,
+                string const& onDuplicate,
+                map<string, string> const& headers,
+                CoordinatorImportResult& result) {
+
+  // Set a few variables needed for our work:
+  ClusterInfo* ci = ClusterInfo::instance();
+  ClusterComm* cc = ClusterComm::instance();
+
+  // First determine the collection ID from the name:
+  shared_ptr<CollectionInfo> collinfo = ci->getCollection(dbname, collname);
+
+  if (collinfo->empty()) {
+    return TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND;
+  }
+
+  string const collid = StringUtils::itoa(collinfo->id());
+
+  // fetch the keys for all documents without a _key attribute at once
+  uint64_t numKeys = 0;
+
+  for (auto json : documents) {
+    if (TRI_LookupObjectJson(json, TRI_VOC_ATTRIBUTE_KEY) == nullptr) {
+      ++numKeys;
+    }
+  }
+
+  uint64_t uid = 0;
+
+  if (numKeys > 0) {
+    uid = ci->uniqid(numKeys);
+
+    if (uid == 0) {
+      return TRI_ERROR_INTERNAL;
+    }
+  }
+
+  // the indexes of the documents of each shard
+  map<ShardID, vector<size_t>> shardDocuments;
+
+  for (size_t i = 0; i < documents.size(); ++i) {
+    TRI_json_t* json = documents[i];
+    bool userSpecifiedKey = true;
+
+    if (TRI_LookupObjectJson(json, TRI_VOC_ATTRIBUTE_KEY) == nullptr) {
+      string const key = StringUtils::itoa(uid++);
+
+      TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, json, TRI_VOC_ATTRIBUTE_KEY,
+                            TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, key.c_str(), key.size()));
+      userSpecifiedKey = false;
+    }
+
+    bool usesDefaultShardingAttributes;
+    ShardID shardID;
+    int error = ci->getResponsibleShard(collid, json, true, shardID,
+                                        usesDefaultShardingAttributes);
+
+    if (error == TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND) {
+      return TRI_ERROR_CLUSTER_SHARD_GONE;
+    }
+
+    if (error == TRI_ERROR_NO_ERROR &&
+        userSpecifiedKey &&
+        (! usesDefaultShardingAttributes || ! collinfo->allowUserKeys())) {
+      error = TRI_ERROR_CLUSTER_MUST_NOT_SPECIFY_KEY;
+    }
+
+    if (error != TRI_ERROR_NO_ERROR) {
+      if (complete) {
+        // a full import was requested, so nothing is imported
+        return error;
+      }
+
+      result.rejected.emplace_back(i, error);
+      continue;
+    }
+
+    shardDocuments[shardID].emplace_back(i);
+  }
+
+  // send the documents of each shard as one import request
+  string parameters = string("&type=documents&details=true") +
+                      "&waitForSync=" + (waitForSync ? "true" : "false") +
+                      "&complete=" + (complete ? "true" : "false");
+
+  if (! onDuplicate.empty()) {
+    parameters += "&onDuplicate=" + StringUtils::urlEncode(onDuplicate);
+  }
+
+  ClusterCommResult* res;
+  CoordTransactionID coordTransactionID = TRI_NewTickServer();
+
+  for (auto const& it : shardDocuments) {
+    StringBuffer buffer(TRI_UNKNOWN_MEM_ZONE);
+
+    for (auto i : it.second) {
+      TRI_StringifyJson(buffer.stringBuffer(), documents[i]);
+      buffer.appendChar('\n');
+    }
+
+    string* body = new string(buffer.c_str(), buffer.length());
+    map<string, string>* headersCopy = new map<string, string>(headers);
+
+    res = cc->asyncRequest("", coordTransactionID, "shard:" + it.first,
+                           triagens::rest::HttpRequest::HTTP_REQUEST_POST,
+                           "/_db/" + StringUtils::urlEncode(dbname) + "/_api/import?collection=" +
+                           StringUtils::urlEncode(it.first) + parameters,
+                           body, true, headersCopy, nullptr, 300.0);
+    delete res;
+  }
+
+  // Now listen to the results. a shard that fails does not fail the whole
+  // import, its documents are reported as rejected instead, so the result
+  // still contains the documents imported by the other shards
+  int error = TRI_ERROR_NO_ERROR;
+
+  for (size_t count = shardDocuments.size(); count > 0; --count) {
+    res = cc->wait("", coordTransactionID, 0, "", 0.0);
+
+    auto it = shardDocuments.find(res->shardID);
+
+    if (it == shardDocuments.end()) {
+      // no request is known for this answer
+      error = TRI_ERROR_INTERNAL;
+    }
+    else if (res->status == CL_COMM_TIMEOUT) {
+      for (auto i : (*it).second) {
+        result.rejected.emplace_back(i, TRI_ERROR_CLUSTER_TIMEOUT);
+      }
+    }
+    else if (res->status != CL_COMM_RECEIVED) {
+      for (auto i : (*it).second) {
+        result.rejected.emplace_back(i, TRI_ERROR_CLUSTER_CONNECTION_LOST);
+      }
+    }
+    else {
+      TRI_json_t* json = TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, res->answer->body());
+
+      if (res->answer_code != triagens::rest::HttpResponse::CREATED ||
+          ! JsonHelper::isObject(json)) {
+        // the shard did not import its documents, e.g. because of complete
+        int const code = JsonHelper::getNumericValue<int>(json, "errorNum", TRI_ERROR_INTERNAL);
+
+        for (auto i : (*it).second) {
+          result.rejected.emplace_back(i, code);
+        }
+      }
+      else {
+        vector<size_t> const& indexes = (*it).second;
+
+        result.numCreated += JsonHelper::getNumericValue<size_t>(json, "created", 0);
+        result.numErrors  += JsonHelper::getNumericValue<size_t>(json, "errors", 0);
+        result.numUpdated += JsonHelper::getNumericValue<size_t>(json, "updated", 0);
+        result.numIgnored += JsonHelper::getNumericValue<size_t>(json, "ignored", 0);
+
+        // map the positions in the messages back to the documents. the
+        // shard's documents are numbered from 1, one per line
+        TRI_json_t const* details = TRI_LookupObjectJson(json, "details");
+
+        if (TRI_IsArrayJson(details)) {
+          static string const prefix("at position ");
+
+          for (size_t j = 0; j < details->_value._objects._length; ++j) {
+            auto detail = static_cast<TRI_json_t const*>(TRI_AtVector(&details->_value._objects, j));
+
+            if (! TRI_IsStringJson(detail)) {
+              continue;
+            }
+
+            string message(detail->_value._string.data, detail->_value._string.length - 1);
+            size_t index = indexes[0];
+
+            if (message.compare(0, prefix.size(), prefix) == 0) {
+              size_t const colon = message.find(": ", prefix.size());
+
+              if (colon != string::npos) {
+                uint64_t position = StringUtils::uint64(message.substr(prefix.size(), colon - prefix.size()));
+
+                if (position >= 1 && position <= indexes.size()) {
+                  index = indexes[position - 1];
+                }
+                message = message.substr(colon + 2);
+              }
+            }
+
+            result.errors.emplace_back(index, message);
+          }
+        }
+      }
+
+      if (json != nullptr) {
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+      }
+    }
+
+    delete res;
+  }
+
+  return error;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief deletes a document in a coordinator
 ////////////////////////////////////////////////////////////////////////////////
@@ -121,6 +121,47 @@ namespace triagens {
                  std::map<std::string, std::string>& resultHeaders,
                  std::string& resultBody);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief result of importing documents in a coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+    struct CoordinatorImportResult {
+      CoordinatorImportResult ()
+        : numCreated(0),
+          numErrors(0),
+          numUpdated(0),
+          numIgnored(0),
+          rejected(),
+          errors() {
+      }
+
+      size_t numCreated;
+      size_t numErrors;
+      size_t numUpdated;
+      size_t numIgnored;
+
+      // documents that were not sent to a shard or whose shard failed, with
+      // the reason
+      std::vector<std::pair<size_t, int>> rejected;
+
+      // error messages reported by the shards, without the position prefix
+      std::vector<std::pair<size_t, std::string>> errors;
+    };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief imports documents in a coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+    int importDocumentsOnCoordinator (
+                 std::string const& dbname,
+                 std::string const& collname,
+                 std::vector<TRI_json_t*> const& documents,
+                 bool waitForSync,
+                 bool complete,
+                 std::string const& onDuplicate,
+                 std::map<std::string, std::string> const& headers,
+                 CoordinatorImportResult& result);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief delete a document in a coordinator
 ////////////////////////////////////////////////////////////////////////////////
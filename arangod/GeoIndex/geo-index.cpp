@@ -312,6 +312,22 @@ static TRI_json_t* JsonGeo2Index (TRI_index_t const* idx) {
   return json;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remembers a document without valid coordinates
+////////////////////////////////////////////////////////////////////////////////
+
+static int AddUnindexed (TRI_geo_index_t* geo,
+                         TRI_doc_mptr_t const* doc) {
+  try {
+    geo->_unindexed->emplace(doc);
+  }
+  catch (...) {
+    return TRI_set_errno(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief inserts a new document
 ////////////////////////////////////////////////////////////////////////////////
@@ -349,7 +365,7 @@ static int InsertGeoIndex (TRI_index_t* idx,
   }
 
   if (! ok) {
-    return TRI_ERROR_NO_ERROR;
+    return AddUnindexed(geo, doc);
   }
 
   // and insert into index
@@ -368,12 +384,14 @@ static int InsertGeoIndex (TRI_index_t* idx,
   }
   else if (res == -3) {
     LOG_DEBUG("illegal geo-coordinates, ignoring entry");
-    return TRI_ERROR_NO_ERROR;
+    return AddUnindexed(geo, doc);
   }
   else if (res < 0) {
     return TRI_set_errno(TRI_ERROR_INTERNAL);
   }
 
+  ++geo->_count;
+
   return TRI_ERROR_NO_ERROR;
 }
 
@@ -413,9 +431,14 @@ static int RemoveGeoIndex (TRI_index_t* idx,
     gc.data = CONST_CAST(doc);
 
     // ignore non-existing elements in geo-index
-    GeoIndex_remove(geo->_geoIndex, &gc);
+    if (GeoIndex_remove(geo->_geoIndex, &gc) == 0) {
+      --geo->_count;
+      return TRI_ERROR_NO_ERROR;
+    }
   }
 
+  geo->_unindexed->erase(doc);
+
   return TRI_ERROR_NO_ERROR;
 }
 
@@ -449,9 +472,14 @@ TRI_index_t* TRI_CreateGeo1Index (TRI_document_collection_t* document,
   TRI_PushBackVectorString(&idx->_fields, ln);
 
   geo->_geoIndex = GeoIndex_new();
+  geo->_unindexed = new (std::nothrow) std::unordered_set<TRI_doc_mptr_t const*>();
 
   // oops, out of memory?
-  if (geo->_geoIndex == NULL) {
+  if (geo->_geoIndex == NULL || geo->_unindexed == nullptr) {
+    if (geo->_geoIndex != NULL) {
+      GeoIndex_free(geo->_geoIndex);
+    }
+    delete geo->_unindexed;
     TRI_DestroyVectorString(&idx->_fields);
     TRI_Free(TRI_CORE_MEM_ZONE, geo);
     return NULL;
@@ -462,6 +490,7 @@ TRI_index_t* TRI_CreateGeo1Index (TRI_document_collection_t* document,
   geo->_latitude   = 0;
   geo->_longitude  = 0;
   geo->_geoJson    = geoJson;
+  geo->_count      = 0;
 
   return idx;
 }
@@ -496,9 +525,14 @@ TRI_index_t* TRI_CreateGeo2Index (TRI_document_collection_t* document,
   TRI_PushBackVectorString(&idx->_fields, lon);
 
   geo->_geoIndex = GeoIndex_new();
+  geo->_unindexed = new (std::nothrow) std::unordered_set<TRI_doc_mptr_t const*>();
 
   // oops, out of memory?
-  if (geo->_geoIndex == NULL) {
+  if (geo->_geoIndex == NULL || geo->_unindexed == nullptr) {
+    if (geo->_geoIndex != NULL) {
+      GeoIndex_free(geo->_geoIndex);
+    }
+    delete geo->_unindexed;
     TRI_DestroyVectorString(&idx->_fields);
     TRI_Free(TRI_CORE_MEM_ZONE, geo);
     return NULL;
@@ -508,6 +542,7 @@ TRI_index_t* TRI_CreateGeo2Index (TRI_document_collection_t* document,
   geo->_location   = 0;
   geo->_latitude   = latitude;
   geo->_longitude  = longitude;
+  geo->_count      = 0;
 
   return idx;
 }
@@ -524,6 +559,7 @@ void TRI_DestroyGeoIndex (TRI_index_t* idx) {
   geo = (TRI_geo_index_t*) idx;
 
   GeoIndex_free(geo->_geoIndex);
+  delete geo->_unindexed;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -574,6 +610,22 @@ GeoCoordinates* TRI_NearestGeoIndex (TRI_index_t* idx,
   return GeoIndex_NearestCountPoints(geo->_geoIndex, &gc, (int) count);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of documents in the index
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_CountGeoIndex (TRI_index_t const* idx) {
+  return ((TRI_geo_index_t const*) idx)->_count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the documents without valid coordinates
+////////////////////////////////////////////////////////////////////////////////
+
+std::unordered_set<TRI_doc_mptr_t const*> const& TRI_UnindexedGeoIndex (TRI_index_t const* idx) {
+  return *((TRI_geo_index_t const*) idx)->_unindexed;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -97,6 +97,23 @@ GeoCoordinates* TRI_NearestGeoIndex (TRI_index_t* idx,
                                      double lon,
                                      size_t count);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of documents in the index
+///
+/// documents without valid coordinates are not contained in the index
+////////////////////////////////////////////////////////////////////////////////
+
+size_t TRI_CountGeoIndex (TRI_index_t const* idx);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the documents without valid coordinates
+///
+/// these are kept up to date on every insert and remove, so they can be found
+/// without scanning the collection
+////////////////////////////////////////////////////////////////////////////////
+
+std::unordered_set<struct TRI_doc_mptr_t const*> const& TRI_UnindexedGeoIndex (TRI_index_t const* idx);
+
 #endif
 
 // -----------------------------------------------------------------------------
@@ -34,6 +34,7 @@
 #include "Basics/logging.h"
 #include "Basics/tri-strings.h"
 #include "Basics/JsonHelper.h"
+#include "Basics/ScopeGuard.h"
 #include "Basics/StringUtils.h"
 #include "SimpleHttpClient/SimpleHttpClient.h"
 #include "SimpleHttpClient/SimpleHttpResult.h"
@@ -41,6 +42,7 @@
 #include "Utils/transactions.h"
 #include "VocBase/index.h"
 #include "VocBase/document-collection.h"
+#include "VocBase/replication-dump.h"
 #include "VocBase/vocbase.h"
 #include "VocBase/voc-types.h"
 
@@ -50,6 +52,22 @@ using namespace triagens::arango;
 using namespace triagens::httpclient;
 using namespace triagens::rest;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of keys per key range for the incremental synchronisation
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t const KeysChunkSize = 5000;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of documents to fetch from the master in one go
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MaxDocumentsPerFetch = 1000;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  helper functions
 // -----------------------------------------------------------------------------
@@ -80,7 +98,8 @@ InitialSyncer::InitialSyncer (TRI_vocbase_t* vocbase,
                               TRI_replication_applier_configuration_t const* configuration,
                               std::unordered_map<string, bool> const& restrictCollections,
                               string const& restrictType,
-                              bool verbose) :
+                              bool verbose,
+                              bool incremental) :
   Syncer(vocbase, configuration),
   _progress("not started"),
   _restrictCollections(restrictCollections),
@@ -92,6 +111,7 @@ InitialSyncer::InitialSyncer (TRI_vocbase_t* vocbase,
   _includeSystem(false),
   _chunkSize(),
   _verbose(verbose),
+  _incremental(incremental),
   _hasFlushed(false) {
 
   uint64_t c = configuration->_chunkSize;
@@ -608,6 +628,404 @@ int InitialSyncer::handleCollectionDump (string const& cid,
   return TRI_ERROR_INTERNAL;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetch the documents with the specified keys from the master, using
+/// the keys snapshot with the specified id
+////////////////////////////////////////////////////////////////////////////////
+
+int InitialSyncer::fetchDocuments (string const& keysId,
+                                   TRI_transaction_collection_t* trxCollection,
+                                   vector<string> const& keys,
+                                   string& errorMsg) {
+  if (keys.empty()) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  sendExtendBatch();
+
+  // keys are user-defined, but do not need escaping
+  string body("[");
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (i > 0) {
+      body.push_back(',');
+    }
+    body.push_back('"');
+    body.append(keys[i]);
+    body.push_back('"');
+  }
+
+  body.push_back(']');
+
+  map<string, string> headers;
+  string const url = BaseUrl + "/keys/" + keysId + "?type=docs&serverId=" + _localServerIdString;
+
+  SimpleHttpResult* response = _client->request(HttpRequest::HTTP_REQUEST_PUT,
+                                                url,
+                                                body.c_str(),
+                                                body.size(),
+                                                headers);
+
+  if (response == nullptr || ! response->isComplete()) {
+    errorMsg = "could not connect to master at " + string(_masterInfo._endpoint) +
+               ": " + _client->getErrorMessage();
+
+    if (response != nullptr) {
+      delete response;
+    }
+
+    return TRI_ERROR_REPLICATION_NO_RESPONSE;
+  }
+
+  if (response->wasHttpError()) {
+    errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+               ": HTTP " + StringUtils::itoa(response->getHttpReturnCode()) +
+               ": " + response->getHttpReturnMessage();
+
+    delete response;
+
+    return TRI_ERROR_REPLICATION_MASTER_ERROR;
+  }
+
+  int res = applyCollectionDump(trxCollection, response, errorMsg);
+
+  delete response;
+
+  return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief incrementally synchronise a collection with the master, using
+/// checksums over key ranges
+///
+/// the master keeps a sorted snapshot of its keys, splits it into ranges and
+/// sends a checksum over the keys and revisions of each range. ranges with
+/// identical checksums are skipped. for all other ranges the full list of keys and revisions is
+/// fetched and compared with the local state: documents missing on the master
+/// are removed locally, and documents missing locally or with a different
+/// revision are fetched from the master
+////////////////////////////////////////////////////////////////////////////////
+
+int InitialSyncer::handleCollectionSync (string const& cid,
+                                         TRI_transaction_collection_t* trxCollection,
+                                         string const& collectionName,
+                                         string& errorMsg) {
+  sendExtendBatch();
+
+  map<string, string> headers;
+  string url = BaseUrl + "/keys?collection=" + cid + "&serverId=" + _localServerIdString;
+
+  string progress = "creating master keys snapshot for collection '" + collectionName +
+                    "', id " + cid;
+  setProgress(progress);
+
+  SimpleHttpResult* response = _client->request(HttpRequest::HTTP_REQUEST_POST,
+                                                url,
+                                                nullptr,
+                                                0,
+                                                headers);
+
+  if (response == nullptr || ! response->isComplete()) {
+    errorMsg = "could not connect to master at " + string(_masterInfo._endpoint) +
+               ": " + _client->getErrorMessage();
+
+    if (response != nullptr) {
+      delete response;
+    }
+
+    return TRI_ERROR_REPLICATION_NO_RESPONSE;
+  }
+
+  if (response->wasHttpError()) {
+    errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+               ": HTTP " + StringUtils::itoa(response->getHttpReturnCode()) +
+               ": " + response->getHttpReturnMessage();
+
+    delete response;
+
+    return TRI_ERROR_REPLICATION_MASTER_ERROR;
+  }
+
+  Json snapshot(TRI_UNKNOWN_MEM_ZONE, TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, response->getBody().c_str()));
+
+  delete response;
+
+  string const keysId = JsonHelper::getStringValue(snapshot.json(), "id", "");
+
+  if (keysId.empty()) {
+    errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+               ": keys snapshot id is missing";
+
+    return TRI_ERROR_REPLICATION_INVALID_RESPONSE;
+  }
+
+  string const keysUrl = BaseUrl + "/keys/" + keysId;
+
+  // the master keeps the sorted keys until the snapshot is removed
+  triagens::basics::ScopeGuard guard{
+    [] () -> void { },
+    [&] () -> void {
+      SimpleHttpResult* response = _client->request(HttpRequest::HTTP_REQUEST_DELETE,
+                                                    keysUrl + "?serverId=" + _localServerIdString,
+                                                    nullptr,
+                                                    0,
+                                                    headers);
+
+      if (response != nullptr) {
+        delete response;
+      }
+    }
+  };
+
+  url = keysUrl + "?chunkSize=" + StringUtils::itoa(KeysChunkSize) +
+        "&serverId=" + _localServerIdString;
+
+  progress = "fetching master key ranges for collection '" + collectionName +
+             "', id " + cid;
+  setProgress(progress);
+
+  response = _client->request(HttpRequest::HTTP_REQUEST_GET,
+                              url,
+                              nullptr,
+                              0,
+                              headers);
+
+  if (response == nullptr || ! response->isComplete()) {
+    errorMsg = "could not connect to master at " + string(_masterInfo._endpoint) +
+               ": " + _client->getErrorMessage();
+
+    if (response != nullptr) {
+      delete response;
+    }
+
+    return TRI_ERROR_REPLICATION_NO_RESPONSE;
+  }
+
+  if (response->wasHttpError()) {
+    errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+               ": HTTP " + StringUtils::itoa(response->getHttpReturnCode()) +
+               ": " + response->getHttpReturnMessage();
+
+    delete response;
+
+    return TRI_ERROR_REPLICATION_MASTER_ERROR;
+  }
+
+  Json chunks(TRI_UNKNOWN_MEM_ZONE, TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, response->getBody().c_str()));
+
+  delete response;
+
+  if (! JsonHelper::isArray(chunks.json())) {
+    errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+               ": response is no array";
+
+    return TRI_ERROR_REPLICATION_INVALID_RESPONSE;
+  }
+
+  // collect the local keys. the surrounding transaction holds the write lock
+  // of the collection already
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+  vector<TRI_replication_key_t> localKeys;
+
+  try {
+    TRI_CollectKeysReplication(document, localKeys);
+  }
+  catch (...) {
+    errorMsg = "could not collect local keys";
+
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  size_t const numLocal = localKeys.size();
+  size_t const numChunks = chunks.json()->_value._objects._length;
+  size_t current = 0;
+  size_t differing = 0;
+  vector<string> toFetch;
+  int res = TRI_ERROR_NO_ERROR;
+
+  auto removeLocal = [&] (string const& key) -> int {
+    return applyCollectionDumpMarker(trxCollection, REPLICATION_MARKER_REMOVE, (TRI_voc_key_t const) key.c_str(), 0, nullptr, errorMsg);
+  };
+
+  auto fetchIfFull = [&] () -> int {
+    if (toFetch.size() < MaxDocumentsPerFetch) {
+      return TRI_ERROR_NO_ERROR;
+    }
+    int res = fetchDocuments(keysId, trxCollection, toFetch, errorMsg);
+    toFetch.clear();
+    return res;
+  };
+
+  for (size_t i = 0; i < numChunks; ++i) {
+    TRI_json_t const* chunk = static_cast<TRI_json_t const*>(TRI_AtVector(&chunks.json()->_value._objects, i));
+
+    string const low  = JsonHelper::getStringValue(chunk, "low", "");
+    string const high = JsonHelper::getStringValue(chunk, "high", "");
+    string const hash = JsonHelper::getStringValue(chunk, "hash", "");
+    size_t const count = JsonHelper::getNumericValue<size_t>(chunk, "count", 0);
+
+    if (low.empty() || high.empty() || hash.empty()) {
+      errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+                 ": invalid key range";
+
+      return TRI_ERROR_REPLICATION_INVALID_RESPONSE;
+    }
+
+    // local documents before this range do not exist on the master
+    while (current < numLocal && localKeys[current].first < low) {
+      res = removeLocal(localKeys[current].first);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+      ++current;
+    }
+
+    size_t const from = current;
+
+    while (current < numLocal && localKeys[current].first <= high) {
+      ++current;
+    }
+
+    if (current - from == count &&
+        StringUtils::uint64(hash) == TRI_ChecksumKeysReplication(localKeys, from, current)) {
+      // range is identical on master and slave
+      continue;
+    }
+
+    ++differing;
+
+    // range differs. now fetch the master's keys for it
+    sendExtendBatch();
+
+    string const body = "{\"low\":\"" + low + "\",\"high\":\"" + high + "\"}";
+
+    response = _client->request(HttpRequest::HTTP_REQUEST_PUT,
+                                keysUrl + "?type=keys&serverId=" + _localServerIdString,
+                                body.c_str(),
+                                body.size(),
+                                headers);
+
+    if (response == nullptr || ! response->isComplete()) {
+      errorMsg = "could not connect to master at " + string(_masterInfo._endpoint) +
+                 ": " + _client->getErrorMessage();
+
+      if (response != nullptr) {
+        delete response;
+      }
+
+      return TRI_ERROR_REPLICATION_NO_RESPONSE;
+    }
+
+    if (response->wasHttpError()) {
+      errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+                 ": HTTP " + StringUtils::itoa(response->getHttpReturnCode()) +
+                 ": " + response->getHttpReturnMessage();
+
+      delete response;
+
+      return TRI_ERROR_REPLICATION_MASTER_ERROR;
+    }
+
+    Json masterKeys(TRI_UNKNOWN_MEM_ZONE, TRI_JsonString(TRI_UNKNOWN_MEM_ZONE, response->getBody().c_str()));
+
+    delete response;
+
+    if (! JsonHelper::isArray(masterKeys.json())) {
+      errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+                 ": response is no array";
+
+      return TRI_ERROR_REPLICATION_INVALID_RESPONSE;
+    }
+
+    // merge the sorted master keys with the sorted local keys of the range
+    size_t const numMaster = masterKeys.json()->_value._objects._length;
+    size_t local = from;
+
+    for (size_t j = 0; j < numMaster; ++j) {
+      TRI_json_t const* pair = static_cast<TRI_json_t const*>(TRI_AtVector(&masterKeys.json()->_value._objects, j));
+
+      if (! JsonHelper::isArray(pair) || pair->_value._objects._length != 2) {
+        errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+                   ": invalid key";
+
+        return TRI_ERROR_REPLICATION_INVALID_RESPONSE;
+      }
+
+      TRI_json_t const* k = static_cast<TRI_json_t const*>(TRI_AtVector(&pair->_value._objects, 0));
+      TRI_json_t const* r = static_cast<TRI_json_t const*>(TRI_AtVector(&pair->_value._objects, 1));
+
+      if (! JsonHelper::isString(k) || ! JsonHelper::isString(r)) {
+        errorMsg = "got invalid response from master at " + string(_masterInfo._endpoint) +
+                   ": invalid key";
+
+        return TRI_ERROR_REPLICATION_INVALID_RESPONSE;
+      }
+
+      string const key(k->_value._string.data, k->_value._string.length - 1);
+      TRI_voc_rid_t const rid = StringUtils::uint64(r->_value._string.data, r->_value._string.length - 1);
+
+      while (local < current && localKeys[local].first < key) {
+        // local document does not exist on the master
+        res = removeLocal(localKeys[local].first);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+        ++local;
+      }
+
+      if (local < current && localKeys[local].first == key) {
+        if (localKeys[local].second != rid) {
+          // document differs
+          toFetch.emplace_back(key);
+        }
+        ++local;
+      }
+      else {
+        // document is missing locally
+        toFetch.emplace_back(key);
+      }
+
+      res = fetchIfFull();
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+    }
+
+    // remaining local documents of the range do not exist on the master
+    while (local < current) {
+      res = removeLocal(localKeys[local].first);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+      ++local;
+    }
+  }
+
+  // local documents after the last range do not exist on the master
+  while (current < numLocal) {
+    res = removeLocal(localKeys[current].first);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+    ++current;
+  }
+
+  res = fetchDocuments(keysId, trxCollection, toFetch, errorMsg);
+
+  if (res == TRI_ERROR_NO_ERROR) {
+    setProgress("incremental sync for collection '" + collectionName + "' found " +
+                StringUtils::itoa(differing) + " of " + StringUtils::itoa(numChunks) +
+                " key ranges differing");
+  }
+
+  return res;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief handle the information about a collection
 ////////////////////////////////////////////////////////////////////////////////
@@ -684,6 +1102,14 @@ int InitialSyncer::handleCollection (TRI_json_t const* parameters,
     }
 
     if (col != nullptr) {
+      TRI_col_type_e const type = (TRI_col_type_e) JsonHelper::getNumericValue<int>(parameters, "type", (int) TRI_COL_TYPE_DOCUMENT);
+
+      if (_incremental && 
+          (TRI_col_type_t) col->_type == (TRI_col_type_t) type) {
+        // keep the collection. its data will be synchronised incrementally
+        return TRI_ERROR_NO_ERROR;
+      }
+
       bool truncate = false;
 
       if (col->_name[0] == '_' && 
@@ -799,6 +1225,11 @@ int InitialSyncer::handleCollection (TRI_json_t const* parameters,
         res = TRI_ERROR_INTERNAL;
         errorMsg = "unable to start transaction: " + string(TRI_errno_string(res));
       }
+      else if (_incremental && 
+               trxCollection->_collection->_collection->_primaryIndex._nrUsed > 0) {
+        // collection has data already. only transfer the differences
+        res = handleCollectionSync(StringUtils::itoa(cid), trxCollection, masterName, errorMsg);
+      }
       else {
         res = handleCollectionDump(StringUtils::itoa(cid), trxCollection, masterName, _masterInfo._lastLogTick, errorMsg);
       }
@@ -91,6 +91,7 @@ namespace triagens {
                        struct TRI_replication_applier_configuration_s const*,
                        std::unordered_map<std::string, bool> const&,
                        std::string const&,
+                       bool,
                        bool);
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -182,6 +183,26 @@ namespace triagens {
                                   TRI_voc_tick_t,
                                   std::string&);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fetch the documents with the specified keys from the master, using
+/// the keys snapshot with the specified id
+////////////////////////////////////////////////////////////////////////////////
+
+        int fetchDocuments (std::string const&,
+                            struct TRI_transaction_collection_s*,
+                            std::vector<std::string> const&,
+                            std::string&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief incrementally synchronise a collection with the master, using
+/// checksums over key ranges
+////////////////////////////////////////////////////////////////////////////////
+
+        int handleCollectionSync (std::string const&,
+                                  struct TRI_transaction_collection_s*,
+                                  std::string const&,
+                                  std::string&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief handle the information about a collection
 ////////////////////////////////////////////////////////////////////////////////
@@ -272,6 +293,13 @@ namespace triagens {
 
         bool _verbose;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not existing collections are synchronised incrementally
+/// instead of being dropped and re-transferred completely
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _incremental;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not the WAL on the remote server has been flushed by us
 ////////////////////////////////////////////////////////////////////////////////
@@ -29,8 +29,11 @@
 
 #include "RestBatchHandler.h"
 
+#include "Basics/ConditionLocker.h"
 #include "Basics/StringUtils.h"
 #include "Basics/logging.h"
+#include "Dispatcher/Dispatcher.h"
+#include "Dispatcher/Job.h"
 #include "HttpServer/HttpHandlerFactory.h"
 #include "HttpServer/HttpServer.h"
 #include "Rest/HttpRequest.h"
@@ -40,6 +43,106 @@ using namespace triagens::basics;
 using namespace triagens::rest;
 using namespace triagens::arango;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                              struct BatchPartQueue
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute parts until all parts are claimed
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchPartQueue::work () {
+  while (true) {
+    size_t const i = next.fetch_add(1);
+
+    if (i >= total) {
+      return;
+    }
+
+    RestBatchHandler::ExecutePart((*parts)[i]);
+
+    CONDITION_LOCKER(guard, condition);
+
+    if (++done == total) {
+      guard.signal();
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until all parts are executed
+////////////////////////////////////////////////////////////////////////////////
+
+void BatchPartQueue::waitForAll () {
+  CONDITION_LOCKER(guard, condition);
+
+  while (done < total) {
+    guard.wait();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class BatchPartJob
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dispatcher job helping to execute the parts of a batch request
+////////////////////////////////////////////////////////////////////////////////
+
+class BatchPartJob : public Job {
+
+  public:
+
+    BatchPartJob (std::shared_ptr<BatchPartQueue> const& queue) 
+      : Job("Batch Part Job"),
+        _queue(queue) {
+    }
+
+    JobType type () const override {
+      return READ_JOB;
+    }
+
+    status_t work () override {
+      _queue->work();
+      return status_t(JOB_DONE);
+    }
+
+    bool cancel (bool) override {
+      return false;
+    }
+
+    void cleanup () override {
+      delete this;
+    }
+
+    bool beginShutdown () override {
+      return true;
+    }
+
+    void handleError (triagens::basics::Exception const&) override {
+    }
+
+  private:
+
+    std::shared_ptr<BatchPartQueue> _queue;
+};
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    static members
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of parts executed in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+size_t RestBatchHandler::DoMaxConcurrency = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief upper bound for the maximum number of parts executed in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+size_t const RestBatchHandler::MaxConcurrencyLimit = 64;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -48,8 +151,10 @@ using namespace triagens::arango;
 /// @brief constructor
 ////////////////////////////////////////////////////////////////////////////////
 
-RestBatchHandler::RestBatchHandler (HttpRequest* request)
-  : RestVocbaseBaseHandler(request) {
+RestBatchHandler::RestBatchHandler (HttpRequest* request,
+                                    Dispatcher* dispatcher)
+  : RestVocbaseBaseHandler(request),
+    _dispatcher(dispatcher) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -82,6 +187,13 @@ RestBatchHandler::~RestBatchHandler () {
 /// server will return the results of all parts in a single response when all
 /// parts are finished.
 ///
+/// If the parts of a batch request do not depend on each other, the client
+/// can send the HTTP header `x-arango-batch-concurrency` with the maximum
+/// number of parts the server may execute in parallel. The server will then
+/// execute the parts on multiple dispatcher threads, using at most the
+/// number of threads set with the startup option `--server.batch-concurrency`.
+/// The responses of the parts are still returned in the order of the parts.
+///
 /// Technically, a batch request is a multipart HTTP request, with
 /// content-type `multipart/form-data`. A batch request consists of an
 /// envelope and the individual batch part actions. Batch part actions
@@ -222,6 +334,8 @@ Handler::status_t RestBatchHandler::execute () {
   helper.message = &message;
   helper.searchStart = (char*) message.messageStart;
 
+  std::vector<BatchPart> parts;
+
   // iterate over all parts of the multipart message
   while (true) {
     // get the next part from the multipart message
@@ -304,41 +418,43 @@ Handler::status_t RestBatchHandler::execute () {
       return status_t(Handler::HANDLER_FAILED);
     }
 
-    Handler::status_t status(Handler::HANDLER_FAILED);
+    try {
+      parts.emplace_back(handler, helper.contentId != 0 ? string(helper.contentId, helper.contentIdLength) : string());
+    }
+    catch (...) {
+      delete handler;
+      throw;
+    }
 
-    do {
-      handler->prepareExecute();
-      try {
-        status = handler->execute();
-      }
-      catch (triagens::basics::Exception const& ex) {
-        handler->handleError(ex);
-      }
-      catch (std::exception const& ex) {
-        triagens::basics::Exception err(TRI_ERROR_INTERNAL, ex.what(), __FILE__, __LINE__);
-        handler->handleError(err);
-      }
-      catch (...) {
-        triagens::basics::Exception err(TRI_ERROR_INTERNAL, __FILE__, __LINE__);
-        handler->handleError(err);
-      }
-      handler->finalizeExecute();
+    if (! helper.containsMore) {
+      // we've read the last part
+      break;
     }
-    while (status.status == Handler::HANDLER_REQUEUE);
+  } // next part
 
+  // execute the handlers of all parts
+  size_t const n = concurrency(parts.size());
 
-    if (status.status == Handler::HANDLER_FAILED) {
+  if (n > 1) {
+    executeParallel(parts, n);
+  }
+  else {
+    for (auto& part : parts) {
+      ExecutePart(part);
+    }
+  }
+
+  for (auto& part : parts) {
+    if (part.status.status == Handler::HANDLER_FAILED) {
       // one of the handlers failed, we must exit now
-      delete handler;
       generateError(HttpResponse::BAD, TRI_ERROR_INTERNAL, "executing a handler for batch part failed");
 
       return status_t(Handler::HANDLER_FAILED);
     }
 
-    HttpResponse* partResponse = handler->getResponse();
+    HttpResponse* partResponse = part.handler->getResponse();
 
     if (partResponse == nullptr) {
-      delete handler;
       generateError(HttpResponse::BAD, TRI_ERROR_INTERNAL, "could not create a response for batch part request");
 
       return status_t(Handler::HANDLER_FAILED);
@@ -355,9 +471,9 @@ Handler::status_t RestBatchHandler::execute () {
     _response->body().appendText(boundary + "\r\nContent-Type: ");
     _response->body().appendText(triagens::rest::HttpRequest::BatchContentType);
 
-    if (helper.contentId != 0) {
+    if (! part.contentId.empty()) {
       // append content-id
-      _response->body().appendText("\r\nContent-Id: " + string(helper.contentId, helper.contentIdLength));
+      _response->body().appendText("\r\nContent-Id: " + part.contentId);
     }
 
     _response->body().appendText("\r\n\r\n", 4);
@@ -372,14 +488,9 @@ Handler::status_t RestBatchHandler::execute () {
     _response->body().appendText(partResponse->body());
     _response->body().appendText("\r\n", 2);
 
-    delete handler;
-
-
-    if (! helper.containsMore) {
-      // we've read the last part
-      break;
-    }
-  } // next part
+    // free the handler and its response early
+    part.handler.reset();
+  }
 
   // append final boundary + "--"
   _response->body().appendText(boundary + "--");
@@ -392,6 +503,102 @@ Handler::status_t RestBatchHandler::execute () {
   return status_t(Handler::HANDLER_DONE);
 }
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute the handler of a batch part
+////////////////////////////////////////////////////////////////////////////////
+
+void RestBatchHandler::ExecutePart (BatchPart& part) {
+  HttpHandler* handler = part.handler.get();
+  Handler::status_t status(Handler::HANDLER_FAILED);
+
+  do {
+    handler->prepareExecute();
+    try {
+      status = handler->execute();
+    }
+    catch (triagens::basics::Exception const& ex) {
+      handler->handleError(ex);
+    }
+    catch (std::exception const& ex) {
+      triagens::basics::Exception err(TRI_ERROR_INTERNAL, ex.what(), __FILE__, __LINE__);
+      handler->handleError(err);
+    }
+    catch (...) {
+      triagens::basics::Exception err(TRI_ERROR_INTERNAL, __FILE__, __LINE__);
+      handler->handleError(err);
+    }
+    handler->finalizeExecute();
+  }
+  while (status.status == Handler::HANDLER_REQUEUE);
+
+  part.status = status;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine the number of parts to execute in parallel
+///
+/// parts are only executed in parallel if the client asked for it, because
+/// parts may depend on the results of previous parts
+////////////////////////////////////////////////////////////////////////////////
+
+size_t RestBatchHandler::concurrency (size_t numberOfParts) const {
+  if (_dispatcher == nullptr) {
+    return 1;
+  }
+
+  bool found;
+  char const* value = _request->header("x-arango-batch-concurrency", found);
+
+  if (! found) {
+    return 1;
+  }
+
+  size_t n = static_cast<size_t>(StringUtils::uint64(value));
+
+  if (n > MaxConcurrency()) {
+    n = MaxConcurrency();
+  }
+
+  if (n > numberOfParts) {
+    n = numberOfParts;
+  }
+
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute the parts in parallel, using dispatcher jobs
+///
+/// the current thread executes parts as well, so all parts get executed even
+/// if the dispatcher queue is full or all dispatcher threads are busy. The
+/// current thread only waits for parts that other threads are executing
+////////////////////////////////////////////////////////////////////////////////
+
+void RestBatchHandler::executeParallel (std::vector<BatchPart>& parts,
+                                        size_t n) {
+  auto queue = std::make_shared<BatchPartQueue>(&parts);
+
+  for (size_t i = 1; i < n; ++i) {
+    BatchPartJob* job = new BatchPartJob(queue);
+
+    if (_dispatcher->addJob(job) != TRI_ERROR_NO_ERROR) {
+      delete job;
+      break;
+    }
+  }
+
+  queue->work();
+  queue->waitForAll();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief extract the boundary from the body of a multipart message
 ////////////////////////////////////////////////////////////////////////////////
@@ -32,6 +32,7 @@
 
 #include "Basics/Common.h"
 
+#include "Basics/ConditionVariable.h"
 #include "RestHandler/RestVocbaseBaseHandler.h"
 
 // -----------------------------------------------------------------------------
@@ -39,6 +40,10 @@
 // -----------------------------------------------------------------------------
 
 namespace triagens {
+  namespace rest {
+    class Dispatcher;
+  }
+
   namespace arango {
 
 // -----------------------------------------------------------------------------
@@ -80,6 +85,50 @@ namespace triagens {
       bool containsMore;
     };
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a single part of a batch request, together with its handler
+////////////////////////////////////////////////////////////////////////////////
+
+    struct BatchPart {
+      BatchPart (rest::HttpHandler* handler,
+                 std::string const& contentId)
+      : handler(handler),
+        contentId(contentId),
+        status(rest::Handler::HANDLER_FAILED) {
+      }
+
+      std::unique_ptr<rest::HttpHandler> handler;
+      std::string contentId;
+      rest::Handler::status_t status;
+    };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the parts of a batch request that are executed in parallel
+///
+/// the parts are claimed one after the other by the thread of the batch
+/// request and the dispatcher jobs helping it. Jobs starting after all parts
+/// were claimed do not touch the parts anymore, so the queue can outlive them
+////////////////////////////////////////////////////////////////////////////////
+
+    struct BatchPartQueue {
+      BatchPartQueue (std::vector<BatchPart>* parts)
+      : parts(parts),
+        total(parts->size()),
+        next(0),
+        done(0) {
+      }
+
+      void work ();
+
+      void waitForAll ();
+
+      std::vector<BatchPart>* parts;
+      size_t const total;
+      std::atomic<size_t> next;
+      size_t done;
+      basics::ConditionVariable condition;
+    };
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief batch request handler
 ////////////////////////////////////////////////////////////////////////////////
@@ -96,7 +145,8 @@ namespace triagens {
 /// @brief constructor
 ////////////////////////////////////////////////////////////////////////////////
 
-        RestBatchHandler (rest::HttpRequest*);
+        RestBatchHandler (rest::HttpRequest*,
+                          rest::Dispatcher*);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destructor
@@ -116,6 +166,34 @@ namespace triagens {
 
         Handler::status_t execute ();
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute the handler of a batch part
+////////////////////////////////////////////////////////////////////////////////
+
+        static void ExecutePart (BatchPart&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the maximum number of parts executed in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t MaxConcurrency () {
+          return DoMaxConcurrency;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of parts executed in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        static void MaxConcurrency (size_t value) {
+          DoMaxConcurrency = (std::min)(value, MaxConcurrencyLimit);
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                   private methods
 // -----------------------------------------------------------------------------
@@ -146,6 +224,42 @@ namespace triagens {
 
         bool extractPart (SearchHelper*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief determine the number of parts to execute in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t concurrency (size_t) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute the parts in parallel, using dispatcher jobs
+////////////////////////////////////////////////////////////////////////////////
+
+        void executeParallel (std::vector<BatchPart>&,
+                              size_t);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the dispatcher
+////////////////////////////////////////////////////////////////////////////////
+
+        rest::Dispatcher* _dispatcher;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of parts executed in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t DoMaxConcurrency;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief upper bound for the maximum number of parts executed in parallel
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const MaxConcurrencyLimit;
      };
   }
 }
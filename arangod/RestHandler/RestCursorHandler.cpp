@@ -34,6 +34,8 @@
 #include "Basics/json.h"
 #include "Basics/MutexLocker.h"
 #include "Basics/ScopeGuard.h"
+#include "Basics/tri-strings.h"
+#include "Cluster/ServerState.h"
 #include "Utils/Cursor.h"
 #include "Utils/CursorRepository.h"
 #include "V8Server/ApplicationV8.h"
@@ -294,6 +296,18 @@ triagens::basics::Json RestCursorHandler::buildExtra (triagens::aql::QueryResult
 ///   specific rules. To disable a rule, prefix its name with a `-`, to enable a rule, prefix it
 ///   with a `+`. There is also a pseudo-rule `all`, which will match all optimizer rules.
 ///
+/// - *stream*: if set to *true*, the query is not executed completely when the
+///   cursor is created. Instead, the server keeps the query alive and produces
+///   each batch when it is requested, so the first results are returned
+///   early and the complete result is never held in memory. The query's *extra*
+///   attribute is only returned with the last batch. The *count* attribute cannot
+///   be used together with this option, because the number of results is not known
+///   in advance. The query will be aborted when the cursor is deleted or when its *ttl*
+///   expires. Until then, the collections used by the query are locked against
+///   writes, so the cursor should be consumed or deleted quickly.
+///   Data-modification queries are always executed completely. The option
+///   is ignored on a coordinator.
+///
 /// If the result set can be created by the server, the server will respond with
 /// *HTTP 201*. The body of the response will contain a JSON object with the
 /// result set.
@@ -599,18 +613,61 @@ void RestCursorHandler::createCursor () {
     }
     
     auto options = buildOptions(json.get());
+
+    bool const stream = triagens::basics::JsonHelper::getBooleanValue(options.json(), "stream", false) &&
+                        ! ServerState::instance()->isCoordinator();
+
+    if (stream && triagens::basics::JsonHelper::getBooleanValue(options.json(), "count", false)) {
+      generateError(HttpResponse::BAD, TRI_ERROR_BAD_PARAMETER, "<count> cannot be used for streaming cursors");
+      return;
+    }
+
+    char const* queryData = queryString->_value._string.data;
+    size_t const queryLength = static_cast<size_t>(queryString->_value._string.length - 1);
+    char* queryCopy = nullptr;
+
+    if (stream) {
+      // a stream cursor outlives the request body, so the query needs its own
+      // copy of the query string
+      queryCopy = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, queryData, queryLength);
+
+      if (queryCopy == nullptr) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+      }
+      queryData = queryCopy;
+    }
   
-    triagens::aql::Query query(_applicationV8, 
-                               false, 
-                               _vocbase, 
-                               queryString->_value._string.data,
-                               static_cast<size_t>(queryString->_value._string.length - 1),
-                               (bindVars != nullptr ? TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, bindVars) : nullptr),
-                               TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, options.json()), 
-                               triagens::aql::PART_MAIN);
+    // frees the copy of the query string, after the query was destroyed
+    triagens::basics::ScopeGuard guard{
+      [] () -> void { },
+      [&queryCopy] () -> void {
+        if (queryCopy != nullptr) {
+          TRI_FreeString(TRI_UNKNOWN_MEM_ZONE, queryCopy);
+        }
+      }
+    };
+
+    std::unique_ptr<triagens::aql::Query> query(new triagens::aql::Query(
+      _applicationV8, 
+      false, 
+      _vocbase, 
+      queryData,
+      queryLength,
+      (bindVars != nullptr ? TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, bindVars) : nullptr),
+      TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, options.json()), 
+      triagens::aql::PART_MAIN
+    ));
  
-    registerQuery(&query); 
-    auto queryResult = query.execute(_queryRegistry);
+    if (stream) {
+      // the cursor takes over the query and its query string
+      char* cursorQueryString = queryCopy;
+      queryCopy = nullptr;
+      createStreamCursor(query.release(), cursorQueryString, options);
+      return;
+    }
+
+    registerQuery(query.get()); 
+    auto queryResult = query->execute(_queryRegistry);
     unregisterQuery(); 
 
     if (queryResult.code != TRI_ERROR_NO_ERROR) {
@@ -709,6 +766,59 @@ void RestCursorHandler::createCursor () {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a stream cursor for a query and return its first batch. 
+/// the cursor takes over the query and the query string, and prepares the
+/// query in its own thread
+////////////////////////////////////////////////////////////////////////////////
+
+void RestCursorHandler::createStreamCursor (triagens::aql::Query* query,
+                                            char* queryString,
+                                            triagens::basics::Json const& options) {
+  auto cursors = static_cast<triagens::arango::CursorRepository*>(_vocbase->_cursorRepository);
+  TRI_ASSERT(cursors != nullptr);
+
+  size_t batchSize = triagens::basics::JsonHelper::getNumericValue<size_t>(options.json(), "batchSize", 1000);
+  double ttl = triagens::basics::JsonHelper::getNumericValue<double>(options.json(), "ttl", 30);
+
+  triagens::arango::StreamCursor* cursor = cursors->createFromQuery(query, queryString, batchSize, ttl);
+
+  try {
+    // the query can be cancelled while it is prepared. data-modification
+    // queries are executed completely when they are prepared
+    registerQuery(query);
+
+    try {
+      cursor->prepare(_queryRegistry);
+    }
+    catch (triagens::basics::Exception const& ex) {
+      if (ex.code() == TRI_ERROR_QUERY_KILLED && wasCancelled()) {
+        THROW_ARANGO_EXCEPTION(TRI_ERROR_REQUEST_CANCELED);
+      }
+      throw;
+    }
+
+    unregisterQuery();
+
+    _response = createResponse(HttpResponse::CREATED);
+    _response->setContentType("application/json; charset=utf-8");
+
+    _response->body().appendChar('{');
+    cursor->dump(_response->body());
+    _response->body().appendText(",\"error\":false,\"code\":");
+    _response->body().appendInteger(static_cast<uint32_t>(_response->responseCode()));
+    _response->body().appendChar('}');
+
+    cursors->release(cursor);
+  }
+  catch (...) {
+    // the query must not be cancelled anymore once the cursor is freed
+    unregisterQuery();
+    cursors->release(cursor);
+    throw;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @startDocuBlock JSF_post_api_cursor_identifier
 /// @brief return the next results from an existing cursor
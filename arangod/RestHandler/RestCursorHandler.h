@@ -142,6 +142,15 @@ namespace triagens {
 
         void createCursor ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a stream cursor for a prepared query and return its first
+/// batch. the cursor takes over the query and the query string
+////////////////////////////////////////////////////////////////////////////////
+
+        void createStreamCursor (triagens::aql::Query*,
+                                 char*,
+                                 triagens::basics::Json const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return the next results from an existing cursor
 ////////////////////////////////////////////////////////////////////////////////
@@ -302,25 +302,24 @@ bool RestDocumentHandler::createDocument () {
 
   bool const waitForSync = extractWaitForSync();
 
-  TRI_json_t* json = parseJsonBody();
+  if (ServerState::instance()->isCoordinator()) {
+    TRI_json_t* json = parseJsonBody();
 
-  if (json == nullptr) {
-    return false;
-  }
+    if (json == nullptr) {
+      return false;
+    }
 
-  if (json->_type != TRI_JSON_OBJECT) {
-    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
-    generateTransactionError(collection, TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID);
-    return false;
-  }
+    if (json->_type != TRI_JSON_OBJECT) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+      generateTransactionError(collection, TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID);
+      return false;
+    }
 
-  if (ServerState::instance()->isCoordinator()) {
     // json will be freed inside!
     return createDocumentCoordinator(collection, waitForSync, json);
   }
 
   if (! checkCreateCollection(collection, getCollectionType())) {
-    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
     return false;
   }
 
@@ -334,25 +333,35 @@ bool RestDocumentHandler::createDocument () {
   int res = trx.begin();
 
   if (res != TRI_ERROR_NO_ERROR) {
-    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
     generateTransactionError(collection, res);
     return false;
   }
 
   if (trx.documentCollection()->_info._type != TRI_COL_TYPE_DOCUMENT) {
     // check if we are inserting with the DOCUMENT handler into a non-DOCUMENT collection
-    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
     generateError(HttpResponse::BAD, TRI_ERROR_ARANGO_COLLECTION_TYPE_INVALID);
     return false;
   }
 
+  // the body is shaped while it is parsed, without building a TRI_json_t
+  ShapedJsonParser parser(trx.documentCollection()->getShaper());  // PROTECTED by trx here
+
+  if (! parseShapedJsonBody(parser, collection)) {
+    return false;
+  }
+
   TRI_voc_cid_t const cid = trx.cid();
 
+  char const* key;
+  res = parser.key(&key);
+
   TRI_doc_mptr_copy_t mptr;
-  res = trx.createDocument(&mptr, json, waitForSync);
-  res = trx.finish(res);
 
-  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+  if (res == TRI_ERROR_NO_ERROR) {
+    res = trx.createDocument((TRI_voc_key_t) key, &mptr, parser.shaped(), waitForSync);
+  }
+
+  res = trx.finish(res);
 
   // .............................................................................
   // outside write transaction
@@ -1386,6 +1395,11 @@ bool RestDocumentHandler::modifyDocument (bool isPatch) {
   string const& collection = suffix[0];
   string const& key = suffix[1];
 
+  if (! isPatch && ! ServerState::instance()->isRunningInCluster()) {
+    // replacing a document in a single server does not need the json
+    return replaceDocumentShaped(collection, key);
+  }
+
   TRI_json_t* json = parseJsonBody();
 
   if (json == nullptr) {
@@ -1615,6 +1629,74 @@ bool RestDocumentHandler::modifyDocument (bool isPatch) {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replaces a document, shaping the body while it is parsed
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestDocumentHandler::replaceDocumentShaped (string const& collection,
+                                                 string const& key) {
+  // extract the revision
+  bool isValidRevision;
+  TRI_voc_rid_t const revision = extractRevision("if-match", "rev", isValidRevision);
+  if (! isValidRevision) {
+    generateError(HttpResponse::BAD,
+                  TRI_ERROR_HTTP_BAD_PARAMETER,
+                  "invalid revision number");
+    return false;
+  }
+
+  // extract or chose the update policy
+  TRI_doc_update_policy_e const policy = extractUpdatePolicy();
+  bool const waitForSync = extractWaitForSync();
+
+  TRI_doc_mptr_copy_t mptr;
+
+  // find and load collection given by name or identifier
+  SingleCollectionWriteTransaction<1> trx(new StandaloneTransactionContext(), _vocbase, collection);
+
+  // .............................................................................
+  // inside write transaction
+  // .............................................................................
+
+  int res = trx.begin();
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateTransactionError(collection, res);
+    return false;
+  }
+
+  TRI_voc_cid_t const cid = trx.cid();
+  TRI_voc_rid_t rid = 0;
+
+  if (trx.orderBarrier(trx.trxCollection()) == nullptr) {
+    generateTransactionError(collection, TRI_ERROR_OUT_OF_MEMORY);
+    return false;
+  }
+
+  ShapedJsonParser parser(trx.documentCollection()->getShaper());  // PROTECTED by trx here
+
+  if (! parseShapedJsonBody(parser, collection)) {
+    return false;
+  }
+
+  res = trx.updateDocument(key, &mptr, const_cast<TRI_shaped_json_t*>(parser.shaped()), policy, waitForSync, revision, &rid);
+  res = trx.finish(res);
+
+  // .............................................................................
+  // outside write transaction
+  // .............................................................................
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateTransactionError(collection, res, (TRI_voc_key_t) key.c_str(), rid);
+
+    return false;
+  }
+
+  generateSaved(trx, cid, mptr);
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief modifies a document, coordinator case in a cluster
 ////////////////////////////////////////////////////////////////////////////////
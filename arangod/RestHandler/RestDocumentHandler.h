@@ -133,6 +133,13 @@ namespace triagens {
 
       virtual bool modifyDocument (bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replaces a document in a single server, without building a json
+////////////////////////////////////////////////////////////////////////////////
+
+      bool replaceDocumentShaped (std::string const&,
+                                  std::string const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief deletes a document
 ////////////////////////////////////////////////////////////////////////////////
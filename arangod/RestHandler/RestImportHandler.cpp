@@ -32,6 +32,7 @@
 #include "Basics/JsonHelper.h"
 #include "Basics/StringUtils.h"
 #include "Basics/tri-strings.h"
+#include "Cluster/ClusterMethods.h"
 #include "Rest/HttpRequest.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/edge-collection.h"
@@ -64,13 +65,6 @@ RestImportHandler::RestImportHandler (HttpRequest* request)
 ////////////////////////////////////////////////////////////////////////////////
 
 HttpHandler::status_t RestImportHandler::execute () {
-  if (ServerState::instance()->isCoordinator()) {
-    generateError(HttpResponse::NOT_IMPLEMENTED,
-                  TRI_ERROR_CLUSTER_UNSUPPORTED,
-                  "'/_api/import' is not yet supported in a cluster");
-    return status_t(HANDLER_DONE);
-  }
-  
   // set default value for onDuplicate
   _onDuplicateAction = DUPLICATE_ERROR;
       
@@ -193,6 +187,44 @@ std::string RestImportHandler::buildParseError (size_t i,
   return positionise(i) + "invalid JSON type (expecting object, probably parse error)";
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief construct an error message for a value that is no object
+////////////////////////////////////////////////////////////////////////////////
+
+std::string RestImportHandler::buildInvalidDocumentError (size_t i,
+                                                          char const* lineStart,
+                                                          TRI_json_t const* json) {
+  if (json != nullptr) {
+    string part = JsonHelper::toString(json);
+    if (part.size() > 255) {
+      // UTF-8 chars in string will be escaped so we can truncate it at any point
+      part = part.substr(0, 255) + "...";
+    }
+  
+    return positionise(i) + "invalid JSON type (expecting object), offending document: " + part;
+  }
+
+  return buildParseError(i, lineStart);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief construct an error message for a document that was not created
+////////////////////////////////////////////////////////////////////////////////
+
+std::string RestImportHandler::buildDocumentError (size_t i,
+                                                   int res,
+                                                   TRI_json_t const* json) {
+  string part = JsonHelper::toString(json);
+  if (part.size() > 255) {
+    // UTF-8 chars in string will be escaped so we can truncate it at any point
+    part = part.substr(0, 255) + "...";
+  }
+
+  return positionise(i) +
+         "creating document failed with error '" + TRI_errno_string(res) +
+         "', offending document: " + part;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief process a single JSON document
 ////////////////////////////////////////////////////////////////////////////////
@@ -206,22 +238,7 @@ int RestImportHandler::handleSingleDocument (RestImportTransaction& trx,
                                              size_t i) {
 
   if (! TRI_IsObjectJson(json)) {
-    std::string errorMsg;
-
-    if (json != nullptr) {
-      string part = JsonHelper::toString(json);
-      if (part.size() > 255) {
-        // UTF-8 chars in string will be escaped so we can truncate it at any point
-        part = part.substr(0, 255) + "...";
-      }
-    
-      errorMsg = positionise(i) + "invalid JSON type (expecting object), offending document: " + part;
-    }
-    else {
-      errorMsg = buildParseError(i, lineStart);
-    }
-
-    registerError(result, errorMsg);
+    registerError(result, buildInvalidDocumentError(i, lineStart, json));
     return TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID;
   }
 
@@ -341,17 +358,77 @@ int RestImportHandler::handleSingleDocument (RestImportTransaction& trx,
 
 
   if (res != TRI_ERROR_NO_ERROR) {
-    string part = JsonHelper::toString(json);
-    if (part.size() > 255) {
-      // UTF-8 chars in string will be escaped so we can truncate it at any point
-      part = part.substr(0, 255) + "...";
+    registerError(result, buildDocumentError(i, res, json));
+  }
+
+  return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a single document from its text, without building a json
+////////////////////////////////////////////////////////////////////////////////
+
+int RestImportHandler::createSingleDocumentShaped (RestImportTransaction& trx,
+                                                   RestImportResult& result,
+                                                   ShapedJsonParser& parser,
+                                                   char const* start,
+                                                   char const* end,
+                                                   bool isEdgeCollection,
+                                                   bool waitForSync) {
+  int res = parser.parse(start, static_cast<size_t>(end - start));
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  char const* key;
+  res = parser.key(&key);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  TRI_doc_mptr_copy_t document;
+
+  if (isEdgeCollection) {
+    char const* from = parser.from();
+    char const* to   = parser.to();
+
+    if (from == nullptr || to == nullptr) {
+      return TRI_ERROR_ARANGO_INVALID_EDGE_ATTRIBUTE;
     }
 
-    std::string errorMsg = positionise(i) +
-                           "creating document failed with error '" + TRI_errno_string(res) +
-                           "', offending document: " + part;
-      
-    registerError(result, errorMsg);
+    TRI_document_edge_t edge;
+
+    edge._fromCid = 0;
+    edge._toCid   = 0;
+    edge._fromKey = nullptr;
+    edge._toKey   = nullptr;
+
+    int res1 = parseDocumentId(trx.resolver(), from, edge._fromCid, edge._fromKey);
+    int res2 = parseDocumentId(trx.resolver(), to, edge._toCid, edge._toKey);
+
+    if (res1 == TRI_ERROR_NO_ERROR &&
+        res2 == TRI_ERROR_NO_ERROR) {
+      res = trx.createEdge((TRI_voc_key_t) key, &document, parser.shaped(), waitForSync, &edge);
+    }
+    else {
+      res = (res1 != TRI_ERROR_NO_ERROR ? res1 : res2);
+    }
+
+    if (edge._fromKey != nullptr) {
+      TRI_Free(TRI_CORE_MEM_ZONE, edge._fromKey);
+    }
+    if (edge._toKey != nullptr) {
+      TRI_Free(TRI_CORE_MEM_ZONE, edge._toKey);
+    }
+  }
+  else {
+    res = trx.createDocument((TRI_voc_key_t) key, &document, parser.shaped(), waitForSync);
+  }
+
+  if (res == TRI_ERROR_NO_ERROR) {
+    ++result._numCreated;
   }
 
   return res;
@@ -775,6 +852,10 @@ bool RestImportHandler::createFromJson (string const& type) {
     return false;
   }
 
+  if (ServerState::instance()->isCoordinator()) {
+    return createFromJsonCoordinator(collection, linewise);
+  }
+
   // find and load collection given by name or identifier
   RestImportTransaction trx(new StandaloneTransactionContext(), _vocbase, collection);
 
@@ -805,6 +886,11 @@ bool RestImportHandler::createFromJson (string const& type) {
     char const* end = ptr + _request->bodySize();
     size_t i = 0;
 
+    // documents are shaped while they are parsed. only documents that cannot
+    // be created this way are parsed into a json, to produce the error
+    // messages and to handle duplicates
+    ShapedJsonParser parser(document->getShaper());  // PROTECTED by trx here
+
     while (ptr < end) {
       // read line until done
       i++;
@@ -824,8 +910,7 @@ bool RestImportHandler::createFromJson (string const& type) {
       // now find end of line
       char const* pos = strchr(ptr, '\n');
       char const* oldPtr = nullptr;
-
-      TRI_json_t* json = nullptr;
+      char const* lineEnd = nullptr;
 
       if (pos == ptr) {
         // line starting with \n, i.e. empty line
@@ -838,7 +923,7 @@ bool RestImportHandler::createFromJson (string const& type) {
         *(const_cast<char*>(pos)) = '\0';
         TRI_ASSERT(ptr != nullptr);
         oldPtr = ptr;
-        json = parseJsonLine(ptr, pos);
+        lineEnd = pos;
         ptr = pos + 1;
       }
       else {
@@ -846,14 +931,20 @@ bool RestImportHandler::createFromJson (string const& type) {
         TRI_ASSERT(pos == nullptr);
         TRI_ASSERT(ptr != nullptr);
         oldPtr = ptr;
-        json = parseJsonLine(ptr);
+        lineEnd = oldPtr + strlen(oldPtr);
         ptr = end;
       }
 
-      res = handleSingleDocument(trx, result, oldPtr, json, isEdgeCollection, waitForSync, i);
+      res = createSingleDocumentShaped(trx, result, parser, oldPtr, lineEnd, isEdgeCollection, waitForSync);
 
-      if (json != nullptr) {
-        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+      if (res != TRI_ERROR_NO_ERROR) {
+        TRI_json_t* json = parseJsonLine(oldPtr, lineEnd);
+
+        res = handleSingleDocument(trx, result, oldPtr, json, isEdgeCollection, waitForSync, i);
+
+        if (json != nullptr) {
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+        }
       }
       
       if (res != TRI_ERROR_NO_ERROR) {
@@ -1277,6 +1368,11 @@ bool RestImportHandler::createFromKeyValueList () {
 
   current = next + 1;
 
+  if (ServerState::instance()->isCoordinator()) {
+    bool const ok = createFromKeyValueListCoordinator(collection, keys, current, bodyEnd, (size_t) lineNumber);
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, keys);
+    return ok;
+  }
 
   // find and load collection given by name or identifier
   RestImportTransaction trx(new StandaloneTransactionContext(), _vocbase, collection);
@@ -1394,6 +1490,302 @@ bool RestImportHandler::createFromKeyValueList () {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collect a document for an import in a coordinator
+///
+/// takes over the json. Returns an error and registers an error message if
+/// the value is no object
+////////////////////////////////////////////////////////////////////////////////
+
+int RestImportHandler::collectDocument (RestImportBatch& batch,
+                                        char const* lineStart,
+                                        TRI_json_t* json,
+                                        size_t i) {
+  if (! TRI_IsObjectJson(json)) {
+    batch._errors.emplace_back(i, buildInvalidDocumentError(i, lineStart, json));
+
+    if (json != nullptr) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+    }
+    return TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID;
+  }
+
+  try {
+    batch._positions.emplace_back(i);
+    batch._documents.emplace_back(json);
+  }
+  catch (...) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+    throw;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates documents from JSON in a coordinator
+///
+/// the documents are parsed by the coordinator, and then sent to the shards
+/// responsible for them, see importOnCoordinator
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestImportHandler::createFromJsonCoordinator (string const& collection,
+                                                   bool linewise) {
+  RestImportBatch batch;
+  int res = TRI_ERROR_NO_ERROR;
+  bool const complete = extractComplete();
+
+  if (linewise) {
+    // each line is a separate JSON document
+    char const* ptr = _request->body();
+    char const* end = ptr + _request->bodySize();
+    size_t i = 0;
+
+    while (ptr < end) {
+      // read line until done
+      i++;
+
+      // trim whitespace at start of line
+      while (ptr < end && 
+             (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\b' || *ptr == '\f')) {
+        ++ptr;
+      }
+
+      if (ptr == end || *ptr == '\0') {
+        break;
+      }
+
+      // now find end of line
+      char const* pos = strchr(ptr, '\n');
+      char const* lineStart = ptr;
+      char const* lineEnd = nullptr;
+
+      if (pos == ptr) {
+        // line starting with \n, i.e. empty line
+        ptr = pos + 1;
+        ++batch._result._numEmpty;
+        continue;
+      }
+      else if (pos != nullptr) {
+        // non-empty line
+        *(const_cast<char*>(pos)) = '\0';
+        lineEnd = pos;
+        ptr = pos + 1;
+      }
+      else {
+        // last-line, non-empty
+        lineEnd = lineStart + strlen(lineStart);
+        ptr = end;
+      }
+
+      res = collectDocument(batch, lineStart, parseJsonLine(lineStart, lineEnd), i);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        if (complete) {
+          // only perform a full import: abort
+          break;
+        }
+
+        res = TRI_ERROR_NO_ERROR;
+      }
+    }
+  }
+
+  else {
+    // the entire request body is one JSON document
+    TRI_json_t* documents = TRI_Json2String(TRI_UNKNOWN_MEM_ZONE, _request->body(), nullptr);
+
+    if (! TRI_IsArrayJson(documents)) {
+      if (documents != nullptr) {
+        TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, documents);
+      }
+
+      generateError(HttpResponse::BAD,
+                    TRI_ERROR_HTTP_BAD_PARAMETER,
+                    "expecting a JSON array in the request");
+      return false;
+    }
+
+    size_t const n = documents->_value._objects._length;
+
+    for (size_t i = 0; i < n; ++i) {
+      TRI_json_t const* json = static_cast<TRI_json_t const*>(TRI_AtVector(&documents->_value._objects, i));
+
+      res = collectDocument(batch, nullptr, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, json), i + 1);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        if (complete) {
+          // only perform a full import: abort
+          break;
+        }
+
+        res = TRI_ERROR_NO_ERROR;
+      }
+    }
+
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, documents);
+  }
+
+  return importOnCoordinator(collection, batch, res);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates documents from key/value lists in a coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestImportHandler::createFromKeyValueListCoordinator (string const& collection,
+                                                           TRI_json_t const* keys,
+                                                           char const* current,
+                                                           char const* bodyEnd,
+                                                           size_t i) {
+  RestImportBatch batch;
+  int res = TRI_ERROR_NO_ERROR;
+  bool const complete = extractComplete();
+
+  while (current != nullptr && current < bodyEnd) {
+    i++;
+
+    char const* next = static_cast<char const*>(memchr(current, '\n', bodyEnd - current));
+
+    char const* lineStart = current;
+    char const* lineEnd   = next;
+
+    if (next == nullptr) {
+      // reached the end
+      lineEnd = bodyEnd;
+      current = nullptr;
+    }
+    else {
+      // got more to read
+      current = next + 1;
+      *(const_cast<char*>(lineEnd)) = '\0';
+    }
+
+    // trim line
+    while (lineStart < bodyEnd &&
+           (*lineStart == ' ' || *lineStart == '\t' || *lineStart == '\r' || *lineStart == '\n' || *lineStart == '\b' || *lineStart == '\f')) {
+      ++lineStart;
+    }
+    
+    while (lineEnd > lineStart &&
+           (*(lineEnd - 1) == ' ' || *(lineEnd - 1) == '\t' || *(lineEnd - 1) == '\r' || *(lineEnd - 1) == '\n' || *(lineEnd - 1) == '\b' || *(lineEnd - 1) == '\f')) {
+      --lineEnd;
+    }
+
+    if (lineStart == lineEnd) {
+      ++batch._result._numEmpty;
+      continue;
+    }
+
+    TRI_json_t* values = parseJsonLine(lineStart, lineEnd);
+
+    if (values != nullptr) {
+      // build the json object from the array
+      string errorMsg;
+
+      TRI_json_t* json = createJsonObject(keys, values, errorMsg, i);
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, values);
+
+      if (json != nullptr) {
+        res = collectDocument(batch, lineStart, json, i);
+      }
+      else {
+        // raise any error
+        res = TRI_ERROR_INTERNAL;
+        ++batch._result._numErrors;
+      }
+      
+      if (res != TRI_ERROR_NO_ERROR) {
+        if (complete) {
+          // only perform a full import: abort
+          break;
+        }
+
+        res = TRI_ERROR_NO_ERROR;
+      }
+    }
+    else {
+      batch._errors.emplace_back(i, buildParseError(i, lineStart));
+    }
+  }
+
+  return importOnCoordinator(collection, batch, res);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sends the collected documents to the shards and creates the result
+///
+/// the coordinator partitions the documents by their responsible shards and
+/// sends one import request per shard, all of them in parallel. The error
+/// messages of the shards are renumbered to the positions of the documents in
+/// the request, so the result looks like the result of a single server. With
+/// complete, each shard imports either all or none of its documents
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestImportHandler::importOnCoordinator (string const& collection,
+                                             RestImportBatch& batch,
+                                             int res) {
+  string const& dbname = _request->databaseName();
+
+  if (res == TRI_ERROR_NO_ERROR && extractOverwrite()) {
+    // truncate collection first
+    res = truncateCollectionOnCoordinator(dbname, collection);
+  }
+
+  CoordinatorImportResult imported;
+
+  if (res == TRI_ERROR_NO_ERROR) {
+    bool found;
+    string const onDuplicate = _request->value("onDuplicate", found);
+
+    res = importDocumentsOnCoordinator(dbname,
+                                       collection,
+                                       batch._documents,
+                                       extractWaitForSync(),
+                                       extractComplete(),
+                                       onDuplicate,
+                                       getForwardableRequestHeaders(_request),
+                                       imported);
+  }
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateTransactionError(collection, res);
+    return false;
+  }
+
+  RestImportResult& result = batch._result;
+
+  result._numCreated += imported.numCreated;
+  result._numUpdated += imported.numUpdated;
+  result._numIgnored += imported.numIgnored;
+  result._numErrors  += batch._errors.size() + imported.rejected.size() + imported.numErrors;
+
+  for (auto const& it : imported.rejected) {
+    size_t const i = batch._positions[it.first];
+    batch._errors.emplace_back(i, buildDocumentError(i, it.second, batch._documents[it.first]));
+  }
+
+  for (auto const& it : imported.errors) {
+    size_t const i = batch._positions[it.first];
+    batch._errors.emplace_back(i, positionise(i) + it.second);
+  }
+
+  // report the errors in the order of the documents
+  std::stable_sort(batch._errors.begin(), batch._errors.end(),
+                   [] (std::pair<size_t, std::string> const& lhs,
+                       std::pair<size_t, std::string> const& rhs) {
+                     return lhs.first < rhs.first;
+                   });
+
+  for (auto& it : batch._errors) {
+    result._errors.emplace_back(std::move(it.second));
+  }
+
+  generateDocumentsCreated(result);
+
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief create response for number of documents created / failed
 ////////////////////////////////////////////////////////////////////////////////
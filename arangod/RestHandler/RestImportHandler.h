@@ -71,6 +71,39 @@ namespace triagens {
         std::vector<std::string> _errors;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   RestImportBatch
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief documents collected by a coordinator, with their positions in the
+/// request and the errors found while parsing them
+////////////////////////////////////////////////////////////////////////////////
+
+    struct RestImportBatch {
+
+      public:
+        RestImportBatch () :
+          _result(),
+          _documents(),
+          _positions(),
+          _errors() {
+        }
+
+        ~RestImportBatch () {
+          for (auto it : _documents) {
+            TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, it);
+          }
+        }
+
+        RestImportResult _result;
+
+        std::vector<TRI_json_t*> _documents;
+        std::vector<size_t> _positions;
+
+        std::vector<std::pair<size_t, std::string>> _errors;
+    };
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief import request handler
 ////////////////////////////////////////////////////////////////////////////////
@@ -139,6 +172,22 @@ namespace triagens {
         std::string buildParseError (size_t,
                                      char const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief construct an error message for a value that is no object
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string buildInvalidDocumentError (size_t,
+                                               char const*,
+                                               TRI_json_t const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief construct an error message for a document that was not created
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string buildDocumentError (size_t,
+                                        int,
+                                        TRI_json_t const*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief process a single JSON document
 ////////////////////////////////////////////////////////////////////////////////
@@ -151,6 +200,22 @@ namespace triagens {
                                   bool,
                                   size_t);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a single document from its text, without building a json
+///
+/// returns an error if the document could not be created this way. the
+/// caller is then supposed to process the document with
+/// handleSingleDocument, which also produces the error messages
+////////////////////////////////////////////////////////////////////////////////
+
+        int createSingleDocumentShaped (RestImportTransaction&,
+                                        RestImportResult&,
+                                        triagens::basics::ShapedJsonParser&,
+                                        char const*,
+                                        char const*,
+                                        bool,
+                                        bool);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief creates documents by JSON objects
 /// each line of the input stream contains an individual JSON object
@@ -177,6 +242,40 @@ namespace triagens {
 
         void generateDocumentsCreated (RestImportResult const&);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collect a document for an import in a coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+        int collectDocument (RestImportBatch&,
+                             char const*,
+                             TRI_json_t*,
+                             size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates documents from JSON in a coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+        bool createFromJsonCoordinator (std::string const&,
+                                        bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates documents from key/value lists in a coordinator
+////////////////////////////////////////////////////////////////////////////////
+
+        bool createFromKeyValueListCoordinator (std::string const&,
+                                                TRI_json_t const*,
+                                                char const*,
+                                                char const*,
+                                                size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sends the collected documents to the shards and creates the result
+////////////////////////////////////////////////////////////////////////////////
+
+        bool importOnCoordinator (std::string const&,
+                                  RestImportBatch&,
+                                  int);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief parses a string
 ////////////////////////////////////////////////////////////////////////////////
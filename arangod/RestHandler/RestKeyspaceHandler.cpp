@@ -0,0 +1,584 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief keyspace request handler
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2010-2014, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "RestKeyspaceHandler.h"
+#include "Basics/Exceptions.h"
+#include "Basics/json.h"
+#include "Basics/JsonHelper.h"
+#include "Basics/StringUtils.h"
+#include "Utils/KeySpaces.h"
+
+using namespace triagens::arango;
+using namespace triagens::basics;
+using namespace triagens::rest;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                      constructors and destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor
+////////////////////////////////////////////////////////////////////////////////
+
+RestKeyspaceHandler::RestKeyspaceHandler (HttpRequest* request)
+  : RestVocbaseBaseHandler(request) {
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   Handler methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// {@inheritDoc}
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestKeyspaceHandler::isDirect () const {
+  // operations on single keys only hold a stripe lock for a short time, so
+  // they are executed without going through the dispatcher queue
+  return (_request->suffix().size() == 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// {@inheritDoc}
+////////////////////////////////////////////////////////////////////////////////
+
+HttpHandler::status_t RestKeyspaceHandler::execute () {
+  if (ServerState::instance()->isCoordinator()) {
+    generateError(HttpResponse::NOT_IMPLEMENTED,
+                  TRI_ERROR_CLUSTER_UNSUPPORTED,
+                  "'" + KEYSPACE_PATH + "' is not supported in a cluster");
+    return status_t(HANDLER_DONE);
+  }
+
+  // extract the sub-request type
+  HttpRequest::HttpRequestType type = _request->requestType();
+  std::vector<std::string> const& suffix = _request->suffix();
+
+  try {
+    if (suffix.empty()) {
+      if (type == HttpRequest::HTTP_REQUEST_POST) {
+        createKeySpace();
+      }
+      else {
+        generateError(HttpResponse::METHOD_NOT_ALLOWED, TRI_ERROR_HTTP_METHOD_NOT_ALLOWED);
+      }
+      return status_t(HANDLER_DONE);
+    }
+
+    if (suffix.size() == 1) {
+      if (type == HttpRequest::HTTP_REQUEST_GET) {
+        readKeySpace(suffix[0]);
+      }
+      else if (type == HttpRequest::HTTP_REQUEST_DELETE) {
+        dropKeySpace(suffix[0]);
+      }
+      else {
+        generateError(HttpResponse::METHOD_NOT_ALLOWED, TRI_ERROR_HTTP_METHOD_NOT_ALLOWED);
+      }
+      return status_t(HANDLER_DONE);
+    }
+
+    if (suffix.size() != 2) {
+      generateError(HttpResponse::BAD,
+                    TRI_ERROR_HTTP_BAD_PARAMETER,
+                    "expecting " + KEYSPACE_PATH + "/<keyspace>/<key>");
+      return status_t(HANDLER_DONE);
+    }
+
+    auto keySpace = static_cast<KeySpaces*>(_vocbase->_userStructures)->get(suffix[0]);
+
+    if (keySpace == nullptr) {
+      generateError(HttpResponse::NOT_FOUND, TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+      return status_t(HANDLER_DONE);
+    }
+
+    switch (type) {
+      case HttpRequest::HTTP_REQUEST_GET:    readKey(keySpace.get(), suffix[1], false); break;
+      case HttpRequest::HTTP_REQUEST_HEAD:   readKey(keySpace.get(), suffix[1], true); break;
+      case HttpRequest::HTTP_REQUEST_PUT:    setKey(keySpace.get(), suffix[1]); break;
+      case HttpRequest::HTTP_REQUEST_POST:   incrementKey(keySpace.get(), suffix[1]); break;
+      case HttpRequest::HTTP_REQUEST_DELETE: removeKey(keySpace.get(), suffix[1]); break;
+
+      default:
+        generateError(HttpResponse::METHOD_NOT_ALLOWED, TRI_ERROR_HTTP_METHOD_NOT_ALLOWED);
+    }
+  }
+  catch (triagens::basics::Exception const& ex) {
+    generateError(HttpResponse::responseCode(ex.code()), ex.code(), ex.what());
+  }
+  catch (...) {
+    generateError(HttpResponse::SERVER_ERROR, TRI_ERROR_INTERNAL);
+  }
+
+  return status_t(HANDLER_DONE);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_post_api_keyspace
+/// @brief creates a keyspace
+///
+/// @RESTHEADER{POST /_api/keyspace, Create keyspace}
+///
+/// @RESTBODYPARAM{options,json,required}
+/// A JSON object with the attributes *name*, and optionally *size* (the
+/// number of keys to reserve room for) and *ignoreExisting*.
+///
+/// @RESTDESCRIPTION
+/// Creates an in-memory keyspace in the current database. Keyspaces are not
+/// persisted and are not replicated.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{201}
+/// is returned if the keyspace was created, or if it exists and
+/// *ignoreExisting* was set.
+///
+/// @RESTRETURNCODE{400}
+/// is returned if the body is invalid.
+///
+/// @RESTRETURNCODE{409}
+/// is returned if the keyspace exists already.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestKeyspaceHandler::createKeySpace () {
+  TRI_json_t* json = parseJsonBody();
+
+  if (json == nullptr) {
+    return;
+  }
+
+  std::string const name = JsonHelper::getStringValue(json, "name", "");
+  double size = JsonHelper::getNumericValue<double>(json, "size", 0.0);
+  bool ignoreExisting = JsonHelper::getBooleanValue(json, "ignoreExisting", false);
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+  if (name.empty()) {
+    generateError(HttpResponse::BAD,
+                  TRI_ERROR_BAD_PARAMETER,
+                  "expecting a non-empty string for 'name'");
+    return;
+  }
+
+  if (size < 0.0 || size > static_cast<double>(UINT32_MAX)) {
+    generateError(HttpResponse::BAD,
+                  TRI_ERROR_BAD_PARAMETER,
+                  "invalid value for 'size'");
+    return;
+  }
+
+  int res = static_cast<KeySpaces*>(_vocbase->_userStructures)->create(name, static_cast<uint32_t>(size), ignoreExisting);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateError(HttpResponse::responseCode(res), res);
+    return;
+  }
+
+  Json result(Json::Object, 3);
+  result("name", Json(name))
+        ("error", Json(false))
+        ("code", Json(static_cast<double>(HttpResponse::CREATED)));
+
+  generateResult(HttpResponse::CREATED, result.json());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_get_api_keyspace
+/// @brief returns the number of keys in a keyspace
+///
+/// @RESTHEADER{GET /_api/keyspace/{name}, Read keyspace}
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{name,string,required}
+/// The name of the keyspace.
+///
+/// @RESTQUERYPARAMETERS
+///
+/// @RESTQUERYPARAM{prefix,string,optional}
+/// Only count the keys starting with this prefix.
+///
+/// @RESTDESCRIPTION
+/// Returns an object with the attributes *name* and *count*. Keys whose
+/// time-to-live has passed are not counted.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the keyspace exists.
+///
+/// @RESTRETURNCODE{404}
+/// is returned if the keyspace does not exist.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestKeyspaceHandler::readKeySpace (std::string const& name) {
+  auto keySpace = static_cast<KeySpaces*>(_vocbase->_userStructures)->get(name);
+
+  if (keySpace == nullptr) {
+    generateError(HttpResponse::NOT_FOUND, TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+    return;
+  }
+
+  bool found;
+  char const* prefix = _request->value("prefix", found);
+
+  uint32_t count = keySpace->count(found ? prefix : nullptr);
+
+  Json result(Json::Object, 4);
+  result("name", Json(name))
+        ("count", Json(static_cast<double>(count)))
+        ("error", Json(false))
+        ("code", Json(static_cast<double>(HttpResponse::OK)));
+
+  generateResult(HttpResponse::OK, result.json());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_delete_api_keyspace
+/// @brief drops a keyspace
+///
+/// @RESTHEADER{DELETE /_api/keyspace/{name}, Drop keyspace}
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{name,string,required}
+/// The name of the keyspace.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the keyspace was dropped.
+///
+/// @RESTRETURNCODE{404}
+/// is returned if the keyspace does not exist.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestKeyspaceHandler::dropKeySpace (std::string const& name) {
+  int res = static_cast<KeySpaces*>(_vocbase->_userStructures)->drop(name);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateError(HttpResponse::responseCode(res), res);
+    return;
+  }
+
+  Json result(Json::Object, 2);
+  result("error", Json(false))
+        ("code", Json(static_cast<double>(HttpResponse::OK)));
+
+  generateResult(HttpResponse::OK, result.json());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_get_api_keyspace_key
+/// @brief returns the value of a key
+///
+/// @RESTHEADER{GET /_api/keyspace/{name}/{key}, Read key}
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{name,string,required}
+/// The name of the keyspace.
+///
+/// @RESTURLPARAM{key,string,required}
+/// The key.
+///
+/// @RESTDESCRIPTION
+/// Returns the value of the key as the response body. A *HEAD* request only
+/// checks whether the key exists.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the key exists.
+///
+/// @RESTRETURNCODE{404}
+/// is returned if the keyspace or the key does not exist, or if the key has
+/// expired.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestKeyspaceHandler::readKey (KeySpace* keySpace,
+                                   std::string const& key,
+                                   bool headOnly) {
+  if (headOnly) {
+    if (keySpace->keyExists(key)) {
+      _response = createResponse(HttpResponse::OK);
+    }
+    else {
+      _response = createResponse(HttpResponse::NOT_FOUND);
+    }
+    _response->setContentType("application/json; charset=utf-8");
+    return;
+  }
+
+  TRI_json_t* json = keySpace->keyGet(key);
+
+  if (json == nullptr) {
+    generateError(HttpResponse::NOT_FOUND, TRI_ERROR_KEYVALUE_KEY_NOT_FOUND);
+    return;
+  }
+
+  generateResult(HttpResponse::OK, json);
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_put_api_keyspace_key
+/// @brief sets the value of a key
+///
+/// @RESTHEADER{PUT /_api/keyspace/{name}/{key}, Set key}
+///
+/// @RESTBODYPARAM{value,json,required}
+/// The new value, which can be any JSON value.
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{name,string,required}
+/// The name of the keyspace.
+///
+/// @RESTURLPARAM{key,string,required}
+/// The key.
+///
+/// @RESTQUERYPARAMETERS
+///
+/// @RESTQUERYPARAM{ttl,number,optional}
+/// The time-to-live of the key in seconds. The key never expires if it is
+/// not set. Replacing a value also replaces its time-to-live.
+///
+/// @RESTQUERYPARAM{replace,boolean,optional}
+/// Whether an existing value is replaced, defaults to *true*.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the value was set.
+///
+/// @RESTRETURNCODE{404}
+/// is returned if the keyspace does not exist.
+///
+/// @RESTRETURNCODE{409}
+/// is returned if the key exists and *replace* is *false*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestKeyspaceHandler::setKey (KeySpace* keySpace,
+                                  std::string const& key) {
+  double ttl;
+
+  if (! extractTtl(ttl)) {
+    return;
+  }
+
+  bool found;
+  char const* value = _request->value("replace", found);
+  bool replace = (! found || StringUtils::boolean(value));
+
+  TRI_json_t* json = parseJsonBody();
+
+  if (json == nullptr) {
+    return;
+  }
+
+  if (! keySpace->keySet(key, json, replace, ttl)) {
+    generateError(HttpResponse::CONFLICT, TRI_ERROR_KEYVALUE_KEY_EXISTS);
+    return;
+  }
+
+  Json result(Json::Object, 2);
+  result("error", Json(false))
+        ("code", Json(static_cast<double>(HttpResponse::OK)));
+
+  generateResult(HttpResponse::OK, result.json());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_post_api_keyspace_key
+/// @brief increments the value of a key
+///
+/// @RESTHEADER{POST /_api/keyspace/{name}/{key}, Increment key}
+///
+/// @RESTBODYPARAM{value,number,optional}
+/// The amount to add, defaults to 1.
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{name,string,required}
+/// The name of the keyspace.
+///
+/// @RESTURLPARAM{key,string,required}
+/// The key.
+///
+/// @RESTQUERYPARAMETERS
+///
+/// @RESTQUERYPARAM{ttl,number,optional}
+/// The time-to-live in seconds of the key if it is created by this request.
+/// The time-to-live of an existing key is left unchanged, so a counter can
+/// be used as a fixed rate limiting window.
+///
+/// @RESTDESCRIPTION
+/// Adds a number to the value of the key and returns an object with the new
+/// value in the attribute *value*. A key that does not exist is created.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the value was incremented.
+///
+/// @RESTRETURNCODE{400}
+/// is returned if the body or the existing value is not a number.
+///
+/// @RESTRETURNCODE{404}
+/// is returned if the keyspace does not exist.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestKeyspaceHandler::incrementKey (KeySpace* keySpace,
+                                        std::string const& key) {
+  double ttl;
+
+  if (! extractTtl(ttl)) {
+    return;
+  }
+
+  double incr = 1.0;
+
+  if (_request->bodySize() > 0) {
+    TRI_json_t* json = parseJsonBody();
+
+    if (json == nullptr) {
+      return;
+    }
+
+    bool isNumber = TRI_IsNumberJson(json);
+
+    if (isNumber) {
+      incr = json->_value._number;
+    }
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+    if (! isNumber) {
+      generateError(HttpResponse::BAD,
+                    TRI_ERROR_TYPE_ERROR,
+                    "expecting a number as body");
+      return;
+    }
+  }
+
+  double value;
+  int res = keySpace->keyIncr(key, incr, ttl, value);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateError(HttpResponse::responseCode(res), res);
+    return;
+  }
+
+  Json result(Json::Object, 3);
+  result("value", Json(value))
+        ("error", Json(false))
+        ("code", Json(static_cast<double>(HttpResponse::OK)));
+
+  generateResult(HttpResponse::OK, result.json());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_delete_api_keyspace_key
+/// @brief removes a key
+///
+/// @RESTHEADER{DELETE /_api/keyspace/{name}/{key}, Remove key}
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{name,string,required}
+/// The name of the keyspace.
+///
+/// @RESTURLPARAM{key,string,required}
+/// The key.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the key was removed.
+///
+/// @RESTRETURNCODE{404}
+/// is returned if the keyspace or the key does not exist.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestKeyspaceHandler::removeKey (KeySpace* keySpace,
+                                     std::string const& key) {
+  if (! keySpace->keyRemove(key)) {
+    generateError(HttpResponse::NOT_FOUND, TRI_ERROR_KEYVALUE_KEY_NOT_FOUND);
+    return;
+  }
+
+  Json result(Json::Object, 2);
+  result("error", Json(false))
+        ("code", Json(static_cast<double>(HttpResponse::OK)));
+
+  generateResult(HttpResponse::OK, result.json());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extracts the ttl parameter, generates an error if it is invalid
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestKeyspaceHandler::extractTtl (double& ttl) {
+  ttl = 0.0;
+
+  bool found;
+  char const* value = _request->value("ttl", found);
+
+  if (found) {
+    ttl = StringUtils::doubleDecimal(value);
+
+    if (ttl < 0.0) {
+      generateError(HttpResponse::BAD,
+                    TRI_ERROR_BAD_PARAMETER,
+                    "invalid value for 'ttl'");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief keyspace request handler
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2010-2014, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_REST_HANDLER_REST_KEYSPACE_HANDLER_H
+#define ARANGODB_REST_HANDLER_REST_KEYSPACE_HANDLER_H 1
+
+#include "Basics/Common.h"
+#include "RestHandler/RestVocbaseBaseHandler.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                         class RestKeyspaceHandler
+// -----------------------------------------------------------------------------
+
+namespace triagens {
+
+  namespace arango {
+
+    class KeySpace;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief keyspace request handler
+////////////////////////////////////////////////////////////////////////////////
+
+    class RestKeyspaceHandler : public RestVocbaseBaseHandler {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                      constructors and destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructor
+////////////////////////////////////////////////////////////////////////////////
+
+        RestKeyspaceHandler (rest::HttpRequest*);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   Handler methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// {@inheritDoc}
+////////////////////////////////////////////////////////////////////////////////
+
+        bool isDirect () const override;
+
+////////////////////////////////////////////////////////////////////////////////
+/// {@inheritDoc}
+////////////////////////////////////////////////////////////////////////////////
+
+        status_t execute () override;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+        void createKeySpace ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the properties of a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+        void readKeySpace (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief drops a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+        void dropKeySpace (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+        void readKey (KeySpace*,
+                      std::string const&,
+                      bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+        void setKey (KeySpace*,
+                     std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief increments the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+        void incrementKey (KeySpace*,
+                           std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes a key
+////////////////////////////////////////////////////////////////////////////////
+
+        void removeKey (KeySpace*,
+                        std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extracts the ttl parameter
+////////////////////////////////////////////////////////////////////////////////
+
+        bool extractTtl (double&);
+
+    };
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -31,6 +31,7 @@
 
 #include "Aql/Query.h"
 #include "Aql/QueryList.h"
+#include "Aql/QueryPlanCache.h"
 #include "Basics/StringUtils.h"
 #include "Basics/conversions.h"
 #include "Basics/json.h"
@@ -309,10 +310,13 @@ bool RestQueryHandler::readQuery () {
   else if (name == "properties") {
     return readQueryProperties();
   }
+  else if (name == "plan-cache") {
+    return readPlanCache();
+  }
 
   generateError(HttpResponse::NOT_FOUND,
                 TRI_ERROR_HTTP_NOT_FOUND,
-                "unknown type '" + name + "', expecting 'slow', 'current', or 'properties'");
+                "unknown type '" + name + "', expecting 'slow', 'current', 'properties' or 'plan-cache'");
   return true;
 }
 
@@ -420,6 +424,9 @@ bool RestQueryHandler::deleteQuery () {
   if (name == "slow") {
     return deleteQuerySlow();
   }
+  else if (name == "plan-cache") {
+    return deletePlanCache();
+  }
   else {
     return deleteQuery(name);
   }
@@ -477,10 +484,14 @@ bool RestQueryHandler::deleteQuery () {
 bool RestQueryHandler::replaceProperties () {
   const auto& suffix = _request->suffix();
 
+  if (suffix.size() == 1 && suffix[0] == "plan-cache") {
+    return replacePlanCacheProperties();
+  }
+
   if (suffix.size() != 1 || suffix[0] != "properties") {
     generateError(HttpResponse::BAD,
                   TRI_ERROR_HTTP_BAD_PARAMETER,
-                  "expecting PUT /_api/query/properties");
+                  "expecting PUT /_api/query/properties or /_api/query/plan-cache");
     return true;
   }
 
@@ -545,6 +556,172 @@ bool RestQueryHandler::replaceProperties () {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock GetApiQueryPlanCache
+/// @brief returns the state of the AQL query plan cache
+///
+/// @RESTHEADER{GET /_api/query/plan-cache, Returns the state of the AQL query plan cache}
+///
+/// Returns the configuration and the usage statistics of the query plan cache
+/// of the selected database as a JSON object with the following properties:
+///
+/// - *maxEntries*: the maximum number of plans kept in the cache. A value of
+///   *0* means that the cache is turned off.
+///
+/// - *entries*: the number of plans currently in the cache.
+///
+/// - *hits*: the number of queries that used a plan from the cache.
+///
+/// - *misses*: the number of queries that were parsed and optimized because
+///   their plan was not found in the cache.
+///
+/// - *hitRate*: the ratio of *hits* to all lookups, or *0* if no lookup was
+///   made yet.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// Is returned when the state of the cache can be retrieved successfully.
+///
+/// @RESTRETURNCODE{400}
+/// The server will respond with *HTTP 400* in case of a malformed request,
+///
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestQueryHandler::readPlanCache () {
+  try {
+    auto planCache = static_cast<QueryPlanCache*>(_vocbase->_planCache);
+    TRI_ASSERT(planCache != nullptr);
+
+    uint64_t const hits = planCache->hits();
+    uint64_t const misses = planCache->misses();
+    double const hitRate = (hits + misses > 0) ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+
+    Json result(Json::Object);
+
+    result
+    .set("error", Json(false))
+    .set("code", Json(HttpResponse::OK))
+    .set("maxEntries", Json(static_cast<double>(planCache->maxEntries())))
+    .set("entries", Json(static_cast<double>(planCache->size())))
+    .set("hits", Json(static_cast<double>(hits)))
+    .set("misses", Json(static_cast<double>(misses)))
+    .set("hitRate", Json(hitRate));
+
+    generateResult(HttpResponse::OK, result.json());
+  }
+  catch (Exception const& err) {
+    handleError(err);
+  }
+  catch (std::exception const& ex) {
+    triagens::basics::Exception err(TRI_ERROR_INTERNAL, ex.what(), __FILE__, __LINE__);
+    handleError(err);
+  }
+  catch (...) {
+    triagens::basics::Exception err(TRI_ERROR_INTERNAL, __FILE__, __LINE__);
+    handleError(err);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock PutApiQueryPlanCache
+/// @brief changes the configuration of the AQL query plan cache
+///
+/// @RESTHEADER{PUT /_api/query/plan-cache, Changes the configuration of the AQL query plan cache}
+///
+/// @RESTBODYPARAM{properties,json,required}
+/// The properties of the plan cache in the current database. 
+///
+/// The body of the HTTP request must be a JSON object with the attribute
+/// *maxEntries*, the maximum number of plans to keep in the cache. Setting it
+/// to *0* turns the cache off. When the value is lowered, the least recently
+/// used plans are removed from the cache.
+///
+/// After the configuration has been changed, the current state of the cache
+/// will be returned in the HTTP response.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// Is returned if the configuration was changed successfully.
+///
+/// @RESTRETURNCODE{400}
+/// The server will respond with *HTTP 400* in case of a malformed request,
+///
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestQueryHandler::replacePlanCacheProperties () {
+  unique_ptr<TRI_json_t> body(parseJsonBody());
+
+  if (body == nullptr) {
+    // error message generated in parseJsonBody
+    return true;
+  }
+
+  auto planCache = static_cast<QueryPlanCache*>(_vocbase->_planCache);
+  TRI_ASSERT(planCache != nullptr);
+
+  try {
+    if (JsonHelper::getObjectElement(body.get(), "maxEntries") != nullptr) {
+      planCache->maxEntries(JsonHelper::checkAndGetNumericValue<size_t>(body.get(), "maxEntries"));
+    }
+
+    return readPlanCache();
+  }
+  catch (Exception const& err) {
+    handleError(err);
+  }
+  catch (std::exception const& ex) {
+    triagens::basics::Exception err(TRI_ERROR_INTERNAL, ex.what(), __FILE__, __LINE__);
+    handleError(err);
+  }
+  catch (...) {
+    triagens::basics::Exception err(TRI_ERROR_INTERNAL, __FILE__, __LINE__);
+    handleError(err);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock DeleteApiQueryPlanCache
+/// @brief clears the AQL query plan cache
+///
+/// @RESTHEADER{DELETE /_api/query/plan-cache, Clears the AQL query plan cache}
+///
+/// Removes all plans from the query plan cache of the current database.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// The server will respond with *HTTP 200* when the cache was cleared
+/// successfully.
+///
+/// @RESTRETURNCODE{400}
+/// The server will respond with *HTTP 400* in case of a malformed request.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestQueryHandler::deletePlanCache () {
+  auto planCache = static_cast<QueryPlanCache*>(_vocbase->_planCache);
+  TRI_ASSERT(planCache != nullptr);
+
+  planCache->invalidate();
+
+  Json result(Json::Object);
+
+  result
+  .set("error", Json(false))
+  .set("code", Json(HttpResponse::OK));
+
+  generateResult(HttpResponse::OK, result.json());
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief parse an AQL query and return information about it
 ////////////////////////////////////////////////////////////////////////////////
@@ -130,6 +130,24 @@ namespace triagens {
 
         bool replaceProperties ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the state of the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        bool readPlanCache ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief changes the settings of the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        bool replacePlanCacheProperties ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief clears the plan cache
+////////////////////////////////////////////////////////////////////////////////
+
+        bool deletePlanCache ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief parses a query
 ////////////////////////////////////////////////////////////////////////////////
@@ -30,6 +30,7 @@
 #include "RestReplicationHandler.h"
 
 #include "Basics/JsonHelper.h"
+#include "Basics/MutexLocker.h"
 #include "Basics/conversions.h"
 #include "Basics/files.h"
 #include "Basics/logging.h"
@@ -61,6 +62,120 @@ const uint64_t RestReplicationHandler::defaultChunkSize = 128 * 1024;
 
 const uint64_t RestReplicationHandler::maxChunkSize = 128 * 1024 * 1024;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     keys snapshots
+// -----------------------------------------------------------------------------
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the sorted keys and revisions of a collection, kept on the master
+/// while a slave synchronises the collection incrementally
+////////////////////////////////////////////////////////////////////////////////
+
+  struct KeysSnapshot {
+    TRI_voc_tick_t                     _databaseId;
+    TRI_voc_cid_t                      _cid;
+    std::vector<TRI_replication_key_t> _keys;
+    double                             _expires;
+  };
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief time after which an unused keys snapshot is removed
+////////////////////////////////////////////////////////////////////////////////
+
+static double const KeysSnapshotTtl = 600.0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lock protecting the keys snapshots
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::basics::Mutex KeysSnapshotsLock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief all keys snapshots, by id
+////////////////////////////////////////////////////////////////////////////////
+
+static std::unordered_map<TRI_voc_tick_t, std::shared_ptr<KeysSnapshot>> KeysSnapshots;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stores a keys snapshot and returns its id. expired snapshots of
+/// slaves that went away are removed along the way
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_voc_tick_t StoreKeysSnapshot (std::shared_ptr<KeysSnapshot> snapshot) {
+  TRI_voc_tick_t const id = TRI_NewTickServer();
+  double const now = TRI_microtime();
+  snapshot->_expires = now + KeysSnapshotTtl;
+
+  // expired snapshots are freed outside the lock
+  std::vector<std::shared_ptr<KeysSnapshot>> expired;
+
+  {
+    MUTEX_LOCKER(KeysSnapshotsLock);
+
+    for (auto it = KeysSnapshots.begin(); it != KeysSnapshots.end(); /* no hoisting */) {
+      if ((*it).second->_expires < now) {
+        expired.emplace_back((*it).second);
+        it = KeysSnapshots.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+
+    KeysSnapshots.emplace(id, snapshot);
+  }
+
+  return id;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up a keys snapshot and extends its lifetime
+////////////////////////////////////////////////////////////////////////////////
+
+static std::shared_ptr<KeysSnapshot> LookupKeysSnapshot (TRI_voc_tick_t databaseId,
+                                                         TRI_voc_tick_t id) {
+  MUTEX_LOCKER(KeysSnapshotsLock);
+
+  auto it = KeysSnapshots.find(id);
+
+  if (it == KeysSnapshots.end() || (*it).second->_databaseId != databaseId) {
+    return nullptr;
+  }
+
+  (*it).second->_expires = TRI_microtime() + KeysSnapshotTtl;
+
+  return (*it).second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes a keys snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+static bool RemoveKeysSnapshot (TRI_voc_tick_t databaseId,
+                                TRI_voc_tick_t id) {
+  std::shared_ptr<KeysSnapshot> snapshot;
+
+  {
+    MUTEX_LOCKER(KeysSnapshotsLock);
+
+    auto it = KeysSnapshots.find(id);
+
+    if (it == KeysSnapshots.end() || (*it).second->_databaseId != databaseId) {
+      return false;
+    }
+
+    // the snapshot is freed outside the lock
+    snapshot = (*it).second;
+    KeysSnapshots.erase(it);
+  }
+
+  return true;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -143,6 +258,36 @@ Handler::status_t RestReplicationHandler::execute () {
         handleCommandDump();
       }
     }
+    else if (command == "keys") {
+      if (type == HttpRequest::HTTP_REQUEST_POST) {
+        if (len != 1) {
+          goto BAD_CALL;
+        }
+      }
+      else if (type == HttpRequest::HTTP_REQUEST_GET ||
+               type == HttpRequest::HTTP_REQUEST_PUT ||
+               type == HttpRequest::HTTP_REQUEST_DELETE) {
+        if (len != 2) {
+          goto BAD_CALL;
+        }
+      }
+      else {
+        goto BAD_CALL;
+      }
+
+      if (ServerState::instance()->isCoordinator()) {
+        handleTrampolineCoordinator();
+      }
+      else if (type == HttpRequest::HTTP_REQUEST_POST) {
+        handleCommandCreateKeys();
+      }
+      else if (type == HttpRequest::HTTP_REQUEST_DELETE) {
+        handleCommandRemoveKeys(suffix[1]);
+      }
+      else {
+        handleCommandKeys(suffix[1]);
+      }
+    }
     else if (command == "restore-collection") {
       if (type != HttpRequest::HTTP_REQUEST_PUT) {
         goto BAD_CALL;
@@ -2972,6 +3117,375 @@ void RestReplicationHandler::handleCommandDump () {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_post_api_replication_keys
+/// @RESTHEADER{POST /_api/replication/keys, Create a keys snapshot of a collection}
+///
+/// @RESTQUERYPARAMETERS
+///
+/// @RESTQUERYPARAM{collection,string,required}
+/// The name or id of the collection.
+///
+/// @RESTDESCRIPTION
+/// Collects the keys and revisions of all documents in the collection, sorted
+/// by key, and keeps them on the server. This snapshot is used by the
+/// incremental synchronisation to find out which parts of a collection differ
+/// between master and slave.
+///
+/// The result is a JSON object with the attributes *id* (the id of the
+/// snapshot, to be used in subsequent requests) and *count* (the number of
+/// documents in the snapshot). The snapshot is removed when it is deleted
+/// explicitly, or after it has not been used for 10 minutes.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the snapshot was created.
+///
+/// @RESTRETURNCODE{400}
+/// is returned if the collection parameter is missing.
+///
+/// @RESTRETURNCODE{404}
+/// is returned when the collection could not be found.
+///
+/// @RESTRETURNCODE{405}
+/// is returned when an invalid HTTP method is used.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestReplicationHandler::handleCommandCreateKeys () {
+  char const* collection = _request->value("collection");
+
+  if (collection == nullptr) {
+    generateError(HttpResponse::BAD,
+                  TRI_ERROR_HTTP_BAD_PARAMETER,
+                  "invalid collection parameter");
+    return;
+  }
+
+  TRI_vocbase_col_t* c = TRI_LookupCollectionByNameVocBase(_vocbase, collection);
+
+  if (c == nullptr) {
+    generateError(HttpResponse::NOT_FOUND, TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND);
+    return;
+  }
+
+  int res = TRI_ERROR_NO_ERROR;
+
+  try {
+    auto snapshot = std::make_shared<KeysSnapshot>();
+    snapshot->_databaseId = _vocbase->_id;
+    snapshot->_cid = c->_cid;
+
+    {
+      SingleCollectionReadOnlyTransaction trx(new StandaloneTransactionContext(), _vocbase, c->_cid);
+
+      res = trx.begin();
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        THROW_ARANGO_EXCEPTION(res);
+      }
+
+      res = trx.lockRead();
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        THROW_ARANGO_EXCEPTION(res);
+      }
+
+      TRI_CollectKeysReplication(trx.documentCollection(), snapshot->_keys);
+
+      trx.finish(res);
+    }
+
+    size_t const count = snapshot->_keys.size();
+    TRI_voc_tick_t const id = StoreKeysSnapshot(snapshot);
+
+    Json result(Json::Object, 2);
+    result("id", Json(StringUtils::itoa(id)))
+          ("count", Json(static_cast<double>(count)));
+
+    generateResult(result.json());
+  }
+  catch (triagens::basics::Exception const& ex) {
+    res = ex.code();
+  }
+  catch (...) {
+    res = TRI_ERROR_INTERNAL;
+  }
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateError(HttpResponse::SERVER_ERROR, res);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_get_api_replication_keys
+/// @RESTHEADER{GET /_api/replication/keys/{id}, Return key ranges of a keys snapshot}
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{id,string,required}
+/// The id of the snapshot, as returned by *POST /_api/replication/keys*.
+///
+/// @RESTQUERYPARAMETERS
+///
+/// @RESTQUERYPARAM{chunkSize,number,optional}
+/// The number of keys per key range. Defaults to 5000.
+///
+/// @RESTDESCRIPTION
+/// Returns checksums of the snapshot's keys, grouped into ranges of keys.
+/// The result is a JSON array of key ranges in ascending key order. Each
+/// range is described by an object with the attributes *low* (lowest key in
+/// range), *high* (highest key in range), *count* (number of documents in
+/// range) and *hash* (checksum of the keys and revisions of the documents in
+/// range).
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the request was executed successfully.
+///
+/// @RESTRETURNCODE{400}
+/// is returned if the chunkSize parameter is invalid.
+///
+/// @RESTRETURNCODE{404}
+/// is returned when the snapshot could not be found, because it was removed
+/// or has expired. The error number is *1414*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_put_api_replication_keys
+/// @RESTHEADER{PUT /_api/replication/keys/{id}, Return keys or documents of a keys snapshot}
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{id,string,required}
+/// The id of the snapshot, as returned by *POST /_api/replication/keys*.
+///
+/// @RESTQUERYPARAMETERS
+///
+/// @RESTQUERYPARAM{type,string,required}
+/// Either *keys* or *docs*.
+///
+/// @RESTDESCRIPTION
+/// When *type* is *keys*, the request body must be a JSON object with the
+/// attributes *low* and *high*. The result is a JSON array of all keys and
+/// revisions of the snapshot in this range, each as an array of the form
+/// *[key, revision]*.
+///
+/// When *type* is *docs*, the request body must be a JSON array of keys.
+/// The result contains the current versions of the documents with these
+/// keys, in the same format as returned by the *dump* API. Keys that do not
+/// exist (anymore) are silently skipped.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{200}
+/// is returned if the request was executed successfully.
+///
+/// @RESTRETURNCODE{400}
+/// is returned if the type parameter or the request body is invalid.
+///
+/// @RESTRETURNCODE{404}
+/// is returned when the snapshot or its collection could not be found. The
+/// error number for a snapshot that was removed or has expired is *1414*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestReplicationHandler::handleCommandKeys (std::string const& idString) {
+  auto snapshot = LookupKeysSnapshot(_vocbase->_id, StringUtils::uint64(idString));
+
+  if (snapshot == nullptr) {
+    generateError(HttpResponse::NOT_FOUND, TRI_ERROR_REPLICATION_KEYS_SNAPSHOT_NOT_FOUND);
+    return;
+  }
+
+  bool const isPut = (_request->requestType() == HttpRequest::HTTP_REQUEST_PUT);
+
+  if (! isPut) {
+    uint64_t chunkSize = 5000;
+
+    bool found;
+    char const* value = _request->value("chunkSize", found);
+
+    if (found) {
+      chunkSize = StringUtils::uint64(value);
+
+      if (chunkSize == 0) {
+        generateError(HttpResponse::BAD,
+                      TRI_ERROR_HTTP_BAD_PARAMETER,
+                      "invalid chunkSize value");
+        return;
+      }
+    }
+
+    TRI_replication_dump_t dump(_vocbase, 0, true);
+    int res = TRI_DumpKeyChunksReplication(&dump, snapshot->_keys, static_cast<size_t>(chunkSize));
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      generateError(HttpResponse::SERVER_ERROR, res);
+      return;
+    }
+
+    _response = createResponse(HttpResponse::OK);
+    _response->setContentType("application/json; charset=utf-8");
+
+    // transfer ownership of the buffer contents
+    _response->body().set(dump._buffer);
+
+    // avoid double freeing
+    TRI_StealStringBuffer(dump._buffer);
+    return;
+  }
+
+  string const type = StringUtils::tolower(_request->value("type"));
+
+  if (type != "keys" && type != "docs") {
+    generateError(HttpResponse::BAD,
+                  TRI_ERROR_HTTP_BAD_PARAMETER,
+                  "invalid type parameter");
+    return;
+  }
+
+  TRI_json_t* json = parseJsonBody();
+
+  if (json == nullptr) {
+    // error message already generated
+    return;
+  }
+
+  string low, high;
+  vector<string> keys;
+  bool valid;
+
+  if (type == "keys") {
+    valid = JsonHelper::isObject(json);
+
+    if (valid) {
+      low  = JsonHelper::getStringValue(json, "low", "");
+      high = JsonHelper::getStringValue(json, "high", "");
+      valid = (! low.empty() && ! high.empty());
+    }
+  }
+  else {
+    valid = JsonHelper::isArray(json);
+
+    if (valid) {
+      size_t const n = json->_value._objects._length;
+      keys.reserve(n);
+
+      for (size_t i = 0; i < n; ++i) {
+        TRI_json_t const* key = static_cast<TRI_json_t const*>(TRI_AtVector(&json->_value._objects, i));
+
+        if (! JsonHelper::isString(key)) {
+          valid = false;
+          break;
+        }
+
+        keys.emplace_back(string(key->_value._string.data, key->_value._string.length - 1));
+      }
+    }
+  }
+
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+  if (! valid) {
+    generateError(HttpResponse::BAD,
+                  TRI_ERROR_HTTP_BAD_PARAMETER,
+                  "invalid request body");
+    return;
+  }
+
+  int res = TRI_ERROR_NO_ERROR;
+
+  try {
+    TRI_replication_dump_t dump(_vocbase, 0, true);
+
+    if (type == "keys") {
+      // the snapshot is sorted, so only the requested range is looked at
+      res = TRI_DumpKeysReplication(&dump, snapshot->_keys, low, high);
+    }
+    else {
+      SingleCollectionReadOnlyTransaction trx(new StandaloneTransactionContext(), _vocbase, snapshot->_cid);
+
+      res = trx.begin();
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        THROW_ARANGO_EXCEPTION(res);
+      }
+
+      res = trx.lockRead();
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        THROW_ARANGO_EXCEPTION(res);
+      }
+
+      res = TRI_DumpDocumentsReplication(&dump, trx.documentCollection(), keys);
+
+      trx.finish(res);
+    }
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION(res);
+    }
+
+    _response = createResponse(HttpResponse::OK);
+
+    if (type == "docs") {
+      _response->setContentType("application/x-arango-dump; charset=utf-8");
+    }
+    else {
+      _response->setContentType("application/json; charset=utf-8");
+    }
+
+    // transfer ownership of the buffer contents
+    _response->body().set(dump._buffer);
+
+    // avoid double freeing
+    TRI_StealStringBuffer(dump._buffer);
+  }
+  catch (triagens::basics::Exception const& ex) {
+    res = ex.code();
+  }
+  catch (...) {
+    res = TRI_ERROR_INTERNAL;
+  }
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    generateError(HttpResponse::responseCode(res), res);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @startDocuBlock JSF_delete_api_replication_keys
+/// @RESTHEADER{DELETE /_api/replication/keys/{id}, Remove a keys snapshot}
+///
+/// @RESTURLPARAMETERS
+///
+/// @RESTURLPARAM{id,string,required}
+/// The id of the snapshot.
+///
+/// @RESTRETURNCODES
+///
+/// @RESTRETURNCODE{204}
+/// is returned if the snapshot was removed.
+///
+/// @RESTRETURNCODE{404}
+/// is returned when the snapshot could not be found, because it was removed
+/// or has expired. The error number is *1414*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+void RestReplicationHandler::handleCommandRemoveKeys (std::string const& idString) {
+  if (! RemoveKeysSnapshot(_vocbase->_id, StringUtils::uint64(idString))) {
+    generateError(HttpResponse::NOT_FOUND, TRI_ERROR_REPLICATION_KEYS_SNAPSHOT_NOT_FOUND);
+    return;
+  }
+
+  _response = createResponse(HttpResponse::NO_CONTENT);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @startDocuBlock JSF_put_api_replication_synchronize
 /// @RESTHEADER{PUT /_api/replication/sync, Synchronize data from a remote endpoint}
@@ -3016,6 +3530,13 @@ void RestReplicationHandler::handleCommandDump () {
 ///    will be sychronised. If *restrictType* is *exclude*, all but the specified
 ///    collections will be synchronized.
 ///
+/// - *incremental*: if set to *true*, collections that already exist locally
+///   will not be dropped and re-transferred completely. Instead, master and
+///   slave will compare checksums over ranges of document keys, and only
+///   documents in ranges that differ will be transferred. This is much faster
+///   when the local data are only slightly behind the master. The default
+///   value is *false*.
+///
 /// In case of success, the body of the response is a JSON object with the following
 /// attributes:
 ///
@@ -3073,6 +3594,7 @@ void RestReplicationHandler::handleCommandSync () {
   }
 
   bool includeSystem = JsonHelper::getBooleanValue(json, "includeSystem", true);
+  bool incremental = JsonHelper::getBooleanValue(json, "incremental", false);
 
   std::unordered_map<string, bool> restrictCollections;
   TRI_json_t* restriction = JsonHelper::getObjectElement(json, "restrictCollections");
@@ -3108,7 +3630,7 @@ void RestReplicationHandler::handleCommandSync () {
   config._password = TRI_DuplicateString2Z(TRI_CORE_MEM_ZONE, password.c_str(), password.size());
   config._includeSystem = includeSystem;
 
-  InitialSyncer syncer(_vocbase, &config, restrictCollections, restrictType, false);
+  InitialSyncer syncer(_vocbase, &config, restrictCollections, restrictType, false, incremental);
   TRI_DestroyConfigurationReplicationApplier(&config);
 
   int res = TRI_ERROR_NO_ERROR;
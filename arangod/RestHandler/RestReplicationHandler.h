@@ -279,6 +279,24 @@ namespace triagens {
 
         void handleCommandDump ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a keys snapshot for a specific collection
+////////////////////////////////////////////////////////////////////////////////
+
+        void handleCommandCreateKeys ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return key ranges, keys or documents of a keys snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+        void handleCommandKeys (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove a keys snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+        void handleCommandRemoveKeys (std::string const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief handle a sync command
 ////////////////////////////////////////////////////////////////////////////////
@@ -88,6 +88,12 @@ const string RestVocbaseBaseHandler::EXPORT_PATH            = "/_api/export";
 
 const string RestVocbaseBaseHandler::IMPORT_PATH            = "/_api/import";
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief keyspace path
+////////////////////////////////////////////////////////////////////////////////
+
+const string RestVocbaseBaseHandler::KEYSPACE_PATH          = "/_api/keyspace";
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replication path
 ////////////////////////////////////////////////////////////////////////////////
@@ -304,74 +310,10 @@ void RestVocbaseBaseHandler::generateDocument (SingleCollectionReadOnlyTransacti
 
   CollectionNameResolver const* resolver = trx.resolver();
 
-  char const* key = TRI_EXTRACT_MARKER_KEY(&mptr);  // PROTECTED by trx from above
-  string const&& id = DocumentHelper::assembleDocumentId(resolver->getCollectionName(cid), key);
-
-  TRI_json_t augmented;
-  TRI_InitObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, 5);
-
-  TRI_json_t* idJson = TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, id.c_str(), id.size());
-
-  if (idJson != nullptr) {
-    TRI_Insert2ObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, TRI_VOC_ATTRIBUTE_ID, idJson);
-  }
-
   // convert rid from uint64_t to string
   string const&& rid = StringUtils::itoa(mptr._rid);
-  TRI_json_t* rev = TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, rid.c_str(), rid.size());
-
-  if (rev != nullptr) {
-    TRI_Insert2ObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, TRI_VOC_ATTRIBUTE_REV, rev);
-  }
-
-  TRI_json_t* keyJson = TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, key, strlen(key));
 
-  if (keyJson != nullptr) {
-    TRI_Insert2ObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, TRI_VOC_ATTRIBUTE_KEY, keyJson);
-  }
-
-  TRI_df_marker_type_t type = static_cast<TRI_df_marker_t const*>(mptr.getDataPtr())->_type;  // PROTECTED by trx passed from above
-
-  if (type == TRI_DOC_MARKER_KEY_EDGE) {
-    TRI_doc_edge_key_marker_t const* marker = static_cast<TRI_doc_edge_key_marker_t const*>(mptr.getDataPtr());  // PROTECTED by trx passed from above
-    string const&& from = DocumentHelper::assembleDocumentId(resolver->getCollectionNameCluster(marker->_fromCid), string((char*) marker + marker->_offsetFromKey));
-    string const&& to = DocumentHelper::assembleDocumentId(resolver->getCollectionNameCluster(marker->_toCid), string((char*) marker +  marker->_offsetToKey));
-
-    TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, TRI_VOC_ATTRIBUTE_FROM, TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, from.c_str(), from.size()));
-    TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, TRI_VOC_ATTRIBUTE_TO, TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, to.c_str(), to.size()));
-  }
-  else if (type == TRI_WAL_MARKER_EDGE) {
-    triagens::wal::edge_marker_t const* marker = static_cast<triagens::wal::edge_marker_t const*>(mptr.getDataPtr());  // PROTECTED by trx passed from above
-    string const&& from = DocumentHelper::assembleDocumentId(resolver->getCollectionNameCluster(marker->_fromCid), string((char*) marker + marker->_offsetFromKey));
-    string const&& to = DocumentHelper::assembleDocumentId(resolver->getCollectionNameCluster(marker->_toCid), string((char*) marker +  marker->_offsetToKey));
-
-    TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, TRI_VOC_ATTRIBUTE_FROM, TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, from.c_str(), from.size()));
-    TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, &augmented, TRI_VOC_ATTRIBUTE_TO, TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, to.c_str(), to.size()));
-  }
-
-  // add document identifier to buffer
-  TRI_string_buffer_t buffer;
-
-  // convert object to string
-  TRI_InitStringBuffer(&buffer, TRI_UNKNOWN_MEM_ZONE);
-
-  TRI_shaped_json_t shapedJson;
-  TRI_EXTRACT_SHAPED_JSON_MARKER(shapedJson, mptr.getDataPtr());  // PROTECTED by trx passed from above
-  TRI_StringifyAugmentedShapedJson(shaper, &buffer, &shapedJson, &augmented);
-
-  TRI_DestroyJson(TRI_UNKNOWN_MEM_ZONE, &augmented);
-
-  if (idJson) {
-    TRI_Free(TRI_UNKNOWN_MEM_ZONE, idJson);
-  }
-
-  if (rev) {
-    TRI_Free(TRI_UNKNOWN_MEM_ZONE, rev);
-  }
-
-  if (keyJson) {
-    TRI_Free(TRI_UNKNOWN_MEM_ZONE, keyJson);
-  }
+  auto marker = static_cast<TRI_df_marker_t const*>(mptr.getDataPtr());  // PROTECTED by trx passed from above
 
   // and generate a response
   _response = createResponse(HttpResponse::OK);
@@ -379,13 +321,19 @@ void RestVocbaseBaseHandler::generateDocument (SingleCollectionReadOnlyTransacti
   _response->setHeader("etag", 4, "\"" + rid + "\"");
 
   if (generateBody) {
-    _response->body().appendText(TRI_BeginStringBuffer(&buffer), TRI_LengthStringBuffer(&buffer));
+    // write the document directly into the response body
+    DocumentHelper::stringifyDocument(_response->body().stringBuffer(), resolver, cid, marker, shaper);
   }
   else {
+    // only the length of the document is needed
+    TRI_string_buffer_t buffer;
+    TRI_InitStringBuffer(&buffer, TRI_UNKNOWN_MEM_ZONE);
+
+    DocumentHelper::stringifyDocument(&buffer, resolver, cid, marker, shaper);
     _response->headResponse(TRI_LengthStringBuffer(&buffer));
-  }
 
-  TRI_DestroyStringBuffer(&buffer);
+    TRI_DestroyStringBuffer(&buffer);
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -597,6 +545,32 @@ TRI_json_t* RestVocbaseBaseHandler::parseJsonBody () {
   return json;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parses the body directly into shaped json
+////////////////////////////////////////////////////////////////////////////////
+
+bool RestVocbaseBaseHandler::parseShapedJsonBody (ShapedJsonParser& parser,
+                                                  string const& collection) {
+  int res = parser.parse(_request->body(), _request->bodySize());
+
+  if (res == TRI_ERROR_NO_ERROR) {
+    return true;
+  }
+
+  if (res == TRI_ERROR_HTTP_CORRUPTED_JSON) {
+    char const* errmsg = parser.errorMessage();
+
+    generateError(HttpResponse::BAD,
+                  TRI_ERROR_HTTP_CORRUPTED_JSON,
+                  errmsg == nullptr ? "cannot parse json object" : errmsg);
+  }
+  else {
+    generateTransactionError(collection, res);
+  }
+
+  return false;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                           HANDLER
 // -----------------------------------------------------------------------------
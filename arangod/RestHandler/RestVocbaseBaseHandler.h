@@ -38,6 +38,7 @@
 #include "Basics/json-utilities.h"
 #include "Rest/HttpResponse.h"
 #include "RestServer/VocbaseContext.h"
+#include "ShapedJson/ShapedJsonParser.h"
 #include "Utils/transactions.h"
 
 // -----------------------------------------------------------------------------
@@ -109,6 +110,12 @@ namespace triagens {
 
         static const std::string IMPORT_PATH;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief keyspace path
+////////////////////////////////////////////////////////////////////////////////
+
+        static const std::string KEYSPACE_PATH;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replication path
 ////////////////////////////////////////////////////////////////////////////////
@@ -365,6 +372,16 @@ namespace triagens {
 
         TRI_json_t* parseJsonBody ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parses the body directly into shaped json
+///
+/// generates an error response and returns false if the body is not a valid
+/// document
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseShapedJsonBody (triagens::basics::ShapedJsonParser&,
+                                  std::string const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief extract a string attribute from a JSON array
 ///
@@ -37,6 +37,7 @@
 #include "Admin/RestHandlerCreator.h"
 #include "Admin/RestShutdownHandler.h"
 #include "Aql/Query.h"
+#include "Aql/QueryPlanCache.h"
 #include "Aql/RestAqlHandler.h"
 #include "Basics/FileUtils.h"
 #include "Basics/Nonce.h"
@@ -67,6 +68,7 @@
 #include "RestHandler/RestEdgeHandler.h"
 #include "RestHandler/RestExportHandler.h"
 #include "RestHandler/RestImportHandler.h"
+#include "RestHandler/RestKeyspaceHandler.h"
 #include "RestHandler/RestPleaseUpgradeHandler.h"
 #include "RestHandler/RestQueryHandler.h"
 #include "RestHandler/RestReplicationHandler.h"
@@ -81,6 +83,8 @@
 #include "V8/v8-utils.h"
 #include "V8Server/ApplicationV8.h"
 #include "VocBase/auth.h"
+#include "VocBase/compactor.h"
+#include "VocBase/datafile.h"
 #include "VocBase/server.h"
 #include "Wal/LogfileManager.h"
 
@@ -118,7 +122,8 @@ void ArangoServer::defineHandlers (HttpHandlerFactory* factory) {
 
   // add "/batch" handler
   factory->addPrefixHandler(RestVocbaseBaseHandler::BATCH_PATH,
-                            RestHandlerCreator<RestBatchHandler>::createNoData);
+                            RestHandlerCreator<RestBatchHandler>::createData<Dispatcher*>,
+                            _applicationDispatcher->dispatcher());
   
   // add "/cursor" handler
   factory->addPrefixHandler(RestVocbaseBaseHandler::CURSOR_PATH,
@@ -141,6 +146,10 @@ void ArangoServer::defineHandlers (HttpHandlerFactory* factory) {
   factory->addPrefixHandler(RestVocbaseBaseHandler::IMPORT_PATH,
                             RestHandlerCreator<RestImportHandler>::createNoData);
 
+  // add "/keyspace" handler
+  factory->addPrefixHandler(RestVocbaseBaseHandler::KEYSPACE_PATH,
+                            RestHandlerCreator<RestKeyspaceHandler>::createNoData);
+
   // add "/replication" handler
   factory->addPrefixHandler(RestVocbaseBaseHandler::REPLICATION_PATH,
                             RestHandlerCreator<RestReplicationHandler>::createNoData);
@@ -312,9 +321,11 @@ ArangoServer::ArangoServer (int argc, char** argv)
     _disableAuthentication(false),
     _disableAuthenticationUnixSockets(false),
     _dispatcherThreads(8),
+    _batchConcurrency(4),
     _dispatcherQueueSize(16384),
     _v8Contexts(8),
     _indexThreads(2),
+    _scanThreads(2),
     _databasePath(),
     _defaultMaximalSize(TRI_JOURNAL_DEFAULT_MAXIMAL_SIZE),
     _defaultWaitForSync(false),
@@ -322,10 +333,16 @@ ArangoServer::ArangoServer (int argc, char** argv)
     _ignoreDatafileErrors(true),
     _disableReplicationApplier(false),
     _disableQueryTracking(false),
+    _queryPlanCacheSize(128),
+    _compactionIoLimit(0),
+    _preallocateDatafiles(false),
+    _adviseDatafileAccess(true),
+    _warmupDatafiles(false),
     _server(nullptr),
     _queryRegistry(nullptr),
     _pairForAql(nullptr),
-    _indexPool(nullptr) {
+    _indexPool(nullptr),
+    _scanPool(nullptr) {
 
   TRI_SetApplicationName("arangod");
 
@@ -354,6 +371,7 @@ ArangoServer::ArangoServer (int argc, char** argv)
 
 ArangoServer::~ArangoServer () {
   delete _indexPool;
+  delete _scanPool;
 
   delete _jobManager;
 
@@ -562,7 +580,13 @@ void ArangoServer::buildApplicationServer () {
     ("database.force-sync-properties", &_forceSyncProperties, "force syncing of collection properties to disk, will use waitForSync value of collection when turned off")
     ("database.ignore-datafile-errors", &_ignoreDatafileErrors, "load collections even if datafiles may contain errors")
     ("database.disable-query-tracking", &_disableQueryTracking, "turn off AQL query tracking by default")
+    ("database.query-plan-cache-size", &_queryPlanCacheSize, "maximum number of cached AQL query plans per database")
+    ("database.compaction-io-limit", &_compactionIoLimit, "maximum number of bytes per second copied by the compaction, 0 means unlimited")
+    ("database.preallocate-datafiles", &_preallocateDatafiles, "allocate the disk space of new datafiles and logfiles")
+    ("database.advise-datafile-access", &_adviseDatafileAccess, "pass access pattern hints for datafiles and logfiles to the operating system")
+    ("database.warmup-datafiles", &_warmupDatafiles, "populate the memory mappings of new datafiles and logfiles")
     ("database.index-threads", &_indexThreads, "threads to start for parallel background index creation")
+    ("database.scan-threads", &_scanThreads, "threads to start for parallel full collection scans in AQL queries")
   ;
 
   // .............................................................................
@@ -594,6 +618,7 @@ void ArangoServer::buildApplicationServer () {
     ("server.disable-replication-applier", &_disableReplicationApplier, "start with replication applier turned off")
     ("server.allow-use-database", &ALLOW_USE_DATABASE_IN_REST_ACTIONS, "allow change of database in REST actions, only needed for unittests")
     ("server.threads", &_dispatcherThreads, "number of threads for basic operations")
+    ("server.batch-concurrency", &_batchConcurrency, "maximum number of batch request parts executed in parallel")
   ;
 
   bool disableStatistics = false;
@@ -714,6 +739,23 @@ void ArangoServer::buildApplicationServer () {
   // set global query tracking flag
   triagens::aql::Query::DisableQueryTracking(_disableQueryTracking);
 
+  // set the size of the query plan caches
+  triagens::aql::QueryPlanCache::DefaultMaxEntries(static_cast<size_t>(_queryPlanCacheSize));
+
+  // set the maximum number of batch parts executed in parallel
+  RestBatchHandler::MaxConcurrency(static_cast<size_t>((std::max)(_batchConcurrency, 0)));
+
+  // set the I/O limit of the compactors
+  TRI_SetIoLimitCompactor(_compactionIoLimit);
+
+  // set the I/O policy for datafiles and logfiles
+  TRI_df_io_policy_t ioPolicy;
+  ioPolicy._preallocate  = _preallocateDatafiles;
+  ioPolicy._adviseAccess = _adviseDatafileAccess;
+  ioPolicy._warmup       = _warmupDatafiles;
+
+  TRI_SetIoPolicyDatafile(&ioPolicy);
+
 
   // .............................................................................
   // now run arangod
@@ -771,6 +813,13 @@ void ArangoServer::buildApplicationServer () {
       _indexThreads = 128;
     }
   }
+
+  if (_scanThreads > 0) {
+    if (_scanThreads > 128) {
+      // some arbitrary limit
+      _scanThreads = 128;
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1123,6 +1172,10 @@ int ArangoServer::runConsole (TRI_vocbase_t* vocbase) {
 int ArangoServer::runUnitTests (TRI_vocbase_t* vocbase) {
   ApplicationV8::V8Context* context = _applicationV8->enterContext("STANDARD", vocbase, true);
 
+  if (context == nullptr) {
+    LOG_FATAL_AND_EXIT("cannot acquire V8 context");
+  }
+
   auto isolate = context->isolate;
 
   bool ok = false;
@@ -1178,6 +1231,11 @@ int ArangoServer::runUnitTests (TRI_vocbase_t* vocbase) {
 int ArangoServer::runScript (TRI_vocbase_t* vocbase) {
   bool ok = false;
   ApplicationV8::V8Context* context = _applicationV8->enterContext("STANDARD", vocbase, true);
+
+  if (context == nullptr) {
+    LOG_FATAL_AND_EXIT("cannot acquire V8 context");
+  }
+
   auto isolate = context->isolate;
 
   {
@@ -1265,9 +1323,14 @@ void ArangoServer::openDatabases (bool checkVersion,
     _indexPool = new triagens::basics::ThreadPool(_indexThreads, "IndexBuilder");
   }
 
+  if (_scanThreads > 0) {
+    _scanPool = new triagens::basics::ThreadPool(_scanThreads, "CollectionScanner");
+  }
+
   int res = TRI_InitServer(_server,
                            _applicationEndpointServer,
                            _indexPool,
+                           _scanPool,
                            _databasePath.c_str(),
                            _applicationV8->appPath().c_str(),
                            &defaults,
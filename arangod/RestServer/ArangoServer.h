@@ -326,6 +326,25 @@ namespace triagens {
 
         int _dispatcherThreads;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of batch parts executed in parallel
+/// @startDocuBlock serverBatchConcurrency
+/// `--server.batch-concurrency number`
+///
+/// Specifies the maximum *number* of parts of a batch request that are
+/// executed in parallel. Parts are only executed in parallel if the client
+/// sends the HTTP header `x-arango-batch-concurrency` with the batch request,
+/// and at most as many parts as given in that header are executed in
+/// parallel. The parts are executed by the batch request's thread and by
+/// other dispatcher threads. Specifying a value of *0* or *1* will turn off
+/// parallel execution of batch parts.
+///
+/// The default is *4*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        int _batchConcurrency;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief maximum size of the dispatcher queue for asynchronous requests
 /// @startDocuBlock schedulerMaximalQueueSize
@@ -372,6 +391,23 @@ namespace triagens {
 
         int _indexThreads;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of background threads for parallel collection scans
+/// @startDocuBlock scanThreads
+/// `--database.scan-threads`
+///
+/// Specifies the *number* of background threads for full collection scans in
+/// AQL queries. When a query iterates over a whole collection and filters the
+/// documents with a simple condition on the documents only, the primary index
+/// is split into parts that are scanned and filtered by these threads and the
+/// query's own thread in parallel. The scan threads are shared among all
+/// queries. Specifying a value of *0* will turn off parallel scanning, meaning
+/// that the filter is evaluated by the query's thread only.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        int _scanThreads;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief path to the database
 /// @startDocuBlock DatabaseDirectory
@@ -512,6 +548,101 @@ namespace triagens {
 
         bool _disableQueryTracking;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of cached AQL query plans per database
+/// @startDocuBlock databaseQueryPlanCacheSize
+/// `--database.query-plan-cache-size number`
+///
+/// The maximum *number* of optimized AQL query plans kept per database. When
+/// a query is executed again with the same query string and options, its plan
+/// is taken from the cache and the query is neither parsed nor optimized again.
+/// The plan of a query using bind parameters is optimized without their values
+/// and reused for other values of the same kinds. Values the optimizer depends
+/// on, such as LIMIT values and bound collection names, are part of the cached
+/// plan. If the cache is full, the least
+/// recently used plan is removed. Plans using a collection are removed when
+/// the collection is dropped or renamed, or when one of its indexes is created
+/// or dropped. Specifying a value of *0* will turn off the plan cache.
+///
+/// The default is *128*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _queryPlanCacheSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of bytes per second copied by the compactors
+/// @startDocuBlock databaseCompactionIoLimit
+/// `--database.compaction-io-limit bytes`
+///
+/// The maximum number of *bytes* per second the compaction of datafiles may
+/// copy, shared by the compactors of all databases. The compactor holds the
+/// locks of a collection only while it copies a batch of about 1 MB of a
+/// datafile. After compacting a collection, it releases all locks and waits
+/// as long as required by the limit before it continues. Limiting the
+/// compaction throughput reduces its impact on the disk I/O of other
+/// operations, but compaction will take longer.
+/// Specifying a value of *0* will not limit the compaction.
+///
+/// The default is *0*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _compactionIoLimit;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief preallocate the disk space of new datafiles and logfiles
+/// @startDocuBlock databasePreallocateDatafiles
+/// `--database.preallocate-datafiles flag`
+///
+/// If *true*, the disk space of new journals, compactor files and
+/// write-ahead logfiles is allocated when the files are created. Otherwise
+/// the files are created as sparse files, and the filesystem allocates the
+/// space when the files are written, which may fragment them. Preallocated
+/// files use their full size on disk immediately. The option has no effect on
+/// platforms or filesystems that do not support preallocation.
+///
+/// The default is *false*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _preallocateDatafiles;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief pass access pattern hints for datafiles and logfiles to the kernel
+/// @startDocuBlock databaseAdviseDatafileAccess
+/// `--database.advise-datafile-access flag`
+///
+/// If *true*, the server tells the operating system how memory-mapped files
+/// are accessed: journals, compactor files and write-ahead logfiles are
+/// written sequentially, and datafiles are read sequentially when a
+/// collection is loaded or compacted. Otherwise datafiles are accessed at
+/// random positions, so no readahead is performed for them. The memory of
+/// write-ahead logfiles is released when their data has been transferred into
+/// the collections.
+///
+/// The default is *true*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _adviseDatafileAccess;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief populate the memory mappings of new datafiles and logfiles
+/// @startDocuBlock databaseWarmupDatafiles
+/// `--database.warmup-datafiles flag`
+///
+/// If *true*, the memory mapping of a new journal, compactor file or
+/// write-ahead logfile is populated when the file is created, so that writing
+/// to the file does not cause a page fault for every page. This makes
+/// creating these files slower. The option is only supported on Linux.
+///
+/// The default is *false*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _warmupDatafiles;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief unit tests
 ///
@@ -592,6 +723,12 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         triagens::basics::ThreadPool* _indexPool;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief thread pool for parallel collection scans
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ThreadPool* _scanPool;
     };
   }
 }
@@ -94,6 +94,12 @@ void ConsoleThread::run () {
   // enter V8 context
   _context = _applicationV8->enterContext("STANDARD", _vocbase, true);
 
+  // note: the context might be 0 in case of shut-down
+  if (_context == nullptr) {
+    _done = 1;
+    return;
+  }
+
   try {
     inner();
   }
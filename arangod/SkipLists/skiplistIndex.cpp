@@ -33,6 +33,7 @@
 #include "ShapedJson/shaped-json.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/voc-shaper.h"
+#include "Wal/Marker.h"
 
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
@@ -59,6 +60,131 @@
 // lists: lexicographically and within each slot according to these rules.
 // ...........................................................................
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief extracts the vertex of an element of a vertex-centric index
+////////////////////////////////////////////////////////////////////////////////
+
+static void ExtractVertex (SkiplistIndex const* skiplistIndex,
+                           TRI_skiplist_index_element_t const* element,
+                           TRI_voc_cid_t& cid,
+                           char const*& key) {
+  bool const from = (skiplistIndex->_vertex == TRI_SKIPLIST_VERTEX_FROM);
+  TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(element->_document->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
+
+  if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
+    auto edge = reinterpret_cast<TRI_doc_edge_key_marker_t const*>(marker);  // ONLY IN INDEX, PROTECTED by RUNTIME
+
+    cid = from ? edge->_fromCid : edge->_toCid;
+    key = reinterpret_cast<char const*>(edge) + (from ? edge->_offsetFromKey : edge->_offsetToKey);
+  }
+  else if (marker->_type == TRI_WAL_MARKER_EDGE) {
+    auto edge = reinterpret_cast<triagens::wal::edge_marker_t const*>(marker);  // ONLY IN INDEX, PROTECTED by RUNTIME
+
+    cid = from ? edge->_fromCid : edge->_toCid;
+    key = reinterpret_cast<char const*>(edge) + (from ? edge->_offsetFromKey : edge->_offsetToKey);
+  }
+  else {
+    // not an edge
+    cid = 0;
+    key = "";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compares a lookup value with the vertex of an element
+///
+/// The lookup value of the vertex is a string of the form "cid/key", which
+/// is built by the index lookup from the vertex handle. Values of other types
+/// are ordered against the vertices like they are ordered against strings.
+////////////////////////////////////////////////////////////////////////////////
+
+static int CompareKeyVertex (SkiplistIndex const* skiplistIndex,
+                             TRI_shaped_json_t const* left,
+                             TRI_skiplist_index_element_t const* right,
+                             TRI_shaper_t* shaper) {
+  TRI_shape_t const* shape = shaper->lookupShapeId(shaper, left->_sid);
+  char* data;
+  size_t length;
+
+  if (shape == nullptr) {
+    return -1;
+  }
+
+  if (! TRI_StringValueShapedJson(shape, left->_data.data, &data, &length)) {
+    // null, booleans and numbers are lower than strings, lists and arrays
+    // are greater
+    if (shape->_type == TRI_SHAPE_NULL ||
+        shape->_type == TRI_SHAPE_BOOLEAN ||
+        shape->_type == TRI_SHAPE_NUMBER) {
+      return -1;
+    }
+
+    return 1;
+  }
+
+  TRI_voc_cid_t leftCid = 0;
+  size_t i = 0;
+
+  while (i < length && data[i] >= '0' && data[i] <= '9') {
+    leftCid = leftCid * 10 + (data[i] - '0');
+    ++i;
+  }
+
+  if (i < length && data[i] == '/') {
+    ++i;
+  }
+
+  TRI_voc_cid_t rightCid;
+  char const* rightKey;
+  ExtractVertex(skiplistIndex, right, rightCid, rightKey);
+
+  if (leftCid != rightCid) {
+    return leftCid < rightCid ? -1 : 1;
+  }
+
+  size_t const leftLength = length - i;
+  size_t const rightLength = strlen(rightKey);
+  int compareResult = memcmp(data + i, rightKey, (std::min)(leftLength, rightLength));
+
+  if (compareResult < 0 || (compareResult == 0 && leftLength < rightLength)) {
+    return -1;
+  }
+  else if (compareResult > 0 || (compareResult == 0 && leftLength > rightLength)) {
+    return 1;
+  }
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compares the vertices of two elements
+////////////////////////////////////////////////////////////////////////////////
+
+static int CompareVertexVertex (SkiplistIndex const* skiplistIndex,
+                                TRI_skiplist_index_element_t const* left,
+                                TRI_skiplist_index_element_t const* right) {
+  TRI_voc_cid_t leftCid;
+  TRI_voc_cid_t rightCid;
+  char const* leftKey;
+  char const* rightKey;
+
+  ExtractVertex(skiplistIndex, left, leftCid, leftKey);
+  ExtractVertex(skiplistIndex, right, rightCid, rightKey);
+
+  if (leftCid != rightCid) {
+    return leftCid < rightCid ? -1 : 1;
+  }
+
+  int compareResult = strcmp(leftKey, rightKey);
+
+  if (compareResult < 0) {
+    return -1;
+  }
+  else if (compareResult > 0) {
+    return 1;
+  }
+  return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief compares a key with an element, version with proper types
 ////////////////////////////////////////////////////////////////////////////////
@@ -135,11 +261,18 @@ static int CmpElmElm (void* sli,
   SkiplistIndex* skiplistindex = static_cast<SkiplistIndex*>(sli);
   shaper = skiplistindex->_collection->getShaper();  // ONLY IN INDEX, PROTECTED by RUNTIME
   for (size_t j = 0;  j < skiplistindex->_numFields;  j++) {
-    int compareResult = CompareElementElement(leftElement,
-                                              j,
-                                              rightElement,
-                                              j,
-                                              shaper);
+    int compareResult;
+
+    if (j == 0 && skiplistindex->_vertex != TRI_SKIPLIST_VERTEX_NONE) {
+      compareResult = CompareVertexVertex(skiplistindex, leftElement, rightElement);
+    }
+    else {
+      compareResult = CompareElementElement(leftElement,
+                                            j,
+                                            rightElement,
+                                            j,
+                                            shaper);
+    }
 
     if (compareResult != 0) {
       return compareResult;
@@ -191,7 +324,14 @@ static int CmpKeyElm (void* sli,
   // attributes, therefore we only run the following loop to
   // leftKey->_numFields.
   for (size_t j = 0;  j < leftKey->_numFields;  j++) {
-    int compareResult = CompareKeyElement(&leftKey->_fields[j], rightElement, j, shaper);
+    int compareResult;
+
+    if (j == 0 && skiplistindex->_vertex != TRI_SKIPLIST_VERTEX_NONE) {
+      compareResult = CompareKeyVertex(skiplistindex, &leftKey->_fields[j], rightElement, shaper);
+    }
+    else {
+      compareResult = CompareKeyElement(&leftKey->_fields[j], rightElement, j, shaper);
+    }
 
     if (compareResult != 0) {
       return compareResult;
@@ -441,7 +581,8 @@ void SkiplistIndex_free (SkiplistIndex* slIndex) {
 
 SkiplistIndex* SkiplistIndex_new (TRI_document_collection_t* document,
                                   size_t numFields,
-                                  bool unique) {
+                                  bool unique,
+                                  TRI_skiplist_vertex_e vertex) {
   SkiplistIndex* skiplistIndex = static_cast<SkiplistIndex*>(TRI_Allocate(TRI_CORE_MEM_ZONE, sizeof(SkiplistIndex), true));
 
   if (skiplistIndex == nullptr) {
@@ -451,6 +592,7 @@ SkiplistIndex* SkiplistIndex_new (TRI_document_collection_t* document,
   skiplistIndex->_collection = document;
   skiplistIndex->_numFields = numFields;
   skiplistIndex->unique = unique;
+  skiplistIndex->_vertex = vertex;
   try {
     skiplistIndex->skiplist = new triagens::basics::SkipList(
                                            CmpElmElm, CmpKeyElm, skiplistIndex,
@@ -48,9 +48,27 @@ struct TRI_document_collection_t;
 // --SECTION--                                        skiplistIndex public types
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief vertex attribute of a vertex-centric skiplist index
+///
+/// A skiplist index on an edge collection whose first attribute is _from or
+/// _to takes the first attribute from the edge marker instead of the shaped
+/// document. The edges are ordered by collection id and key of the vertex,
+/// so all edges of a vertex form one contiguous range of the index, ordered
+/// by the remaining attributes.
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum {
+  TRI_SKIPLIST_VERTEX_NONE = 0,
+  TRI_SKIPLIST_VERTEX_FROM = 1,
+  TRI_SKIPLIST_VERTEX_TO   = 2
+}
+TRI_skiplist_vertex_e;
+
 typedef struct {
   triagens::basics::SkipList* skiplist;
   bool unique;
+  TRI_skiplist_vertex_e _vertex;
   struct TRI_document_collection_t* _collection;
   size_t _numFields;
 }
@@ -140,7 +158,7 @@ int SkiplistIndex_assignMethod (void*, TRI_index_method_assignment_type_e);
 //------------------------------------------------------------------------------
 
 SkiplistIndex* SkiplistIndex_new (struct TRI_document_collection_t*,
-                                  size_t, bool);
+                                  size_t, bool, TRI_skiplist_vertex_e);
 
 TRI_skiplist_iterator_t* SkiplistIndex_find (SkiplistIndex*, 
                                              TRI_vector_t const*,
@@ -28,15 +28,44 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Utils/Cursor.h"
+#include "Aql/AqlItemBlock.h"
+#include "Aql/ExecutionBlock.h"
+#include "Aql/ExecutionEngine.h"
+#include "Aql/Query.h"
+#include "Basics/ConditionLocker.h"
 #include "Basics/JsonHelper.h"
+#include "Basics/tri-strings.h"
 #include "ShapedJson/shaped-json.h"
+#include "Utils/AqlTransaction.h"
 #include "Utils/CollectionExport.h"
+#include "Utils/DocumentHelper.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/vocbase.h"
 #include "VocBase/voc-shaper.h"
 
 using namespace triagens::arango;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief attribute filter for exports with restrictions
+////////////////////////////////////////////////////////////////////////////////
+
+static bool ExportRestrictionsFilter (char const* name,
+                                      void* data) {
+  auto restrictions = static_cast<CollectionExport::Restrictions const*>(data);
+
+  bool const keyContainedInRestrictions = (restrictions->fields.find(name) != restrictions->fields.end());
+
+  if (restrictions->type == CollectionExport::Restrictions::RESTRICTION_INCLUDE) {
+    return keyContainedInRestrictions;
+  }
+
+  return ! keyContainedInRestrictions;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                      class Cursor
 // -----------------------------------------------------------------------------
@@ -305,119 +334,517 @@ void ExportCursor::dump (triagens::basics::StringBuffer& buffer) {
     
     auto marker = static_cast<TRI_df_marker_t const*>(_ex->_documents->at(_position++));
 
-    TRI_shaped_json_t shaped;
-    TRI_EXTRACT_SHAPED_JSON_MARKER(shaped, marker);
-    triagens::basics::Json json(shaper->_memoryZone, TRI_JsonShapedJson(shaper, &shaped));
+    bool ok;
+
+    if (restrictionType == CollectionExport::Restrictions::RESTRICTION_INCLUDE ||
+        restrictionType == CollectionExport::Restrictions::RESTRICTION_EXCLUDE) {
+      // only include the specified fields
+      ok = DocumentHelper::stringifyDocument(buffer.stringBuffer(), &_ex->_resolver, _ex->_document->_info._cid, marker, shaper, &ExportRestrictionsFilter, &_ex->_restrictions);
+    }
+    else {
+      // no restrictions
+      TRI_ASSERT(restrictionType == CollectionExport::Restrictions::RESTRICTION_NONE);
+      ok = DocumentHelper::stringifyDocument(buffer.stringBuffer(), &_ex->_resolver, _ex->_document->_info._cid, marker, shaper);
+    }
 
-    // append the internal attributes
+    if (! ok) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+  }
 
-    // _id, _key, _rev
-    char const* key = TRI_EXTRACT_MARKER_KEY(marker);
-    std::string id(_ex->_resolver.getCollectionName(_ex->_document->_info._cid));
-    id.push_back('/');
-    id.append(key);
+  buffer.appendText("],\"hasMore\":");
+  buffer.appendText(hasNext() ? "true" : "false");
 
-    json(TRI_VOC_ATTRIBUTE_ID, triagens::basics::Json(id));
-    json(TRI_VOC_ATTRIBUTE_REV, triagens::basics::Json(std::to_string(TRI_EXTRACT_MARKER_RID(marker))));
-    json(TRI_VOC_ATTRIBUTE_KEY, triagens::basics::Json(key));
+  if (hasNext()) {
+    // only return cursor id if there are more documents
+    buffer.appendText(",\"id\":\"");
+    buffer.appendInteger(id());
+    buffer.appendText("\"");
+  }
 
-    if (TRI_IS_EDGE_MARKER(marker)) {
-      // _from
-      std::string from(_ex->_resolver.getCollectionNameCluster(TRI_EXTRACT_MARKER_FROM_CID(marker)));
-      from.push_back('/');
-      from.append(TRI_EXTRACT_MARKER_FROM_KEY(marker));
-      json(TRI_VOC_ATTRIBUTE_FROM, triagens::basics::Json(from));
+  if (hasCount()) {
+    buffer.appendText(",\"count\":");
+    buffer.appendInteger(static_cast<uint64_t>(count()));
+  }
+
+  if (! hasNext()) {
+    delete _ex;
+    _ex = nullptr;
+
+    // mark the cursor as deleted
+    this->deleted();
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class StreamCursor
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a stream cursor
+/// the cursor takes over the query and the query string it points to. the
+/// query must be prepared by calling prepare()
+////////////////////////////////////////////////////////////////////////////////
+
+StreamCursor::StreamCursor (TRI_vocbase_t* vocbase,
+                            CursorId id,
+                            triagens::aql::Query* query,
+                            char* queryString,
+                            size_t batchSize,
+                            double ttl)
+  : Cursor(id, batchSize, nullptr, ttl, false),
+    _vocbase(vocbase),
+    _query(query),
+    _queryString(queryString),
+    _block(nullptr),
+    _blockPosition(0),
+    _current(nullptr),
+    _result(nullptr),
+    _condition(),
+    _job(nullptr),
+    _jobError(TRI_ERROR_NO_ERROR),
+    _jobErrorMessage(),
+    _stop(false),
+    _thread() {
+
+  _thread = std::thread(&StreamCursor::run, this);
+
+  TRI_UseVocBase(vocbase);
+}
         
-      // _to
-      std::string to(_ex->_resolver.getCollectionNameCluster(TRI_EXTRACT_MARKER_TO_CID(marker)));
-      to.push_back('/');
-      to.append(TRI_EXTRACT_MARKER_TO_KEY(marker));
-      json(TRI_VOC_ATTRIBUTE_TO, triagens::basics::Json(to));
+StreamCursor::~StreamCursor () {
+  try {
+    // an unfinished query is aborted by the thread that started it
+    execute([this] () -> void {
+      freeQuery();
+    });
+  }
+  catch (...) {
+  }
+
+  {
+    CONDITION_LOCKER(guard, _condition);
+    _stop = true;
+    guard.broadcast();
+  }
+
+  _thread.join();
+
+  TRI_ReleaseVocBase(_vocbase);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepare the query
+/// data-modification queries are executed completely, so their results are
+/// served from memory afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::prepare (triagens::aql::QueryRegistry* registry) {
+  try {
+    execute([this, &registry] () -> void {
+      prepareQuery(registry);
+    });
+  }
+  catch (...) {
+    this->deleted();
+    throw;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether the cursor contains more data
+/// this will fetch the next block of results from the engine if required
+////////////////////////////////////////////////////////////////////////////////
+
+bool StreamCursor::hasNext () {
+  bool result = false;
+
+  execute([this, &result] () -> void {
+    result = fetch();
+  });
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the next element
+/// the element is owned by the cursor and is valid until the next call
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* StreamCursor::next () {
+  TRI_json_t* result = nullptr;
+
+  execute([this, &result] () -> void {
+    result = nextRow();
+  });
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of results returned so far
+////////////////////////////////////////////////////////////////////////////////
+
+size_t StreamCursor::count () const {
+  return _position;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the next batch into a string buffer
+////////////////////////////////////////////////////////////////////////////////
+        
+void StreamCursor::dump (triagens::basics::StringBuffer& buffer) {
+  try {
+    execute([this, &buffer] () -> void {
+      try {
+        dumpBatch(buffer);
+      }
+      catch (...) {
+        // the query cannot be continued after an error
+        freeQuery();
+        throw;
+      }
+    });
+  }
+  catch (...) {
+    this->deleted();
+    throw;
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute a job in the cursor's thread and wait for it
+/// an error raised by the job is rethrown in the calling thread
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::execute (std::function<void()> const& job) {
+  int res;
+  std::string message;
+
+  {
+    CONDITION_LOCKER(guard, _condition);
+
+    TRI_ASSERT(_job == nullptr);
+    _job = &job;
+    guard.broadcast();
+
+    while (_job != nullptr) {
+      guard.wait();
     }
 
-    if (restrictionType == CollectionExport::Restrictions::RESTRICTION_INCLUDE ||
-        restrictionType == CollectionExport::Restrictions::RESTRICTION_EXCLUDE) {
-      // only include the specified fields
-      // for this we'll modify the JSON that we already have, in place
-      // we'll scan through the JSON attributs from left to right and
-      // keep all those that we want to keep. we'll overwrite existing
-      // other values in the JSON 
-      TRI_json_t* obj = json.json();
-      TRI_ASSERT(TRI_IsObjectJson(obj));
+    res = _jobError;
+    message = _jobErrorMessage;
+  }
 
-      size_t const n = obj->_value._objects._length;
+  if (res != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(res, message);
+  }
+}
 
-      size_t j = 0;
-      for (size_t i = 0; i < n; i += 2) {
-        auto key = static_cast<TRI_json_t const*>(TRI_AtVector(&obj->_value._objects, i));
+////////////////////////////////////////////////////////////////////////////////
+/// @brief main loop of the cursor's thread
+////////////////////////////////////////////////////////////////////////////////
 
-        if (! TRI_IsStringJson(key)) {
-          continue;
-        }
+void StreamCursor::run () {
+  CONDITION_LOCKER(guard, _condition);
 
-        bool const keyContainedInRestrictions = (_ex->_restrictions.fields.find(key->_value._string.data) != _ex->_restrictions.fields.end());
-
-        if ((restrictionType == CollectionExport::Restrictions::RESTRICTION_INCLUDE && keyContainedInRestrictions) ||
-            (restrictionType == CollectionExport::Restrictions::RESTRICTION_EXCLUDE && ! keyContainedInRestrictions)) {
-          // include the field
-          if (i != j) {
-            // steal the key and the value
-            void* src = TRI_AddressVector(&obj->_value._objects, i);
-            void* dst = TRI_AddressVector(&obj->_value._objects, j);
-            memcpy(dst, src, 2 * sizeof(TRI_json_t));
-          }
-          j += 2;
-        }
-        else {
-          // do not include the field
-          // key
-          auto src = static_cast<TRI_json_t*>(TRI_AddressVector(&obj->_value._objects, i));
-          TRI_DestroyJson(TRI_UNKNOWN_MEM_ZONE, src);
-          // value
-          TRI_DestroyJson(TRI_UNKNOWN_MEM_ZONE, src + 1);
+  while (true) {
+    while (_job == nullptr && ! _stop) {
+      guard.wait();
+    }
+
+    if (_job == nullptr) {
+      // the cursor is destroyed
+      return;
+    }
+
+    _jobError = TRI_ERROR_NO_ERROR;
+    _jobErrorMessage.clear();
+
+    try {
+      (*_job)();
+    }
+    catch (triagens::basics::Exception const& ex) {
+      _jobError = ex.code();
+      _jobErrorMessage = ex.message();
+    }
+    catch (std::bad_alloc const&) {
+      _jobError = TRI_ERROR_OUT_OF_MEMORY;
+      _jobErrorMessage = TRI_errno_string(TRI_ERROR_OUT_OF_MEMORY);
+    }
+    catch (...) {
+      _jobError = TRI_ERROR_INTERNAL;
+      _jobErrorMessage = TRI_errno_string(TRI_ERROR_INTERNAL);
+    }
+
+    _job = nullptr;
+    guard.broadcast();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepare the query, and execute it if it modifies data
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::prepareQuery (triagens::aql::QueryRegistry* registry) {
+  TRI_ASSERT(_query != nullptr);
+
+  auto preparedResult = _query->prepare(registry);
+
+  if (preparedResult.code != TRI_ERROR_NO_ERROR) {
+    THROW_ARANGO_EXCEPTION_MESSAGE(preparedResult.code, preparedResult.details);
+  }
+
+  if (_query->isModificationQuery()) {
+    // data-modification queries must commit before the cursor is returned
+    auto queryResult = _query->executePrepared();
+
+    if (queryResult.code != TRI_ERROR_NO_ERROR) {
+      THROW_ARANGO_EXCEPTION_MESSAGE(queryResult.code, queryResult.details);
+    }
+
+    TRI_ASSERT(TRI_IsArrayJson(queryResult.json));
+    _result = queryResult.json;
+    queryResult.json = nullptr;
+
+    setExtra(queryResult);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether there are more results, and fetch the next block of
+/// results from the engine if required
+////////////////////////////////////////////////////////////////////////////////
+
+bool StreamCursor::fetch () {
+  if (_result != nullptr) {
+    return (_position < TRI_LengthArrayJson(_result));
+  }
+
+  if (_query == nullptr) {
+    return false;
+  }
+
+  auto engine = _query->engine();
+  auto const resultRegister = engine->resultRegister();
+
+  while (true) {
+    if (_block != nullptr) {
+      size_t const n = _block->size();
+
+      while (_blockPosition < n) {
+        if (! _block->getValueReference(_blockPosition, resultRegister).isEmpty()) {
+          return true;
         }
+        ++_blockPosition;
       }
 
-      // finally adjust the length of the patched JSON so the NULL fields at
-      // the end will not be dumped 
-      obj->_value._objects._length = j;
+      engine->_itemBlockManager.returnBlock(_block);
+      _blockPosition = 0;
     }
-    else {
-      // no restrictions
-      TRI_ASSERT(restrictionType == CollectionExport::Restrictions::RESTRICTION_NONE);
+
+    size_t const atMost = (std::min)(batchSize(), triagens::aql::ExecutionBlock::DefaultBatchSize);
+    _block = engine->getSome(1, atMost);
+
+    if (_block == nullptr) {
+      // query is exhausted
+      finish();
+      return false;
     }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the next result row
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* StreamCursor::nextRow () {
+  if (_result != nullptr) {
+    TRI_ASSERT(_position < TRI_LengthArrayJson(_result));
+    return static_cast<TRI_json_t*>(TRI_AtVector(&_result->_value._objects, _position++));
+  }
+
+  TRI_ASSERT(_query != nullptr);
+  TRI_ASSERT(_block != nullptr);
+  TRI_ASSERT(_blockPosition < _block->size());
+
+  if (_current != nullptr) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, _current);
+    _current = nullptr;
+  }
+
+  auto const resultRegister = _query->engine()->resultRegister();
+  auto doc = _block->getDocumentCollection(resultRegister);
+  auto val = _block->getValueReference(_blockPosition++, resultRegister);
+
+  _current = val.toJson(_query->trx(), doc).steal();
+  ++_position;
+
+  return _current;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the next batch into a string buffer
+////////////////////////////////////////////////////////////////////////////////
         
-    int res = TRI_StringifyJson(buffer.stringBuffer(), json.json());
+void StreamCursor::dumpBatch (triagens::basics::StringBuffer& buffer) {
+  buffer.appendText("\"result\":[");
+
+  size_t const n = batchSize();
+
+  for (size_t i = 0; i < n; ++i) {
+    if (! fetch()) {
+      break;
+    }
+
+    if (i > 0) {
+      buffer.appendChar(',');
+    }
+
+    if (_result == nullptr) {
+      auto const resultRegister = _query->engine()->resultRegister();
+      auto const& val = _block->getValueReference(_blockPosition, resultRegister);
+
+      if (val.isShaped()) {
+        // write documents directly, without converting them to json first
+        auto doc = _block->getDocumentCollection(resultRegister);
+
+        if (! DocumentHelper::stringifyDocument(buffer.stringBuffer(), _query->trx()->resolver(), doc->_info._cid, val.getMarker(), doc->getShaper())) {
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+
+        ++_blockPosition;
+        ++_position;
+        continue;
+      }
+    }
+    
+    auto row = nextRow();
+    if (row == nullptr) {
+      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+    }
+
+    int res = TRI_StringifyJson(buffer.stringBuffer(), row);
 
     if (res != TRI_ERROR_NO_ERROR) {
       THROW_ARANGO_EXCEPTION(res);
     }
   }
 
+  bool const more = fetch();
+
   buffer.appendText("],\"hasMore\":");
-  buffer.appendText(hasNext() ? "true" : "false");
+  buffer.appendText(more ? "true" : "false");
 
-  if (hasNext()) {
+  if (more) {
     // only return cursor id if there are more documents
     buffer.appendText(",\"id\":\"");
     buffer.appendInteger(id());
     buffer.appendText("\"");
   }
-
-  if (hasCount()) {
-    buffer.appendText(",\"count\":");
-    buffer.appendInteger(static_cast<uint64_t>(count()));
+  else if (_result != nullptr) {
+    // the data-modification query was finished when it was prepared
+    freeQuery();
   }
 
-  if (! hasNext()) {
-    delete _ex;
-    _ex = nullptr;
+  TRI_json_t const* extraJson = extra();
 
+  if (TRI_IsObjectJson(extraJson)) {
+    buffer.appendText(",\"extra\":");
+    TRI_StringifyJson(buffer.stringBuffer(), extraJson);
+  }
+    
+  if (! more) {
     // mark the cursor as deleted
     this->deleted();
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finish the query and build the "extra" attribute from its result
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::finish () {
+  TRI_ASSERT(_query != nullptr);
+
+  auto queryResult = _query->finish();
+  setExtra(queryResult);
+
+  freeQuery();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief build the "extra" attribute from the result of the query
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::setExtra (triagens::aql::QueryResult& queryResult) {
+  triagens::basics::Json extra(triagens::basics::Json::Object, 3); 
+ 
+  if (queryResult.stats != nullptr) {
+    extra.set("stats", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.stats, triagens::basics::Json::AUTOFREE));
+    queryResult.stats = nullptr;
+  }
+  if (queryResult.profile != nullptr) {
+    extra.set("profile", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.profile, triagens::basics::Json::AUTOFREE));
+    queryResult.profile = nullptr;
+  }
+  if (queryResult.warnings == nullptr) {
+    extra.set("warnings", triagens::basics::Json(triagens::basics::Json::Array));
+  }
+  else {
+    extra.set("warnings", triagens::basics::Json(TRI_UNKNOWN_MEM_ZONE, queryResult.warnings, triagens::basics::Json::AUTOFREE));
+    queryResult.warnings = nullptr;
+  }
+
+  TRI_ASSERT(_extra == nullptr);
+  _extra = extra.steal();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the query and the current results
+/// an unfinished query will be aborted
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamCursor::freeQuery () {
+  if (_current != nullptr) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, _current);
+    _current = nullptr;
+  }
+
+  if (_block != nullptr) {
+    TRI_ASSERT(_query != nullptr && _query->engine() != nullptr);
+    _query->engine()->_itemBlockManager.returnBlock(_block);
+  }
+
+  if (_result != nullptr) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, _result);
+    _result = nullptr;
+  }
+
+  if (_query != nullptr) {
+    delete _query;
+    _query = nullptr;
+  }
+
+  if (_queryString != nullptr) {
+    // must be freed after the query, which points into it
+    TRI_FreeString(TRI_UNKNOWN_MEM_ZONE, _queryString);
+    _queryString = nullptr;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -31,13 +31,24 @@
 #define ARANGODB_ARANGO_CURSOR_H 1
 
 #include "Basics/Common.h"
+#include "Basics/ConditionVariable.h"
 #include "Basics/StringBuffer.h"
 #include "VocBase/voc-types.h"
 
+#include <functional>
+#include <thread>
+
 struct TRI_json_t;
 struct TRI_vocbase_s;
 
 namespace triagens {
+  namespace aql {
+    class AqlItemBlock;
+    class Query;
+    class QueryRegistry;
+    struct QueryResult;
+  }
+
   namespace arango {
 
     class CollectionExport;
@@ -233,6 +244,122 @@ namespace triagens {
         size_t const                        _size;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                class StreamCursor
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a cursor that keeps the query alive and fetches each batch from
+/// the execution engine on demand
+///
+/// the statistics, warnings and profile of the query are only known when the
+/// query is exhausted, so they are returned with the last batch. the total
+/// number of results is not known in advance, so stream cursors do not
+/// support counting
+///
+/// the query's transaction holds the collection locks of the thread that
+/// started it, so each cursor runs its query in a thread of its own, from
+/// preparing it to committing or aborting it. the cursor's methods hand their
+/// work to this thread and wait for it
+////////////////////////////////////////////////////////////////////////////////
+    
+    class StreamCursor : public Cursor {
+      public:
+
+        StreamCursor (struct TRI_vocbase_s*,
+                      CursorId,
+                      triagens::aql::Query*,
+                      char*,
+                      size_t,
+                      double);
+
+        ~StreamCursor ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public functions
+// -----------------------------------------------------------------------------
+
+      public:
+
+        void prepare (triagens::aql::QueryRegistry*);
+
+        bool hasNext () override final;
+
+        struct TRI_json_t* next () override final;
+        
+        size_t count () const override final;
+
+        void dump (triagens::basics::StringBuffer&) override final;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+      private:
+
+        void execute (std::function<void()> const&);
+
+        void run ();
+
+        void prepareQuery (triagens::aql::QueryRegistry*);
+
+        bool fetch ();
+
+        struct TRI_json_t* nextRow ();
+
+        void dumpBatch (triagens::basics::StringBuffer&);
+
+        void finish ();
+
+        void setExtra (triagens::aql::QueryResult&);
+
+        void freeQuery ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+        struct TRI_vocbase_s*         _vocbase;
+        triagens::aql::Query*         _query;
+        char*                         _queryString;
+        triagens::aql::AqlItemBlock*  _block;
+        size_t                        _blockPosition;
+        struct TRI_json_t*            _current;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief complete result of a data-modification query, which is executed
+/// when it is prepared
+////////////////////////////////////////////////////////////////////////////////
+
+        struct TRI_json_t*            _result;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief protects the job handed to the cursor's thread
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ConditionVariable _condition;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the job the cursor's thread has to execute next
+////////////////////////////////////////////////////////////////////////////////
+
+        std::function<void()> const*  _job;
+
+        int                           _jobError;
+
+        std::string                   _jobErrorMessage;
+
+        bool                          _stop;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the thread that prepares, executes and finishes the query
+////////////////////////////////////////////////////////////////////////////////
+
+        std::thread                   _thread;
+    };
+
   }
 }
 
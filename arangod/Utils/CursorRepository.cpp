@@ -28,9 +28,11 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "Utils/CursorRepository.h"
+#include "Aql/Query.h"
 #include "Basics/json.h"
 #include "Basics/logging.h"
 #include "Basics/MutexLocker.h"
+#include "Basics/tri-strings.h"
 #include "Utils/CollectionExport.h"
 #include "VocBase/server.h"
 #include "VocBase/vocbase.h"
@@ -171,6 +173,46 @@ ExportCursor* CursorRepository::createFromExport (triagens::arango::CollectionEx
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a cursor from a query and stores it in the registry
+/// the cursor will be returned with the usage flag set to true. it must be
+/// returned later using release() 
+/// the cursor will take ownership of both the query and the query string
+////////////////////////////////////////////////////////////////////////////////
+
+StreamCursor* CursorRepository::createFromQuery (triagens::aql::Query* query,
+                                                 char* queryString,
+                                                 size_t batchSize,
+                                                 double ttl) {
+  TRI_ASSERT(query != nullptr);
+
+  CursorId const id = TRI_NewTickServer();
+  triagens::arango::StreamCursor* cursor = nullptr;
+
+  try {
+    cursor = new triagens::arango::StreamCursor(_vocbase, id, query, queryString, batchSize, ttl);
+  }
+  catch (...) {
+    delete query;
+    if (queryString != nullptr) {
+      TRI_FreeString(TRI_UNKNOWN_MEM_ZONE, queryString);
+    }
+    throw;
+  }
+
+  cursor->use();
+
+  try {
+    MUTEX_LOCKER(_lock);
+    _cursors.emplace(std::make_pair(id, cursor));
+    return cursor;
+  }
+  catch (...) {
+    delete cursor;
+    throw;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief remove a cursor by id
 ////////////////////////////////////////////////////////////////////////////////
@@ -95,6 +95,18 @@ namespace triagens {
                                         double, 
                                         bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a cursor from a query and stores it in the registry
+/// the cursor will be returned with the usage flag set to true. it must be
+/// returned later using release() 
+/// the cursor will take ownership of both the query and the query string
+////////////////////////////////////////////////////////////////////////////////
+
+        StreamCursor* createFromQuery (triagens::aql::Query*,
+                                       char*,
+                                       size_t,
+                                       double);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief remove a cursor by id
 ////////////////////////////////////////////////////////////////////////////////
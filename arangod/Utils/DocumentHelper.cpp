@@ -29,9 +29,13 @@
 
 #include "DocumentHelper.h"
 
+#include "Basics/conversions.h"
 #include "Basics/json.h"
+#include "Basics/string-buffer.h"
 #include "Basics/StringUtils.h"
+#include "VocBase/document-collection.h"
 #include "VocBase/vocbase.h"
+#include "VocBase/voc-shaper.h"
 
 using namespace triagens::arango;
 using namespace triagens::basics;
@@ -136,6 +140,63 @@ int DocumentHelper::getKey (TRI_json_t const* json,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief print a document marker as JSON into a string buffer, including
+/// its system attributes
+////////////////////////////////////////////////////////////////////////////////
+
+bool DocumentHelper::stringifyDocument (TRI_string_buffer_t* buffer,
+                                        CollectionNameResolver const* resolver,
+                                        TRI_voc_cid_t cid,
+                                        TRI_df_marker_t const* marker,
+                                        TRI_shaper_t* shaper,
+                                        TRI_shaped_json_filter_t filter,
+                                        void* filterData) {
+  // _id, _key, _rev
+  char const* key = TRI_EXTRACT_MARKER_KEY(marker);
+  std::string id(resolver->getCollectionName(cid));
+  id.push_back('/');
+  id.append(key);
+
+  char rid[24];
+  TRI_StringUInt64InPlace(TRI_EXTRACT_MARKER_RID(marker), rid);
+
+  std::string from;
+  std::string to;
+
+  char const* attributes[10];
+  size_t n = 0;
+
+  attributes[n++] = TRI_VOC_ATTRIBUTE_ID;
+  attributes[n++] = id.c_str();
+  attributes[n++] = TRI_VOC_ATTRIBUTE_KEY;
+  attributes[n++] = key;
+  attributes[n++] = TRI_VOC_ATTRIBUTE_REV;
+  attributes[n++] = rid;
+
+  if (TRI_IS_EDGE_MARKER(marker)) {
+    // _from
+    from.append(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_FROM_CID(marker)));
+    from.push_back('/');
+    from.append(TRI_EXTRACT_MARKER_FROM_KEY(marker));
+
+    // _to
+    to.append(resolver->getCollectionNameCluster(TRI_EXTRACT_MARKER_TO_CID(marker)));
+    to.push_back('/');
+    to.append(TRI_EXTRACT_MARKER_TO_KEY(marker));
+
+    attributes[n++] = TRI_VOC_ATTRIBUTE_FROM;
+    attributes[n++] = from.c_str();
+    attributes[n++] = TRI_VOC_ATTRIBUTE_TO;
+    attributes[n++] = to.c_str();
+  }
+
+  TRI_shaped_json_t shaped;
+  TRI_EXTRACT_SHAPED_JSON_MARKER(shaped, marker);
+
+  return TRI_StringifyObjectShapedJson(shaper, buffer, &shaped, attributes, n / 2, filter, filterData);
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -31,10 +31,14 @@
 #define ARANGODB_UTILS_DOCUMENT_HELPER_H 1
 
 #include "Basics/Common.h"
+#include "ShapedJson/shaped-json.h"
 #include "Utils/CollectionNameResolver.h"
 #include "VocBase/voc-types.h"
 
+struct TRI_df_marker_s;
 struct TRI_json_t;
+struct TRI_shaper_s;
+struct TRI_string_buffer_s;
 
 namespace triagens {
   namespace arango {
@@ -93,6 +97,23 @@ namespace triagens {
         static int getKey (struct TRI_json_t const*,
                            TRI_voc_key_t*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief print a document marker as JSON into a string buffer, including
+/// its system attributes
+///
+/// the document is written directly from its shaped json, without creating
+/// an intermediate json. if a filter is given, only the attributes for which
+/// it returns true are printed
+////////////////////////////////////////////////////////////////////////////////
+
+        static bool stringifyDocument (struct TRI_string_buffer_s*,
+                                       triagens::arango::CollectionNameResolver const*,
+                                       TRI_voc_cid_t,
+                                       struct TRI_df_marker_s const*,
+                                       struct TRI_shaper_s*,
+                                       TRI_shaped_json_filter_t = nullptr,
+                                       void* = nullptr);
+
     };
   }
 }
@@ -0,0 +1,1197 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief in-memory keyspaces for user data
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2011-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "Utils/KeySpaces.h"
+#include "Basics/Exceptions.h"
+#include "Basics/fasthash.h"
+#include "Basics/hashes.h"
+#include "Basics/json.h"
+#include "Basics/json-utilities.h"
+#include "Basics/ReadLocker.h"
+#include "Basics/tri-strings.h"
+#include "Basics/WriteLocker.h"
+
+using namespace triagens::arango;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                            struct KeySpaceElement
+// -----------------------------------------------------------------------------
+
+namespace triagens {
+  namespace arango {
+
+    struct KeySpaceElement {
+      KeySpaceElement () = delete;
+
+      KeySpaceElement (char const* k,
+                       size_t length,
+                       TRI_json_t* json,
+                       double expires)
+        : key(nullptr),
+          json(json),
+          expires(expires) {
+
+        key = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, k, length);
+        if (key == nullptr) {
+          // the element owns the value, even if it cannot be created
+          if (json != nullptr) {
+            TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+          }
+          THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+        }
+      }
+
+      ~KeySpaceElement () {
+        if (key != nullptr) {
+          TRI_FreeString(TRI_UNKNOWN_MEM_ZONE, key);
+        }
+        if (json != nullptr) {
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+        }
+      }
+
+      void setValue (TRI_json_t* value) {
+        if (json != nullptr) {
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+          json = nullptr;
+        }
+        json = value;
+      }
+
+      bool isExpired (double now) const {
+        return (expires > 0.0 && expires <= now);
+      }
+
+      bool isExpired () const {
+        return (expires > 0.0 && expires <= TRI_microtime());
+      }
+
+      char*        key;
+      TRI_json_t*  json;
+      double       expires;
+    };
+
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hashes an element
+////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t HashElement (TRI_associative_pointer_t*,
+                             void const* element) {
+  return TRI_FnvHashString(static_cast<KeySpaceElement const*>(element)->key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compares a key and an element
+////////////////////////////////////////////////////////////////////////////////
+
+static bool EqualKeyElement (TRI_associative_pointer_t*,
+                             void const* key,
+                             void const* element) {
+  return TRI_EqualString(static_cast<char const*>(key), static_cast<KeySpaceElement const*>(element)->key);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts a time-to-live into an expiry timestamp, 0 means never
+////////////////////////////////////////////////////////////////////////////////
+
+static double ExpiryTime (double ttl) {
+  if (ttl > 0.0) {
+    return TRI_microtime() + ttl;
+  }
+  return 0.0;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    class KeySpace
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+KeySpace::KeySpace (uint32_t initialSize) {
+  size_t i = 0;
+
+  for (; i < NumberOfStripes; ++i) {
+    auto& stripe = _stripes[i];
+
+    stripe._expiring   = 0;
+    stripe._nextExpiry = 0.0;
+
+    if (TRI_InitAssociativePointer(&stripe._hash,
+                                   TRI_UNKNOWN_MEM_ZONE,
+                                   TRI_HashStringKeyAssociativePointer,
+                                   HashElement,
+                                   EqualKeyElement,
+                                   nullptr) != TRI_ERROR_NO_ERROR) {
+      break;
+    }
+
+    if (initialSize > 0) {
+      TRI_ReserveAssociativePointer(&stripe._hash, static_cast<int32_t>(initialSize / NumberOfStripes + 1));
+    }
+  }
+
+  if (i < NumberOfStripes) {
+    while (i > 0) {
+      TRI_DestroyAssociativePointer(&_stripes[--i]._hash);
+    }
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+KeySpace::~KeySpace () {
+  for (auto& stripe : _stripes) {
+    uint32_t const n = stripe._hash._nrAlloc;
+
+    for (uint32_t i = 0; i < n; ++i) {
+      auto element = static_cast<KeySpaceElement*>(stripe._hash._table[i]);
+
+      if (element != nullptr) {
+        delete element;
+      }
+    }
+    TRI_DestroyAssociativePointer(&stripe._hash);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of keys, optionally restricted to a prefix
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t KeySpace::count (char const* prefix) {
+  double const now = TRI_microtime();
+  uint32_t count = 0;
+
+  for (auto& stripe : _stripes) {
+    READ_LOCKER(stripe._lock);
+
+    if (prefix == nullptr && stripe._expiring == 0) {
+      count += stripe._hash._nrUsed;
+      continue;
+    }
+
+    uint32_t const n = stripe._hash._nrAlloc;
+
+    for (uint32_t i = 0; i < n; ++i) {
+      auto element = static_cast<KeySpaceElement*>(stripe._hash._table[i]);
+
+      if (element != nullptr &&
+          ! element->isExpired(now) &&
+          (prefix == nullptr || TRI_IsPrefixString(element->key, prefix))) {
+        ++count;
+      }
+    }
+  }
+
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all keys, optionally restricted to a prefix
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t KeySpace::remove (char const* prefix) {
+  double const now = TRI_microtime();
+  uint32_t deleted = 0;
+
+  for (auto& stripe : _stripes) {
+    WRITE_LOCKER(stripe._lock);
+
+    uint32_t const n = stripe._hash._nrAlloc;
+
+    if (prefix == nullptr) {
+      for (uint32_t i = 0; i < n; ++i) {
+        auto element = static_cast<KeySpaceElement*>(stripe._hash._table[i]);
+
+        if (element != nullptr) {
+          if (! element->isExpired(now)) {
+            ++deleted;
+          }
+          delete element;
+          stripe._hash._table[i] = nullptr;
+        }
+      }
+      stripe._hash._nrUsed = 0;
+      stripe._expiring     = 0;
+      stripe._nextExpiry   = 0.0;
+      continue;
+    }
+
+    uint32_t i = 0;
+
+    while (i < n) {
+      auto element = static_cast<KeySpaceElement*>(stripe._hash._table[i]);
+
+      if (element != nullptr && TRI_IsPrefixString(element->key, prefix)) {
+        if (! element->isExpired(now)) {
+          ++deleted;
+        }
+        // removing moves the following elements up, so look at this slot again
+        erase(stripe, element);
+        continue;
+      }
+      ++i;
+    }
+  }
+
+  return deleted;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all keys, optionally restricted to a prefix
+////////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> KeySpace::keys (char const* prefix) {
+  double const now = TRI_microtime();
+  std::vector<std::string> result;
+
+  for (auto& stripe : _stripes) {
+    READ_LOCKER(stripe._lock);
+
+    uint32_t const n = stripe._hash._nrAlloc;
+
+    for (uint32_t i = 0; i < n; ++i) {
+      auto element = static_cast<KeySpaceElement*>(stripe._hash._table[i]);
+
+      if (element != nullptr &&
+          ! element->isExpired(now) &&
+          (prefix == nullptr || TRI_IsPrefixString(element->key, prefix))) {
+        result.emplace_back(element->key);
+      }
+    }
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all keys and values, optionally restricted to a prefix
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* KeySpace::get (char const* prefix) {
+  TRI_json_t* result = TRI_CreateObjectJson(TRI_UNKNOWN_MEM_ZONE);
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  double const now = TRI_microtime();
+
+  for (auto& stripe : _stripes) {
+    READ_LOCKER(stripe._lock);
+
+    uint32_t const n = stripe._hash._nrAlloc;
+
+    for (uint32_t i = 0; i < n; ++i) {
+      auto element = static_cast<KeySpaceElement*>(stripe._hash._table[i]);
+
+      if (element != nullptr &&
+          ! element->isExpired(now) &&
+          (prefix == nullptr || TRI_IsPrefixString(element->key, prefix))) {
+        TRI_Insert3ObjectJson(TRI_UNKNOWN_MEM_ZONE, result, element->key, TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, element->json));
+      }
+    }
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all expired keys
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t KeySpace::expire (double now) {
+  uint32_t expired = 0;
+
+  for (auto& stripe : _stripes) {
+    {
+      READ_LOCKER(stripe._lock);
+
+      if (stripe._expiring == 0 || stripe._nextExpiry > now) {
+        // nothing can have expired in this stripe
+        continue;
+      }
+    }
+
+    WRITE_LOCKER(stripe._lock);
+
+    uint32_t const n = stripe._hash._nrAlloc;
+    uint32_t i = 0;
+    double nextExpiry = 0.0;
+
+    while (i < n) {
+      auto element = static_cast<KeySpaceElement*>(stripe._hash._table[i]);
+
+      if (element != nullptr && element->expires > 0.0) {
+        if (element->isExpired(now)) {
+          // removing moves the following elements up, so look at this slot again
+          erase(stripe, element);
+          ++expired;
+          continue;
+        }
+
+        if (nextExpiry == 0.0 || element->expires < nextExpiry) {
+          nextExpiry = element->expires;
+        }
+      }
+      ++i;
+    }
+
+    stripe._nextExpiry = nextExpiry;
+  }
+
+  return expired;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a copy of the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_json_t* KeySpace::keyGet (std::string const& key) {
+  auto& stripe = this->stripe(key);
+  READ_LOCKER(stripe._lock);
+
+  auto found = lookup(stripe, key);
+
+  if (found == nullptr) {
+    return nullptr;
+  }
+
+  TRI_json_t* result = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, found->json);
+
+  if (result == nullptr) {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns whether a key exists
+////////////////////////////////////////////////////////////////////////////////
+
+bool KeySpace::keyExists (std::string const& key) {
+  auto& stripe = this->stripe(key);
+  READ_LOCKER(stripe._lock);
+
+  return (lookup(stripe, key) != nullptr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the type name of the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+char const* KeySpace::keyType (std::string const& key) {
+  auto& stripe = this->stripe(key);
+  READ_LOCKER(stripe._lock);
+
+  auto found = lookup(stripe, key);
+
+  if (found != nullptr) {
+    switch (found->json->_type) {
+      case TRI_JSON_NULL:
+        return "null";
+      case TRI_JSON_BOOLEAN:
+        return "boolean";
+      case TRI_JSON_NUMBER:
+        return "number";
+      case TRI_JSON_STRING:
+      case TRI_JSON_STRING_REFERENCE:
+        return "string";
+      case TRI_JSON_ARRAY:
+        return "list";
+      case TRI_JSON_OBJECT:
+        return "object";
+      case TRI_JSON_UNUSED:
+        break;
+    }
+  }
+
+  return "undefined";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of members of a list or object value
+////////////////////////////////////////////////////////////////////////////////
+
+bool KeySpace::keyCount (std::string const& key,
+                         uint32_t& result) {
+  auto& stripe = this->stripe(key);
+  READ_LOCKER(stripe._lock);
+
+  auto found = lookup(stripe, key);
+
+  if (found != nullptr) {
+    TRI_json_t const* value = found->json;
+
+    if (TRI_IsArrayJson(value)) {
+      result = static_cast<uint32_t>(TRI_LengthVector(&value->_value._objects));
+      return true;
+    }
+    if (TRI_IsObjectJson(value)) {
+      result = static_cast<uint32_t>(TRI_LengthVector(&value->_value._objects) / 2);
+      return true;
+    }
+  }
+
+  result = 0;
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a copy of a list member
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keyGetAt (std::string const& key,
+                        int64_t index,
+                        TRI_json_t*& result) {
+  result = nullptr;
+
+  auto& stripe = this->stripe(key);
+  READ_LOCKER(stripe._lock);
+
+  auto found = lookup(stripe, key);
+
+  if (found == nullptr) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  if (! TRI_IsArrayJson(found->json)) {
+    return TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+
+  size_t const n = found->json->_value._objects._length;
+
+  if (index < 0) {
+    index = static_cast<int64_t>(n) + index;
+  }
+
+  if (index < 0 || index >= static_cast<int64_t>(n)) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  auto item = static_cast<TRI_json_t const*>(TRI_AtVector(&found->json->_value._objects, static_cast<size_t>(index)));
+  result = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, item);
+
+  if (result == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+bool KeySpace::keySet (std::string const& key,
+                       TRI_json_t* value,
+                       bool replace,
+                       double ttl) {
+  TRI_ASSERT(value != nullptr);
+
+  // build the element outside the lock
+  std::unique_ptr<KeySpaceElement> element(new KeySpaceElement(key.c_str(), key.size(), value, ExpiryTime(ttl)));
+  auto& stripe = this->stripe(key);
+
+  {
+    WRITE_LOCKER(stripe._lock);
+
+    auto found = lookupForWrite(stripe, key);
+
+    if (found == nullptr) {
+      int res = insert(stripe, element.release());
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        THROW_ARANGO_EXCEPTION(res);
+      }
+      return true;
+    }
+
+    if (! replace) {
+      return false;
+    }
+
+    // the old value is freed with the element, outside the lock
+    std::swap(found->json, element->json);
+    untrack(stripe, found);
+    found->expires = element->expires;
+    track(stripe, found);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief conditionally sets the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keyCas (std::string const& key,
+                      TRI_json_t* value,
+                      TRI_json_t const* compare,
+                      bool& match) {
+  TRI_ASSERT(value != nullptr);
+
+  std::unique_ptr<KeySpaceElement> element(new KeySpaceElement(key.c_str(), key.size(), value, 0.0));
+  auto& stripe = this->stripe(key);
+
+  WRITE_LOCKER(stripe._lock);
+
+  auto found = lookupForWrite(stripe, key);
+
+  if (compare == nullptr) {
+    // the key must not exist yet
+    match = (found == nullptr);
+
+    if (match) {
+      return insert(stripe, element.release());
+    }
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  match = (found != nullptr && TRI_CompareValuesJson(found->json, compare) == 0);
+
+  if (match) {
+    // a key keeps its expiry time
+    std::swap(found->json, element->json);
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes a key
+////////////////////////////////////////////////////////////////////////////////
+
+bool KeySpace::keyRemove (std::string const& key) {
+  auto& stripe = this->stripe(key);
+  WRITE_LOCKER(stripe._lock);
+
+  auto found = lookupForWrite(stripe, key);
+
+  if (found == nullptr) {
+    return false;
+  }
+
+  erase(stripe, found);
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief increments a numeric value
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keyIncr (std::string const& key,
+                       double value,
+                       double ttl,
+                       double& result) {
+  auto& stripe = this->stripe(key);
+  WRITE_LOCKER(stripe._lock);
+
+  auto found = lookupForWrite(stripe, key);
+
+  if (found == nullptr) {
+    TRI_json_t* json = TRI_CreateNumberJson(TRI_UNKNOWN_MEM_ZONE, value);
+
+    if (json == nullptr) {
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+
+    int res = insert(stripe, new KeySpaceElement(key.c_str(), key.size(), json, ExpiryTime(ttl)));
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+
+    result = value;
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  TRI_json_t* current = found->json;
+
+  if (! TRI_IsNumberJson(current)) {
+    return TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+
+  result = current->_value._number += value;
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends a value to a list
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keyPush (std::string const& key,
+                       TRI_json_t* value) {
+  TRI_ASSERT(value != nullptr);
+
+  auto& stripe = this->stripe(key);
+  WRITE_LOCKER(stripe._lock);
+
+  auto found = lookupForWrite(stripe, key);
+
+  if (found == nullptr) {
+    TRI_json_t* list = TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 1);
+
+    if (list == nullptr) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+
+    if (TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, list, value) != TRI_ERROR_NO_ERROR) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, list);
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+
+    return insert(stripe, new KeySpaceElement(key.c_str(), key.size(), list, 0.0));
+  }
+
+  TRI_json_t* current = found->json;
+
+  if (! TRI_IsArrayJson(current)) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+    return TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+
+  if (TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, current, value) != TRI_ERROR_NO_ERROR) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes the last member of a list and returns it
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keyPop (std::string const& key,
+                      TRI_json_t*& result) {
+  result = nullptr;
+
+  auto& stripe = this->stripe(key);
+  WRITE_LOCKER(stripe._lock);
+
+  auto found = lookupForWrite(stripe, key);
+
+  if (found == nullptr) {
+    return TRI_ERROR_KEYVALUE_KEY_NOT_FOUND;
+  }
+
+  TRI_json_t* current = found->json;
+
+  if (! TRI_IsArrayJson(current)) {
+    return TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+
+  size_t const n = TRI_LengthVector(&current->_value._objects);
+
+  if (n == 0) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  result = static_cast<TRI_json_t*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, sizeof(TRI_json_t), false));
+
+  if (result == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  // move the member out of the list without copying its contents
+  *result = *static_cast<TRI_json_t*>(TRI_AtVector(&current->_value._objects, n - 1));
+  --current->_value._objects._length;
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief moves the last member of a list to another list
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keyTransfer (std::string const& keyFrom,
+                           std::string const& keyTo,
+                           TRI_json_t*& result) {
+  result = nullptr;
+
+  auto& source = stripe(keyFrom);
+  auto& dest   = stripe(keyTo);
+
+  if (&source == &dest) {
+    WRITE_LOCKER(source._lock);
+    return transfer(source, dest, keyFrom, keyTo, result);
+  }
+
+  // always lock the stripes in the same order
+  auto& first  = (&source < &dest) ? source : dest;
+  auto& second = (&source < &dest) ? dest : source;
+
+  WRITE_LOCKER(first._lock);
+  WRITE_LOCKER(second._lock);
+
+  return transfer(source, dest, keyFrom, keyTo, result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets a list member
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keySetAt (std::string const& key,
+                        int64_t index,
+                        TRI_json_t* value) {
+  TRI_ASSERT(value != nullptr);
+
+  auto& stripe = this->stripe(key);
+  WRITE_LOCKER(stripe._lock);
+
+  auto found = lookupForWrite(stripe, key);
+  int res = TRI_ERROR_NO_ERROR;
+
+  if (found == nullptr) {
+    res = TRI_ERROR_KEYVALUE_KEY_NOT_FOUND;
+  }
+  else if (! TRI_IsArrayJson(found->json)) {
+    res = TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+  else if (index < 0) {
+    res = TRI_ERROR_BAD_PARAMETER;
+  }
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+    return res;
+  }
+
+  TRI_vector_t* objects = &found->json->_value._objects;
+
+  if (index < static_cast<int64_t>(objects->_length)) {
+    // overwrite existing member
+    auto item = static_cast<TRI_json_t*>(TRI_AtVector(objects, static_cast<size_t>(index)));
+    TRI_DestroyJson(TRI_UNKNOWN_MEM_ZONE, item);
+    TRI_SetVector(objects, static_cast<size_t>(index), value);
+    // only free the pointer, the contents now belong to the list
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, value);
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  // fill the gap up to the new member with nulls
+  while (static_cast<int64_t>(objects->_length) < index) {
+    TRI_json_t null;
+    TRI_InitNullJson(&null);
+
+    if (TRI_PushBack2ArrayJson(found->json, &null) != TRI_ERROR_NO_ERROR) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+  }
+
+  if (TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, found->json, value) != TRI_ERROR_NO_ERROR) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief merges an object into an object value
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::keyMerge (std::string const& key,
+                        TRI_json_t* value,
+                        bool nullMeansRemove,
+                        TRI_json_t*& result) {
+  TRI_ASSERT(value != nullptr);
+  result = nullptr;
+
+  if (! TRI_IsObjectJson(value)) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+    return TRI_ERROR_TYPE_ERROR;
+  }
+
+  auto& stripe = this->stripe(key);
+  WRITE_LOCKER(stripe._lock);
+
+  auto found = lookupForWrite(stripe, key);
+
+  if (found == nullptr) {
+    result = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, value);
+
+    if (result == nullptr) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+
+    return insert(stripe, new KeySpaceElement(key.c_str(), key.size(), value, 0.0));
+  }
+
+  if (! TRI_IsObjectJson(found->json)) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+    return TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+
+  TRI_json_t* merged = TRI_MergeJson(TRI_UNKNOWN_MEM_ZONE, found->json, value, nullMeansRemove, false);
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, value);
+
+  if (merged == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  result = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, merged);
+  found->setValue(merged);
+
+  if (result == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the stripe responsible for a key
+////////////////////////////////////////////////////////////////////////////////
+
+KeySpace::Stripe& KeySpace::stripe (std::string const& key) {
+  // use another hash function than the tables do, so the keys of a stripe
+  // are still spread over its whole table
+  return _stripes[fasthash64(key.c_str(), key.size(), 0xdeadbeef) % NumberOfStripes];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up a key that has not expired
+////////////////////////////////////////////////////////////////////////////////
+
+KeySpaceElement* KeySpace::lookup (Stripe& stripe,
+                                   std::string const& key) const {
+  auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&stripe._hash, key.c_str()));
+
+  if (found == nullptr || found->isExpired()) {
+    return nullptr;
+  }
+
+  return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up a key for writing, removing it if it has expired
+////////////////////////////////////////////////////////////////////////////////
+
+KeySpaceElement* KeySpace::lookupForWrite (Stripe& stripe,
+                                           std::string const& key) {
+  auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&stripe._hash, key.c_str()));
+
+  if (found != nullptr && found->isExpired()) {
+    erase(stripe, found);
+    return nullptr;
+  }
+
+  return found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inserts a new element
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::insert (Stripe& stripe,
+                      KeySpaceElement* element) {
+  if (TRI_InsertKeyAssociativePointer(&stripe._hash, element->key, element, false) != nullptr) {
+    // the caller has checked that the key does not exist
+    delete element;
+    return TRI_ERROR_INTERNAL;
+  }
+
+  track(stripe, element);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes and frees an element
+////////////////////////////////////////////////////////////////////////////////
+
+void KeySpace::erase (Stripe& stripe,
+                      KeySpaceElement* element) {
+  TRI_RemoveKeyAssociativePointer(&stripe._hash, element->key);
+  untrack(stripe, element);
+
+  delete element;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief registers the expiry time of an element with its stripe
+////////////////////////////////////////////////////////////////////////////////
+
+void KeySpace::track (Stripe& stripe,
+                      KeySpaceElement const* element) {
+  if (element->expires > 0.0) {
+    ++stripe._expiring;
+
+    if (stripe._nextExpiry == 0.0 || element->expires < stripe._nextExpiry) {
+      stripe._nextExpiry = element->expires;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief unregisters the expiry time of an element from its stripe
+////////////////////////////////////////////////////////////////////////////////
+
+void KeySpace::untrack (Stripe& stripe,
+                        KeySpaceElement const* element) {
+  if (element->expires > 0.0) {
+    TRI_ASSERT(stripe._expiring > 0);
+    --stripe._expiring;
+    // _nextExpiry stays a lower bound, the next sweep will correct it
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief moves the last list member between two locked stripes
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpace::transfer (Stripe& sourceStripe,
+                        Stripe& destStripe,
+                        std::string const& keyFrom,
+                        std::string const& keyTo,
+                        TRI_json_t*& result) {
+  auto source = lookupForWrite(sourceStripe, keyFrom);
+
+  if (source == nullptr) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  TRI_json_t* current = source->json;
+
+  if (! TRI_IsArrayJson(current)) {
+    return TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+
+  size_t const n = TRI_LengthVector(&current->_value._objects);
+
+  if (n == 0) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  auto item = static_cast<TRI_json_t*>(TRI_AtVector(&current->_value._objects, n - 1));
+  auto dest = lookupForWrite(destStripe, keyTo);
+
+  if (dest != nullptr && ! TRI_IsArrayJson(dest->json)) {
+    return TRI_ERROR_KEYVALUE_TYPE_MISMATCH;
+  }
+
+  TRI_json_t* copy = TRI_CopyJson(TRI_UNKNOWN_MEM_ZONE, item);
+
+  if (copy == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  if (dest == source) {
+    // moving the last member to the end of its own list changes nothing
+    result = copy;
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  if (dest == nullptr) {
+    TRI_json_t* list = TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 1);
+
+    if (list == nullptr) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, copy);
+      return TRI_ERROR_OUT_OF_MEMORY;
+    }
+
+    dest = new KeySpaceElement(keyTo.c_str(), keyTo.size(), list, 0.0);
+    int res = insert(destStripe, dest);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, copy);
+      return res;
+    }
+  }
+
+  // move the member, its contents belong to the destination list from now on
+  if (TRI_PushBack2ArrayJson(dest->json, item) != TRI_ERROR_NO_ERROR) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, copy);
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  --current->_value._objects._length;
+  result = copy;
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   class KeySpaces
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the keyspaces registry
+////////////////////////////////////////////////////////////////////////////////
+
+KeySpaces::KeySpaces ()
+  : _lock(),
+    _keySpaces() {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the keyspaces registry
+////////////////////////////////////////////////////////////////////////////////
+
+KeySpaces::~KeySpaces () {
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpaces::create (std::string const& name,
+                       uint32_t size,
+                       bool ignoreExisting) {
+  // allocate the keyspace outside the lock
+  auto keySpace = std::make_shared<KeySpace>(size);
+
+  WRITE_LOCKER(_lock);
+
+  if (_keySpaces.find(name) != _keySpaces.end()) {
+    if (ignoreExisting) {
+      return TRI_ERROR_NO_ERROR;
+    }
+    return TRI_ERROR_KEYVALUE_KEYSPACE_EXISTS;
+  }
+
+  _keySpaces.emplace(name, keySpace);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief drops a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+int KeySpaces::drop (std::string const& name) {
+  std::shared_ptr<KeySpace> keySpace;
+
+  {
+    WRITE_LOCKER(_lock);
+
+    auto it = _keySpaces.find(name);
+
+    if (it == _keySpaces.end()) {
+      return TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND;
+    }
+
+    keySpace = (*it).second;
+    _keySpaces.erase(it);
+  }
+
+  // the keyspace is freed outside the lock, or by the last operation still
+  // using it
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<KeySpace> KeySpaces::get (std::string const& name) {
+  READ_LOCKER(_lock);
+
+  auto it = _keySpaces.find(name);
+
+  if (it == _keySpaces.end()) {
+    return nullptr;
+  }
+
+  return (*it).second;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes the expired keys from all keyspaces
+////////////////////////////////////////////////////////////////////////////////
+
+uint32_t KeySpaces::expire () {
+  std::vector<std::shared_ptr<KeySpace>> keySpaces;
+
+  {
+    READ_LOCKER(_lock);
+
+    keySpaces.reserve(_keySpaces.size());
+
+    for (auto const& it : _keySpaces) {
+      keySpaces.emplace_back(it.second);
+    }
+  }
+
+  double const now = TRI_microtime();
+  uint32_t expired = 0;
+
+  for (auto& keySpace : keySpaces) {
+    expired += keySpace->expire(now);
+  }
+
+  return expired;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
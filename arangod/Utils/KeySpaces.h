@@ -0,0 +1,436 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief in-memory keyspaces for user data
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2011-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_UTILS_KEY_SPACES_H
+#define ARANGODB_UTILS_KEY_SPACES_H 1
+
+#include "Basics/Common.h"
+#include "Basics/associative.h"
+#include "Basics/ReadWriteLock.h"
+
+struct TRI_json_t;
+
+namespace triagens {
+  namespace arango {
+
+    struct KeySpaceElement;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    class KeySpace
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a keyspace, mapping string keys to JSON values
+///
+/// the keys are distributed over a fixed number of stripes, each with its own
+/// lock and hash table, so operations on different keys rarely contend. keys
+/// can have a time-to-live. expired keys are invisible immediately and are
+/// physically removed by the next write to their stripe or by expire().
+///
+/// all values handed into a keyspace are owned by it afterwards, even if the
+/// operation fails. values handed out are copies owned by the caller.
+////////////////////////////////////////////////////////////////////////////////
+
+    class KeySpace {
+
+      private:
+
+        KeySpace (KeySpace const&) = delete;
+        KeySpace& operator= (KeySpace const&) = delete;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a part of the keyspace with its own lock
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Stripe {
+          triagens::basics::ReadWriteLock  _lock;
+          TRI_associative_pointer_t        _hash;
+          uint32_t                         _expiring;
+          double                           _nextExpiry;
+        };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a keyspace, reserving room for the given number of keys
+////////////////////////////////////////////////////////////////////////////////
+
+        explicit KeySpace (uint32_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+        ~KeySpace ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of keys, optionally restricted to a prefix
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t count (char const* = nullptr);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all keys, optionally restricted to a prefix, and returns
+/// the number of keys removed
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t remove (char const* = nullptr);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all keys, optionally restricted to a prefix
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::string> keys (char const* = nullptr);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all keys and values as a JSON object, optionally restricted
+/// to a prefix
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t* get (char const* = nullptr);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all expired keys and returns their number
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t expire (double);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a copy of the value of a key, or a nullptr if the key does
+/// not exist
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_json_t* keyGet (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns whether a key exists
+////////////////////////////////////////////////////////////////////////////////
+
+        bool keyExists (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the type name of the value of a key
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* keyType (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of members of a list or object value
+////////////////////////////////////////////////////////////////////////////////
+
+        bool keyCount (std::string const&,
+                       uint32_t&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a copy of a list member, negative positions count from the
+/// end. the result is a nullptr if the key or position does not exist
+////////////////////////////////////////////////////////////////////////////////
+
+        int keyGetAt (std::string const&,
+                      int64_t,
+                      TRI_json_t*&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the value of a key, with a time-to-live in seconds if positive
+/// returns false if the key exists and replace is not set
+////////////////////////////////////////////////////////////////////////////////
+
+        bool keySet (std::string const&,
+                     TRI_json_t*,
+                     bool,
+                     double);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the value of a key if its current value equals the compare
+/// value. a nullptr compare value means that the key must not exist
+////////////////////////////////////////////////////////////////////////////////
+
+        int keyCas (std::string const&,
+                    TRI_json_t*,
+                    TRI_json_t const*,
+                    bool&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes a key, returns false if it did not exist
+////////////////////////////////////////////////////////////////////////////////
+
+        bool keyRemove (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief increments a numeric value. a key that does not exist is created,
+/// using the time-to-live in seconds if positive
+////////////////////////////////////////////////////////////////////////////////
+
+        int keyIncr (std::string const&,
+                     double,
+                     double,
+                     double&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends a value to a list, creating the list if required
+////////////////////////////////////////////////////////////////////////////////
+
+        int keyPush (std::string const&,
+                     TRI_json_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes the last member of a list and returns it. the result is a
+/// nullptr if the list is empty
+////////////////////////////////////////////////////////////////////////////////
+
+        int keyPop (std::string const&,
+                    TRI_json_t*&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief moves the last member of a list to the end of another list and
+/// returns a copy of it
+////////////////////////////////////////////////////////////////////////////////
+
+        int keyTransfer (std::string const&,
+                         std::string const&,
+                         TRI_json_t*&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets a list member
+////////////////////////////////////////////////////////////////////////////////
+
+        int keySetAt (std::string const&,
+                      int64_t,
+                      TRI_json_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief merges an object into an object value and returns a copy of the
+/// result
+////////////////////////////////////////////////////////////////////////////////
+
+        int keyMerge (std::string const&,
+                      TRI_json_t*,
+                      bool,
+                      TRI_json_t*&);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the stripe responsible for a key
+////////////////////////////////////////////////////////////////////////////////
+
+        Stripe& stripe (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up a key that has not expired, the stripe must be locked
+////////////////////////////////////////////////////////////////////////////////
+
+        KeySpaceElement* lookup (Stripe&,
+                                 std::string const&) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up a key for writing, the stripe must be write-locked. an
+/// expired key is removed
+////////////////////////////////////////////////////////////////////////////////
+
+        KeySpaceElement* lookupForWrite (Stripe&,
+                                         std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief inserts a new element, the stripe must be write-locked. the element
+/// is freed on failure
+////////////////////////////////////////////////////////////////////////////////
+
+        int insert (Stripe&,
+                    KeySpaceElement*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes and frees an element, the stripe must be write-locked
+////////////////////////////////////////////////////////////////////////////////
+
+        void erase (Stripe&,
+                    KeySpaceElement*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief registers the expiry time of an element with its stripe
+////////////////////////////////////////////////////////////////////////////////
+
+        void track (Stripe&,
+                    KeySpaceElement const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief unregisters the expiry time of an element from its stripe
+////////////////////////////////////////////////////////////////////////////////
+
+        void untrack (Stripe&,
+                      KeySpaceElement const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief moves the last list member between two locked stripes
+////////////////////////////////////////////////////////////////////////////////
+
+        int transfer (Stripe&,
+                      Stripe&,
+                      std::string const&,
+                      std::string const&,
+                      TRI_json_t*&);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of stripes
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const NumberOfStripes = 64;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the stripes
+////////////////////////////////////////////////////////////////////////////////
+
+        Stripe _stripes[NumberOfStripes];
+
+    };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   class KeySpaces
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the keyspaces of a database
+////////////////////////////////////////////////////////////////////////////////
+
+    class KeySpaces {
+
+      private:
+
+        KeySpaces (KeySpaces const&) = delete;
+        KeySpaces& operator= (KeySpaces const&) = delete;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create the keyspaces registry
+////////////////////////////////////////////////////////////////////////////////
+
+        KeySpaces ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the keyspaces registry
+////////////////////////////////////////////////////////////////////////////////
+
+        ~KeySpaces ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a keyspace
+////////////////////////////////////////////////////////////////////////////////
+
+        int create (std::string const&,
+                    uint32_t,
+                    bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief drops a keyspace. operations still running on it can finish
+////////////////////////////////////////////////////////////////////////////////
+
+        int drop (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a keyspace, or a nullptr if it does not exist
+////////////////////////////////////////////////////////////////////////////////
+
+        std::shared_ptr<KeySpace> get (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes the expired keys from all keyspaces
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t expire ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lock for the keyspaces
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ReadWriteLock _lock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief keyspaces, by name
+////////////////////////////////////////////////////////////////////////////////
+
+        std::unordered_map<std::string, std::shared_ptr<KeySpace>> _keySpaces;
+
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
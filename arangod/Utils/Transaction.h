@@ -32,6 +32,8 @@
 
 #include "Basics/Common.h"
 
+#include <functional>
+
 #include "Cluster/ServerState.h"
 
 #include "Basics/Exceptions.h"
@@ -443,6 +445,68 @@ namespace triagens {
           return TRI_ERROR_NO_ERROR;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief read-lock a collection and pass the next slots of its primary index
+/// to a callback, starting at an internal offset into the primary index. the
+/// callback may hand out parts of the slots to other threads, as long as it
+/// waits for them before it returns. the callback is not called if there are
+/// no more slots
+////////////////////////////////////////////////////////////////////////////////
+
+        int readSlots (TRI_transaction_collection_t* trxCollection,
+                       TRI_voc_size_t& internalSkip,
+                       TRI_voc_size_t numSlots,
+                       std::function<void(void* const*, void* const*)> const& callback,
+                       uint32_t* total) {
+
+          TRI_document_collection_t* document = documentCollection(trxCollection);
+
+          // READ-LOCK START
+          int res = this->lock(trxCollection, TRI_TRANSACTION_READ);
+
+          if (res != TRI_ERROR_NO_ERROR) {
+            return res;
+          }
+
+          *total = (uint32_t) document->_primaryIndex._nrUsed;
+
+          if (document->_primaryIndex._nrUsed == 0 ||
+              internalSkip >= document->_primaryIndex._nrAlloc) {
+            // nothing to do
+            this->unlock(trxCollection, TRI_TRANSACTION_READ);
+
+            // READ-LOCK END
+            return TRI_ERROR_NO_ERROR;
+          }
+
+          if (orderBarrier(trxCollection) == nullptr) {
+            this->unlock(trxCollection, TRI_TRANSACTION_READ);
+            return TRI_ERROR_OUT_OF_MEMORY;
+          }
+
+          void** beg = document->_primaryIndex._table + internalSkip;
+          void** end = document->_primaryIndex._table + document->_primaryIndex._nrAlloc;
+
+          if (static_cast<TRI_voc_size_t>(end - beg) > numSlots) {
+            end = beg + numSlots;
+          }
+
+          internalSkip += static_cast<TRI_voc_size_t>(end - beg);
+
+          try {
+            callback(beg, end);
+          }
+          catch (...) {
+            this->unlock(trxCollection, TRI_TRANSACTION_READ);
+            throw;
+          }
+
+          this->unlock(trxCollection, TRI_TRANSACTION_READ);
+          // READ-LOCK END
+
+          return TRI_ERROR_NO_ERROR;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief read all master pointers, using skip and limit and an internal
 /// offset into the primary index. this can be used for incremental access to
@@ -588,6 +652,106 @@ namespace triagens {
           return res;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create many documents, using JSON
+///
+/// the documents are inserted in a single operation of the storage engine.
+/// the result of each document is returned in results, in the order of the
+/// documents. edges contains the edge data for each document, and must be
+/// empty for document collections. with stopOnError, no document following
+/// the first failing document is inserted, and these documents get the error
+/// TRI_ERROR_REQUEST_CANCELED. if an error is returned, not all documents
+/// could be processed and the transaction must be aborted
+////////////////////////////////////////////////////////////////////////////////
+
+        int createMany (TRI_transaction_collection_t* trxCollection,
+                        std::vector<TRI_json_t const*> const& jsons,
+                        std::vector<TRI_document_edge_t const*> const& edges,
+                        std::vector<TRI_doc_bulk_operation_t>& results,
+                        bool forceSync,
+                        bool stopOnError) {
+
+          size_t const n = jsons.size();
+
+          TRI_ASSERT(edges.empty() || edges.size() == n);
+
+          TRI_shaper_t* shaper = this->shaper(trxCollection);
+          TRI_memory_zone_t* zone = shaper->_memoryZone;
+
+          std::vector<TRI_doc_bulk_operation_t> documents;
+          std::vector<TRI_shaped_json_t*> shapes;
+          std::vector<size_t> positions;
+
+          int res = TRI_ERROR_NO_ERROR;
+
+          try {
+            results.clear();
+            results.resize(n);
+            documents.reserve(n);
+            shapes.reserve(n);
+            positions.reserve(n);
+
+            for (size_t i = 0; i < n; ++i) {
+              TRI_voc_key_t key = 0;
+              int res2 = DocumentHelper::getKey(jsons[i], &key);
+              TRI_shaped_json_t* shaped = nullptr;
+
+              if (res2 == TRI_ERROR_NO_ERROR) {
+                shaped = TRI_ShapedJsonJson(shaper, jsons[i], true);
+
+                if (shaped == nullptr) {
+                  res2 = TRI_ERROR_ARANGO_SHAPER_FAILED;
+                }
+              }
+
+              if (res2 != TRI_ERROR_NO_ERROR) {
+                results[i].errorCode = res2;
+
+                if (stopOnError) {
+                  for (size_t j = i + 1; j < n; ++j) {
+                    results[j].errorCode = TRI_ERROR_REQUEST_CANCELED;
+                  }
+                  break;
+                }
+                continue;
+              }
+
+              shapes.push_back(shaped);
+
+              TRI_doc_bulk_operation_t document;
+              document.key    = key;
+              document.shaped = shaped;
+              document.edge   = edges.empty() ? nullptr : edges[i];
+
+              documents.push_back(document);
+              positions.push_back(i);
+            }
+
+            res = TRI_InsertShapedJsonDocumentsCollection(trxCollection,
+                                                          documents,
+                                                          ! isLocked(trxCollection, TRI_TRANSACTION_WRITE),
+                                                          forceSync,
+                                                          false,
+                                                          stopOnError);
+
+            for (size_t i = 0; i < documents.size(); ++i) {
+              results[positions[i]] = documents[i];
+            }
+          }
+          catch (triagens::basics::Exception const& ex) {
+            res = ex.code();
+          }
+          catch (...) {
+            res = TRI_ERROR_INTERNAL;
+          }
+
+          for (auto it : shapes) {
+            TRI_FreeShapedJson(zone, it);
+          }
+
+          return res;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief update a single document, using JSON
 ////////////////////////////////////////////////////////////////////////////////
@@ -1255,18 +1419,34 @@ namespace triagens {
           }
 
           try {
-            for (auto it = ids.begin(); it != ids.end(); ++it) {
-              res = TRI_RemoveShapedJsonDocumentCollection(trxCollection,
-                                                           (TRI_voc_key_t) (*it).c_str(),
-                                                           0,
-                                                           nullptr, // marker 
-                                                           nullptr, // policy
-                                                           false,
-                                                           forceSync);
-
-              if (res != TRI_ERROR_NO_ERROR) {
-                // halt on first error
-                break;
+            // remove the documents in batches, so the markers of a batch
+            // can be written into the logfiles at once
+            size_t const batchSize = 1000;
+            std::vector<TRI_doc_bulk_operation_t> documents;
+            documents.reserve((std::min)(ids.size(), batchSize));
+
+            for (size_t i = 0; i < ids.size() && res == TRI_ERROR_NO_ERROR; i += batchSize) {
+              size_t const end = (std::min)(ids.size(), i + batchSize);
+
+              documents.clear();
+
+              for (size_t j = i; j < end; ++j) {
+                TRI_doc_bulk_operation_t document;
+                document.key = (TRI_voc_key_t) ids[j].c_str();
+                documents.push_back(document);
+              }
+
+              res = TRI_RemoveShapedJsonDocumentsCollection(trxCollection,
+                                                            documents,
+                                                            false,
+                                                            forceSync);
+
+              for (auto const& it : documents) {
+                if (res != TRI_ERROR_NO_ERROR) {
+                  // halt on first error
+                  break;
+                }
+                res = it.errorCode;
               }
             }
           }
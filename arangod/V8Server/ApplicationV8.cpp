@@ -51,6 +51,7 @@
 #include "Rest/HttpRequest.h"
 #include "Scheduler/ApplicationScheduler.h"
 #include "Scheduler/Scheduler.h"
+#include "V8/JSCodeCache.h"
 #include "V8/v8-buffer.h"
 #include "V8/v8-conv.h"
 #include "V8/v8-shell.h"
@@ -290,6 +291,11 @@ ApplicationV8::ApplicationV8 (TRI_server_t* server,
     _gcInterval(1000),
     _gcFrequency(10.0),
     _v8Options(""),
+    _maxContexts(0),
+    _contextsGrowWait(0.1),
+    _contextsIdleTimeout(60.0),
+    _contextsMaxWait(0.0),
+    _useCodeCache(true),
     _startupLoader(),
     _vocbase(nullptr),
     _nrInstances(),
@@ -298,6 +304,14 @@ ApplicationV8::ApplicationV8 (TRI_server_t* server,
     _freeContexts(),
     _dirtyContexts(),
     _busyContexts(),
+    _nextContextId(0),
+    _contextsRequested(0),
+    _contextsCreated(0),
+    _contextsRemoved(0),
+    _contextTimeouts(0),
+    _coordinatorBootstrapped(false),
+    _contextWaitTimes(),
+    _gcTimes(),
     _stopping(0),
     _gcThread(nullptr),
     _scheduler(scheduler),
@@ -346,17 +360,83 @@ void ApplicationV8::setVocbase (TRI_vocbase_t* vocbase) {
 
 ApplicationV8::V8Context* ApplicationV8::enterContext (std::string const& name,
                                                        TRI_vocbase_s* vocbase,
-                                                       bool allowUseDatabase) {
+                                                       bool allowUseDatabase,
+                                                       bool limitWait) {
+  bool const isStandard = (name == DEFAULT_NAME);
+  double const maxWait = (limitWait ? _contextsMaxWait : 0.0);
+  double const start = TRI_microtime();
+
   CONDITION_LOCKER(guard, _contextCondition);
 
+  // whether or not we asked the garbage collection thread for another context
+  bool requested = false;
+
   while (_freeContexts[name].empty() && ! _stopping) {
+    if (! isStandard) {
+      LOG_DEBUG("waiting for unused V8 context");
+      guard.wait();
+      continue;
+    }
+
+    double const waited = TRI_microtime() - start;
+
+    if (maxWait > 0.0 && waited >= maxWait) {
+      // give up
+      break;
+    }
+
+    bool const canGrow = (_maxContexts > _nrInstances[DEFAULT_NAME]);
+
+    if (canGrow && ! requested && waited >= _contextsGrowWait) {
+      requested = true;
+      ++_contextsRequested;
+
+      // wake up the garbage collection thread
+      guard.broadcast();
+    }
+
+    // wake up in time to ask for another context or to give up
+    double timeout = 0.0;
+
+    if (canGrow && ! requested) {
+      timeout = _contextsGrowWait - waited;
+    }
+
+    if (maxWait > 0.0 && (timeout == 0.0 || maxWait - waited < timeout)) {
+      timeout = maxWait - waited;
+    }
+
     LOG_DEBUG("waiting for unused V8 context");
-    guard.wait();
+
+    if (timeout > 0.0) {
+      guard.wait(static_cast<uint64_t>(timeout * 1000000.0) + 1);
+    }
+    else {
+      guard.wait();
+    }
+  }
+
+  if (requested) {
+    --_contextsRequested;
   }
 
   // in case we are in the shutdown phase, do not enter a context!
   // the context might have been deleted by the shutdown
   if (_stopping) {
+    TRI_set_errno(TRI_ERROR_NO_ERROR);
+    return nullptr;
+  }
+
+  if (isStandard) {
+    _contextWaitTimes.addFigure(TRI_microtime() - start);
+  }
+
+  if (_freeContexts[name].empty()) {
+    // timeout
+    ++_contextTimeouts;
+    LOG_DEBUG("no V8 context became available within %f s", maxWait);
+
+    TRI_set_errno(TRI_ERROR_V8_CONTEXT_TIMEOUT);
     return nullptr;
   }
 
@@ -420,6 +500,7 @@ void ApplicationV8::exitContext (V8Context* context) {
   // update data for later garbage collection
   TRI_GET_GLOBALS();
   context->_hasDeadObjects = v8g->_hasDeadObjects;
+  context->_lastUseStamp = TRI_microtime();
   ++context->_numExecutions;
 
   // check for cancelation requests
@@ -520,6 +601,8 @@ void ApplicationV8::exitContext (V8Context* context) {
     if (performGarbageCollection) {
       guard.unlock();
 
+      double const gcStart = TRI_microtime();
+
       isolate->Enter();
       {
         v8::HandleScope scope(isolate);
@@ -536,6 +619,8 @@ void ApplicationV8::exitContext (V8Context* context) {
       }
       isolate->Exit();
 
+      _gcTimes.addFigure(TRI_microtime() - gcStart);
+
       guard.lock();
 
       context->_numExecutions = 0;
@@ -555,14 +640,19 @@ void ApplicationV8::exitContext (V8Context* context) {
 
 bool ApplicationV8::addGlobalContextMethod (string const& method) {
   bool result = true;
-  size_t nrInstances = _nrInstances[DEFAULT_NAME];
 
-  for (size_t i = 0; i < nrInstances; ++i) {
-    if (! _contexts[DEFAULT_NAME][i]->addGlobalContextMethod(method)) {
+  CONDITION_LOCKER(guard, _contextCondition);
+
+  for (auto context : _contexts[DEFAULT_NAME]) {
+    if (! context->addGlobalContextMethod(method)) {
       result = false;
     }
   }
 
+  if (GlobalContextMethods::getType(method) == GlobalContextMethods::TYPE_BOOTSTRAP_COORDINATOR) {
+    _coordinatorBootstrapped = true;
+  }
+
   return result;
 }
 
@@ -589,12 +679,14 @@ void ApplicationV8::collectGarbage () {
 
   while (_stopping == 0) {
     V8Context* context = nullptr;
+    V8Context* idleContext = nullptr;
+    bool grow = false;
 
     {
       bool gotSignal = false;
       CONDITION_LOCKER(guard, _contextCondition);
 
-      if (_dirtyContexts[DEFAULT_NAME].empty()) {
+      if (_dirtyContexts[DEFAULT_NAME].empty() && ! needsMoreContexts()) {
         uint64_t waitTime = useReducedWait ? reducedWaitTime : regularWaitTime;
 
         // we'll wait for a signal or a timeout
@@ -610,19 +702,39 @@ void ApplicationV8::collectGarbage () {
         _dirtyContexts[DEFAULT_NAME].pop_back();
         useReducedWait = false;
       }
+      else if (needsMoreContexts()) {
+        // threads have waited too long for a context
+        grow = true;
+      }
       else if (! gotSignal && ! _freeContexts[DEFAULT_NAME].empty()) {
         // we timed out waiting for a signal, so we have idle time that we can
-        // spend on running the GC pro-actively
-        // We'll pick one of the free contexts and clean it up
-        context = pickFreeContextForGc();
+        // spend on removing contexts that are no longer needed, or on running
+        // the GC pro-actively
+        idleContext = removeIdleContext();
+
+        if (idleContext == nullptr) {
+          // We'll pick one of the free contexts and clean it up
+          context = pickFreeContextForGc();
+        }
 
         // there is no context to clean up, probably they all have been cleaned up
         // already. increase the wait time so we don't cycle too much in the GC loop
         // and waste CPU unnecessary
-        useReducedWait = (context != nullptr);
+        useReducedWait = (context != nullptr || idleContext != nullptr);
       }
     }
 
+    if (grow) {
+      addContext();
+      continue;
+    }
+
+    if (idleContext != nullptr) {
+      LOG_DEBUG("removing unused V8 context #%d", (int) idleContext->_id);
+      shutdownV8Instance(idleContext);
+      continue;
+    }
+
     // update last gc time
     double lastGc = TRI_microtime();
     gc->updateGcStamp(lastGc);
@@ -653,6 +765,8 @@ void ApplicationV8::collectGarbage () {
       delete context->_locker;
       context->_locker = nullptr;
 
+      _gcTimes.addFigure(TRI_microtime() - lastGc);
+
       // update garbage collection statistics
       context->_hasDeadObjects = false;
       context->_numExecutions  = 0;
@@ -670,6 +784,28 @@ void ApplicationV8::collectGarbage () {
   _gcFinished = true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the state of the STANDARD contexts
+////////////////////////////////////////////////////////////////////////////////
+
+ApplicationV8::V8ContextStatistics ApplicationV8::contextStatistics () {
+  V8ContextStatistics result;
+
+  CONDITION_LOCKER(guard, _contextCondition);
+
+  result._available = _contexts[DEFAULT_NAME].size();
+  result._busy      = _busyContexts[DEFAULT_NAME].size();
+  result._dirty     = _dirtyContexts[DEFAULT_NAME].size();
+  result._free      = _freeContexts[DEFAULT_NAME].size();
+  result._min       = _nrInstances[DEFAULT_NAME];
+  result._max       = (std::max)(static_cast<size_t>(_maxContexts), result._min);
+  result._created   = _contextsCreated;
+  result._removed   = _contextsRemoved;
+  result._timeouts  = _contextTimeouts;
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief disables actions
 ////////////////////////////////////////////////////////////////////////////////
@@ -893,7 +1029,7 @@ bool ApplicationV8::prepareNamedContexts (const string& name,
                                           const string& worker) {
   {
     CONDITION_LOCKER(guard, _contextCondition);
-    _contexts[name] = new V8Context*[concurrency];
+    _contexts[name].resize(concurrency, nullptr);
     _nrInstances[name] = concurrency;
   }
   
@@ -969,6 +1105,11 @@ void ApplicationV8::setupOptions (map<string, basics::ProgramOptionsDescription>
     ("javascript.app-path", &_appPath, "directory for Foxx applications (normal mode)")
     ("javascript.startup-directory", &_startupPath, "path to the directory containing JavaScript startup scripts")
     ("javascript.v8-options", &_v8Options, "options to pass to v8")
+    ("javascript.v8-contexts-max", &_maxContexts, "maximum number of V8 contexts, additional contexts are created on demand")
+    ("javascript.v8-contexts-grow-wait", &_contextsGrowWait, "wait time (in seconds) for a V8 context after which another context is created")
+    ("javascript.v8-contexts-idle-timeout", &_contextsIdleTimeout, "idle time (in seconds) after which an additional V8 context is removed")
+    ("javascript.v8-contexts-max-wait", &_contextsMaxWait, "maximum wait time (in seconds) for a V8 context, 0 means unlimited")
+    ("javascript.code-cache", &_useCodeCache, "share the compiled code of the JavaScript files between V8 contexts")
   ;
 
   options["Hidden Options"]
@@ -1038,6 +1179,16 @@ bool ApplicationV8::prepare () {
     _gcFrequency = 1;
   }
 
+  if (_contextsGrowWait < 0.0) {
+    _contextsGrowWait = 0.0;
+  }
+
+  if (_contextsMaxWait < 0.0) {
+    _contextsMaxWait = 0.0;
+  }
+
+  JSCodeCache::enable(_useCodeCache);
+
   return true;
 }
 
@@ -1057,17 +1208,31 @@ bool ApplicationV8::prepare2 () {
   // setup instances
   {
     CONDITION_LOCKER(guard, _contextCondition);
-    _contexts[DEFAULT_NAME] = new V8Context*[nrInstances];
+    _contexts[DEFAULT_NAME].resize(nrInstances, nullptr);
+    _nextContextId = nrInstances;
+  }
+
+  if (_maxContexts > nrInstances) {
+    LOG_INFO("using between %d and %d V8 contexts", (int) nrInstances, (int) _maxContexts);
   }
 
   std::vector<std::thread> threads;
   _ok = true;
-  for (size_t i = 0; i < nrInstances;  ++i) {
+  size_t first = 0;
+
+  if (JSCodeCache::enabled() && nrInstances > 1) {
+    // the first context fills the code cache, so the other contexts do not
+    // need to compile the startup files again
+    prepareV8InstanceInThread(DEFAULT_NAME, 0, _useActions);
+    first = 1;
+  }
+
+  for (size_t i = first; i < nrInstances;  ++i) {
     threads.push_back(std::thread(&ApplicationV8::prepareV8InstanceInThread, 
                                   this, DEFAULT_NAME, i, _useActions));
   }
-  for (size_t i = 0; i < nrInstances; ++i) {
-    threads[i].join();
+  for (auto& thread : threads) {
+    thread.join();
   }
   return _ok;
 }
@@ -1167,15 +1332,12 @@ void ApplicationV8::stop () {
   {
     CONDITION_LOCKER(guard, _contextCondition);
 
-    for (auto all : _contexts) {
-      const string& name = all.first;
-      size_t nrInstances = _nrInstances[name];
-
-      for (size_t i = 0;  i < nrInstances;  ++i) {
-        shutdownV8Instance(name, i);
+    for (auto& all : _contexts) {
+      for (auto context : all.second) {
+        shutdownV8Instance(context);
       }
 
-      delete[] _contexts[name];
+      all.second.clear();
     }
   }
 
@@ -1254,6 +1416,81 @@ ApplicationV8::V8Context* ApplicationV8::pickFreeContextForGc () {
   return context;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the garbage collection thread should create a context
+////////////////////////////////////////////////////////////////////////////////
+
+bool ApplicationV8::needsMoreContexts () {
+  return _contextsRequested > _freeContexts[DEFAULT_NAME].size() &&
+         _contexts[DEFAULT_NAME].size() < _maxContexts;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates an additional STANDARD context
+////////////////////////////////////////////////////////////////////////////////
+
+void ApplicationV8::addContext () {
+  // only called by the garbage collection thread
+  size_t const id = _nextContextId++;
+
+  LOG_DEBUG("creating additional V8 context #%d", (int) id);
+
+  V8Context* context = createV8Instance(DEFAULT_NAME, id, _useActions);
+
+  {
+    // register the context before loading the startup files, so global
+    // methods issued in the meantime are queued for it. they are executed
+    // when the context is entered for the first time
+    CONDITION_LOCKER(guard, _contextCondition);
+
+    if (_coordinatorBootstrapped) {
+      context->addGlobalContextMethod(GlobalContextMethods::getName(GlobalContextMethods::TYPE_BOOTSTRAP_COORDINATOR));
+    }
+
+    _contexts[DEFAULT_NAME].push_back(context);
+  }
+
+  loadV8Server(context, _startupFile);
+
+  CONDITION_LOCKER(guard, _contextCondition);
+
+  // only now the context can be handed out
+  _freeContexts[DEFAULT_NAME].push_back(context);
+  ++_contextsCreated;
+
+  guard.broadcast();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes an additional STANDARD context that has not been used
+/// for the idle timeout
+////////////////////////////////////////////////////////////////////////////////
+
+ApplicationV8::V8Context* ApplicationV8::removeIdleContext () {
+  auto& freeContexts = _freeContexts[DEFAULT_NAME];
+
+  // the contexts created at startup are kept
+  size_t const nrInstances = _nrInstances[DEFAULT_NAME];
+  double const now = TRI_microtime();
+
+  for (auto it = freeContexts.begin(); it != freeContexts.end(); ++it) {
+    V8Context* context = (*it);
+
+    if (context->_id >= nrInstances &&
+        context->_lastUseStamp + _contextsIdleTimeout < now) {
+      freeContexts.erase(it);
+
+      auto& contexts = _contexts[DEFAULT_NAME];
+      contexts.erase(std::find(contexts.begin(), contexts.end(), context));
+      ++_contextsRemoved;
+
+      return context;
+    }
+  }
+
+  return nullptr;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief prepares a V8 instance
 ////////////////////////////////////////////////////////////////////////////////
@@ -1261,13 +1498,25 @@ ApplicationV8::V8Context* ApplicationV8::pickFreeContextForGc () {
 bool ApplicationV8::prepareV8Instance (const string& name, size_t i, bool useActions) {
   CONDITION_LOCKER(guard, _contextCondition);
 
+  V8Context* context = _contexts[name][i] = createV8Instance(name, i, useActions);
+
+  _freeContexts[name].push_back(context);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a V8 instance
+////////////////////////////////////////////////////////////////////////////////
+
+ApplicationV8::V8Context* ApplicationV8::createV8Instance (const string& name, size_t i, bool useActions) {
   vector<string> files;
 
   files.push_back("server/initialise.js");
 
   v8::Isolate* isolate = v8::Isolate::New();
   
-  V8Context* context = _contexts[name][i] = new V8Context();
+  V8Context* context = new V8Context();
 
   if (context == nullptr) {
     LOG_FATAL_AND_EXIT("cannot initialize V8 context #%d", (int) i);
@@ -1379,12 +1628,11 @@ bool ApplicationV8::prepareV8Instance (const string& name, size_t i, bool useAct
   context->_numExecutions  = 0;
   context->_hasDeadObjects = true;
   context->_lastGcStamp    = TRI_microtime();
+  context->_lastUseStamp   = context->_lastGcStamp;
 
   LOG_TRACE("initialised V8 context #%d", (int) i);
 
-  _freeContexts[name].push_back(context);
-
-  return true;
+  return context;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1392,10 +1640,16 @@ bool ApplicationV8::prepareV8Instance (const string& name, size_t i, bool useAct
 ////////////////////////////////////////////////////////////////////////////////
 
 void ApplicationV8::prepareV8Server (const string& name, const size_t i, const string& startupFile) {
+  loadV8Server(_contexts[name][i], startupFile);
+}
 
-  // enter context and isolate
-  V8Context* context = _contexts[name][i];
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads the startup file of the V8 server into a context
+////////////////////////////////////////////////////////////////////////////////
 
+void ApplicationV8::loadV8Server (V8Context* context, const string& startupFile) {
+
+  // enter context and isolate
   auto isolate = context->isolate;
   TRI_ASSERT(context->_locker == nullptr);
   context->_locker = new v8::Locker(isolate);
@@ -1428,17 +1682,15 @@ void ApplicationV8::prepareV8Server (const string& name, const size_t i, const s
   context->_locker = nullptr;
 
   // initialise garbage collection for context
-  LOG_TRACE("initialised V8 server #%d", (int) i);
+  LOG_TRACE("initialised V8 server #%d", (int) context->_id);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief shut downs a V8 instances
 ////////////////////////////////////////////////////////////////////////////////
 
-void ApplicationV8::shutdownV8Instance (const string& name, size_t i) {
-  LOG_TRACE("shutting down V8 context #%d", (int) i);
-
-  V8Context* context = _contexts[name][i];
+void ApplicationV8::shutdownV8Instance (V8Context* context) {
+  LOG_TRACE("shutting down V8 context #%d", (int) context->_id);
 
   auto isolate = context->isolate;
   isolate->Enter();
@@ -37,6 +37,7 @@
 #include <v8.h>
 
 #include "Basics/ConditionVariable.h"
+#include "Statistics/histogram.h"
 #include "V8/JSLoader.h"
 
 // -----------------------------------------------------------------------------
@@ -247,6 +248,12 @@ namespace triagens {
 
           double _lastGcStamp;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief timestamp of the last exit from the context
+////////////////////////////////////////////////////////////////////////////////
+
+          double _lastUseStamp;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not the context has dead (ex-v8 wrapped) objects
 ////////////////////////////////////////////////////////////////////////////////
@@ -254,6 +261,62 @@ namespace triagens {
           bool _hasDeadObjects;
         };
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief state of the STANDARD contexts
+////////////////////////////////////////////////////////////////////////////////
+
+        struct V8ContextStatistics {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of existing contexts
+////////////////////////////////////////////////////////////////////////////////
+
+          size_t _available;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of contexts executing JavaScript
+////////////////////////////////////////////////////////////////////////////////
+
+          size_t _busy;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of contexts waiting for the garbage collection
+////////////////////////////////////////////////////////////////////////////////
+
+          size_t _dirty;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of unused contexts
+////////////////////////////////////////////////////////////////////////////////
+
+          size_t _free;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of contexts created at startup, which are never removed
+////////////////////////////////////////////////////////////////////////////////
+
+          size_t _min;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of contexts
+////////////////////////////////////////////////////////////////////////////////
+
+          size_t _max;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of contexts created and removed after startup
+////////////////////////////////////////////////////////////////////////////////
+
+          uint64_t _created;
+          uint64_t _removed;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of threads that gave up waiting for a context
+////////////////////////////////////////////////////////////////////////////////
+
+          uint64_t _timeouts;
+        };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                      constructors and destructors
 // -----------------------------------------------------------------------------
@@ -301,11 +364,18 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief enters an context
+///
+/// returns a nullptr if the server is shutting down. If limitWait is set,
+/// it also returns a nullptr if no STANDARD context became available within
+/// the maximum wait time, and sets the error code to
+/// TRI_ERROR_V8_CONTEXT_TIMEOUT. This is meant for requests and queries that
+/// should fail fast, background jobs wait until a context is available.
 ////////////////////////////////////////////////////////////////////////////////
 
         V8Context* enterContext (std::string const& name,
                                  TRI_vocbase_s*,
-                                 bool useDatabase);
+                                 bool useDatabase,
+                                 bool limitWait = false);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief exists an context
@@ -321,10 +391,35 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief runs the garbage collection
+///
+/// the garbage collection thread also creates STANDARD contexts when threads
+/// wait too long for one, and removes them again when they are not used
 ////////////////////////////////////////////////////////////////////////////////
 
         void collectGarbage ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the state of the STANDARD contexts
+////////////////////////////////////////////////////////////////////////////////
+
+        V8ContextStatistics contextStatistics ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the times threads waited for a STANDARD context
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram const& contextWaitTimes () const {
+          return _contextWaitTimes;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the durations of the garbage collections
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram const& gcTimes () const {
+          return _gcTimes;
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief disables actions
 ////////////////////////////////////////////////////////////////////////////////
@@ -427,12 +522,42 @@ namespace triagens {
 
         V8Context* pickFreeContextForGc ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the garbage collection thread should create a context
+///
+/// Caller must hold the _contextCondition.
+////////////////////////////////////////////////////////////////////////////////
+
+        bool needsMoreContexts ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates an additional STANDARD context
+////////////////////////////////////////////////////////////////////////////////
+
+        void addContext ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes an additional STANDARD context that has not been used
+/// for the idle timeout
+///
+/// Caller must hold the _contextCondition. Returns the context, which the
+/// caller must shut down after releasing the lock
+////////////////////////////////////////////////////////////////////////////////
+
+        V8Context* removeIdleContext ();
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief prepares a V8 instance
 ////////////////////////////////////////////////////////////////////////////////
 
         bool prepareV8Instance (const std::string& name, size_t i, bool useActions);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates a V8 instance
+////////////////////////////////////////////////////////////////////////////////
+
+        V8Context* createV8Instance (const std::string& name, size_t i, bool useActions);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief prepares a V8 instance, multi-threaded version calling the above
 ////////////////////////////////////////////////////////////////////////////////
@@ -450,11 +575,17 @@ namespace triagens {
 
         void prepareV8Server (const std::string& name, size_t i, const std::string& startupFile);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads the startup file of the V8 server into a context
+////////////////////////////////////////////////////////////////////////////////
+
+        void loadV8Server (V8Context*, const std::string& startupFile);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief shuts down a V8 instance
 ////////////////////////////////////////////////////////////////////////////////
 
-        void shutdownV8Instance (const std::string& name, size_t i);
+        void shutdownV8Instance (V8Context*);
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
@@ -573,6 +704,81 @@ namespace triagens {
 
         std::string _v8Options;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of V8 contexts
+/// @startDocuBlock jsV8ContextsMax
+/// `--javascript.v8-contexts-max number`
+///
+/// Specifies the maximum *number* of V8 contexts for executing JavaScript
+/// actions. If all contexts are in use and a request has waited for
+/// *--javascript.v8-contexts-grow-wait* seconds, an additional context is
+/// created, until there are *number* contexts. The default value is *0*, which
+/// means that no contexts are created in addition to the
+/// *--javascript.v8-contexts* contexts created at startup.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _maxContexts;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait time after which an additional V8 context is created
+/// @startDocuBlock jsV8ContextsGrowWait
+/// `--javascript.v8-contexts-grow-wait seconds`
+///
+/// Specifies the time in *seconds* a request waits for a free V8 context
+/// before an additional context is created. Creating a context takes some
+/// time, so a request might also be served by a context freed in the meantime.
+/// The default value is *0.1*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        double _contextsGrowWait;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief idle time after which an additional V8 context is removed
+/// @startDocuBlock jsV8ContextsIdleTimeout
+/// `--javascript.v8-contexts-idle-timeout seconds`
+///
+/// Specifies the time in *seconds* after which an unused V8 context created in
+/// addition to the *--javascript.v8-contexts* contexts is removed again, so
+/// its memory is given back. The default value is *60*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        double _contextsIdleTimeout;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum wait time for a V8 context
+/// @startDocuBlock jsV8ContextsMaxWait
+/// `--javascript.v8-contexts-max-wait seconds`
+///
+/// Specifies the maximum time in *seconds* a request waits for a free V8
+/// context. Requests that do not get a context in time fail with HTTP 503
+/// (*service unavailable*) instead of queuing up. The limit applies to
+/// JavaScript actions and AQL queries only, background tasks and jobs wait
+/// until a context becomes available. The default value is *0*, which means
+/// that requests wait until a context becomes available.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        double _contextsMaxWait;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief use a code cache for the JavaScript files
+/// @startDocuBlock jsCodeCache
+/// `--javascript.code-cache flag`
+///
+/// If *true*, the code V8 compiles for the JavaScript startup files and modules
+/// is kept in memory, and all other V8 contexts use this code instead of
+/// compiling the files again. This makes creating V8 contexts considerably
+/// faster, both at server start and when additional contexts are created. The
+/// cached code of a file is only used as long as the file is unchanged. The
+/// default value is *true*.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _useCodeCache;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief V8 startup loader
 ////////////////////////////////////////////////////////////////////////////////
@@ -595,7 +801,7 @@ namespace triagens {
 /// @brief V8 contexts
 ////////////////////////////////////////////////////////////////////////////////
 
-        std::map<std::string, V8Context**> _contexts;
+        std::map<std::string, std::vector<V8Context*>> _contexts;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief V8 contexts queue lock
@@ -621,6 +827,50 @@ namespace triagens {
 
         std::map<std::string, std::set<V8Context*>> _busyContexts;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief identifier of the next STANDARD context created after startup
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _nextContextId;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of threads that have waited too long for a STANDARD context
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _contextsRequested;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of STANDARD contexts created and removed after startup
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _contextsCreated;
+        uint64_t _contextsRemoved;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of threads that gave up waiting for a STANDARD context
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _contextTimeouts;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the coordinator has been bootstrapped, so that contexts
+/// created later need to be bootstrapped, too
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _coordinatorBootstrapped;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief times threads waited for a STANDARD context
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram _contextWaitTimes;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief durations of the garbage collections
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram _gcTimes;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief shutdown in progress
 ////////////////////////////////////////////////////////////////////////////////
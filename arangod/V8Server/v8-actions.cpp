@@ -44,6 +44,7 @@
 #include "HttpServer/HttpServer.h"
 #include "Rest/HttpRequest.h"
 #include "Rest/HttpResponse.h"
+#include "V8/JSCodeCache.h"
 #include "V8/v8-buffer.h"
 #include "V8/v8-conv.h"
 #include "V8/v8-utils.h"
@@ -141,11 +142,28 @@ class v8_action_t : public TRI_action_t {
       ApplicationV8::V8Context* context = GlobalV8Dealer->enterContext(
         "STANDARD",
         vocbase,
-        allowUseDatabaseInRestActions
+        allowUseDatabaseInRestActions,
+        true
       );
 
       // note: the context might be 0 in case of shut-down
       if (context == nullptr) {
+        if (TRI_errno() == TRI_ERROR_V8_CONTEXT_TIMEOUT) {
+          // all contexts are busy, fail fast instead of queuing up
+          result.isValid = true;
+          result.response = new HttpResponse(HttpResponse::SERVICE_UNAVAILABLE, request->compatibility());
+          result.response->setContentType("application/json; charset=utf-8");
+
+          result.response->body()
+          .appendText("{\"error\":true,\"errorMessage\":\"")
+          .appendText(TRI_errno_string(TRI_ERROR_V8_CONTEXT_TIMEOUT))
+          .appendText("\",\"code\":")
+          .appendInteger((int) HttpResponse::SERVICE_UNAVAILABLE)
+          .appendText(",\"errorNum\":")
+          .appendInteger(TRI_ERROR_V8_CONTEXT_TIMEOUT)
+          .appendText("}");
+        }
+
         return result;
       }
 
@@ -899,6 +917,53 @@ static void JS_ExecuteGlobalContextFunction (const v8::FunctionCallbackInfo<v8::
   TRI_V8_RETURN_UNDEFINED();
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the state of the V8 contexts
+///
+/// @FUN{internal.v8ContextStatistics()}
+////////////////////////////////////////////////////////////////////////////////
+
+static void JS_V8ContextStatistics (const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  if (args.Length() != 0) {
+    TRI_V8_THROW_EXCEPTION_USAGE("v8ContextStatistics()");
+  }
+
+  ApplicationV8::V8ContextStatistics const info = GlobalV8Dealer->contextStatistics();
+
+  v8::Handle<v8::Object> result = v8::Object::New(isolate);
+
+  result->Set(TRI_V8_ASCII_STRING("available"), v8::Number::New(isolate, (double) info._available));
+  result->Set(TRI_V8_ASCII_STRING("busy"),      v8::Number::New(isolate, (double) info._busy));
+  result->Set(TRI_V8_ASCII_STRING("dirty"),     v8::Number::New(isolate, (double) info._dirty));
+  result->Set(TRI_V8_ASCII_STRING("free"),      v8::Number::New(isolate, (double) info._free));
+  result->Set(TRI_V8_ASCII_STRING("min"),       v8::Number::New(isolate, (double) info._min));
+  result->Set(TRI_V8_ASCII_STRING("max"),       v8::Number::New(isolate, (double) info._max));
+  result->Set(TRI_V8_ASCII_STRING("created"),   v8::Number::New(isolate, (double) info._created));
+  result->Set(TRI_V8_ASCII_STRING("removed"),   v8::Number::New(isolate, (double) info._removed));
+  result->Set(TRI_V8_ASCII_STRING("timeouts"),  v8::Number::New(isolate, (double) info._timeouts));
+
+  TRI_FillHistogramV8(isolate, result, TRI_V8_ASCII_STRING("waitTime"), GlobalV8Dealer->contextWaitTimes());
+  TRI_FillHistogramV8(isolate, result, TRI_V8_ASCII_STRING("gcTime"), GlobalV8Dealer->gcTimes());
+
+  JSCodeCache::Statistics const cache = JSCodeCache::statistics();
+
+  v8::Handle<v8::Object> codeCache = v8::Object::New(isolate);
+
+  codeCache->Set(TRI_V8_ASCII_STRING("enabled"),  v8::Boolean::New(isolate, JSCodeCache::enabled()));
+  codeCache->Set(TRI_V8_ASCII_STRING("entries"),  v8::Number::New(isolate, (double) cache._entries));
+  codeCache->Set(TRI_V8_ASCII_STRING("memory"),   v8::Number::New(isolate, (double) cache._memory));
+  codeCache->Set(TRI_V8_ASCII_STRING("hits"),     v8::Number::New(isolate, (double) cache._hits));
+  codeCache->Set(TRI_V8_ASCII_STRING("misses"),   v8::Number::New(isolate, (double) cache._misses));
+  codeCache->Set(TRI_V8_ASCII_STRING("rejected"), v8::Number::New(isolate, (double) cache._rejected));
+
+  result->Set(TRI_V8_ASCII_STRING("codeCache"), codeCache);
+
+  TRI_V8_RETURN(result);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the current request
 ///
@@ -1430,6 +1495,7 @@ void TRI_InitV8Actions (v8::Isolate* isolate,
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_RAW_REQUEST_BODY"), JS_RawRequestBody, true);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_REQUEST_PARTS"), JS_RequestParts, true);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_SEND_CHUNK"), JS_SendChunk);
+  TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_V8_CONTEXT_STATISTICS"), JS_V8ContextStatistics);
 }
 
 // -----------------------------------------------------------------------------
@@ -1717,12 +1717,19 @@ static TRI_doc_collection_info_t* GetFigures (TRI_vocbase_col_t* collection) {
 ///   only contained in the write-ahead log are not reporting in this figure.
 /// * *datafiles.count*: The number of datafiles.
 /// * *datafiles.fileSize*: The total filesize of datafiles (in bytes).
+/// * *datafiles.residentSize*: The number of bytes of the datafiles that are
+///   currently in memory. Reading other parts of the datafiles requires disk
+///   I/O.
 /// * *journals.count*: The number of journal files.
 /// * *journals.fileSize*: The total filesize of the journal files
 ///   (in bytes).
+/// * *journals.residentSize*: The number of bytes of the journal files that
+///   are currently in memory.
 /// * *compactors.count*: The number of compactor files.
 /// * *compactors.fileSize*: The total filesize of the compactor files
 ///   (in bytes).
+/// * *compactors.residentSize*: The number of bytes of the compactor files
+///   that are currently in memory.
 /// * *shapefiles.count*: The number of shape files. This value is
 ///   deprecated and kept for compatibility reasons only. The value will always
 ///   be 0 since ArangoDB 2.0 and higher.
@@ -1826,6 +1833,7 @@ static void JS_FiguresVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>& arg
   result->Set(TRI_V8_ASCII_STRING("datafiles"), dfs);
   dfs->Set(TRI_V8_ASCII_STRING("count"),         v8::Number::New(isolate, (double) info->_numberDatafiles));
   dfs->Set(TRI_V8_ASCII_STRING("fileSize"),      v8::Number::New(isolate, (double) info->_datafileSize));
+  dfs->Set(TRI_V8_ASCII_STRING("residentSize"),  v8::Number::New(isolate, (double) info->_datafileResidentSize));
 
   // journal info
   v8::Handle<v8::Object> js = v8::Object::New(isolate);
@@ -1833,6 +1841,7 @@ static void JS_FiguresVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>& arg
   result->Set(TRI_V8_ASCII_STRING("journals"), js);
   js->Set(TRI_V8_ASCII_STRING("count"),          v8::Number::New(isolate, (double) info->_numberJournalfiles));
   js->Set(TRI_V8_ASCII_STRING("fileSize"),       v8::Number::New(isolate, (double) info->_journalfileSize));
+  js->Set(TRI_V8_ASCII_STRING("residentSize"),   v8::Number::New(isolate, (double) info->_journalfileResidentSize));
 
   // compactors info
   v8::Handle<v8::Object> cs = v8::Object::New(isolate);
@@ -1840,6 +1849,7 @@ static void JS_FiguresVocbaseCol (const v8::FunctionCallbackInfo<v8::Value>& arg
   result->Set(TRI_V8_ASCII_STRING("compactors"), cs);
   cs->Set(TRI_V8_ASCII_STRING("count"),          v8::Number::New(isolate, (double) info->_numberCompactorfiles));
   cs->Set(TRI_V8_ASCII_STRING("fileSize"),       v8::Number::New(isolate, (double) info->_compactorfileSize));
+  cs->Set(TRI_V8_ASCII_STRING("residentSize"),   v8::Number::New(isolate, (double) info->_compactorfileResidentSize));
 
   // shapefiles info
   v8::Handle<v8::Object> sf = v8::Object::New(isolate);
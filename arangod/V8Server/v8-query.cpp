@@ -354,6 +354,14 @@ static TRI_index_operator_t* SetupConditionsSkiplist (v8::Isolate* isolate,
           goto MEM_ERROR;
         }
 
+        if (i == 1 && 
+            ((TRI_skiplist_index_t*) idx)->_skiplistIndex->_vertex != TRI_SKIPLIST_VERTEX_NONE) {
+          // a vertex-centric index does not order the vertices like strings,
+          // so it cannot answer range conditions on the vertex attribute
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+          goto MEM_ERROR;
+        }
+
         TRI_index_operator_type_e opType;
         if (opValue == ">") {
           opType = TRI_GT_INDEX_OPERATOR;
@@ -186,6 +186,11 @@ static void JS_SynchroniseReplication (const v8::FunctionCallbackInfo<v8::Value>
     verbose = TRI_ObjectToBoolean(object->Get(TRI_V8_ASCII_STRING("verbose")));
   }
 
+  bool incremental = false;
+  if (object->Has(TRI_V8_ASCII_STRING("incremental"))) {
+    incremental = TRI_ObjectToBoolean(object->Get(TRI_V8_ASCII_STRING("incremental")));
+  }
+
   if (endpoint.empty()) {
     TRI_V8_THROW_EXCEPTION_PARAMETER("<endpoint> must be a valid endpoint");
   }
@@ -216,7 +221,7 @@ static void JS_SynchroniseReplication (const v8::FunctionCallbackInfo<v8::Value>
   }
 
   string errorMsg = "";
-  InitialSyncer syncer(vocbase, &config, restrictCollections, restrictType, verbose);
+  InitialSyncer syncer(vocbase, &config, restrictCollections, restrictType, verbose, incremental);
   TRI_DestroyConfigurationReplicationApplier(&config);
 
   int res = TRI_ERROR_NO_ERROR;
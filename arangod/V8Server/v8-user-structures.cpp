@@ -29,793 +29,14 @@
 
 #include "v8-user-structures.h"
 #include "Basics/Exceptions.h"
-#include "Basics/ReadWriteLock.h"
-#include "Basics/ReadLocker.h"
-#include "Basics/WriteLocker.h"
-#include "Basics/hashes.h"
 #include "Basics/json.h"
-#include "Basics/json-utilities.h"
-#include "Basics/tri-strings.h"
+#include "Utils/KeySpaces.h"
 #include "VocBase/vocbase.h"
 #include "V8/v8-conv.h"
 #include "V8/v8-utils.h"
 
-// -----------------------------------------------------------------------------
-// --SECTION--                                            struct KeySpaceElement
-// -----------------------------------------------------------------------------
-
-struct KeySpaceElement {
-  KeySpaceElement () = delete;
-  
-  KeySpaceElement (char const* k,
-                   size_t length,
-                   TRI_json_t* json) 
-    : key(nullptr),
-      json(json) {
-
-    key = TRI_DuplicateString2Z(TRI_UNKNOWN_MEM_ZONE, k, length);
-    if (key == nullptr) {
-      THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
-    }
-  }
-
-  ~KeySpaceElement () {
-    if (key != nullptr) {
-      TRI_FreeString(TRI_UNKNOWN_MEM_ZONE, key);
-    }
-    if (json != nullptr) {
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
-    }
-  }
-
-  void setValue (TRI_json_t* value) {
-    if (json != nullptr) {
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
-      json = nullptr;
-    }
-    json = value;
-  }
-
-  char*        key;
-  TRI_json_t*  json;
-};
-
-// -----------------------------------------------------------------------------
-// --SECTION--                                                    class KeySpace
-// -----------------------------------------------------------------------------
-
-class KeySpace {
-  public:
-    KeySpace (uint32_t initialSize) 
-      : _lock() {
-
-      TRI_InitAssociativePointer(&_hash, 
-                                 TRI_UNKNOWN_MEM_ZONE,
-                                 TRI_HashStringKeyAssociativePointer,
-                                 HashHash,
-                                 EqualHash,
-                                 nullptr);
-
-      if (initialSize > 0) {
-        TRI_ReserveAssociativePointer(&_hash, initialSize);
-      }
-    } 
-
-    ~KeySpace () {
-      uint32_t const n = _hash._nrAlloc;
-      for (uint32_t i = 0; i < n; ++i) {
-        auto element = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-        if (element != nullptr) {
-          delete element;
-        }
-      }
-      TRI_DestroyAssociativePointer(&_hash);
-    }
-
-    static uint64_t HashHash (TRI_associative_pointer_t*,
-                              void const* element) {
-      return TRI_FnvHashString(static_cast<KeySpaceElement const*>(element)->key);
-    }
-
-    static bool EqualHash (TRI_associative_pointer_t*,
-                           void const* key,
-                           void const* element) {
-      return TRI_EqualString(static_cast<char const*>(key), static_cast<KeySpaceElement const*>(element)->key);
-    }
-
-    uint32_t keyspaceCount () {
-      READ_LOCKER(_lock);
-      return _hash._nrUsed;
-    }
-
-    uint32_t keyspaceCount (std::string const& prefix) {
-      uint32_t count = 0;
-      READ_LOCKER(_lock);
-
-      uint32_t const n = _hash._nrAlloc;
-      for (uint32_t i = 0; i < n; ++i) {
-        auto data = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-        if (data != nullptr) {
-          if (TRI_IsPrefixString(data->key, prefix.c_str())) {
-            ++count;
-          }
-        }
-      }
-
-      return count;
-    }
-
-    v8::Handle<v8::Value> keyspaceRemove (v8::Isolate* isolate) {
-      v8::EscapableHandleScope scope(isolate);
-
-      WRITE_LOCKER(_lock);
-
-      uint32_t const n = _hash._nrAlloc;
-      uint32_t deleted = 0;
-
-      for (uint32_t i = 0; i < n; ++i) {
-        auto element = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-        if (element != nullptr) {
-          delete element;
-          _hash._table[i] = nullptr;
-          ++deleted;
-        }
-      }
-      _hash._nrUsed = 0;
-
-      return scope.Escape<v8::Value>(v8::Number::New(isolate, static_cast<int>(deleted)));
-    }
-
-    v8::Handle<v8::Value> keyspaceRemove (v8::Isolate* isolate,
-                                          std::string const& prefix) {
-      v8::EscapableHandleScope scope(isolate);
-      WRITE_LOCKER(_lock);
-
-      uint32_t const n = _hash._nrAlloc;
-      uint32_t i = 0;
-      uint32_t deleted = 0;
-
-      while (i < n) {
-        auto element = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-        if (element != nullptr) {
-          if (TRI_IsPrefixString(element->key, prefix.c_str())) {
-            if (TRI_RemoveKeyAssociativePointer(&_hash, element->key) != nullptr) {
-              delete element;
-              ++deleted;
-              continue;
-            }
-          }
-        }
-        ++i;
-      }
-
-      return scope.Escape<v8::Value>(v8::Number::New(isolate, static_cast<int>(deleted)));
-    }
-
-    v8::Handle<v8::Value> keyspaceKeys (v8::Isolate* isolate) {
-      v8::EscapableHandleScope scope(isolate);
-      v8::Handle<v8::Array> result;
-      {
-        READ_LOCKER(_lock);
-
-        uint32_t const n = _hash._nrAlloc;
-        uint32_t count = 0;
-        result = v8::Array::New(isolate, static_cast<int>(_hash._nrUsed));
-
-        for (uint32_t i = 0; i < n; ++i) {
-          auto element = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-          if (element != nullptr) {
-            result->Set(count++, TRI_V8_STRING(element->key));
-          }
-        }
-      }
-
-      return scope.Escape<v8::Value>(result);
-    }
-
-   v8::Handle<v8::Value> keyspaceKeys (v8::Isolate* isolate, std::string const& prefix) {
-     v8::EscapableHandleScope scope(isolate);
-      v8::Handle<v8::Array> result;
-      {
-        READ_LOCKER(_lock);
-
-        uint32_t const n = _hash._nrAlloc;
-        uint32_t count = 0;
-        result = v8::Array::New(isolate);
-
-        for (uint32_t i = 0; i < n; ++i) {
-          auto element = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-          if (element != nullptr) {
-            if (TRI_IsPrefixString(element->key, prefix.c_str())) {
-              result->Set(count++, TRI_V8_STRING(element->key));
-            }
-          }
-        }
-      }
-
-      return scope.Escape<v8::Value>(result);
-    }
-
-    v8::Handle<v8::Value> keyspaceGet (v8::Isolate* isolate) {
-      v8::EscapableHandleScope scope(isolate);
-      v8::Handle<v8::Object> result = v8::Object::New(isolate);
-      {
-        READ_LOCKER(_lock);
-
-        uint32_t const n = _hash._nrAlloc;
-
-        for (uint32_t i = 0; i < n; ++i) {
-          auto element = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-          if (element != nullptr) {
-            result->Set(TRI_V8_STRING(element->key), TRI_ObjectJson(isolate, element->json));
-          }
-        }
-      }
-
-      return scope.Escape<v8::Value>(result);
-    }
-
-    v8::Handle<v8::Value> keyspaceGet (v8::Isolate* isolate, std::string const& prefix) {
-      v8::EscapableHandleScope scope(isolate);
-      v8::Handle<v8::Object> result = v8::Object::New(isolate);
-      {
-        READ_LOCKER(_lock);
-
-        uint32_t const n = _hash._nrAlloc;
-
-        for (uint32_t i = 0; i < n; ++i) {
-          auto element = static_cast<KeySpaceElement*>(_hash._table[i]);
-
-          if (element != nullptr) {
-            if (TRI_IsPrefixString(element->key, prefix.c_str())) {
-              result->Set(TRI_V8_STRING(element->key), TRI_ObjectJson(isolate, element->json));
-            }
-          }
-        }
-      }
-
-      return scope.Escape<v8::Value>(result);
-    }
-
-    bool keyCount (std::string const& key, 
-                   uint32_t& result) {
-      READ_LOCKER(_lock);
-
-      auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-      if (found != nullptr) {
-        TRI_json_t const* value = found->json;
-
-        if (TRI_IsArrayJson(value)) {
-          result = static_cast<uint32_t>(TRI_LengthVector(&value->_value._objects));
-          return true;
-        }
-        if (TRI_IsObjectJson(value)) {
-          result = static_cast<uint32_t>(TRI_LengthVector(&value->_value._objects) / 2);
-          return true;
-        }
-      }
-
-      result = 0;
-      return false;
-    }
-
-    v8::Handle<v8::Value> keyGet (v8::Isolate* isolate, std::string const& key) {
-      v8::Handle<v8::Value> result;
-      {
-        READ_LOCKER(_lock);
-
-        auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-        if (found == nullptr) {
-          result = v8::Undefined(isolate);
-        }
-        else {
-          result = TRI_ObjectJson(isolate, found->json);
-        }
-      }
-
-      return result; 
-    }
-
-    bool keySet (v8::Isolate* isolate,
-                 std::string const& key,
-                 v8::Handle<v8::Value> const& value,
-                 bool replace) {
-      auto element = new KeySpaceElement(key.c_str(), key.size(), TRI_ObjectToJson(isolate, value));
-      KeySpaceElement* found = nullptr;
-
-      {
-        WRITE_LOCKER(_lock);
- 
-        found = static_cast<KeySpaceElement*>(TRI_InsertKeyAssociativePointer(&_hash, element->key, element, replace));
-      }
-   
-      if (found == nullptr) {
-        return true;
-      }
-        
-      if (replace) {
-        delete found;
-        return true;
-      }
-
-      delete element;
-      return false;
-    }
-
-    int keyCas (v8::Isolate* isolate,
-                std::string const& key,
-                v8::Handle<v8::Value> const& value,
-                v8::Handle<v8::Value> const& compare,
-                bool& match) {
-      auto element = new KeySpaceElement(key.c_str(), key.size(), TRI_ObjectToJson(isolate, value));
-
-      WRITE_LOCKER(_lock);
- 
-      auto found = static_cast<KeySpaceElement*>(TRI_InsertKeyAssociativePointer(&_hash, element->key, element, false));
-   
-      if (compare->IsUndefined()) {
-        if (found == nullptr) {
-          // no object saved yet
-          TRI_InsertKeyAssociativePointer(&_hash, element->key, element, false);
-          match = true;
-        }
-        else {
-          match = false;
-        }
-        return TRI_ERROR_NO_ERROR;
-      }
-
-      TRI_json_t* other = TRI_ObjectToJson(isolate, compare);
-
-      if (other == nullptr) {
-        delete element;
-        // TODO: fix error message
-        return TRI_ERROR_OUT_OF_MEMORY;
-      }
-        
-      int res = TRI_CompareValuesJson(found->json, other);
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, other); 
-
-      if (res != 0) {
-        delete element;
-        match = false;
-      }
-      else {
-        TRI_InsertKeyAssociativePointer(&_hash, element->key, element, true);
-        delete found;
-        match = true;
-      }
-
-      return TRI_ERROR_NO_ERROR;
-    }
-
-    bool keyRemove (std::string const& key) {
-      KeySpaceElement* found = nullptr;
-
-      {
-        WRITE_LOCKER(_lock);
-
-        found = static_cast<KeySpaceElement*>(TRI_RemoveKeyAssociativePointer(&_hash, key.c_str()));
-      }
-
-      if (found != nullptr) {
-        delete found;
-        return true;
-      }
-
-      return false;
-    }
- 
-    bool keyExists (std::string const& key) {
-      READ_LOCKER(_lock);
-
-      return (TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()) != nullptr);
-    }
- 
-    int keyIncr (std::string const& key,
-                 double value,
-                 double& result) {
-      WRITE_LOCKER(_lock);
-
-      auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-      if (found == nullptr) {
-        auto element = new KeySpaceElement(key.c_str(), key.size(), TRI_CreateNumberJson(TRI_UNKNOWN_MEM_ZONE, value));
-
-        if (TRI_InsertKeyAssociativePointer(&_hash, element->key, static_cast<void*>(element), false) != TRI_ERROR_NO_ERROR) {
-          delete element;
-          return TRI_ERROR_OUT_OF_MEMORY;
-        }
-        result = value;
-      }
-      else {
-        TRI_json_t* current = found->json;
-
-        if (! TRI_IsNumberJson(current)) {
-          // TODO: change error code
-          return TRI_ERROR_ILLEGAL_NUMBER;
-        }
-
-        result = current->_value._number += value;
-      }
-
-      return TRI_ERROR_NO_ERROR;
-    }
-
-    int keyPush (v8::Isolate* isolate,
-                 std::string const& key,
-                 v8::Handle<v8::Value> const& value) {
-      WRITE_LOCKER(_lock);
-
-      auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-      if (found == nullptr) {
-        TRI_json_t* list = TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 1);
-
-        if (list == nullptr) {
-          return TRI_ERROR_OUT_OF_MEMORY;
-        }
-
-        if (TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, list, TRI_ObjectToJson(isolate, value)) != TRI_ERROR_NO_ERROR) {
-          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, list);
-          return TRI_ERROR_OUT_OF_MEMORY;
-        }
-
-        auto element = new KeySpaceElement(key.c_str(), key.size(), list);
-
-        if (TRI_InsertKeyAssociativePointer(&_hash, element->key, static_cast<void*>(element), false) != TRI_ERROR_NO_ERROR) {
-          delete element;
-          return TRI_ERROR_OUT_OF_MEMORY;
-        }
-      }
-      else {
-        TRI_json_t* current = found->json;
-
-        if (! TRI_IsArrayJson(current)) {
-          // TODO: change error code
-          return TRI_ERROR_INTERNAL;
-        }
-
-        if (TRI_PushBack3ArrayJson(TRI_UNKNOWN_MEM_ZONE, current, TRI_ObjectToJson(isolate, value)) != TRI_ERROR_NO_ERROR) {
-          return TRI_ERROR_OUT_OF_MEMORY;
-        }
-      }
-
-      return TRI_ERROR_NO_ERROR;
-    }
-
-    void keyPop (const v8::FunctionCallbackInfo<v8::Value>& args, std::string const& key) {
-      v8::Isolate* isolate = args.GetIsolate();
-      v8::HandleScope scope(isolate);
-      WRITE_LOCKER(_lock);
-
-      auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-      if (found == nullptr) {
-        // TODO: change error code
-        TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL); 
-      }
-        
-      TRI_json_t* current = found->json;
-
-      if (! TRI_IsArrayJson(current)) {
-        // TODO: change error code
-        TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL); 
-      }
-
-      size_t const n = TRI_LengthVector(&current->_value._objects);
-
-      if (n == 0) {
-        TRI_V8_RETURN_UNDEFINED();
-      }
-
-      TRI_json_t* item = static_cast<TRI_json_t*>(TRI_AtVector(&current->_value._objects, n - 1));
-      // hack: decrease the vector size
-      --current->_value._objects._length;
-
-      v8::Handle<v8::Value> result = TRI_ObjectJson(isolate, item);
-      TRI_DestroyJson(TRI_UNKNOWN_MEM_ZONE, item);
-
-      TRI_V8_RETURN(result);
-    }
-
-    void keyTransfer (const v8::FunctionCallbackInfo<v8::Value>& args,
-                      std::string const& keyFrom,
-                      std::string const& keyTo) {
-      v8::Isolate* isolate = args.GetIsolate();
-      v8::HandleScope scope(isolate);
-
-      WRITE_LOCKER(_lock);
-
-      auto source = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, keyFrom.c_str()));
-
-      if (source == nullptr) {
-        TRI_V8_RETURN_UNDEFINED();
-      }
-        
-      TRI_json_t* current = source->json;
-
-      if (! TRI_IsArrayJson(current)) {
-        // TODO: change error code
-        TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL); 
-      }
-
-      size_t const n = TRI_LengthVector(&source->json->_value._objects);
-
-      if (n == 0) {
-        TRI_V8_RETURN_UNDEFINED();
-      }
-
-      TRI_json_t* sourceItem = static_cast<TRI_json_t*>(TRI_AtVector(&source->json->_value._objects, n - 1));
-
-      auto dest = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, keyTo.c_str()));
-
-      if (dest == nullptr) {
-        TRI_json_t* list = TRI_CreateArrayJson(TRI_UNKNOWN_MEM_ZONE, 1);
-
-        if (list == nullptr) {
-          TRI_V8_THROW_EXCEPTION_MEMORY();
-        }
-
-        TRI_PushBack2ArrayJson(list, sourceItem);
- 
-        try {
-          auto element = new KeySpaceElement(keyTo.c_str(), keyTo.size(), list);
-          TRI_InsertKeyAssociativePointer(&_hash, element->key, element, false);
-          // hack: decrease the vector size
-          --current->_value._objects._length;
-        
-          TRI_V8_RETURN(TRI_ObjectJson(isolate, sourceItem));
-        }
-        catch (...) {
-          TRI_V8_THROW_EXCEPTION_MEMORY();
-        }
-      }
-
-      if (! TRI_IsArrayJson(dest->json)) {
-        // TODO: change error code
-        TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL); 
-      }
-
-      TRI_PushBack2ArrayJson(dest->json, sourceItem);
-
-      // hack: decrease the vector size
-      --current->_value._objects._length;
-
-      TRI_V8_RETURN(TRI_ObjectJson(isolate, sourceItem));
-    }
-
-    v8::Handle<v8::Value> keyKeys (v8::Isolate* isolate, std::string const& key) {
-      v8::Handle<v8::Value> result;
-      {
-        READ_LOCKER(_lock);
-
-        auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-        if (found == nullptr) {
-          result = v8::Undefined(isolate);
-        }
-        else {
-          result = TRI_KeysJson(isolate, found->json);
-        }
-      }
-
-      return result;
-    }
-
-    v8::Handle<v8::Value> keyValues (v8::Isolate* isolate,
-                                     std::string const& key) {
-      v8::EscapableHandleScope scope(isolate);
-      v8::Handle<v8::Value> result;
-      {
-        READ_LOCKER(_lock);
-
-        auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-        if (found == nullptr) {
-          result = v8::Undefined(isolate);
-        }
-        else {
-          result = TRI_ValuesJson(isolate, found->json);
-        }
-      }
-
-      return scope.Escape<v8::Value>(result);
-    }
-
-    void keyGetAt (const v8::FunctionCallbackInfo<v8::Value>& args,
-                   std::string const& key,
-                   int64_t index) {
-      v8::Isolate* isolate = args.GetIsolate();
-      v8::HandleScope scope(isolate);
-
-      v8::Handle<v8::Value> result;
-      {
-        READ_LOCKER(_lock);
-
-        auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-        if (found == nullptr) {
-          result = v8::Undefined(isolate);
-        }
-        else {
-          if (! TRI_IsArrayJson(found->json)) {
-            // TODO: change error code
-            TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL); 
-          }
-
-          size_t const n = found->json->_value._objects._length;
-          if (index < 0) {
-            index = static_cast<int64_t>(n) + index;
-          }
-
-          if (index >= static_cast<int64_t>(n)) {
-            result = v8::Undefined(isolate);
-          }
-          else {
-            auto item = static_cast<TRI_json_t const*>(TRI_AtVector(&found->json->_value._objects, static_cast<size_t>(index)));
-            result = TRI_ObjectJson(isolate, item);
-          }
-        }
-      }
-
-      TRI_V8_RETURN(result);
-    }
-    
-    bool keySetAt (v8::Isolate* isolate,
-                   std::string const& key,
-                   int64_t index,
-                   v8::Handle<v8::Value> const& value) {
-      WRITE_LOCKER(_lock);
-
-      auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-
-      if (found == nullptr) {
-        // TODO: change error code
-        return false;
-      }
-      else {
-        if (! TRI_IsArrayJson(found->json)) {
-          // TODO: change error code
-          return false;
-        }
-
-        size_t const n = found->json->_value._objects._length;
-        if (index < 0) {
-          // TODO: change error code
-          return false;
-        }
-
-        auto json = TRI_ObjectToJson(isolate, value);
-        if (json == nullptr) {
-          // TODO: change error code
-          return false;
-        }
-
-        if (index >= static_cast<int64_t>(n)) {
-          // insert new element
-          TRI_InsertVector(&found->json->_value._objects, json, static_cast<size_t>(index)); 
-        }
-        else {
-          // overwrite existing element
-          auto item = static_cast<TRI_json_t*>(TRI_AtVector(&found->json->_value._objects, static_cast<size_t>(index)));
-          if (item != nullptr) {
-            TRI_DestroyJson(TRI_UNKNOWN_MEM_ZONE, item);
-          }
-
-          TRI_SetVector(&found->json->_value._objects, static_cast<size_t>(index), json); 
-        }
-
-        // only free pointer to json, but not its internal structures
-        TRI_Free(TRI_UNKNOWN_MEM_ZONE, json);
-      }
-
-      return true; 
-    }
-
-    char const* keyType (std::string const& key) {
-      READ_LOCKER(_lock);
-
-      void* found = TRI_LookupByKeyAssociativePointer(&_hash, key.c_str());
-
-      if (found != nullptr) {
-        TRI_json_t const* value = static_cast<KeySpaceElement*>(found)->json;
-
-        switch (value->_type) {
-          case TRI_JSON_NULL:
-            return "null";
-          case TRI_JSON_BOOLEAN:
-            return "boolean";
-          case TRI_JSON_NUMBER:
-            return "number";
-          case TRI_JSON_STRING:
-          case TRI_JSON_STRING_REFERENCE:
-            return "string";
-          case TRI_JSON_ARRAY:
-            return "list";
-          case TRI_JSON_OBJECT:
-            return "object";
-          case TRI_JSON_UNUSED:
-            break;
-        }
-      }
-
-      return "undefined";
-    }
-
-    void keyMerge (const v8::FunctionCallbackInfo<v8::Value>& args,
-                   std::string const& key,
-                   v8::Handle<v8::Value> const& value,
-                   bool nullMeansRemove) {
-      v8::Isolate* isolate = args.GetIsolate();
-      v8::HandleScope scope(isolate);
-
-      if (! value->IsObject() || value->IsArray()) {
-        // TODO: change error code
-        TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-      }
-
-      WRITE_LOCKER(_lock);
- 
-      auto found = static_cast<KeySpaceElement*>(TRI_LookupByKeyAssociativePointer(&_hash, key.c_str()));
-   
-      if (found == nullptr) {
-        auto element = new KeySpaceElement(key.c_str(), key.size(), TRI_ObjectToJson(isolate, value));
-        TRI_InsertKeyAssociativePointer(&_hash, element->key, element, false);
-
-        TRI_V8_RETURN(value);
-      }
-
-      if (! TRI_IsObjectJson(found->json)) {
-        // TODO: change error code
-        TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-      }
-
-      TRI_json_t* other = TRI_ObjectToJson(isolate, value);
-
-      if (other == nullptr) {
-        TRI_V8_THROW_EXCEPTION_MEMORY();
-      }
-
-      TRI_json_t* merged = TRI_MergeJson(TRI_UNKNOWN_MEM_ZONE, found->json, other, nullMeansRemove, false); 
-      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, other);
-
-      if (merged == nullptr) {
-        TRI_V8_THROW_EXCEPTION_MEMORY();
-      }
-
-      found->setValue(merged);
- 
-      TRI_V8_RETURN(TRI_ObjectJson(isolate, merged));
-    }
-
-  private:
-        
-    triagens::basics::ReadWriteLock _lock; 
-    TRI_associative_pointer_t       _hash;
-   
-};
-
-// -----------------------------------------------------------------------------
-// --SECTION--                                             struct UserStructures
-// -----------------------------------------------------------------------------
-
-struct UserStructures {
-  struct {
-    triagens::basics::ReadWriteLock              lock; 
-    std::unordered_map<std::string, KeySpace*>   data;
-  }
-  hashes;
-};
+using triagens::arango::KeySpace;
+using triagens::arango::KeySpaces;
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private functions
@@ -833,19 +54,30 @@ static inline TRI_vocbase_t* GetContextVocBase (v8::Isolate* isolate) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief finds a hash array by name
-/// note that at least the read-lock must be held to use this function
+/// @brief finds a keyspace by name
+////////////////////////////////////////////////////////////////////////////////
+
+static std::shared_ptr<KeySpace> GetKeySpace (TRI_vocbase_t* vocbase,
+                                              std::string const& name) {
+  return static_cast<KeySpaces*>(vocbase->_userStructures)->get(name);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts a value handed out by a keyspace and frees it
 ////////////////////////////////////////////////////////////////////////////////
 
-static KeySpace* GetKeySpace (TRI_vocbase_t* vocbase,
-                                std::string const& name) {
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  auto it = h->data.find(name);
+static v8::Handle<v8::Value> ConvertJson (v8::Isolate* isolate,
+                                          TRI_json_t* json) {
+  v8::EscapableHandleScope scope(isolate);
 
-  if (it != h->data.end()) {
-    return (*it).second;
+  if (json == nullptr) {
+    return scope.Escape<v8::Value>(v8::Undefined(isolate));
   }
-  return nullptr;
+
+  v8::Handle<v8::Value> result = TRI_ObjectJson(isolate, json);
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+  return scope.Escape<v8::Value>(result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -882,27 +114,20 @@ static void JS_KeyspaceCreate (const v8::FunctionCallbackInfo<v8::Value>& args)
     ignoreExisting = TRI_ObjectToBoolean(args[2]);
   }
 
-  std::unique_ptr<KeySpace> ptr(new KeySpace(static_cast<uint32_t>(size)));
-
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  {
-    WRITE_LOCKER(h->lock);
+  int res;
 
-    auto hash = GetKeySpace(vocbase, name);
+  try {
+    res = static_cast<KeySpaces*>(vocbase->_userStructures)->create(name, static_cast<uint32_t>(size), ignoreExisting);
+  }
+  catch (triagens::basics::Exception const& ex) {
+    res = ex.code();
+  }
+  catch (...) {
+    res = TRI_ERROR_OUT_OF_MEMORY;
+  }
 
-    if (hash != nullptr) {
-      if (! ignoreExisting) {
-        // TODO: change error code
-        TRI_V8_THROW_EXCEPTION_MESSAGE(TRI_ERROR_INTERNAL, "hash already exists");
-      }
-    }
-   
-    try { 
-      h->data.emplace(std::make_pair(name, ptr.release()));
-    }
-    catch (...) {
-      TRI_V8_THROW_EXCEPTION_MEMORY();
-    }
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_V8_THROW_EXCEPTION(res);
   }
 
   TRI_V8_RETURN_TRUE();
@@ -929,19 +154,10 @@ static void JS_KeyspaceDrop (const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   std::string const&& name = TRI_ObjectToString(args[0]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  {
-    WRITE_LOCKER(h->lock);
-
-    auto it = h->data.find(name);
+  int res = static_cast<KeySpaces*>(vocbase->_userStructures)->drop(name);
 
-    if (it == h->data.end()) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
-
-    delete (*it).second;
-    h->data.erase(it);
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_V8_THROW_EXCEPTION(res);
   }
 
   TRI_V8_RETURN_TRUE();
@@ -968,25 +184,20 @@ static void JS_KeyspaceCount (const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   std::string const&& name = TRI_ObjectToString(args[0]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  uint32_t count; 
-  {
-    READ_LOCKER(h->lock);
+  auto hash = GetKeySpace(vocbase, name);
 
-    auto hash = GetKeySpace(vocbase, name);
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
 
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
-  
-    if (args.Length() > 1) {
-      std::string const&& prefix = TRI_ObjectToString(args[1]);
-      count = hash->keyspaceCount(prefix);
-    }
-    else {
-      count = hash->keyspaceCount();
-    }
+  uint32_t count;
+
+  if (args.Length() > 1) {
+    std::string const&& prefix = TRI_ObjectToString(args[1]);
+    count = hash->count(prefix.c_str());
+  }
+  else {
+    count = hash->count();
   }
 
   TRI_V8_RETURN(v8::Number::New(isolate, static_cast<int>(count)));
@@ -1013,12 +224,7 @@ static void JS_KeyspaceExists (const v8::FunctionCallbackInfo<v8::Value>& args)
 
   std::string const&& name = TRI_ObjectToString(args[0]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-   
-  READ_LOCKER(h->lock);
-  auto hash = GetKeySpace(vocbase, name);
-
-  if (hash != nullptr) {
+  if (GetKeySpace(vocbase, name) != nullptr) {
     TRI_V8_RETURN_TRUE();
   }
   else {
@@ -1047,22 +253,30 @@ static void JS_KeyspaceKeys (const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   std::string const&& name = TRI_ObjectToString(args[0]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
+  std::vector<std::string> keys;
+
   if (args.Length() > 1) {
     std::string const&& prefix = TRI_ObjectToString(args[1]);
-    TRI_V8_RETURN(hash->keyspaceKeys(isolate, prefix));
+    keys = hash->keys(prefix.c_str());
+  }
+  else {
+    keys = hash->keys();
+  }
+
+  v8::Handle<v8::Array> result = v8::Array::New(isolate, static_cast<int>(keys.size()));
+  uint32_t count = 0;
+
+  for (auto const& key : keys) {
+    result->Set(count++, TRI_V8_STD_STRING(key));
   }
 
-  TRI_V8_RETURN(hash->keyspaceKeys(isolate));
+  TRI_V8_RETURN(result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1086,22 +300,18 @@ static void JS_KeyspaceGet (const v8::FunctionCallbackInfo<v8::Value>& args) {
 
   std::string const&& name = TRI_ObjectToString(args[0]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
   if (args.Length() > 1) {
     std::string const&& prefix = TRI_ObjectToString(args[1]);
-    TRI_V8_RETURN(hash->keyspaceGet(isolate, prefix));
+    TRI_V8_RETURN(ConvertJson(isolate, hash->get(prefix.c_str())));
   }
 
-  TRI_V8_RETURN(hash->keyspaceGet(isolate));
+  TRI_V8_RETURN(ConvertJson(isolate, hash->get()));
 }
 
 
@@ -1126,22 +336,23 @@ static void JS_KeyspaceRemove (const v8::FunctionCallbackInfo<v8::Value>& args)
 
   std::string const&& name = TRI_ObjectToString(args[0]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
+  uint32_t deleted;
+
   if (args.Length() > 1) {
     std::string const&& prefix = TRI_ObjectToString(args[1]);
-    TRI_V8_RETURN(hash->keyspaceRemove(isolate, prefix));
+    deleted = hash->remove(prefix.c_str());
+  }
+  else {
+    deleted = hash->remove();
   }
 
-  TRI_V8_RETURN(hash->keyspaceRemove(isolate));
+  TRI_V8_RETURN(v8::Number::New(isolate, static_cast<int>(deleted)));
 }
 
 
@@ -1167,22 +378,13 @@ static void JS_KeyGet (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  v8::Handle<v8::Value> result;
-  {
-    READ_LOCKER(h->lock);
-
-    auto hash = GetKeySpace(vocbase, name);
-
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
+  auto hash = GetKeySpace(vocbase, name);
 
-    result = hash->keyGet(isolate, key);
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  TRI_V8_RETURN(result);
+  TRI_V8_RETURN(ConvertJson(isolate, hash->keyGet(key)));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1195,7 +397,7 @@ static void JS_KeySet (const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 
   if (args.Length() < 3 || ! args[0]->IsString() || ! args[1]->IsString()) {
-    TRI_V8_THROW_EXCEPTION_USAGE("KEY_SET(<name>, <key>, <value>, <replace>)");
+    TRI_V8_THROW_EXCEPTION_USAGE("KEY_SET(<name>, <key>, <value>, <replace>, <ttl>)");
   }
 
   TRI_vocbase_t* vocbase = GetContextVocBase(isolate);
@@ -1212,22 +414,25 @@ static void JS_KeySet (const v8::FunctionCallbackInfo<v8::Value>& args) {
     replace = TRI_ObjectToBoolean(args[3]);
   }
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  bool result;
-  {
-    READ_LOCKER(h->lock);
+  double ttl = 0.0;
 
-    auto hash = GetKeySpace(vocbase, name);
+  if (args.Length() > 4) {
+    ttl = TRI_ObjectToDouble(args[4]);
+  }
 
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
+  auto hash = GetKeySpace(vocbase, name);
+
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
+
+  TRI_json_t* json = TRI_ObjectToJson(isolate, args[2]);
 
-    result = hash->keySet(isolate, key, args[2], replace);
+  if (json == nullptr) {
+    TRI_V8_THROW_EXCEPTION_MEMORY();
   }
 
-  if (result) {
+  if (hash->keySet(key, json, replace, ttl)) {
     TRI_V8_RETURN_TRUE();
   }
   else {
@@ -1258,24 +463,37 @@ static void JS_KeySetCas (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& key  = TRI_ObjectToString(args[1]);
 
   if (args[2]->IsUndefined()) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_NO_VALUE);
   }
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  int res;
-  bool match = false;
-  {
-    READ_LOCKER(h->lock);
+  auto hash = GetKeySpace(vocbase, name);
+
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
+
+  TRI_json_t* json = TRI_ObjectToJson(isolate, args[2]);
+
+  if (json == nullptr) {
+    TRI_V8_THROW_EXCEPTION_MEMORY();
+  }
+
+  TRI_json_t* compare = nullptr;
 
-    auto hash = GetKeySpace(vocbase, name);
+  if (! args[3]->IsUndefined()) {
+    compare = TRI_ObjectToJson(isolate, args[3]);
 
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    if (compare == nullptr) {
+      TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+      TRI_V8_THROW_EXCEPTION_MEMORY();
     }
+  }
+
+  bool match = false;
+  int res = hash->keyCas(key, json, compare, match);
 
-    res = hash->keyCas(isolate, key, args[2], args[3], match);
+  if (compare != nullptr) {
+    TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, compare);
   }
 
   if (res != TRI_ERROR_NO_ERROR) {
@@ -1308,26 +526,17 @@ static void JS_KeyRemove (const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (vocbase == nullptr) {
     TRI_V8_THROW_EXCEPTION_INTERNAL("cannot extract vocbase");
   }
-  
+
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
- 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  bool result; 
-  {
-    READ_LOCKER(h->lock);
-
-    auto hash = GetKeySpace(vocbase, name);
 
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
+  auto hash = GetKeySpace(vocbase, name);
 
-    result = hash->keyRemove(key);
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  if (result) {
+  if (hash->keyRemove(key)) {
     TRI_V8_RETURN_TRUE();
   }
   else {
@@ -1353,26 +562,17 @@ static void JS_KeyExists (const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (vocbase == nullptr) {
     TRI_V8_THROW_EXCEPTION_INTERNAL("cannot extract vocbase");
   }
-  
+
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
- 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  bool result; 
-  {
-    READ_LOCKER(h->lock);
-
-    auto hash = GetKeySpace(vocbase, name);
 
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
+  auto hash = GetKeySpace(vocbase, name);
 
-    result = hash->keyExists(key);
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  if (result) {
+  if (hash->keyExists(key)) {
     TRI_V8_RETURN_TRUE();
   }
   else {
@@ -1390,11 +590,11 @@ static void JS_KeyIncr (const v8::FunctionCallbackInfo<v8::Value>& args) {
 
 
   if (args.Length() < 2 || ! args[0]->IsString() || ! args[1]->IsString()) {
-    TRI_V8_THROW_EXCEPTION_USAGE("KEY_INCR(<name>, <key>, <value>)");
+    TRI_V8_THROW_EXCEPTION_USAGE("KEY_INCR(<name>, <key>, <value>, <ttl>)");
   }
 
   if (args.Length() >= 3 && ! args[2]->IsNumber()) {
-    TRI_V8_THROW_EXCEPTION_USAGE("KEY_INCR(<name>, <key>, <value>)");
+    TRI_V8_THROW_EXCEPTION_USAGE("KEY_INCR(<name>, <key>, <value>, <ttl>)");
   }
 
   TRI_vocbase_t* vocbase = GetContextVocBase(isolate);
@@ -1412,23 +612,23 @@ static void JS_KeyIncr (const v8::FunctionCallbackInfo<v8::Value>& args) {
     incr = TRI_ObjectToDouble(args[2]);
   }
 
-  double result;
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  {
-    READ_LOCKER(h->lock);
+  double ttl = 0.0;
 
-    auto hash = GetKeySpace(vocbase, name);
+  if (args.Length() >= 4) {
+    ttl = TRI_ObjectToDouble(args[3]);
+  }
 
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
+  auto hash = GetKeySpace(vocbase, name);
 
-    int res = hash->keyIncr(key, incr, result);
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
 
-    if (res != TRI_ERROR_NO_ERROR) {
-      TRI_V8_THROW_EXCEPTION(res);
-    }
+  double result;
+  int res = hash->keyIncr(key, incr, ttl, result);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_V8_THROW_EXCEPTION(res);
   }
 
   TRI_V8_RETURN(v8::Number::New(isolate, result));
@@ -1461,17 +661,30 @@ static void JS_KeyUpdate (const v8::FunctionCallbackInfo<v8::Value>& args) {
     nullMeansRemove = TRI_ObjectToBoolean(args[3]);
   }
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
+  if (! args[2]->IsObject() || args[2]->IsArray()) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_TYPE_ERROR);
+  }
 
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
+
+  TRI_json_t* json = TRI_ObjectToJson(isolate, args[2]);
+
+  if (json == nullptr) {
+    TRI_V8_THROW_EXCEPTION_MEMORY();
+  }
+
+  TRI_json_t* merged = nullptr;
+  int res = hash->keyMerge(key, json, nullMeansRemove, merged);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_V8_THROW_EXCEPTION(res);
   }
 
-  hash->keyMerge(args, key, args[2], nullMeansRemove);
+  TRI_V8_RETURN(ConvertJson(isolate, merged));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1496,17 +709,22 @@ static void JS_KeyKeys (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  TRI_V8_RETURN(hash->keyKeys(isolate, key));
+  TRI_json_t* json = hash->keyGet(key);
+
+  if (json == nullptr) {
+    TRI_V8_RETURN_UNDEFINED();
+  }
+
+  v8::Handle<v8::Value> result = TRI_KeysJson(isolate, json);
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+  TRI_V8_RETURN(result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1531,17 +749,22 @@ static void JS_KeyValues (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  TRI_V8_RETURN(hash->keyValues(isolate, key));
+  TRI_json_t* json = hash->keyGet(key);
+
+  if (json == nullptr) {
+    TRI_V8_RETURN_UNDEFINED();
+  }
+
+  v8::Handle<v8::Value> result = TRI_ValuesJson(isolate, json);
+  TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+  TRI_V8_RETURN(result);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1566,17 +789,19 @@ static void JS_KeyPush (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  int res = hash->keyPush(isolate, key, args[2]);
+  TRI_json_t* json = TRI_ObjectToJson(isolate, args[2]);
+
+  if (json == nullptr) {
+    TRI_V8_THROW_EXCEPTION_MEMORY();
+  }
+
+  int res = hash->keyPush(key, json);
 
   if (res != TRI_ERROR_NO_ERROR) {
     TRI_V8_THROW_EXCEPTION(res);
@@ -1607,17 +832,20 @@ static void JS_KeyPop (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
+
+  TRI_json_t* item = nullptr;
+  int res = hash->keyPop(key, item);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_V8_THROW_EXCEPTION(res);
   }
 
-  hash->keyPop(args, key);
+  TRI_V8_RETURN(ConvertJson(isolate, item));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1643,17 +871,20 @@ static void JS_KeyTransfer (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& keyFrom = TRI_ObjectToString(args[1]);
   std::string const&& keyTo   = TRI_ObjectToString(args[2]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  hash->keyTransfer(args, keyFrom, keyTo);
+  TRI_json_t* item = nullptr;
+  int res = hash->keyTransfer(keyFrom, keyTo, item);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_V8_THROW_EXCEPTION(res);
+  }
+
+  TRI_V8_RETURN(ConvertJson(isolate, item));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1679,17 +910,20 @@ static void JS_KeyGetAt (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& key  = TRI_ObjectToString(args[1]);
   int64_t offset = TRI_ObjectToInt64(args[2]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
+
+  TRI_json_t* item = nullptr;
+  int res = hash->keyGetAt(key, offset, item);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    TRI_V8_THROW_EXCEPTION(res);
   }
 
-  hash->keyGetAt(args, key, offset);
+  TRI_V8_RETURN(ConvertJson(isolate, item));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1715,17 +949,20 @@ static void JS_KeySetAt (const v8::FunctionCallbackInfo<v8::Value>& args) {
   std::string const&& key  = TRI_ObjectToString(args[1]);
   int64_t offset = TRI_ObjectToInt64(args[2]);
 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  READ_LOCKER(h->lock);
-
   auto hash = GetKeySpace(vocbase, name);
 
   if (hash == nullptr) {
-    // TODO: change error code
-    TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
+  }
+
+  TRI_json_t* json = TRI_ObjectToJson(isolate, args[3]);
+
+  if (json == nullptr) {
+    TRI_V8_THROW_EXCEPTION_MEMORY();
   }
 
-  int res = hash->keySetAt(isolate, key, offset, args[3]);
+  int res = hash->keySetAt(key, offset, json);
+
   if (res != TRI_ERROR_NO_ERROR) {
     TRI_V8_THROW_EXCEPTION(res);
   }
@@ -1751,26 +988,17 @@ static void JS_KeyType (const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (vocbase == nullptr) {
     TRI_V8_THROW_EXCEPTION_INTERNAL("cannot extract vocbase");
   }
-  
+
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
- 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  char const* result; 
-  {
-    READ_LOCKER(h->lock);
-
-    auto hash = GetKeySpace(vocbase, name);
 
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
+  auto hash = GetKeySpace(vocbase, name);
 
-    result = hash->keyType(key);
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  TRI_V8_RETURN_STRING(result);
+  TRI_V8_RETURN_STRING(hash->keyType(key));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1791,27 +1019,19 @@ static void JS_KeyCount (const v8::FunctionCallbackInfo<v8::Value>& args) {
   if (vocbase == nullptr) {
     TRI_V8_THROW_EXCEPTION_INTERNAL("cannot extract vocbase");
   }
-  
+
   std::string const&& name = TRI_ObjectToString(args[0]);
   std::string const&& key  = TRI_ObjectToString(args[1]);
- 
-  auto h = &(static_cast<UserStructures*>(vocbase->_userStructures)->hashes);
-  uint32_t result; 
-  bool valid;
-  {
-    READ_LOCKER(h->lock);
-
-    auto hash = GetKeySpace(vocbase, name);
-
-    if (hash == nullptr) {
-      // TODO: change error code
-      TRI_V8_THROW_EXCEPTION(TRI_ERROR_INTERNAL);
-    }
 
-    valid = hash->keyCount(key, result);
+  auto hash = GetKeySpace(vocbase, name);
+
+  if (hash == nullptr) {
+    TRI_V8_THROW_EXCEPTION(TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND);
   }
 
-  if (valid) {
+  uint32_t result;
+
+  if (hash->keyCount(key, result)) {
     TRI_V8_RETURN(v8::Number::New(isolate, result));
   }
 
@@ -1830,7 +1050,7 @@ void TRI_CreateUserStructuresVocBase (TRI_vocbase_t* vocbase) {
   TRI_ASSERT(vocbase != nullptr);
   TRI_ASSERT(vocbase->_userStructures == nullptr);
 
-  vocbase->_userStructures = new UserStructures;
+  vocbase->_userStructures = new KeySpaces;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1839,13 +1059,8 @@ void TRI_CreateUserStructuresVocBase (TRI_vocbase_t* vocbase) {
 
 void TRI_FreeUserStructuresVocBase (TRI_vocbase_t* vocbase) {
   if (vocbase->_userStructures != nullptr) {
-    auto us = static_cast<UserStructures*>(vocbase->_userStructures);
-    for (auto& hash : us->hashes.data) {
-      if (hash.second != nullptr) {
-        delete hash.second;
-      }
-    }    
-    delete us;
+    delete static_cast<KeySpaces*>(vocbase->_userStructures);
+    vocbase->_userStructures = nullptr;
   }
 }
 
@@ -1858,7 +1073,7 @@ void TRI_InitV8UserStructures (v8::Isolate* isolate,
   v8::HandleScope scope(isolate);
 
 
-  // NOTE: the following functions are all experimental and might 
+  // NOTE: the following functions are all experimental and might
   // change without further notice
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("KEYSPACE_CREATE"), JS_KeyspaceCreate, true);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("KEYSPACE_DROP"), JS_KeyspaceDrop, true);
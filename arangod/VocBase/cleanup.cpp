@@ -33,6 +33,7 @@
 #include "Basics/logging.h"
 #include "Basics/tri-strings.h"
 #include "Utils/CursorRepository.h"
+#include "Utils/KeySpaces.h"
 #include "VocBase/barrier.h"
 #include "VocBase/compactor.h"
 #include "VocBase/document-collection.h"
@@ -246,6 +247,29 @@ static void CleanupCursors (TRI_vocbase_t* vocbase,
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes expired keys from the keyspaces
+////////////////////////////////////////////////////////////////////////////////
+
+static void CleanupKeySpaces (TRI_vocbase_t* vocbase) {
+  auto keySpaces = static_cast<triagens::arango::KeySpaces*>(vocbase->_userStructures);
+
+  if (keySpaces == nullptr) {
+    return;
+  }
+
+  try {
+    uint32_t expired = keySpaces->expire();
+
+    if (expired > 0) {
+      LOG_TRACE("removed %lu expired keys from keyspaces", (unsigned long) expired);
+    }
+  }
+  catch (...) {
+    LOG_WARNING("caught exception during keyspace cleanup");
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  public functions
 // -----------------------------------------------------------------------------
@@ -330,6 +354,10 @@ void TRI_CleanupVocBase (void* data) {
         TRI_CleanupCompactorVocBase(vocbase);
       }
 
+      // remove expired keys in every iteration, so they do not linger
+      // much longer than their time-to-live
+      CleanupKeySpaces(vocbase);
+
       if (state == 1) {
         TRI_LockCondition(&vocbase->_cleanupCondition);
         TRI_TimedWaitCondition(&vocbase->_cleanupCondition, (uint64_t) CLEANUP_INTERVAL);
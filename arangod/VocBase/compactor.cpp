@@ -36,6 +36,7 @@
 #include "Basics/conversions.h"
 #include "Basics/files.h"
 #include "Basics/logging.h"
+#include "Basics/MutexLocker.h"
 #include "Basics/tri-strings.h"
 #include "Utils/transactions.h"
 #include "VocBase/document-collection.h"
@@ -95,6 +96,18 @@
 
 #define COMPACTOR_MIN_SIZE (128 * 1024)
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief amount of data (in bytes) inspected while holding the collection's
+/// compaction lock and write lock
+///
+/// the compactor releases the locks after each batch, so readers and writers
+/// of the collection are not blocked while a complete datafile is copied. if
+/// the locks cannot be acquired instantly for a batch, the compaction is
+/// continued with this batch in the compactor's next pass
+////////////////////////////////////////////////////////////////////////////////
+
+#define COMPACTOR_BATCH_SIZE (1024 * 1024)
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief re-try compaction of a specific collection in this interval (in s)
 ////////////////////////////////////////////////////////////////////////////////
@@ -107,6 +120,29 @@
 
 static int const COMPACTOR_INTERVAL = (1 * 1000 * 1000);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum number of bytes per second copied by all compactors,
+/// 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<uint64_t> IoLimit(0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief mutex protecting NextCopyTime
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::basics::Mutex ThrottleLock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief point in time at which the compactors may continue copying
+////////////////////////////////////////////////////////////////////////////////
+
+static double NextCopyTime = 0.0;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                     private types
 // -----------------------------------------------------------------------------
@@ -142,7 +178,12 @@ typedef struct compaction_context_s {
   TRI_document_collection_t* _document;
   TRI_datafile_t*            _compactor;
   TRI_doc_datafile_info_t    _dfi;
+  int64_t                    _batchSize;   // bytes inspected in the current batch
+  int64_t                    _copied;      // bytes written to the compactor
+  size_t                     _offset;      // offset of the next marker in the current datafile
   bool                       _keepDeletions;
+  bool                       _locked;
+  bool                       _interrupted;
 }
 compaction_context_t;
 
@@ -156,6 +197,22 @@ typedef struct compaction_info_s {
 }
 compaction_info_t;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compaction of a collection that is continued in the next pass
+///
+/// the state is kept in the collection until all datafiles were copied and
+/// the compactor file was swapped in. the datafiles to compact cannot vanish
+/// in between, because only the compactor removes datafiles of a loaded
+/// collection
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct TRI_compaction_state_s {
+  TRI_vector_t               _compactions;
+  compaction_context_t       _context;
+  size_t                     _current;     // index of the datafile being compacted
+}
+compaction_state_t;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private functions
 // -----------------------------------------------------------------------------
@@ -402,6 +459,9 @@ static void RenameDatafileCallback (TRI_datafile_t* datafile,
     // put the compactor in place of the datafile
     document->_datafiles._buffer[i] = compactor;
 
+    // documents in datafiles are looked up via the master pointers
+    TRI_AdviseDatafile(compactor, TRI_DF_ACCESS_RANDOM);
+
     // update dfi
     dfi = TRI_FindDatafileInfoDocumentCollection(document, compactor->_fid, false);
 
@@ -598,6 +658,109 @@ static bool Compactifier (TRI_df_marker_t const* marker,
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until copying the given amount of data complies with the I/O
+/// limit
+///
+/// the limit is shared by the compactors of all databases. the wait is cut
+/// short when the database is shut down. the caller must not hold any locks
+////////////////////////////////////////////////////////////////////////////////
+
+static void ThrottleCompaction (TRI_vocbase_t* vocbase,
+                                int64_t size,
+                                double start) {
+  uint64_t const limit = IoLimit.load(std::memory_order_relaxed);
+
+  if (limit == 0 || size <= 0) {
+    return;
+  }
+
+  double end;
+
+  {
+    MUTEX_LOCKER(ThrottleLock);
+
+    if (NextCopyTime < start) {
+      NextCopyTime = start;
+    }
+
+    NextCopyTime += (double) size / (double) limit;
+    end = NextCopyTime;
+  }
+
+  while (vocbase->_state == 1) {
+    double const wait = end - TRI_microtime();
+
+    if (wait <= 0.0) {
+      break;
+    }
+
+    // sleep in small steps so we can react on shutdown
+    usleep(static_cast<unsigned long>((wait < 0.1 ? wait : 0.1) * 1000.0 * 1000.0));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief datafile iterator, runs the compactifier in batches
+///
+/// the collection's compaction lock and write lock are acquired for the first
+/// marker of a batch, and released when the batch is complete. write
+/// transactions hold the compaction lock in read mode, so they can run
+/// between two batches. The compactifier checks and re-points the master
+/// pointer of each marker while holding the locks, so concurrent
+/// modifications between two batches are detected as usual.
+///
+/// if the locks cannot be acquired instantly, the iteration is stopped and
+/// the batch is retried in the next pass, starting at the recorded offset
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CompactifierBatch (TRI_df_marker_t const* marker,
+                               void* data,
+                               TRI_datafile_t* datafile) {
+  compaction_context_t* context = static_cast<compaction_context_t*>(data);
+  TRI_document_collection_t* document = context->_document;
+
+  size_t const offset = static_cast<size_t>(reinterpret_cast<char const*>(marker) - datafile->_data);
+
+  if (offset < context->_offset) {
+    // marker was handled in an earlier pass
+    return true;
+  }
+
+  if (! context->_locked) {
+    if (! TRI_TryWriteLockReadWriteLock(&document->_compactionLock)) {
+      context->_interrupted = true;
+      return false;
+    }
+
+    if (! TRI_TRY_WRITE_LOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document)) {
+      TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
+      context->_interrupted = true;
+      return false;
+    }
+
+    context->_locked = true;
+  }
+
+  TRI_voc_size_t const compactorSize = context->_compactor->_currentSize;
+
+  bool result = Compactifier(marker, data, datafile);
+
+  // only the markers actually copied count for the I/O limit
+  context->_copied += static_cast<int64_t>(context->_compactor->_currentSize - compactorSize);
+  context->_batchSize += AlignedSize(marker);
+  context->_offset = offset + static_cast<size_t>(AlignedSize(marker));
+
+  if (context->_batchSize >= COMPACTOR_BATCH_SIZE) {
+    TRI_WRITE_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+    TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
+    context->_locked = false;
+    context->_batchSize = 0;
+  }
+
+  return result;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief remove an empty compactor file
 ////////////////////////////////////////////////////////////////////////////////
@@ -779,29 +942,42 @@ static compaction_initial_context_t InitCompaction (TRI_document_collection_t* d
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief compact a list of datafiles
+/// @brief free the state of a compaction
 ////////////////////////////////////////////////////////////////////////////////
 
-static void CompactifyDatafiles (TRI_document_collection_t* document,
-                                 TRI_vector_t const* compactions) {
-  TRI_datafile_t* compactor;
-  compaction_initial_context_t initial;
-  compaction_context_t context;
-  size_t i, j, n;
+static void FreeCompactionState (compaction_state_t* state) {
+  TRI_DestroyVector(&state->_compactions);
+  TRI_Free(TRI_UNKNOWN_MEM_ZONE, state);
+}
 
-  n = compactions->_length;
-  TRI_ASSERT(n > 0);
+////////////////////////////////////////////////////////////////////////////////
+/// @brief start the compaction of a list of datafiles
+///
+/// creates the compactor file and returns the state of the compaction, which
+/// takes over the list. returns a nullptr if the compaction cannot be started
+/// now
+////////////////////////////////////////////////////////////////////////////////
 
-  // create a fake transaction
-  triagens::arango::TransactionBase trx(true);
+static compaction_state_t* StartCompaction (TRI_document_collection_t* document,
+                                            TRI_vector_t* compactions) {
+  size_t const n = compactions->_length;
+  TRI_ASSERT(n > 0);
 
+  // the target size depends on the primary index, which must not change
+  // while it is calculated. if writers are active, try again later
+  if (! TRI_TryWriteLockReadWriteLock(&document->_compactionLock)) {
+    TRI_DestroyVector(compactions);
+    return nullptr;
+  }
 
-  initial = InitCompaction(document, compactions);
+  compaction_initial_context_t initial = InitCompaction(document, compactions);
+  TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
 
   if (initial._failed) {
     LOG_ERROR("could not create initialise compaction");
+    TRI_DestroyVector(compactions);
 
-    return;
+    return nullptr;
   }
 
   LOG_TRACE("compactify called for collection '%llu' for %d datafiles of total size %llu",
@@ -809,55 +985,127 @@ static void CompactifyDatafiles (TRI_document_collection_t* document,
             (int) n,
             (unsigned long long) initial._targetSize);
 
+  compaction_state_t* state = static_cast<compaction_state_t*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, sizeof(compaction_state_t), false));
+
+  if (state == nullptr) {
+    TRI_DestroyVector(compactions);
+    return nullptr;
+  }
+
   // now create a new compactor file
   // we are re-using the _fid of the first original datafile!
-  compactor = CreateCompactor(document, initial._fid, initial._targetSize);
+  TRI_datafile_t* compactor = CreateCompactor(document, initial._fid, initial._targetSize);
 
   if (compactor == nullptr) {
     // some error occurred
     LOG_ERROR("could not create compactor file");
+    TRI_DestroyVector(compactions);
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, state);
 
-    return;
+    return nullptr;
   }
 
   LOG_DEBUG("created new compactor file '%s'", compactor->getName(compactor));
 
+  // the state takes over the list of datafiles
+  state->_compactions = *compactions;
+  state->_current     = 0;
+
+  compaction_context_t& context = state->_context;
+
   memset(&context._dfi, 0, sizeof(TRI_doc_datafile_info_t));
   // these attributes remain the same for all datafiles we collect
-  context._document  = document;
-  context._compactor = compactor;
-  context._dfi._fid  = compactor->_fid;
+  context._document    = document;
+  context._compactor   = compactor;
+  context._dfi._fid    = compactor->_fid;
+  context._batchSize   = 0;
+  context._copied      = 0;
+  context._offset      = 0;
+  context._locked      = false;
+  context._interrupted = false;
+
+  return state;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compact a list of datafiles, or continue an earlier compaction
+///
+/// returns true if the compaction is finished, and false if it must be
+/// continued in the next pass. the number of bytes copied is added to copied
+////////////////////////////////////////////////////////////////////////////////
+
+static bool CompactifyDatafiles (TRI_document_collection_t* document,
+                                 compaction_state_t* state,
+                                 int64_t& copied) {
+  TRI_vector_t const* compactions = &state->_compactions;
+  compaction_context_t& context = state->_context;
+  TRI_datafile_t* compactor = context._compactor;
+  size_t i, j, n;
+
+  n = compactions->_length;
+  TRI_ASSERT(n > 0);
+
+  // create a fake transaction
+  triagens::arango::TransactionBase trx(true);
+
+  int64_t const copiedBefore = context._copied;
 
   // now compact all datafiles
-  for (i = 0; i < n; ++i) {
-    compaction_info_t* compaction = static_cast<compaction_info_t*>(TRI_AtVector(compactions, i));
+  for (; state->_current < n; ++state->_current) {
+    compaction_info_t* compaction = static_cast<compaction_info_t*>(TRI_AtVector(compactions, state->_current));
     TRI_datafile_t* df = compaction->_datafile;
 
-    LOG_TRACE("compacting datafile '%s' into '%s', number: %d, keep deletions: %d",
-               df->getName(df),
-               compactor->getName(compactor),
-               (int) i,
-               (int) compaction->_keepDeletions);
+    if (context._offset == 0) {
+      LOG_TRACE("compacting datafile '%s' into '%s', number: %d, keep deletions: %d",
+                 df->getName(df),
+                 compactor->getName(compactor),
+                 (int) state->_current,
+                 (int) compaction->_keepDeletions);
 
-    // if this is the first datafile in the list of datafiles, we can also collect
-    // deletion markers
-    context._keepDeletions = compaction->_keepDeletions;
+      // if this is the first datafile in the list of datafiles, we can also collect
+      // deletion markers
+      context._keepDeletions = compaction->_keepDeletions;
+    }
 
-    TRI_WRITE_LOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
-    
-    // run the actual compaction of a single datafile
-    bool ok = TRI_IterateDatafile(df, Compactifier, &context);
-    
-    TRI_WRITE_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+    // run the actual compaction of a single datafile. the collection is
+    // locked for each batch of markers only
+    TRI_AdviseDatafile(df, TRI_DF_ACCESS_SEQUENTIAL);
+
+    context._interrupted = false;
+    bool ok = TRI_IterateDatafile(df, CompactifierBatch, &context);
+
+    if (context._locked) {
+      TRI_WRITE_UNLOCK_DOCUMENTS_INDEXES_PRIMARY_COLLECTION(document);
+      TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
+      context._locked = false;
+    }
+
+    if (context._interrupted) {
+      // the collection is in use. continue with this batch in the next pass
+      copied += context._copied - copiedBefore;
+      context._batchSize = 0;
+      return false;
+    }
 
     if (! ok) {
       LOG_WARNING("failed to compact datafile '%s'", df->getName(df));
       // compactor file does not need to be removed now. will be removed on next startup
       // TODO: Remove
-      return;
+      copied += context._copied - copiedBefore;
+      return true;
     }
+
+    context._offset = 0;
   } // next file
 
+  copied += context._copied - copiedBefore;
+  context._batchSize = 0;
+
+  // the compactor file replaces the datafiles now. this is done while holding
+  // the compaction lock. if writers are active, try again in the next pass
+  if (! TRI_TryWriteLockReadWriteLock(&document->_compactionLock)) {
+    return false;
+  }
 
   // locate the compactor
   // must acquire a write-lock as we're about to change the datafiles vector
@@ -866,17 +1114,19 @@ static void CompactifyDatafiles (TRI_document_collection_t* document,
   if (! LocateDatafile(&document->_compactors, compactor->_fid, &j)) {
     // not found
     TRI_WRITE_UNLOCK_DATAFILES_DOC_COLLECTION(document);
+    TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
 
     LOG_ERROR("logic error in CompactifyDatafiles: could not find compactor");
-    return;
+    return true;
   }
 
   if (! TRI_CloseDatafileDocumentCollection(document, j, true)) {
     TRI_WRITE_UNLOCK_DATAFILES_DOC_COLLECTION(document);
+    TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
 
     LOG_ERROR("could not close compactor file");
     // TODO: how do we recover from this state?
-    return;
+    return true;
   }
 
   TRI_WRITE_UNLOCK_DATAFILES_DOC_COLLECTION(document);
@@ -974,13 +1224,37 @@ static void CompactifyDatafiles (TRI_document_collection_t* document,
       }
     }
   }
+
+  TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
+
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief checks all datafiles of a collection
+///
+/// the number of bytes copied by the compaction is added to copied
 ////////////////////////////////////////////////////////////////////////////////
 
-static bool CompactifyDocumentCollection (TRI_document_collection_t* document) {
+static bool CompactifyDocumentCollection (TRI_document_collection_t* document,
+                                          int64_t& copied) {
+  compaction_state_t* state = document->_compactionState;
+
+  if (state != nullptr) {
+    // continue the compaction that was interrupted in an earlier pass
+    size_t const current = state->_current;
+    size_t const offset  = state->_context._offset;
+
+    if (CompactifyDatafiles(document, state, copied)) {
+      FreeCompactionState(state);
+      document->_compactionState = nullptr;
+      return true;
+    }
+
+    // no progress means the collection is still busy
+    return (state->_current != current || state->_context._offset != offset);
+  }
+
   // we can hopefully get away without the lock here...
 //  if (! TRI_IsFullyCollectedDocumentCollection(document)) {
 //    return false;
@@ -1131,10 +1405,19 @@ static bool CompactifyDocumentCollection (TRI_document_collection_t* document) {
   // handle datafiles with dead objects
   TRI_ASSERT(vector._length >= 1);
 
-  CompactifyDatafiles(document, &vector);
+  // the state takes over the vector
+  state = StartCompaction(document, &vector);
+
+  if (state == nullptr) {
+    return false;
+  }
 
-  // cleanup local variables
-  TRI_DestroyVector(&vector);
+  if (CompactifyDatafiles(document, state, copied)) {
+    FreeCompactionState(state);
+  }
+  else {
+    document->_compactionState = state;
+  }
 
   return true;
 }
@@ -1203,6 +1486,17 @@ static bool CheckAndLockCompaction (TRI_vocbase_t* vocbase) {
 // --SECTION--                                                  public functions
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the state of an unfinished compaction of a collection
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FreeCompactionStateCompactor (TRI_document_collection_t* document) {
+  if (document->_compactionState != nullptr) {
+    FreeCompactionState(document->_compactionState);
+    document->_compactionState = nullptr;
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief initialise the compaction blockers structure
 ////////////////////////////////////////////////////////////////////////////////
@@ -1371,6 +1665,14 @@ int TRI_RemoveBlockerCompactorVocBase (TRI_vocbase_t* vocbase,
   return TRI_ERROR_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of bytes per second copied by the compactors
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetIoLimitCompactor (uint64_t value) {
+  IoLimit.store(value, std::memory_order_relaxed);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief compactor event loop
 ////////////////////////////////////////////////////////////////////////////////
@@ -1389,84 +1691,88 @@ void TRI_CompactorVocBase (void* data) {
     // keep initial _state value as vocbase->_state might change during compaction loop
     int state = vocbase->_state;
 
-    // check if compaction is currently disallowed
-    if (CheckAndLockCompaction(vocbase)) {
-      // compaction is currently allowed
-      double now = TRI_microtime();
-      numCompacted = 0;
+    numCompacted = 0;
 
-      // copy all collections
-      TRI_READ_LOCK_COLLECTIONS_VOCBASE(vocbase);
-      TRI_CopyDataVectorPointer(&collections, &vocbase->_collections);
-      TRI_READ_UNLOCK_COLLECTIONS_VOCBASE(vocbase);
+    // copy all collections
+    TRI_READ_LOCK_COLLECTIONS_VOCBASE(vocbase);
+    TRI_CopyDataVectorPointer(&collections, &vocbase->_collections);
+    TRI_READ_UNLOCK_COLLECTIONS_VOCBASE(vocbase);
 
-      size_t const n = collections._length;
+    size_t const n = collections._length;
 
-      for (size_t i = 0;  i < n;  ++i) {
-        TRI_vocbase_col_t* collection = static_cast<TRI_vocbase_col_t*>(collections._buffer[i]);
+    for (size_t i = 0;  i < n;  ++i) {
+      // check if compaction is currently disallowed. the compaction lock is
+      // acquired for each collection separately, so compaction blockers can
+      // be inserted while other collections are compacted
+      if (! CheckAndLockCompaction(vocbase)) {
+        break;
+      }
 
-        if (! TRI_TRY_READ_LOCK_STATUS_VOCBASE_COL(collection)) {
-          // if we can't acquire the read lock instantly, we continue directly
-          // we don't want to stall here for too long
-          continue;
-        }
+      // compaction is currently allowed
+      double now = TRI_microtime();
 
-        TRI_document_collection_t* document = collection->_collection;
+      TRI_vocbase_col_t* collection = static_cast<TRI_vocbase_col_t*>(collections._buffer[i]);
 
-        if (document == nullptr) {
-          TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
-          continue;
-        }
+      if (! TRI_TRY_READ_LOCK_STATUS_VOCBASE_COL(collection)) {
+        // if we can't acquire the read lock instantly, we continue directly
+        // we don't want to stall here for too long
+        UnlockCompaction(vocbase);
+        continue;
+      }
 
-        bool worked    = false;
-        bool doCompact = document->_info._doCompact;
+      TRI_document_collection_t* document = collection->_collection;
 
-        // for document collection, compactify datafiles
-        if (collection->_status == TRI_VOC_COL_STATUS_LOADED && doCompact) {
-          // check whether someone else holds a read-lock on the compaction lock
-          if (! TRI_TryWriteLockReadWriteLock(&document->_compactionLock)) {
-            // someone else is holding the compactor lock, we'll not compact
-            TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
-            continue;
-          }
+      if (document == nullptr) {
+        TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+        UnlockCompaction(vocbase);
+        continue;
+      }
 
-          if (document->_lastCompaction + COMPACTOR_COLLECTION_INTERVAL <= now) {
-            TRI_barrier_t* ce = TRI_CreateBarrierCompaction(&document->_barrierList);
+      bool worked    = false;
+      bool doCompact = document->_info._doCompact;
+      int64_t copied = 0;
+
+      // for document collection, compactify datafiles. the collection's
+      // compaction lock is acquired for each batch of markers, not for the
+      // whole compaction. a batch that cannot get the lock instantly is
+      // retried in a later pass
+      if (collection->_status == TRI_VOC_COL_STATUS_LOADED && doCompact) {
+        if (document->_lastCompaction + COMPACTOR_COLLECTION_INTERVAL <= now) {
+          TRI_barrier_t* ce = TRI_CreateBarrierCompaction(&document->_barrierList);
+
+          if (ce == nullptr) {
+            // out of memory
+            LOG_WARNING("out of memory when trying to create a barrier element");
+          }
+          else {
+            worked = CompactifyDocumentCollection(document, copied);
 
-            if (ce == nullptr) {
-              // out of memory
-              LOG_WARNING("out of memory when trying to create a barrier element");
+            if (! worked) {
+              // set compaction stamp
+              document->_lastCompaction = now;
             }
-            else {
-              worked = CompactifyDocumentCollection(document);
-
-              if (! worked) {
-                // set compaction stamp
-                document->_lastCompaction = now;
-              }
-              // if we worked, then we don't set the compaction stamp to force another round of compaction
+            // if we worked, then we don't set the compaction stamp to force another round of compaction
 
-              TRI_FreeBarrier(ce);
-            }
+            TRI_FreeBarrier(ce);
           }
-
-          // read-unlock the compaction lock
-          TRI_WriteUnlockReadWriteLock(&document->_compactionLock);
         }
+      }
 
-        TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+      TRI_READ_UNLOCK_STATUS_VOCBASE_COL(collection);
+      UnlockCompaction(vocbase);
 
-        if (worked) {
-          ++numCompacted;
+      // comply with the I/O limit. this must not block others, so no locks
+      // are held anymore
+      ThrottleCompaction(vocbase, copied, now);
 
-          // signal the cleanup thread that we worked and that it can now wake up
-          TRI_LockCondition(&vocbase->_cleanupCondition);
-          TRI_SignalCondition(&vocbase->_cleanupCondition);
-          TRI_UnlockCondition(&vocbase->_cleanupCondition);
-        }
-      }
+      if (worked) {
+        ++numCompacted;
 
-      UnlockCompaction(vocbase);
+        // signal the cleanup thread that we worked and that it can now wake up
+        TRI_LockCondition(&vocbase->_cleanupCondition);
+        TRI_SignalCondition(&vocbase->_cleanupCondition);
+        TRI_UnlockCondition(&vocbase->_cleanupCondition);
+      }
     }
 
     if (numCompacted > 0) {
@@ -34,12 +34,19 @@
 
 #include "VocBase/voc-types.h"
 
+struct TRI_document_collection_t;
 struct TRI_vocbase_s;
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  public functions
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief free the state of an unfinished compaction of a collection
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FreeCompactionStateCompactor (struct TRI_document_collection_t*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief initialise the compaction blockers structure
 ////////////////////////////////////////////////////////////////////////////////
@@ -95,6 +102,13 @@ bool TRI_CheckAndLockCompactorVocBase (struct TRI_vocbase_s*);
 
 void TRI_UnlockCompactorVocBase (struct TRI_vocbase_s*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set the maximum number of bytes per second copied by the
+/// compactors of all databases, 0 means unlimited
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetIoLimitCompactor (uint64_t);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief compactor event loop
 ////////////////////////////////////////////////////////////////////////////////
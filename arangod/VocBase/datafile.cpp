@@ -44,6 +44,16 @@
 
 // #define DEBUG_DATAFILE 1
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the I/O policy for datafiles
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_df_io_policy_t IoPolicy = { false, true, false };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private functions
 // -----------------------------------------------------------------------------
@@ -168,6 +178,9 @@ static bool CheckCrcMarker (TRI_df_marker_t const* marker,
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief creates a new sparse datafile
 ///
+/// if the I/O policy requests it and the platform supports it, the disk space
+/// of the file is allocated, so writing to the mapped file does not need to
+/// allocate blocks in the filesystem. The file stays sparse if this fails.
 /// returns the file descriptor or -1 if the file cannot be created
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -191,6 +204,19 @@ static int CreateSparseFile (char const* filename,
     return -1;
   }
 
+#ifdef TRI_HAVE_POSIX_FALLOCATE
+  if (IoPolicy._preallocate) {
+    // posix_fallocate does not set errno but returns the error
+    int err = posix_fallocate(fd, 0, (off_t) maximalSize);
+
+    if (err == 0) {
+      return fd;
+    }
+
+    LOG_DEBUG("cannot preallocate datafile '%s': %s. creating a sparse file", filename, strerror(err));
+  }
+#endif
+
   // create sparse file
   offset = TRI_LSEEK(fd, (TRI_lseek_t) (maximalSize - 1), SEEK_SET);
 
@@ -982,6 +1008,9 @@ TRI_datafile_t* TRI_CreateDatafile (char const* filename,
 
   datafile->_state = TRI_DF_STATE_WRITE;
 
+  // new files are always written front to back
+  TRI_AdviseDatafile(datafile, TRI_DF_ACCESS_SEQUENTIAL);
+
   if (withInitialMarkers) {
     int res = WriteInitialHeaderMarker(datafile, fid, maximalSize);
 
@@ -1101,8 +1130,15 @@ TRI_datafile_t* TRI_CreatePhysicalDatafile (char const* filename,
     return nullptr;
   }
 
-  // memory map the data
-  res = TRI_MMFile(0, maximalSize, PROT_WRITE | PROT_READ, MAP_SHARED, fd, &mmHandle, 0, &data);
+  // memory map the data. with warmup, the page tables of the whole file
+  // are populated at once, instead of faulting each page in on first write
+  int flags = MAP_SHARED;
+
+  if (IoPolicy._warmup) {
+    flags |= TRI_MMAP_POPULATE;
+  }
+
+  res = TRI_MMFile(0, maximalSize, PROT_WRITE | PROT_READ, flags, fd, &mmHandle, 0, &data);
 
   if (res != TRI_ERROR_NO_ERROR) {
     TRI_set_errno(res);
@@ -1888,6 +1924,74 @@ void TRI_DestroyDatafileScan (TRI_df_scan_t* scan) {
   TRI_DestroyVector(&scan->_entries);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the I/O policy for all datafiles created afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetIoPolicyDatafile (TRI_df_io_policy_t const* policy) {
+  IoPolicy = *policy;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief announces the access pattern of a datafile
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_AdviseDatafile (TRI_datafile_t* datafile,
+                         TRI_df_access_e access) {
+  if (! IoPolicy._adviseAccess || datafile->_data == nullptr) {
+    return;
+  }
+
+  int advice;
+
+  switch (access) {
+    case TRI_DF_ACCESS_SEQUENTIAL:
+      advice = TRI_MADVISE_SEQUENTIAL;
+      break;
+    case TRI_DF_ACCESS_RANDOM:
+      advice = TRI_MADVISE_RANDOM;
+      break;
+    case TRI_DF_ACCESS_WILLNEED:
+      advice = TRI_MADVISE_WILLNEED;
+      break;
+    case TRI_DF_ACCESS_DONTNEED:
+      if (! datafile->isPhysical(datafile)) {
+        // the pages of an anonymous region might not be backed by anything
+        return;
+      }
+      advice = TRI_MADVISE_DONTNEED;
+      break;
+    default:
+      return;
+  }
+
+  int res = TRI_AdviseMMFile(datafile->_data, (size_t) datafile->_maximalSize, advice);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    // the hint is not essential
+    LOG_DEBUG("cannot advise access pattern %d for datafile '%s'", (int) access, datafile->getName(datafile));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of bytes of a datafile that are in memory
+////////////////////////////////////////////////////////////////////////////////
+
+int64_t TRI_ResidentSizeDatafile (TRI_datafile_t const* datafile) {
+  if (datafile->_data == nullptr) {
+    return 0;
+  }
+
+  size_t size;
+  int res = TRI_ResidentMMFile(datafile->_data, (size_t) datafile->_maximalSize, &size);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return 0;
+  }
+
+  return (int64_t) size;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -131,6 +131,29 @@ typedef enum {
 }
 TRI_df_state_e;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief expected access pattern of a datafile
+////////////////////////////////////////////////////////////////////////////////
+
+typedef enum {
+  TRI_DF_ACCESS_SEQUENTIAL      = 1, // datafile is written or read front to back
+  TRI_DF_ACCESS_RANDOM          = 2, // datafile is read at random positions
+  TRI_DF_ACCESS_WILLNEED        = 3, // datafile will be read soon
+  TRI_DF_ACCESS_DONTNEED        = 4  // datafile will not be read soon
+}
+TRI_df_access_e;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief I/O policy for datafiles, journals, compactor files and logfiles
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct TRI_df_io_policy_s {
+  bool _preallocate;             // allocate the disk space of new files
+  bool _adviseAccess;            // pass access pattern hints to the kernel
+  bool _warmup;                  // populate the memory mappings of new files
+}
+TRI_df_io_policy_t;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief type of the marker
 ////////////////////////////////////////////////////////////////////////////////
@@ -752,6 +775,26 @@ TRI_df_scan_t TRI_ScanDatafile (char const* path);
 
 void TRI_DestroyDatafileScan (TRI_df_scan_t* scan);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the I/O policy for all datafiles created afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_SetIoPolicyDatafile (TRI_df_io_policy_t const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief announces the access pattern of a datafile, if the I/O policy
+/// allows access pattern hints
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_AdviseDatafile (TRI_datafile_t*,
+                         TRI_df_access_e);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of bytes of a datafile that are in memory
+////////////////////////////////////////////////////////////////////////////////
+
+int64_t TRI_ResidentSizeDatafile (TRI_datafile_t const*);
+
 #endif
 
 // -----------------------------------------------------------------------------
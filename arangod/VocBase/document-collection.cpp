@@ -29,6 +29,7 @@
 
 #include "document-collection.h"
 
+#include "Aql/QueryPlanCache.h"
 #include "Basics/Barrier.h"
 #include "Basics/conversions.h"
 #include "Basics/files.h"
@@ -45,6 +46,7 @@
 #include "Utils/transactions.h"
 #include "Utils/CollectionReadLocker.h"
 #include "Utils/CollectionWriteLocker.h"
+#include "VocBase/compactor.h"
 #include "VocBase/edge-collection.h"
 #include "VocBase/index.h"
 #include "VocBase/key-generator.h"
@@ -144,6 +146,8 @@ TRI_shaper_t* TRI_document_collection_t::getShaper () const {
 
 int TRI_AddOperationTransaction (triagens::wal::DocumentOperation&, bool&);
 
+int TRI_AddOperationsTransaction (std::vector<triagens::wal::DocumentOperation*>&, bool&, size_t&);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                              forward declarations
 // -----------------------------------------------------------------------------
@@ -491,6 +495,9 @@ static int AddIndex (TRI_document_collection_t* document,
     SetIndexCleanupFlag(document, true);
   }
 
+  // cached query plans were optimized without the new index
+  triagens::aql::QueryPlanCache::InvalidateCollection(document->_vocbase, document->_info._name);
+
   return TRI_ERROR_NO_ERROR;
 }
 
@@ -586,6 +593,34 @@ static inline TRI_voc_rid_t GetRevisionId (TRI_voc_rid_t previous) {
   return static_cast<TRI_voc_rid_t>(TRI_NewTickServer());
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief insert a new document into all indexes
+////////////////////////////////////////////////////////////////////////////////
+
+static int InsertIndexes (TRI_document_collection_t* document,
+                          TRI_doc_mptr_t* header) {
+  // insert into primary index first
+  int res = InsertPrimaryIndex(document, header, false);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    // insert has failed
+    return res;
+  }
+
+  // insert into secondary indexes
+  res = InsertSecondaryIndexes(document, header, false);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    DeleteSecondaryIndexes(document, header, true);
+    DeletePrimaryIndex(document, header, true);
+    return res;
+  }
+
+  document->_numberDocuments++;
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief insert a document
 ////////////////////////////////////////////////////////////////////////////////
@@ -604,25 +639,12 @@ static int InsertDocument (TRI_transaction_collection_t* trxCollection,
   // insert into indexes
   // .............................................................................
 
-  // insert into primary index first
-  int res = InsertPrimaryIndex(document, header, false);
+  int res = InsertIndexes(document, header);
 
   if (res != TRI_ERROR_NO_ERROR) {
-    // insert has failed
     return res;
   }
 
-  // insert into secondary indexes
-  res = InsertSecondaryIndexes(document, header, false);
-
-  if (res != TRI_ERROR_NO_ERROR) {
-    DeleteSecondaryIndexes(document, header, true);
-    DeletePrimaryIndex(document, header, true);
-    return res;
-  }
-
-  document->_numberDocuments++;
-
   operation.indexed();
 
   TRI_IF_FAILURE("InsertDocumentNoOperation") {
@@ -669,16 +691,12 @@ static int LookupDocument (TRI_document_collection_t* document,
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/// @brief updates an existing document
+/// @brief replace an existing document in the secondary indexes
 ////////////////////////////////////////////////////////////////////////////////
 
-static int UpdateDocument (TRI_transaction_collection_t* trxCollection,
-                           TRI_doc_mptr_t* oldHeader,
-                           triagens::wal::DocumentOperation& operation,
-                           TRI_doc_mptr_copy_t* mptr,
-                           bool syncRequested) {
-  TRI_document_collection_t* document = trxCollection->_collection->_collection;
-
+static int UpdateIndexes (TRI_document_collection_t* document,
+                          TRI_doc_mptr_t* oldHeader,
+                          triagens::wal::DocumentOperation& operation) {
   // save the old data, remember
   TRI_doc_mptr_copy_t oldData = *oldHeader;
 
@@ -723,6 +741,28 @@ static int UpdateDocument (TRI_transaction_collection_t* trxCollection,
     return res;
   }
 
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief updates an existing document
+////////////////////////////////////////////////////////////////////////////////
+
+static int UpdateDocument (TRI_transaction_collection_t* trxCollection,
+                           TRI_doc_mptr_t* oldHeader,
+                           triagens::wal::DocumentOperation& operation,
+                           TRI_doc_mptr_copy_t* mptr,
+                           bool syncRequested) {
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+
+  int res = UpdateIndexes(document, oldHeader, operation);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
+
+  TRI_doc_mptr_t* newHeader = oldHeader;
+
   operation.indexed();
 
   TRI_IF_FAILURE("UpdateDocumentNoOperation") {
@@ -743,6 +783,188 @@ static int UpdateDocument (TRI_transaction_collection_t* trxCollection,
   return res;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief remove an existing document from all indexes
+////////////////////////////////////////////////////////////////////////////////
+
+static int RemoveIndexes (TRI_document_collection_t* document,
+                          TRI_doc_mptr_t* header) {
+  int res = DeleteSecondaryIndexes(document, header, false);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    InsertSecondaryIndexes(document, header, true);
+    return res;
+  }
+
+  res = DeletePrimaryIndex(document, header, false);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    InsertSecondaryIndexes(document, header, true);
+    return res;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief grow the primary index and the hash indexes for a batch of documents
+///
+/// the indexes are only grown if inserting the batch would resize them anyway.
+/// they are then grown at least geometrically, so repeated batches do not
+/// rehash the indexes over and over
+////////////////////////////////////////////////////////////////////////////////
+
+static void PrepareIndexes (TRI_document_collection_t* document,
+                            size_t n) {
+  TRI_primary_index_t* primaryIndex = &document->_primaryIndex;
+  size_t targetSize = static_cast<size_t>(primaryIndex->_nrUsed) + n;
+
+  if (static_cast<size_t>(primaryIndex->_nrAlloc) >= 2 * targetSize) {
+    // no resize required
+    return;
+  }
+
+  targetSize = (std::max)(targetSize, static_cast<size_t>(primaryIndex->_nrAlloc));
+
+  // a failed resize is not an error, the indexes grow on insert as usual
+  TRI_ResizePrimaryIndex(primaryIndex, targetSize);
+
+  if (! document->useSecondaryIndexes()) {
+    return;
+  }
+
+  size_t const numIndexes = document->_allIndexes._length;
+
+  // we can start at index #1 here (index #0 is the primary index)
+  for (size_t i = 1;  i < numIndexes;  ++i) {
+    TRI_index_t* idx = static_cast<TRI_index_t*>(document->_allIndexes._buffer[i]);
+
+    // the edge index can only be sized while it is empty
+    if (idx->_type == TRI_IDX_TYPE_HASH_INDEX && idx->sizeHint != nullptr) {
+      idx->sizeHint(idx, targetSize);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief revert the operations of a batch from the end down to start, and
+/// free all of them
+////////////////////////////////////////////////////////////////////////////////
+
+static void DiscardOperations (std::vector<triagens::wal::DocumentOperation*>& operations,
+                               size_t start) {
+  for (size_t i = operations.size(); i > start; --i) {
+    if (operations[i - 1] != nullptr) {
+      operations[i - 1]->revert();
+    }
+  }
+
+  for (auto it : operations) {
+    delete it;
+  }
+
+  operations.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write the indexed operations of a batch into the logfiles
+///
+/// the results are copied into the documents of the operations. operations
+/// that cannot be written are reverted, and the error is returned
+////////////////////////////////////////////////////////////////////////////////
+
+static int FlushOperations (TRI_transaction_collection_t* trxCollection,
+                            std::vector<triagens::wal::DocumentOperation*>& operations,
+                            std::vector<TRI_doc_bulk_operation_t*>& documents,
+                            bool forceSync,
+                            TRI_voc_tick_t& markerTick) {
+  size_t const n = operations.size();
+
+  TRI_ASSERT(documents.size() == n);
+
+  if (n == 0) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  TRI_voc_document_operation_e const type = operations[0]->type;
+
+  // applied operations hand over their headers to the transaction
+  std::vector<TRI_doc_mptr_t*> headers;
+  headers.reserve(n);
+
+  for (auto it : operations) {
+    headers.push_back(it->header);
+  }
+
+  size_t applied = 0;
+  int res;
+
+  try {
+    res = TRI_AddOperationsTransaction(operations, forceSync, applied);
+  }
+  catch (...) {
+    DiscardOperations(operations, applied);
+    documents.clear();
+    throw;
+  }
+
+  if (type != TRI_VOC_DOCUMENT_OPERATION_REMOVE) {
+    for (size_t i = 0; i < applied; ++i) {
+      documents[i]->mptr = *headers[i];
+    }
+  }
+
+  if (forceSync && applied > 0) {
+    markerTick = operations[applied - 1]->tick;
+  }
+
+  for (size_t i = applied; i < n; ++i) {
+    documents[i]->errorCode = res;
+  }
+
+  DiscardOperations(operations, applied);
+  documents.clear();
+
+  if (type == TRI_VOC_DOCUMENT_OPERATION_INSERT) {
+    for (size_t i = 0; i < applied; ++i) {
+      PostInsertIndexes(trxCollection, headers[i]);
+    }
+  }
+
+  return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a key for a new document
+////////////////////////////////////////////////////////////////////////////////
+
+static int CreateKey (TRI_document_collection_t* document,
+                      TRI_voc_key_t key,
+                      TRI_voc_tick_t tick,
+                      bool isRestore,
+                      std::string& keyString) {
+  if (key == nullptr) {
+    // no key specified, now generate a new one
+    keyString.assign(document->_keyGenerator->generate(tick));
+
+    if (keyString.empty()) {
+      return TRI_ERROR_ARANGO_OUT_OF_KEYS;
+    }
+  }
+  else {
+    // key was specified, now validate it
+    int res = document->_keyGenerator->validate(key, isRestore);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+
+    keyString = key;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief create a document or edge marker, without using a legend
 ////////////////////////////////////////////////////////////////////////////////
@@ -1892,6 +2114,7 @@ static TRI_doc_collection_info_t* Figures (TRI_document_collection_t* document)
     TRI_datafile_t* df = (TRI_datafile_t*) base->_datafiles._buffer[i];
 
     info->_datafileSize += (int64_t) df->_maximalSize;
+    info->_datafileResidentSize += TRI_ResidentSizeDatafile(df);
     ++info->_numberDatafiles;
   }
 
@@ -1899,6 +2122,7 @@ static TRI_doc_collection_info_t* Figures (TRI_document_collection_t* document)
     TRI_datafile_t* df = (TRI_datafile_t*) base->_journals._buffer[i];
 
     info->_journalfileSize += (int64_t) df->_maximalSize;
+    info->_journalfileResidentSize += TRI_ResidentSizeDatafile(df);
     ++info->_numberJournalfiles;
   }
 
@@ -1906,6 +2130,7 @@ static TRI_doc_collection_info_t* Figures (TRI_document_collection_t* document)
     TRI_datafile_t* df = (TRI_datafile_t*) base->_compactors._buffer[i];
 
     info->_compactorfileSize += (int64_t) df->_maximalSize;
+    info->_compactorfileResidentSize += TRI_ResidentSizeDatafile(df);
     ++info->_numberCompactorfiles;
   }
 
@@ -1944,6 +2169,7 @@ static int InitBaseDocumentCollection (TRI_document_collection_t* document,
   document->_capConstraint      = nullptr;
   document->_numberDocuments    = 0;
   document->_lastCompaction     = 0.0;
+  document->_compactionState    = nullptr;
 
   document->size                = Count;
 
@@ -1984,6 +2210,7 @@ static void DestroyBaseDocumentCollection (TRI_document_collection_t* document)
     document->_keyGenerator = nullptr;
   }
 
+  TRI_FreeCompactionStateCompactor(document);
   TRI_DestroyReadWriteLock(&document->_compactionLock);
 
   TRI_DestroyPrimaryIndex(&document->_primaryIndex);
@@ -2162,9 +2389,18 @@ static int IterateMarkersCollection (TRI_collection_t* collection) {
     return res;
   }
 
-  // read all documents and fill primary index
+  // read all documents and fill primary index. the datafiles are read front
+  // to back now, but afterwards documents are looked up via the master pointers
+  for (size_t i = 0; i < collection->_datafiles._length; ++i) {
+    TRI_AdviseDatafile(static_cast<TRI_datafile_t*>(collection->_datafiles._buffer[i]), TRI_DF_ACCESS_SEQUENTIAL);
+  }
+
   TRI_IterateCollection(collection, OpenIterator, &openState);
 
+  for (size_t i = 0; i < collection->_datafiles._length; ++i) {
+    TRI_AdviseDatafile(static_cast<TRI_datafile_t*>(collection->_datafiles._buffer[i]), TRI_DF_ACCESS_RANDOM);
+  }
+
   LOG_TRACE("found %llu document markers, %llu deletion markers for collection '%s'",
             (unsigned long long) openState._documents,
             (unsigned long long) openState._deletions,
@@ -2793,6 +3029,9 @@ bool TRI_CloseDatafileDocumentCollection (TRI_document_collection_t* document,
   if (! isCompactor) {
     TRI_RemoveVectorPointer(vector, position);
     TRI_PushBackVectorPointer(&document->_datafiles, journal);
+
+    // documents in datafiles are looked up via the master pointers
+    TRI_AdviseDatafile(journal, TRI_DF_ACCESS_RANDOM);
   }
 
   return true;
@@ -3489,6 +3728,11 @@ bool TRI_DropIndexDocumentCollection (TRI_document_collection_t* document,
 
   TRI_ReadUnlockReadWriteLock(&vocbase->_inventoryLock);
 
+  if (found != nullptr) {
+    // cached query plans may use the dropped index
+    triagens::aql::QueryPlanCache::InvalidateCollection(vocbase, document->_info._name);
+  }
+
   // .............................................................................
   // outside write-lock
   // .............................................................................
@@ -5079,17 +5323,9 @@ int TRI_RemoveShapedJsonDocumentCollection (TRI_transaction_collection_t* trxCol
     operation.init();
 
     // delete from indexes
-    res = DeleteSecondaryIndexes(document, header, false);
+    res = RemoveIndexes(document, header);
 
     if (res != TRI_ERROR_NO_ERROR) {
-      InsertSecondaryIndexes(document, header, true);
-      return res;
-    }
-
-    res = DeletePrimaryIndex(document, header, false);
-
-    if (res != TRI_ERROR_NO_ERROR) {
-      InsertSecondaryIndexes(document, header, true);
       return res;
     }
 
@@ -5152,31 +5388,14 @@ int TRI_InsertShapedJsonDocumentCollection (TRI_transaction_collection_t* trxCol
   //TRI_ASSERT_EXPENSIVE(lock || TRI_IsLockedCollectionTransaction(trxCollection, TRI_TRANSACTION_WRITE, 0));
 
   std::string keyString;
+  int res = CreateKey(document, key, tick, isRestore, keyString);
 
-  if (key == nullptr) {
-    // no key specified, now generate a new one
-    keyString.assign(document->_keyGenerator->generate(tick));
-
-    if (keyString.empty()) {
-      return TRI_ERROR_ARANGO_OUT_OF_KEYS;
-    }
-  }
-  else {
-    // key was specified, now validate it
-    int res = document->_keyGenerator->validate(key, isRestore);
-
-    if (res != TRI_ERROR_NO_ERROR) {
-      return res;
-    }
-
-    keyString = key;
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
   }
 
   uint64_t const hash = TRI_HashKeyPrimaryIndex(keyString.c_str(), keyString.size());
 
-
-  int res = TRI_ERROR_NO_ERROR;
-
   if (marker == nullptr) {
     res = CreateMarkerNoLegend(marker, document, rid, trxCollection, keyString, shaped, edge);
   
@@ -5362,6 +5581,351 @@ int TRI_UpdateShapedJsonDocumentCollection (TRI_transaction_collection_t* trxCol
   return res;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes many shaped-json documents (or edges)
+///
+/// the collection is locked once for all documents, and the markers are
+/// written into the logfiles in batches. the result of each document is
+/// returned in its errorCode. if the function itself returns an error, the
+/// documents were not removed completely and the transaction must be aborted
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_RemoveShapedJsonDocumentsCollection (TRI_transaction_collection_t* trxCollection,
+                                             std::vector<TRI_doc_bulk_operation_t>& documents,
+                                             bool lock,
+                                             bool forceSync) {
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+  size_t const n = documents.size();
+
+  std::vector<triagens::wal::DocumentOperation*> operations;
+  std::vector<triagens::wal::DocumentOperation*> indexed;
+  std::vector<TRI_doc_bulk_operation_t*> indexedDocuments;
+  operations.reserve(n);
+  indexed.reserve(n);
+  indexedDocuments.reserve(n);
+
+  int res = TRI_ERROR_NO_ERROR;
+  TRI_voc_tick_t markerTick = 0;
+
+  try {
+    // create the markers outside the lock
+    for (auto& it : documents) {
+      TRI_ASSERT(it.key != nullptr);
+
+      it.errorCode = TRI_ERROR_NO_ERROR;
+      it.rid = GetRevisionId(it.rid);
+
+      triagens::wal::Marker* marker = new triagens::wal::RemoveMarker(document->_vocbase->_id,
+                                                                      document->_info._cid,
+                                                                      it.rid,
+                                                                      TRI_MarkerIdTransaction(trxCollection->_transaction),
+                                                                      std::string(it.key));
+
+      operations.push_back(new triagens::wal::DocumentOperation(marker, true, trxCollection, TRI_VOC_DOCUMENT_OPERATION_REMOVE, it.rid));
+    }
+
+    triagens::arango::CollectionWriteLocker collectionLocker(document, lock);
+
+    for (size_t i = 0; i < n; ++i) {
+      auto& it = documents[i];
+      triagens::wal::DocumentOperation* operation = operations[i];
+
+      TRI_doc_mptr_t* header;
+      int res2 = LookupDocument(document, it.key, it.policy, header);
+
+      if (res2 == TRI_ERROR_NO_ERROR) {
+        // we found a document to remove
+        operation->header = header;
+        operation->init();
+
+        res2 = RemoveIndexes(document, header);
+      }
+
+      if (res2 != TRI_ERROR_NO_ERROR) {
+        it.errorCode = res2;
+        operation->revert();
+        delete operation;
+        operations[i] = nullptr;
+        continue;
+      }
+
+      operation->indexed();
+      indexed.push_back(operation);
+      indexedDocuments.push_back(&it);
+      operations[i] = nullptr;
+
+      document->_headersPtr->unlink(header);  // PROTECTED by trx in trxCollection
+      document->_numberDocuments--;
+    }
+
+    res = FlushOperations(trxCollection, indexed, indexedDocuments, forceSync, markerTick);
+  }
+  catch (...) {
+    // revert in reverse order
+    DiscardOperations(operations, 0);
+    DiscardOperations(indexed, 0);
+    throw;
+  }
+
+  DiscardOperations(operations, 0);
+
+  if (markerTick > 0) {
+    // need to wait for tick, outside the lock
+    triagens::wal::LogfileManager::instance()->slots()->waitForTick(markerTick);
+  }
+
+  return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief insert many shaped-json documents (or edges)
+///
+/// the collection is locked once for all documents, the indexes are sized for
+/// all documents, and the markers are written into the logfiles in batches.
+/// the result of each document is returned in its errorCode and mptr. with
+/// stopOnError, the documents following the first document that cannot be
+/// inserted are not inserted either, and get TRI_ERROR_REQUEST_CANCELED. if
+/// the function itself returns an error, the documents were not inserted
+/// completely and the transaction must be aborted
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_InsertShapedJsonDocumentsCollection (TRI_transaction_collection_t* trxCollection,
+                                             std::vector<TRI_doc_bulk_operation_t>& documents,
+                                             bool lock,
+                                             bool forceSync,
+                                             bool isRestore,
+                                             bool stopOnError) {
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+  size_t const n = documents.size();
+
+  std::vector<triagens::wal::DocumentOperation*> operations;
+  std::vector<TRI_doc_bulk_operation_t*> operationDocuments;
+  std::vector<uint64_t> hashes;
+  std::vector<triagens::wal::DocumentOperation*> indexed;
+  std::vector<TRI_doc_bulk_operation_t*> indexedDocuments;
+  operations.reserve(n);
+  operationDocuments.reserve(n);
+  hashes.reserve(n);
+  indexed.reserve(n);
+  indexedDocuments.reserve(n);
+
+  int res = TRI_ERROR_NO_ERROR;
+  TRI_voc_tick_t markerTick = 0;
+
+  try {
+    // create the markers outside the lock
+    std::string keyString;
+    bool stopped = false;
+
+    for (auto& it : documents) {
+      it.mptr.setDataPtr(nullptr);  // PROTECTED by trx in trxCollection
+
+      if (stopped) {
+        it.errorCode = TRI_ERROR_REQUEST_CANCELED;
+        continue;
+      }
+
+      it.errorCode = TRI_ERROR_NO_ERROR;
+      it.rid = GetRevisionId(it.rid);
+
+      triagens::wal::Marker* marker = nullptr;
+      int res2 = CreateKey(document, it.key, static_cast<TRI_voc_tick_t>(it.rid), isRestore, keyString);
+
+      if (res2 == TRI_ERROR_NO_ERROR) {
+        res2 = CreateMarkerNoLegend(marker, document, it.rid, trxCollection, keyString, it.shaped, it.edge);
+      }
+
+      if (res2 != TRI_ERROR_NO_ERROR) {
+        if (marker != nullptr) {
+          // avoid memleak
+          delete marker;
+        }
+
+        it.errorCode = res2;
+        stopped = stopOnError;
+        continue;
+      }
+
+      operations.push_back(new triagens::wal::DocumentOperation(marker, true, trxCollection, TRI_VOC_DOCUMENT_OPERATION_INSERT, it.rid));
+      operationDocuments.push_back(&it);
+      hashes.push_back(TRI_HashKeyPrimaryIndex(keyString.c_str(), keyString.size()));
+    }
+
+    triagens::arango::CollectionWriteLocker collectionLocker(document, lock);
+
+    PrepareIndexes(document, operations.size());
+
+    for (size_t i = 0; i < operations.size(); ++i) {
+      triagens::wal::DocumentOperation* operation = operations[i];
+
+      // create a new header
+      TRI_doc_mptr_t* header = operation->header = document->_headersPtr->request(operation->marker->size());  // PROTECTED by trx in trxCollection
+      int res2 = TRI_ERROR_OUT_OF_MEMORY;
+
+      if (header != nullptr) {
+        header->_rid  = operation->rid;
+        header->setDataPtr(operation->marker->mem());  // PROTECTED by trx in trxCollection
+        header->_hash = hashes[i];
+
+        res2 = InsertIndexes(document, header);
+      }
+
+      if (res2 != TRI_ERROR_NO_ERROR) {
+        operationDocuments[i]->errorCode = res2;
+        operation->revert();
+        delete operation;
+        operations[i] = nullptr;
+
+        if (stopOnError) {
+          // the remaining operations are discarded below
+          for (size_t j = i + 1; j < operations.size(); ++j) {
+            operationDocuments[j]->errorCode = TRI_ERROR_REQUEST_CANCELED;
+          }
+          break;
+        }
+        continue;
+      }
+
+      operation->indexed();
+      indexed.push_back(operation);
+      indexedDocuments.push_back(operationDocuments[i]);
+      operations[i] = nullptr;
+    }
+
+    res = FlushOperations(trxCollection, indexed, indexedDocuments, forceSync, markerTick);
+  }
+  catch (...) {
+    // revert in reverse order
+    DiscardOperations(operations, 0);
+    DiscardOperations(indexed, 0);
+    throw;
+  }
+
+  DiscardOperations(operations, 0);
+
+  if (markerTick > 0) {
+    // need to wait for tick, outside the lock
+    triagens::wal::LogfileManager::instance()->slots()->waitForTick(markerTick);
+  }
+
+  return res;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief updates many documents in the collection from shaped json
+///
+/// the collection is locked once for all documents, and the markers are
+/// written into the logfiles in batches. a document that is updated more than
+/// once is updated in order, as its previous updates are written before. the
+/// result of each document is returned in its errorCode and mptr. if the
+/// function itself returns an error, the documents were not updated
+/// completely and the transaction must be aborted
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_UpdateShapedJsonDocumentsCollection (TRI_transaction_collection_t* trxCollection,
+                                             std::vector<TRI_doc_bulk_operation_t>& documents,
+                                             bool lock,
+                                             bool forceSync) {
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+  size_t const n = documents.size();
+
+  std::vector<triagens::wal::DocumentOperation*> indexed;
+  std::vector<TRI_doc_bulk_operation_t*> indexedDocuments;
+  std::unordered_set<TRI_doc_mptr_t const*> indexedHeaders;
+  indexed.reserve(n);
+  indexedDocuments.reserve(n);
+
+  int res = TRI_ERROR_NO_ERROR;
+  TRI_voc_tick_t markerTick = 0;
+
+  try {
+    triagens::arango::CollectionWriteLocker collectionLocker(document, lock);
+
+    for (auto& it : documents) {
+      TRI_ASSERT(it.key != nullptr);
+
+      it.mptr.setDataPtr(nullptr);  // PROTECTED by trx in trxCollection
+      it.errorCode = TRI_ERROR_NO_ERROR;
+      it.rid = GetRevisionId(it.rid);
+
+      // get the header pointer of the previous revision
+      TRI_doc_mptr_t* oldHeader;
+      int res2 = LookupDocument(document, it.key, nullptr, oldHeader);
+
+      if (res2 == TRI_ERROR_NO_ERROR &&
+          indexedHeaders.find(oldHeader) != indexedHeaders.end()) {
+        // the document was updated in this batch before. write the batch
+        // first, so the update is based on the previous one
+        res = FlushOperations(trxCollection, indexed, indexedDocuments, forceSync, markerTick);
+
+        if (res != TRI_ERROR_NO_ERROR) {
+          break;
+        }
+
+        indexedHeaders.clear();
+      }
+
+      if (res2 == TRI_ERROR_NO_ERROR && it.policy != nullptr) {
+        res2 = it.policy->check(oldHeader->_rid);
+      }
+
+      triagens::wal::Marker* marker = nullptr;
+
+      if (res2 == TRI_ERROR_NO_ERROR) {
+        TRI_df_marker_t const* original = static_cast<TRI_df_marker_t const*>(oldHeader->getDataPtr());  // PROTECTED by trx in trxCollection
+
+        res2 = CloneMarkerNoLegend(marker, original, document, it.rid, trxCollection, it.shaped);
+      }
+
+      if (res2 != TRI_ERROR_NO_ERROR) {
+        if (marker != nullptr) {
+          // avoid memleak
+          delete marker;
+        }
+
+        it.errorCode = res2;
+        continue;
+      }
+
+      triagens::wal::DocumentOperation* operation = new triagens::wal::DocumentOperation(marker, true, trxCollection, TRI_VOC_DOCUMENT_OPERATION_UPDATE, it.rid);
+      operation->header = oldHeader;
+      operation->init();
+
+      res2 = UpdateIndexes(document, oldHeader, *operation);
+
+      if (res2 != TRI_ERROR_NO_ERROR) {
+        it.errorCode = res2;
+        operation->revert();
+        delete operation;
+        continue;
+      }
+
+      operation->indexed();
+      indexed.push_back(operation);
+      indexedDocuments.push_back(&it);
+      indexedHeaders.insert(oldHeader);
+    }
+
+    if (res == TRI_ERROR_NO_ERROR) {
+      res = FlushOperations(trxCollection, indexed, indexedDocuments, forceSync, markerTick);
+    }
+    else {
+      DiscardOperations(indexed, 0);
+    }
+  }
+  catch (...) {
+    DiscardOperations(indexed, 0);
+    throw;
+  }
+
+  if (markerTick > 0) {
+    // need to wait for tick, outside the lock
+    triagens::wal::LogfileManager::instance()->slots()->waitForTick(markerTick);
+  }
+
+  return res;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -53,6 +53,7 @@
 // -----------------------------------------------------------------------------
 
 struct TRI_cap_constraint_s;
+struct TRI_compaction_state_s;
 struct TRI_document_edge_s;
 struct TRI_index_s;
 struct TRI_json_t;
@@ -313,6 +314,10 @@ typedef struct TRI_doc_collection_info_s {
   int64_t         _compactorfileSize;
   int64_t         _shapefileSize;
 
+  int64_t         _datafileResidentSize;
+  int64_t         _journalfileResidentSize;
+  int64_t         _compactorfileResidentSize;
+
   TRI_voc_tick_t  _tickMax;
   uint64_t        _uncollectedLogfileEntries;
 }
@@ -379,6 +384,9 @@ public:
   TRI_read_write_lock_t        _compactionLock;
   double                       _lastCompaction;
 
+  // state of a compaction that is continued in the compactor's next pass
+  struct TRI_compaction_state_s* _compactionState;
+
   // ...........................................................................
   // this condition variable protects the _journalsCondition
   // ...........................................................................
@@ -1015,6 +1023,34 @@ int TRI_RotateJournalDocumentCollection (TRI_document_collection_t*);
 // --SECTION--                                                      CRUD methods
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a document of a bulk insert, update or remove
+///
+/// key, shaped, edge, policy and rid are the input of the operation, as
+/// for the functions handling a single document. errorCode and mptr
+/// receive the result
+////////////////////////////////////////////////////////////////////////////////
+
+struct TRI_doc_bulk_operation_t {
+  TRI_doc_bulk_operation_t ()
+    : key(nullptr),
+      shaped(nullptr),
+      edge(nullptr),
+      policy(nullptr),
+      rid(0),
+      errorCode(TRI_ERROR_NO_ERROR),
+      mptr() {
+  }
+
+  TRI_voc_key_t                   key;
+  TRI_shaped_json_t const*        shaped;
+  TRI_document_edge_t const*      edge;
+  TRI_doc_update_policy_t const*  policy;
+  TRI_voc_rid_t                   rid;
+  int                             errorCode;
+  TRI_doc_mptr_copy_t             mptr;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief reads an element from the document collection
 ////////////////////////////////////////////////////////////////////////////////
@@ -1066,6 +1102,36 @@ int TRI_UpdateShapedJsonDocumentCollection (TRI_transaction_collection_t*,
                                             bool,
                                             bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes many shaped-json documents (or edges)
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_RemoveShapedJsonDocumentsCollection (TRI_transaction_collection_t*,
+                                             std::vector<TRI_doc_bulk_operation_t>&,
+                                             bool,
+                                             bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief insert many shaped-json documents (or edges)
+/// note: keys might be NULL. in this case, the keys are auto-generated
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_InsertShapedJsonDocumentsCollection (TRI_transaction_collection_t*,
+                                             std::vector<TRI_doc_bulk_operation_t>&,
+                                             bool,
+                                             bool,
+                                             bool,
+                                             bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief updates many documents in the collection from shaped json
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_UpdateShapedJsonDocumentsCollection (TRI_transaction_collection_t*,
+                                             std::vector<TRI_doc_bulk_operation_t>&,
+                                             bool,
+                                             bool);
+
 #endif
 
 // -----------------------------------------------------------------------------
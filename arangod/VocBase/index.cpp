@@ -47,6 +47,7 @@
 #include "HashIndex/hash-index.h"
 #include "ShapedJson/shape-accessor.h"
 #include "ShapedJson/shaped-json.h"
+#include "Utils/CollectionNameResolver.h"
 #include "VocBase/document-collection.h"
 #include "VocBase/edge-collection.h"
 #include "VocBase/server.h"
@@ -580,8 +581,7 @@ void TRI_FreePrimaryIndex (TRI_index_t* idx) {
 /// @brief hashes an edge key
 ////////////////////////////////////////////////////////////////////////////////
 
-static uint64_t HashElementKey (TRI_multi_pointer_t* array, void const* data) {
-  TRI_edge_header_t const* h = static_cast<TRI_edge_header_t const*>(data);
+static inline uint64_t HashElementKey (TRI_edge_header_t const* h) {
   char const* key = h->_key;
 
   uint64_t hash = h->_cid;
@@ -590,20 +590,26 @@ static uint64_t HashElementKey (TRI_multi_pointer_t* array, void const* data) {
   return fasthash64(&hash, sizeof(hash), 0x56781234);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hashes an edge key (_from case)
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TRI_edge_from_desc_t::hashKey (TRI_edge_header_t const* key) const {
+  return HashElementKey(key);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief hashes an edge (_from case)
 ////////////////////////////////////////////////////////////////////////////////
 
-static uint64_t HashElementEdgeFrom (TRI_multi_pointer_t* array,
-                                     void const* data,
-                                     bool byKey) {
+uint64_t TRI_edge_from_desc_t::hashElement (TRI_doc_mptr_t const* mptr,
+                                            bool byKey) const {
   uint64_t hash;
 
   if (! byKey) {
-    hash = (uint64_t) data;
+    hash = (uint64_t) mptr;
   }
   else {
-    TRI_doc_mptr_t const* mptr = static_cast<TRI_doc_mptr_t const*>(data);
     TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
     if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -629,20 +635,26 @@ static uint64_t HashElementEdgeFrom (TRI_multi_pointer_t* array,
   return fasthash64(&hash, sizeof(hash), 0x56781234);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hashes an edge key (_to case)
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TRI_edge_to_desc_t::hashKey (TRI_edge_header_t const* key) const {
+  return HashElementKey(key);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief hashes an edge (_to case)
 ////////////////////////////////////////////////////////////////////////////////
 
-static uint64_t HashElementEdgeTo (TRI_multi_pointer_t* array,
-                                   void const* data,
-                                   bool byKey) {
+uint64_t TRI_edge_to_desc_t::hashElement (TRI_doc_mptr_t const* mptr,
+                                          bool byKey) const {
   uint64_t hash;
 
   if (! byKey) {
-    hash = (uint64_t) data;
+    hash = (uint64_t) mptr;
   }
   else {
-    TRI_doc_mptr_t const* mptr = static_cast<TRI_doc_mptr_t const*>(data);
     TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
     if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -672,15 +684,12 @@ static uint64_t HashElementEdgeTo (TRI_multi_pointer_t* array,
 /// @brief checks if key and element match (_from case)
 ////////////////////////////////////////////////////////////////////////////////
 
-static bool IsEqualKeyEdgeFrom (TRI_multi_pointer_t* array,
-                                void const* left,
-                                void const* right) {
+bool TRI_edge_from_desc_t::isEqualKeyElement (TRI_edge_header_t const* l,
+                                              TRI_doc_mptr_t const* rMptr) const {
   // left is a key
   // right is an element, that is a master pointer
-  TRI_edge_header_t const* l = static_cast<TRI_edge_header_t const*>(left);
   char const* lKey = l->_key;
 
-  TRI_doc_mptr_t const* rMptr = static_cast<TRI_doc_mptr_t const*>(right);
   TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(rMptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
   if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -706,15 +715,12 @@ static bool IsEqualKeyEdgeFrom (TRI_multi_pointer_t* array,
 /// @brief checks if key and element match (_to case)
 ////////////////////////////////////////////////////////////////////////////////
 
-static bool IsEqualKeyEdgeTo (TRI_multi_pointer_t* array,
-                              void const* left,
-                              void const* right) {
+bool TRI_edge_to_desc_t::isEqualKeyElement (TRI_edge_header_t const* l,
+                                            TRI_doc_mptr_t const* rMptr) const {
   // left is a key
   // right is an element, that is a master pointer
-  TRI_edge_header_t const* l = static_cast<TRI_edge_header_t const*>(left);
   char const* lKey = l->_key;
 
-  TRI_doc_mptr_t const* rMptr = static_cast<TRI_doc_mptr_t const*>(right);
   TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(rMptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
   if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -741,12 +747,11 @@ static bool IsEqualKeyEdgeTo (TRI_multi_pointer_t* array,
 /// @brief checks for elements are equal (_from case)
 ////////////////////////////////////////////////////////////////////////////////
 
-static bool IsEqualElementEdgeFrom (TRI_multi_pointer_t* array,
-                                    void const* left,
-                                    void const* right,
-                                    bool byKey) {
+bool TRI_edge_from_desc_t::isEqualElementElement (TRI_doc_mptr_t const* lMptr,
+                                                  TRI_doc_mptr_t const* rMptr,
+                                                  bool byKey) const {
   if (! byKey) {
-    return left == right;
+    return lMptr == rMptr;
   }
   else {
     TRI_df_marker_t const* marker;
@@ -756,7 +761,6 @@ static bool IsEqualElementEdgeFrom (TRI_multi_pointer_t* array,
     TRI_voc_cid_t rCid;
 
     // left element
-    TRI_doc_mptr_t const* lMptr = static_cast<TRI_doc_mptr_t const*>(left);
     marker = static_cast<TRI_df_marker_t const*>(lMptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
     if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -774,7 +778,6 @@ static bool IsEqualElementEdgeFrom (TRI_multi_pointer_t* array,
     }
 
     // right element
-    TRI_doc_mptr_t const* rMptr = static_cast<TRI_doc_mptr_t const*>(right);
     marker = static_cast<TRI_df_marker_t const*>(rMptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
     if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -801,12 +804,11 @@ static bool IsEqualElementEdgeFrom (TRI_multi_pointer_t* array,
 /// @brief checks for elements are equal (_to case)
 ////////////////////////////////////////////////////////////////////////////////
 
-static bool IsEqualElementEdgeTo (TRI_multi_pointer_t* array,
-                                  void const* left,
-                                  void const* right,
-                                  bool byKey) {
+bool TRI_edge_to_desc_t::isEqualElementElement (TRI_doc_mptr_t const* lMptr,
+                                                TRI_doc_mptr_t const* rMptr,
+                                                bool byKey) const {
   if (! byKey) {
-    return left == right;
+    return lMptr == rMptr;
   }
   else {
     TRI_df_marker_t const* marker;
@@ -816,7 +818,6 @@ static bool IsEqualElementEdgeTo (TRI_multi_pointer_t* array,
     TRI_voc_cid_t rCid;
 
     // left element
-    TRI_doc_mptr_t const* lMptr = static_cast<TRI_doc_mptr_t const*>(left);
     marker = static_cast<TRI_df_marker_t const*>(lMptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
     if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -834,7 +835,6 @@ static bool IsEqualElementEdgeTo (TRI_multi_pointer_t* array,
     }
 
     // right element
-    TRI_doc_mptr_t const* rMptr = static_cast<TRI_doc_mptr_t const*>(right);
     marker = static_cast<TRI_df_marker_t const*>(rMptr->getDataPtr());  // ONLY IN INDEX, PROTECTED by RUNTIME
 
     if (marker->_type == TRI_DOC_MARKER_KEY_EDGE) {
@@ -865,14 +865,25 @@ static int InsertEdge (TRI_index_t* idx,
                        TRI_doc_mptr_t const* mptr,
                        bool isRollback) {
 
-  TRI_multi_pointer_t* edgesIndex;
+  TRI_edge_index_t* edgesIndex = (TRI_edge_index_t*) idx;
 
   // OUT
-  edgesIndex = &(((TRI_edge_index_t*) idx)->_edges_from);
-  TRI_InsertElementMultiPointer(edgesIndex, CONST_CAST(mptr), true, isRollback);
+  try {
+    edgesIndex->_edges_from->insert(const_cast<TRI_doc_mptr_t*>(mptr), true, isRollback);
+  }
+  catch (triagens::basics::Exception const& ex) {
+    return ex.code();
+  }
+
   // IN
-  edgesIndex = &(((TRI_edge_index_t*) idx)->_edges_to);
-  TRI_InsertElementMultiPointer(edgesIndex, CONST_CAST(mptr), true, isRollback);
+  try {
+    edgesIndex->_edges_to->insert(const_cast<TRI_doc_mptr_t*>(mptr), true, isRollback);
+  }
+  catch (triagens::basics::Exception const& ex) {
+    // the tables could not be grown, remove the edge from the OUT part again
+    edgesIndex->_edges_from->remove(mptr);
+    return ex.code();
+  }
 
   return TRI_ERROR_NO_ERROR;
 }
@@ -885,14 +896,12 @@ static int RemoveEdge (TRI_index_t* idx,
                        TRI_doc_mptr_t const* mptr,
                        bool isRollback) {
 
-  TRI_multi_pointer_t* edgesIndex;
+  TRI_edge_index_t* edgesIndex = (TRI_edge_index_t*) idx;
 
   // OUT
-  edgesIndex = &(((TRI_edge_index_t*) idx)->_edges_from);
-  TRI_RemoveElementMultiPointer(edgesIndex, mptr);
+  edgesIndex->_edges_from->remove(mptr);
   // IN
-  edgesIndex = &(((TRI_edge_index_t*) idx)->_edges_to);
-  TRI_RemoveElementMultiPointer(edgesIndex, mptr);
+  edgesIndex->_edges_to->remove(mptr);
 
   return TRI_ERROR_NO_ERROR;
 }
@@ -902,8 +911,10 @@ static int RemoveEdge (TRI_index_t* idx,
 ////////////////////////////////////////////////////////////////////////////////
 
 static size_t MemoryEdge (TRI_index_t const* idx) {
-  return TRI_MemoryUsageMultiPointer(&(((TRI_edge_index_t*) idx)->_edges_from)) +
-         TRI_MemoryUsageMultiPointer(&(((TRI_edge_index_t*) idx)->_edges_to));
+  TRI_edge_index_t const* edgesIndex = (TRI_edge_index_t const*) idx;
+
+  return edgesIndex->_edges_from->memoryUsage() +
+         edgesIndex->_edges_to->memoryUsage();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -911,9 +922,11 @@ static size_t MemoryEdge (TRI_index_t const* idx) {
 ////////////////////////////////////////////////////////////////////////////////
 
 static double SelectivityEstimateEdge (TRI_index_t const* idx) {
+  TRI_edge_index_t const* edgesIndex = (TRI_edge_index_t const*) idx;
+
   // return average selectivity of the two index parts
-  return (TRI_SelectivityEstimateMultiPointer(&(((TRI_edge_index_t*) idx)->_edges_from)) +
-          TRI_SelectivityEstimateMultiPointer(&(((TRI_edge_index_t*) idx)->_edges_to))) * 0.5;
+  return (edgesIndex->_edges_from->selectivity() +
+          edgesIndex->_edges_to->selectivity()) * 0.5;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -942,31 +955,22 @@ static TRI_json_t* JsonEdge (TRI_index_t const* idx) {
 static int SizeHintEdge (TRI_index_t* idx,
                          size_t size) {
 
-  int err;
-
-  TRI_multi_pointer_t* edgesIndex = &(((TRI_edge_index_t*) idx)->_edges_from);
+  TRI_edge_index_t* edgesIndex = (TRI_edge_index_t*) idx;
 
   // we assume this is called when setting up the index and the index
   // is still empty
-  TRI_ASSERT(edgesIndex->_nrUsed == 0);
+  TRI_ASSERT(edgesIndex->_edges_from->size() == 0);
+  TRI_ASSERT(edgesIndex->_edges_to->size() == 0);
 
   // set an initial size for the index for some new nodes to be created
   // without resizing
-  err = TRI_ResizeMultiPointer(edgesIndex, size + 2049);
+  int err = edgesIndex->_edges_from->resize(size + 2049);
 
   if (err != TRI_ERROR_NO_ERROR) {
     return err;
   }
 
-  edgesIndex = &(((TRI_edge_index_t*) idx)->_edges_to);
-
-  // we assume this is called when setting up the index and the index
-  // is still empty
-  TRI_ASSERT(edgesIndex->_nrUsed == 0);
-
-  // set an initial size for the index for some new nodes to be created
-  // without resizing
-  return TRI_ResizeMultiPointer(edgesIndex, size + 2049);
+  return edgesIndex->_edges_to->resize(size + 2049);
 }
 
 // -----------------------------------------------------------------------------
@@ -981,7 +985,6 @@ TRI_index_t* TRI_CreateEdgeIndex (TRI_document_collection_t* document,
                                   TRI_idx_iid_t iid) {
   TRI_index_t* idx;
   char* id;
-  int res;
 
   // create index
   TRI_edge_index_t* edgeIndex = static_cast<TRI_edge_index_t*>(TRI_Allocate(TRI_CORE_MEM_ZONE, sizeof(TRI_edge_index_t), false));
@@ -990,27 +993,15 @@ TRI_index_t* TRI_CreateEdgeIndex (TRI_document_collection_t* document,
     return nullptr;
   }
 
-  res = TRI_InitMultiPointer(&edgeIndex->_edges_from,
-                             TRI_UNKNOWN_MEM_ZONE,
-                             HashElementKey,
-                             HashElementEdgeFrom,
-                             IsEqualKeyEdgeFrom,
-                             IsEqualElementEdgeFrom);
+  edgeIndex->_edges_from = nullptr;
+  edgeIndex->_edges_to   = nullptr;
 
-  if (res != TRI_ERROR_NO_ERROR) {
-    TRI_Free(TRI_CORE_MEM_ZONE, edgeIndex);
-
-    return nullptr;
+  try {
+    edgeIndex->_edges_from = new TRI_edge_from_hash_t(TRI_UNKNOWN_MEM_ZONE);
+    edgeIndex->_edges_to   = new TRI_edge_to_hash_t(TRI_UNKNOWN_MEM_ZONE);
   }
-  res = TRI_InitMultiPointer(&edgeIndex->_edges_to,
-                             TRI_UNKNOWN_MEM_ZONE,
-                             HashElementKey,
-                             HashElementEdgeTo,
-                             IsEqualKeyEdgeTo,
-                             IsEqualElementEdgeTo);
-
-  if (res != TRI_ERROR_NO_ERROR) {
-    TRI_DestroyMultiPointer(&edgeIndex->_edges_from);
+  catch (...) {
+    delete edgeIndex->_edges_from;
     TRI_Free(TRI_CORE_MEM_ZONE, edgeIndex);
 
     return nullptr;
@@ -1045,8 +1036,8 @@ void TRI_DestroyEdgeIndex (TRI_index_t* idx) {
 
   LOG_TRACE("destroying edge index");
 
-  TRI_DestroyMultiPointer(&edgesIndex->_edges_to);
-  TRI_DestroyMultiPointer(&edgesIndex->_edges_from);
+  delete edgesIndex->_edges_to;
+  delete edgesIndex->_edges_from;
 
   TRI_DestroyVectorString(&idx->_fields);
 }
@@ -1068,12 +1059,44 @@ void TRI_FreeEdgeIndex (TRI_index_t* idx) {
 // --SECTION--                                                 private functions
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts the vertex handle of a lookup into "cid/key"
+///
+/// Vertex-centric skiplist indexes order the edges by the collection id of
+/// the vertex, so the collection name of the handle is resolved once here
+/// instead of in every comparison. Returns a nullptr if the handle refers to
+/// an unknown collection, as no edge can match it then.
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_json_t* VertexLookupValue (TRI_document_collection_t* document,
+                                      TRI_json_t const* json) {
+  char const* handle = json->_value._string.data;
+  size_t const length = json->_value._string.length - 1;
+  char const* separator = static_cast<char const*>(memchr(handle, TRI_DOCUMENT_HANDLE_SEPARATOR_CHR, length));
+
+  if (separator == nullptr) {
+    return nullptr;
+  }
+
+  triagens::arango::CollectionNameResolver resolver(document->_vocbase);
+  TRI_voc_cid_t cid = resolver.getCollectionIdCluster(std::string(handle, separator - handle));
+
+  if (cid == 0) {
+    return nullptr;
+  }
+
+  std::string const value = std::to_string(cid) + std::string(separator, length - (separator - handle));
+
+  return TRI_CreateStringCopyJson(TRI_UNKNOWN_MEM_ZONE, value.c_str(), value.size());
+}
+
 // .............................................................................
 // Helper function for TRI_LookupSkiplistIndex
 // .............................................................................
 
 static int FillLookupSLOperator (TRI_index_operator_t* slOperator,
-                                 TRI_document_collection_t* document) {
+                                 TRI_document_collection_t* document,
+                                 TRI_skiplist_vertex_e vertex) {
   if (slOperator == nullptr) {
     return TRI_ERROR_INTERNAL;
   }
@@ -1083,10 +1106,10 @@ static int FillLookupSLOperator (TRI_index_operator_t* slOperator,
     case TRI_NOT_INDEX_OPERATOR:
     case TRI_OR_INDEX_OPERATOR: {
       TRI_logical_index_operator_t* logicalOperator = (TRI_logical_index_operator_t*) slOperator;
-      int result = FillLookupSLOperator(logicalOperator->_left, document);
+      int result = FillLookupSLOperator(logicalOperator->_left, document, vertex);
 
       if (result == TRI_ERROR_NO_ERROR) {
-        result = FillLookupSLOperator(logicalOperator->_right, document);
+        result = FillLookupSLOperator(logicalOperator->_right, document, vertex);
       }
       if (result != TRI_ERROR_NO_ERROR) {
         return result;
@@ -1124,9 +1147,30 @@ static int FillLookupSLOperator (TRI_index_operator_t* slOperator,
             return TRI_ERROR_BAD_PARAMETER;
           }
 
+          TRI_json_t* vertexObject = nullptr;
+
+          if (j == 0 && 
+              vertex != TRI_SKIPLIST_VERTEX_NONE &&
+              TRI_IsStringJson(jsonObject)) {
+            vertexObject = VertexLookupValue(document, jsonObject);
+
+            if (vertexObject == nullptr) {
+              // unknown vertex collection
+              TRI_Free(TRI_UNKNOWN_MEM_ZONE, relationOperator->_fields);
+              relationOperator->_fields = nullptr;
+              return TRI_RESULT_ELEMENT_NOT_FOUND;
+            }
+
+            jsonObject = vertexObject;
+          }
+
           // now shape the search object (but never create any new shapes)
           TRI_shaped_json_t* shapedObject = TRI_ShapedJsonJson(document->getShaper(), jsonObject, false);  // ONLY IN INDEX, PROTECTED by RUNTIME
 
+          if (vertexObject != nullptr) {
+            TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, vertexObject);
+          }
+
           if (shapedObject != nullptr) {
             // found existing shape
             relationOperator->_fields[j] = *shapedObject; // shallow copy here is ok
@@ -1174,7 +1218,9 @@ TRI_skiplist_iterator_t* TRI_LookupSkiplistIndex (TRI_index_t* idx,
   // .........................................................................
 
   TRI_skiplist_index_t* skiplistIndex = (TRI_skiplist_index_t*) idx;
-  int errorResult = FillLookupSLOperator(slOperator, skiplistIndex->base._collection);
+  int errorResult = FillLookupSLOperator(slOperator, 
+                                         skiplistIndex->base._collection,
+                                         skiplistIndex->_skiplistIndex->_vertex);
 
   if (errorResult != TRI_ERROR_NO_ERROR) {
     TRI_set_errno(errorResult);
@@ -1225,6 +1271,12 @@ static int SkiplistIndexHelper (TRI_skiplist_index_t const* skiplistIndex,
   auto subObjects = SkiplistIndex_Subobjects(skiplistElement);
 
   for (size_t j = 0; j < skiplistIndex->_paths._length; ++j) {
+    if (j == 0 && skiplistIndex->_skiplistIndex->_vertex != TRI_SKIPLIST_VERTEX_NONE) {
+      // the vertex is taken from the edge marker by the index itself
+      subObjects[j]._sid = BasicShapes::TRI_SHAPE_SID_NULL; 
+      continue;
+    }
+
     TRI_shape_pid_t shape = *((TRI_shape_pid_t*) TRI_AtVector(&skiplistIndex->_paths, j));
 
     // ..........................................................................
@@ -1486,9 +1538,25 @@ TRI_index_t* TRI_CreateSkiplistIndex (TRI_document_collection_t* document,
   TRI_InitVectorString(&idx->_fields, TRI_CORE_MEM_ZONE);
   TRI_CopyDataFromVectorPointerVectorString(TRI_CORE_MEM_ZONE, &idx->_fields, fields);
 
+  // a skiplist index on an edge collection starting with _from or _to is
+  // vertex-centric
+  TRI_skiplist_vertex_e vertex = TRI_SKIPLIST_VERTEX_NONE;
+
+  if (document->_info._type == TRI_COL_TYPE_EDGE && fields->_length > 0) {
+    char const* first = static_cast<char const*>(fields->_buffer[0]);
+
+    if (TRI_EqualString(first, TRI_VOC_ATTRIBUTE_FROM)) {
+      vertex = TRI_SKIPLIST_VERTEX_FROM;
+    }
+    else if (TRI_EqualString(first, TRI_VOC_ATTRIBUTE_TO)) {
+      vertex = TRI_SKIPLIST_VERTEX_TO;
+    }
+  }
+
   skiplistIndex->_skiplistIndex = SkiplistIndex_new(document,
                                                     paths->_length,
-                                                    unique);
+                                                    unique,
+                                                    vertex);
 
   if (skiplistIndex->_skiplistIndex == nullptr) {
     TRI_DestroyVector(&skiplistIndex->_paths);
@@ -34,7 +34,7 @@
 
 #include "VocBase/vocbase.h"
 
-#include "Basics/associative-multi.h"
+#include "Basics/AssocMulti.h"
 #include "Basics/json.h"
 #include "FulltextIndex/fulltext-index.h"
 #include "GeoIndex/GeoIndex.h"
@@ -50,6 +50,7 @@
 struct TRI_collection_t;
 struct TRI_doc_mptr_t;
 struct TRI_shaped_json_s;
+struct TRI_edge_header_s;
 struct TRI_document_collection_t;
 struct TRI_transaction_collection_s;
 
@@ -146,9 +147,43 @@ typedef struct TRI_geo_index_s {
 
   bool _geoJson;
   bool _constraint;
+
+  size_t _count;  // number of documents in the index
+
+  // documents without valid coordinates, which are not in the index
+  std::unordered_set<struct TRI_doc_mptr_t const*>* _unindexed;
 }
 TRI_geo_index_t;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash and comparison functions of the edge index (_from case)
+////////////////////////////////////////////////////////////////////////////////
+
+struct TRI_edge_from_desc_t {
+  uint64_t hashKey (struct TRI_edge_header_s const*) const;
+  uint64_t hashElement (struct TRI_doc_mptr_t const*, bool) const;
+  bool isEqualKeyElement (struct TRI_edge_header_s const*, struct TRI_doc_mptr_t const*) const;
+  bool isEqualElementElement (struct TRI_doc_mptr_t const*, struct TRI_doc_mptr_t const*, bool) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash and comparison functions of the edge index (_to case)
+////////////////////////////////////////////////////////////////////////////////
+
+struct TRI_edge_to_desc_t {
+  uint64_t hashKey (struct TRI_edge_header_s const*) const;
+  uint64_t hashElement (struct TRI_doc_mptr_t const*, bool) const;
+  bool isEqualKeyElement (struct TRI_edge_header_s const*, struct TRI_doc_mptr_t const*) const;
+  bool isEqualElementElement (struct TRI_doc_mptr_t const*, struct TRI_doc_mptr_t const*, bool) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hash tables of the edge index
+////////////////////////////////////////////////////////////////////////////////
+
+typedef triagens::basics::AssocMulti<struct TRI_edge_header_s, struct TRI_doc_mptr_t, TRI_edge_from_desc_t> TRI_edge_from_hash_t;
+typedef triagens::basics::AssocMulti<struct TRI_edge_header_s, struct TRI_doc_mptr_t, TRI_edge_to_desc_t> TRI_edge_to_hash_t;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief edge index
 ////////////////////////////////////////////////////////////////////////////////
@@ -156,8 +191,8 @@ TRI_geo_index_t;
 typedef struct TRI_edge_index_s {
   TRI_index_t base;
 
-  TRI_multi_pointer_t _edges_from;
-  TRI_multi_pointer_t _edges_to;
+  TRI_edge_from_hash_t* _edges_from;
+  TRI_edge_to_hash_t*   _edges_to;
 }
 TRI_edge_index_t;
 
@@ -297,10 +297,11 @@ static int StringifyMarkerDump (TRI_replication_dump_t* dump,
                                 bool withTicks,
                                 bool translateCollectionIds,
                                 triagens::arango::CollectionNameResolver* resolver) {
-  // This covers two cases:
+  // This covers three cases:
   //   1. document is not nullptr and marker points into a data file
   //   2. document is a nullptr and marker points into a WAL file
-  // no other combinations are allowed.
+  //   3. document is not nullptr and marker points into a WAL file. this
+  //      happens when documents are looked up via the primary index
 
   TRI_string_buffer_t* buffer;
   TRI_replication_operation_e type;
@@ -345,7 +346,6 @@ static int StringifyMarkerDump (TRI_replication_dump_t* dump,
     }
 
     case TRI_WAL_MARKER_REMOVE: {
-      TRI_ASSERT(nullptr == document);
       auto m = static_cast<wal::remove_marker_t const*>(marker);
       key = ((char*) m) + sizeof(wal::remove_marker_t);
       type = REPLICATION_MARKER_REMOVE;
@@ -356,7 +356,6 @@ static int StringifyMarkerDump (TRI_replication_dump_t* dump,
     }
 
     case TRI_WAL_MARKER_DOCUMENT: {
-      TRI_ASSERT(nullptr == document);
       auto m = static_cast<wal::document_marker_t const*>(marker);
       key = ((char*) m) + m->_offsetKey;
       type = REPLICATION_MARKER_DOCUMENT;
@@ -366,7 +365,6 @@ static int StringifyMarkerDump (TRI_replication_dump_t* dump,
     }
 
     case TRI_WAL_MARKER_EDGE: {
-      TRI_ASSERT(nullptr == document);
       auto m = static_cast<wal::edge_marker_t const*>(marker);
       key = ((char*) m) + m->_offsetKey;
       type = REPLICATION_MARKER_EDGE;
@@ -463,12 +461,19 @@ static int StringifyMarkerDump (TRI_replication_dump_t* dump,
       auto m = static_cast<wal::document_marker_t const*>(marker);
       TRI_EXTRACT_SHAPED_JSON_MARKER(shaped, m);
       char const* legend = reinterpret_cast<char const*>(m) + m->_offsetLegend;
-      if (m->_offsetJson - m->_offsetLegend == 8) {
-        auto p = reinterpret_cast<int64_t const*>(legend);
-        legend += *p;
+
+      if (document != nullptr && *((uint64_t const*) legend) == 0ULL) {
+        // marker has no legend, but all its shapes are known to the collection
+        TRI_StringifyArrayShapedJson(document->getShaper(), buffer, &shaped, true);
+      }
+      else {
+        if (m->_offsetJson - m->_offsetLegend == 8) {
+          auto p = reinterpret_cast<int64_t const*>(legend);
+          legend += *p;
+        }
+        basics::LegendReader legendReader(legend);
+        TRI_StringifyArrayShapedJson(&legendReader, buffer, &shaped, true);
       }
-      basics::LegendReader legendReader(legend);
-      TRI_StringifyArrayShapedJson(&legendReader, buffer, &shaped, true);
     }
 
     APPEND_STRING(buffer, "}}\n");
@@ -1474,6 +1479,167 @@ int TRI_DumpLogReplication (TRI_replication_dump_t* dump,
   return res;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collect the keys and revisions of all documents in a collection,
+/// sorted by key. the caller must hold the collection's read lock
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_CollectKeysReplication (TRI_document_collection_t* document,
+                                 std::vector<TRI_replication_key_t>& keys) {
+  size_t const n = static_cast<size_t>(document->_primaryIndex._nrAlloc);
+
+  keys.clear();
+  keys.reserve(static_cast<size_t>(document->_primaryIndex._nrUsed));
+
+  for (size_t i = 0; i < n; ++i) {
+    auto mptr = static_cast<TRI_doc_mptr_t const*>(document->_primaryIndex._table[i]);
+
+    if (mptr != nullptr) {
+      keys.emplace_back(std::string(TRI_EXTRACT_MARKER_KEY(mptr)), mptr->_rid);
+    }
+  }
+
+  std::sort(keys.begin(), keys.end(), [] (TRI_replication_key_t const& lhs, TRI_replication_key_t const& rhs) {
+    return lhs.first < rhs.first;
+  });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculate the checksum of the keys in the range [from, to)
+///
+/// the checksum depends on the order of the keys, so both sides of a
+/// comparison must use the same sort order
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TRI_ChecksumKeysReplication (std::vector<TRI_replication_key_t> const& keys,
+                                      size_t from,
+                                      size_t to) {
+  uint64_t hash = TRI_FnvHashBlockInitial();
+  char buffer[21];
+
+  for (size_t i = from; i < to; ++i) {
+    auto const& key = keys[i];
+    // include the terminating NUL byte so "ab"/"c" and "a"/"bc" hash differently
+    hash = TRI_FnvHashBlock(hash, key.first.c_str(), key.first.size() + 1);
+
+    size_t length = TRI_StringUInt64InPlace(static_cast<uint64_t>(key.second), buffer);
+    hash = TRI_FnvHashBlock(hash, buffer, length + 1);
+  }
+
+  return hash;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the key ranges of a collection with their checksums
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_DumpKeyChunksReplication (TRI_replication_dump_t* dump,
+                                  std::vector<TRI_replication_key_t> const& keys,
+                                  size_t chunkSize) {
+  TRI_string_buffer_t* buffer = dump->_buffer;
+  size_t const n = keys.size();
+
+  if (chunkSize == 0) {
+    return TRI_ERROR_BAD_PARAMETER;
+  }
+
+  APPEND_CHAR(buffer, '[');
+
+  for (size_t from = 0; from < n; from += chunkSize) {
+    size_t const to = (std::min)(from + chunkSize, n);
+
+    if (from > 0) {
+      APPEND_CHAR(buffer, ',');
+    }
+
+    // keys are user-defined, but do not need escaping
+    APPEND_STRING(buffer, "{\"low\":\"");
+    APPEND_STRING(buffer, keys[from].first.c_str());
+    APPEND_STRING(buffer, "\",\"high\":\"");
+    APPEND_STRING(buffer, keys[to - 1].first.c_str());
+    APPEND_STRING(buffer, "\",\"count\":");
+    APPEND_UINT64(buffer, (uint64_t) (to - from));
+    APPEND_STRING(buffer, ",\"hash\":\"");
+    APPEND_UINT64(buffer, TRI_ChecksumKeysReplication(keys, from, to));
+    APPEND_STRING(buffer, "\"}");
+  }
+
+  APPEND_CHAR(buffer, ']');
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the keys and revisions of a key range
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_DumpKeysReplication (TRI_replication_dump_t* dump,
+                             std::vector<TRI_replication_key_t> const& keys,
+                             std::string const& low,
+                             std::string const& high) {
+  TRI_string_buffer_t* buffer = dump->_buffer;
+
+  auto it = std::lower_bound(keys.begin(), keys.end(), low, [] (TRI_replication_key_t const& lhs, std::string const& rhs) {
+    return lhs.first < rhs;
+  });
+
+  APPEND_CHAR(buffer, '[');
+
+  bool first = true;
+
+  while (it != keys.end() && (*it).first <= high) {
+    if (first) {
+      first = false;
+    }
+    else {
+      APPEND_CHAR(buffer, ',');
+    }
+
+    APPEND_STRING(buffer, "[\"");
+    APPEND_STRING(buffer, (*it).first.c_str());
+    APPEND_STRING(buffer, "\",\"");
+    APPEND_UINT64(buffer, (uint64_t) (*it).second);
+    APPEND_STRING(buffer, "\"]");
+
+    ++it;
+  }
+
+  APPEND_CHAR(buffer, ']');
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the documents with the specified keys, using the dump format
+/// the caller must hold the collection's read lock
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_DumpDocumentsReplication (TRI_replication_dump_t* dump,
+                                  TRI_document_collection_t* document,
+                                  std::vector<std::string> const& keys) {
+  triagens::arango::CollectionNameResolver resolver(dump->_vocbase);
+
+  for (auto const& key : keys) {
+    auto mptr = static_cast<TRI_doc_mptr_t const*>(TRI_LookupByKeyPrimaryIndex(&document->_primaryIndex, key.c_str()));
+
+    if (mptr == nullptr) {
+      // document was removed in the meantime. the slave will pick this up
+      // from the continuous replication
+      continue;
+    }
+
+    auto marker = static_cast<TRI_df_marker_t const*>(mptr->getDataPtr());
+
+    int res = StringifyMarkerDump(dump, document, marker, false, true, &resolver);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
@@ -44,6 +44,7 @@
 // --SECTION--                                              forward declarations
 // -----------------------------------------------------------------------------
 
+struct TRI_document_collection_t;
 struct TRI_shape_s;
 struct TRI_vocbase_col_s;
 
@@ -107,6 +108,12 @@ struct TRI_replication_dump_t {
   bool                         _includeSystem;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a document key with its revision, used for key-range checksums
+////////////////////////////////////////////////////////////////////////////////
+
+typedef std::pair<std::string, TRI_voc_rid_t> TRI_replication_key_t;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  public functions
 // -----------------------------------------------------------------------------
@@ -131,6 +138,48 @@ int TRI_DumpLogReplication (TRI_replication_dump_t*,
                             TRI_voc_tick_t,
                             bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collect the keys and revisions of all documents in a collection,
+/// sorted by key. the caller must hold the collection's read lock
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_CollectKeysReplication (struct TRI_document_collection_t*,
+                                 std::vector<TRI_replication_key_t>&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief calculate the checksum of the keys in the range [from, to)
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t TRI_ChecksumKeysReplication (std::vector<TRI_replication_key_t> const&,
+                                      size_t,
+                                      size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the key ranges of a collection with their checksums
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_DumpKeyChunksReplication (TRI_replication_dump_t*,
+                                  std::vector<TRI_replication_key_t> const&,
+                                  size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the keys and revisions of a key range
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_DumpKeysReplication (TRI_replication_dump_t*,
+                             std::vector<TRI_replication_key_t> const&,
+                             std::string const&,
+                             std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief dump the documents with the specified keys, using the dump format
+/// the caller must hold the collection's read lock
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_DumpDocumentsReplication (TRI_replication_dump_t*,
+                                  struct TRI_document_collection_t*,
+                                  std::vector<std::string> const&);
+
 #endif
 
 // -----------------------------------------------------------------------------
@@ -769,6 +769,238 @@ static void UpdateTransactionStatus (TRI_transaction_t* const trx,
   trx->_status = status;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief make a marker refer to a legend that is already in the logfile
+////////////////////////////////////////////////////////////////////////////////
+
+static void SetLegendReference (char* marker,
+                                void const* oldLegend) {
+  auto m = reinterpret_cast<triagens::wal::document_marker_t*>(marker);
+  int64_t* legendPtr = reinterpret_cast<int64_t*>
+                       (marker + m->_offsetLegend);
+  *legendPtr =  reinterpret_cast<char const*>(oldLegend) 
+               -reinterpret_cast<char*>(legendPtr);
+  // This means that we can find the old legend relative to
+  // the new position in the same WAL file.
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prepare a transaction for adding WAL operations
+////////////////////////////////////////////////////////////////////////////////
+
+static int PrepareOperations (TRI_transaction_collection_t* trxCollection,
+                              bool& waitForSync) {
+  TRI_transaction_t* trx = trxCollection->_transaction;
+
+  bool const isSingleOperationTransaction = IsSingleOperationTransaction(trx);
+
+  // upgrade the info for the transaction
+  if (waitForSync || trxCollection->_waitForSync) {
+    trx->_waitForSync = true;
+  }
+
+  // default is false
+  waitForSync = false;
+  if (isSingleOperationTransaction) {
+    waitForSync |= trxCollection->_waitForSync;
+  }
+  
+
+  TRI_IF_FAILURE("TransactionOperationNoSlot") {
+    return TRI_ERROR_DEBUG;
+  }
+
+  TRI_IF_FAILURE("TransactionOperationNoSlotExcept") {
+    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  }
+      
+  if (! trx->_beginWritten) {
+    int res = WriteBeginMarker(trx);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write the marker of a WAL operation into the logfiles
+////////////////////////////////////////////////////////////////////////////////
+
+static int WriteOperationMarker (triagens::wal::DocumentOperation& operation,
+                                 TRI_voc_fid_t& fid,
+                                 void const*& position,
+                                 int64_t& sizeChanged) {
+  TRI_document_collection_t* document = operation.trxCollection->_collection->_collection;
+
+  if (operation.marker->fid() == 0) {
+    // this is a "real" marker that must be written into the logfiles
+    char* oldmarker = static_cast<char*>(operation.marker->mem());
+    auto oldm = reinterpret_cast<triagens::wal::document_marker_t*>(oldmarker);
+    if ((oldm->_type == TRI_WAL_MARKER_DOCUMENT ||
+         oldm->_type == TRI_WAL_MARKER_EDGE) &&
+         ! triagens::wal::LogfileManager::instance()->suppressShapeInformation()) {
+      // In this case we have to take care of the legend, we know that the
+      // marker does not have a legend so far, so first try to get away 
+      // with this:
+      // (Note that the latter also works for edges!
+      TRI_voc_cid_t cid = oldm->_collectionId;
+      TRI_shape_sid_t sid = oldm->_shape;
+      void* oldLegend;
+      triagens::wal::SlotInfoCopy slotInfo = triagens::wal::LogfileManager::instance()->allocateAndWrite(oldmarker, operation.marker->size(), false, cid, sid, 0, oldLegend);
+      if (slotInfo.errorCode == TRI_ERROR_LEGEND_NOT_IN_WAL_FILE) {
+        // Oh dear, we have to build a legend and patch the marker:
+        triagens::basics::JsonLegend legend(document->getShaper());  // PROTECTED by trx in trxCollection
+        int res = legend.addShape(sid, oldmarker + oldm->_offsetJson,
+                                       oldm->_size - oldm->_offsetJson);
+        if (res != TRI_ERROR_NO_ERROR) {
+          return res;
+        }
+        else {
+          sizeChanged =   legend.getSize() 
+                        - (oldm->_offsetJson - oldm->_offsetLegend);
+          TRI_voc_size_t newMarkerSize = (TRI_voc_size_t) (oldm->_size + sizeChanged);
+
+          // Now construct the new marker on the heap:
+          char* newmarker = new char[newMarkerSize];
+          memcpy(newmarker, oldmarker, oldm->_offsetLegend);
+          legend.dump(newmarker + oldm->_offsetLegend);
+          memcpy(newmarker + oldm->_offsetLegend + legend.getSize(), 
+                 oldmarker + oldm->_offsetJson,
+                 oldm->_size - oldm->_offsetJson);
+
+          // And fix its entries:
+          auto newm = reinterpret_cast<triagens::wal::document_marker_t*>(newmarker);
+          newm->_size = newMarkerSize;
+          newm->_offsetJson = (uint32_t) (oldm->_offsetLegend + legend.getSize());
+          triagens::wal::SlotInfoCopy slotInfo2 = triagens::wal::LogfileManager::instance()->allocateAndWrite(newmarker, newMarkerSize, false, cid, sid, newm->_offsetLegend, oldLegend);
+          delete[] newmarker;
+          if (slotInfo2.errorCode != TRI_ERROR_NO_ERROR) {
+            return slotInfo2.errorCode;
+          }
+          fid = slotInfo2.logfileId;
+          position = slotInfo2.mem; 
+          operation.tick = slotInfo2.tick;
+        }
+      }
+      else if (slotInfo.errorCode != TRI_ERROR_NO_ERROR) {
+        return slotInfo.errorCode;
+      }
+      else {
+        SetLegendReference(oldmarker, oldLegend);
+        operation.tick = slotInfo.tick;
+        fid = slotInfo.logfileId;
+        position = slotInfo.mem; 
+      }
+
+    }
+    else {  
+      // No document or edge marker, just append it to the WAL:
+      triagens::wal::SlotInfoCopy slotInfo = triagens::wal::LogfileManager::instance()->allocateAndWrite(operation.marker->mem(), operation.marker->size(), false);
+      if (slotInfo.errorCode != TRI_ERROR_NO_ERROR) {
+        // some error occurred
+        return slotInfo.errorCode;
+      }
+      operation.tick = slotInfo.tick;
+      fid = slotInfo.logfileId;
+      position = slotInfo.mem; 
+    }
+  }
+  else {
+    // this is an envelope marker that has been written to the logfiles before
+    // avoid writing it again!
+    fid = operation.marker->fid();
+    position = operation.marker->mem();
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief apply a WAL operation after its marker has been written
+////////////////////////////////////////////////////////////////////////////////
+
+static int ApplyOperation (triagens::wal::DocumentOperation& operation,
+                           TRI_voc_fid_t fid,
+                           void const* position,
+                           int64_t sizeChanged) {
+  TRI_transaction_collection_t* trxCollection = operation.trxCollection;
+  TRI_transaction_t* trx = trxCollection->_transaction;
+  TRI_document_collection_t* document = trxCollection->_collection->_collection;
+
+  bool const isSingleOperationTransaction = IsSingleOperationTransaction(trx);
+
+  TRI_ASSERT(fid > 0);
+  TRI_ASSERT(position != nullptr);
+  
+  if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT ||
+      operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE) {
+    // adjust the data position in the header
+    operation.header->setDataPtr(position);  // PROTECTED by ongoing trx from operation
+    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT && sizeChanged) {
+      document->_headersPtr->adjustTotalSize(0, sizeChanged);
+    }
+  }
+  
+  TRI_IF_FAILURE("TransactionOperationAfterAdjust") {
+    return TRI_ERROR_DEBUG;
+  }
+
+  // set header file id
+  operation.header->_fid = fid;
+
+  TRI_ASSERT(operation.header->_fid > 0);
+
+  if (isSingleOperationTransaction) {
+    // operation is directly executed
+    operation.handle();
+
+    ++document->_uncollectedLogfileEntries;
+
+    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE ||
+        operation.type == TRI_VOC_DOCUMENT_OPERATION_REMOVE) {
+      // update datafile statistics for the old header
+      TRI_ASSERT(operation.oldHeader._fid > 0);
+       
+      TRI_LOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+
+      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, operation.oldHeader._fid, false);
+      // the old header might point to the WAL. in this case, there'll be no stats update
+
+      if (dfi != nullptr) {
+        TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(operation.oldHeader.getDataPtr());  // PROTECTED by trx from above
+        dfi->_numberDead += 1;
+        dfi->_sizeDead += TRI_DF_ALIGN_BLOCK(marker->_size);
+        dfi->_numberAlive -= 1;
+        dfi->_sizeAlive -= TRI_DF_ALIGN_BLOCK(marker->_size);
+      }
+      
+      TRI_UNLOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+    }
+  }
+  else {
+    // operation is buffered and might be rolled back
+    if (trxCollection->_operations == nullptr) {
+      trxCollection->_operations = new std::vector<triagens::wal::DocumentOperation*>;
+      trx->_hasOperations = true;
+    }
+
+    triagens::wal::DocumentOperation* copy = operation.swap();
+    trxCollection->_operations->push_back(copy);
+    copy->handle();
+  }
+
+  TRI_UpdateRevisionDocumentCollection(document, operation.rid, false);
+  
+  TRI_IF_FAILURE("TransactionOperationAtEnd") {
+    return TRI_ERROR_DEBUG;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                        constructors / destructors
 // -----------------------------------------------------------------------------
@@ -1083,196 +1315,137 @@ bool TRI_IsLockedCollectionTransaction (TRI_transaction_collection_t const* trxC
 
 int TRI_AddOperationTransaction (triagens::wal::DocumentOperation& operation,
                                  bool& waitForSync) {
-  TRI_transaction_collection_t* trxCollection = operation.trxCollection;
-  TRI_transaction_t* trx = trxCollection->_transaction;
-
   TRI_ASSERT(operation.header != nullptr);
 
-  bool const isSingleOperationTransaction = IsSingleOperationTransaction(trx);
+  int res = PrepareOperations(operation.trxCollection, waitForSync);
 
-  // upgrade the info for the transaction
-  if (waitForSync || trxCollection->_waitForSync) {
-    trx->_waitForSync = true;
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
   }
 
-  // default is false
-  waitForSync = false;
-  if (isSingleOperationTransaction) {
-    waitForSync |= trxCollection->_waitForSync;
-  }
-  
+  TRI_voc_fid_t fid = 0;
+  void const* position = nullptr;
+  int64_t sizeChanged = 0;
 
-  TRI_IF_FAILURE("TransactionOperationNoSlot") {
-    return TRI_ERROR_DEBUG;
+  res = WriteOperationMarker(operation, fid, position, sizeChanged);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
   }
 
-  TRI_IF_FAILURE("TransactionOperationNoSlotExcept") {
-    THROW_ARANGO_EXCEPTION(TRI_ERROR_DEBUG);
+  return ApplyOperation(operation, fid, position, sizeChanged);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief add many WAL operations for the same transaction collection
+///
+/// the markers of the operations are written into the logfiles in batches,
+/// using one slot acquisition for many markers. markers that need a legend
+/// not yet contained in the logfile, and envelope markers, are handled one by
+/// one as in TRI_AddOperationTransaction. the operations are applied in order.
+/// the number of operations applied is returned in applied. in case of an
+/// error, the remaining operations are left untouched and must be reverted by
+/// the caller
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_AddOperationsTransaction (std::vector<triagens::wal::DocumentOperation*>& operations,
+                                  bool& waitForSync,
+                                  size_t& applied) {
+  applied = 0;
+
+  size_t const n = operations.size();
+
+  if (n == 0) {
+    return TRI_ERROR_NO_ERROR;
   }
-      
-  if (! trx->_beginWritten) {
-    int res = WriteBeginMarker(trx);
 
-    if (res != TRI_ERROR_NO_ERROR) {
-      return res;
-    }
+  int res = PrepareOperations(operations[0]->trxCollection, waitForSync);
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
   }
 
-  TRI_voc_fid_t fid = 0;
-  void const* position = nullptr;
+  auto logfileManager = triagens::wal::LogfileManager::instance();
+  bool const suppressShapeInformation = logfileManager->suppressShapeInformation();
 
-  int64_t sizeChanged = 0;
-  TRI_document_collection_t* document = operation.trxCollection->_collection->_collection;
+  std::vector<triagens::wal::SlotBatchEntry> entries;
+  entries.reserve(n);
 
-  if (operation.marker->fid() == 0) {
-    // this is a "real" marker that must be written into the logfiles
-    char* oldmarker = static_cast<char*>(operation.marker->mem());
-    auto oldm = reinterpret_cast<triagens::wal::document_marker_t*>(oldmarker);
-    if ((oldm->_type == TRI_WAL_MARKER_DOCUMENT ||
-         oldm->_type == TRI_WAL_MARKER_EDGE) &&
-         ! triagens::wal::LogfileManager::instance()->suppressShapeInformation()) {
-      // In this case we have to take care of the legend, we know that the
-      // marker does not have a legend so far, so first try to get away 
-      // with this:
-      // (Note that the latter also works for edges!
-      TRI_voc_cid_t cid = oldm->_collectionId;
-      TRI_shape_sid_t sid = oldm->_shape;
-      void* oldLegend;
-      triagens::wal::SlotInfoCopy slotInfo = triagens::wal::LogfileManager::instance()->allocateAndWrite(oldmarker, operation.marker->size(), false, cid, sid, 0, oldLegend);
-      if (slotInfo.errorCode == TRI_ERROR_LEGEND_NOT_IN_WAL_FILE) {
-        // Oh dear, we have to build a legend and patch the marker:
-        triagens::basics::JsonLegend legend(document->getShaper());  // PROTECTED by trx in trxCollection
-        int res = legend.addShape(sid, oldmarker + oldm->_offsetJson,
-                                       oldm->_size - oldm->_offsetJson);
-        if (res != TRI_ERROR_NO_ERROR) {
-          return res;
-        }
-        else {
-          sizeChanged =   legend.getSize() 
-                        - (oldm->_offsetJson - oldm->_offsetLegend);
-          TRI_voc_size_t newMarkerSize = (TRI_voc_size_t) (oldm->_size + sizeChanged);
+  while (applied < n) {
+    TRI_ASSERT(operations[applied]->header != nullptr);
+    TRI_ASSERT(operations[applied]->trxCollection == operations[0]->trxCollection);
 
-          // Now construct the new marker on the heap:
-          char* newmarker = new char[newMarkerSize];
-          memcpy(newmarker, oldmarker, oldm->_offsetLegend);
-          legend.dump(newmarker + oldm->_offsetLegend);
-          memcpy(newmarker + oldm->_offsetLegend + legend.getSize(), 
-                 oldmarker + oldm->_offsetJson,
-                 oldm->_size - oldm->_offsetJson);
+    // gather all following "real" markers that must be written into the logfiles
+    entries.clear();
 
-          // And fix its entries:
-          auto newm = reinterpret_cast<triagens::wal::document_marker_t*>(newmarker);
-          newm->_size = newMarkerSize;
-          newm->_offsetJson = (uint32_t) (oldm->_offsetLegend + legend.getSize());
-          triagens::wal::SlotInfoCopy slotInfo2 = triagens::wal::LogfileManager::instance()->allocateAndWrite(newmarker, newMarkerSize, false, cid, sid, newm->_offsetLegend, oldLegend);
-          delete[] newmarker;
-          if (slotInfo2.errorCode != TRI_ERROR_NO_ERROR) {
-            return slotInfo2.errorCode;
-          }
-          fid = slotInfo2.logfileId;
-          position = slotInfo2.mem; 
-          operation.tick = slotInfo2.tick;
-        }
-      }
-      else if (slotInfo.errorCode != TRI_ERROR_NO_ERROR) {
-        return slotInfo.errorCode;
-      }
-      else {
-        int64_t* legendPtr = reinterpret_cast<int64_t*>
-                             (oldmarker + oldm->_offsetLegend);
-        *legendPtr =  reinterpret_cast<char*>(oldLegend) 
-                     -reinterpret_cast<char*>(legendPtr);
-        // This means that we can find the old legend relative to
-        // the new position in the same WAL file.
-        operation.tick = slotInfo.tick;
-        fid = slotInfo.logfileId;
-        position = slotInfo.mem; 
-      }
+    for (size_t i = applied; i < n && operations[i]->marker->fid() == 0; ++i) {
+      char* marker = static_cast<char*>(operations[i]->marker->mem());
+      auto m = reinterpret_cast<triagens::wal::document_marker_t*>(marker);
+      bool const needsLegend = ((m->_type == TRI_WAL_MARKER_DOCUMENT ||
+                                 m->_type == TRI_WAL_MARKER_EDGE) &&
+                                ! suppressShapeInformation);
 
+      entries.emplace_back(marker,
+                           operations[i]->marker->size(),
+                           needsLegend ? m->_collectionId : 0,
+                           needsLegend ? m->_shape : 0,
+                           needsLegend);
     }
-    else {  
-      // No document or edge marker, just append it to the WAL:
-      triagens::wal::SlotInfoCopy slotInfo = triagens::wal::LogfileManager::instance()->allocateAndWrite(operation.marker->mem(), operation.marker->size(), false);
-      if (slotInfo.errorCode != TRI_ERROR_NO_ERROR) {
-        // some error occurred
-        return slotInfo.errorCode;
-      }
-      operation.tick = slotInfo.tick;
-      fid = slotInfo.logfileId;
-      position = slotInfo.mem; 
-    }
-  }
-  else {
-    // this is an envelope marker that has been written to the logfiles before
-    // avoid writing it again!
-    fid = operation.marker->fid();
-    position = operation.marker->mem();
-  }
-   
-  TRI_ASSERT(fid > 0);
-  TRI_ASSERT(position != nullptr);
-  
-  if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT ||
-      operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE) {
-    // adjust the data position in the header
-    operation.header->setDataPtr(position);  // PROTECTED by ongoing trx from operation
-    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_INSERT && sizeChanged) {
-      document->_headersPtr->adjustTotalSize(0, sizeChanged);
-    }
-  }
-  
-  TRI_IF_FAILURE("TransactionOperationAfterAdjust") {
-    return TRI_ERROR_DEBUG;
-  }
 
-  // set header file id
-  operation.header->_fid = fid;
+    size_t written = 0;
+    res = TRI_ERROR_NO_ERROR;
 
-  TRI_ASSERT(operation.header->_fid > 0);
+    if (! entries.empty()) {
+      res = logfileManager->allocateAndWrite(&entries[0], entries.size(), false, written);
+    }
 
-  if (isSingleOperationTransaction) {
-    // operation is directly executed
-    operation.handle();
+    for (size_t i = 0; i < written; ++i) {
+      auto& entry = entries[i];
+      auto& operation = *operations[applied];
 
-    ++document->_uncollectedLogfileEntries;
+      if (entry.needsLegend) {
+        SetLegendReference(static_cast<char*>(entry.src), entry.oldLegend);
+      }
 
-    if (operation.type == TRI_VOC_DOCUMENT_OPERATION_UPDATE ||
-        operation.type == TRI_VOC_DOCUMENT_OPERATION_REMOVE) {
-      // update datafile statistics for the old header
-      TRI_ASSERT(operation.oldHeader._fid > 0);
-       
-      TRI_LOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+      operation.tick = entry.tick;
 
-      TRI_doc_datafile_info_t* dfi = TRI_FindDatafileInfoDocumentCollection(document, operation.oldHeader._fid, false);
-      // the old header might point to the WAL. in this case, there'll be no stats update
+      int res2 = ApplyOperation(operation, static_cast<TRI_voc_fid_t>(entry.logfileId), entry.mem, 0);
 
-      if (dfi != nullptr) {
-        TRI_df_marker_t const* marker = static_cast<TRI_df_marker_t const*>(operation.oldHeader.getDataPtr());  // PROTECTED by trx from above
-        dfi->_numberDead += 1;
-        dfi->_sizeDead += TRI_DF_ALIGN_BLOCK(marker->_size);
-        dfi->_numberAlive -= 1;
-        dfi->_sizeAlive -= TRI_DF_ALIGN_BLOCK(marker->_size);
+      if (res2 != TRI_ERROR_NO_ERROR) {
+        return res2;
       }
-      
-      TRI_UNLOCK_JOURNAL_ENTRIES_DOC_COLLECTION(document);
+
+      ++applied;
     }
-  }
-  else {
-    // operation is buffered and might be rolled back
-    if (trxCollection->_operations == nullptr) {
-      trxCollection->_operations = new std::vector<triagens::wal::DocumentOperation*>;
-      trx->_hasOperations = true;
+
+    if (res != TRI_ERROR_NO_ERROR &&
+        res != TRI_ERROR_LEGEND_NOT_IN_WAL_FILE) {
+      return res;
     }
 
-    triagens::wal::DocumentOperation* copy = operation.swap();
-    trxCollection->_operations->push_back(copy);
-    copy->handle();
-  }
+    if (applied < n &&
+        (res == TRI_ERROR_LEGEND_NOT_IN_WAL_FILE || written == entries.size())) {
+      // the next marker needs a legend, or is an envelope marker
+      auto& operation = *operations[applied];
 
-  TRI_UpdateRevisionDocumentCollection(document, operation.rid, false);
-  
-  TRI_IF_FAILURE("TransactionOperationAtEnd") {
-    return TRI_ERROR_DEBUG;
+      TRI_voc_fid_t fid = 0;
+      void const* position = nullptr;
+      int64_t sizeChanged = 0;
+
+      res = WriteOperationMarker(operation, fid, position, sizeChanged);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      res = ApplyOperation(operation, fid, position, sizeChanged);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        return res;
+      }
+
+      ++applied;
+    }
   }
 
   return TRI_ERROR_NO_ERROR;
@@ -29,6 +29,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "voc-shaper.h"
+#include "Basics/AssociativeArray.h"
 #include "Basics/Exceptions.h"
 #include "Basics/Mutex.h"
 #include "Basics/MutexLocker.h"
@@ -48,6 +49,40 @@
 // --SECTION--                                                     private types
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief description of the accessor cache
+////////////////////////////////////////////////////////////////////////////////
+
+struct AccessorDescription {
+  static inline uint64_t hashElement (TRI_shape_access_t const* element) {
+    uint64_t v[2];
+
+    v[0] = element->_sid;
+    v[1] = element->_pid;
+
+    return TRI_FnvHashPointer(v, sizeof(v));
+  }
+
+  static inline bool isEqualElementElement (TRI_shape_access_t const* left,
+                                            TRI_shape_access_t const* right) {
+    return left->_sid == right->_sid && left->_pid == right->_pid;
+  }
+
+  static inline bool isEmptyElement (TRI_shape_access_t const* element) {
+    return element == nullptr;
+  }
+
+  static inline void clearElement (TRI_shape_access_t const*& element) {
+    element = nullptr;
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief accessor cache
+////////////////////////////////////////////////////////////////////////////////
+
+typedef triagens::basics::AssociativeArray<TRI_shape_access_t const*, TRI_shape_access_t const*, AccessorDescription> AccessorCache;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief collection-based shaper
 ////////////////////////////////////////////////////////////////////////////////
@@ -60,7 +95,7 @@ typedef struct voc_shaper_s {
   TRI_associative_synced_t        _shapeDictionary;
   TRI_associative_synced_t        _shapeIds;
 
-  TRI_associative_pointer_t       _accessors;
+  AccessorCache*                  _accessors;
 
   std::atomic<TRI_shape_aid_t>    _nextAid;
   std::atomic<TRI_shape_sid_t>    _nextSid;
@@ -451,31 +486,6 @@ static TRI_shape_t const* LookupShapeId (TRI_shaper_t* shaper,
   return shape;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-/// @brief hashes the accessor
-////////////////////////////////////////////////////////////////////////////////
-
-static uint64_t HashElementAccessor (TRI_associative_pointer_t* array, void const* element) {
-  TRI_shape_access_t const* ee = static_cast<TRI_shape_access_t const*>(element);
-  uint64_t v[2];
-
-  v[0] = ee->_sid;
-  v[1] = ee->_pid;
-
-  return TRI_FnvHashPointer(v, sizeof(v));
-}
-
-////////////////////////////////////////////////////////////////////////////////
-/// @brief compares an accessor
-////////////////////////////////////////////////////////////////////////////////
-
-static bool EqualElementAccessor (TRI_associative_pointer_t* array, void const* left, void const* right) {
-  TRI_shape_access_t const* ll = static_cast<TRI_shape_access_t const*>(left);
-  TRI_shape_access_t const* rr = static_cast<TRI_shape_access_t const*>(right);
-
-  return ll->_sid == rr->_sid && ll->_pid == rr->_pid;
-}
-
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief initialises a shaper
 ////////////////////////////////////////////////////////////////////////////////
@@ -540,12 +550,12 @@ static int InitStep1VocShaper (voc_shaper_t* shaper) {
     return res;
   }
 
-  res = TRI_InitAssociativePointer(&shaper->_accessors,
-                                   TRI_UNKNOWN_MEM_ZONE,
-                                   0,
-                                   HashElementAccessor,
-                                   0,
-                                   EqualElementAccessor);
+  try {
+    shaper->_accessors = new AccessorCache(64);
+  }
+  catch (...) {
+    res = TRI_ERROR_OUT_OF_MEMORY;
+  }
 
   if (res != TRI_ERROR_NO_ERROR) {
     TRI_DestroyAssociativeSynced(&shaper->_shapeIds);
@@ -557,7 +567,7 @@ static int InitStep1VocShaper (voc_shaper_t* shaper) {
   }
 
   if (res != TRI_ERROR_NO_ERROR) {
-    TRI_DestroyAssociativePointer(&shaper->_accessors);
+    delete shaper->_accessors;
     TRI_DestroyAssociativeSynced(&shaper->_shapeIds);
     TRI_DestroyAssociativeSynced(&shaper->_shapeDictionary);
     TRI_DestroyAssociativeSynced(&shaper->_attributeIds);
@@ -636,14 +646,15 @@ void TRI_DestroyVocShaper (TRI_shaper_t* s) {
   TRI_DestroyAssociativeSynced(&shaper->_shapeDictionary);
   TRI_DestroyAssociativeSynced(&shaper->_shapeIds);
 
-  for (size_t i = 0; i < shaper->_accessors._nrAlloc; ++i) {
-    TRI_shape_access_t* accessor = (TRI_shape_access_t*) shaper->_accessors._table[i];
+  size_t n;
+  TRI_shape_access_t const* const* accessors = shaper->_accessors->tableAndSize(n);
 
-    if (accessor != nullptr) {
-      TRI_FreeShapeAccessor(accessor);
+  for (size_t i = 0; i < n; ++i) {
+    if (accessors[i] != nullptr) {
+      TRI_FreeShapeAccessor(const_cast<TRI_shape_access_t*>(accessors[i]));
     }
   }
-  TRI_DestroyAssociativePointer(&shaper->_accessors);
+  delete shaper->_accessors;
   TRI_DestroyShaper(s);
 }
 
@@ -905,7 +916,7 @@ TRI_shape_access_t const* TRI_FindAccessorVocShaper (TRI_shaper_t* s,
   {
     READ_LOCKER(shaper->_accessorLock);
 
-    found = static_cast<TRI_shape_access_t const*>(TRI_LookupByElementAssociativePointer(&shaper->_accessors, &search));
+    found = shaper->_accessors->findElement(&search);
 
     if (found != nullptr) {
       return found;
@@ -924,7 +935,11 @@ TRI_shape_access_t const* TRI_FindAccessorVocShaper (TRI_shaper_t* s,
   {
     WRITE_LOCKER(shaper->_accessorLock);
 
-    found = static_cast<TRI_shape_access_t const*>(TRI_InsertElementAssociativePointer(&shaper->_accessors, const_cast<void*>(static_cast<void const*>(accessor)), false));
+    found = shaper->_accessors->findElement(accessor);
+
+    if (found == nullptr) {
+      shaper->_accessors->addElement(accessor, false);
+    }
   }
 
   if (found != nullptr) {
@@ -36,6 +36,7 @@
 #include <regex.h>
 
 #include "Aql/QueryList.h"
+#include "Aql/QueryPlanCache.h"
 #include "Basics/conversions.h"
 #include "Basics/files.h"
 #include "Basics/hashes.h"
@@ -1374,6 +1375,7 @@ TRI_vocbase_t* TRI_CreateInitialVocBase (TRI_server_t* server,
   vocbase->_userStructures     = nullptr;
   vocbase->_cursorRepository   = nullptr;
   vocbase->_queries            = nullptr;
+  vocbase->_planCache          = nullptr;
   vocbase->_oldTransactions    = nullptr;
 
   try {
@@ -1388,10 +1390,24 @@ TRI_vocbase_t* TRI_CreateInitialVocBase (TRI_server_t* server,
     return nullptr;
   }
 
+  try {
+    vocbase->_planCache        = new triagens::aql::QueryPlanCache();
+  }
+  catch (...) {
+    delete static_cast<triagens::aql::QueryList*>(vocbase->_queries);
+    TRI_Free(TRI_CORE_MEM_ZONE, vocbase->_name);
+    TRI_Free(TRI_CORE_MEM_ZONE, vocbase->_path);
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, vocbase);
+    TRI_set_errno(TRI_ERROR_OUT_OF_MEMORY);
+
+    return nullptr;
+  }
+
   try {
     vocbase->_cursorRepository = new triagens::arango::CursorRepository(vocbase);
   }
   catch (...) {
+    delete static_cast<triagens::aql::QueryPlanCache*>(vocbase->_planCache);
     delete static_cast<triagens::aql::QueryList*>(vocbase->_queries);
     TRI_Free(TRI_CORE_MEM_ZONE, vocbase->_name);
     TRI_Free(TRI_CORE_MEM_ZONE, vocbase->_path);
@@ -1476,6 +1492,7 @@ void TRI_DestroyInitialVocBase (TRI_vocbase_t* vocbase) {
   TRI_DestroySpin(&vocbase->_usage._lock);
   
   delete static_cast<triagens::arango::CursorRepository*>(vocbase->_cursorRepository);
+  delete static_cast<triagens::aql::QueryPlanCache*>(vocbase->_planCache);
   delete static_cast<triagens::aql::QueryList*>(vocbase->_queries);
 
   // free name and path
@@ -1975,6 +1992,11 @@ TRI_vocbase_col_t* TRI_CreateCollectionVocBase (TRI_vocbase_t* vocbase,
 
   TRI_ReadUnlockReadWriteLock(&vocbase->_inventoryLock);
 
+  if (collection != nullptr) {
+    // cached query plans may still refer to a dropped collection with this name
+    triagens::aql::QueryPlanCache::InvalidateCollection(vocbase, parameters->_name);
+  }
+
   return collection;
 }
 
@@ -2074,6 +2096,8 @@ int TRI_DropCollectionVocBase (TRI_vocbase_t* vocbase,
     return TRI_set_errno(TRI_ERROR_FORBIDDEN);
   }
 
+  triagens::aql::QueryPlanCache::InvalidateCollection(vocbase, collection->_name);
+
   TRI_ReadLockReadWriteLock(&vocbase->_inventoryLock);
 
   TRI_EVENTUAL_WRITE_LOCK_STATUS_VOCBASE_COL(collection);
@@ -2294,6 +2318,11 @@ int TRI_RenameCollectionVocBase (TRI_vocbase_t* vocbase,
 
   TRI_ReadUnlockReadWriteLock(&vocbase->_inventoryLock);
 
+  if (res == TRI_ERROR_NO_ERROR) {
+    triagens::aql::QueryPlanCache::InvalidateCollection(vocbase, oldName);
+    triagens::aql::QueryPlanCache::InvalidateCollection(vocbase, newName);
+  }
+
   TRI_FreeString(TRI_CORE_MEM_ZONE, oldName);
 
   return res;
@@ -29,6 +29,7 @@
 
 #include "CollectorThread.h"
 
+#include "Basics/Barrier.h"
 #include "Basics/MutexLocker.h"
 #include "Basics/hashes.h"
 #include "Basics/logging.h"
@@ -282,7 +283,8 @@ uint64_t const CollectorThread::Interval = 1000000;
 ////////////////////////////////////////////////////////////////////////////////
 
 CollectorThread::CollectorThread (LogfileManager* logfileManager,
-                                  TRI_server_t* server)
+                                  TRI_server_t* server,
+                                  uint32_t numberOfThreads)
   : Thread("WalCollector"),
     _logfileManager(logfileManager),
     _server(server),
@@ -291,7 +293,12 @@ CollectorThread::CollectorThread (LogfileManager* logfileManager,
     _operationsQueue(),
     _operationsQueueInUse(false),
     _stop(0),
-    _numPendingOperations(0) {
+    _numPendingOperations(0),
+    _workers(nullptr) {
+
+  if (numberOfThreads > 1) {
+    _workers = new triagens::basics::ThreadPool(static_cast<size_t>(numberOfThreads), "WalCollectorWorker");
+  }
 
   allowAsynchronousCancelation();
 }
@@ -301,6 +308,9 @@ CollectorThread::CollectorThread (LogfileManager* logfileManager,
 ////////////////////////////////////////////////////////////////////////////////
 
 CollectorThread::~CollectorThread () {
+  if (_workers != nullptr) {
+    delete _workers;
+  }
 }
 
 // -----------------------------------------------------------------------------
@@ -456,74 +466,22 @@ bool CollectorThread::processQueuedOperations () {
 
   // go on without the mutex!
 
-  // process operations for each collection
-  for (auto it = _operationsQueue.begin(); it != _operationsQueue.end(); ++it) {
-    auto& operations = (*it).second;
-    TRI_ASSERT(! operations.empty());
-
-    for (auto it2 = operations.begin(); it2 != operations.end(); /* no hoisting */ ) {
-      Logfile* logfile = (*it2)->logfile;
-
-      int res = TRI_ERROR_INTERNAL;
-
-      try {
-        res = processCollectionOperations((*it2));
-      }
-      catch (triagens::basics::Exception const& ex) {
-        res = ex.code();
-      }
-
-      if (res == TRI_ERROR_LOCK_TIMEOUT) {
-        // could not acquire write-lock for collection in time
-        // do not delete the operations
-        ++it2;
-        continue;
-      }
-
-      if (res == TRI_ERROR_NO_ERROR) {
-        LOG_TRACE("queued operations applied successfully");
-      }
-      else if (res == TRI_ERROR_ARANGO_DATABASE_NOT_FOUND ||
-               res == TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND) {
-        // these are expected errors
-        LOG_TRACE("removing queued operations for already deleted collection");
-        res = TRI_ERROR_NO_ERROR;
-      }
-      else {
-        LOG_WARNING("got unexpected error code while applying queued operations: %s", TRI_errno_string(res));
-      }
-
-      if (res == TRI_ERROR_NO_ERROR) {
-        uint64_t numOperations = (*it2)->operations->size();
-        uint64_t maxNumPendingOperations = _logfileManager->throttleWhenPending();
-
-        if (maxNumPendingOperations > 0 && 
-            _numPendingOperations >= maxNumPendingOperations &&
-            (_numPendingOperations - numOperations) < maxNumPendingOperations) {
-          // write-throttling was active, but can be turned off now
-          _logfileManager->deactivateWriteThrottling();
-          LOG_INFO("deactivating write-throttling");
-        }
-
-        _numPendingOperations -= numOperations;
-
-        // delete the object
-        delete (*it2);
-
-        // delete the element from the vector while iterating over the vector
-        it2 = operations.erase(it2);
+  // process operations for each collection. the collections are independent
+  // of each other, so they can be handled by different workers
+  std::vector<std::function<void()>> tasks;
+  tasks.reserve(_operationsQueue.size());
 
-        _logfileManager->decreaseCollectQueueSize(logfile);
-      }
-      else {
-        // do not delete the object but advance in the operations vector
-        ++it2;
-      }
-    }
+  for (auto it = _operationsQueue.begin(); it != _operationsQueue.end(); ++it) {
+    auto* operations = &((*it).second);
+    TRI_ASSERT(! operations->empty());
 
-    // next collection
+    tasks.emplace_back([this, operations] () -> void {
+      processCollectionQueue(*operations);
+    });
   }
 
+  executeTasks(tasks);
+
   // finally remove all entries from the map with empty vectors
   {
     MUTEX_LOCKER(_operationsQueueLock);
@@ -544,6 +502,77 @@ bool CollectorThread::processQueuedOperations () {
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief process the queued operations of a single collection, in order
+////////////////////////////////////////////////////////////////////////////////
+
+void CollectorThread::processCollectionQueue (std::vector<CollectorCache*>& operations) {
+  for (auto it = operations.begin(); it != operations.end(); /* no hoisting */ ) {
+    Logfile* logfile = (*it)->logfile;
+
+    int res = TRI_ERROR_INTERNAL;
+
+    try {
+      res = processCollectionOperations((*it));
+    }
+    catch (triagens::basics::Exception const& ex) {
+      res = ex.code();
+    }
+    catch (...) {
+      res = TRI_ERROR_INTERNAL;
+    }
+
+    if (res == TRI_ERROR_LOCK_TIMEOUT) {
+      // could not acquire write-lock for collection in time
+      // do not delete the operations
+      ++it;
+      continue;
+    }
+
+    if (res == TRI_ERROR_NO_ERROR) {
+      LOG_TRACE("queued operations applied successfully");
+    }
+    else if (res == TRI_ERROR_ARANGO_DATABASE_NOT_FOUND ||
+             res == TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND) {
+      // these are expected errors
+      LOG_TRACE("removing queued operations for already deleted collection");
+      res = TRI_ERROR_NO_ERROR;
+    }
+    else {
+      LOG_WARNING("got unexpected error code while applying queued operations: %s", TRI_errno_string(res));
+    }
+
+    if (res == TRI_ERROR_NO_ERROR) {
+      uint64_t numOperations = (*it)->operations->size();
+      uint64_t maxNumPendingOperations = _logfileManager->throttleWhenPending();
+
+      // other workers may update the counter concurrently, so only the worker
+      // that crosses the threshold turns write-throttling off
+      uint64_t numPendingOperations = _numPendingOperations.fetch_sub(numOperations);
+
+      if (maxNumPendingOperations > 0 && 
+          numPendingOperations >= maxNumPendingOperations &&
+          (numPendingOperations - numOperations) < maxNumPendingOperations) {
+        // write-throttling was active, but can be turned off now
+        _logfileManager->deactivateWriteThrottling();
+        LOG_INFO("deactivating write-throttling");
+      }
+
+      // delete the object
+      delete (*it);
+
+      // delete the element from the vector while iterating over the vector
+      it = operations.erase(it);
+
+      _logfileManager->decreaseCollectQueueSize(logfile);
+    }
+    else {
+      // do not delete the object but advance in the operations vector
+      ++it;
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief check whether there are queued operations left
 ////////////////////////////////////////////////////////////////////////////////
@@ -698,10 +727,19 @@ int CollectorThread::processCollectionOperations (CollectorCache* cache) {
     LOG_TRACE("updating datafile statistics for collection '%s'", document->_info._name);
     updateDatafileStatistics(document, cache);
         
-    document->_uncollectedLogfileEntries -= cache->totalOperationsCount;
-    if (document->_uncollectedLogfileEntries < 0) {
-      document->_uncollectedLogfileEntries = 0;
+    // transactions may increase the counter concurrently, so decrease it
+    // without ever going below zero and without losing their increments
+    int64_t uncollected = document->_uncollectedLogfileEntries.load();
+    int64_t remaining;
+
+    do {
+      remaining = uncollected - cache->totalOperationsCount;
+
+      if (remaining < 0) {
+        remaining = 0;
+      }
     }
+    while (! document->_uncollectedLogfileEntries.compare_exchange_weak(uncollected, remaining));
 
     res = TRI_ERROR_NO_ERROR;
   }
@@ -773,11 +811,18 @@ int CollectorThread::collect (Logfile* logfile) {
     }
   }
 
-  // now for each collection, write all surviving markers into collection datafiles
-  for (auto it = collectionIds.begin(); it != collectionIds.end(); ++it) {
+  // now for each collection, write all surviving markers into collection datafiles.
+  // the markers of different collections are transferred by different workers
+  size_t const n = collectionIds.size();
+  std::vector<OperationsType> allOperations(n);
+  std::vector<int> results(n, TRI_ERROR_NO_ERROR);
+  std::vector<std::function<void()>> tasks;
+  size_t i = 0;
+
+  for (auto it = collectionIds.begin(); it != collectionIds.end(); ++it, ++i) {
     auto cid = (*it);
 
-    OperationsType sortedOperations;
+    OperationsType& sortedOperations = allOperations[i];
 
     // insert structural operations - those are already sorted by tick
     if (state.structuralOperations.find(cid) != state.structuralOperations.end()) {
@@ -803,25 +848,38 @@ int CollectorThread::collect (Logfile* logfile) {
     }
 
     if (! sortedOperations.empty()) {
-      int res = TRI_ERROR_INTERNAL;
+      // look up everything needed from the state here, as the workers must not
+      // access it concurrently
+      TRI_voc_tick_t databaseId = state.collections[cid];
+      int64_t totalOperationsCount = state.operationsCount[cid];
+      int* result = &results[i];
 
-      try {
-        res = transferMarkers(logfile, cid, state.collections[cid], state.operationsCount[cid], sortedOperations);
-      }
-      catch (triagens::basics::Exception const& ex) {
-        res = ex.code();
-      }
-      catch (...) {
-        res = TRI_ERROR_INTERNAL;
-      }
+      tasks.emplace_back([this, logfile, cid, databaseId, totalOperationsCount, &sortedOperations, result] () -> void {
+        int res = TRI_ERROR_INTERNAL;
 
-      if (res != TRI_ERROR_NO_ERROR &&
-          res != TRI_ERROR_ARANGO_DATABASE_NOT_FOUND &&
-          res != TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND) {
-        LOG_WARNING("got unexpected error in CollectorThread::collect: %s", TRI_errno_string(res));
-        // abort early
-        return res;
-      }
+        try {
+          res = transferMarkers(logfile, cid, databaseId, totalOperationsCount, sortedOperations);
+        }
+        catch (triagens::basics::Exception const& ex) {
+          res = ex.code();
+        }
+        catch (...) {
+          res = TRI_ERROR_INTERNAL;
+        }
+
+        *result = res;
+      });
+    }
+  }
+
+  executeTasks(tasks);
+
+  for (auto res : results) {
+    if (res != TRI_ERROR_NO_ERROR &&
+        res != TRI_ERROR_ARANGO_DATABASE_NOT_FOUND &&
+        res != TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND) {
+      LOG_WARNING("got unexpected error in CollectorThread::collect: %s", TRI_errno_string(res));
+      return res;
     }
   }
 
@@ -1149,17 +1207,16 @@ int CollectorThread::queueOperations (triagens::wal::Logfile* logfile,
   }
   
   uint64_t numOperations = cache->operations->size();
+  uint64_t numPendingOperations = _numPendingOperations.fetch_add(numOperations);
 
   if (maxNumPendingOperations > 0 && 
-      _numPendingOperations < maxNumPendingOperations &&
-      (_numPendingOperations + numOperations) >= maxNumPendingOperations) {
+      numPendingOperations < maxNumPendingOperations &&
+      (numPendingOperations + numOperations) >= maxNumPendingOperations) {
     // activate write-throttling!
     _logfileManager->activateWriteThrottling();
     LOG_WARNING("queued more than %llu pending WAL collector operations. now activating write-throttling", 
                 (unsigned long long) maxNumPendingOperations);
   }
-  
-  _numPendingOperations += numOperations;
 
   // we have put the object into the queue successfully
   // now set the original pointer to null so it isn't double-freed
@@ -1416,6 +1473,35 @@ void CollectorThread::finishMarker (char const* walPosition,
   cache->operations->emplace_back(CollectorOperation(datafilePosition, marker->_size, walPosition, cache->lastFid));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute tasks on the collector workers and wait for all of them
+///
+/// the tasks must not throw. without workers, or with a single task only, the
+/// tasks are executed by the collector thread itself
+////////////////////////////////////////////////////////////////////////////////
+
+void CollectorThread::executeTasks (std::vector<std::function<void()>> const& tasks) {
+  if (_workers == nullptr || tasks.size() <= 1) {
+    for (auto const& task : tasks) {
+      task();
+    }
+    return;
+  }
+
+  triagens::basics::Barrier barrier(tasks.size());
+
+  for (auto const& task : tasks) {
+    auto* t = &task;
+
+    _workers->enqueue([&barrier, t] () -> void {
+      triagens::basics::BarrierTask joiner(&barrier);
+      (*t)();
+    });
+  }
+
+  barrier.synchronize();
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       END-OF-FILE
 // -----------------------------------------------------------------------------
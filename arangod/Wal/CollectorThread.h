@@ -34,6 +34,7 @@
 #include "Basics/ConditionVariable.h"
 #include "Basics/Mutex.h"
 #include "Basics/Thread.h"
+#include "Basics/ThreadPool.h"
 #include "VocBase/barrier.h"
 #include "VocBase/datafile.h"
 #include "VocBase/document-collection.h"
@@ -210,7 +211,8 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
         CollectorThread (LogfileManager*,
-                         struct TRI_server_s*);
+                         struct TRI_server_s*,
+                         uint32_t);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroy the collector thread
@@ -296,6 +298,12 @@ namespace triagens {
 
         bool processQueuedOperations ();
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief process the queued operations of a single collection, in order
+////////////////////////////////////////////////////////////////////////////////
+
+        void processCollectionQueue (std::vector<CollectorCache*>&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief process all operations for a single collection
 ////////////////////////////////////////////////////////////////////////////////
@@ -374,6 +382,12 @@ namespace triagens {
                            TRI_voc_tick_t,
                            CollectorCache*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief execute tasks on the collector workers and wait for all of them
+////////////////////////////////////////////////////////////////////////////////
+
+        void executeTasks (std::vector<std::function<void()>> const&);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -426,7 +440,14 @@ namespace triagens {
 /// @brief number of pending operations in collector queue
 ////////////////////////////////////////////////////////////////////////////////
 
-        uint64_t _numPendingOperations;
+        std::atomic<uint64_t> _numPendingOperations;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief worker threads for handling different collections in parallel,
+/// nullptr if all collections are handled by the collector thread itself
+////////////////////////////////////////////////////////////////////////////////
+
+        triagens::basics::ThreadPool* _workers;
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief wait interval for the collector thread when idle
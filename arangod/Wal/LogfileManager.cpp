@@ -28,6 +28,9 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "LogfileManager.h"
+
+#include <thread>
+
 #include "Basics/hashes.h"
 #include "Basics/json.h"
 #include "Basics/logging.h"
@@ -142,6 +145,8 @@ LogfileManager::LogfileManager (TRI_server_t* server,
     _allowOversizeEntries(true),
     _ignoreLogfileErrors(false),
     _ignoreRecoveryErrors(false),
+    _recoveryThreads(4),
+    _collectorThreads(2),
     _suppressShapeInformation(false),
     _allowWrites(false), // start in read-only mode
     _hasFoundLastTick(false),
@@ -233,12 +238,14 @@ void LogfileManager::initialise (std::string* path,
 void LogfileManager::setupOptions (std::map<std::string, triagens::basics::ProgramOptionsDescription>& options) {
   options["Write-ahead log options:help-wal"]
     ("wal.allow-oversize-entries", &_allowOversizeEntries, "allow entries that are bigger than --wal.logfile-size")
+    ("wal.collector-threads", &_collectorThreads, "number of threads for transferring logfile data of different collections into their datafiles")
     ("wal.directory", &_directory, "logfile directory")
     ("wal.historic-logfiles", &_historicLogfiles, "maximum number of historic logfiles to keep after collection")
     ("wal.ignore-logfile-errors", &_ignoreLogfileErrors, "ignore logfile errors. this will read recoverable data from corrupted logfiles but ignore any unrecoverable data")
     ("wal.ignore-recovery-errors", &_ignoreRecoveryErrors, "continue recovery even if re-applying operations fails")
     ("wal.logfile-size", &_filesize, "size of each logfile (in bytes)")
     ("wal.open-logfiles", &_maxOpenLogfiles, "maximum number of parallel open logfiles")
+    ("wal.recovery-threads", &_recoveryThreads, "number of threads for scanning and replaying logfiles in recovery")
     ("wal.reserve-logfiles", &_reserveLogfiles, "maximum number of reserve logfiles to maintain")
     ("wal.slots", &_numberOfSlots, "number of logfile slots to use")
     ("wal.suppress-shape-information", &_suppressShapeInformation, "do not write shape information for markers (saves a lot of disk space, but effectively disables using the write-ahead log for replication)")
@@ -310,9 +317,17 @@ bool LogfileManager::prepare () {
   // we use microseconds
   _syncInterval = _syncInterval * 1000;
 
+  if (_recoveryThreads == 0) {
+    LOG_FATAL_AND_EXIT("invalid value for --wal.recovery-threads. Please use a value of at least 1");
+  }
+
+  if (_collectorThreads == 0) {
+    LOG_FATAL_AND_EXIT("invalid value for --wal.collector-threads. Please use a value of at least 1");
+  }
+
   // initialise some objects
   _slots = new Slots(this, _numberOfSlots, 0);
-  _recoverState = new RecoverState(_server, _ignoreRecoveryErrors);
+  _recoverState = new RecoverState(_server, _ignoreRecoveryErrors, _recoveryThreads);
 
   return true;
 }
@@ -887,6 +902,87 @@ SlotInfoCopy LogfileManager::allocateAndWrite (Marker const& marker,
   return allocateAndWrite(marker.mem(), marker.size(), waitForSync);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write a batch of markers into the logfile
+/// this is a convenience function that combines allocate, memcpy and finalise
+/// for many markers, acquiring the slots for them in groups
+///
+/// the markers are written in order. the number of markers written is
+/// returned in count, and is less than the number of markers in case of an
+/// error. TRI_ERROR_LEGEND_NOT_IN_WAL_FILE is returned for a document or edge
+/// marker that needs a legend, so the caller can write this marker with its
+/// legend and continue with the remaining markers afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+int LogfileManager::allocateAndWrite (SlotBatchEntry* entries,
+                                      size_t n,
+                                      bool waitForSync,
+                                      size_t& count) {
+  count = 0;
+
+  if (! _allowWrites) {
+    // no writes allowed
+    return TRI_ERROR_ARANGO_READ_ONLY;
+  }
+
+  while (count < n) {
+    uint32_t const size = entries[count].size;
+
+    if (size > MaxEntrySize() ||
+        (size > _filesize && ! _allowOversizeEntries)) {
+      // entry is too big
+      return TRI_ERROR_ARANGO_DOCUMENT_TOO_LARGE;
+    }
+
+    // only hand out slots up to the next entry that is too big
+    size_t end = count + 1;
+
+    while (end < n &&
+           entries[end].size <= MaxEntrySize() &&
+           (entries[end].size <= _filesize || _allowOversizeEntries)) {
+      ++end;
+    }
+
+    size_t acquired = 0;
+    int res = _slots->nextUnused(entries + count, end - count, acquired);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+
+    TRI_ASSERT(acquired > 0);
+
+    res = TRI_ERROR_NO_ERROR;
+
+    for (size_t i = count; i < count + acquired; ++i) {
+      SlotBatchEntry& entry = entries[i];
+
+      try {
+        entry.slotInfo.slot->fill(entry.src, entry.size);
+      }
+      catch (...) {
+        res = TRI_ERROR_INTERNAL;
+      }
+
+      // we must copy the slot's data because returnUsed() will reset it
+      entry.mem       = entry.slotInfo.slot->mem();
+      entry.logfileId = entry.slotInfo.slot->logfileId();
+      entry.tick      = entry.slotInfo.slot->tick();
+    }
+
+    // if we don't return the slots we'll run into serious problems later
+    _slots->returnUsed(entries + count, acquired, waitForSync && res == TRI_ERROR_NO_ERROR);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return res;
+    }
+
+    count += acquired;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief finalise and seal the currently open logfile
 /// this is useful to ensure that any open writes up to this point have made
@@ -1415,6 +1511,12 @@ void LogfileManager::setCollectionDone (Logfile* logfile) {
     _lastCollectedId = logfile->id();
   }
 
+  // the data of the logfile has been transferred into the collections, so it
+  // is not read anymore, except when replicating
+  if (logfile->df() != nullptr) {
+    TRI_AdviseDatafile(logfile->df(), TRI_DF_ACCESS_DONTNEED);
+  }
+
   if (! _inRecovery) {
     // to start removal of unneeded datafiles
     _collectorThread->signal();
@@ -1770,7 +1872,7 @@ void LogfileManager::stopAllocatorThread () {
 ////////////////////////////////////////////////////////////////////////////////
 
 int LogfileManager::startCollectorThread () {
-  _collectorThread = new CollectorThread(this, _server);
+  _collectorThread = new CollectorThread(this, _server, _collectorThreads);
 
   if (_collectorThread == nullptr) {
     return TRI_ERROR_INTERNAL;
@@ -1897,52 +1999,134 @@ int LogfileManager::inspectLogfiles () {
   }
 #endif
 
-  for (auto it = _logfiles.begin(); it != _logfiles.end(); ) {
-    Logfile::IdType const id = (*it).first;
-    std::string const filename = logfileName(id);
+  // open and scan the logfiles in parallel. the results are merged into the
+  // recover state in logfile order below
+  std::vector<Logfile::IdType> ids;
+  ids.reserve(_logfiles.size());
 
+  for (auto it = _logfiles.begin(); it != _logfiles.end(); ++it) {
     TRI_ASSERT((*it).second == nullptr);
+    ids.emplace_back((*it).first);
+  }
 
-    int res = Logfile::judge(filename);
+  size_t const n = ids.size();
+  std::vector<Logfile*> opened(n, nullptr);
+  std::vector<int> results(n, TRI_ERROR_NO_ERROR);
+  std::vector<RecoverScan> scans(n);
+  std::atomic<size_t> next(0);
 
-    if (res == TRI_ERROR_ARANGO_DATAFILE_EMPTY) {
-      _recoverState->emptyLogfiles.push_back(filename);
-      _logfiles.erase(it++);
+  auto inspect = [&] () -> void {
+    while (true) {
+      size_t const i = next.fetch_add(1);
+
+      if (i >= n) {
+        break;
+      }
+
+      Logfile::IdType const id = ids[i];
+      std::string const filename = logfileName(id);
+
+      int res = Logfile::judge(filename);
+
+      if (res == TRI_ERROR_ARANGO_DATAFILE_EMPTY) {
+        results[i] = res;
+        continue;
+      }
+
+      bool const wasCollected = (id <= _lastCollectedId);
+      TRI_set_errno(TRI_ERROR_NO_ERROR);
+      Logfile* logfile = Logfile::openExisting(filename, id, wasCollected, _ignoreLogfileErrors);
+
+      if (logfile == nullptr) {
+        res = TRI_errno();
+        if (res == TRI_ERROR_NO_ERROR) {
+          // must have an error!
+          res = TRI_ERROR_ARANGO_DATAFILE_UNREADABLE;
+        }
+        results[i] = res;
+        continue;
+      }
+
+      opened[i] = logfile;
+
+      LOG_TRACE("inspecting logfile %llu (%s)", (unsigned long long) logfile->id(), logfile->statusText().c_str());
+
+      // collect the tick statistics  
+      if (! TRI_IterateDatafile(logfile->df(), &RecoverState::InitialScanMarker, static_cast<void*>(&scans[i]))) {
+        results[i] = TRI_ERROR_ARANGO_RECOVERY;
+      }
+    }
+  };
+
+  size_t const numThreads = (std::min)(n, static_cast<size_t>(_recoveryThreads));
+
+  if (numThreads <= 1) {
+    inspect();
+  }
+  else {
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < numThreads; ++i) {
+      threads.push_back(std::thread(inspect));
+    }
+    for (size_t i = 0; i < numThreads; ++i) {
+      threads[i].join();
+    }
+  }
+
+  int res = TRI_ERROR_NO_ERROR;
+  size_t i = 0;
+
+  for (auto it = _logfiles.begin(); it != _logfiles.end(); ++i) {
+    Logfile::IdType const id = (*it).first;
+    Logfile* logfile = opened[i];
+
+    TRI_ASSERT(id == ids[i]);
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      // an error happened before. free the remaining logfiles
+      delete logfile;
+      ++it;
       continue;
     }
 
-    bool const wasCollected = (id <= _lastCollectedId);
-    Logfile* logfile = Logfile::openExisting(filename, id, wasCollected, _ignoreLogfileErrors);
+    if (results[i] == TRI_ERROR_ARANGO_DATAFILE_EMPTY) {
+      _recoverState->emptyLogfiles.push_back(logfileName(id));
+      _logfiles.erase(it++);
+      continue;
+    }
 
     if (logfile == nullptr) {
       // an error happened when opening a logfile
       if (! _ignoreLogfileErrors) {
         // we don't ignore errors, so we abort here
-        int res = TRI_errno();
-        if (res == TRI_ERROR_NO_ERROR) {
-          // must have an error!
-          res = TRI_ERROR_ARANGO_DATAFILE_UNREADABLE;
-        }
-        return res;
+        res = results[i];
+        ++it;
+        continue;
       }
 
       _logfiles.erase(it++);
       continue;
     }
+
+    bool const mustReplay = (logfile->status() == Logfile::StatusType::OPEN ||
+                             logfile->status() == Logfile::StatusType::SEALED);
         
-    if (logfile->status() == Logfile::StatusType::OPEN ||
-        logfile->status() == Logfile::StatusType::SEALED) {
+    if (mustReplay) {
       _recoverState->logfilesToProcess.push_back(logfile);
     }
-        
-    LOG_TRACE("inspecting logfile %llu (%s)", (unsigned long long) logfile->id(), logfile->statusText().c_str());
 
-    // update the tick statistics  
-    if (! TRI_IterateDatafile(logfile->df(), &RecoverState::InitialScanMarker, static_cast<void*>(_recoverState))) {
+    if (results[i] == TRI_ERROR_ARANGO_RECOVERY) {
       LOG_WARNING("WAL inspection failed when scanning logfile '%s'", logfile->filename().c_str());
-      return TRI_ERROR_ARANGO_RECOVERY;
+      res = results[i];
+      (*it).second = logfile;
+      ++it;
+      continue;
     }
 
+    // update the tick statistics  
+    _recoverState->applyScan(scans[i], mustReplay);
+
     if (logfile->status() == Logfile::StatusType::SEALED &&
         id > _lastSealedId) {
       _lastSealedId = id;
@@ -1957,6 +2141,10 @@ int LogfileManager::inspectLogfiles () {
     (*it).second = logfile;
     ++it;
   }
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return res;
+  }
  
   
   // update the tick with the max tick we found in the WAL
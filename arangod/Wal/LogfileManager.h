@@ -474,6 +474,17 @@ namespace triagens {
         SlotInfoCopy allocateAndWrite (Marker const&,
                                        bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief write a batch of markers into the logfile
+/// this is a convenience function that combines allocate, memcpy and finalise
+/// for many markers, acquiring the slots for them in groups
+////////////////////////////////////////////////////////////////////////////////
+
+        int allocateAndWrite (SlotBatchEntry*,
+                              size_t,
+                              bool,
+                              size_t&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief finalise and seal the currently open logfile
 /// this is useful to ensure that any open writes up to this point have made
@@ -1007,6 +1018,43 @@ namespace triagens {
 
         bool _ignoreRecoveryErrors;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of recovery threads
+/// @startDocuBlock WalLogfileRecoveryThreads
+/// `--wal.recovery-threads`
+///
+/// The number of threads used for scanning and replaying the write-ahead
+/// logfiles after an unclean shutdown. Logfiles are scanned in parallel, and
+/// the operations of different collections are replayed in parallel, while
+/// the operations of each collection are still replayed in their original
+/// order. The secondary indexes of a collection are filled as soon as all its
+/// operations have been replayed.
+///
+/// Setting this option to *1* will replay all operations in a single thread.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t _recoveryThreads;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of collector threads
+/// @startDocuBlock WalLogfileCollectorThreads
+/// `--wal.collector-threads`
+///
+/// The number of threads used by the write-ahead log garbage collector for
+/// transferring the operations of a sealed logfile into the datafiles of their
+/// collections. The operations of different collections are transferred in
+/// parallel, and the in-memory pointers of different collections are updated
+/// in parallel afterwards. The operations of each collection are still handled
+/// in their original order by a single thread.
+///
+/// Setting this option to *1* will handle all collections in the collector
+/// thread itself.
+/// @endDocuBlock
+////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t _collectorThreads;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief suppress shape information
 /// @startDocuBlock WalLogfileSuppressShapeInformation
@@ -28,7 +28,12 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "RecoverState.h"
+
+#include <thread>
+
+#include "Basics/Barrier.h"
 #include "Basics/FileUtils.h"
+#include "Basics/MutexLocker.h"
 #include "Basics/conversions.h"
 #include "Basics/files.h"
 #include "Basics/Exceptions.h"
@@ -40,10 +45,59 @@
 
 using namespace triagens::wal;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of markers handed to a replay thread at once
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const ReplayBatchSize = 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief interval for reporting the replay progress (in seconds)
+////////////////////////////////////////////////////////////////////////////////
+
+static double const ProgressInterval = 10.0;
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  helper functions
 // -----------------------------------------------------------------------------
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the id of the collection a marker belongs to, or 0 if the
+/// marker does not belong to a collection
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_voc_cid_t CollectionIdMarker (TRI_df_marker_t const* marker) {
+  switch (marker->_type) {
+    case TRI_WAL_MARKER_ATTRIBUTE:
+      return reinterpret_cast<attribute_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_SHAPE:
+      return reinterpret_cast<shape_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_DOCUMENT:
+    case TRI_WAL_MARKER_EDGE:
+      return reinterpret_cast<document_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_REMOVE:
+      return reinterpret_cast<remove_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_CREATE_COLLECTION:
+      return reinterpret_cast<collection_create_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_DROP_COLLECTION:
+      return reinterpret_cast<collection_drop_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_RENAME_COLLECTION:
+      return reinterpret_cast<collection_rename_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_CHANGE_COLLECTION:
+      return reinterpret_cast<collection_change_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_CREATE_INDEX:
+      return reinterpret_cast<index_create_marker_t const*>(marker)->_collectionId;
+    case TRI_WAL_MARKER_DROP_INDEX:
+      return reinterpret_cast<index_drop_marker_t const*>(marker)->_collectionId;
+  }
+
+  return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief whether or not a collection is volatile
 ////////////////////////////////////////////////////////////////////////////////
@@ -176,7 +230,8 @@ static int WaitForDeletion (TRI_vocbase_t* vocbase,
 ////////////////////////////////////////////////////////////////////////////////
 
 RecoverState::RecoverState (TRI_server_t* server,
-                            bool ignoreRecoveryErrors)
+                            bool ignoreRecoveryErrors,
+                            uint32_t numberOfThreads)
   : server(server),
     failedTransactions(),
     remoteTransactions(),
@@ -188,9 +243,19 @@ RecoverState::RecoverState (TRI_server_t* server,
     openedDatabases(),
     runningRemoteTransactions(),
     emptyLogfiles(),
-    policy(TRI_DOC_UPDATE_ONLY_IF_NEWER, 0, nullptr),
+    collectionTicks(),
+    filledCollections(),
     ignoreRecoveryErrors(ignoreRecoveryErrors),
-    errorCount(0) {
+    errorCount(0),
+    numberOfThreads(numberOfThreads > 0 ? numberOfThreads : 1),
+    replayThreads(),
+    replayBatches(),
+    replayPending(false),
+    replayFailed(false),
+    lock(),
+    markersToReplay(0),
+    markersReplayed(0),
+    lastProgress(0.0) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -198,6 +263,10 @@ RecoverState::RecoverState (TRI_server_t* server,
 ////////////////////////////////////////////////////////////////////////////////
 
 RecoverState::~RecoverState () {
+  for (auto it : replayThreads) {
+    delete it;
+  }
+
   releaseResources();
 
   // free running remote transactions
@@ -476,16 +545,24 @@ int RecoverState::executeSingleOperation (TRI_voc_tick_t databaseId,
                                           TRI_voc_fid_t fid,
                                           std::function<int(SingleWriteTransactionType*, Marker*)> func) {
 
-  // first find the correct database
-  TRI_vocbase_t* vocbase = useDatabase(databaseId);
+  TRI_vocbase_t* vocbase;
+  TRI_vocbase_col_t* collection;
+  int res;
 
-  if (vocbase == nullptr) {
-    LOG_TRACE("database %llu not found", (unsigned long long) databaseId);
-    return TRI_ERROR_ARANGO_DATABASE_NOT_FOUND;
-  }
+  {
+    // the replay threads share the database and collection caches
+    MUTEX_LOCKER(lock);
 
-  int res;
-  TRI_vocbase_col_t* collection = useCollection(vocbase, collectionId, res);
+    // first find the correct database
+    vocbase = useDatabase(databaseId);
+
+    if (vocbase == nullptr) {
+      LOG_TRACE("database %llu not found", (unsigned long long) databaseId);
+      return TRI_ERROR_ARANGO_DATABASE_NOT_FOUND;
+    }
+
+    collection = useCollection(vocbase, collectionId, res);
+  }
 
   if (collection == nullptr || collection->_collection == nullptr) {
     if (res == TRI_ERROR_ARANGO_CORRUPTED_COLLECTION) {
@@ -556,23 +633,82 @@ int RecoverState::executeSingleOperation (TRI_voc_tick_t databaseId,
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief callback to handle one marker during recovery
-/// this function only builds up state and does not change any data
+/// this function only builds up state and does not change any data. it is
+/// called with a RecoverScan, and may run for several logfiles in parallel
 ////////////////////////////////////////////////////////////////////////////////
 
 bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
                                       void* data,
                                       TRI_datafile_t* datafile) {
-  RecoverState* state = reinterpret_cast<RecoverState*>(data);
+  RecoverScan* scan = reinterpret_cast<RecoverScan*>(data);
 
   TRI_ASSERT(marker != nullptr);
 
   // note the marker's tick
-  TRI_ASSERT(marker->_tick >= state->lastTick);
+  TRI_ASSERT(marker->_tick >= scan->lastTick);
+
+  if (marker->_tick > scan->lastTick) {
+    scan->lastTick = marker->_tick;
+  }
+
+  ++scan->numberOfMarkers;
+
+  // note the tick of the last marker for each collection. once this marker
+  // has been replayed, the collection's indexes can be filled
+  TRI_voc_cid_t collectionId = CollectionIdMarker(marker);
+
+  if (collectionId != 0) {
+    scan->collectionTicks[collectionId] = marker->_tick;
+  }
+
+  switch (marker->_type) {
+    case TRI_WAL_MARKER_BEGIN_TRANSACTION:
+    case TRI_WAL_MARKER_COMMIT_TRANSACTION:
+    case TRI_WAL_MARKER_ABORT_TRANSACTION:
+    case TRI_WAL_MARKER_BEGIN_REMOTE_TRANSACTION:
+    case TRI_WAL_MARKER_COMMIT_REMOTE_TRANSACTION:
+    case TRI_WAL_MARKER_ABORT_REMOTE_TRANSACTION:
+    case TRI_WAL_MARKER_DROP_COLLECTION: {
+      // the state is built from these markers when the scan results are merged
+      scan->markers.push_back(marker);
+      break;
+    }
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief merge the scan result of a logfile into the state
+/// this must be called for the logfiles in ascending order
+////////////////////////////////////////////////////////////////////////////////
+
+void RecoverState::applyScan (RecoverScan const& scan,
+                              bool mustReplay) {
+  TRI_ASSERT(scan.lastTick == 0 || scan.lastTick >= lastTick);
+
+  if (scan.lastTick > lastTick) {
+    lastTick = scan.lastTick;
+  }
+
+  for (auto const& it : scan.markers) {
+    applyScanMarker(it);
+  }
+
+  for (auto const& it : scan.collectionTicks) {
+    collectionTicks[it.first] = it.second;
+  }
 
-  if (marker->_tick > state->lastTick) {
-    state->lastTick = marker->_tick;
+  if (mustReplay) {
+    markersToReplay += scan.numberOfMarkers;
   }
+}
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief note a marker found in the initial scan that affects the state
+////////////////////////////////////////////////////////////////////////////////
+
+void RecoverState::applyScanMarker (TRI_df_marker_t const* marker) {
   switch (marker->_type) {
 
     // -----------------------------------------------------------------------------
@@ -584,14 +720,14 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
       // insert this transaction into the list of failed transactions
       // we do this because if we don't find a commit marker for this transaction,
       // we'll have it in the failed list at the end of the scan and can ignore it
-      state->failedTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, false)));
+      failedTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, false)));
       break;
     }
 
     case TRI_WAL_MARKER_COMMIT_TRANSACTION: {
       transaction_commit_marker_t const* m = reinterpret_cast<transaction_commit_marker_t const*>(marker);
       // remove this transaction from the list of failed transactions
-      state->failedTransactions.erase(m->_transactionId);
+      failedTransactions.erase(m->_transactionId);
       break;
     }
 
@@ -599,28 +735,28 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
       // insert this transaction into the list of failed transactions
       transaction_abort_marker_t const* m = reinterpret_cast<transaction_abort_marker_t const*>(marker);
 
-      auto it = state->failedTransactions.find(m->_transactionId);
-      if (it != state->failedTransactions.end()) {
+      auto it = failedTransactions.find(m->_transactionId);
+      if (it != failedTransactions.end()) {
         // delete previous element if present
-        state->failedTransactions.erase(m->_transactionId);
+        failedTransactions.erase(m->_transactionId);
       }
 
       // and (re-)insert
-      state->failedTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, true)));
+      failedTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, true)));
       break;
     }
 
     case TRI_WAL_MARKER_BEGIN_REMOTE_TRANSACTION: {
       transaction_remote_begin_marker_t const* m = reinterpret_cast<transaction_remote_begin_marker_t const*>(marker);
       // insert this transaction into the list of remote transactions
-      state->remoteTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, m->_externalId)));
+      remoteTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, m->_externalId)));
       break;
     }
 
     case TRI_WAL_MARKER_COMMIT_REMOTE_TRANSACTION: {
       transaction_remote_commit_marker_t const* m = reinterpret_cast<transaction_remote_commit_marker_t const*>(marker);
       // remove this transaction from the list of remote transactions
-      state->remoteTransactions.erase(m->_transactionId);
+      remoteTransactions.erase(m->_transactionId);
       break;
     }
 
@@ -628,14 +764,14 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
       transaction_remote_abort_marker_t const* m = reinterpret_cast<transaction_remote_abort_marker_t const*>(marker);
       // insert this transaction into the list of failed transactions
       // the transaction is treated the same as a regular local transaction that is aborted
-      auto it = state->failedTransactions.find(m->_transactionId);
-      if (it == state->failedTransactions.end()) {
+      auto it = failedTransactions.find(m->_transactionId);
+      if (it == failedTransactions.end()) {
         // insert the transaction into the list of failed transactions
-        state->failedTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, false)));
+        failedTransactions.emplace(std::make_pair(m->_transactionId, std::make_pair(m->_databaseId, false)));
       }
       
       // remove this transaction from the list of remote transactions
-      state->remoteTransactions.erase(m->_transactionId);
+      remoteTransactions.erase(m->_transactionId);
       break;
     }
 /*
@@ -646,14 +782,14 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
     case TRI_WAL_MARKER_CREATE_COLLECTION: {
       collection_create_marker_t const* m = reinterpret_cast<collection_create_marker_t const*>(marker);
       // undo a potential drop marker discovered before for the same collection
-      state->droppedCollections.erase(m->_collectionId);
+      droppedCollections.erase(m->_collectionId);
       break;
     }
   
     case TRI_WAL_MARKER_CREATE_DATABASE: {
       database_create_marker_t const* m = reinterpret_cast<database_create_marker_t const*>(marker);
       // undo a potential drop marker discovered before for the same database
-      state->droppedDatabases.erase(m->_databaseId);
+      droppedDatabases.erase(m->_databaseId);
       break;
     }
       
@@ -670,7 +806,7 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
     case TRI_WAL_MARKER_DROP_COLLECTION: {
       collection_drop_marker_t const* m = reinterpret_cast<collection_drop_marker_t const*>(marker);
       // note that the collection was dropped and doesn't need to be recovered
-      state->droppedIds.insert(m->_collectionId);
+      droppedIds.insert(m->_collectionId);
       break;
     }
 
@@ -678,7 +814,7 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
     case TRI_WAL_MARKER_DROP_DATABASE: {
       database_drop_marker_t const* m = reinterpret_cast<database_drop_marker_t const*>(marker);
       // note that the database was dropped and doesn't need to be recovered
-      state->droppedDatabases.insert(m->_databaseId);
+      droppedDatabases.insert(m->_databaseId);
       break;
     }
        
@@ -688,8 +824,6 @@ bool RecoverState::InitialScanMarker (TRI_df_marker_t const* marker,
     }
    */ 
   }
-
-  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -808,8 +942,8 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
           int res = TRI_InsertShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, nullptr, false, false, true);
 
           if (res == TRI_ERROR_ARANGO_UNIQUE_CONSTRAINT_VIOLATED) {
-            state->policy.setExpectedRevision(m->_revisionId);
-            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &state->policy, false, false);
+            TRI_doc_update_policy_t policy(TRI_DOC_UPDATE_ONLY_IF_NEWER, m->_revisionId, nullptr);
+            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &policy, false, false);
           }
 
           return res;
@@ -826,8 +960,8 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
           int res = TRI_InsertShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, nullptr, false, false, true);
 
           if (res == TRI_ERROR_ARANGO_UNIQUE_CONSTRAINT_VIOLATED) {
-            state->policy.setExpectedRevision(m->_revisionId);
-            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &state->policy, false, false);
+            TRI_doc_update_policy_t policy(TRI_DOC_UPDATE_ONLY_IF_NEWER, m->_revisionId, nullptr);
+            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &policy, false, false);
           }
 
           return res;
@@ -892,8 +1026,8 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
           int res = TRI_InsertShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &edge, false, false, true);
 
           if (res == TRI_ERROR_ARANGO_UNIQUE_CONSTRAINT_VIOLATED) {
-            state->policy.setExpectedRevision(m->_revisionId);
-            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &state->policy, false, false);
+            TRI_doc_update_policy_t policy(TRI_DOC_UPDATE_ONLY_IF_NEWER, m->_revisionId, nullptr);
+            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &policy, false, false);
           }
 
           return res;
@@ -910,8 +1044,8 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
           int res = TRI_InsertShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &edge, false, false, true);
 
           if (res == TRI_ERROR_ARANGO_UNIQUE_CONSTRAINT_VIOLATED) {
-            state->policy.setExpectedRevision(m->_revisionId);
-            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &state->policy, false, false);
+            TRI_doc_update_policy_t policy(TRI_DOC_UPDATE_ONLY_IF_NEWER, m->_revisionId, nullptr);
+            res = TRI_UpdateShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &mptr, &shaped, &policy, false, false);
           }
 
           return res;
@@ -965,8 +1099,8 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
           } 
 
           // remove the document and ignore any potential errors
-          state->policy.setExpectedRevision(m->_revisionId);
-          TRI_RemoveShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &state->policy, false, false);
+          TRI_doc_update_policy_t policy(TRI_DOC_UPDATE_ONLY_IF_NEWER, m->_revisionId, nullptr);
+          TRI_RemoveShapedJsonDocumentCollection(trx->trxCollection(collectionId), (TRI_voc_key_t) key, m->_revisionId, envelope, &policy, false, false);
 
           return TRI_ERROR_NO_ERROR;
         });
@@ -979,8 +1113,8 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
           } 
 
           // remove the document and ignore any potential errors
-          state->policy.setExpectedRevision(m->_revisionId);
-          TRI_RemoveShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &state->policy, false, false);
+          TRI_doc_update_policy_t policy(TRI_DOC_UPDATE_ONLY_IF_NEWER, m->_revisionId, nullptr);
+          TRI_RemoveShapedJsonDocumentCollection(trx->trxCollection(), (TRI_voc_key_t) key, m->_revisionId, envelope, &policy, false, false);
 
           return TRI_ERROR_NO_ERROR;
         });
@@ -1547,6 +1681,18 @@ bool RecoverState::ReplayMarker (TRI_df_marker_t const* marker,
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief callback to hand one marker to the replay threads
+////////////////////////////////////////////////////////////////////////////////
+
+bool RecoverState::DispatchMarker (TRI_df_marker_t const* marker,
+                                   void* data,
+                                   TRI_datafile_t* datafile) {
+  RecoverState* state = reinterpret_cast<RecoverState*>(data);
+
+  return state->dispatchMarker(marker, datafile);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replay a single logfile
 ////////////////////////////////////////////////////////////////////////////////
@@ -1558,7 +1704,7 @@ int RecoverState::replayLogfile (Logfile* logfile,
   LOG_INFO("replaying WAL logfile '%s' (%d of %d)", 
            logfile->filename().c_str(), number + 1, n);
 
-  if (! TRI_IterateDatafile(logfile->df(), &RecoverState::ReplayMarker, static_cast<void*>(this))) {
+  if (! TRI_IterateDatafile(logfile->df(), &RecoverState::DispatchMarker, static_cast<void*>(this))) {
     LOG_WARNING("WAL inspection failed when scanning logfile '%s'", logfile->filename().c_str());
     return TRI_ERROR_ARANGO_RECOVERY;
   }
@@ -1568,23 +1714,66 @@ int RecoverState::replayLogfile (Logfile* logfile,
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replay all logfiles
+///
+/// markers of different collections are replayed in parallel. each collection
+/// is assigned to one replay thread, which replays its markers in tick order.
+/// all other markers, e.g. for creating or dropping collections or markers of
+/// remote transactions, are replayed by the calling thread once the replay
+/// threads have caught up
 ////////////////////////////////////////////////////////////////////////////////
     
 int RecoverState::replayLogfiles () {
   droppedCollections.clear();
   droppedDatabases.clear();
 
+  double const start = TRI_microtime();
+  lastProgress = start;
+
+  if (numberOfThreads > 1) {
+    LOG_INFO("replaying WAL markers using %d threads", (int) numberOfThreads);
+
+    replayThreads.reserve(numberOfThreads);
+    replayBatches.resize(numberOfThreads);
+
+    for (uint32_t i = 0; i < numberOfThreads; ++i) {
+      // each thread has its own pool so markers are replayed in order
+      replayThreads.emplace_back(new triagens::basics::ThreadPool(1, "WalRecovery"));
+    }
+  }
+
+  int res = TRI_ERROR_NO_ERROR;
   int i = 0;
+
   for (auto& it : logfilesToProcess) {
     TRI_ASSERT(it != nullptr);
-    int res = replayLogfile(it, i++);
+    res = replayLogfile(it, i++);
 
     if (res != TRI_ERROR_NO_ERROR) {
-      return res;
+      break;
     }
   }
 
-  return TRI_ERROR_NO_ERROR;
+  waitForReplayThreads();
+
+  for (auto it : replayThreads) {
+    delete it;
+  }
+
+  replayThreads.clear();
+  replayBatches.clear();
+
+  if (res == TRI_ERROR_NO_ERROR && replayFailed) {
+    res = TRI_ERROR_ARANGO_RECOVERY;
+  }
+
+  if (res == TRI_ERROR_NO_ERROR) {
+    LOG_INFO("replayed %llu WAL markers in %.2f s, indexes of %d collections filled during replay", 
+             (unsigned long long) markersReplayed,
+             TRI_microtime() - start,
+             (int) filledCollections.size());
+  }
+
+  return res;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -1656,31 +1845,278 @@ int RecoverState::removeEmptyLogfiles () {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief fill the secondary indexes of all collections used in recovery
+///
+/// collections whose indexes were filled during the replay are skipped. the
+/// remaining collections are distributed over the recovery threads
 ////////////////////////////////////////////////////////////////////////////////
 
 int RecoverState::fillIndexes () {
-  // fake transaction to allow populating the secondary indexes
-  triagens::arango::TransactionBase trx(true);
+  std::vector<TRI_voc_cid_t> collections;
 
-  // release all collections
   for (auto it = openedCollections.begin(); it != openedCollections.end(); ++it) {
-    TRI_vocbase_col_t* collection = (*it).second;
+    if (filledCollections.find((*it).first) == filledCollections.end()) {
+      collections.emplace_back((*it).first);
+    }
+  }
 
-    TRI_document_collection_t* document = collection->_collection;
+  std::atomic<size_t> next(0);
+  std::atomic<int> result(TRI_ERROR_NO_ERROR);
 
-    TRI_ASSERT(document != nullptr);
+  auto fill = [&] () -> void {
+    while (true) {
+      size_t const i = next.fetch_add(1);
 
-    // activate secondary indexes
-    document->useSecondaryIndexes(true);
+      if (i >= collections.size()) {
+        break;
+      }
 
-    int res = TRI_FillIndexesDocumentCollection(collection, document);
+      int res = fillIndexes(collections[i]);
 
-    if (res != TRI_ERROR_NO_ERROR) {
-      return res;
+      if (res != TRI_ERROR_NO_ERROR) {
+        int expected = TRI_ERROR_NO_ERROR;
+        result.compare_exchange_strong(expected, res, std::memory_order_acquire);
+      }
+    }
+  };
+
+  size_t const n = (std::min)(collections.size(), static_cast<size_t>(numberOfThreads));
+
+  if (n <= 1) {
+    fill();
+  }
+  else {
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < n; ++i) {
+      threads.push_back(std::thread(fill));
+    }
+    for (size_t i = 0; i < n; ++i) {
+      threads[i].join();
     }
   }
- 
-  return TRI_ERROR_NO_ERROR; 
+
+  return result.load();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replay a marker or hand it to the replay thread of its collection
+////////////////////////////////////////////////////////////////////////////////
+
+bool RecoverState::dispatchMarker (TRI_df_marker_t const* marker,
+                                   TRI_datafile_t* datafile) {
+  if (replayFailed) {
+    // a replay thread found an error that must not be ignored
+    return false;
+  }
+
+  if ((++markersReplayed % ReplayBatchSize) == 0) {
+    double const now = TRI_microtime();
+
+    if (now - lastProgress >= ProgressInterval) {
+      lastProgress = now;
+      LOG_INFO("WAL recovery progress: replayed %llu of %llu markers (%d %%)", 
+               (unsigned long long) markersReplayed,
+               (unsigned long long) markersToReplay,
+               (int) (markersToReplay > 0 ? (100 * markersReplayed) / markersToReplay : 100));
+    }
+  }
+
+  if (replayThreads.empty()) {
+    return ReplayMarker(marker, static_cast<void*>(this), datafile);
+  }
+
+  TRI_voc_cid_t collectionId = 0;
+
+  switch (marker->_type) {
+    case TRI_WAL_MARKER_ATTRIBUTE:
+    case TRI_WAL_MARKER_SHAPE: {
+      collectionId = CollectionIdMarker(marker);
+      break;
+    }
+
+    case TRI_WAL_MARKER_DOCUMENT:
+    case TRI_WAL_MARKER_EDGE: {
+      document_marker_t const* m = reinterpret_cast<document_marker_t const*>(marker);
+
+      if (! isRemoteTransaction(m->_transactionId)) {
+        collectionId = m->_collectionId;
+      }
+      break;
+    }
+
+    case TRI_WAL_MARKER_REMOVE: {
+      remove_marker_t const* m = reinterpret_cast<remove_marker_t const*>(marker);
+
+      if (! isRemoteTransaction(m->_transactionId)) {
+        collectionId = m->_collectionId;
+      }
+      break;
+    }
+
+    case TRI_WAL_MARKER_BEGIN_REMOTE_TRANSACTION:
+    case TRI_WAL_MARKER_RENAME_COLLECTION:
+    case TRI_WAL_MARKER_CHANGE_COLLECTION:
+    case TRI_WAL_MARKER_CREATE_INDEX:
+    case TRI_WAL_MARKER_CREATE_COLLECTION:
+    case TRI_WAL_MARKER_CREATE_DATABASE:
+    case TRI_WAL_MARKER_DROP_INDEX:
+    case TRI_WAL_MARKER_DROP_COLLECTION:
+    case TRI_WAL_MARKER_DROP_DATABASE: {
+      break;
+    }
+
+    default: {
+      // nothing to replay
+      return true;
+    }
+  }
+
+  if (collectionId == 0 || isUsedByRemoteTransaction(collectionId)) {
+    // the marker changes state that is shared by all collections, so all
+    // markers before it must have been replayed
+    waitForReplayThreads();
+
+    return ReplayMarker(marker, static_cast<void*>(this), datafile);
+  }
+
+  size_t const partition = static_cast<size_t>(collectionId % replayThreads.size());
+  auto& batch = replayBatches[partition];
+
+  batch.emplace_back(marker, datafile);
+
+  if (batch.size() >= ReplayBatchSize) {
+    flushReplayBatch(partition);
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hand the pending markers of a partition to its replay thread
+////////////////////////////////////////////////////////////////////////////////
+
+void RecoverState::flushReplayBatch (size_t partition) {
+  auto& batch = replayBatches[partition];
+
+  if (batch.empty()) {
+    return;
+  }
+
+  auto markers = std::make_shared<std::vector<std::pair<TRI_df_marker_t const*, TRI_datafile_t*>>>();
+  markers->swap(batch);
+  batch.reserve(ReplayBatchSize);
+
+  replayThreads[partition]->enqueue([this, markers] () -> void {
+    replayBatch(*markers);
+  });
+
+  replayPending = true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replay markers in a replay thread
+////////////////////////////////////////////////////////////////////////////////
+
+void RecoverState::replayBatch (std::vector<std::pair<TRI_df_marker_t const*, TRI_datafile_t*>> const& markers) {
+  for (auto const& it : markers) {
+    if (replayFailed) {
+      return;
+    }
+
+    TRI_df_marker_t const* marker = it.first;
+    bool ok;
+
+    try {
+      ok = ReplayMarker(marker, static_cast<void*>(this), it.second);
+    }
+    catch (...) {
+      ok = false;
+    }
+
+    if (! ok) {
+      replayFailed = true;
+      return;
+    }
+
+    TRI_voc_cid_t collectionId = CollectionIdMarker(marker);
+    auto tick = collectionTicks.find(collectionId);
+
+    if (tick != collectionTicks.end() && (*tick).second == marker->_tick) {
+      // this was the collection's last marker, so its indexes can be
+      // filled while other collections are still replayed
+      int res = fillIndexes(collectionId);
+
+      if (res != TRI_ERROR_NO_ERROR) {
+        LOG_WARNING("unable to fill indexes of collection %llu: %s", 
+                    (unsigned long long) collectionId,
+                    TRI_errno_string(res));
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until the replay threads have replayed all markers handed
+/// to them
+////////////////////////////////////////////////////////////////////////////////
+
+void RecoverState::waitForReplayThreads () {
+  for (size_t i = 0; i < replayBatches.size(); ++i) {
+    flushReplayBatch(i);
+  }
+
+  if (! replayPending) {
+    return;
+  }
+
+  triagens::basics::Barrier barrier(replayThreads.size());
+
+  for (auto it : replayThreads) {
+    it->enqueue([&barrier] () -> void {
+      barrier.join();
+    });
+  }
+
+  barrier.synchronize();
+  replayPending = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fill the secondary indexes of a single collection used in recovery
+////////////////////////////////////////////////////////////////////////////////
+
+int RecoverState::fillIndexes (TRI_voc_cid_t collectionId) {
+  TRI_vocbase_col_t* collection;
+
+  {
+    MUTEX_LOCKER(lock);
+
+    auto it = openedCollections.find(collectionId);
+
+    if (it == openedCollections.end() || 
+        ! filledCollections.emplace(collectionId).second) {
+      // collection not used in recovery or already filled
+      return TRI_ERROR_NO_ERROR;
+    }
+
+    collection = (*it).second;
+  }
+
+  // fake transaction to allow populating the secondary indexes
+  triagens::arango::TransactionBase trx(true);
+
+  TRI_document_collection_t* document = collection->_collection;
+
+  TRI_ASSERT(document != nullptr);
+
+  // activate secondary indexes
+  document->useSecondaryIndexes(true);
+
+  return TRI_FillIndexesDocumentCollection(collection, document);
 }
 
 // -----------------------------------------------------------------------------
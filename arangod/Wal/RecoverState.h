@@ -31,6 +31,8 @@
 #define ARANGODB_WAL_RECOVER_STATE_H 1
 
 #include "Basics/Common.h"
+#include "Basics/Mutex.h"
+#include "Basics/ThreadPool.h"
 #include "Utils/transactions.h"
 #include "VocBase/datafile.h"
 #include "VocBase/document-collection.h"
@@ -59,6 +61,32 @@ struct TRI_server_s;
 namespace triagens {
   namespace wal {
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       RecoverScan
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief result of the initial scan of a single WAL logfile
+///
+/// logfiles are scanned independently of each other, and the results are
+/// merged into the recover state in logfile order afterwards
+////////////////////////////////////////////////////////////////////////////////
+
+    struct RecoverScan {
+
+      RecoverScan ()
+        : lastTick(0),
+          numberOfMarkers(0),
+          markers(),
+          collectionTicks() {
+      }
+
+      TRI_voc_tick_t                                    lastTick;
+      uint64_t                                          numberOfMarkers;
+      std::vector<TRI_df_marker_t const*>               markers;
+      std::unordered_map<TRI_voc_cid_t, TRI_voc_tick_t> collectionTicks;
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                      RecoverState
 // -----------------------------------------------------------------------------
@@ -81,7 +109,8 @@ namespace triagens {
 ////////////////////////////////////////////////////////////////////////////////
 
       RecoverState (TRI_server_t*,
-                    bool);
+                    bool,
+                    uint32_t);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief destroys the recover state
@@ -261,13 +290,30 @@ namespace triagens {
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief callback to handle one marker during recovery
-/// this function only builds up state and does not change any data
+/// this function only builds up state and does not change any data. it is
+/// called with a RecoverScan, and may run for several logfiles in parallel
 ////////////////////////////////////////////////////////////////////////////////
 
       static bool InitialScanMarker (TRI_df_marker_t const*,
                                      void*,
                                      TRI_datafile_t*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief merge the scan result of a logfile into the state
+/// this must be called for the logfiles in ascending order
+////////////////////////////////////////////////////////////////////////////////
+
+      void applyScan (RecoverScan const&,
+                      bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief callback to hand one marker to the replay threads
+////////////////////////////////////////////////////////////////////////////////
+
+      static bool DispatchMarker (TRI_df_marker_t const*,
+                                  void*,
+                                  TRI_datafile_t*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief replay a single logfile
 ////////////////////////////////////////////////////////////////////////////////
@@ -298,6 +344,48 @@ namespace triagens {
 
       int fillIndexes ();
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief note a marker found in the initial scan that affects the state
+////////////////////////////////////////////////////////////////////////////////
+
+      void applyScanMarker (TRI_df_marker_t const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replay a marker or hand it to the replay thread of its collection
+////////////////////////////////////////////////////////////////////////////////
+
+      bool dispatchMarker (TRI_df_marker_t const*,
+                           TRI_datafile_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief hand the pending markers of a partition to its replay thread
+////////////////////////////////////////////////////////////////////////////////
+
+      void flushReplayBatch (size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replay markers in a replay thread
+////////////////////////////////////////////////////////////////////////////////
+
+      void replayBatch (std::vector<std::pair<TRI_df_marker_t const*, TRI_datafile_t*>> const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief wait until the replay threads have replayed all markers handed
+/// to them
+////////////////////////////////////////////////////////////////////////////////
+
+      void waitForReplayThreads ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fill the secondary indexes of a single collection used in recovery
+////////////////////////////////////////////////////////////////////////////////
+
+      int fillIndexes (TRI_voc_cid_t);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                  public variables
 // -----------------------------------------------------------------------------
@@ -317,10 +405,22 @@ namespace triagens {
       std::unordered_map<TRI_voc_tick_t, TRI_vocbase_t*>                          openedDatabases;
       std::unordered_map<TRI_voc_tid_t, RemoteTransactionType*>                   runningRemoteTransactions;
       std::vector<std::string>                                                    emptyLogfiles;
+      std::unordered_map<TRI_voc_cid_t, TRI_voc_tick_t>                           collectionTicks;
+      std::unordered_set<TRI_voc_cid_t>                                           filledCollections;
 
-      TRI_doc_update_policy_t                                                     policy;
       bool                                                                        ignoreRecoveryErrors;
-      int64_t                                                                     errorCount;
+      std::atomic<int64_t>                                                        errorCount;
+
+      uint32_t                                                                    numberOfThreads;
+      std::vector<triagens::basics::ThreadPool*>                                  replayThreads;
+      std::vector<std::vector<std::pair<TRI_df_marker_t const*, TRI_datafile_t*>>> replayBatches;
+      bool                                                                        replayPending;
+      std::atomic<bool>                                                           replayFailed;
+      triagens::basics::Mutex                                                     lock;
+
+      uint64_t                                                                    markersToReplay;
+      uint64_t                                                                    markersReplayed;
+      double                                                                      lastProgress;
     };
 
   }
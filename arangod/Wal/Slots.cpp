@@ -376,6 +376,81 @@ SlotInfo Slots::nextUnused (uint32_t size,
   return SlotInfo(TRI_ERROR_ARANGO_NO_JOURNAL);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the next unused slots for a batch of markers
+///
+/// the slot for the first marker is acquired like the slot of a single marker,
+/// waiting for a free slot or a new logfile if required. the slots for the
+/// following markers are then handed out under a single acquisition of the
+/// lock, for as long as there are free slots, the current logfile has enough
+/// space left and contains the legends required. the number of slots handed
+/// out is returned in count, the remaining markers must be handled by another
+/// call. TRI_ERROR_LEGEND_NOT_IN_WAL_FILE is returned if the first marker
+/// needs a legend that is not yet in the logfile
+////////////////////////////////////////////////////////////////////////////////
+
+int Slots::nextUnused (SlotBatchEntry* entries,
+                       size_t n,
+                       size_t& count) {
+  TRI_ASSERT(n > 0);
+
+  count = 0;
+
+  SlotBatchEntry& first = entries[0];
+
+  if (first.needsLegend) {
+    first.slotInfo = nextUnused(first.size, first.cid, first.sid, 0, first.oldLegend);
+  }
+  else {
+    first.slotInfo = nextUnused(first.size);
+  }
+
+  if (first.slotInfo.errorCode != TRI_ERROR_NO_ERROR) {
+    return first.slotInfo.errorCode;
+  }
+
+  count = 1;
+
+  MUTEX_LOCKER(_lock);
+
+  while (count < n) {
+    SlotBatchEntry& entry = entries[count];
+    uint32_t alignedSize = TRI_DF_ALIGN_BLOCK(entry.size);
+
+    Slot* slot = &_slots[_handoutIndex];
+    TRI_ASSERT(slot != nullptr);
+
+    if (! slot->isUnused() ||
+        _logfile == nullptr ||
+        _logfile->freeSize() < static_cast<uint64_t>(alignedSize)) {
+      // the remaining markers may have to wait for a slot or a new logfile
+      break;
+    }
+
+    if (entry.needsLegend) {
+      void* legend = _logfile->lookupLegend(entry.cid, entry.sid);
+
+      if (legend == nullptr) {
+        break;
+      }
+
+      entry.oldLegend = legend;
+    }
+
+    char* mem = _logfile->reserve(alignedSize);
+
+    if (mem == nullptr) {
+      break;
+    }
+
+    slot->setUsed(static_cast<void*>(mem), entry.size, _logfile->id(), handout());
+    entry.slotInfo = SlotInfo(slot);
+    ++count;
+  }
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return a used slot, allowing its synchronisation
 ////////////////////////////////////////////////////////////////////////////////
@@ -400,6 +475,35 @@ void Slots::returnUsed (SlotInfo& slotInfo,
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the used slots of a batch of markers
+////////////////////////////////////////////////////////////////////////////////
+
+void Slots::returnUsed (SlotBatchEntry* entries,
+                        size_t n,
+                        bool waitForSync) {
+  TRI_ASSERT(n > 0);
+  Slot::TickType tick = entries[n - 1].slotInfo.slot->tick();
+
+  TRI_ASSERT(tick > 0);
+
+  {
+    MUTEX_LOCKER(_lock);
+
+    for (size_t i = 0; i < n; ++i) {
+      TRI_ASSERT(entries[i].slotInfo.slot != nullptr);
+      entries[i].slotInfo.slot->setReturned(waitForSync);
+      ++_numEvents;
+    }
+  }
+
+  _logfileManager->signalSync();
+
+  if (waitForSync) {
+    waitForTick(tick);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the next synchronisable region
 ////////////////////////////////////////////////////////////////////////////////
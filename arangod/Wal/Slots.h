@@ -99,6 +99,49 @@ namespace triagens {
       int         errorCode;
     };
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                             struct SlotBatchEntry
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a marker that is written as part of a batch
+///
+/// document and edge markers without a legend must set needsLegend. they can
+/// only be written if the logfile already contains a legend for their shape,
+/// which is then returned in oldLegend. the position of the written marker is
+/// returned in mem, logfileId and tick
+////////////////////////////////////////////////////////////////////////////////
+
+    struct SlotBatchEntry {
+      SlotBatchEntry (void* src,
+                      uint32_t size,
+                      TRI_voc_cid_t cid,
+                      TRI_shape_sid_t sid,
+                      bool needsLegend)
+        : src(src),
+          size(size),
+          cid(cid),
+          sid(sid),
+          needsLegend(needsLegend),
+          oldLegend(nullptr),
+          slotInfo(),
+          mem(nullptr),
+          logfileId(0),
+          tick(0) {
+      }
+
+      void*            src;
+      uint32_t         size;
+      TRI_voc_cid_t    cid;
+      TRI_shape_sid_t  sid;
+      bool             needsLegend;
+      void*            oldLegend;
+      SlotInfo         slotInfo;
+      void const*      mem;
+      Logfile::IdType  logfileId;
+      Slot::TickType   tick;
+    };
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                       class Slots
 // -----------------------------------------------------------------------------
@@ -172,6 +215,14 @@ namespace triagens {
                              uint32_t legendIncluded,
                              void*& oldLegend);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the next unused slots for a batch of markers
+////////////////////////////////////////////////////////////////////////////////
+
+        int nextUnused (SlotBatchEntry*,
+                        size_t,
+                        size_t&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief return a used slot, allowing its synchronisation
 ////////////////////////////////////////////////////////////////////////////////
@@ -179,6 +230,14 @@ namespace triagens {
         void returnUsed (SlotInfo&,
                          bool);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the used slots of a batch of markers
+////////////////////////////////////////////////////////////////////////////////
+
+        void returnUsed (SlotBatchEntry*,
+                         size_t,
+                         bool);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief get the next synchronisable region
 ////////////////////////////////////////////////////////////////////////////////
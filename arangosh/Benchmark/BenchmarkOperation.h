@@ -90,6 +90,31 @@ namespace triagens {
 
       virtual const char* payload (size_t*, const int, const size_t, const size_t, bool*) = 0;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the names of the operation classes, results are reported
+/// per class if there is more than one
+////////////////////////////////////////////////////////////////////////////////
+
+      virtual std::vector<std::string> operationClasses () const {
+        return std::vector<std::string>();
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the class of the operation to execute
+////////////////////////////////////////////////////////////////////////////////
+
+      virtual size_t operationClass (const int, const size_t, const size_t) {
+        return 0;
+      }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of operations to execute before measuring
+////////////////////////////////////////////////////////////////////////////////
+
+      virtual size_t warmupOperations () const {
+        return 0;
+      }
+
     };
   }
 }
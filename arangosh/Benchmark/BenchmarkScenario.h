@@ -0,0 +1,965 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief benchmark workload described in a scenario file
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_BENCHMARK_BENCHMARK_SCENARIO_H
+#define ARANGODB_BENCHMARK_BENCHMARK_SCENARIO_H 1
+
+#include "Basics/Common.h"
+
+#include "Basics/JsonHelper.h"
+#include "Basics/StringUtils.h"
+#include "Basics/fasthash.h"
+#include "Basics/json.h"
+#include "Basics/string-buffer.h"
+#include "Basics/tri-strings.h"
+#include "Rest/HttpRequest.h"
+#include "SimpleHttpClient/SimpleHttpClient.h"
+#include "SimpleHttpClient/SimpleHttpResult.h"
+#include "Benchmark/BenchmarkOperation.h"
+
+namespace triagens {
+  namespace arangob {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                           class BenchmarkScenario
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a mixed workload described in a JSON file
+///
+/// A scenario consists of a weighted list of operations. Each operation is a
+/// document read, insert, update, replace or remove, a parameterised AQL
+/// query, or an arbitrary REST call. The keys of the documents are drawn from
+/// a uniform, zipfian or hot-set distribution over a fixed key space, and the
+/// documents written have a fixed or uniformly distributed size. Example:
+///
+///     {
+///       "collection" : "Scenario",
+///       "keys" : 100000,
+///       "keyDistribution" : { "type" : "zipfian", "theta" : 0.99 },
+///       "documentSize" : { "type" : "uniform", "min" : 100, "max" : 1000 },
+///       "warmup" : 10000,
+///       "operations" : [
+///         { "type" : "read", "weight" : 80 },
+///         { "type" : "update", "weight" : 15 },
+///         { "name" : "lookup", "type" : "aql", "weight" : 5,
+///           "query" : "FOR d IN @@collection FILTER d._key == @key RETURN d" }
+///       ]
+///     }
+///
+/// All random decisions are derived from the seed, the thread number and the
+/// thread's operation counter, so the three callbacks of an operation agree
+/// on what they describe, and a run can be repeated exactly.
+////////////////////////////////////////////////////////////////////////////////
+
+    class BenchmarkScenario : public BenchmarkOperation {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+      private:
+
+        enum DistributionType {
+          DISTRIBUTION_UNIFORM,
+          DISTRIBUTION_ZIPFIAN,
+          DISTRIBUTION_HOTSET
+        };
+
+        enum OperationType {
+          OPERATION_READ,
+          OPERATION_INSERT,
+          OPERATION_UPDATE,
+          OPERATION_REPLACE,
+          OPERATION_REMOVE,
+          OPERATION_AQL,
+          OPERATION_REST
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief salts for the different random decisions of an operation
+////////////////////////////////////////////////////////////////////////////////
+
+        enum {
+          SALT_OPERATION,
+          SALT_KEY,
+          SALT_HOTSET,
+          SALT_SIZE,
+          SALT_VALUE
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief an operation of the scenario
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Operation {
+          std::string _name;
+          OperationType _type;
+
+          // upper bound of the operation's share in [0, 1)
+          double _bound;
+
+          // REST calls, may contain {collection}, {key} and {value}
+          rest::HttpRequest::HttpRequestType _method;
+          std::string _path;
+          std::string _body;
+
+          // AQL queries, static bind parameters are pre-serialised
+          std::string _query;
+          std::string _bindVars;
+          bool _bindKey;
+          bool _bindValue;
+        };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      private:
+
+        BenchmarkScenario ()
+          : BenchmarkOperation(),
+            _collection(),
+            _keys(1000),
+            _keyDistribution(DISTRIBUTION_UNIFORM),
+            _theta(0.99),
+            _zetan(0.0),
+            _alpha(0.0),
+            _eta(0.0),
+            _hotFraction(0.2),
+            _hotProbability(0.8),
+            _minSize(0),
+            _maxSize(0),
+            _warmup(0),
+            _seed(0),
+            _prepare(true),
+            _operations() {
+        }
+
+      public:
+
+        ~BenchmarkScenario () {
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             public static methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief loads a scenario file, returns nullptr and sets error on failure
+////////////////////////////////////////////////////////////////////////////////
+
+        static BenchmarkScenario* load (std::string const& filename,
+                                        std::string const& collection,
+                                        std::string& error) {
+          char* parseError = nullptr;
+          TRI_json_t* json = TRI_JsonFile(TRI_UNKNOWN_MEM_ZONE, filename.c_str(), &parseError);
+
+          if (json == nullptr) {
+            error = "cannot parse scenario file '" + filename + "'";
+
+            if (parseError != nullptr) {
+              error += ": " + std::string(parseError);
+            }
+          }
+
+          if (parseError != nullptr) {
+            TRI_FreeString(TRI_CORE_MEM_ZONE, parseError);
+          }
+
+          if (json == nullptr) {
+            return nullptr;
+          }
+
+          std::unique_ptr<BenchmarkScenario> scenario(new BenchmarkScenario());
+          bool ok = scenario->parse(json, collection, error);
+
+          TRI_FreeJson(TRI_UNKNOWN_MEM_ZONE, json);
+
+          if (! ok) {
+            error = "invalid scenario file '" + filename + "': " + error;
+            return nullptr;
+          }
+
+          return scenario.release();
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates the collection and the documents of the key space
+////////////////////////////////////////////////////////////////////////////////
+
+        bool setUp (httpclient::SimpleHttpClient* client) {
+          if (! _prepare) {
+            return true;
+          }
+
+          std::string const name = _collection;
+
+          // a missing collection is fine here
+          sendRequest(client, rest::HttpRequest::HTTP_REQUEST_DELETE, "/_api/collection/" + name, "");
+
+          if (! sendRequest(client,
+                            rest::HttpRequest::HTTP_REQUEST_POST,
+                            "/_api/collection",
+                            "{\"name\":\"" + name + "\"}")) {
+            return false;
+          }
+
+          static uint64_t const ChunkSize = 1000;
+
+          for (uint64_t start = 0;  start < _keys;  start += ChunkSize) {
+            TRI_string_buffer_t* buffer = TRI_CreateSizedStringBuffer(TRI_UNKNOWN_MEM_ZONE, ChunkSize * (_maxSize + 64));
+
+            for (uint64_t key = start;  key < _keys && key < start + ChunkSize;  ++key) {
+              appendDocument(buffer, &key, -1, static_cast<size_t>(key), key);
+              TRI_AppendCharStringBuffer(buffer, '\n');
+            }
+
+            std::string const body(TRI_BeginStringBuffer(buffer), TRI_LengthStringBuffer(buffer));
+            TRI_FreeStringBuffer(TRI_UNKNOWN_MEM_ZONE, buffer);
+
+            if (! sendRequest(client,
+                              rest::HttpRequest::HTTP_REQUEST_POST,
+                              "/_api/import?type=documents&collection=" + name,
+                              body)) {
+              return false;
+            }
+          }
+
+          return true;
+        }
+
+        void tearDown () {
+        }
+
+        std::string url (const int threadNumber, const size_t threadCounter, const size_t globalCounter) {
+          Operation const& operation = nextOperation(threadNumber, threadCounter);
+
+          switch (operation._type) {
+            case OPERATION_INSERT:
+              return "/_api/document?collection=" + _collection;
+
+            case OPERATION_READ:
+            case OPERATION_UPDATE:
+            case OPERATION_REPLACE:
+            case OPERATION_REMOVE:
+              return "/_api/document/" + _collection + "/" + keyName(nextKey(threadNumber, threadCounter));
+
+            case OPERATION_AQL:
+              return "/_api/cursor";
+
+            case OPERATION_REST:
+              return substitute(operation._path, threadNumber, threadCounter);
+          }
+
+          TRI_ASSERT(false);
+          return "";
+        }
+
+        rest::HttpRequest::HttpRequestType type (const int threadNumber, const size_t threadCounter, const size_t globalCounter) {
+          Operation const& operation = nextOperation(threadNumber, threadCounter);
+
+          switch (operation._type) {
+            case OPERATION_READ:
+              return rest::HttpRequest::HTTP_REQUEST_GET;
+
+            case OPERATION_INSERT:
+            case OPERATION_AQL:
+              return rest::HttpRequest::HTTP_REQUEST_POST;
+
+            case OPERATION_UPDATE:
+              return rest::HttpRequest::HTTP_REQUEST_PATCH;
+
+            case OPERATION_REPLACE:
+              return rest::HttpRequest::HTTP_REQUEST_PUT;
+
+            case OPERATION_REMOVE:
+              return rest::HttpRequest::HTTP_REQUEST_DELETE;
+
+            case OPERATION_REST:
+              return operation._method;
+          }
+
+          TRI_ASSERT(false);
+          return rest::HttpRequest::HTTP_REQUEST_GET;
+        }
+
+        const char* payload (size_t* length, const int threadNumber, const size_t threadCounter, const size_t globalCounter, bool* mustFree) {
+          Operation const& operation = nextOperation(threadNumber, threadCounter);
+
+          if (operation._type == OPERATION_READ ||
+              operation._type == OPERATION_REMOVE ||
+              (operation._type == OPERATION_REST && operation._body.empty())) {
+            *length = 0;
+            *mustFree = false;
+            return (const char*) nullptr;
+          }
+
+          TRI_string_buffer_t* buffer = TRI_CreateSizedStringBuffer(TRI_UNKNOWN_MEM_ZONE, _maxSize + 256);
+
+          if (operation._type == OPERATION_AQL) {
+            TRI_AppendStringStringBuffer(buffer, "{\"query\":\"");
+            TRI_AppendJsonEncodedStringStringBuffer(buffer, operation._query.c_str(), false);
+            TRI_AppendStringStringBuffer(buffer, "\",\"bindVars\":{");
+            TRI_AppendString2StringBuffer(buffer, operation._bindVars.c_str(), operation._bindVars.size());
+
+            bool first = operation._bindVars.empty();
+
+            if (operation._bindKey) {
+              TRI_AppendStringStringBuffer(buffer, first ? "\"key\":\"" : ",\"key\":\"");
+              TRI_AppendStringStringBuffer(buffer, keyName(nextKey(threadNumber, threadCounter)).c_str());
+              TRI_AppendCharStringBuffer(buffer, '"');
+              first = false;
+            }
+
+            if (operation._bindValue) {
+              TRI_AppendStringStringBuffer(buffer, first ? "\"value\":" : ",\"value\":");
+              TRI_AppendUInt64StringBuffer(buffer, nextValue(threadNumber, threadCounter));
+            }
+
+            TRI_AppendStringStringBuffer(buffer, "}}");
+          }
+          else if (operation._type == OPERATION_REST) {
+            std::string const body = substitute(operation._body, threadNumber, threadCounter);
+            TRI_AppendString2StringBuffer(buffer, body.c_str(), body.size());
+          }
+          else {
+            appendDocument(buffer, nullptr, threadNumber, threadCounter, nextValue(threadNumber, threadCounter));
+          }
+
+          *length = TRI_LengthStringBuffer(buffer);
+          *mustFree = true;
+          char* ptr = TRI_StealStringBuffer(buffer);
+          TRI_FreeStringBuffer(TRI_UNKNOWN_MEM_ZONE, buffer);
+
+          return (const char*) ptr;
+        }
+
+        std::vector<std::string> operationClasses () const {
+          std::vector<std::string> result;
+
+          for (auto const& operation : _operations) {
+            result.emplace_back(operation._name);
+          }
+
+          return result;
+        }
+
+        size_t operationClass (const int threadNumber, const size_t threadCounter, const size_t globalCounter) {
+          return static_cast<size_t>(&nextOperation(threadNumber, threadCounter) - &_operations[0]);
+        }
+
+        size_t warmupOperations () const {
+          return static_cast<size_t>(_warmup);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the collection of the scenario
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string const& collection () const {
+          return _collection;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reads the scenario description
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parse (TRI_json_t const* json,
+                    std::string const& collection,
+                    std::string& error) {
+          using triagens::basics::JsonHelper;
+
+          if (! TRI_IsObjectJson(json)) {
+            error = "expecting an object";
+            return false;
+          }
+
+          _collection = JsonHelper::getStringValue(json, "collection", collection);
+          _keys = JsonHelper::getNumericValue<uint64_t>(json, "keys", _keys);
+          _warmup = JsonHelper::getNumericValue<uint64_t>(json, "warmup", _warmup);
+          _seed = JsonHelper::getNumericValue<uint64_t>(json, "seed", _seed);
+          _prepare = JsonHelper::getBooleanValue(json, "prepare", _prepare);
+
+          if (_collection.empty() || _keys == 0) {
+            error = "'collection' and 'keys' must not be empty";
+            return false;
+          }
+
+          // key distribution
+          TRI_json_t const* keys = TRI_LookupObjectJson(json, "keyDistribution");
+
+          if (keys != nullptr) {
+            std::string const type = JsonHelper::getStringValue(keys, "type", "uniform");
+
+            if (type == "uniform") {
+              _keyDistribution = DISTRIBUTION_UNIFORM;
+            }
+            else if (type == "zipfian") {
+              _keyDistribution = DISTRIBUTION_ZIPFIAN;
+              _theta = JsonHelper::getNumericValue<double>(keys, "theta", _theta);
+
+              if (_theta <= 0.0 || _theta >= 1.0) {
+                error = "'theta' must be between 0 and 1";
+                return false;
+              }
+            }
+            else if (type == "hotset") {
+              _keyDistribution = DISTRIBUTION_HOTSET;
+              _hotFraction = JsonHelper::getNumericValue<double>(keys, "hotFraction", _hotFraction);
+              _hotProbability = JsonHelper::getNumericValue<double>(keys, "hotProbability", _hotProbability);
+
+              if (_hotFraction <= 0.0 || _hotFraction > 1.0 ||
+                  _hotProbability < 0.0 || _hotProbability > 1.0) {
+                error = "'hotFraction' and 'hotProbability' must be between 0 and 1";
+                return false;
+              }
+            }
+            else {
+              error = "unknown key distribution '" + type + "'";
+              return false;
+            }
+          }
+
+          if (_keyDistribution == DISTRIBUTION_ZIPFIAN) {
+            initZipfian();
+          }
+
+          // document sizes
+          TRI_json_t const* size = TRI_LookupObjectJson(json, "documentSize");
+
+          if (size != nullptr) {
+            std::string const type = JsonHelper::getStringValue(size, "type", "fixed");
+
+            if (type == "fixed") {
+              _minSize = _maxSize = JsonHelper::getNumericValue<size_t>(size, "size", 0);
+            }
+            else if (type == "uniform") {
+              _minSize = JsonHelper::getNumericValue<size_t>(size, "min", 0);
+              _maxSize = JsonHelper::getNumericValue<size_t>(size, "max", 0);
+
+              if (_minSize > _maxSize) {
+                error = "'min' must not be greater than 'max'";
+                return false;
+              }
+            }
+            else {
+              error = "unknown document size distribution '" + type + "'";
+              return false;
+            }
+          }
+
+          // operations
+          TRI_json_t const* operations = TRI_LookupObjectJson(json, "operations");
+
+          if (! TRI_IsArrayJson(operations) || TRI_LengthArrayJson(operations) == 0) {
+            error = "'operations' must be a non-empty array";
+            return false;
+          }
+
+          double total = 0.0;
+
+          for (size_t i = 0;  i < TRI_LengthArrayJson(operations);  ++i) {
+            Operation operation;
+
+            if (! parseOperation(TRI_LookupArrayJson(operations, i), operation, error)) {
+              return false;
+            }
+
+            total += operation._bound;
+            operation._bound = total;
+
+            _operations.emplace_back(std::move(operation));
+          }
+
+          if (total <= 0.0) {
+            error = "the sum of the operation weights must be positive";
+            return false;
+          }
+
+          for (auto& operation : _operations) {
+            operation._bound /= total;
+          }
+
+          return true;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reads an operation, its _bound is set to its weight
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseOperation (TRI_json_t const* json,
+                             Operation& operation,
+                             std::string& error) {
+          using triagens::basics::JsonHelper;
+
+          if (! TRI_IsObjectJson(json)) {
+            error = "expecting an object for each operation";
+            return false;
+          }
+
+          std::string const type = JsonHelper::getStringValue(json, "type", "");
+
+          operation._name = JsonHelper::getStringValue(json, "name", type);
+          operation._bound = JsonHelper::getNumericValue<double>(json, "weight", 1.0);
+          operation._method = rest::HttpRequest::HTTP_REQUEST_GET;
+          operation._bindKey = false;
+          operation._bindValue = false;
+
+          if (operation._bound < 0.0) {
+            error = "the weight of operation '" + operation._name + "' must not be negative";
+            return false;
+          }
+
+          if (type == "read") {
+            operation._type = OPERATION_READ;
+          }
+          else if (type == "insert") {
+            operation._type = OPERATION_INSERT;
+          }
+          else if (type == "update") {
+            operation._type = OPERATION_UPDATE;
+          }
+          else if (type == "replace") {
+            operation._type = OPERATION_REPLACE;
+          }
+          else if (type == "remove") {
+            operation._type = OPERATION_REMOVE;
+          }
+          else if (type == "aql") {
+            operation._type = OPERATION_AQL;
+            operation._query = JsonHelper::getStringValue(json, "query", "");
+
+            if (operation._query.empty()) {
+              error = "operation '" + operation._name + "' has no query";
+              return false;
+            }
+
+            return parseBindVars(json, operation, error);
+          }
+          else if (type == "rest") {
+            operation._type = OPERATION_REST;
+            operation._method = rest::HttpRequest::translateMethod(JsonHelper::getStringValue(json, "method", "GET"));
+            operation._path = JsonHelper::getStringValue(json, "path", "");
+            operation._body = JsonHelper::getStringValue(json, "body", "");
+
+            if (operation._method == rest::HttpRequest::HTTP_REQUEST_ILLEGAL || operation._path.empty()) {
+              error = "operation '" + operation._name + "' needs a valid 'method' and 'path'";
+              return false;
+            }
+          }
+          else {
+            error = "unknown operation type '" + type + "'";
+            return false;
+          }
+
+          return true;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collects the bind parameters of a query
+///
+/// @@collection, @key and @value are filled in for each request, all other
+/// bind parameters must be given in the "bindVars" attribute.
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseBindVars (TRI_json_t const* json,
+                            Operation& operation,
+                            std::string& error) {
+          using triagens::basics::JsonHelper;
+
+          TRI_json_t const* bindVars = TRI_LookupObjectJson(json, "bindVars");
+          std::string const& query = operation._query;
+          std::vector<std::string> names;
+
+          for (size_t i = 0;  i < query.size();  ++i) {
+            if (query[i] != '@') {
+              continue;
+            }
+
+            size_t end = i + 1;
+
+            if (end < query.size() && query[end] == '@') {
+              ++end;
+            }
+
+            while (end < query.size() && (isalnum(query[end]) || query[end] == '_')) {
+              ++end;
+            }
+
+            names.emplace_back(query.substr(i + 1, end - i - 1));
+            i = end - 1;
+          }
+
+          for (auto const& name : names) {
+            TRI_json_t const* value = (bindVars == nullptr ? nullptr : TRI_LookupObjectJson(bindVars, name.c_str()));
+            std::string serialised;
+
+            if (value != nullptr) {
+              serialised = JsonHelper::toString(value);
+            }
+            else if (name == "@collection") {
+              serialised = "\"" + _collection + "\"";
+            }
+            else if (name == "key") {
+              operation._bindKey = true;
+              continue;
+            }
+            else if (name == "value") {
+              operation._bindValue = true;
+              continue;
+            }
+            else {
+              error = "no value for bind parameter '" + name + "' of operation '" + operation._name + "'";
+              return false;
+            }
+
+            if (operation._bindVars.find("\"" + name + "\":") != std::string::npos) {
+              // parameter is used more than once
+              continue;
+            }
+
+            if (! operation._bindVars.empty()) {
+              operation._bindVars += ",";
+            }
+
+            operation._bindVars += "\"" + name + "\":" + serialised;
+          }
+
+          return true;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief precomputes the constants of the zipfian distribution
+///
+/// Uses the method of Gray et al., "Quickly Generating Billion-Record
+/// Synthetic Databases", which maps a uniform value to a rank in O(1).
+////////////////////////////////////////////////////////////////////////////////
+
+        void initZipfian () {
+          double const n = static_cast<double>(_keys);
+
+          _zetan = 0.0;
+
+          for (uint64_t i = 1;  i <= _keys;  ++i) {
+            _zetan += 1.0 / pow(static_cast<double>(i), _theta);
+          }
+
+          double const zeta2 = 1.0 + pow(0.5, _theta);
+
+          _alpha = 1.0 / (1.0 - _theta);
+          _eta = (1.0 - pow(2.0 / n, 1.0 - _theta)) / (1.0 - zeta2 / _zetan);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a random number for a decision of an operation
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t random (const int threadNumber, const size_t threadCounter, uint64_t salt) const {
+          uint64_t values[3] = {
+            static_cast<uint64_t>(threadNumber),
+            static_cast<uint64_t>(threadCounter),
+            salt
+          };
+
+          return fasthash64(values, sizeof(values), _seed);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a random number in [0, 1) for a decision of an operation
+////////////////////////////////////////////////////////////////////////////////
+
+        double uniform (const int threadNumber, const size_t threadCounter, uint64_t salt) const {
+          return static_cast<double>(random(threadNumber, threadCounter, salt) >> 11) / 9007199254740992.0;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the operation to execute
+////////////////////////////////////////////////////////////////////////////////
+
+        Operation const& nextOperation (const int threadNumber, const size_t threadCounter) const {
+          double const u = uniform(threadNumber, threadCounter, SALT_OPERATION);
+
+          for (auto const& operation : _operations) {
+            if (u < operation._bound) {
+              return operation;
+            }
+          }
+
+          return _operations.back();
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the key of an operation
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t nextKey (const int threadNumber, const size_t threadCounter) const {
+          double const u = uniform(threadNumber, threadCounter, SALT_KEY);
+          double const n = static_cast<double>(_keys);
+          uint64_t key = 0;
+
+          switch (_keyDistribution) {
+            case DISTRIBUTION_UNIFORM: {
+              key = static_cast<uint64_t>(u * n);
+              break;
+            }
+
+            case DISTRIBUTION_ZIPFIAN: {
+              double const uz = u * _zetan;
+              uint64_t rank;
+
+              if (uz < 1.0) {
+                rank = 0;
+              }
+              else if (uz < 1.0 + pow(0.5, _theta)) {
+                rank = 1;
+              }
+              else {
+                rank = static_cast<uint64_t>(n * pow(_eta * u - _eta + 1.0, _alpha));
+              }
+
+              // scatter the popular keys over the key space
+              key = fasthash64(&rank, sizeof(rank), 0xdeadbeef) % _keys;
+              break;
+            }
+
+            case DISTRIBUTION_HOTSET: {
+              uint64_t hot = static_cast<uint64_t>(n * _hotFraction);
+
+              if (hot == 0) {
+                hot = 1;
+              }
+
+              if (hot == _keys || uniform(threadNumber, threadCounter, SALT_HOTSET) < _hotProbability) {
+                key = static_cast<uint64_t>(u * static_cast<double>(hot));
+              }
+              else {
+                key = hot + static_cast<uint64_t>(u * static_cast<double>(_keys - hot));
+              }
+              break;
+            }
+          }
+
+          return (key < _keys ? key : _keys - 1);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the value written by an operation
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t nextValue (const int threadNumber, const size_t threadCounter) const {
+          return random(threadNumber, threadCounter, SALT_VALUE) % 1000000;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the document key for a key number
+////////////////////////////////////////////////////////////////////////////////
+
+        static std::string keyName (uint64_t key) {
+          return "testkey" + triagens::basics::StringUtils::itoa(key);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replaces {collection}, {key} and {value} in a template
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string substitute (std::string const& value, const int threadNumber, const size_t threadCounter) const {
+          namespace StringUtils = triagens::basics::StringUtils;
+
+          std::string result = StringUtils::replace(value, "{collection}", _collection);
+
+          if (result.find("{key}") != std::string::npos) {
+            result = StringUtils::replace(result, "{key}", keyName(nextKey(threadNumber, threadCounter)));
+          }
+
+          if (result.find("{value}") != std::string::npos) {
+            result = StringUtils::replace(result, "{value}", StringUtils::itoa(nextValue(threadNumber, threadCounter)));
+          }
+
+          return result;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends a document of the configured size, with a key if given
+////////////////////////////////////////////////////////////////////////////////
+
+        void appendDocument (TRI_string_buffer_t* buffer,
+                             uint64_t const* key,
+                             const int threadNumber,
+                             const size_t threadCounter,
+                             uint64_t value) const {
+          size_t size = _minSize;
+
+          if (_maxSize > _minSize) {
+            size += static_cast<size_t>(random(threadNumber, threadCounter, SALT_SIZE) % (_maxSize - _minSize + 1));
+          }
+
+          TRI_AppendCharStringBuffer(buffer, '{');
+
+          if (key != nullptr) {
+            TRI_AppendStringStringBuffer(buffer, "\"_key\":\"");
+            TRI_AppendStringStringBuffer(buffer, keyName(*key).c_str());
+            TRI_AppendStringStringBuffer(buffer, "\",");
+          }
+
+          TRI_AppendStringStringBuffer(buffer, "\"value\":");
+          TRI_AppendUInt64StringBuffer(buffer, value);
+          TRI_AppendStringStringBuffer(buffer, ",\"payload\":\"");
+
+          for (size_t i = 0;  i < size;  ++i) {
+            TRI_AppendCharStringBuffer(buffer, 'x');
+          }
+
+          TRI_AppendStringStringBuffer(buffer, "\"}");
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sends a request, returns true if the server replied with 2xx
+////////////////////////////////////////////////////////////////////////////////
+
+        static bool sendRequest (httpclient::SimpleHttpClient* client,
+                                 rest::HttpRequest::HttpRequestType type,
+                                 std::string const& url,
+                                 std::string const& body) {
+          std::map<std::string, std::string> headerFields;
+          httpclient::SimpleHttpResult* result = client->request(type,
+                                                                 url,
+                                                                 body.c_str(),
+                                                                 body.size(),
+                                                                 headerFields);
+
+          bool ok = false;
+
+          if (result != nullptr) {
+            int statusCode = result->getHttpReturnCode();
+            ok = (statusCode >= 200 && statusCode < 300);
+
+            delete result;
+          }
+
+          return ok;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief collection used by the operations
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _collection;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of keys in the key space
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _keys;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief distribution of the keys
+////////////////////////////////////////////////////////////////////////////////
+
+        DistributionType _keyDistribution;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skew and precomputed constants of the zipfian distribution
+////////////////////////////////////////////////////////////////////////////////
+
+        double _theta;
+        double _zetan;
+        double _alpha;
+        double _eta;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief share of the hot keys and probability to pick one of them
+////////////////////////////////////////////////////////////////////////////////
+
+        double _hotFraction;
+        double _hotProbability;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief minimum and maximum size of the document payloads (in bytes)
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t _minSize;
+        size_t _maxSize;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of operations to execute before measuring
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _warmup;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief seed for all random decisions
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _seed;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether to (re-)create the collection and the key space
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _prepare;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the operations
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<Operation> _operations;
+    };
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
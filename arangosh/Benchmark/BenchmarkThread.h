@@ -41,6 +41,7 @@
 #include "Rest/HttpResponse.h"
 #include "SimpleHttpClient/SimpleHttpClient.h"
 #include "SimpleHttpClient/GeneralClientConnection.h"
+#include "Statistics/histogram.h"
 #include "Benchmark/BenchmarkCounter.h"
 #include "Benchmark/BenchmarkOperation.h"
 
@@ -69,6 +70,7 @@ namespace triagens {
                          int threadNumber,
                          const unsigned long batchSize,
                          BenchmarkCounter<unsigned long>* operationsCounter,
+                         BenchmarkCounter<unsigned long>* warmupCounter,
                          rest::Endpoint* endpoint,
                          const std::string& databaseName,
                          const std::string& username,
@@ -78,6 +80,7 @@ namespace triagens {
                          uint32_t sslProtocol,
                          bool keepAlive,
                          bool async,
+                         double rate,
                          bool verbose)
           : Thread("arangob"),
             _operation(operation),
@@ -87,6 +90,8 @@ namespace triagens {
             _batchSize(batchSize),
             _warningCount(0),
             _operationsCounter(operationsCounter),
+            _warmupCounter(warmupCounter),
+            _warmingUp(false),
             _endpoint(endpoint),
             _headers(),
             _databaseName(databaseName),
@@ -97,14 +102,26 @@ namespace triagens {
             _sslProtocol(sslProtocol),
             _keepAlive(keepAlive),
             _async(async),
+            _rate(rate),
             _client(0),
             _connection(0),
             _offset(0),
             _counter(0),
             _time(0.0),
+            _startTime(0.0),
+            _scheduled(0),
+            _latencies(),
+            _serviceTimes(),
             _verbose(verbose) {
 
           _errorHeader = StringUtils::tolower(rest::HttpResponse::getBatchErrorHeader());
+
+          size_t const n = _operation->operationClasses().size();
+
+          for (size_t i = 0;  i < n;  ++i) {
+            _classLatencies.emplace_back(new basics::StatisticsHistogram());
+            _classFailures.emplace_back(0);
+          }
         }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -119,6 +136,10 @@ namespace triagens {
           if (_connection != 0) {
             delete _connection;
           }
+
+          for (auto histogram : _classLatencies) {
+            delete histogram;
+          }
         }
 
 // -----------------------------------------------------------------------------
@@ -185,6 +206,12 @@ namespace triagens {
             guard.wait();
           }
 
+          if (_warmupCounter != nullptr) {
+            warmup();
+          }
+
+          _startTime = TRI_microtime();
+
           while (1) {
             unsigned long numOps = _operationsCounter->next(_batchSize);
 
@@ -245,6 +272,91 @@ namespace triagens {
           }
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the warmup operations and waits until all threads are done
+/// with them
+///
+/// Warmup operations are not recorded, and their failures are counted in the
+/// warmup counter.
+////////////////////////////////////////////////////////////////////////////////
+
+        void warmup () {
+          _warmingUp = true;
+
+          while (_warmupCounter->next(1) > 0) {
+            executeSingleRequest();
+            _warmupCounter->done(1);
+          }
+
+          _warmingUp = false;
+
+          while (_warmupCounter->getDone() < _warmupCounter->getValue()) {
+            usleep(1000);
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief waits until the next request is due, returns the time at which it
+/// should be sent or 0 if the thread sends as fast as it can
+///
+/// In open-loop mode the requests of a thread are scheduled at fixed times,
+/// independent of how long the server takes to answer. A thread that falls
+/// behind sends immediately, but the latency of the request is still measured
+/// from its scheduled time, so a stalling server is not hidden by the client
+/// sending fewer requests (coordinated omission).
+////////////////////////////////////////////////////////////////////////////////
+
+        double waitForSchedule (unsigned long numOperations) {
+          if (_rate <= 0.0) {
+            return 0.0;
+          }
+
+          double const intended = _startTime + static_cast<double>(_scheduled) / _rate;
+          _scheduled += numOperations;
+
+          double const now = TRI_microtime();
+
+          if (intended > now) {
+            usleep(static_cast<unsigned long>((intended - now) * 1000000.0));
+          }
+
+          return intended;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief records the duration of a request
+////////////////////////////////////////////////////////////////////////////////
+
+        void recordTime (double intended, double start, double end, size_t operationClass) {
+          if (_warmingUp) {
+            return;
+          }
+
+          double const latency = end - (intended > 0.0 ? intended : start);
+
+          _time += end - start;
+          _serviceTimes.addFigure(end - start);
+          _latencies.addFigure(latency);
+
+          if (operationClass < _classLatencies.size()) {
+            _classLatencies[operationClass]->addFigure(latency);
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief counts failed operations
+////////////////////////////////////////////////////////////////////////////////
+
+        void recordFailures (size_t count, size_t operationClass) {
+          BenchmarkCounter<unsigned long>* counter = (_warmingUp ? _warmupCounter : _operationsCounter);
+
+          counter->incFailures(count);
+
+          if (! _warmingUp && operationClass < _classFailures.size()) {
+            _classFailures[operationClass] += count;
+          }
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief execute a batch request with numOperations parts
 ////////////////////////////////////////////////////////////////////////////////
@@ -311,13 +423,15 @@ namespace triagens {
           _headers["Content-Type"] = rest::HttpRequest::MultiPartContentType +
                                      "; boundary=" + boundary;
 
-          double start = TRI_microtime();
+          double const intended = waitForSchedule(numOperations);
+          double const start = TRI_microtime();
           httpclient::SimpleHttpResult* result = _client->request(rest::HttpRequest::HTTP_REQUEST_POST,
                                                       "/_api/batch",
                                                       batchPayload.c_str(),
                                                       batchPayload.length(),
                                                       _headers);
-          _time += TRI_microtime() - start;
+          // the parts of a batch may belong to different operation classes
+          recordTime(intended, start, TRI_microtime(), SIZE_MAX);
 
           if (result == nullptr || ! result->isComplete()) {
             if (result != nullptr){
@@ -391,23 +505,25 @@ namespace triagens {
 
           // std::cout << "thread number #" << _threadNumber << ", threadCounter " << threadCounter << ", globalCounter " << globalCounter << "\n";
           const char* payload = _operation->payload(&payloadLength, _threadNumber, threadCounter, globalCounter, &mustFree);
+          const size_t operationClass = _operation->operationClass(_threadNumber, threadCounter, globalCounter);
 
-          double start = TRI_microtime();
+          double const intended = (_warmingUp ? 0.0 : waitForSchedule(1));
+          double const start = TRI_microtime();
           httpclient::SimpleHttpResult* result = _client->request(type,
                                                       url,
                                                       payload,
                                                       payloadLength,
                                                       _headers);
-          _time += TRI_microtime() - start;
+          recordTime(intended, start, TRI_microtime(), operationClass);
 
           if (mustFree) {
             TRI_Free(TRI_UNKNOWN_MEM_ZONE, (void*) payload);
           }
 
           if (result == nullptr || ! result->isComplete()) {
-            _operationsCounter->incFailures(1);
+            recordFailures(1, operationClass);
             if (result != nullptr) {
-              _operationsCounter->incIncompleteFailures(1);
+              (_warmingUp ? _warmupCounter : _operationsCounter)->incIncompleteFailures(1);
               delete result;
             }
             _warningCount++;
@@ -418,7 +534,7 @@ namespace triagens {
           }
 
           if (result->wasHttpError()) {
-            _operationsCounter->incFailures(1);
+            recordFailures(1, operationClass);
 
             _warningCount++;
             if (_warningCount < MaxWarnings) {
@@ -453,6 +569,39 @@ namespace triagens {
           return _time;
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the latencies of the requests, measured from the scheduled
+/// send time in open-loop mode
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram const& latencies () const {
+          return _latencies;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the request/response durations of the requests
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram const& serviceTimes () const {
+          return _serviceTimes;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the latencies of an operation class
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram const& classLatencies (size_t operationClass) const {
+          return *_classLatencies[operationClass];
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of failed operations of an operation class
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t classFailures (size_t operationClass) const {
+          return _classFailures[operationClass];
+        }
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private variables
 // -----------------------------------------------------------------------------
@@ -501,6 +650,18 @@ namespace triagens {
 
         BenchmarkCounter<unsigned long>* _operationsCounter;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief counter for the warmup operations, may be a nullptr
+////////////////////////////////////////////////////////////////////////////////
+
+        BenchmarkCounter<unsigned long>* _warmupCounter;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the thread executes warmup operations
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _warmingUp;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief endpoint to use
 ////////////////////////////////////////////////////////////////////////////////
@@ -561,6 +722,12 @@ namespace triagens {
 
         bool _async;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief requests per second sent by this thread (0 = as fast as possible)
+////////////////////////////////////////////////////////////////////////////////
+
+        double const _rate;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief underlying client
 ////////////////////////////////////////////////////////////////////////////////
@@ -591,6 +758,43 @@ namespace triagens {
 
         double _time;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief time at which the thread started sending
+////////////////////////////////////////////////////////////////////////////////
+
+        double _startTime;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of operations scheduled so far in open-loop mode
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _scheduled;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief request latencies
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram _latencies;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief request/response durations
+////////////////////////////////////////////////////////////////////////////////
+
+        basics::StatisticsHistogram _serviceTimes;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief latencies per operation class
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<basics::StatisticsHistogram*> _classLatencies;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief failed operations per operation class, read after the thread is
+/// joined
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<uint64_t> _classFailures;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief lower-case error header we look for
 ////////////////////////////////////////////////////////////////////////////////
@@ -29,7 +29,11 @@
 
 #include "Basics/Common.h"
 
+#include <iomanip>
+
 #include "ArangoShell/ArangoClient.h"
+#include "Basics/FileUtils.h"
+#include "Basics/JsonHelper.h"
 #include "Basics/Mutex.h"
 #include "Basics/MutexLocker.h"
 #include "Basics/ProgramOptions.h"
@@ -46,8 +50,10 @@
 #include "Rest/InitialiseRest.h"
 #include "SimpleHttpClient/SimpleHttpClient.h"
 #include "SimpleHttpClient/SimpleHttpResult.h"
+#include "Statistics/histogram.h"
 #include "Benchmark/BenchmarkCounter.h"
 #include "Benchmark/BenchmarkOperation.h"
+#include "Benchmark/BenchmarkScenario.h"
 #include "Benchmark/BenchmarkThread.h"
 
 using namespace std;
@@ -127,12 +133,43 @@ static bool KeepAlive = true;
 
 static int Operations = 1000;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief file to write the results to
+////////////////////////////////////////////////////////////////////////////////
+
+static string OutputFile;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief format of the output file (json or csv)
+////////////////////////////////////////////////////////////////////////////////
+
+static string OutputFormat = "json";
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief display progress
 ////////////////////////////////////////////////////////////////////////////////
 
 static bool Progress = true;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief scenario file to use instead of a test case
+////////////////////////////////////////////////////////////////////////////////
+
+static string ScenarioFile;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief operations per second sent by all threads together (0 = as fast
+/// as possible)
+////////////////////////////////////////////////////////////////////////////////
+
+static double Rate = 0.0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief seconds between two interval reports (0 = no interval reports)
+////////////////////////////////////////////////////////////////////////////////
+
+static double ReportInterval = 0.0;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test case to use
 ////////////////////////////////////////////////////////////////////////////////
@@ -151,6 +188,30 @@ static bool verbose = false;
 
 #include "Benchmark/test-cases.h"
 
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the results of one reporting interval
+////////////////////////////////////////////////////////////////////////////////
+
+struct IntervalReport {
+  double _start;
+  double _end;
+  size_t _failures;
+  StatisticsHistogramSnapshot _latencies;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the results of one operation class
+////////////////////////////////////////////////////////////////////////////////
+
+struct ClassReport {
+  string _name;
+  uint64_t _failures;
+  StatisticsHistogramSnapshot _latencies;
+};
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                 private functions
@@ -183,6 +244,245 @@ static void Status (const string& value) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief merges the latencies of all threads
+////////////////////////////////////////////////////////////////////////////////
+
+static StatisticsHistogramSnapshot MergeLatencies (vector<BenchmarkThread*> const& threads,
+                                                   bool serviceTimes) {
+  StatisticsHistogramSnapshot result;
+
+  for (auto thread : threads) {
+    if (serviceTimes) {
+      result.merge(thread->serviceTimes().snapshot());
+    }
+    else {
+      result.merge(thread->latencies().snapshot());
+    }
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the values recorded between two snapshots
+///
+/// The exact extremes of an interval are unknown, they are estimated from the
+/// buckets of the first and last values in the interval.
+////////////////////////////////////////////////////////////////////////////////
+
+static StatisticsHistogramSnapshot IntervalLatencies (StatisticsHistogramSnapshot const& current,
+                                                      StatisticsHistogramSnapshot const& previous) {
+  StatisticsHistogramSnapshot result;
+
+  result._count = current._count - previous._count;
+  result._total = current._total - previous._total;
+
+  bool first = true;
+
+  for (size_t i = 0;  i < result._counts.size();  ++i) {
+    result._counts[i] = current._counts[i] - previous._counts[i];
+
+    if (result._counts[i] == 0) {
+      continue;
+    }
+
+    if (first) {
+      result._min = (std::max)(StatisticsHistogram::bucketLowerBound(i), current._min);
+      first = false;
+    }
+
+    result._max = (std::min)(StatisticsHistogram::bucketUpperBound(i), current._max);
+  }
+
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts microseconds into milliseconds
+////////////////////////////////////////////////////////////////////////////////
+
+static double Millis (uint64_t value) {
+  return static_cast<double>(value) / 1000.0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prints the percentiles of a snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+static void PrintLatencies (string const& title,
+                            StatisticsHistogramSnapshot const& latencies) {
+  streamsize precision = cout.precision();
+
+  cout << title << " (ms): " <<
+          "mean " << fixed << setprecision(3) << (latencies.mean() / 1000.0) <<
+          ", p50 " << Millis(latencies.percentile(0.5)) <<
+          ", p90 " << Millis(latencies.percentile(0.9)) <<
+          ", p99 " << Millis(latencies.percentile(0.99)) <<
+          ", p99.9 " << Millis(latencies.percentile(0.999)) <<
+          ", max " << Millis(latencies._max) <<
+          endl;
+
+  cout.precision(precision);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prints an interval report
+////////////////////////////////////////////////////////////////////////////////
+
+static void PrintInterval (IntervalReport const& interval) {
+  double const duration = interval._end - interval._start;
+  streamsize precision = cout.precision();
+
+  cout << fixed << setprecision(3) <<
+          "[" << interval._start << " - " << interval._end << " s] " <<
+          interval._latencies._count << " requests, " <<
+          (duration > 0.0 ? interval._latencies._count / duration : 0.0) << " requests/s, " <<
+          interval._failures << " failures" <<
+          endl;
+
+  cout.precision(precision);
+
+  PrintLatencies("  latency", interval._latencies);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief converts the percentiles of a snapshot into JSON
+////////////////////////////////////////////////////////////////////////////////
+
+static Json LatenciesToJson (StatisticsHistogramSnapshot const& latencies) {
+  Json json(Json::Object, 8);
+
+  json.set("count", Json(static_cast<double>(latencies._count)));
+  json.set("mean",  Json(latencies.mean() / 1000.0));
+  json.set("min",   Json(Millis(latencies._min)));
+  json.set("p50",   Json(Millis(latencies.percentile(0.5))));
+  json.set("p90",   Json(Millis(latencies.percentile(0.9))));
+  json.set("p99",   Json(Millis(latencies.percentile(0.99))));
+  json.set("p99.9", Json(Millis(latencies.percentile(0.999))));
+  json.set("max",   Json(Millis(latencies._max)));
+
+  return json;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief appends a CSV line
+////////////////////////////////////////////////////////////////////////////////
+
+static void AppendCsv (ostringstream& out,
+                       string const& name,
+                       double start,
+                       double end,
+                       size_t failures,
+                       StatisticsHistogramSnapshot const& latencies) {
+  double const duration = end - start;
+
+  out << name << "," <<
+         fixed << setprecision(3) <<
+         start << "," <<
+         end << "," <<
+         latencies._count << "," <<
+         failures << "," <<
+         (duration > 0.0 ? latencies._count / duration : 0.0) << "," <<
+         (latencies.mean() / 1000.0) << "," <<
+         Millis(latencies._min) << "," <<
+         Millis(latencies.percentile(0.5)) << "," <<
+         Millis(latencies.percentile(0.9)) << "," <<
+         Millis(latencies.percentile(0.99)) << "," <<
+         Millis(latencies.percentile(0.999)) << "," <<
+         Millis(latencies._max) << "\n";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief writes the results into the output file
+////////////////////////////////////////////////////////////////////////////////
+
+static void WriteResults (double time,
+                          size_t failures,
+                          size_t incomplete,
+                          StatisticsHistogramSnapshot const& latencies,
+                          StatisticsHistogramSnapshot const& serviceTimes,
+                          vector<IntervalReport> const& intervals,
+                          vector<ClassReport> const& classes) {
+  string content;
+
+  if (OutputFormat == "csv") {
+    ostringstream out;
+
+    out << "interval,start,end,requests,failures,requests_per_second,"
+           "mean,min,p50,p90,p99,p99.9,max\n";
+
+    for (size_t i = 0;  i < intervals.size();  ++i) {
+      IntervalReport const& interval = intervals[i];
+
+      AppendCsv(out, StringUtils::itoa(static_cast<uint64_t>(i + 1)), interval._start, interval._end, interval._failures, interval._latencies);
+    }
+
+    for (auto const& report : classes) {
+      AppendCsv(out, "class:" + report._name, 0.0, time, report._failures, report._latencies);
+    }
+
+    AppendCsv(out, "total", 0.0, time, failures, latencies);
+    content = out.str();
+  }
+  else {
+    Json json(Json::Object, 16);
+
+    json.set("testCase",           Json(TestCase));
+    json.set("complexity",         Json(static_cast<double>(Complexity)));
+    json.set("collection",         Json(Collection));
+    json.set("concurrency",        Json(static_cast<double>(Concurrency)));
+    json.set("batchSize",          Json(static_cast<double>(BatchSize)));
+    json.set("keepAlive",          Json(KeepAlive));
+    json.set("async",              Json(Async));
+    json.set("rate",               Json(Rate));
+    json.set("operations",         Json(static_cast<double>(Operations)));
+    json.set("failures",           Json(static_cast<double>(failures)));
+    json.set("incompleteFailures", Json(static_cast<double>(incomplete)));
+    json.set("time",               Json(time));
+    json.set("operationsPerSecond", Json(static_cast<double>(Operations) / time));
+    json.set("latency",            LatenciesToJson(latencies));
+    json.set("serviceTime",        LatenciesToJson(serviceTimes));
+
+    Json list(Json::Array, intervals.size());
+
+    for (auto const& interval : intervals) {
+      Json entry(Json::Object, 4);
+
+      entry.set("start",    Json(interval._start));
+      entry.set("end",      Json(interval._end));
+      entry.set("failures", Json(static_cast<double>(interval._failures)));
+      entry.set("latency",  LatenciesToJson(interval._latencies));
+
+      list.add(entry);
+    }
+
+    json.set("intervals", list);
+
+    Json classList(Json::Array, classes.size());
+
+    for (auto const& report : classes) {
+      Json entry(Json::Object, 3);
+
+      entry.set("name",     Json(report._name));
+      entry.set("failures", Json(static_cast<double>(report._failures)));
+      entry.set("latency",  LatenciesToJson(report._latencies));
+
+      classList.add(entry);
+    }
+
+    json.set("operationClasses", classList);
+    content = json.toString() + "\n";
+  }
+
+  try {
+    FileUtils::spit(OutputFile, content);
+  }
+  catch (...) {
+    LOG_ERROR("cannot write results to '%s'", OutputFile.c_str());
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief parses the program options
 ////////////////////////////////////////////////////////////////////////////////
@@ -201,6 +501,11 @@ static void ParseProgramOptions (int argc, char* argv[]) {
     ("complexity", &Complexity, "complexity parameter for the test")
     ("delay", &Delay, "use a startup delay (necessary only when run in series)")
     ("progress", &Progress, "show progress")
+    ("scenario", &ScenarioFile, "run the workload described in this JSON file instead of a test case")
+    ("rate", &Rate, "send this many operations per second in total, independent of the server's response times (0 sends as fast as possible)")
+    ("report-interval", &ReportInterval, "report throughput and latencies every this many seconds (0 disables interval reports)")
+    ("output-file", &OutputFile, "write the results to this file")
+    ("output-format", &OutputFormat, "format of the output file (possible values: json, csv)")
     ("verbose", &verbose, "print out replies if the http-header indicates db-errors")
   ;
 
@@ -317,16 +622,43 @@ int main (int argc, char* argv[]) {
     LOG_FATAL_AND_EXIT("invalid value for --server.endpoint ('%s')", BaseClient.endpointString().c_str());
   }
 
-  BenchmarkOperation* testCase = GetTestCase(TestCase);
+  if (OutputFormat != "json" && OutputFormat != "csv") {
+    LOG_FATAL_AND_EXIT("invalid value for --output-format ('%s')", OutputFormat.c_str());
+  }
+
+  if (Rate < 0.0) {
+    LOG_FATAL_AND_EXIT("invalid value for --rate (%f)", Rate);
+  }
+
+  BenchmarkOperation* testCase = nullptr;
+
+  if (! ScenarioFile.empty()) {
+    string error;
+    BenchmarkScenario* scenario = BenchmarkScenario::load(ScenarioFile, Collection, error);
+
+    if (scenario == nullptr) {
+      LOG_FATAL_AND_EXIT("%s", error.c_str());
+    }
+
+    TestCase = "scenario '" + ScenarioFile + "'";
+    Collection = scenario->collection();
+    testCase = scenario;
+  }
+  else {
+    testCase = GetTestCase(TestCase);
 
-  if (testCase == nullptr) {
-    LOG_FATAL_AND_EXIT("invalid test case name '%s'", TestCase.c_str());
-    return EXIT_FAILURE; // will not be reached
+    if (testCase == nullptr) {
+      LOG_FATAL_AND_EXIT("invalid test case name '%s'", TestCase.c_str());
+      return EXIT_FAILURE; // will not be reached
+    }
   }
 
   Status("starting threads...");
 
   BenchmarkCounter<unsigned long> operationsCounter(0, (unsigned long) Operations);
+
+  const size_t warmup = testCase->warmupOperations();
+  BenchmarkCounter<unsigned long> warmupCounter(0, (unsigned long) warmup);
   ConditionVariable startCondition;
 
 
@@ -355,6 +687,7 @@ int main (int argc, char* argv[]) {
         i,
         (unsigned long) BatchSize,
         &operationsCounter,
+        (warmup > 0 ? &warmupCounter : nullptr),
         endpoint,
         BaseClient.databaseName(),
         BaseClient.username(),
@@ -364,6 +697,7 @@ int main (int argc, char* argv[]) {
         BaseClient.sslProtocol(),
         KeepAlive,
         Async,
+        Rate / (double) Concurrency,
         verbose);
 
     threads.push_back(thread);
@@ -391,6 +725,20 @@ int main (int argc, char* argv[]) {
     guard.broadcast();
   }
 
+  if (warmup > 0) {
+    Status("warming up...");
+
+    while (warmupCounter.getDone() < warmup) {
+      usleep(5000);
+    }
+
+    if (warmupCounter.failures() > 0) {
+      cerr << "WARNING: " << warmupCounter.failures() << " arangob warmup request(s) failed!!" << endl;
+    }
+
+    start = TRI_microtime();
+  }
+
   const size_t stepValue = (Operations / 20);
   size_t nextReportValue = stepValue;
 
@@ -398,6 +746,29 @@ int main (int argc, char* argv[]) {
     nextReportValue = 100;
   }
 
+  vector<IntervalReport> intervals;
+  StatisticsHistogramSnapshot previousLatencies;
+  size_t previousFailures = 0;
+  double intervalStart = start;
+
+  auto reportInterval = [&] (double now) -> void {
+    IntervalReport interval;
+    StatisticsHistogramSnapshot latencies = MergeLatencies(threads, false);
+    size_t failures = operationsCounter.failures();
+
+    interval._start = intervalStart - start;
+    interval._end = now - start;
+    interval._failures = failures - previousFailures;
+    interval._latencies = IntervalLatencies(latencies, previousLatencies);
+
+    PrintInterval(interval);
+    intervals.emplace_back(std::move(interval));
+
+    previousLatencies = std::move(latencies);
+    previousFailures = failures;
+    intervalStart = now;
+  };
+
   while (1) {
     const size_t numOperations = operationsCounter.getDone();
 
@@ -405,7 +776,14 @@ int main (int argc, char* argv[]) {
       break;
     }
 
-    if (Progress && numOperations >= nextReportValue) {
+    if (ReportInterval > 0.0) {
+      double now = TRI_microtime();
+
+      if (now - intervalStart >= ReportInterval) {
+        reportInterval(now);
+      }
+    }
+    else if (Progress && numOperations >= nextReportValue) {
       LOG_INFO("number of operations: %d", (int) nextReportValue);
       nextReportValue += stepValue;
     }
@@ -413,7 +791,16 @@ int main (int argc, char* argv[]) {
     usleep(20000);
   }
 
-  double time = TRI_microtime() - start;
+  double now = TRI_microtime();
+  double time = now - start;
+
+  if (ReportInterval > 0.0) {
+    reportInterval(now);
+  }
+
+  for (int i = 0; i < Concurrency; ++i) {
+    threads[i]->join();
+  }
   double requestTime = 0.0;
 
   for (int i = 0; i < Concurrency; ++i) {
@@ -431,6 +818,10 @@ int main (int argc, char* argv[]) {
           ", concurrency level (threads): " << Concurrency <<
           endl;
 
+  if (Rate > 0.0) {
+    cout << "Target rate: " << fixed << Rate << " operations per second (open loop)" << endl;
+  }
+
   cout << "Test case: " << TestCase <<
           ", complexity: " << Complexity <<
           ", database: '" << BaseClient.databaseName() <<
@@ -442,7 +833,45 @@ int main (int argc, char* argv[]) {
   cout << "Time needed per operation: " << fixed << (time / Operations) << " s" << endl;
   cout << "Time needed per operation per thread: " << fixed << (time / (double) Operations * (double) Concurrency) << " s" << endl;
   cout << "Operations per second rate: " << fixed << ((double) Operations / time) << endl;
-  cout << "Elapsed time since start: " << fixed << time << " s" << endl << endl;
+  cout << "Elapsed time since start: " << fixed << time << " s" << endl;
+
+  StatisticsHistogramSnapshot latencies = MergeLatencies(threads, false);
+  StatisticsHistogramSnapshot serviceTimes = MergeLatencies(threads, true);
+
+  PrintLatencies("Request latency", latencies);
+
+  if (Rate > 0.0) {
+    PrintLatencies("Request/response duration", serviceTimes);
+  }
+
+  vector<ClassReport> classes;
+  vector<string> const classNames = testCase->operationClasses();
+
+  for (size_t i = 0; i < classNames.size(); ++i) {
+    ClassReport report;
+
+    report._name = classNames[i];
+    report._failures = 0;
+
+    for (auto thread : threads) {
+      report._latencies.merge(thread->classLatencies(i).snapshot());
+      report._failures += thread->classFailures(i);
+    }
+
+    cout << "Operation class '" << report._name << "': " <<
+            report._latencies._count << " requests, " <<
+            report._failures << " failures" <<
+            endl;
+    PrintLatencies("  latency", report._latencies);
+
+    classes.emplace_back(std::move(report));
+  }
+
+  cout << endl;
+
+  if (! OutputFile.empty()) {
+    WriteResults(time, failures, incomplete, latencies, serviceTimes, intervals, classes);
+  }
 
   if (failures > 0) {
     cerr << "WARNING: " << failures << " arangob request(s) failed!!" << endl;
@@ -454,7 +883,6 @@ int main (int argc, char* argv[]) {
   testCase->tearDown();
 
   for (int i = 0; i < Concurrency; ++i) {
-    threads[i]->join();
     delete threads[i];
     delete endpoints[i];
   }
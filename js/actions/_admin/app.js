@@ -190,6 +190,31 @@ actions.defineHttp({
 /// *count* and the distribution list in *counts*. The sum (or total) of the
 /// individual values is returned in *sum*.
 ///
+/// The attribute *latency* contains high resolution histograms of the queue,
+/// request and I/O time of finished requests. Its sub-attribute *endpoints*
+/// lists one entry per database and handler path (*database*, *path*), its
+/// sub-attribute *queues* one entry per dispatcher queue (*name*). Each entry
+/// has the attributes *queueTime*, *requestTime* and *ioTime*, each of which
+/// contains *count*, *sum*, *mean*, *min*, *max* and the percentiles *p50*,
+/// *p90*, *p99* and *p999*, all in seconds. The percentiles are accurate to
+/// about 3 %. Once 128 endpoints are known, all further ones are counted in a
+/// single entry with the *path* "*".
+///
+/// The attribute *v8Contexts* describes the V8 contexts executing JavaScript
+/// actions: the number of existing contexts (*available*), of contexts in use
+/// (*busy*), waiting for the garbage collection (*dirty*) and unused (*free*),
+/// the configured minimum and maximum number of contexts (*min*, *max*), the
+/// number of contexts created and removed on demand (*created*, *removed*) and
+/// the number of requests that gave up waiting for a context (*timeouts*). Its
+/// sub-attributes *waitTime* and *gcTime* are histograms of the time requests
+/// waited for a context and of the durations of the garbage collections, with
+/// the same attributes as the *latency* histograms. The sub-attribute *codeCache*
+/// describes the cache for the compiled code of the JavaScript files: whether
+/// it is turned on (*enabled*), the number of cached files (*entries*), the
+/// size of their code in bytes (*memory*), the number of compilations using
+/// the cached code (*hits*) or not (*misses*), and the number of times V8
+/// refused the cached code (*rejected*).
+///
 /// @RESTRETURNCODES
 ///
 /// @RESTRETURNCODE{200}
@@ -222,6 +247,8 @@ actions.defineHttp({
       result.client = internal.clientStatistics();
       result.http = internal.httpStatistics();
       result.server = internal.serverStatistics();
+      result.latency = internal.latencyStatistics();
+      result.v8Contexts = internal.v8ContextStatistics();
 
       actions.resultOk(req, res, actions.HTTP_OK, result);
     }
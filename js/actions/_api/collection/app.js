@@ -627,12 +627,18 @@ function get_api_collections (req, res) {
 ///
 /// - *figures.datafiles.count*: The number of datafiles.
 /// - *figures.datafiles.fileSize*: The total filesize of datafiles (in bytes).
+/// - *figures.datafiles.residentSize*: The number of bytes of the datafiles that
+///   are currently in memory. Reading other parts of the datafiles requires disk I/O.
 ///
 /// - *figures.journals.count*: The number of journal files.
 /// - *figures.journals.fileSize*: The total filesize of all journal files (in bytes).
+/// - *figures.journals.residentSize*: The number of bytes of the journal files that
+///   are currently in memory.
 ///
 /// - *figures.compactors.count*: The number of compactor files.
 /// - *figures.compactors.fileSize*: The total filesize of all compactor files (in bytes).
+/// - *figures.compactors.residentSize*: The number of bytes of the compactor files
+///   that are currently in memory.
 ///
 /// * *figures.shapefiles.count*: The number of shape files. This value is
 ///   deprecated and kept for compatibility reasons only. The value will always
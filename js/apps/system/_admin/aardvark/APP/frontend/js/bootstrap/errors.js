@@ -38,6 +38,7 @@
     "ERROR_IP_ADDRESS_INVALID"     : { "code" : 25, "message" : "IP address is invalid" },
     "ERROR_LEGEND_NOT_IN_WAL_FILE" : { "code" : 26, "message" : "internal error if a legend for a marker does not yet exist in the same WAL file" },
     "ERROR_FILE_EXISTS"            : { "code" : 27, "message" : "file exists" },
+    "ERROR_V8_CONTEXT_TIMEOUT"     : { "code" : 28, "message" : "timeout waiting for a V8 context" },
     "ERROR_HTTP_BAD_PARAMETER"     : { "code" : 400, "message" : "bad parameter" },
     "ERROR_HTTP_UNAUTHORIZED"      : { "code" : 401, "message" : "unauthorized" },
     "ERROR_HTTP_FORBIDDEN"         : { "code" : 403, "message" : "forbidden" },
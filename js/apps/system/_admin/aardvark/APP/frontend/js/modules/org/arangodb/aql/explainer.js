@@ -419,7 +419,7 @@ function processQuery (query, explain) {
         return keyword("EMPTY") + "   " + annotation("/* empty result set */");
       case "EnumerateCollectionNode":
         collectionVariables[node.outVariable.id] = node.collection;
-        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* full collection scan" + (node.random ? ", random order" : "") + " */");
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + (node.filter ? " " + keyword("FILTER") + " " + buildExpression(node.filter) : "") + "   " + annotation("/* full collection scan" + (node.random ? ", random order" : "") + (node.filter ? ", parallel filter" : "") + " */");
       case "EnumerateListNode":
         return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + variableName(node.inVariable) + "   " + annotation("/* list iteration */");
       case "IndexRangeNode":
@@ -429,7 +429,16 @@ function processQuery (query, explain) {
         index.collection = node.collection;
         index.node = node.id;
         indexes.push(index);
-        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* " + (node.reverse ? "reverse " : "") + node.index.type + " index scan") + annotation("*/");
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* " + (node.reverse ? "reverse " : "") + node.index.type + " index scan" + (node.indexOnly ? ", index only" : "")) + annotation("*/");
+      case "GeoIndexNode":
+        collectionVariables[node.outVariable.id] = node.collection;
+        var geoIndex = node.index;
+        geoIndex.ranges = "DISTANCE(" + [ node.latitude, node.longitude ].map(function (v) { return value(JSON.stringify(v)); }).join(", ") + ")" +
+                          (node.hasOwnProperty("radius") ? " <= " + value(JSON.stringify(node.radius)) : "");
+        geoIndex.collection = node.collection;
+        geoIndex.node = node.id;
+        indexes.push(geoIndex);
+        return keyword("FOR") + " " + variableName(node.outVariable) + " " + keyword("IN") + " " + collection(node.collection) + "   " + annotation("/* geo index scan, by distance */");
       case "CalculationNode":
         return keyword("LET") + " " + variableName(node.outVariable) + " = " + buildExpression(node.expression);
       case "FilterNode":
@@ -503,6 +512,7 @@ function processQuery (query, explain) {
     if ([ "EnumerateCollectionNode",
           "EnumerateListNode",
           "IndexRangeNode",
+          "GeoIndexNode",
           "SubqueryNode" ].indexOf(node.type) !== -1) {
       level++;
     }
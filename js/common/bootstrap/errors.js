@@ -38,6 +38,7 @@
     "ERROR_IP_ADDRESS_INVALID"     : { "code" : 25, "message" : "IP address is invalid" },
     "ERROR_LEGEND_NOT_IN_WAL_FILE" : { "code" : 26, "message" : "internal error if a legend for a marker does not yet exist in the same WAL file" },
     "ERROR_FILE_EXISTS"            : { "code" : 27, "message" : "file exists" },
+    "ERROR_V8_CONTEXT_TIMEOUT"     : { "code" : 28, "message" : "timeout waiting for a V8 context" },
     "ERROR_HTTP_BAD_PARAMETER"     : { "code" : 400, "message" : "bad parameter" },
     "ERROR_HTTP_UNAUTHORIZED"      : { "code" : 401, "message" : "unauthorized" },
     "ERROR_HTTP_FORBIDDEN"         : { "code" : 403, "message" : "forbidden" },
@@ -121,6 +122,7 @@
     "ERROR_REPLICATION_RUNNING"    : { "code" : 1411, "message" : "cannot change applier configuration while running" },
     "ERROR_REPLICATION_APPLIER_STOPPED" : { "code" : 1412, "message" : "replication stopped" },
     "ERROR_REPLICATION_NO_START_TICK" : { "code" : 1413, "message" : "no start tick" },
+    "ERROR_REPLICATION_KEYS_SNAPSHOT_NOT_FOUND" : { "code" : 1414, "message" : "keys snapshot not found" },
     "ERROR_CLUSTER_NO_AGENCY"      : { "code" : 1450, "message" : "could not connect to agency" },
     "ERROR_CLUSTER_NO_COORDINATOR_HEADER" : { "code" : 1451, "message" : "missing coordinator header" },
     "ERROR_CLUSTER_COULD_NOT_LOCK_PLAN" : { "code" : 1452, "message" : "could not lock plan in agency" },
@@ -212,6 +214,9 @@
     "ERROR_KEYVALUE_KEY_NOT_CHANGED" : { "code" : 1804, "message" : "key value not changed" },
     "ERROR_KEYVALUE_KEY_NOT_REMOVED" : { "code" : 1805, "message" : "key value not removed" },
     "ERROR_KEYVALUE_NO_VALUE"      : { "code" : 1806, "message" : "missing value" },
+    "ERROR_KEYVALUE_KEYSPACE_NOT_FOUND" : { "code" : 1807, "message" : "keyspace not found" },
+    "ERROR_KEYVALUE_KEYSPACE_EXISTS" : { "code" : 1808, "message" : "keyspace already exists" },
+    "ERROR_KEYVALUE_TYPE_MISMATCH" : { "code" : 1809, "message" : "key value has wrong type" },
     "ERROR_TASK_INVALID_ID"        : { "code" : 1850, "message" : "invalid task id" },
     "ERROR_TASK_DUPLICATE_ID"      : { "code" : 1851, "message" : "duplicate task id" },
     "ERROR_TASK_NOT_FOUND"         : { "code" : 1852, "message" : "task not found" },
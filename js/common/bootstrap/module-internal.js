@@ -654,6 +654,15 @@ if (global.SYS_HTTP_STATISTICS) {
   delete global.SYS_HTTP_STATISTICS;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief latencyStatistics
+////////////////////////////////////////////////////////////////////////////////
+
+if (global.SYS_LATENCY_STATISTICS) {
+  exports.latencyStatistics = global.SYS_LATENCY_STATISTICS;
+  delete global.SYS_LATENCY_STATISTICS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief executeExternal
 ////////////////////////////////////////////////////////////////////////////////
@@ -190,6 +190,15 @@ else {
   };
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief v8ContextStatistics
+////////////////////////////////////////////////////////////////////////////////
+
+if (global.SYS_V8_CONTEXT_STATISTICS) {
+  exports.v8ContextStatistics = global.SYS_V8_CONTEXT_STATISTICS;
+  delete global.SYS_V8_CONTEXT_STATISTICS;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief reloads the AQL user functions
 ////////////////////////////////////////////////////////////////////////////////
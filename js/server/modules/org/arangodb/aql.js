@@ -3804,6 +3804,43 @@ function AQL_IS_IN_POLYGON (points, latitude, longitude) {
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the distance between two points in meters
+///
+/// the distance is calculated in the same way as by the geo index
+////////////////////////////////////////////////////////////////////////////////
+
+function AQL_DISTANCE (latitude1, longitude1, latitude2, longitude2) {
+  'use strict';
+
+  if (TYPEWEIGHT(latitude1) !== TYPEWEIGHT_NUMBER ||
+      TYPEWEIGHT(longitude1) !== TYPEWEIGHT_NUMBER ||
+      TYPEWEIGHT(latitude2) !== TYPEWEIGHT_NUMBER ||
+      TYPEWEIGHT(longitude2) !== TYPEWEIGHT_NUMBER ||
+      latitude1 < -90 || latitude1 > 90 ||
+      latitude2 < -90 || latitude2 > 90 ||
+      longitude1 < -180 || longitude1 > 180 ||
+      longitude2 < -180 || longitude2 > 180) {
+    WARN("DISTANCE", INTERNAL.errors.ERROR_QUERY_FUNCTION_ARGUMENT_TYPE_MISMATCH);
+    return null;
+  }
+
+  var toRadians = Math.PI / 180;
+  var lat1 = latitude1 * toRadians, lon1 = longitude1 * toRadians;
+  var lat2 = latitude2 * toRadians, lon2 = longitude2 * toRadians;
+
+  var dx = Math.cos(lat1) * Math.cos(lon1) - Math.cos(lat2) * Math.cos(lon2);
+  var dy = Math.cos(lat1) * Math.sin(lon1) - Math.cos(lat2) * Math.sin(lon2);
+  var dz = Math.sin(lat1) - Math.sin(lat2);
+  var mole = Math.sqrt(dx * dx + dy * dy + dz * dz);
+
+  if (mole > 2) {
+    mole = 2;
+  }
+
+  return 2 * 6371000 * Math.asin(mole / 2);
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                fulltext functions
 // -----------------------------------------------------------------------------
@@ -8005,6 +8042,7 @@ exports.AQL_NEAR = AQL_NEAR;
 exports.AQL_WITHIN = AQL_WITHIN;
 exports.AQL_WITHIN_RECTANGLE = AQL_WITHIN_RECTANGLE;
 exports.AQL_IS_IN_POLYGON = AQL_IS_IN_POLYGON;
+exports.AQL_DISTANCE = AQL_DISTANCE;
 exports.AQL_FULLTEXT = AQL_FULLTEXT;
 exports.AQL_PATHS = AQL_PATHS;
 exports.AQL_SHORTEST_PATH = AQL_SHORTEST_PATH;
@@ -318,6 +318,51 @@ function containsNullAttributes (example) {
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the candidate edges for an example containing a vertex
+///
+/// uses the vertex-centric skiplist index on the vertex attribute that covers
+/// the most attributes of the example, and the edge index otherwise
+////////////////////////////////////////////////////////////////////////////////
+
+function edgesByExample (collection, attribute, example) {
+  var normalized = normalizeAttributes(example, "");
+  var keys = Object.keys(normalized);
+  var hasNull = containsNullAttributes(example);
+  var indexes = collection.getIndexes();
+  var best = null, bestMatches = 1, i;
+
+  for (i = 0; i < indexes.length; ++i) {
+    var idx = indexes[i];
+
+    if (idx.type !== 'skiplist' || 
+        idx.fields[0] !== attribute || 
+        (idx.sparse && hasNull)) {
+      continue;
+    }
+
+    var matches = 0;
+    while (matches < idx.fields.length && keys.indexOf(idx.fields[matches]) !== -1) {
+      ++matches;
+    }
+
+    if (matches > bestMatches) {
+      best = idx;
+      bestMatches = matches;
+    }
+  }
+
+  if (best !== null) {
+    return collection.BY_EXAMPLE_SKIPLIST(best.id, normalized, 0, null).documents;
+  }
+
+  if (attribute === '_from') {
+    return collection.outEdges(example._from);
+  }
+
+  return collection.inEdges(example._to);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief finds documents by example
 ////////////////////////////////////////////////////////////////////////////////
@@ -366,18 +411,18 @@ function byExample (data) {
     }
   }
   else if (example.hasOwnProperty('_from')) {
-    // use edge index
+    // use vertex-centric or edge index
     try {
-      candidates.documents = collection.outEdges(example._from);
+      candidates.documents = edgesByExample(collection, '_from', example);
       postFilter = true;
     }
     catch (n3) {
     }
   }
   else if (example.hasOwnProperty('_to')) {
-    // use edge index
+    // use vertex-centric or edge index
     try {
-      candidates.documents = collection.inEdges(example._to);
+      candidates.documents = edgesByExample(collection, '_to', example);
       postFilter = true;
     }
     catch (n4) {
@@ -1707,6 +1707,73 @@ function ahuacatlInsertSuite () {
       assertEqual(expected, sanitizeStats(actual.stats));
     },
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert, with duplicate keys in the same block
+////////////////////////////////////////////////////////////////////////////////
+
+    testInsertIgnoreDuplicatesInBlock : function () {
+      var expected = { writesExecuted: 1000, writesIgnored: 2000 };
+      var actual = getModifyQueryResultsRaw("FOR i IN 0..2999 INSERT { _key: CONCAT('dup', TO_STRING(i % 1000)), value: i } IN @@cn OPTIONS { ignoreErrors: true } LET inserted = NEW RETURN inserted.value", { "@cn": cn2 });
+
+      assertEqual(1000, actual.json.length);
+      for (var i = 0; i < 1000; ++i) {
+        assertEqual(i, actual.json[i]);
+        assertEqual(i, c2.document("dup" + i).value);
+      }
+      assertEqual(1050, c2.count());
+      assertEqual(expected, sanitizeStats(actual.stats));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert, violating a unique index in the middle of a block
+////////////////////////////////////////////////////////////////////////////////
+
+    testInsertUniqueViolationInBlock : function () {
+      c2.ensureUniqueConstraint("value1");
+
+      assertQueryError(errors.ERROR_ARANGO_UNIQUE_CONSTRAINT_VIOLATED.code, "FOR i IN 0..1999 INSERT { value1: 1000 + (i % 1500) } IN @@cn", { "@cn": cn2 });
+
+      assertEqual(50, c2.count());
+      assertEqual(0, c2.byExample({ value1: 1000 }).count());
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test insert, stopping at the first error of a block
+////////////////////////////////////////////////////////////////////////////////
+
+    testInsertStopsAtFirstErrorInBlock : function () {
+      var queries = [
+        // fails in the storage engine
+        "FOR i IN 0..999 INSERT { _key: i == 500 ? 'new0' : CONCAT('new', TO_STRING(i)) } IN @@cn",
+        // fails before the documents are handed to the storage engine
+        "FOR i IN 0..999 INSERT i == 500 ? 'foo' : { _key: CONCAT('new', TO_STRING(i)) } IN @@cn"
+      ];
+
+      queries.forEach(function (query) {
+        c2.truncate();
+
+        // the outer transaction keeps the documents inserted before the error
+        var errorNum = db._executeTransaction({
+          collections: { write: cn2 },
+          action: function (params) {
+            try {
+              require("org/arangodb").db._query(params.query, { "@cn": params.cn });
+            }
+            catch (err) {
+              return err.errorNum;
+            }
+            return 0;
+          },
+          params: { query: query, cn: cn2 }
+        });
+
+        assertTrue(errorNum !== 0);
+        assertEqual(500, c2.count());
+        assertTrue(c2.exists("new499"));
+        assertFalse(c2.exists("new501"));
+      });
+    },
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief test insert
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,226 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var internal = require("internal");
+var helper = require("org/arangodb/aql-helper");
+var isEqual = helper.isEqual;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "parallelize-collection-scan";
+  // various choices to control the optimizer:
+  var paramNone     = { optimizer: { rules: [ "-all" ] } };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var colName = "UnitTestsAqlOptimizerRule";
+  var c;
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      internal.db._drop(colName);
+      c = internal.db._create(colName);
+
+      for (var i = 0; i < 5000; ++i) {
+        c.save({ _key: "test" + i, value: i, group: i % 10, sub: { active: (i % 3 === 0) }, tags: [ "a" + (i % 4) ] });
+      }
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      internal.db._drop(colName);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var queries = [
+        "FOR u IN " + colName + " FILTER u.value > 10 RETURN u",
+        "FOR u IN " + colName + " FILTER u.group == 1 && u.sub.active RETURN u.value"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramNone);
+        assertEqual([ ], result.plan.rules, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        "FOR u IN " + colName + " RETURN u",
+        "FOR u IN " + colName + " FILTER u._key == 'test1' RETURN u",
+        "FOR u IN " + colName + " FILTER u == { } RETURN u",
+        "FOR u IN " + colName + " FILTER LENGTH(u.tags) == 1 RETURN u",
+        "FOR u IN " + colName + " FILTER u.value + 1 > 10 RETURN u",
+        "FOR u IN " + colName + " FILTER u.value > RAND() RETURN u",
+        "FOR i IN 1..2 FOR u IN " + colName + " FILTER u.value == i RETURN u",
+        "FOR u IN " + colName + " LET x = u.value FILTER x > 10 RETURN u",
+        "FOR u IN " + colName + " SORT RAND() FILTER u.value > 10 RETURN u",
+        "FOR u IN " + colName + " FILTER u.sub.active ? u.group == 1 : u.group == 2 RETURN u"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        "FOR u IN " + colName + " FILTER u.value > 10 RETURN u",
+        "FOR u IN " + colName + " FILTER u.value > 10 FILTER u.group == 1 RETURN u.value",
+        "FOR u IN " + colName + " FILTER u.group IN [ 1, 2 ] || NOT u.sub.active RETURN u._key",
+        "FOR u IN " + colName + " FILTER u.value >= @min && u.value < @max RETURN u",
+        "FOR i IN 1..2 FOR u IN " + colName + " FILTER u.value == 3 RETURN [ i, u.value ]"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { min: 10, max: 20 }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query);
+
+        var nodes = helper.findExecutionNodes(result, "EnumerateCollectionNode");
+        assertEqual(1, nodes.length, query);
+        assertTrue(nodes[0].hasOwnProperty("filter"), query);
+        assertEqual(0, helper.findExecutionNodes(result, "FilterNode").length, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        [ "FOR u IN " + colName + " FILTER u.value < 10 SORT u.value RETURN u.value", [ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 ] ],
+        [ "FOR u IN " + colName + " FILTER u.value >= 4990 && u.group == 5 RETURN u._key", [ "test4995" ] ],
+        [ "FOR u IN " + colName + " FILTER u.value < 30 FILTER u.sub.active && u.tags[0] == 'a0' SORT u.value RETURN u.value", [ 0, 12, 24 ] ],
+        [ "FOR u IN " + colName + " FILTER u.group IN [ 1, 2 ] COLLECT g = u.group WITH COUNT INTO n RETURN [ g, n ]", [ [ 1, 500 ], [ 2, 500 ] ] ],
+        [ "FOR u IN " + colName + " FILTER u.missing == null COLLECT WITH COUNT INTO n RETURN n", [ 5000 ] ],
+        [ "FOR u IN " + colName + " FILTER u.value == -1 RETURN u", [ ] ],
+        [ "FOR i IN 1..3 FOR u IN " + colName + " FILTER u.value == 7 RETURN [ i, u.value ]", [ [ 1, 7 ], [ 2, 7 ], [ 3, 7 ] ] ]
+      ];
+
+      queries.forEach(function(query) {
+        var planDisabled   = AQL_EXPLAIN(query[0], { }, paramDisabled);
+        var planEnabled    = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        var resultDisabled = AQL_EXECUTE(query[0], { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query[0], { }, paramEnabled).json;
+
+        assertEqual(-1, planDisabled.plan.rules.indexOf(ruleName), query[0]);
+        assertNotEqual(-1, planEnabled.plan.rules.indexOf(ruleName), query[0]);
+
+        assertTrue(isEqual(resultDisabled, resultEnabled), query[0]);
+        assertEqual(query[1], resultEnabled, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results of filters that are not evaluated while scanning
+////////////////////////////////////////////////////////////////////////////////
+
+    testResultsNoEffect : function () {
+      var queries = [
+        [ "FOR u IN " + colName + " FILTER u.sub.active ? u.group == 1 : u.group == 2 COLLECT g = u.group WITH COUNT INTO n RETURN [ g, n ]", [ [ 1, 166 ], [ 2, 333 ] ] ],
+        [ "FOR u IN " + colName + " FILTER u.value < 20 FILTER u.sub.active ? u.group == 0 : false SORT u.value RETURN u.value", [ 0 ] ]
+      ];
+
+      queries.forEach(function(query) {
+        var resultDisabled = AQL_EXECUTE(query[0], { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query[0], { }, paramEnabled).json;
+
+        assertTrue(isEqual(resultDisabled, resultEnabled), query[0]);
+        assertEqual(query[1], resultEnabled, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the scan keeps the order of the documents
+////////////////////////////////////////////////////////////////////////////////
+
+    testOrder : function () {
+      var query = "FOR u IN " + colName + " FILTER u.group == 3 RETURN u._key";
+
+      var resultDisabled = AQL_EXECUTE(query, { }, paramNone).json;
+      var resultEnabled  = AQL_EXECUTE(query, { }, paramEnabled).json;
+
+      assertEqual(500, resultEnabled.length);
+      assertEqual(resultDisabled, resultEnabled);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test execution statistics
+////////////////////////////////////////////////////////////////////////////////
+
+    testStats : function () {
+      var query = "FOR u IN " + colName + " FILTER u.group == 3 RETURN u";
+
+      var stats = AQL_EXECUTE(query, { }, paramEnabled).stats;
+
+      assertEqual(5000, stats.scannedFull);
+      assertEqual(4500, stats.filtered);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,231 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var internal = require("internal");
+var helper = require("org/arangodb/aql-helper");
+var isEqual = helper.isEqual;
+
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "use-geo-index";
+  // various choices to control the optimizer:
+  var paramNone     = { optimizer: { rules: [ "-all" ] } };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var colName = "UnitTestsAqlOptimizerRuleGeo";
+  var colNameNoIndex = "UnitTestsAqlOptimizerRuleGeoNoIndex";
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      var i, j;
+
+      internal.db._drop(colName);
+      internal.db._drop(colNameNoIndex);
+      var c = internal.db._create(colName);
+      var n = internal.db._create(colNameNoIndex);
+      for (i = -20; i <= 20; ++i) {
+        for (j = -20; j <= 20; ++j) {
+          c.save({ lat: i, lon: j, value: i * 100 + j });
+          n.save({ lat: i, lon: j });
+        }
+      }
+      // documents not contained in the geo index
+      c.save({ lat: "foo", lon: 0, value: "invalid" });
+      c.save({ lat: 0, value: "missing" });
+      c.save({ lat: 100, lon: 0, value: "out of range" });
+
+      c.ensureGeoIndex("lat", "lon");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      internal.db._drop(colName);
+      internal.db._drop(colNameNoIndex);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test the DISTANCE function
+////////////////////////////////////////////////////////////////////////////////
+
+    testDistance : function () {
+      var result = AQL_EXECUTE("RETURN [ DISTANCE(0, 0, 0, 0), DISTANCE(0, 0, 0, 1), DISTANCE(0, 0, 1, 0), DISTANCE(0, 180, 0, -180) ]").json[0];
+      assertEqual(0, result[0]);
+      assertTrue(Math.abs(result[1] - 111194.9) < 1);
+      assertTrue(Math.abs(result[2] - 111194.9) < 1);
+      assertTrue(result[3] < 0.001);
+
+      result = AQL_EXECUTE("RETURN [ DISTANCE(0, 0, 91, 0), DISTANCE(0, 0, 0, -181), DISTANCE(null, 0, 0, 0), DISTANCE('1', 0, 0, 0) ]").json[0];
+      assertEqual([ null, null, null, null ], result);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var queries = [
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 100000 RETURN d",
+        "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, 0, 0) LIMIT 5 RETURN d"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramNone);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+        result = AQL_EXPLAIN(query, { }, paramDisabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        "FOR d IN " + colNameNoIndex + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 100000 RETURN d",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lon, d.lat, 0, 0) < 100000 RETURN d",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) > 100000 RETURN d",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, d.lat, 0) < 100000 RETURN d",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < d.value RETURN d",
+        "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, 0, 0) DESC LIMIT 5 RETURN d",
+        "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, 0, 0), d.value LIMIT 5 RETURN d",
+        "FOR d IN " + colName + " SORT d.value FILTER DISTANCE(d.lat, d.lon, 0, 0) < 100000 RETURN d",
+        "FOR d IN " + colName + " RETURN DISTANCE(d.lat, d.lon, 0, 0)"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        [ "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 100000 RETURN d", 100000, false ],
+        [ "FOR d IN " + colName + " FILTER DISTANCE(0, 0, d.lat, d.lon) <= 100000 RETURN d", 100000, false ],
+        [ "FOR d IN " + colName + " FILTER 100000 > DISTANCE(d.lat, d.lon, 0, 0) RETURN d", 100000, false ],
+        [ "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 200000 FILTER DISTANCE(d.lat, d.lon, 0, 0) < 100000 RETURN d", 100000, false ],
+        [ "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, 0, 0) LIMIT 5 RETURN d", undefined, true ],
+        [ "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 100000 SORT DISTANCE(d.lat, d.lon, 0, 0) RETURN d", 100000, true ],
+        [ "FOR d IN " + colName + " LET x = DISTANCE(d.lat, d.lon, 1, 2) SORT x LIMIT 5 RETURN d", undefined, true ]
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query[0], { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query[0]);
+
+        var nodes = helper.findExecutionNodes(result, "GeoIndexNode");
+        assertEqual(1, nodes.length, query[0]);
+        assertEqual(query[1], nodes[0].radius, query[0]);
+        assertEqual(0, helper.findExecutionNodes(result, "EnumerateCollectionNode").length, query[0]);
+        assertEqual(query[2] ? 0 : 1, helper.findExecutionNodes(result, "SortNode").length, query[0]);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 400000 RETURN d.value",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 5, 5) <= 0 RETURN d.value",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 3, -7) < 10 RETURN d.value",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 400000 && d.value > 0 RETURN d.value",
+        "FOR d IN " + colName + " FILTER DISTANCE(d.lat, d.lon, 0, 0) < 1000000 SORT DISTANCE(d.lat, d.lon, 0, 0) LIMIT 20 RETURN DISTANCE(d.lat, d.lon, 0, 0)",
+        "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, 0, 0) LIMIT 50 RETURN DISTANCE(d.lat, d.lon, 0, 0)",
+        "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, 10, 10) LIMIT 1000, 10 RETURN DISTANCE(d.lat, d.lon, 10, 10)",
+        "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, -10, 10) RETURN DISTANCE(d.lat, d.lon, -10, 10)"
+      ];
+
+      queries.forEach(function(query) {
+        var planDisabled   = AQL_EXPLAIN(query, { }, paramDisabled);
+        var planEnabled    = AQL_EXPLAIN(query, { }, paramEnabled);
+        var resultDisabled = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query, { }, paramEnabled).json;
+
+        assertEqual(-1, planDisabled.plan.rules.indexOf(ruleName), query);
+        assertNotEqual(-1, planEnabled.plan.rules.indexOf(ruleName), query);
+
+        assertTrue(resultDisabled.length > 0, query);
+        if (query.indexOf("SORT") === -1) {
+          resultDisabled.sort();
+          resultEnabled.sort();
+        }
+        assertTrue(isEqual(resultDisabled, resultEnabled), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that documents not contained in the index are returned
+////////////////////////////////////////////////////////////////////////////////
+
+    testDocumentsNotIndexed : function () {
+      var query = "FOR d IN " + colName + " SORT DISTANCE(d.lat, d.lon, 0, 0) LIMIT 4 RETURN d.value";
+      var result = AQL_EXECUTE(query, { }, paramEnabled).json;
+
+      assertEqual(4, result.length);
+      assertEqual([ "invalid", "missing", "out of range" ], result.slice(0, 3).sort());
+      assertEqual(0, result[3]);
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
@@ -0,0 +1,191 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, assertNotEqual, AQL_EXPLAIN, AQL_EXECUTE */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for optimizer rules
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var jsunity = require("jsunity");
+var internal = require("internal");
+var helper = require("org/arangodb/aql-helper");
+var isEqual = helper.isEqual;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function optimizerRuleTestSuite () {
+  var ruleName = "use-index-only";
+  // various choices to control the optimizer:
+  var paramNone     = { optimizer: { rules: [ "-all", "+use-index-range" ] } };
+  var paramEnabled  = { optimizer: { rules: [ "-all", "+use-index-range", "+" + ruleName ] } };
+  var paramDisabled = { optimizer: { rules: [ "+all", "-" + ruleName ] } };
+
+  var colNameSkip = "UnitTestsAqlOptimizerRuleSkiplist";
+  var colNameHash = "UnitTestsAqlOptimizerRuleHash";
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      var i;
+
+      internal.db._drop(colNameSkip);
+      var skiplist = internal.db._create(colNameSkip);
+      for (i = 0; i < 100; ++i) {
+        skiplist.save({ a: i, b: "test" + (i % 10), c: { d: i % 5, e: i }, f: i * 2 });
+      }
+      skiplist.ensureSkiplist("a", "b");
+      skiplist.ensureSkiplist("c.d");
+
+      internal.db._drop(colNameHash);
+      var hash = internal.db._create(colNameHash);
+      for (i = 0; i < 100; ++i) {
+        hash.save({ a: i % 10, b: "test" + (i % 3), f: i });
+      }
+      hash.ensureHashIndex("a", "b");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      internal.db._drop(colNameSkip);
+      internal.db._drop(colNameHash);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect when explicitly disabled
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleDisabled : function () {
+      var queries = [
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN u.a",
+        "FOR u IN " + colNameHash + " FILTER u.a == 1 && u.b == 'test1' RETURN u.a"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramNone);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has no effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleNoEffect : function () {
+      var queries = [
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN u",
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN u._key",
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN u.f",
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN [ u.a, u.c ]",
+        "FOR u IN " + colNameSkip + " FILTER u.c.d == 1 RETURN u.c.e",
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN ATTRIBUTES(u)",
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 SORT u.a COLLECT a = u.a INTO g RETURN g",
+        "FOR u IN " + colNameHash + " FILTER u.a == 1 && u.b == 'test1' RETURN u",
+        "FOR u IN " + colNameHash + " FILTER u.a == 1 && u.b == 'test1' RETURN u._id",
+        "FOR u IN " + colNameHash + " FILTER u.a == 1 && u.b == 'test1' RETURN u.f"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertEqual(-1, result.plan.rules.indexOf(ruleName), query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that rule has an effect
+////////////////////////////////////////////////////////////////////////////////
+
+    testRuleHasEffect : function () {
+      var queries = [
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN u.a",
+        "FOR u IN " + colNameSkip + " FILTER u.a > 10 RETURN { a: u.a, b: u.b }",
+        "FOR u IN " + colNameSkip + " FILTER u.a == 10 && u.b == 'test0' RETURN CONCAT(u.b, u.a)",
+        "FOR u IN " + colNameSkip + " FILTER u.c.d == 1 RETURN u.c.d",
+        "FOR u IN " + colNameHash + " FILTER u.a == 1 && u.b == 'test1' RETURN u.a",
+        "FOR u IN " + colNameHash + " FILTER u.b == 'test1' && u.a == 1 RETURN [ u.a, u.b ]"
+      ];
+
+      queries.forEach(function(query) {
+        var result = AQL_EXPLAIN(query, { }, paramEnabled);
+        assertNotEqual(-1, result.plan.rules.indexOf(ruleName), query);
+
+        var nodes = helper.findExecutionNodes(result, "IndexRangeNode");
+        assertEqual(1, nodes.length, query);
+        assertTrue(nodes[0].indexOnly, query);
+      });
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test results
+////////////////////////////////////////////////////////////////////////////////
+
+    testResults : function () {
+      var queries = [
+        "FOR u IN " + colNameSkip + " FILTER u.a > 90 RETURN u.a",
+        "FOR u IN " + colNameSkip + " FILTER u.a >= 95 RETURN { a: u.a, b: u.b }",
+        "FOR u IN " + colNameSkip + " FILTER u.a == 10 && u.b == 'test0' RETURN CONCAT(u.b, u.a)",
+        "FOR u IN " + colNameSkip + " FILTER u.c.d == 1 SORT u.c.d RETURN u.c.d",
+        "FOR u IN " + colNameSkip + " FILTER u.a > 90 LIMIT 2, 3 RETURN u.a",
+        "FOR u IN " + colNameHash + " FILTER u.a == 1 && u.b == 'test1' RETURN u.a",
+        "FOR u IN " + colNameHash + " FILTER u.b == 'test1' && u.a == 1 RETURN [ u.a, u.b ]"
+      ];
+
+      queries.forEach(function(query) {
+        var planDisabled   = AQL_EXPLAIN(query, { }, paramDisabled);
+        var planEnabled    = AQL_EXPLAIN(query, { }, paramEnabled);
+        var resultDisabled = AQL_EXECUTE(query, { }, paramDisabled).json;
+        var resultEnabled  = AQL_EXECUTE(query, { }, paramEnabled).json;
+
+        assertEqual(-1, planDisabled.plan.rules.indexOf(ruleName), query);
+        assertNotEqual(-1, planEnabled.plan.rules.indexOf(ruleName), query);
+
+        assertTrue(resultDisabled.length > 0, query);
+        assertTrue(isEqual(resultDisabled.sort(), resultEnabled.sort()), query);
+      });
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(optimizerRuleTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
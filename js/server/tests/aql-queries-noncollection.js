@@ -319,6 +319,26 @@ function ahuacatlQueryNonCollectionTestSuite () {
 
       var actual = getQueryResults("FOR r IN [ 1 ] LET f = (FOR x IN [ 1 ] FILTER 1 == 1 FOR y IN [ 1 ] FOR z IN [ 1 ] RETURN 1) RETURN 1");
       assertEqual(expected, actual);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test block statistics
+////////////////////////////////////////////////////////////////////////////////
+
+    testBlockStatistics : function () {
+      var result = AQL_EXECUTE("FOR i IN 1..10000 RETURN i");
+      var stats = result.stats;
+
+      assertEqual(10000, result.json.length);
+      assertTrue(stats.hasOwnProperty("blocksAllocated"));
+      assertTrue(stats.hasOwnProperty("blocksReused"));
+      assertTrue(stats.hasOwnProperty("bytesAllocated"));
+
+      // the result blocks are handed back by the query and recycled
+      assertTrue(stats.blocksAllocated > 0);
+      assertTrue(stats.blocksReused > 0);
+      assertTrue(stats.blocksAllocated < 10);
+      assertTrue(stats.bytesAllocated > 0);
     }
 
   };
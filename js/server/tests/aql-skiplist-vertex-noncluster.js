@@ -0,0 +1,244 @@
+/*jshint globalstrict:false, strict:false, maxlen: 500 */
+/*global assertEqual, assertTrue, AQL_EXPLAIN */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for vertex-centric skiplist indexes
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2015 ArangoDB GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2015, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var internal = require("internal");
+var jsunity = require("jsunity");
+var helper = require("org/arangodb/aql-helper");
+var getQueryResults = helper.getQueryResults;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function ahuacatlSkiplistVertexTestSuite () {
+  var vn = "UnitTestsAhuacatlVertex";
+  // created after vn, so its id is higher, but its name sorts before vn
+  var vn2 = "UnitTestsAhuacatlAVertex";
+  var en = "UnitTestsAhuacatlEdge";
+  var edges;
+  var idx;
+
+  var indexesUsed = function (query, params) {
+    var plan = AQL_EXPLAIN(query, params || { }).plan;
+    return helper.findExecutionNodes(plan, "IndexRangeNode").map(function(node) {
+      return node.index.type + ":" + node.index.fields.join(",");
+    });
+  };
+
+  return {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief set up
+////////////////////////////////////////////////////////////////////////////////
+
+    setUp : function () {
+      internal.db._drop(vn);
+      internal.db._drop(vn2);
+      internal.db._drop(en);
+      internal.db._create(vn);
+      internal.db._create(vn2);
+      edges = internal.db._createEdgeCollection(en);
+
+      // one vertex with many edges, and a few with some edges each
+      for (var i = 0; i < 1000; ++i) {
+        edges.save(vn + "/super", vn + "/v" + (i % 10), { type: (i % 4 === 0 ? "follows" : "likes"), time: i });
+      }
+      for (var j = 0; j < 10; ++j) {
+        edges.save(vn + "/v" + j, vn + "/super", { type: "follows", time: j });
+        edges.save(vn + "/v" + j, vn + "/v" + ((j + 1) % 10), { type: "likes", time: j });
+        edges.save(vn2 + "/a" + j, vn + "/v" + j, { type: "follows", time: j });
+      }
+
+      idx = edges.ensureSkiplist("_from", "type", "time");
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tear down
+////////////////////////////////////////////////////////////////////////////////
+
+    tearDown : function () {
+      internal.db._drop(en);
+      internal.db._drop(vn);
+      internal.db._drop(vn2);
+      edges = null;
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test equality on the vertex only
+////////////////////////////////////////////////////////////////////////////////
+
+    testVertexOnly : function () {
+      var query = "FOR e IN " + en + " FILTER e._from == @vertex RETURN e";
+
+      assertEqual(1000, getQueryResults(query, { vertex: vn + "/super" }).length);
+      assertEqual(2, getQueryResults(query, { vertex: vn + "/v3" }).length);
+      assertEqual(0, getQueryResults(query, { vertex: vn + "/unknown" }).length);
+      assertEqual(0, getQueryResults(query, { vertex: "UnitTestsNonExisting/super" }).length);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test equality on the vertex and the next attribute
+////////////////////////////////////////////////////////////////////////////////
+
+    testVertexAndAttribute : function () {
+      var query = "FOR e IN " + en + " FILTER e._from == @vertex && e.type == @type RETURN e";
+      var actual = getQueryResults(query, { vertex: vn + "/super", type: "follows" });
+
+      assertEqual(250, actual.length);
+      actual.forEach(function (e) {
+        assertEqual(vn + "/super", e._from);
+        assertEqual("follows", e.type);
+      });
+
+      assertEqual(1, getQueryResults(query, { vertex: vn + "/v7", type: "likes" }).length);
+      assertEqual([ "skiplist:_from,type,time" ], indexesUsed(query, { vertex: vn + "/super", type: "follows" }));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a range on the attribute after the vertex
+////////////////////////////////////////////////////////////////////////////////
+
+    testVertexAndRange : function () {
+      var query = "FOR e IN " + en + " FILTER e._from == @vertex && e.type == 'follows' && e.time >= 100 && e.time < 200 SORT e.time RETURN e.time";
+      var expected = [ ];
+      for (var i = 100; i < 200; i += 4) {
+        expected.push(i);
+      }
+
+      assertEqual(expected, getQueryResults(query, { vertex: vn + "/super" }));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test sorting by the vertex, which the index does not order like
+/// strings
+////////////////////////////////////////////////////////////////////////////////
+
+    testSortVertex : function () {
+      var query = "FOR e IN " + en + " SORT e._from, e.type, e.time RETURN e._from";
+      var expected = edges.toArray().map(function (e) { return e._from; }).sort();
+
+      assertEqual(1030, expected.length);
+      assertEqual(vn2 + "/a0", expected[0]);
+      assertEqual(expected, getQueryResults(query));
+      assertEqual([ ], indexesUsed(query));
+
+      query = "FOR e IN " + en + " SORT e._from DESC RETURN e._from";
+      assertEqual(expected.reverse(), getQueryResults(query));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test a range on the vertex across two vertex collections
+////////////////////////////////////////////////////////////////////////////////
+
+    testRangeVertex : function () {
+      var query = "FOR e IN " + en + " FILTER e._from >= @low && e._from < @high SORT e._from RETURN e._from";
+      var low = vn2 + "/a3", high = vn + "/v5";
+      var expected = edges.toArray().map(function (e) { return e._from; }).filter(function (from) {
+        return from >= low && from < high;
+      }).sort();
+
+      assertEqual(7 + 1000 + 10, expected.length);
+      assertEqual(expected, getQueryResults(query, { low: low, high: high }));
+      assertEqual([ ], indexesUsed(query, { low: low, high: high }));
+
+      query = "FOR e IN " + en + " FILTER e._from > @low RETURN e._from";
+      assertEqual(1030, getQueryResults(query, { low: "UnitTestsAAA/a" }).length);
+      assertEqual([ ], indexesUsed(query, { low: "UnitTestsAAA/a" }));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the index follows modifications
+////////////////////////////////////////////////////////////////////////////////
+
+    testModifications : function () {
+      var query = "FOR e IN " + en + " FILTER e._from == @vertex && e.type == 'blocks' RETURN e._key";
+      var doc = edges.save(vn + "/v1", vn + "/v2", { type: "blocks", time: 0 });
+
+      assertEqual([ doc._key ], getQueryResults(query, { vertex: vn + "/v1" }));
+
+      edges.update(doc._key, { type: "likes" });
+      assertEqual([ ], getQueryResults(query, { vertex: vn + "/v1" }));
+
+      edges.update(doc._key, { type: "blocks" });
+      assertEqual([ doc._key ], getQueryResults(query, { vertex: vn + "/v1" }));
+
+      edges.remove(doc._key);
+      assertEqual([ ], getQueryResults(query, { vertex: vn + "/v1" }));
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test queries by example
+////////////////////////////////////////////////////////////////////////////////
+
+    testByExample : function () {
+      var actual = edges.byExample({ _from: vn + "/super", type: "likes" }).toArray();
+
+      assertEqual(750, actual.length);
+      actual.forEach(function (e) {
+        assertEqual(vn + "/super", e._from);
+        assertEqual("likes", e.type);
+      });
+
+      actual = edges.byExampleSkiplist(idx.id, { _from: vn + "/v4", type: "likes" }).toArray();
+      assertEqual(1, actual.length);
+      assertEqual(vn + "/v5", actual[0]._to);
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test that the index survives an unload
+////////////////////////////////////////////////////////////////////////////////
+
+    testUnload : function () {
+      edges.unload();
+      edges = null;
+      internal.wait(2);
+      edges = internal.db._collection(en);
+
+      var query = "FOR e IN " + en + " FILTER e._from == @vertex && e.type == 'follows' RETURN e";
+
+      assertEqual(250, getQueryResults(query, { vertex: vn + "/super" }).length);
+      assertTrue(edges.getIndexes().some(function (index) { return index.type === "skiplist"; }));
+    }
+
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+jsunity.run(ahuacatlSkiplistVertexTestSuite);
+
+return jsunity.done();
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "^\\(/// @brief\\|/// @addtogroup\\|// --SECTION--\\|/// @page\\|/// @}\\)"
+// End:
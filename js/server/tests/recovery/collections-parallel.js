@@ -0,0 +1,154 @@
+/*jshint globalstrict:false, strict:false, unused : false */
+/*global assertEqual, assertNull */
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief tests for parallel recovery of multiple collections
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2010-2012 triagens GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is triAGENS GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2012, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+var db = require("org/arangodb").db;
+var internal = require("internal");
+var jsunity = require("jsunity");
+
+
+function runSetup () {
+  'use strict';
+  internal.debugClearFailAt();
+
+  // disable collector
+  internal.debugSetFailAt("CollectorThreadProcessQueuedOperations");
+
+  var c = [ ], i, j;
+
+  for (i = 0; i < 8; ++i) {
+    db._drop("UnitTestsRecovery" + i);
+    c[i] = db._create("UnitTestsRecovery" + i);
+    c[i].ensureHashIndex("value");
+  }
+  db._drop("UnitTestsRecoveryDropped");
+  var dropped = db._create("UnitTestsRecoveryDropped");
+
+  // interleave the operations of all collections
+  for (j = 0; j < 1000; ++j) {
+    for (i = 0; i < 8; ++i) {
+      c[i].save({ _key: "test" + j, value: j, collection: i });
+    }
+    dropped.save({ _key: "test" + j });
+
+    if (j % 250 === 0) {
+      // make sure the next operations go into a separate log
+      internal.wal.flush(true, false);
+    }
+  }
+
+  for (j = 0; j < 1000; j += 2) {
+    for (i = 0; i < 8; ++i) {
+      c[i].update("test" + j, { value: j + 1000 });
+    }
+  }
+
+  dropped.drop();
+
+  for (j = 0; j < 1000; j += 10) {
+    for (i = 0; i < 8; ++i) {
+      c[i].remove("test" + j);
+    }
+  }
+
+  // create an index after the data
+  c[0].ensureSkiplist("collection");
+
+  c[1].save({ _key: "foo" }, true);
+
+  internal.debugSegfault("crashing server");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function recoverySuite () {
+  'use strict';
+  jsunity.jsUnity.attachAssertions();
+
+  return {
+    setUp: function () {
+    },
+    tearDown: function () {
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test whether the operations of all collections are recovered
+////////////////////////////////////////////////////////////////////////////////
+    
+    testCollectionsParallel : function () {
+      var c, i, j, doc, expected, idx;
+
+      assertNull(db._collection("UnitTestsRecoveryDropped"));
+
+      for (i = 0; i < 8; ++i) {
+        c = db._collection("UnitTestsRecovery" + i);
+        assertEqual(i === 1 ? 901 : 900, c.count());
+        idx = c.getIndexes()[1];
+
+        for (j = 0; j < 1000; ++j) {
+          if (j % 10 === 0) {
+            assertEqual(0, c.byExample({ _key: "test" + j }).toArray().length);
+            continue;
+          }
+
+          expected = (j % 2 === 0) ? j + 1000 : j;
+          doc = c.document("test" + j);
+          assertEqual(expected, doc.value);
+          assertEqual(i, doc.collection);
+
+          // the hash index must have been filled
+          assertEqual(1, c.byExampleHash(idx.id, { value: expected }).toArray().length);
+        }
+      }
+
+      c = db._collection("UnitTestsRecovery0");
+      assertEqual(3, c.getIndexes().length);
+      assertEqual(900, c.byExample({ collection: 0 }).toArray().length);
+    }
+        
+  };
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief executes the test suite
+////////////////////////////////////////////////////////////////////////////////
+
+function main (argv) {
+  'use strict';
+  if (argv[1] === "setup") {
+    runSetup();
+    return 0;
+  }
+  else {
+    jsunity.run(recoverySuite);
+    return jsunity.done().status ? 0 : 1;
+  }
+}
@@ -1655,6 +1655,65 @@ function ReplicationSuite () {
           restrictCollections: [ cn2 ]
         }
       );
+    },
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief test incremental sync of an existing collection
+////////////////////////////////////////////////////////////////////////////////
+
+    testIncrementalSync : function () {
+      var configuration = {
+        endpoint: masterEndpoint,
+        username: replicatorUser,
+        password: replicatorPassword,
+        restrictType: "include",
+        restrictCollections: [ cn ]
+      };
+
+      var c = db._create(cn), i;
+
+      // more documents than fit into one key range
+      for (i = 0; i < 12000; ++i) {
+        c.save({ _key: "test" + i, value: i });
+      }
+
+      connectToSlave();
+      replication.applier.stop();
+
+      // full sync first
+      replication.sync(configuration);
+      assertEqual(12000, collectionCount(cn));
+
+      // modify the master
+      connectToMaster();
+      c = db._collection(cn);
+
+      for (i = 0; i < 12000; i += 1000) {
+        c.update("test" + i, { value: -i });
+      }
+      c.remove("test1");
+      c.remove("test11999");
+      c.save({ _key: "aaa", value: "before all other keys" });
+      c.save({ _key: "zzz", value: "after all other keys" });
+
+      var checksum = collectionChecksum(cn);
+      var count = collectionCount(cn);
+
+      // modify the slave, too
+      connectToSlave();
+      c = db._collection(cn);
+      c.save({ _key: "slave-only" });
+      c.remove("test500");
+      c.update("test501", { value: "changed on slave" });
+
+      configuration.incremental = true;
+      var syncResult = replication.sync(configuration);
+
+      assertTrue(syncResult.hasOwnProperty('lastLogTick'));
+      assertEqual(count, collectionCount(cn));
+      assertEqual(checksum, collectionChecksum(cn));
+      assertEqual(-1000, db._collection(cn).document("test1000").value);
+      assertEqual(501, db._collection(cn).document("test501").value);
     }
 
   };
@@ -0,0 +1,677 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief associative multi array for pointers, template version
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Martin Schoenert
+/// @author Max Neunhoeffer
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2006-2014, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_BASICS_ASSOC_MULTI_H
+#define ARANGODB_BASICS_ASSOC_MULTI_H 1
+
+#include "Basics/Common.h"
+#include "Basics/Exceptions.h"
+#include "Basics/prime-numbers.h"
+
+namespace triagens {
+  namespace basics {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  class AssocMulti
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief associative multi array of pointers
+///
+/// This is the template version of TRI_multi_pointer_t and has exactly the
+/// same semantics: the array stores pointers to elements, several elements
+/// can have the same key, and all elements with the same key are chained in
+/// a doubly linked list. The first element of such a list is stored at the
+/// position of its key hash, all other elements are stored at the position
+/// of the hash of their identity.
+///
+/// The description is a compile-time policy that describes how to hash keys
+/// and elements and how to compare them. It must provide the following
+/// methods:
+///
+/// - uint64_t hashKey (KEY const*)
+/// - uint64_t hashElement (ELEMENT const*, bool byKey)
+/// - bool isEqualKeyElement (KEY const*, ELEMENT const*)
+/// - bool isEqualElementElement (ELEMENT const*, ELEMENT const*, bool byKey)
+///
+/// Because the calls are resolved at compile-time, they can be inlined into
+/// the probing loops, which is not possible with the function pointers of
+/// TRI_multi_pointer_t. Methods that need to grow the table throw an
+/// exception if the memory cannot be allocated.
+////////////////////////////////////////////////////////////////////////////////
+
+    template <typename KEY, typename ELEMENT, typename DESC>
+    class AssocMulti {
+      private:
+        AssocMulti (AssocMulti const&);
+        AssocMulti& operator= (AssocMulti const&);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                     private types
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief an entry of the table
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Entry {
+          ELEMENT* ptr;    // a pointer to the data stored in this slot
+          uint64_t next;   // index of the data following in the linked list
+                           // of all items with the same key
+          uint64_t prev;   // index of the data preceding in the linked list
+                           // of all items with the same key
+        };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalid index value
+////////////////////////////////////////////////////////////////////////////////
+
+        static uint64_t const INVALID_INDEX = ((uint64_t) 0) - 1;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief initial number of elements of a container
+////////////////////////////////////////////////////////////////////////////////
+
+        static uint64_t const INITIAL_SIZE = 64;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                      constructors and destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief constructs a new associative multi array
+////////////////////////////////////////////////////////////////////////////////
+
+        explicit
+        AssocMulti (TRI_memory_zone_t* zone, DESC const& desc = DESC())
+          : _desc(desc),
+            _memoryZone(zone),
+            _tableAlloc(nullptr),
+            _table(nullptr),
+            _nrAlloc(0),
+            _nrUsed(0),
+            _nrUnique(0),
+            _nrDuplicate(0) {
+
+          _tableAlloc = allocateTable(INITIAL_SIZE);
+
+          if (_tableAlloc == nullptr) {
+            THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+          }
+
+          _table = static_cast<Entry*>(TRI_Align64(_tableAlloc));
+          _nrAlloc = INITIAL_SIZE;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroys the associative multi array, but not the elements
+////////////////////////////////////////////////////////////////////////////////
+
+        ~AssocMulti () {
+          if (_tableAlloc != nullptr) {
+            TRI_Free(_memoryZone, _tableAlloc);
+          }
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of elements
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t size () const {
+          return _nrUsed;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the memory used by the array
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t memoryUsage () const {
+          return (size_t) _nrAlloc * sizeof(Entry) + 64;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns a selectivity estimate, that is the ratio of distinct keys
+/// to elements
+////////////////////////////////////////////////////////////////////////////////
+
+        double selectivity () const {
+          uint64_t numTotal = _nrUnique + _nrDuplicate;
+
+          if (numTotal == 0) {
+            return 1.0;
+          }
+
+          return static_cast<double>(_nrUnique) / static_cast<double>(numTotal);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief adds an element to the array
+///
+/// Returns the element that compared equal to the new one, or a null pointer
+/// if there was none. If overwrite is set, the old element is replaced.
+///
+/// If checkEquality is not set, the caller guarantees that no equal element
+/// is stored in the array yet. This saves a lot of comparisons when an index
+/// is filled initially.
+////////////////////////////////////////////////////////////////////////////////
+
+        ELEMENT* insert (ELEMENT* element,
+                         bool overwrite,
+                         bool checkEquality) {
+
+          // if we were adding and the table is more than half full, extend it
+          if (_nrAlloc < 2 * _nrUsed) {
+            if (! resizeInternal(2 * _nrAlloc + 1)) {
+              THROW_ARANGO_EXCEPTION(TRI_ERROR_OUT_OF_MEMORY);
+            }
+          }
+
+          // compute the hash by the key only first
+          uint64_t i = _desc.hashElement(element, true) % _nrAlloc;
+
+          // now find the first slot with an entry with the same key that is
+          // the start of a linked list, or a free slot
+          while (_table[i].ptr != nullptr &&
+                 (_table[i].prev != INVALID_INDEX ||
+                  ! _desc.isEqualElementElement(element, _table[i].ptr, true))) {
+            i = TRI_IncModU64(i, _nrAlloc);
+          }
+
+          // if this is free, we are the first with this key
+          if (_table[i].ptr == nullptr) {
+            _table[i].ptr = element;
+            _table[i].next = INVALID_INDEX;
+            _table[i].prev = INVALID_INDEX;
+            _nrUsed++;
+            _nrUnique++;
+
+            return nullptr;
+          }
+
+          // otherwise, entry i points to the beginning of the linked list of
+          // which we want to make element a member. perhaps an equal element
+          // is right here
+          if (checkEquality &&
+              _desc.isEqualElementElement(element, _table[i].ptr, false)) {
+            ELEMENT* old = _table[i].ptr;
+
+            if (overwrite) {
+              _table[i].ptr = element;
+            }
+
+            return old;
+          }
+
+          // now find a new home for element in this linked list
+          uint64_t j = findElementPlace(element, checkEquality);
+
+          ELEMENT* old = _table[j].ptr;
+
+          // if we found an element, return
+          if (old != nullptr) {
+            if (overwrite) {
+              _table[j].ptr = element;
+            }
+
+            return old;
+          }
+
+          // add a new element to the array and the linked list (in pos 2)
+          _table[j].ptr = element;
+          _table[j].next = _table[i].next;
+          _table[j].prev = i;
+          _table[i].next = j;
+
+          // finally, we need to find the successor to patch it up
+          if (_table[j].next != INVALID_INDEX) {
+            _table[_table[j].next].prev = j;
+          }
+
+          _nrUsed++;
+          _nrDuplicate++;
+
+          return nullptr;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up all elements with a given key
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<ELEMENT*> lookupByKey (KEY const* key) const {
+          std::vector<ELEMENT*> result;
+
+          uint64_t i = findKeyHead(key);
+
+          if (_table[i].ptr != nullptr) {
+            // we found the beginning of the linked list
+            // pre-initialize the result to save at least a few reallocs
+            result.reserve(4);
+
+            do {
+              result.push_back(_table[i].ptr);
+              i = _table[i].next;
+            }
+            while (i != INVALID_INDEX);
+          }
+
+          return result;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up elements with a given key in batches
+///
+/// Calls the callback for at most batchSize elements. next must be a null
+/// pointer for the first batch, it is set to the position of the next
+/// element or to a null pointer if there are no more elements.
+////////////////////////////////////////////////////////////////////////////////
+
+        template <typename CALLBACK>
+        void lookupByKey (KEY const* key,
+                          CALLBACK const& callback,
+                          void*& next,
+                          size_t batchSize) const {
+          TRI_ASSERT(batchSize > 0);
+
+          size_t total = 0;
+
+          if (next == nullptr) {
+            uint64_t i = findKeyHead(key);
+
+            if (_table[i].ptr != nullptr) {
+              callback(_table[i].ptr);
+              ++total;
+
+              uint64_t nextIndex = _table[i].next;
+
+              if (nextIndex != INVALID_INDEX) {
+                next = &_table[nextIndex];
+              }
+            }
+          }
+
+          if (next != nullptr) {
+            // we already had a state
+            while (total < batchSize) {
+              Entry const* current = static_cast<Entry const*>(next);
+              callback(current->ptr);
+              ++total;
+
+              uint64_t nextIndex = current->next;
+
+              if (nextIndex == INVALID_INDEX) {
+                next = nullptr;
+                break;
+              }
+
+              next = &_table[nextIndex];
+            }
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up an element given an element
+////////////////////////////////////////////////////////////////////////////////
+
+        ELEMENT* lookup (ELEMENT const* element) const {
+          return _table[lookupByElement(element)].ptr;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes an element from the array, returns the removed element
+/// or a null pointer if it was not found
+////////////////////////////////////////////////////////////////////////////////
+
+        ELEMENT* remove (ELEMENT const* element) {
+          uint64_t i = lookupByElement(element);
+
+          if (_table[i].ptr == nullptr) {
+            return nullptr;
+          }
+
+          ELEMENT* old = _table[i].ptr;
+
+          if (_table[i].prev == INVALID_INDEX) {
+            // this is the first in its linked list
+            uint64_t j = _table[i].next;
+
+            if (j == INVALID_INDEX) {
+              // the only one in its linked list, simply remove it and heal
+              // the hole
+              invalidateEntry(i);
+              healHole(i);
+              _nrUnique--;
+            }
+            else {
+              // there is at least one successor in position j
+              _table[j].prev = INVALID_INDEX;
+              moveEntry(j, i);
+              healHole(j);
+              _nrDuplicate--;
+            }
+          }
+          else {
+            // this one is not the first in its linked list
+            uint64_t j = _table[i].prev;
+            _table[j].next = _table[i].next;
+            j = _table[i].next;
+
+            if (j != INVALID_INDEX) {
+              // we are not the last in the linked list
+              _table[j].prev = _table[i].prev;
+            }
+
+            invalidateEntry(i);
+            healHole(i);
+            _nrDuplicate--;
+          }
+
+          _nrUsed--;
+
+          return old;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief resizes the array so that it can take size elements
+////////////////////////////////////////////////////////////////////////////////
+
+        int resize (size_t size) {
+          if (! resizeInternal(2 * (uint64_t) size + 1)) {
+            return TRI_ERROR_OUT_OF_MEMORY;
+          }
+
+          return TRI_ERROR_NO_ERROR;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief allocates a zero-filled table, including the alignment slack
+////////////////////////////////////////////////////////////////////////////////
+
+        Entry* allocateTable (uint64_t size) {
+          return static_cast<Entry*>(TRI_Allocate(_memoryZone, (size_t) size * sizeof(Entry) + 64, true));
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finds the head of the linked list for a key, or a free slot
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t findKeyHead (KEY const* key) const {
+          uint64_t i = _desc.hashKey(key) % _nrAlloc;
+
+          while (_table[i].ptr != nullptr &&
+                 (_table[i].prev != INVALID_INDEX ||
+                  ! _desc.isEqualKeyElement(key, _table[i].ptr))) {
+            i = TRI_IncModU64(i, _nrAlloc);
+          }
+
+          return i;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finds an element or its place using the element hash function
+///
+/// This either finds a place to store the element or an entry in the table
+/// that is equal to it. If checkEquality is not set, the caller guarantees
+/// that there is no equal entry in the table.
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t findElementPlace (ELEMENT const* element,
+                                   bool checkEquality) const {
+          uint64_t i = _desc.hashElement(element, false) % _nrAlloc;
+
+          while (_table[i].ptr != nullptr &&
+                 (! checkEquality ||
+                  ! _desc.isEqualElementElement(element, _table[i].ptr, false))) {
+            i = TRI_IncModU64(i, _nrAlloc);
+          }
+
+          return i;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief finds an element or its place by key and element identity
+///
+/// The slot returned is either empty or contains an element that compares
+/// equal to the element.
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t lookupByElement (ELEMENT const* element) const {
+          uint64_t i = _desc.hashElement(element, true) % _nrAlloc;
+
+          // now find the first slot with an entry with the same key that is
+          // the start of a linked list, or a free slot
+          while (_table[i].ptr != nullptr &&
+                 (_table[i].prev != INVALID_INDEX ||
+                  ! _desc.isEqualElementElement(element, _table[i].ptr, true))) {
+            i = TRI_IncModU64(i, _nrAlloc);
+          }
+
+          if (_table[i].ptr != nullptr) {
+            // it might be right here
+            if (_desc.isEqualElementElement(element, _table[i].ptr, false)) {
+              return i;
+            }
+
+            // now we have to look for it in its hash position, we have
+            // either found an equal element or nothing
+            return findElementPlace(element, true);
+          }
+
+          // if we get here, no element with the same key is in the array, so
+          // we will not be able to find it anywhere
+          return i;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not x is behind from and before or equal to to in the
+/// cyclic order
+///
+/// If x is equal to from, then the result is always false. If from is equal
+/// to to, then the result is always true.
+////////////////////////////////////////////////////////////////////////////////
+
+        static inline bool isBetween (uint64_t from, uint64_t x, uint64_t to) {
+          return (from < to) ? (from < x && x <= to)
+                             : (x > from || x <= to);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief invalidates a slot
+////////////////////////////////////////////////////////////////////////////////
+
+        inline void invalidateEntry (uint64_t i) {
+          _table[i].ptr = nullptr;
+          _table[i].next = INVALID_INDEX;
+          _table[i].prev = INVALID_INDEX;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief moves an entry from one slot to another
+///
+/// Adjusts the linked lists, but does not take care of the hole. to must be
+/// unused, from can be any element in a linked list.
+////////////////////////////////////////////////////////////////////////////////
+
+        inline void moveEntry (uint64_t from, uint64_t to) {
+          _table[to] = _table[from];
+
+          if (_table[to].prev != INVALID_INDEX) {
+            _table[_table[to].prev].next = to;
+          }
+
+          if (_table[to].next != INVALID_INDEX) {
+            _table[_table[to].next].prev = to;
+          }
+
+          invalidateEntry(from);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief heals a hole where we deleted something
+////////////////////////////////////////////////////////////////////////////////
+
+        void healHole (uint64_t i) {
+          uint64_t j = TRI_IncModU64(i, _nrAlloc);
+
+          while (_table[j].ptr != nullptr) {
+            // find out where this element ought to be. if it is the start of
+            // one of the linked lists, we need to hash by key, otherwise, we
+            // hash by the full identity of the element
+            uint64_t k = _desc.hashElement(_table[j].ptr, _table[j].prev == INVALID_INDEX) % _nrAlloc;
+
+            if (! isBetween(i, k, j)) {
+              // we have to move j to i, and heal the hole at j afterwards
+              moveEntry(j, i);
+              i = j;
+            }
+
+            j = TRI_IncModU64(j, _nrAlloc);
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief resizes the table to a prime near the given size
+////////////////////////////////////////////////////////////////////////////////
+
+        bool resizeInternal (uint64_t size) {
+          Entry* oldTableAlloc = _tableAlloc;
+          Entry* oldTable = _table;
+          uint64_t oldAlloc = _nrAlloc;
+
+          uint64_t newAlloc = TRI_NearPrime(size);
+          Entry* newTableAlloc = allocateTable(newAlloc);
+
+          if (newTableAlloc == nullptr) {
+            return false;
+          }
+
+          _tableAlloc = newTableAlloc;
+          _table = static_cast<Entry*>(TRI_Align64(newTableAlloc));
+          _nrAlloc = newAlloc;
+          _nrUsed = 0;
+          _nrUnique = 0;
+          _nrDuplicate = 0;
+
+          // table is already cleared by allocate, copy old data
+          for (uint64_t j = 0; j < oldAlloc; j++) {
+            if (oldTable[j].ptr != nullptr) {
+              insert(oldTable[j].ptr, true, false);
+            }
+          }
+
+          TRI_Free(_memoryZone, oldTableAlloc);
+
+          return true;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the description, hash and comparison functions
+////////////////////////////////////////////////////////////////////////////////
+
+        DESC _desc;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the memory zone of the table
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_memory_zone_t* _memoryZone;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the allocated table, _table is this pointer aligned to 64 bytes
+////////////////////////////////////////////////////////////////////////////////
+
+        Entry* _tableAlloc;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the table itself, aligned to a cache line
+////////////////////////////////////////////////////////////////////////////////
+
+        Entry* _table;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the size of the table
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _nrAlloc;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the number of used entries
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _nrUsed;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the number of distinct keys
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _nrUnique;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the number of elements that share their key with an earlier one
+////////////////////////////////////////////////////////////////////////////////
+
+        uint64_t _nrDuplicate;
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
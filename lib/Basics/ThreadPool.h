@@ -75,6 +75,14 @@ namespace triagens {
           return _name.c_str();
         }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the number of worker threads
+////////////////////////////////////////////////////////////////////////////////
+
+        size_t size () const {
+          return _threads.size();
+        }
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief dequeue a task
 ////////////////////////////////////////////////////////////////////////////////
@@ -35,6 +35,7 @@
 #include "Basics/tri-strings.h"
 
 #include <sys/mman.h>
+#include <unistd.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 // @brief flush memory mapped file to disk
@@ -162,6 +163,71 @@ int TRI_ProtectMMFile (void* memoryAddress,
   return TRI_ERROR_SYS_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// @brief give an access pattern hint for a region in a memory-mapped file
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_AdviseMMFile (void* memoryAddress,
+                      size_t numOfBytes,
+                      int advice) {
+  int result = madvise(memoryAddress, numOfBytes, advice);
+
+  if (result == 0) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  return TRI_ERROR_SYS_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// @brief count the resident bytes of a region in a memory-mapped file
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_ResidentMMFile (void* memoryAddress,
+                        size_t numOfBytes,
+                        size_t* result) {
+  size_t const pageSize = (size_t) getpagesize();
+  size_t const numPages = (numOfBytes + pageSize - 1) / pageSize;
+
+  *result = 0;
+
+  if (numPages == 0) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+#ifdef __linux__
+  typedef unsigned char vec_t;
+#else
+  typedef char vec_t;
+#endif
+
+  vec_t* vec = static_cast<vec_t*>(TRI_Allocate(TRI_UNKNOWN_MEM_ZONE, numPages, false));
+
+  if (vec == nullptr) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  if (mincore(memoryAddress, numOfBytes, vec) != 0) {
+    TRI_Free(TRI_UNKNOWN_MEM_ZONE, vec);
+    return TRI_ERROR_SYS_ERROR;
+  }
+
+  size_t resident = 0;
+
+  for (size_t i = 0; i < numPages; ++i) {
+    if ((vec[i] & 1) != 0) {
+      ++resident;
+    }
+  }
+
+  TRI_Free(TRI_UNKNOWN_MEM_ZONE, vec);
+
+  resident *= pageSize;
+  *result = (resident > numOfBytes ? numOfBytes : resident);
+
+  return TRI_ERROR_NO_ERROR;
+}
+
 #endif
 
 // -----------------------------------------------------------------------------
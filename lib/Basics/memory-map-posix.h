@@ -49,6 +49,28 @@
 #define TRI_MMAP_ANONYMOUS MAP_ANON
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief flag for populating the page tables of a mapping when it is created
+///
+/// only available on Linux, ignored elsewhere
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef MAP_POPULATE
+#define TRI_MMAP_POPULATE MAP_POPULATE
+#else
+#define TRI_MMAP_POPULATE 0
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief access pattern hints for TRI_AdviseMMFile
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_MADVISE_NORMAL     MADV_NORMAL
+#define TRI_MADVISE_SEQUENTIAL MADV_SEQUENTIAL
+#define TRI_MADVISE_RANDOM     MADV_RANDOM
+#define TRI_MADVISE_WILLNEED   MADV_WILLNEED
+#define TRI_MADVISE_DONTNEED   MADV_DONTNEED
+
 #endif
 
 #endif
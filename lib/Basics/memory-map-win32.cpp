@@ -329,6 +329,18 @@ int TRI_ProtectMMFile(void* memoryAddress,  size_t numOfBytesToProtect, int flag
 }
 
 
+int TRI_AdviseMMFile (void* memoryAddress, size_t numOfBytes, int advice) {
+  // access pattern hints are not supported, so there is nothing to do
+  return TRI_ERROR_NO_ERROR;
+}
+
+
+int TRI_ResidentMMFile (void* memoryAddress, size_t numOfBytes, size_t* result) {
+  *result = 0;
+  return TRI_ERROR_NOT_IMPLEMENTED;
+}
+
+
 #endif
 
 // -----------------------------------------------------------------------------
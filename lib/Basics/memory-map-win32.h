@@ -75,6 +75,19 @@
 #define PROT_GROWSDOWN  0x01000000      /* Extend change to start of growsdown vma (mprotect only).  */
 #define PROT_GROWSUP    0x02000000      /* Extend change to start of growsup vma (mprotect only).  */
 
+////////////////////////////////////////////////////////////////////////////////
+// Dummy flags for populating mappings and for access pattern hints, which are
+// ignored under windows.
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_MMAP_POPULATE      0
+
+#define TRI_MADVISE_NORMAL     0
+#define TRI_MADVISE_SEQUENTIAL 1
+#define TRI_MADVISE_RANDOM     2
+#define TRI_MADVISE_WILLNEED   3
+#define TRI_MADVISE_DONTNEED   4
+
 #endif
 
 #endif
@@ -111,6 +111,25 @@ int TRI_ProtectMMFile (void* memoryAddress,
                        int fileDescriptor,
                        void** mmHandle);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief gives the kernel a hint about the access pattern of a region
+///
+/// advice is one of the TRI_MADVISE_* values. The hint is ignored on
+/// platforms that do not support it
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_AdviseMMFile (void* memoryAddress,
+                      size_t numOfBytes,
+                      int advice);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the number of bytes of a region that are in memory
+////////////////////////////////////////////////////////////////////////////////
+
+int TRI_ResidentMMFile (void* memoryAddress,
+                        size_t numOfBytes,
+                        size_t* result);
+
 #endif
 
 // -----------------------------------------------------------------------------
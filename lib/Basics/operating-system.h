@@ -303,6 +303,7 @@
 #define TRI_HAVE_LINUX_SOCKETS              1
 #define TRI_HAVE_POSIX_SPIN                 1
 #define TRI_HAVE_POSIX_THREADS              1
+#define TRI_HAVE_POSIX_FALLOCATE            1
 #define TRI_HAVE_POSIX_MMAP                 1
 #define TRI_HAVE_POSIX_PWD_GRP              1
 
@@ -473,6 +474,7 @@
 #define TRI_HAVE_LINUX_SOCKETS              1
 #define TRI_HAVE_POSIX_SPIN                 1
 #define TRI_HAVE_POSIX_THREADS              1
+#define TRI_HAVE_POSIX_FALLOCATE            1
 #define TRI_HAVE_POSIX_MMAP                 1
 #define TRI_HAVE_POSIX_PWD_GRP              1
 
@@ -34,6 +34,7 @@ void TRI_InitialiseErrorMessages () {
   REG_ERROR(ERROR_IP_ADDRESS_INVALID, "IP address is invalid");
   REG_ERROR(ERROR_LEGEND_NOT_IN_WAL_FILE, "internal error if a legend for a marker does not yet exist in the same WAL file");
   REG_ERROR(ERROR_FILE_EXISTS, "file exists");
+  REG_ERROR(ERROR_V8_CONTEXT_TIMEOUT, "timeout waiting for a V8 context");
   REG_ERROR(ERROR_HTTP_BAD_PARAMETER, "bad parameter");
   REG_ERROR(ERROR_HTTP_UNAUTHORIZED, "unauthorized");
   REG_ERROR(ERROR_HTTP_FORBIDDEN, "forbidden");
@@ -117,6 +118,7 @@ void TRI_InitialiseErrorMessages () {
   REG_ERROR(ERROR_REPLICATION_RUNNING, "cannot change applier configuration while running");
   REG_ERROR(ERROR_REPLICATION_APPLIER_STOPPED, "replication stopped");
   REG_ERROR(ERROR_REPLICATION_NO_START_TICK, "no start tick");
+  REG_ERROR(ERROR_REPLICATION_KEYS_SNAPSHOT_NOT_FOUND, "keys snapshot not found");
   REG_ERROR(ERROR_CLUSTER_NO_AGENCY, "could not connect to agency");
   REG_ERROR(ERROR_CLUSTER_NO_COORDINATOR_HEADER, "missing coordinator header");
   REG_ERROR(ERROR_CLUSTER_COULD_NOT_LOCK_PLAN, "could not lock plan in agency");
@@ -208,6 +210,9 @@ void TRI_InitialiseErrorMessages () {
   REG_ERROR(ERROR_KEYVALUE_KEY_NOT_CHANGED, "key value not changed");
   REG_ERROR(ERROR_KEYVALUE_KEY_NOT_REMOVED, "key value not removed");
   REG_ERROR(ERROR_KEYVALUE_NO_VALUE, "missing value");
+  REG_ERROR(ERROR_KEYVALUE_KEYSPACE_NOT_FOUND, "keyspace not found");
+  REG_ERROR(ERROR_KEYVALUE_KEYSPACE_EXISTS, "keyspace already exists");
+  REG_ERROR(ERROR_KEYVALUE_TYPE_MISMATCH, "key value has wrong type");
   REG_ERROR(ERROR_TASK_INVALID_ID, "invalid task id");
   REG_ERROR(ERROR_TASK_DUPLICATE_ID, "duplicate task id");
   REG_ERROR(ERROR_TASK_NOT_FOUND, "task not found");
@@ -66,6 +66,9 @@
 ///   the user.
 /// - 27: @LIT{file exists}
 ///   Will be raised when a file already exists.
+/// - 28: @LIT{timeout waiting for a V8 context}
+///   Will be raised when no V8 context becomes available within the maximum
+///   wait time.
 /// - 400: @LIT{bad parameter}
 ///   Will be raised when the HTTP request does not fulfill the requirements.
 /// - 401: @LIT{unauthorized}
@@ -270,6 +273,9 @@
 /// - 1413: @LIT{no start tick}
 ///   Will be raised when the replication error is started without a known
 ///   start tick value.
+/// - 1414: @LIT{keys snapshot not found}
+///   Will be raised when the keys snapshot requested for an incremental
+///   synchronisation does not exist or has expired.
 /// - 1450: @LIT{could not connect to agency}
 ///   Will be raised when none of the agency servers can be connected to.
 /// - 1451: @LIT{missing coordinator header}
@@ -511,6 +517,13 @@
 ///   Will be raised when deleting a key/value pair does not work
 /// - 1806: @LIT{missing value}
 ///   Will be raised when the value is missing
+/// - 1807: @LIT{keyspace not found}
+///   Will be raised when the specified keyspace is not found
+/// - 1808: @LIT{keyspace already exists}
+///   Will be raised when a keyspace is to be created that already exists
+/// - 1809: @LIT{key value has wrong type}
+///   Will be raised when an operation is applied to a key whose value has an
+///   incompatible type
 /// - 1850: @LIT{invalid task id}
 ///   Will be raised when a task is created with an invalid id.
 /// - 1851: @LIT{duplicate task id}
@@ -951,6 +964,17 @@ void TRI_InitialiseErrorMessages ();
 
 #define TRI_ERROR_FILE_EXISTS                                             (27)
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 28: ERROR_V8_CONTEXT_TIMEOUT
+///
+/// timeout waiting for a V8 context
+///
+/// Will be raised when no V8 context becomes available within the maximum
+/// wait time.
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_ERROR_V8_CONTEXT_TIMEOUT                                      (28)
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief 400: ERROR_HTTP_BAD_PARAMETER
 ///
@@ -1813,6 +1837,17 @@ void TRI_InitialiseErrorMessages ();
 
 #define TRI_ERROR_REPLICATION_NO_START_TICK                               (1413)
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 1414: ERROR_REPLICATION_KEYS_SNAPSHOT_NOT_FOUND
+///
+/// keys snapshot not found
+///
+/// Will be raised when the keys snapshot requested for an incremental
+/// synchronisation does not exist or has expired.
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_ERROR_REPLICATION_KEYS_SNAPSHOT_NOT_FOUND                     (1414)
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief 1450: ERROR_CLUSTER_NO_AGENCY
 ///
@@ -2778,6 +2813,37 @@ void TRI_InitialiseErrorMessages ();
 
 #define TRI_ERROR_KEYVALUE_NO_VALUE                                       (1806)
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 1807: ERROR_KEYVALUE_KEYSPACE_NOT_FOUND
+///
+/// keyspace not found
+///
+/// Will be raised when the specified keyspace is not found
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND                             (1807)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 1808: ERROR_KEYVALUE_KEYSPACE_EXISTS
+///
+/// keyspace already exists
+///
+/// Will be raised when a keyspace is to be created that already exists
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_ERROR_KEYVALUE_KEYSPACE_EXISTS                                (1808)
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief 1809: ERROR_KEYVALUE_TYPE_MISMATCH
+///
+/// key value has wrong type
+///
+/// Will be raised when an operation is applied to a key whose value has an
+/// incompatible type
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_ERROR_KEYVALUE_TYPE_MISMATCH                                  (1809)
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief 1850: ERROR_TASK_INVALID_ID
 ///
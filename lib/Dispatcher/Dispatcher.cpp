@@ -212,6 +212,8 @@ int Dispatcher::addJob (Job* job) {
     return TRI_ERROR_QUEUE_UNKNOWN;
   }
 
+  RequestStatisticsAgentSetQueue(job, name);
+
   // log success, but do this BEFORE the real add, because the addJob might execute
   // and delete the job before we have a chance to log something
   LOG_TRACE("added job %p to queue '%s'", (void*) job, name.c_str());
@@ -965,6 +965,11 @@ void HttpCommTask::processRequest (uint32_t compatibility) {
   // check for an async request
   string const& asyncExecution = _request->header("x-arango-async", found);
 
+  // the handler factory has set the prefix of the handler path by now
+  RequestStatisticsAgentSetEndpoint(this,
+                                    _request->databaseName(),
+                                    _request->prefix()[0] == '\0' ? string("/") : string(_request->prefix()));
+
   // clear request object
   _request = nullptr;
   RequestStatisticsAgent::transfer(handler);
@@ -205,6 +205,8 @@ HttpResponse::HttpResponseCode HttpResponse::responseCode (int code) {
     case TRI_ERROR_CLUSTER_MUST_NOT_CHANGE_SHARDING_ATTRIBUTES:
     case TRI_ERROR_CLUSTER_MUST_NOT_SPECIFY_KEY: 
     case TRI_ERROR_TYPE_ERROR: 
+    case TRI_ERROR_KEYVALUE_INVALID_KEY:
+    case TRI_ERROR_KEYVALUE_TYPE_MISMATCH:
       return BAD;
     
     case TRI_ERROR_ARANGO_READ_ONLY:
@@ -213,6 +215,8 @@ HttpResponse::HttpResponseCode HttpResponse::responseCode (int code) {
     case TRI_ERROR_ARANGO_COLLECTION_NOT_FOUND:
     case TRI_ERROR_ARANGO_DOCUMENT_NOT_FOUND:
     case TRI_ERROR_CURSOR_NOT_FOUND:
+    case TRI_ERROR_KEYVALUE_KEY_NOT_FOUND:
+    case TRI_ERROR_KEYVALUE_KEYSPACE_NOT_FOUND:
       return NOT_FOUND;
 
     case TRI_ERROR_REQUEST_CANCELED:
@@ -222,6 +226,8 @@ HttpResponse::HttpResponseCode HttpResponse::responseCode (int code) {
     case TRI_ERROR_ARANGO_CONFLICT:
     case TRI_ERROR_ARANGO_GEO_INDEX_VIOLATED:
     case TRI_ERROR_CURSOR_BUSY:
+    case TRI_ERROR_KEYVALUE_KEY_EXISTS:
+    case TRI_ERROR_KEYVALUE_KEYSPACE_EXISTS:
       return CONFLICT;
 
     case TRI_ERROR_ARANGO_OUT_OF_KEYS:
@@ -0,0 +1,1048 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief single-pass parser from JSON text to shaped json
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "ShapedJsonParser.h"
+
+#include "Basics/tri-strings.h"
+
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief reserved top-level attributes, as bits
+////////////////////////////////////////////////////////////////////////////////
+
+enum {
+  ReservedKey  = 1,
+  ReservedRev  = 2,
+  ReservedId   = 4,
+  ReservedFrom = 8,
+  ReservedTo   = 16
+};
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief check whether an attribute name is a reserved top-level attribute
+////////////////////////////////////////////////////////////////////////////////
+
+static int ReservedAttribute (std::string const& name) {
+  if (name == "_key") {
+    return ReservedKey;
+  }
+  if (name == "_rev") {
+    return ReservedRev;
+  }
+  if (name == "_id") {
+    return ReservedId;
+  }
+  if (name == "_from") {
+    return ReservedFrom;
+  }
+  if (name == "_to") {
+    return ReservedTo;
+  }
+
+  return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the text starts with a keyword, ignoring case
+////////////////////////////////////////////////////////////////////////////////
+
+static bool IsKeyword (char const* p,
+                       char const* end,
+                       char const* keyword,
+                       size_t length) {
+  return (static_cast<size_t>(end - p) >= length &&
+          TRI_CaseEqualString2(p, keyword, length));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether the character is a digit
+////////////////////////////////////////////////////////////////////////////////
+
+static inline bool IsDigit (char c) {
+  return (c >= '0' && c <= '9');
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a parser for the shaper
+////////////////////////////////////////////////////////////////////////////////
+
+ShapedJsonParser::ShapedJsonParser (TRI_shaper_t* shaper)
+  : _shaper(shaper),
+    _pos(nullptr),
+    _end(nullptr),
+    _errorCode(TRI_ERROR_NO_ERROR),
+    _message(nullptr),
+    _data(),
+    _values(),
+    _aids(),
+    _buffer(),
+    _key(),
+    _from(),
+    _to(),
+    _hasKey(false),
+    _validKey(false),
+    _hasFrom(false),
+    _hasTo(false) {
+
+  _shaped._sid = 0;
+  _shaped._data.length = 0;
+  _shaped._data.data = nullptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the parser
+////////////////////////////////////////////////////////////////////////////////
+
+ShapedJsonParser::~ShapedJsonParser () {
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a document
+////////////////////////////////////////////////////////////////////////////////
+
+int ShapedJsonParser::parse (char const* text,
+                             size_t length) {
+  _pos       = text;
+  _end       = text + length;
+  _errorCode = TRI_ERROR_NO_ERROR;
+  _message   = nullptr;
+
+  _data.clear();
+  _values.clear();
+
+  _hasKey    = false;
+  _validKey  = false;
+  _hasFrom   = false;
+  _hasTo     = false;
+
+  _shaped._sid = 0;
+  _shaped._data.length = 0;
+  _shaped._data.data = nullptr;
+
+  skipWhitespace();
+
+  // only objects are shaped. anything else is still validated, so invalid
+  // JSON is reported as such
+  bool const isObject = (_pos < _end && *_pos == '{');
+
+  try {
+    if (! parseValue(0, true, ! isObject)) {
+      return _errorCode;
+    }
+  }
+  catch (std::bad_alloc const&) {
+    return TRI_ERROR_OUT_OF_MEMORY;
+  }
+
+  skipWhitespace();
+
+  if (_pos < _end) {
+    fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "failed to parse json object: expecting EOF");
+    return _errorCode;
+  }
+
+  if (! isObject) {
+    return TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID;
+  }
+
+  TRI_ASSERT(_values.size() == 1);
+  TRI_ASSERT(_data.size() == _values[0]._size);
+
+  _shaped._sid = _values[0]._sid;
+  _shaped._data.length = (uint32_t) _values[0]._size;
+  _shaped._data.data = _data.data();
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the _key attribute of the document
+////////////////////////////////////////////////////////////////////////////////
+
+int ShapedJsonParser::key (char const** key) const {
+  *key = nullptr;
+
+  if (! _hasKey) {
+    return TRI_ERROR_NO_ERROR;
+  }
+
+  if (! _validKey) {
+    // _key is there but not a string
+    return TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD;
+  }
+
+  *key = _key.c_str();
+
+  return TRI_ERROR_NO_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skip whitespace
+////////////////////////////////////////////////////////////////////////////////
+
+void ShapedJsonParser::skipWhitespace () {
+  while (_pos < _end &&
+         (*_pos == ' ' || *_pos == '\t' || *_pos == '\r' || *_pos == '\n')) {
+    ++_pos;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief register an error, always returns false
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::fail (int code,
+                             char const* message) {
+  _errorCode = code;
+  _message = message;
+
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a value, and push its shape value unless it is skipped
+///
+/// skipped values are validated only. they are neither shaped nor do they
+/// create attributes or shapes
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::parseValue (size_t level,
+                                   bool checkDuplicates,
+                                   bool skip) {
+  skipWhitespace();
+
+  if (_pos >= _end) {
+    return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expecting atom, got end-of-file");
+  }
+
+  switch (*_pos) {
+    case '{':
+      ++_pos;
+      return parseObject(level, checkDuplicates, skip);
+
+    case '[':
+      ++_pos;
+      return parseList(level, skip);
+
+    case '"':
+      if (! parseString(_buffer)) {
+        return false;
+      }
+
+      if (! skip) {
+        pushString(_buffer);
+      }
+      return true;
+
+    case '}':
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expected object, got '}'");
+
+    case ']':
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expected object, got ']'");
+
+    case ',':
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expected object, got ','");
+
+    case ':':
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expected object, got ':'");
+
+    case '-':
+    case '+':
+    case '0':
+    case '1':
+    case '2':
+    case '3':
+    case '4':
+    case '5':
+    case '6':
+    case '7':
+    case '8':
+    case '9': {
+      double value;
+
+      if (! parseNumber(value)) {
+        return false;
+      }
+
+      if (! skip) {
+        TRI_shape_number_t const number = value;
+        char* ptr = pushValue(TRI_SHAPE_NUMBER, BasicShapes::TRI_SHAPE_SID_NUMBER, true, sizeof(TRI_shape_number_t));
+        memcpy(ptr, &number, sizeof(TRI_shape_number_t));
+      }
+      return true;
+    }
+  }
+
+  // keywords are matched case-insensitively, as in the JSON parser
+  if (IsKeyword(_pos, _end, "null", 4)) {
+    _pos += 4;
+
+    if (! skip) {
+      pushValue(TRI_SHAPE_NULL, BasicShapes::TRI_SHAPE_SID_NULL, true, 0);
+    }
+    return true;
+  }
+
+  bool const isTrue = IsKeyword(_pos, _end, "true", 4);
+
+  if (isTrue || IsKeyword(_pos, _end, "false", 5)) {
+    _pos += (isTrue ? 4 : 5);
+
+    if (! skip) {
+      TRI_shape_boolean_t const value = (isTrue ? 1 : 0);
+      char* ptr = pushValue(TRI_SHAPE_BOOLEAN, BasicShapes::TRI_SHAPE_SID_BOOLEAN, true, sizeof(TRI_shape_boolean_t));
+      memcpy(ptr, &value, sizeof(TRI_shape_boolean_t));
+    }
+    return true;
+  }
+
+  return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expected object, got unquoted string");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse an object
+///
+/// duplicate attribute names are detected in the same objects as by
+/// TRI_HasDuplicateKeyJson, i.e. not in objects contained in lists
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::parseObject (size_t level,
+                                    bool checkDuplicates,
+                                    bool skip) {
+  size_t const base = _values.size();
+  size_t const dataStart = _data.size();
+
+  bool comma = false;
+  bool hasEmpty = false;
+  int reserved = 0;
+
+  while (true) {
+    skipWhitespace();
+
+    if (_pos >= _end) {
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expecting a object attribute name or element, got end-of-file");
+    }
+
+    if (*_pos == '}') {
+      ++_pos;
+      break;
+    }
+
+    if (comma) {
+      if (*_pos != ',') {
+        return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expecting comma");
+      }
+
+      ++_pos;
+      skipWhitespace();
+    }
+    else {
+      comma = true;
+    }
+
+    // attribute name
+    if (_pos >= _end || *_pos != '"') {
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expecting attribute name");
+    }
+
+    if (! parseString(_buffer)) {
+      return false;
+    }
+
+    // followed by a colon
+    skipWhitespace();
+
+    if (_pos >= _end || *_pos != ':') {
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expecting colon");
+    }
+
+    ++_pos;
+
+    if (skip) {
+      if (! parseValue(level + 1, false, true)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (_buffer.empty()) {
+      // empty attribute names are validated but not shaped
+      if (checkDuplicates) {
+        if (hasEmpty) {
+          return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "duplicate attribute name");
+        }
+        hasEmpty = true;
+      }
+
+      if (! parseValue(level + 1, false, true)) {
+        return false;
+      }
+      continue;
+    }
+
+    if (level == 0 && _buffer[0] == '_') {
+      int const which = ReservedAttribute(_buffer);
+
+      if (which != 0) {
+        // on top level, reserved attributes are not shaped
+        if (reserved & which) {
+          return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "duplicate attribute name");
+        }
+        reserved |= which;
+
+        skipWhitespace();
+
+        if (_pos < _end && *_pos == '"') {
+          std::string& target = (which == ReservedKey ? _key : which == ReservedFrom ? _from : which == ReservedTo ? _to : _buffer);
+
+          if (! parseString(target)) {
+            return false;
+          }
+
+          _hasKey   |= (which == ReservedKey);
+          _validKey |= (which == ReservedKey);
+          _hasFrom  |= (which == ReservedFrom);
+          _hasTo    |= (which == ReservedTo);
+        }
+        else {
+          if (! parseValue(level + 1, false, true)) {
+            return false;
+          }
+
+          _hasKey |= (which == ReservedKey);
+        }
+        continue;
+      }
+    }
+
+    // first find an identifier for the name
+    TRI_shape_aid_t const aid = _shaper->findOrCreateAttributeByName(_shaper, _buffer.c_str());
+
+    if (aid == 0) {
+      return fail(TRI_ERROR_ARANGO_SHAPER_FAILED, "cannot create attribute");
+    }
+
+    if (! parseValue(level + 1, checkDuplicates, false)) {
+      return false;
+    }
+
+    _values.back()._aid = aid;
+  }
+
+  if (skip) {
+    return true;
+  }
+
+  return composeObject(base, dataStart, checkDuplicates);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a list
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::parseList (size_t level,
+                                  bool skip) {
+  size_t const base = _values.size();
+  size_t const dataStart = _data.size();
+
+  bool comma = false;
+
+  while (true) {
+    skipWhitespace();
+
+    if (_pos >= _end) {
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expecting a list element, got end-of-file");
+    }
+
+    if (*_pos == ']') {
+      ++_pos;
+      break;
+    }
+
+    if (comma) {
+      if (*_pos != ',') {
+        return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expecting comma");
+      }
+
+      ++_pos;
+    }
+    else {
+      comma = true;
+    }
+
+    if (! parseValue(level + 1, false, skip)) {
+      return false;
+    }
+  }
+
+  if (skip) {
+    return true;
+  }
+
+  return composeList(base, dataStart);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a string into a buffer
+///
+/// strings without escape sequences and non-ASCII characters are copied,
+/// all others are unescaped and normalized like in the JSON parser
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::parseString (std::string& result) {
+  TRI_ASSERT(*_pos == '"');
+
+  char const* start = ++_pos;
+  bool simple = true;
+
+  while (true) {
+    if (_pos >= _end) {
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "unterminated string");
+    }
+
+    char const c = *_pos;
+
+    if (c == '"') {
+      break;
+    }
+
+    if (c == '\\') {
+      simple = false;
+      ++_pos;
+
+      if (_pos >= _end || *_pos == '\n') {
+        return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "unterminated string");
+      }
+    }
+    else if (static_cast<unsigned char>(c) >= 0x80) {
+      simple = false;
+    }
+
+    ++_pos;
+  }
+
+  size_t const length = static_cast<size_t>(_pos - start);
+  ++_pos;
+
+  if (simple) {
+    result.assign(start, length);
+    return true;
+  }
+
+  size_t outLength;
+  char* unescaped = TRI_UnescapeUtf8StringZ(TRI_UNKNOWN_MEM_ZONE, start, length, &outLength);
+
+  if (unescaped == nullptr) {
+    return fail(TRI_ERROR_OUT_OF_MEMORY, "out-of-memory");
+  }
+
+  try {
+    result.assign(unescaped, outLength);
+  }
+  catch (...) {
+    TRI_FreeString(TRI_UNKNOWN_MEM_ZONE, unescaped);
+    throw;
+  }
+
+  TRI_FreeString(TRI_UNKNOWN_MEM_ZONE, unescaped);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a number
+///
+/// accepts the same grammar as the JSON parser, including a leading plus sign
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::parseNumber (double& result) {
+  char const* start = _pos;
+
+  if (*_pos == '-' || *_pos == '+') {
+    ++_pos;
+  }
+
+  if (_pos >= _end || ! IsDigit(*_pos)) {
+    return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "expected object, got unquoted string");
+  }
+
+  if (*_pos == '0') {
+    ++_pos;
+  }
+  else {
+    while (_pos < _end && IsDigit(*_pos)) {
+      ++_pos;
+    }
+  }
+
+  // fraction
+  if (_pos + 1 < _end && *_pos == '.' && IsDigit(_pos[1])) {
+    _pos += 2;
+
+    while (_pos < _end && IsDigit(*_pos)) {
+      ++_pos;
+    }
+  }
+
+  // exponent
+  if (_pos < _end && (*_pos == 'e' || *_pos == 'E')) {
+    char const* p = _pos + 1;
+
+    if (p < _end && (*p == '-' || *p == '+')) {
+      ++p;
+    }
+
+    if (p < _end && IsDigit(*p)) {
+      while (p < _end && IsDigit(*p)) {
+        ++p;
+      }
+      _pos = p;
+    }
+  }
+
+  size_t const length = static_cast<size_t>(_pos - start);
+
+  if (length >= 512) {
+    return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "number too big");
+  }
+
+  // the text is not null-terminated after the number
+  char number[512];
+  memcpy(number, start, length);
+  number[length] = '\0';
+
+  // need to reset errno because return value of 0 is not distinguishable from an error on Linux
+  errno = 0;
+
+  char* ep;
+  result = strtod(number, &ep);
+
+  if (result == HUGE_VAL && errno == ERANGE) {
+    return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "number too big");
+  }
+
+  if (result == 0 && errno == ERANGE) {
+    return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "number too small");
+  }
+
+  if (ep != number + length) {
+    return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "cannot parse number");
+  }
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a new value to the arena and return its data
+///
+/// the data is zero-filled
+////////////////////////////////////////////////////////////////////////////////
+
+char* ShapedJsonParser::pushValue (TRI_shape_type_t type,
+                                   TRI_shape_sid_t sid,
+                                   bool fixedSized,
+                                   TRI_shape_size_t size) {
+  size_t const offset = _data.size();
+
+  TRI_shape_value_t value;
+  value._aid = 0;
+  value._sid = sid;
+  value._type = type;
+  value._fixedSized = fixedSized;
+  value._size = size;
+  value._value = nullptr;
+
+  _values.push_back(value);
+  _data.resize(offset + static_cast<size_t>(size));
+
+  return _data.data() + offset;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief push a string value
+////////////////////////////////////////////////////////////////////////////////
+
+void ShapedJsonParser::pushString (std::string const& value) {
+  // the length includes the trailing null byte
+  size_t const length = value.size() + 1;
+
+  if (length <= TRI_SHAPE_SHORT_STRING_CUT) {
+    TRI_shape_length_short_string_t const l = static_cast<TRI_shape_length_short_string_t>(length);
+    char* ptr = pushValue(TRI_SHAPE_SHORT_STRING,
+                          BasicShapes::TRI_SHAPE_SID_SHORT_STRING,
+                          true,
+                          sizeof(TRI_shape_length_short_string_t) + TRI_SHAPE_SHORT_STRING_CUT);
+
+    memcpy(ptr, &l, sizeof(TRI_shape_length_short_string_t));
+    memcpy(ptr + sizeof(TRI_shape_length_short_string_t), value.c_str(), length);
+  }
+  else {
+    TRI_shape_length_long_string_t const l = static_cast<TRI_shape_length_long_string_t>(length);
+    char* ptr = pushValue(TRI_SHAPE_LONG_STRING,
+                          BasicShapes::TRI_SHAPE_SID_LONG_STRING,
+                          false,
+                          sizeof(TRI_shape_length_long_string_t) + length);
+
+    memcpy(ptr, &l, sizeof(TRI_shape_length_long_string_t));
+    memcpy(ptr + sizeof(TRI_shape_length_long_string_t), value.c_str(), length);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace the values of an object by the object
+///
+/// builds the same shape and data as FillShapeValueArray. The data of the
+/// object is built behind the data of its values and then moved to the place
+/// of the values
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::composeObject (size_t base,
+                                      size_t dataStart,
+                                      bool checkDuplicates) {
+  size_t const n = _values.size() - base;
+
+  if (checkDuplicates && n > 1) {
+    _aids.clear();
+
+    for (size_t i = base;  i < _values.size();  ++i) {
+      _aids.push_back(_values[i]._aid);
+    }
+
+    std::sort(_aids.begin(), _aids.end());
+
+    if (std::adjacent_find(_aids.begin(), _aids.end()) != _aids.end()) {
+      return fail(TRI_ERROR_HTTP_CORRUPTED_JSON, "duplicate attribute name");
+    }
+  }
+
+  uint64_t total = 0;
+  size_t f = 0;
+  size_t v = 0;
+
+  for (size_t i = base;  i < _values.size();  ++i) {
+    total += _values[i]._size;
+
+    if (_values[i]._fixedSized) {
+      ++f;
+    }
+    else {
+      ++v;
+    }
+  }
+
+  // add variable offset table size
+  total += (v + 1) * sizeof(TRI_shape_size_t);
+
+  // the arena does not grow while the values point into it
+  size_t const target = _data.size();
+  _data.resize(target + static_cast<size_t>(total));
+
+  TRI_shape_value_t* values = _values.data() + base;
+  char* src = _data.data() + dataStart;
+
+  for (size_t i = 0;  i < n;  ++i) {
+    values[i]._value = src;
+    src += values[i]._size;
+  }
+
+  if (n > 1) {
+    TRI_SortShapeValues(values, n);
+  }
+
+  // generate shape structure
+  size_t const byteSize =
+    sizeof(TRI_array_shape_t)
+    + n * sizeof(TRI_shape_sid_t)
+    + n * sizeof(TRI_shape_aid_t)
+    + (f + 1) * sizeof(TRI_shape_size_t);
+
+  char* ptr = static_cast<char*>(TRI_Allocate(_shaper->_memoryZone, byteSize, true));
+
+  if (ptr == nullptr) {
+    return fail(TRI_ERROR_OUT_OF_MEMORY, "out-of-memory");
+  }
+
+  TRI_array_shape_t* a = reinterpret_cast<TRI_array_shape_t*>(ptr);
+
+  a->base._type = TRI_SHAPE_ARRAY;
+  a->base._size = byteSize;
+  a->base._dataSize = (v == 0) ? total : TRI_SHAPE_SIZE_VARIABLE;
+
+  a->_fixedEntries = f;
+  a->_variableEntries = v;
+
+  ptr += sizeof(TRI_array_shape_t);
+
+  TRI_shape_sid_t* sids = reinterpret_cast<TRI_shape_sid_t*>(ptr);
+  ptr += n * sizeof(TRI_shape_sid_t);
+
+  TRI_shape_aid_t* aids = reinterpret_cast<TRI_shape_aid_t*>(ptr);
+  ptr += n * sizeof(TRI_shape_aid_t);
+
+  TRI_shape_size_t* offsetsF = reinterpret_cast<TRI_shape_size_t*>(ptr);
+
+  // the data in the arena is not aligned, so the offsets of the variable part
+  // are copied into it
+  char* offsetsV = _data.data() + target;
+  char* dst = offsetsV + (v + 1) * sizeof(TRI_shape_size_t);
+
+  TRI_shape_size_t offset = (v + 1) * sizeof(TRI_shape_size_t);
+  bool fixedSized = true;
+
+  for (size_t i = 0;  i < n;  ++i) {
+    TRI_shape_value_t const* p = values + i;
+
+    *aids++ = p->_aid;
+    *sids++ = p->_sid;
+
+    memcpy(dst, p->_value, static_cast<size_t>(p->_size));
+    dst += p->_size;
+
+    fixedSized &= p->_fixedSized;
+
+    if (p->_fixedSized) {
+      *offsetsF++ = offset;
+      offset += p->_size;
+      *offsetsF = offset;
+    }
+    else {
+      memcpy(offsetsV, &offset, sizeof(TRI_shape_size_t));
+      offsetsV += sizeof(TRI_shape_size_t);
+      offset += p->_size;
+      memcpy(offsetsV, &offset, sizeof(TRI_shape_size_t));
+    }
+  }
+
+  TRI_shape_t const* found = findShape(&a->base);
+
+  if (found == nullptr) {
+    return false;
+  }
+
+  memmove(_data.data() + dataStart, _data.data() + target, static_cast<size_t>(total));
+  _data.resize(dataStart + static_cast<size_t>(total));
+
+  _values.resize(base);
+
+  TRI_shape_value_t value;
+  value._aid = 0;
+  value._sid = found->_sid;
+  value._type = TRI_SHAPE_ARRAY;
+  value._fixedSized = fixedSized;
+  value._size = total;
+  value._value = nullptr;
+
+  _values.push_back(value);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace the values of a list by the list
+///
+/// builds the same shape and data as FillShapeValueList. As the data of the
+/// values is stored in list order, it is copied as a whole
+////////////////////////////////////////////////////////////////////////////////
+
+bool ShapedJsonParser::composeList (size_t base,
+                                    size_t dataStart) {
+  size_t const n = _values.size() - base;
+
+  // check for special case "empty list"
+  if (n == 0) {
+    TRI_ASSERT(_data.size() == dataStart);
+
+    pushValue(TRI_SHAPE_LIST, BasicShapes::TRI_SHAPE_SID_LIST, false, sizeof(TRI_shape_length_list_t));
+    return true;
+  }
+
+  // check if this list is homogeneous
+  TRI_shape_sid_t const s = _values[base]._sid;
+  TRI_shape_size_t const l = _values[base]._size;
+
+  bool hs = true;
+  bool hl = true;
+  uint64_t total = 0;
+
+  for (size_t i = base;  i < _values.size();  ++i) {
+    total += _values[i]._size;
+
+    if (_values[i]._sid != s) {
+      hs = false;
+    }
+    else if (_values[i]._size != l) {
+      hl = false;
+    }
+  }
+
+  TRI_shape_length_list_t const length = static_cast<TRI_shape_length_list_t>(n);
+  TRI_shape_t const* found;
+  TRI_shape_size_t size;
+  TRI_shape_size_t offset;
+
+  // homogeneous sized
+  if (hs && hl) {
+    auto shape = static_cast<TRI_homogeneous_sized_list_shape_t*>(TRI_Allocate(_shaper->_memoryZone, sizeof(TRI_homogeneous_sized_list_shape_t), true));
+
+    if (shape == nullptr) {
+      return fail(TRI_ERROR_OUT_OF_MEMORY, "out-of-memory");
+    }
+
+    shape->base._size = sizeof(TRI_homogeneous_sized_list_shape_t);
+    shape->base._type = TRI_SHAPE_HOMOGENEOUS_SIZED_LIST;
+    shape->base._dataSize = TRI_SHAPE_SIZE_VARIABLE;
+    shape->_sidEntry = s;
+    shape->_sizeEntry = l;
+
+    found = findShape(&shape->base);
+    offset = sizeof(TRI_shape_length_list_t);
+    size = offset + total;
+  }
+
+  // homogeneous
+  else if (hs) {
+    auto shape = static_cast<TRI_homogeneous_list_shape_t*>(TRI_Allocate(_shaper->_memoryZone, sizeof(TRI_homogeneous_list_shape_t), true));
+
+    if (shape == nullptr) {
+      return fail(TRI_ERROR_OUT_OF_MEMORY, "out-of-memory");
+    }
+
+    shape->base._size = sizeof(TRI_homogeneous_list_shape_t);
+    shape->base._type = TRI_SHAPE_HOMOGENEOUS_LIST;
+    shape->base._dataSize = TRI_SHAPE_SIZE_VARIABLE;
+    shape->_sidEntry = s;
+
+    found = findShape(&shape->base);
+    offset = sizeof(TRI_shape_length_list_t) + (n + 1) * sizeof(TRI_shape_size_t);
+    size = offset + total;
+  }
+
+  // in-homogeneous
+  else {
+    found = TRI_LookupSidBasicShapeShaper(BasicShapes::TRI_SHAPE_SID_LIST);
+    offset =
+      sizeof(TRI_shape_length_list_t)
+      + n * sizeof(TRI_shape_sid_t)
+      + (n + 1) * sizeof(TRI_shape_size_t);
+    size = offset + total;
+  }
+
+  if (found == nullptr) {
+    return false;
+  }
+
+  size_t const target = _data.size();
+  _data.resize(target + static_cast<size_t>(size));
+
+  char* ptr = _data.data() + target;
+  memcpy(ptr, &length, sizeof(TRI_shape_length_list_t));
+  ptr += sizeof(TRI_shape_length_list_t);
+
+  if (! (hs && hl)) {
+    if (! hs) {
+      // shape identifiers
+      for (size_t i = base;  i < _values.size();  ++i) {
+        memcpy(ptr, &_values[i]._sid, sizeof(TRI_shape_sid_t));
+        ptr += sizeof(TRI_shape_sid_t);
+      }
+    }
+
+    // offsets
+    for (size_t i = base;  i < _values.size();  ++i) {
+      memcpy(ptr, &offset, sizeof(TRI_shape_size_t));
+      ptr += sizeof(TRI_shape_size_t);
+      offset += _values[i]._size;
+    }
+
+    memcpy(ptr, &offset, sizeof(TRI_shape_size_t));
+    ptr += sizeof(TRI_shape_size_t);
+  }
+
+  // the values are stored in list order already
+  memcpy(ptr, _data.data() + dataStart, static_cast<size_t>(total));
+
+  memmove(_data.data() + dataStart, _data.data() + target, static_cast<size_t>(size));
+  _data.resize(dataStart + static_cast<size_t>(size));
+
+  _values.resize(base);
+
+  TRI_shape_value_t value;
+  value._aid = 0;
+  value._sid = found->_sid;
+  value._type = found->_type;
+  value._fixedSized = false;
+  value._size = size;
+  value._value = nullptr;
+
+  _values.push_back(value);
+
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up a shape, the shape is freed in any case
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_shape_t const* ShapedJsonParser::findShape (TRI_shape_t* shape) {
+  // note: if 'found' is not a nullptr, the shaper will have freed the shape
+  TRI_shape_t const* found = _shaper->findShape(_shaper, shape, true);
+
+  if (found == nullptr) {
+    TRI_Free(_shaper->_memoryZone, shape);
+    fail(TRI_ERROR_ARANGO_SHAPER_FAILED, "cannot create shape");
+  }
+
+  return found;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
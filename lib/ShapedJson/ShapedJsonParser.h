@@ -0,0 +1,354 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief single-pass parser from JSON text to shaped json
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Jan Steemann
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+/// @author Copyright 2012-2013, triAGENS GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_SHAPED_JSON_SHAPED_JSON_PARSER_H
+#define ARANGODB_SHAPED_JSON_SHAPED_JSON_PARSER_H 1
+
+#include "Basics/Common.h"
+#include "ShapedJson/json-shaper.h"
+#include "ShapedJson/shaped-json.h"
+
+namespace triagens {
+  namespace basics {
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                            class ShapedJsonParser
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parses a JSON document directly into shaped json
+///
+/// The parser produces the same shapes and data as parsing the text into a
+/// TRI_json_t and calling TRI_ShapedJsonJson, but without building the
+/// intermediate tree. Attribute names are resolved through the shaper while
+/// parsing, and the shaped data of all values is built in an arena that is
+/// kept between calls, so a parser used for many documents does not allocate
+/// memory for their data once the arena is large enough.
+///
+/// As in TRI_ShapedJsonJson, the system attributes _key, _rev, _id, _from
+/// and _to are stripped from the top-level object. The values of _key, _from
+/// and _to are made available separately.
+////////////////////////////////////////////////////////////////////////////////
+
+    class ShapedJsonParser {
+
+      ShapedJsonParser (ShapedJsonParser const&) = delete;
+      ShapedJsonParser& operator= (ShapedJsonParser const&) = delete;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                        constructors / destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief create a parser for the shaper
+////////////////////////////////////////////////////////////////////////////////
+
+        explicit ShapedJsonParser (TRI_shaper_t*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief destroy the parser
+////////////////////////////////////////////////////////////////////////////////
+
+        ~ShapedJsonParser ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a document
+///
+/// Returns TRI_ERROR_HTTP_CORRUPTED_JSON if the text is not valid JSON or an
+/// object contains an attribute more than once,
+/// TRI_ERROR_ARANGO_DOCUMENT_TYPE_INVALID if it is valid JSON but not an
+/// object, and TRI_ERROR_ARANGO_SHAPER_FAILED if an attribute or shape
+/// cannot be created. The results of a previous call are invalidated.
+////////////////////////////////////////////////////////////////////////////////
+
+        int parse (char const*,
+                   size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the shaped document, valid until the next call to parse
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_shaped_json_t const* shaped () const {
+          return &_shaped;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the _key attribute of the document
+///
+/// the key is set to a nullptr if the document has no _key attribute.
+/// Returns TRI_ERROR_ARANGO_DOCUMENT_KEY_BAD if the attribute is not a string
+////////////////////////////////////////////////////////////////////////////////
+
+        int key (char const**) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the _from attribute, or a nullptr if it is not a string
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* from () const {
+          return _hasFrom ? _from.c_str() : nullptr;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the _to attribute, or a nullptr if it is not a string
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* to () const {
+          return _hasTo ? _to.c_str() : nullptr;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief return the reason why the text could not be parsed
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* errorMessage () const {
+          return _message;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief skip whitespace
+////////////////////////////////////////////////////////////////////////////////
+
+        void skipWhitespace ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief register an error, always returns false
+////////////////////////////////////////////////////////////////////////////////
+
+        bool fail (int,
+                   char const*);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a value, and push its shape value unless it is skipped
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseValue (size_t,
+                         bool,
+                         bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse an object
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseObject (size_t,
+                          bool,
+                          bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a list
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseList (size_t,
+                        bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a string into a buffer
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseString (std::string&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief parse a number
+////////////////////////////////////////////////////////////////////////////////
+
+        bool parseNumber (double&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief append a new value to the arena and return its data
+////////////////////////////////////////////////////////////////////////////////
+
+        char* pushValue (TRI_shape_type_t,
+                         TRI_shape_sid_t,
+                         bool,
+                         TRI_shape_size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief push a string value
+////////////////////////////////////////////////////////////////////////////////
+
+        void pushString (std::string const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace the values of an object by the object
+////////////////////////////////////////////////////////////////////////////////
+
+        bool composeObject (size_t,
+                            size_t,
+                            bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief replace the values of a list by the list
+////////////////////////////////////////////////////////////////////////////////
+
+        bool composeList (size_t,
+                          size_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief look up a shape, the shape is freed in any case
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_shape_t const* findShape (TRI_shape_t*);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the shaper
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_shaper_t* _shaper;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief current parse position
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* _pos;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief end of the text
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* _end;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief error code
+////////////////////////////////////////////////////////////////////////////////
+
+        int _errorCode;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief error message
+////////////////////////////////////////////////////////////////////////////////
+
+        char const* _message;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief arena for the data of all values. The data of the values on the
+/// value stack is stored in stack order, without gaps
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<char> _data;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief value stack, holding the values of all unfinished objects and lists
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_shape_value_t> _values;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief attribute ids of an object, used to find duplicates
+////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TRI_shape_aid_t> _aids;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief buffer for strings and attribute names
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _buffer;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the _key attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _key;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the _from attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _from;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the _to attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        std::string _to;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the document has a _key attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _hasKey;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the _key attribute is a string
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _validKey;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the document has a string _from attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _hasFrom;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the document has a string _to attribute
+////////////////////////////////////////////////////////////////////////////////
+
+        bool _hasTo;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the result
+////////////////////////////////////////////////////////////////////////////////
+
+        TRI_shaped_json_t _shaped;
+    };
+
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
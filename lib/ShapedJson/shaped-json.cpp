@@ -1573,7 +1573,10 @@ static bool StringifyJsonShapeDataArray (TRI_shaper_t* shaper,
                                          char const* data,
                                          uint64_t size,
                                          bool braces,
-                                         uint64_t* num) {
+                                         uint64_t* num,
+                                         TRI_shaped_json_filter_t filter = nullptr,
+                                         void* filterData = nullptr,
+                                         bool first = true) {
   TRI_array_shape_t const* s;
   TRI_shape_aid_t const* aids;
   TRI_shape_sid_t const* sids;
@@ -1584,7 +1587,6 @@ static bool StringifyJsonShapeDataArray (TRI_shaper_t* shaper,
   TRI_shape_size_t n;
   TRI_shape_size_t v;
   shape_cache_t shapeCache;
-  bool first;
   char const* qtr;
   int res;
 
@@ -1592,7 +1594,6 @@ static bool StringifyJsonShapeDataArray (TRI_shaper_t* shaper,
   f = s->_fixedEntries;
   v = s->_variableEntries;
   n = f + v;
-  first = true;
 
   if (num != nullptr) {
     *num = n;
@@ -1654,6 +1655,10 @@ static bool StringifyJsonShapeDataArray (TRI_shaper_t* shaper,
       continue;
     }
 
+    if (filter != nullptr && ! filter(name, filterData)) {
+      continue;
+    }
+
     if (first) {
       first = false;
     }
@@ -1726,6 +1731,10 @@ static bool StringifyJsonShapeDataArray (TRI_shaper_t* shaper,
       continue;
     }
 
+    if (filter != nullptr && ! filter(name, filterData)) {
+      continue;
+    }
+
     if (first) {
       first = false;
     }
@@ -2274,6 +2283,85 @@ bool TRI_StringifyAugmentedShapedJson (TRI_shaper_t* shaper,
   return true;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prints a shaped json object to a string buffer, with additional
+/// string attributes in front of the attributes of the shaped json
+///
+/// attributes contains numAttributes pairs of attribute names and values. if
+/// a filter is given, only the attributes for which it returns true are
+/// printed. this writes the object in a single pass, without creating an
+/// intermediate json
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_StringifyObjectShapedJson (TRI_shaper_t* shaper,
+                                    TRI_string_buffer_t* buffer,
+                                    TRI_shaped_json_t const* shaped,
+                                    char const* const* attributes,
+                                    size_t numAttributes,
+                                    TRI_shaped_json_filter_t filter,
+                                    void* filterData) {
+  TRI_shape_t const* shape = shaper->lookupShapeId(shaper, shaped->_sid);
+
+  if (shape == nullptr || shape->_type != TRI_SHAPE_ARRAY) {
+    return false;
+  }
+
+  int res = TRI_AppendCharStringBuffer(buffer, '{');
+
+  if (res != TRI_ERROR_NO_ERROR) {
+    return false;
+  }
+
+  bool first = true;
+
+  for (size_t i = 0; i < numAttributes; ++i) {
+    char const* name  = attributes[2 * i];
+    char const* value = attributes[2 * i + 1];
+
+    if (filter != nullptr && ! filter(name, filterData)) {
+      continue;
+    }
+
+    if (first) {
+      first = false;
+    }
+    else {
+      res = TRI_AppendCharStringBuffer(buffer, ',');
+    }
+
+    if (res == TRI_ERROR_NO_ERROR) {
+      res = TRI_AppendCharStringBuffer(buffer, '"');
+    }
+    if (res == TRI_ERROR_NO_ERROR) {
+      res = TRI_AppendJsonEncodedStringStringBuffer(buffer, name, true);
+    }
+    if (res == TRI_ERROR_NO_ERROR) {
+      res = TRI_AppendString2StringBuffer(buffer, "\":\"", 3);
+    }
+    if (res == TRI_ERROR_NO_ERROR) {
+      res = TRI_AppendJsonEncodedStringStringBuffer(buffer, value, false);
+    }
+    if (res == TRI_ERROR_NO_ERROR) {
+      res = TRI_AppendCharStringBuffer(buffer, '"');
+    }
+
+    if (res != TRI_ERROR_NO_ERROR) {
+      return false;
+    }
+  }
+
+  uint64_t num;
+  bool ok = StringifyJsonShapeDataArray(shaper, buffer, shape, shaped->_data.data, shaped->_data.length, false, &num, filter, filterData, first);
+
+  if (! ok) {
+    return false;
+  }
+
+  res = TRI_AppendCharStringBuffer(buffer, '}');
+
+  return (res == TRI_ERROR_NO_ERROR);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief returns the length of a list
 ////////////////////////////////////////////////////////////////////////////////
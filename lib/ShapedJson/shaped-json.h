@@ -268,6 +268,13 @@ typedef uint32_t TRI_shape_length_long_string_t;
 
 typedef uint32_t TRI_shape_length_list_t;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief filter for attribute names when printing shaped json, returns
+/// whether or not the attribute should be printed
+////////////////////////////////////////////////////////////////////////////////
+
+typedef bool (*TRI_shaped_json_filter_t) (char const*, void*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief base class for json shape
 ////////////////////////////////////////////////////////////////////////////////
@@ -984,6 +991,19 @@ bool TRI_StringifyAugmentedShapedJson (struct TRI_shaper_s* shaper,
                                        TRI_shaped_json_t const*,
                                        TRI_json_t const*);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief prints a shaped json object to a string buffer, with additional
+/// string attributes in front of the attributes of the shaped json
+////////////////////////////////////////////////////////////////////////////////
+
+bool TRI_StringifyObjectShapedJson (struct TRI_shaper_s*,
+                                    struct TRI_string_buffer_s*,
+                                    TRI_shaped_json_t const*,
+                                    char const* const*,
+                                    size_t,
+                                    TRI_shaped_json_filter_t,
+                                    void*);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief returns the length of a list
 ////////////////////////////////////////////////////////////////////////////////
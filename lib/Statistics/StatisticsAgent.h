@@ -263,6 +263,52 @@ namespace triagens {
 
 #endif
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the endpoint for the latency histograms
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef TRI_ENABLE_FIGURES
+
+#define RequestStatisticsAgentSetEndpoint(a,b,c)                                      \
+  do {                                                                                \
+    if (TRI_ENABLE_STATISTICS) {                                                      \
+      if ((a)->RequestStatisticsAgent::_statistics != nullptr) {                      \
+        (a)->RequestStatisticsAgent::_statistics->_endpoint =                         \
+          TRI_LookupEndpointLatencyStatistics(b, c);                                  \
+      }                                                                               \
+    }                                                                                 \
+  }                                                                                   \
+  while (0)
+
+#else
+
+#define RequestStatisticsAgentSetEndpoint(a,b,c) while (0)
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sets the dispatcher queue for the latency histograms
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef TRI_ENABLE_FIGURES
+
+#define RequestStatisticsAgentSetQueue(a,b)                                           \
+  do {                                                                                \
+    if (TRI_ENABLE_STATISTICS) {                                                      \
+      if ((a)->RequestStatisticsAgent::_statistics != nullptr) {                      \
+        (a)->RequestStatisticsAgent::_statistics->_queue =                            \
+          TRI_LookupQueueLatencyStatistics(b);                                        \
+      }                                                                               \
+    }                                                                                 \
+  }                                                                                   \
+  while (0)
+
+#else
+
+#define RequestStatisticsAgentSetQueue(a,b) while (0)
+
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief sets the async flag
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,260 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief high resolution latency histograms
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "histogram.h"
+
+using namespace triagens::basics;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief next shard to hand out to a thread
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<size_t> NextShard(0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief shard of the current thread, plus one (zero means unassigned)
+////////////////////////////////////////////////////////////////////////////////
+
+static thread_local size_t ThreadShard = 0;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                 struct StatisticsHistogramSnapshot
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates an empty snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+StatisticsHistogramSnapshot::StatisticsHistogramSnapshot ()
+  : _count(0),
+    _total(0),
+    _min(0),
+    _max(0),
+    _counts(StatisticsHistogram::BucketCount, 0) {
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief adds the values of another snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+void StatisticsHistogramSnapshot::merge (StatisticsHistogramSnapshot const& other) {
+  if (other._count == 0) {
+    return;
+  }
+
+  if (_count == 0 || other._min < _min) {
+    _min = other._min;
+  }
+
+  if (other._max > _max) {
+    _max = other._max;
+  }
+
+  _count += other._count;
+  _total += other._total;
+
+  for (size_t i = 0;  i < _counts.size();  ++i) {
+    _counts[i] += other._counts[i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the value at or below which the given fraction lies
+////////////////////////////////////////////////////////////////////////////////
+
+uint64_t StatisticsHistogramSnapshot::percentile (double fraction) const {
+  if (_count == 0) {
+    return 0;
+  }
+
+  if (fraction >= 1.0) {
+    return _max;
+  }
+
+  uint64_t wanted = static_cast<uint64_t>(fraction * static_cast<double>(_count) + 0.5);
+
+  if (wanted == 0) {
+    wanted = 1;
+  }
+
+  uint64_t seen = 0;
+
+  for (size_t i = 0;  i < _counts.size();  ++i) {
+    seen += _counts[i];
+
+    if (seen >= wanted) {
+      uint64_t value = StatisticsHistogram::bucketUpperBound(i);
+
+      // the exact extremes are known, so never report a value outside them
+      if (value > _max) {
+        return _max;
+      }
+
+      if (value < _min) {
+        return _min;
+      }
+
+      return value;
+    }
+  }
+
+  // not reached for snapshots taken from a histogram, because addValue()
+  // increases the count only after the bucket
+  return _max;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the mean value
+////////////////////////////////////////////////////////////////////////////////
+
+double StatisticsHistogramSnapshot::mean () const {
+  if (_count == 0) {
+    return 0.0;
+  }
+
+  return static_cast<double>(_total) / static_cast<double>(_count);
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                           class StatisticsHistogram
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                      constructors and destructors
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief creates an empty histogram
+////////////////////////////////////////////////////////////////////////////////
+
+StatisticsHistogram::StatisticsHistogram () {
+  for (size_t i = 0;  i < NumberShards;  ++i) {
+    Shard& shard = _shards[i];
+
+    shard._count.store(0, std::memory_order_relaxed);
+    shard._total.store(0, std::memory_order_relaxed);
+    shard._min.store(UINT64_MAX, std::memory_order_relaxed);
+    shard._max.store(0, std::memory_order_relaxed);
+
+    for (size_t j = 0;  j < BucketCount;  ++j) {
+      shard._counts[j].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief records a duration given in microseconds
+////////////////////////////////////////////////////////////////////////////////
+
+void StatisticsHistogram::addValue (uint64_t value) {
+  Shard& shard = _shards[shardIndex()];
+
+  shard._counts[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  shard._total.fetch_add(value, std::memory_order_relaxed);
+
+  uint64_t current = shard._min.load(std::memory_order_relaxed);
+
+  while (value < current &&
+         ! shard._min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+
+  current = shard._max.load(std::memory_order_relaxed);
+
+  while (value > current &&
+         ! shard._max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+
+  // increase the count last, so that a reader never sees more values than
+  // have been put into the buckets
+  shard._count.fetch_add(1, std::memory_order_release);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sums up all shards
+////////////////////////////////////////////////////////////////////////////////
+
+StatisticsHistogramSnapshot StatisticsHistogram::snapshot () const {
+  StatisticsHistogramSnapshot result;
+
+  for (size_t i = 0;  i < NumberShards;  ++i) {
+    Shard const& shard = _shards[i];
+    uint64_t count = shard._count.load(std::memory_order_acquire);
+
+    if (count == 0) {
+      continue;
+    }
+
+    StatisticsHistogramSnapshot part;
+
+    part._count = count;
+    part._total = shard._total.load(std::memory_order_relaxed);
+    part._min = shard._min.load(std::memory_order_relaxed);
+    part._max = shard._max.load(std::memory_order_relaxed);
+
+    for (size_t j = 0;  j < BucketCount;  ++j) {
+      part._counts[j] = shard._counts[j].load(std::memory_order_relaxed);
+    }
+
+    result.merge(part);
+  }
+
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the shard of the calling thread
+////////////////////////////////////////////////////////////////////////////////
+
+size_t StatisticsHistogram::shardIndex () {
+  if (ThreadShard == 0) {
+    ThreadShard = (NextShard.fetch_add(1, std::memory_order_relaxed) % NumberShards) + 1;
+  }
+
+  return ThreadShard - 1;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -0,0 +1,255 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief high resolution latency histograms
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_STATISTICS_HISTOGRAM_H
+#define ARANGODB_STATISTICS_HISTOGRAM_H 1
+
+#include "Basics/Common.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                      public types
+// -----------------------------------------------------------------------------
+
+namespace triagens {
+  namespace basics {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a point-in-time copy of a histogram
+///
+/// all values are in microseconds
+////////////////////////////////////////////////////////////////////////////////
+
+    struct StatisticsHistogramSnapshot {
+      StatisticsHistogramSnapshot ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief adds the values of another snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+      void merge (StatisticsHistogramSnapshot const&);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the value at or below which the given fraction of all
+/// values lies, e.g. 0.999 for the 99.9th percentile
+////////////////////////////////////////////////////////////////////////////////
+
+      uint64_t percentile (double) const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the mean value
+////////////////////////////////////////////////////////////////////////////////
+
+      double mean () const;
+
+      uint64_t _count;
+      uint64_t _total;
+      uint64_t _min;
+      uint64_t _max;
+      std::vector<uint64_t> _counts;
+    };
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief a log-linear histogram of durations
+///
+/// Values are recorded in microseconds. Values below SubBucketCount are
+/// counted exactly, larger values fall into buckets whose width doubles with
+/// each power of two, giving a relative error of at most 1 / (SubBucketCount
+/// / 2) over the whole range. Recording is lock-free: each thread picks one of
+/// NumberShards shards and increments its counters with relaxed atomics, so
+/// concurrent request threads do not contend on a single cache line. Readers
+/// sum up the shards in snapshot().
+////////////////////////////////////////////////////////////////////////////////
+
+    class StatisticsHistogram {
+      StatisticsHistogram (StatisticsHistogram const&) = delete;
+      StatisticsHistogram& operator= (StatisticsHistogram const&) = delete;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   public constants
+// -----------------------------------------------------------------------------
+
+      public:
+
+        static size_t const SubBucketBits = 6;
+        static size_t const SubBucketCount = (1 << SubBucketBits);
+        static size_t const SubBucketHalfCount = SubBucketCount / 2;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of halvings before a value drops below SubBucketCount,
+/// values needing more are counted in the last bucket (about 76 hours)
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t const MaxShift = 32;
+
+        static size_t const BucketCount = SubBucketCount + MaxShift * SubBucketHalfCount;
+
+        static size_t const NumberShards = 4;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                      constructors and destructors
+// -----------------------------------------------------------------------------
+
+      public:
+
+        StatisticsHistogram ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                    public methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief records a duration given in seconds
+////////////////////////////////////////////////////////////////////////////////
+
+        void addFigure (double seconds) {
+          if (seconds <= 0.0) {
+            addValue(0);
+          }
+          else {
+            addValue(static_cast<uint64_t>(seconds * 1000000.0 + 0.5));
+          }
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief records a duration given in microseconds
+////////////////////////////////////////////////////////////////////////////////
+
+        void addValue (uint64_t);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief sums up all shards
+////////////////////////////////////////////////////////////////////////////////
+
+        StatisticsHistogramSnapshot snapshot () const;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the bucket for a value
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t bucketIndex (uint64_t value) {
+          if (value < SubBucketCount) {
+            return static_cast<size_t>(value);
+          }
+
+          size_t shift = 0;
+
+          while (value >= SubBucketCount) {
+            value >>= 1;
+            ++shift;
+          }
+
+          if (shift > MaxShift) {
+            return BucketCount - 1;
+          }
+
+          return SubBucketCount +
+                 (shift - 1) * SubBucketHalfCount +
+                 static_cast<size_t>(value - SubBucketHalfCount);
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the smallest value counted in a bucket
+////////////////////////////////////////////////////////////////////////////////
+
+        static uint64_t bucketLowerBound (size_t index) {
+          if (index < SubBucketCount) {
+            return static_cast<uint64_t>(index);
+          }
+
+          index -= SubBucketCount;
+          size_t shift = index / SubBucketHalfCount + 1;
+          uint64_t sub = index % SubBucketHalfCount + SubBucketHalfCount;
+
+          return sub << shift;
+        }
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the largest value counted in a bucket
+////////////////////////////////////////////////////////////////////////////////
+
+        static uint64_t bucketUpperBound (size_t index) {
+          if (index < SubBucketCount) {
+            return static_cast<uint64_t>(index);
+          }
+
+          if (index == BucketCount - 1) {
+            return UINT64_MAX;
+          }
+
+          return bucketLowerBound(index + 1) - 1;
+        }
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private methods
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the shard of the calling thread
+////////////////////////////////////////////////////////////////////////////////
+
+        static size_t shardIndex ();
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+      private:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief per-thread-group counters, padded so that the hot header fields
+/// of different shards never share a cache line
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Shard {
+          char _padding[64];
+          std::atomic<uint64_t> _count;
+          std::atomic<uint64_t> _total;
+          std::atomic<uint64_t> _min;
+          std::atomic<uint64_t> _max;
+          std::atomic<uint64_t> _counts[BucketCount];
+        };
+
+        Shard _shards[NumberShards];
+    };
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
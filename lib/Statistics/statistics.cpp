@@ -30,6 +30,8 @@
 #include "statistics.h"
 #include "Basics/Mutex.h"
 #include "Basics/MutexLocker.h"
+#include "Basics/ReadLocker.h"
+#include "Basics/WriteLocker.h"
 
 #ifndef BSD
 #ifdef __FreeBSD__
@@ -61,6 +63,174 @@ static triagens::basics::Mutex RequestListLock;
 
 static TRI_statistics_list_t RequestFreeList;
 
+// -----------------------------------------------------------------------------
+// --SECTION--                              private latency statistics variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lock for the latency entries
+////////////////////////////////////////////////////////////////////////////////
+
+static triagens::basics::ReadWriteLock LatencyLock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief latency entries of the endpoints, keyed by database and path
+////////////////////////////////////////////////////////////////////////////////
+
+static std::unordered_map<std::string, TRI_latency_statistics_t*> LatencyEndpoints;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief latency entry shared by all endpoints beyond the limit
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_latency_statistics_t* LatencyOverflow = nullptr;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief latency entries of the dispatcher queues, keyed by name
+////////////////////////////////////////////////////////////////////////////////
+
+static std::unordered_map<std::string, TRI_latency_statistics_t*> LatencyQueues;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                              private latency statistics functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief records the times of a finished request
+////////////////////////////////////////////////////////////////////////////////
+
+static void AddLatencyFigures (TRI_latency_statistics_t* latency,
+                               TRI_request_statistics_t const* statistics) {
+  if (latency == nullptr) {
+    return;
+  }
+
+  double totalTime = statistics->_writeEnd - statistics->_readStart;
+  double requestTime = statistics->_requestEnd - statistics->_requestStart;
+  double queueTime = 0.0;
+
+  if (statistics->_queueStart != 0.0 && statistics->_queueEnd != 0.0) {
+    queueTime = statistics->_queueEnd - statistics->_queueStart;
+    latency->_queueTime.addFigure(queueTime);
+  }
+
+  latency->_requestTime.addFigure(requestTime);
+
+  double ioTime = totalTime - requestTime - queueTime;
+
+  if (ioTime >= 0.0) {
+    latency->_ioTime.addFigure(ioTime);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief looks up or creates an entry, the caller must not hold the lock
+////////////////////////////////////////////////////////////////////////////////
+
+static TRI_latency_statistics_t* LookupLatency (std::unordered_map<std::string, TRI_latency_statistics_t*>& entries,
+                                                std::string const& key,
+                                                std::string const& database,
+                                                std::string const& path,
+                                                bool limited) {
+  {
+    READ_LOCKER(LatencyLock);
+
+    auto it = entries.find(key);
+
+    if (it != entries.end()) {
+      return (*it).second;
+    }
+
+    if (limited && entries.size() >= TRI_MAX_LATENCY_ENDPOINTS && LatencyOverflow != nullptr) {
+      return LatencyOverflow;
+    }
+  }
+
+  WRITE_LOCKER(LatencyLock);
+
+  // someone else might have been faster
+  auto it = entries.find(key);
+
+  if (it != entries.end()) {
+    return (*it).second;
+  }
+
+  if (limited && entries.size() >= TRI_MAX_LATENCY_ENDPOINTS) {
+    if (LatencyOverflow == nullptr) {
+      LatencyOverflow = new TRI_latency_statistics_t();
+      LatencyOverflow->_path = "*";
+    }
+
+    return LatencyOverflow;
+  }
+
+  TRI_latency_statistics_t* latency = new TRI_latency_statistics_t();
+  latency->_database = database;
+  latency->_path = path;
+
+  try {
+    entries.emplace(key, latency);
+  }
+  catch (...) {
+    delete latency;
+    return nullptr;
+  }
+
+  return latency;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                               public latency statistics functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the latency histograms of an endpoint
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_latency_statistics_t* TRI_LookupEndpointLatencyStatistics (std::string const& database,
+                                                               std::string const& path) {
+  std::string key;
+  key.reserve(database.size() + path.size() + 1);
+  key.append(database);
+  key.push_back('\0');
+  key.append(path);
+
+  return LookupLatency(LatencyEndpoints, key, database, path, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the latency histograms of a dispatcher queue
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_latency_statistics_t* TRI_LookupQueueLatencyStatistics (std::string const& queue) {
+  return LookupLatency(LatencyQueues, queue, "", queue, false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all known endpoint and queue entries
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FillLatencyStatistics (std::vector<TRI_latency_statistics_t const*>& endpoints,
+                                std::vector<TRI_latency_statistics_t const*>& queues) {
+  READ_LOCKER(LatencyLock);
+
+  endpoints.reserve(LatencyEndpoints.size() + 1);
+
+  for (auto const& it : LatencyEndpoints) {
+    endpoints.push_back(it.second);
+  }
+
+  if (LatencyOverflow != nullptr) {
+    endpoints.push_back(LatencyOverflow);
+  }
+
+  queues.reserve(LatencyQueues.size());
+
+  for (auto const& it : LatencyQueues) {
+    queues.push_back(it.second);
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                               public request statistics functions
 // -----------------------------------------------------------------------------
@@ -89,12 +259,21 @@ TRI_request_statistics_t* TRI_AcquireRequestStatistics () {
 ////////////////////////////////////////////////////////////////////////////////
 
 void TRI_ReleaseRequestStatistics (TRI_request_statistics_t* statistics) {
-  MUTEX_LOCKER(RequestListLock);
-
   if (statistics == nullptr) {
     return;
   }
 
+  // the latency histograms are lock-free, so fill them before taking the lock
+  if (! statistics->_ignore &&
+      statistics->_readStart != 0.0 &&
+      statistics->_writeEnd != 0.0 &&
+      (statistics->_endpoint != nullptr || statistics->_queue != nullptr)) {
+    AddLatencyFigures(statistics->_endpoint, statistics);
+    AddLatencyFigures(statistics->_queue, statistics);
+  }
+
+  MUTEX_LOCKER(RequestListLock);
+
   if (! statistics->_ignore) {
     TRI_TotalRequestsStatistics.incCounter();
 
@@ -598,6 +777,25 @@ void TRI_ShutdownStatistics (void) {
 
   DestroyStatisticsList(&RequestFreeList);
   DestroyStatisticsList(&ConnectionFreeList);
+
+  {
+    WRITE_LOCKER(LatencyLock);
+
+    for (auto& it : LatencyEndpoints) {
+      delete it.second;
+    }
+
+    LatencyEndpoints.clear();
+
+    for (auto& it : LatencyQueues) {
+      delete it.second;
+    }
+
+    LatencyQueues.clear();
+
+    delete LatencyOverflow;
+    LatencyOverflow = nullptr;
+  }
 #endif
 }
 
@@ -33,6 +33,17 @@
 #include "Basics/Common.h"
 #include "Rest/HttpRequest.h"
 #include "Statistics/figures.h"
+#include "Statistics/histogram.h"
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                  public constants
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximal number of endpoints with separate latency histograms
+////////////////////////////////////////////////////////////////////////////////
+
+#define TRI_MAX_LATENCY_ENDPOINTS (128)
 
 // -----------------------------------------------------------------------------
 // --SECTION--                                                      public types
@@ -57,6 +68,24 @@ typedef struct TRI_statistics_list_s {
 }
 TRI_statistics_list_t;
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief latency histograms of a single endpoint or dispatcher queue
+///
+/// An endpoint is identified by the database name and the path prefix of the
+/// handler that served the request, a queue only by its name. Entries are
+/// never freed before shutdown, so request statistics may point to them.
+////////////////////////////////////////////////////////////////////////////////
+
+typedef struct TRI_latency_statistics_s {
+  std::string _database;
+  std::string _path;
+
+  triagens::basics::StatisticsHistogram _queueTime;
+  triagens::basics::StatisticsHistogram _requestTime;
+  triagens::basics::StatisticsHistogram _ioTime;
+}
+TRI_latency_statistics_t;
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief request statistics
 ////////////////////////////////////////////////////////////////////////////////
@@ -76,6 +105,9 @@ typedef struct TRI_request_statistics_s {
   double _receivedBytes;
   double _sentBytes;
 
+  TRI_latency_statistics_t* _endpoint;
+  TRI_latency_statistics_t* _queue;
+
   triagens::rest::HttpRequest::HttpRequestType _requestType;
 
   bool _async;
@@ -137,6 +169,34 @@ void TRI_FillRequestStatistics (triagens::basics::StatisticsDistribution& totalT
                                 triagens::basics::StatisticsDistribution& bytesSent,
                                 triagens::basics::StatisticsDistribution& bytesReceived);
 
+// -----------------------------------------------------------------------------
+// --SECTION--                               public latency statistics functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the latency histograms of an endpoint
+///
+/// creates the entry if it does not exist yet. Once TRI_MAX_LATENCY_ENDPOINTS
+/// endpoints are known, all further ones share a single overflow entry with
+/// an empty database name and the path "*".
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_latency_statistics_t* TRI_LookupEndpointLatencyStatistics (std::string const& database,
+                                                               std::string const& path);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the latency histograms of a dispatcher queue
+////////////////////////////////////////////////////////////////////////////////
+
+TRI_latency_statistics_t* TRI_LookupQueueLatencyStatistics (std::string const& queue);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns all known endpoint and queue entries
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FillLatencyStatistics (std::vector<TRI_latency_statistics_t const*>& endpoints,
+                                std::vector<TRI_latency_statistics_t const*>& queues);
+
 // -----------------------------------------------------------------------------
 // --SECTION--                            public connection statistics functions
 // -----------------------------------------------------------------------------
@@ -0,0 +1,294 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cache for the compiled code of JavaScript files
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#include "JSCodeCache.h"
+
+#include "Basics/fasthash.h"
+#include "Basics/logging.h"
+#include "Basics/ReadLocker.h"
+#include "Basics/ReadWriteLock.h"
+#include "Basics/WriteLocker.h"
+
+using namespace std;
+using namespace triagens::basics;
+using namespace triagens::arango;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                   private classes
+// -----------------------------------------------------------------------------
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief the cached code of a script
+////////////////////////////////////////////////////////////////////////////////
+
+  struct CacheEntry {
+    CacheEntry (uint64_t hash,
+                size_t length,
+                uint8_t const* data,
+                int size)
+      : _hash(hash),
+        _length(length),
+        _data(data, data + size) {
+    }
+
+    uint64_t const             _hash;
+    size_t const               _length;
+    std::vector<uint8_t> const _data;
+  };
+
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private variables
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief maximum size of the cached code, scripts are compiled without the
+/// cache once it is reached
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t const MaxMemory = 128 * 1024 * 1024;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the cache is turned on
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<bool> Enabled(false);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief lock for the entries
+////////////////////////////////////////////////////////////////////////////////
+
+static ReadWriteLock Lock;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cached code, by script name
+////////////////////////////////////////////////////////////////////////////////
+
+static std::unordered_map<std::string, std::shared_ptr<CacheEntry const>> Entries;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief total size of the cached code
+////////////////////////////////////////////////////////////////////////////////
+
+static size_t Memory = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of scripts compiled from cached code
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<uint64_t> Hits(0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of scripts compiled without cached code
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<uint64_t> Misses(0);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief number of times V8 rejected the cached code
+////////////////////////////////////////////////////////////////////////////////
+
+static std::atomic<uint64_t> Rejected(0);
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 private functions
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief stores the code of a script, replacing the given entry
+////////////////////////////////////////////////////////////////////////////////
+
+static void StoreEntry (std::string const& name,
+                        std::shared_ptr<CacheEntry const> const& old,
+                        std::shared_ptr<CacheEntry const> const& entry) {
+  WRITE_LOCKER(Lock);
+
+  auto it = Entries.find(name);
+
+  if (it != Entries.end()) {
+    if (it->second != old) {
+      // another context has replaced the entry in the meantime
+      return;
+    }
+
+    Memory -= it->second->_data.size();
+    Entries.erase(it);
+  }
+
+  if (entry == nullptr || Memory + entry->_data.size() > MaxMemory) {
+    return;
+  }
+
+  Entries.emplace(name, entry);
+  Memory += entry->_data.size();
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 class JSCodeCache
+// -----------------------------------------------------------------------------
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             public static methods
+// -----------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief turns the cache on or off, turning it off clears the cache
+////////////////////////////////////////////////////////////////////////////////
+
+void JSCodeCache::enable (bool value) {
+  Enabled = value;
+
+  if (! value) {
+    clear();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the cache is turned on
+////////////////////////////////////////////////////////////////////////////////
+
+bool JSCodeCache::enabled () {
+  return Enabled;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compiles a named script in the current context
+////////////////////////////////////////////////////////////////////////////////
+
+v8::Handle<v8::Script> JSCodeCache::compile (v8::Isolate* isolate,
+                                             v8::Handle<v8::String> source,
+                                             v8::Handle<v8::String> name) {
+  if (! Enabled) {
+    return v8::Script::Compile(source, name);
+  }
+
+  v8::String::Utf8Value nameValue(name);
+  v8::String::Utf8Value sourceValue(source);
+
+  if (*nameValue == nullptr || *sourceValue == nullptr) {
+    return v8::Script::Compile(source, name);
+  }
+
+  std::string const key(*nameValue, static_cast<size_t>(nameValue.length()));
+  size_t const length = static_cast<size_t>(sourceValue.length());
+  uint64_t const hash = fasthash64(*sourceValue, length, 0xdeadbeef);
+
+  std::shared_ptr<CacheEntry const> entry;
+
+  {
+    READ_LOCKER(Lock);
+
+    auto it = Entries.find(key);
+
+    if (it != Entries.end()) {
+      entry = it->second;
+    }
+  }
+
+  v8::ScriptOrigin origin(name);
+
+  if (entry != nullptr && entry->_hash == hash && entry->_length == length) {
+    // the cached data does not own the buffer, the entry is kept alive by
+    // our reference until the compilation is done
+    v8::ScriptCompiler::Source compileSource(source, origin,
+      new v8::ScriptCompiler::CachedData(entry->_data.data(), static_cast<int>(entry->_data.size())));
+
+    v8::Local<v8::Script> script = v8::ScriptCompiler::Compile(isolate, &compileSource, v8::ScriptCompiler::kConsumeCodeCache);
+
+    if (! compileSource.GetCachedData()->rejected) {
+      ++Hits;
+      return script;
+    }
+
+    // V8 has compiled the script from its source. the code was produced by
+    // another V8 version or with other flags, so it is useless from now on
+    ++Rejected;
+    LOG_DEBUG("V8 rejected the cached code of '%s'", key.c_str());
+
+    StoreEntry(key, entry, nullptr);
+    return script;
+  }
+
+  // no entry, or the source has changed
+  ++Misses;
+
+  v8::ScriptCompiler::Source compileSource(source, origin);
+  v8::Local<v8::Script> script = v8::ScriptCompiler::Compile(isolate, &compileSource, v8::ScriptCompiler::kProduceCodeCache);
+
+  v8::ScriptCompiler::CachedData const* data = compileSource.GetCachedData();
+
+  if (! script.IsEmpty() && data != nullptr && data->length > 0) {
+    StoreEntry(key, entry, std::make_shared<CacheEntry const>(hash, length, data->data, data->length));
+  }
+
+  return script;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all entries
+////////////////////////////////////////////////////////////////////////////////
+
+void JSCodeCache::clear () {
+  WRITE_LOCKER(Lock);
+
+  Entries.clear();
+  Memory = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the cache statistics
+////////////////////////////////////////////////////////////////////////////////
+
+JSCodeCache::Statistics JSCodeCache::statistics () {
+  Statistics result;
+
+  {
+    READ_LOCKER(Lock);
+
+    result._entries = Entries.size();
+    result._memory  = Memory;
+  }
+
+  result._hits     = Hits;
+  result._misses   = Misses;
+  result._rejected = Rejected;
+
+  return result;
+}
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
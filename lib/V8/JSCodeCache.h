@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cache for the compiled code of JavaScript files
+///
+/// @file
+///
+/// DISCLAIMER
+///
+/// Copyright 2014 ArangoDB GmbH, Cologne, Germany
+/// Copyright 2004-2014 triAGENS GmbH, Cologne, Germany
+///
+/// Licensed under the Apache License, Version 2.0 (the "License");
+/// you may not use this file except in compliance with the License.
+/// You may obtain a copy of the License at
+///
+///     http://www.apache.org/licenses/LICENSE-2.0
+///
+/// Unless required by applicable law or agreed to in writing, software
+/// distributed under the License is distributed on an "AS IS" BASIS,
+/// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+/// See the License for the specific language governing permissions and
+/// limitations under the License.
+///
+/// Copyright holder is ArangoDB GmbH, Cologne, Germany
+///
+/// @author Dr. Frank Celler
+/// @author Copyright 2014, ArangoDB GmbH, Cologne, Germany
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARANGODB_V8_JSCODE_CACHE_H
+#define ARANGODB_V8_JSCODE_CACHE_H 1
+
+#include "Basics/Common.h"
+
+#include <v8.h>
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                 class JSCodeCache
+// -----------------------------------------------------------------------------
+
+namespace triagens {
+  namespace arango {
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief process-wide cache for the compiled code of JavaScript files
+///
+/// Every V8 context of the server loads the same bootstrap files and modules.
+/// When the cache is enabled, the first context that compiles a file stores
+/// the code V8 produced for it, and all other contexts - including contexts
+/// that are created later on - deserialise this code instead of parsing and
+/// compiling the file again. An entry is only used if the source of the file
+/// is unchanged, and V8 itself rejects code that was produced by another V8
+/// version or with other flags. In both cases the file is compiled normally
+/// and the entry is replaced.
+////////////////////////////////////////////////////////////////////////////////
+
+    class JSCodeCache {
+
+      JSCodeCache () = delete;
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                      public types
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief cache statistics
+////////////////////////////////////////////////////////////////////////////////
+
+        struct Statistics {
+          size_t   _entries;
+          size_t   _memory;
+          uint64_t _hits;
+          uint64_t _misses;
+          uint64_t _rejected;
+        };
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                             public static methods
+// -----------------------------------------------------------------------------
+
+      public:
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief turns the cache on or off, turning it off clears the cache
+////////////////////////////////////////////////////////////////////////////////
+
+        static void enable (bool);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief whether or not the cache is turned on
+////////////////////////////////////////////////////////////////////////////////
+
+        static bool enabled ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief compiles a named script in the current context
+///
+/// Uses the cached code of the script if there is any, and stores the code
+/// otherwise. If the cache is turned off, this is the same as calling
+/// v8::Script::Compile.
+////////////////////////////////////////////////////////////////////////////////
+
+        static v8::Handle<v8::Script> compile (v8::Isolate*,
+                                               v8::Handle<v8::String>,
+                                               v8::Handle<v8::String>);
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief removes all entries
+////////////////////////////////////////////////////////////////////////////////
+
+        static void clear ();
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the cache statistics
+////////////////////////////////////////////////////////////////////////////////
+
+        static Statistics statistics ();
+    };
+  }
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// --SECTION--                                                       END-OF-FILE
+// -----------------------------------------------------------------------------
+
+// Local Variables:
+// mode: outline-minor
+// outline-regexp: "/// @brief\\|/// {@inheritDoc}\\|/// @page\\|// --SECTION--\\|/// @\\}"
+// End:
@@ -80,7 +80,8 @@ v8::Handle<v8::Value> JSLoader::executeGlobalScript (v8::Isolate* isolate,
                                        context,
                                        TRI_V8_STD_STRING(i->second),
                                        TRI_V8_STD_STRING(name),
-                                       false);
+                                       false,
+                                       true);
 
   if (tryCatch.HasCaught()) {
     if (tryCatch.CanContinue()) {
@@ -123,7 +124,8 @@ JSLoader::eState JSLoader::loadScript(v8::Isolate* isolate,
                               context,
                               TRI_V8_STD_STRING(i->second),
                               TRI_V8_STD_STRING(name),
-                              false);
+                              false,
+                              true);
 
   if (tryCatch.HasCaught()) {
     if (tryCatch.CanContinue()) {
@@ -191,7 +193,8 @@ bool JSLoader::executeScript (v8::Isolate* isolate,
                               context,
                               TRI_V8_STD_STRING(content),
                               TRI_V8_STD_STRING(name),
-                              false);
+                              false,
+                              true);
 
   if (! tryCatch.HasCaught()) {
     TRI_LogV8Exception(isolate, &tryCatch);
@@ -57,6 +57,7 @@
 #include "SimpleHttpClient/SimpleHttpClient.h"
 #include "SimpleHttpClient/SimpleHttpResult.h"
 #include "Statistics/statistics.h"
+#include "V8/JSCodeCache.h"
 #include "V8/v8-conv.h"
 #include "V8/v8-globals.h"
 
@@ -328,6 +329,45 @@ static void FillDistribution (v8::Isolate* isolate,
   list->Set(name, result);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fills a latency histogram, all values are in seconds
+////////////////////////////////////////////////////////////////////////////////
+
+static void FillHistogram (v8::Isolate* isolate,
+                           v8::Handle<v8::Object> list,
+                           v8::Handle<v8::String> name,
+                           StatisticsHistogram const& histogram) {
+  StatisticsHistogramSnapshot const snapshot = histogram.snapshot();
+  v8::Handle<v8::Object> result = v8::Object::New(isolate);
+
+  result->Set(TRI_V8_ASCII_STRING("count"), v8::Number::New(isolate, (double) snapshot._count));
+  result->Set(TRI_V8_ASCII_STRING("sum"), v8::Number::New(isolate, snapshot._total / 1000000.0));
+  result->Set(TRI_V8_ASCII_STRING("mean"), v8::Number::New(isolate, snapshot.mean() / 1000000.0));
+  result->Set(TRI_V8_ASCII_STRING("min"), v8::Number::New(isolate, snapshot._min / 1000000.0));
+  result->Set(TRI_V8_ASCII_STRING("max"), v8::Number::New(isolate, snapshot._max / 1000000.0));
+  result->Set(TRI_V8_ASCII_STRING("p50"), v8::Number::New(isolate, snapshot.percentile(0.5) / 1000000.0));
+  result->Set(TRI_V8_ASCII_STRING("p90"), v8::Number::New(isolate, snapshot.percentile(0.9) / 1000000.0));
+  result->Set(TRI_V8_ASCII_STRING("p99"), v8::Number::New(isolate, snapshot.percentile(0.99) / 1000000.0));
+  result->Set(TRI_V8_ASCII_STRING("p999"), v8::Number::New(isolate, snapshot.percentile(0.999) / 1000000.0));
+
+  list->Set(name, result);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/// @brief fills the latency histograms of an endpoint or queue
+////////////////////////////////////////////////////////////////////////////////
+
+static v8::Handle<v8::Object> LatencyObject (v8::Isolate* isolate,
+                                             TRI_latency_statistics_t const* latency) {
+  v8::Handle<v8::Object> result = v8::Object::New(isolate);
+
+  FillHistogram(isolate, result, TRI_V8_ASCII_STRING("queueTime"), latency->_queueTime);
+  FillHistogram(isolate, result, TRI_V8_ASCII_STRING("requestTime"), latency->_requestTime);
+  FillHistogram(isolate, result, TRI_V8_ASCII_STRING("ioTime"), latency->_ioTime);
+
+  return result;
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                      JS functions
 // -----------------------------------------------------------------------------
@@ -1025,7 +1065,13 @@ static void JS_Execute (const v8::FunctionCallbackInfo<v8::Value>& args) {
   {
     v8::TryCatch tryCatch;
 
-    script = v8::Script::Compile(source->ToString(), filename->ToString());
+    if (filename->IsUndefined()) {
+      script = v8::Script::Compile(source->ToString(), filename->ToString());
+    }
+    else {
+      // scripts with a name are modules, use the code cache for them
+      script = JSCodeCache::compile(isolate, source->ToString(), filename->ToString());
+    }
 
     // compilation failed, print errors that happened during compilation
     if (script.IsEmpty()) {
@@ -1788,7 +1834,8 @@ static void JS_Load (const v8::FunctionCallbackInfo<v8::Value>& args) {
                                 isolate->GetCurrentContext(),
                                 TRI_V8_PAIR_STRING(content, length),
                                 filename->ToString(),
-                                false);
+                                false,
+                                true);
  
   // restore old values for __dirname and __filename
   if (oldFilename.IsEmpty() || oldFilename->IsUndefined()) {
@@ -3428,6 +3475,49 @@ static void JS_HttpStatistics (const v8::FunctionCallbackInfo<v8::Value>& args)
   TRI_V8_RETURN(result);
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief returns the latency histograms per endpoint and dispatcher queue
+////////////////////////////////////////////////////////////////////////////////
+
+static void JS_LatencyStatistics (const v8::FunctionCallbackInfo<v8::Value>& args) {
+  v8::Isolate* isolate = args.GetIsolate();
+  v8::HandleScope scope(isolate);
+
+  vector<TRI_latency_statistics_t const*> endpoints;
+  vector<TRI_latency_statistics_t const*> queues;
+
+  TRI_FillLatencyStatistics(endpoints, queues);
+
+  v8::Handle<v8::Object> result = v8::Object::New(isolate);
+
+  v8::Handle<v8::Array> endpointList = v8::Array::New(isolate, (int) endpoints.size());
+  uint32_t pos = 0;
+
+  for (auto const& it : endpoints) {
+    v8::Handle<v8::Object> entry = LatencyObject(isolate, it);
+
+    entry->Set(TRI_V8_ASCII_STRING("database"), TRI_V8_STD_STRING(it->_database));
+    entry->Set(TRI_V8_ASCII_STRING("path"), TRI_V8_STD_STRING(it->_path));
+    endpointList->Set(pos++, entry);
+  }
+
+  result->Set(TRI_V8_ASCII_STRING("endpoints"), endpointList);
+
+  v8::Handle<v8::Array> queueList = v8::Array::New(isolate, (int) queues.size());
+  pos = 0;
+
+  for (auto const& it : queues) {
+    v8::Handle<v8::Object> entry = LatencyObject(isolate, it);
+
+    entry->Set(TRI_V8_ASCII_STRING("name"), TRI_V8_STD_STRING(it->_path));
+    queueList->Set(pos++, entry);
+  }
+
+  result->Set(TRI_V8_ASCII_STRING("queues"), queueList);
+
+  TRI_V8_RETURN(result);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief executes a external program
 ////////////////////////////////////////////////////////////////////////////////
@@ -4160,11 +4250,19 @@ v8::Handle<v8::Value> TRI_ExecuteJavaScriptString (v8::Isolate* isolate,
                                                    v8::Handle<v8::Context> context,
                                                    v8::Handle<v8::String> const source,
                                                    v8::Handle<v8::String> const name,
-                                                   bool printResult) {
+                                                   bool printResult,
+                                                   bool useCodeCache) {
   v8::EscapableHandleScope scope(isolate);
 
   v8::Handle<v8::Value> result;
-  v8::Handle<v8::Script> script = v8::Script::Compile(source, name);
+  v8::Handle<v8::Script> script;
+
+  if (useCodeCache) {
+    script = JSCodeCache::compile(isolate, source, name);
+  }
+  else {
+    script = v8::Script::Compile(source, name);
+  }
 
   // compilation failed, print errors that happened during compilation
   if (script.IsEmpty()) {
@@ -4316,6 +4414,18 @@ bool TRI_SingleRunGarbageCollectionV8 (v8::Isolate* isolate,
   return rc;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief adds a histogram of durations to an object, all values are in
+/// seconds
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FillHistogramV8 (v8::Isolate* isolate,
+                          v8::Handle<v8::Object> object,
+                          v8::Handle<v8::String> name,
+                          StatisticsHistogram const& histogram) {
+  FillHistogram(isolate, object, name, histogram);
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief run the V8 garbage collection for at most a specifiable amount of 
 /// time
@@ -4470,6 +4580,7 @@ void TRI_InitV8Utils (v8::Isolate* isolate,
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_HTTP_STATISTICS"), JS_HttpStatistics);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_IS_IP"), JS_IsIP);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_KILL_EXTERNAL"), JS_KillExternal);
+  TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_LATENCY_STATISTICS"), JS_LatencyStatistics);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_LOAD"), JS_Load);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_LOG"), JS_Log);
   TRI_AddGlobalFunctionVocbase(isolate, context, TRI_V8_ASCII_STRING("SYS_LOG_LEVEL"), JS_LogLevel);
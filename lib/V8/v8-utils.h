@@ -37,6 +37,12 @@
 #include "V8/JSLoader.h"
 #include "Basics/json.h"
 
+namespace triagens {
+  namespace basics {
+    class StatisticsHistogram;
+  }
+}
+
 // -----------------------------------------------------------------------------
 // --SECTION--                                                           GENERAL
 // -----------------------------------------------------------------------------
@@ -183,13 +189,17 @@ bool TRI_ParseJavaScriptFile (v8::Isolate* isolate, char const*);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief executes a string within a V8 context, optionally print the result
+///
+/// if useCodeCache is true, the string is the content of the file name and
+/// is compiled using the JSCodeCache
 ////////////////////////////////////////////////////////////////////////////////
 
 v8::Handle<v8::Value> TRI_ExecuteJavaScriptString (v8::Isolate* isolate,
                                                    v8::Handle<v8::Context> context,
                                                    v8::Handle<v8::String> const source,
                                                    v8::Handle<v8::String> const name,
-                                                   bool printResult);
+                                                   bool printResult,
+                                                   bool useCodeCache = false);
 
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief creates an error in a javascript object, based on error number only
@@ -227,6 +237,16 @@ void TRI_normalize_V8_Obj (const v8::FunctionCallbackInfo<v8::Value>& args,
    
 bool TRI_SingleRunGarbageCollectionV8 (v8::Isolate*, double);
 
+////////////////////////////////////////////////////////////////////////////////
+/// @brief adds a histogram of durations to an object, all values are in
+/// seconds
+////////////////////////////////////////////////////////////////////////////////
+
+void TRI_FillHistogramV8 (v8::Isolate*,
+                          v8::Handle<v8::Object>,
+                          v8::Handle<v8::String>,
+                          triagens::basics::StatisticsHistogram const&);
+
 ////////////////////////////////////////////////////////////////////////////////
 /// @brief run the V8 garbage collection for at most a specifiable amount of 
 /// time